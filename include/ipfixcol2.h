@@ -56,6 +56,8 @@
 
 #include <ipfixcol2/api.h>
 
+#include <ipfixcol2/field_locator.h>
+#include <ipfixcol2/htable.h>
 #include <ipfixcol2/message.h>
 #include <ipfixcol2/message_garbage.h>
 #include <ipfixcol2/message_session.h>
@@ -0,0 +1,134 @@
+/**
+ * \file include/ipfixcol2/field_locator.h
+ * \brief Template field locators (header file)
+ * \date 2026
+ */
+
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#ifndef IPX_FIELD_LOCATOR_H
+#define IPX_FIELD_LOCATOR_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <libfds.h>
+#include <ipfixcol2/api.h>
+
+/**
+ * \defgroup ipxFieldLocator Template field locators
+ * \ingroup publicAPIs
+ * \brief Cache of positions of selected fields in Data Records
+ *
+ * Plugins that are interested only in a few fields of each Data Record (e.g. IP addresses
+ * or timestamps) would otherwise have to iterate over all fields of every record. Instead,
+ * the fields of a template are matched against a plugin-supplied callback only once and
+ * positions (offset, length) of the matching fields are cached. Cached positions are always
+ * validated against the definition of the template, therefore, a freed template and a new one
+ * allocated at the same address are never confused.
+ *
+ * The position of a field is known only if all previous fields of the template have fixed
+ * length. Therefore, for templates with variable-length fields before (or among) the matching
+ * fields, the plugin must fall back to fds_drec_iter.
+ *
+ * \warning The cache is not thread-safe. Each plugin instance should use its own cache.
+ * @{
+ */
+
+/** Position of a field in Data Records of a template                                          */
+struct ipx_floc_field {
+    /** Offset from the beginning of a Data Record                                             */
+    uint16_t offset;
+    /** Length of the field                                                                     */
+    uint16_t length;
+    /** Template field definition                                                               */
+    const struct fds_tfield *info;
+};
+
+/**
+ * \brief Field selection callback
+ * \param[in] field Template field
+ * \param[in] data  User data passed to ipx_floc_create()
+ * \return True if the field should be located. Otherwise false.
+ */
+typedef bool (*ipx_floc_match_cb)(const struct fds_tfield *field, void *data);
+
+/** Internal type of the cache                                                                */
+typedef struct ipx_floc ipx_floc_t;
+
+/**
+ * \brief Create a cache of field locators
+ * \param[in] match Field selection callback
+ * \param[in] data  User data passed to the callback (can be NULL)
+ * \return Pointer to the cache or NULL (memory allocation error)
+ */
+IPX_API ipx_floc_t *
+ipx_floc_create(ipx_floc_match_cb match, void *data);
+
+/**
+ * \brief Destroy a cache of field locators
+ * \param[in] floc Cache to destroy
+ */
+IPX_API void
+ipx_floc_destroy(ipx_floc_t *floc);
+
+/**
+ * \brief Get positions of the matching fields of a template
+ *
+ * Fields are returned in the same order as in the template.
+ * \warning The array of fields is valid only until the next call of this function.
+ * \param[in]  floc   Cache
+ * \param[in]  tmplt  Template of Data Records (must be valid, i.e. referenced by a message)
+ * \param[out] fields Array of matching fields (the first one)
+ * \param[out] cnt    Number of matching fields
+ * \return #IPX_OK on success (the number of fields can be zero)
+ * \return #IPX_ERR_FORMAT if a matching field doesn't have a fixed position (i.e. variable-length
+ *   field or a field after a variable-length field) and Data Records must be iterated instead
+ * \return #IPX_ERR_NOMEM if a memory allocation error has occurred
+ */
+IPX_API int
+ipx_floc_get(ipx_floc_t *floc, const struct fds_template *tmplt,
+    const struct ipx_floc_field **fields, uint16_t *cnt);
+
+/**@}*/
+
+#ifdef __cplusplus
+}
+#endif
+#endif // IPX_FIELD_LOCATOR_H
@@ -0,0 +1,230 @@
+/**
+ * \file include/ipfixcol2/htable.h
+ * \brief Hash table with open addressing (header file)
+ * \date 2026
+ */
+
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#ifndef IPX_HTABLE_H
+#define IPX_HTABLE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <ipfixcol2/api.h>
+
+/**
+ * \defgroup ipxHashTable Hash table
+ * \ingroup publicAPIs
+ * \brief Hash table of pointers with open addressing
+ *
+ * The table stores pointers to items owned by the user together with their hash values.
+ * Collisions are resolved by linear probing and the table is kept at most half full, so
+ * lookups usually touch a single cache line. Items are removed by backward shift deletion,
+ * i.e. there are no tombstones and lookups don't degrade over time.
+ *
+ * Items are compared by a user-supplied callback that is usually inlined by the compiler
+ * into ipx_htable_find(). The table itself never dereferences the items.
+ *
+ * All slots can be iterated directly (see ipx_htable::slots), empty slots have NULL item.
+ * \warning The table is not thread-safe.
+ * @{
+ */
+
+/** Slot of a hash table                                                                        */
+struct ipx_htable_slot {
+    /** Hash of the item                                                                        */
+    uint64_t hash;
+    /** Item (NULL, if the slot is empty)                                                       */
+    void *item;
+};
+
+/** Hash table                                                                                  */
+struct ipx_htable {
+    /** Array of slots                                                                          */
+    struct ipx_htable_slot *slots;
+    /** Number of slots (power of two)                                                          */
+    size_t size;
+    /** Number of items                                                                         */
+    size_t used;
+};
+
+/**
+ * \brief Item comparison callback
+ * \param[in] item Item stored in the table
+ * \param[in] key  Key to look up (passed to ipx_htable_find())
+ * \return True if the item matches the key
+ */
+typedef bool (*ipx_htable_eq_cb)(const void *item, const void *key);
+
+/**
+ * \brief Mix bits of a 64-bit value (finalizer of MurmurHash3)
+ *
+ * Useful for hashing pointers and integers, which usually don't have well distributed bits.
+ * \param[in] key Value
+ * \return Hash value
+ */
+static inline uint64_t
+ipx_htable_mix(uint64_t key)
+{
+    key ^= key >> 33;
+    key *= 0xFF51AFD7ED558CCDULL;
+    key ^= key >> 33;
+    key *= 0xC4CEB9FE1A85EC53ULL;
+    key ^= key >> 33;
+    return key;
+}
+
+/**
+ * \brief Initialize an empty hash table
+ * \param[in] table Hash table
+ * \param[in] size  Initial number of slots (must be a power of two)
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_NOMEM if a memory allocation error has occurred
+ */
+IPX_API int
+ipx_htable_init(struct ipx_htable *table, size_t size);
+
+/**
+ * \brief Destroy a hash table
+ * \note Items are not freed.
+ * \param[in] table Hash table
+ */
+IPX_API void
+ipx_htable_destroy(struct ipx_htable *table);
+
+/**
+ * \brief Remove all items from a hash table
+ * \note Items are not freed.
+ * \param[in] table Hash table
+ */
+IPX_API void
+ipx_htable_clear(struct ipx_htable *table);
+
+/**
+ * \brief Make sure that a new item can be inserted into a hash table
+ *
+ * If the table would be more than half full, its size is doubled.
+ * \param[in] table Hash table
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_NOMEM if a memory allocation error has occurred
+ */
+IPX_API int
+ipx_htable_reserve(struct ipx_htable *table);
+
+/**
+ * \brief Insert an item into a hash table
+ * \warning The item must not be present in the table and the table must have enough space
+ *   (see ipx_htable_reserve())
+ * \param[in] table Hash table
+ * \param[in] hash  Hash of the item
+ * \param[in] item  Item (not NULL)
+ */
+IPX_API void
+ipx_htable_insert(struct ipx_htable *table, uint64_t hash, void *item);
+
+/**
+ * \brief Remove an item from a hash table
+ *
+ * Following items of the same cluster are moved to fill the gap. Therefore, if the table is
+ * being iterated, the same slot must be checked again after the removal.
+ * \param[in] table Hash table
+ * \param[in] slot  Slot of the item (see ipx_htable_find() or ipx_htable_find_item())
+ */
+IPX_API void
+ipx_htable_remove(struct ipx_htable *table, struct ipx_htable_slot *slot);
+
+/**
+ * \brief Find an item in a hash table
+ * \param[in] table Hash table
+ * \param[in] hash  Hash of the key
+ * \param[in] eq    Comparison callback
+ * \param[in] key   Key passed to the callback
+ * \return Pointer to the slot of the item or NULL (not found)
+ */
+static inline struct ipx_htable_slot *
+ipx_htable_find(const struct ipx_htable *table, uint64_t hash, ipx_htable_eq_cb eq,
+    const void *key)
+{
+    const size_t mask = table->size - 1;
+    size_t idx = hash & mask;
+    struct ipx_htable_slot *slot;
+    while ((slot = &table->slots[idx])->item != NULL) {
+        if (slot->hash == hash && eq(slot->item, key)) {
+            return slot;
+        }
+
+        idx = (idx + 1) & mask;
+    }
+
+    return NULL;
+}
+
+/**
+ * \brief Find a slot of an item in a hash table (the item is compared by its address)
+ * \param[in] table Hash table
+ * \param[in] hash  Hash of the item
+ * \param[in] item  Item
+ * \return Pointer to the slot of the item or NULL (not found)
+ */
+static inline struct ipx_htable_slot *
+ipx_htable_find_item(const struct ipx_htable *table, uint64_t hash, const void *item)
+{
+    const size_t mask = table->size - 1;
+    size_t idx = hash & mask;
+    struct ipx_htable_slot *slot;
+    while ((slot = &table->slots[idx])->item != NULL) {
+        if (slot->item == item) {
+            return slot;
+        }
+
+        idx = (idx + 1) & mask;
+    }
+
+    return NULL;
+}
+
+/**@}*/
+
+#ifdef __cplusplus
+}
+#endif
+#endif // IPX_HTABLE_H
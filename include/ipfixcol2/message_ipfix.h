@@ -117,6 +117,10 @@ struct ipx_ipfix_record {
  * parser. In case of NetFlow, the parser transforms message to IPFIX.
  *
  * \warning User MUST make sure that \p msg_data represents valid Message header
+ * \note
+ *   The \p msg_data MUST be allocated by malloc() or ipx_msg_ipfix_buffer_alloc() of the same
+ *   plugin context. The message takes over responsibility for the memory and frees it when the
+ *   message is destroyed. If the function fails, the caller is still responsible for the memory.
  * \param[in] plugin_ctx Context of the plugin
  * \param[in] msg_ctx    Message context (info about Transport Session, ODID, etc.)
  * \param[in] msg_data   Pointer to the IPFIX (or NetFlow) Message header
@@ -127,6 +131,61 @@ IPX_API ipx_msg_ipfix_t *
 ipx_msg_ipfix_create(const ipx_ctx_t *plugin_ctx, const struct ipx_msg_ctx *msg_ctx,
     uint8_t *msg_data, uint16_t msg_size);
 
+/**
+ * \brief Create a wrapper around IPFIX (or NetFlow) Message stored in a shared buffer
+ *
+ * Same as ipx_msg_ipfix_create(), however, the message only refers to a part of the \p buffer.
+ * The caller keeps its reference to the buffer, therefore, multiple messages can be created
+ * from a single buffer without copying (e.g. all complete messages received from a stream at
+ * once) and the buffer MUST be still released by the caller using ipx_msg_ipfix_buffer_free().
+ * The memory is returned after the caller and all messages release it.
+ *
+ * \warning The referenced part of the \p buffer MUST NOT be modified by the caller anymore.
+ * \note
+ *   If the \p buffer has not been allocated from the pool of buffers (e.g. the pool is not
+ *   available), the message is copied into a new buffer.
+ * \param[in] plugin_ctx Context of the plugin
+ * \param[in] msg_ctx    Message context (info about Transport Session, ODID, etc.)
+ * \param[in] buffer     Buffer allocated by ipx_msg_ipfix_buffer_alloc()
+ * \param[in] msg_data   Pointer to the IPFIX (or NetFlow) Message header inside the \p buffer
+ * \param[in] msg_size   Total size of the IPFIX (or NetFlow) Message
+ * \return Pointer or NULL (memory allocation error)
+ */
+IPX_API ipx_msg_ipfix_t *
+ipx_msg_ipfix_create_ref(const ipx_ctx_t *plugin_ctx, const struct ipx_msg_ctx *msg_ctx,
+    uint8_t *buffer, uint8_t *msg_data, uint16_t msg_size);
+
+/**
+ * \brief Allocate a buffer for a raw IPFIX (or NetFlow) Message
+ *
+ * Buffers of input instances are taken from a pool of buffers owned by the collector, therefore,
+ * it is usually much faster than malloc(). The buffer is expected to be passed to
+ * ipx_msg_ipfix_create() which takes over responsibility for the memory and returns it to the
+ * pool after the message is destroyed (by any thread). Otherwise, the buffer MUST be freed
+ * using ipx_msg_ipfix_buffer_free().
+ *
+ * \warning The function can be called only by the thread of the instance (i.e. from its
+ *   callback functions).
+ * \param[in] plugin_ctx Context of the plugin
+ * \param[in] size       Size of the buffer (in bytes)
+ * \return Pointer or NULL (memory allocation error)
+ */
+IPX_API uint8_t *
+ipx_msg_ipfix_buffer_alloc(const ipx_ctx_t *plugin_ctx, size_t size);
+
+/**
+ * \brief Free a buffer for a raw IPFIX (or NetFlow) Message
+ *
+ * \warning The function can be called only by the thread of the instance (i.e. from its
+ *   callback functions). The \p buffer MUST NOT be passed to any message by
+ *   ipx_msg_ipfix_create(). Buffers shared by ipx_msg_ipfix_create_ref() are returned after
+ *   all messages that refer to them are destroyed.
+ * \param[in] plugin_ctx Context of the plugin
+ * \param[in] buffer     Buffer allocated by ipx_msg_ipfix_buffer_alloc() (can be NULL)
+ */
+IPX_API void
+ipx_msg_ipfix_buffer_free(const ipx_ctx_t *plugin_ctx, uint8_t *buffer);
+
 /**
  * \brief Destroy a message wrapper with a parsed IPFIX packet
  * \param[out] msg Pointer to the message
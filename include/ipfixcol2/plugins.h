@@ -150,6 +150,18 @@ typedef struct ipx_ctx_ext ipx_ctx_ext_t;
  */
 #define IPX_PF_DEEPBIND 1U
 
+/**
+ * \def IPX_PF_WORKERS
+ * \brief The input plugin supports multiple workers
+ *
+ * If the user configures multiple workers of an input instance, the collector creates one
+ * independent replica of the instance per worker (each with its own thread and parser). All
+ * replicas receive the same parameters, therefore, they must be able to share resources such
+ * as a local port (see ipx_ctx_worker_get()). Instances of plugins without this flag are
+ * refused to run in multiple workers.
+ */
+#define IPX_PF_WORKERS 2U
+
 /**
  * \brief Identification of a plugin
  *
@@ -285,6 +297,41 @@ ipx_plugin_get(ipx_ctx_t *ctx, void *cfg);
 IPX_API int
 ipx_plugin_process(ipx_ctx_t *ctx, void *cfg, ipx_msg_t *msg);
 
+/**
+ * \brief Process multiple messages from the IPFIXcol core (OPTIONAL, Intermediate and Output
+ *   plugins ONLY)
+ *
+ * If the plugin implements this function, the IPFIXcol core prefers it over
+ * ipx_plugin_process() and passes all messages, which are available at the moment and the
+ * instance subscribes to, at once. Processing of a batch of messages allows the plugin to
+ * amortize costs of per-message operations (e.g. function calls, lookups, system calls, etc.).
+ * Plugins that do not implement this function keep working unchanged, i.e. ipx_plugin_process()
+ * is called for each message separately.
+ *
+ * The same rules as in case of ipx_plugin_process() apply to each message of the batch.
+ * The messages are sorted in the order in which they have been received and, in case of
+ * _Intermediate plugins_, the order of messages passed by ipx_ctx_msg_pass() should be
+ * preserved. The array itself is owned by the IPFIXcol core and it is valid only during the
+ * function call.
+ *
+ * \warning
+ *   This interface is only for Intermediate and Output plugins! In case of the other types,
+ *   the IPFIXcol core ignores this function.
+ * \warning
+ *   Even if the function is implemented, ipx_plugin_process() MUST be still implemented.
+ * \param[in] ctx  Plugin context
+ * \param[in] cfg  Private data of the instance prepared by initialization function
+ * \param[in] msgs Array of messages to process
+ * \param[in] cnt  Number of messages in the array (always non-zero)
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_DENIED if a fatal memory allocation error has occurred and/or the plugin cannot
+ *   continue to work properly (the collector will exit).
+ * \return #IPX_ERR_EOF if the plugin has reached expected goal (e.g. number of processed records).
+ *   This function will not be called anymore and the collector will shut down.
+ */
+IPX_API int
+ipx_plugin_process_batch(ipx_ctx_t *ctx, void *cfg, ipx_msg_t **msgs, size_t cnt);
+
 /**
  * \brief Request to close a Transport Session (Input plugins only!)
  *
@@ -350,6 +397,19 @@ ipx_ctx_verb_get(const ipx_ctx_t *ctx);
 IPX_API const char *
 ipx_ctx_name_get(const ipx_ctx_t *ctx);
 
+/**
+ * \brief Get identification of the worker of an input instance
+ *
+ * Input instances with multiple workers (see #IPX_PF_WORKERS) consist of independent replicas
+ * of the instance. Each replica is a worker with a unique identification number.
+ * \param[in]  ctx Current plugin context
+ * \note The collector also adds the identification to the name of the instance.
+ * \param[out] id  Identification number of the worker (0 .. cnt - 1) (can be NULL)
+ * \param[out] cnt Total number of workers of the instance (1 if the instance is not replicated)
+ */
+IPX_API void
+ipx_ctx_worker_get(const ipx_ctx_t *ctx, unsigned int *id, unsigned int *cnt);
+
 /**
  * \brief Pass a message to a successor of the plugin (only Input and Intermediate plugins ONLY!)
  *
@@ -372,6 +432,26 @@ ipx_ctx_name_get(const ipx_ctx_t *ctx);
 IPX_API int
 ipx_ctx_msg_pass(ipx_ctx_t *ctx, ipx_msg_t *msg);
 
+/**
+ * \brief Pass multiple messages to a successor of the plugin (Input and Intermediate plugins
+ *   ONLY!)
+ *
+ * The same as ipx_ctx_msg_pass() for each message of the array, however, the cost of
+ * synchronization with the successor is shared by all messages. The order of messages is
+ * preserved.
+ * \warning
+ *   This interface is only for Input and Intermediate plugins.
+ * \note The content of the array is undefined after the call.
+ * \param[in] ctx  Current plugin context
+ * \param[in] msgs Array of messages to send
+ * \param[in] cnt  Number of messages in the array
+ * \return #IPX_OK on success.
+ * \return #IPX_ERR_ARG if any message is NULL or the plugin doesn't have permissions (nothing
+ *   is passed).
+ */
+IPX_API int
+ipx_ctx_msg_pass_batch(ipx_ctx_t *ctx, ipx_msg_t **msgs, uint32_t cnt);
+
 /**
  * \brief Change message subscription (Intermediate and Output plugins ONLY!)
  *
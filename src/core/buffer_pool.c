@@ -0,0 +1,554 @@
+/**
+ * \file src/core/buffer_pool.c
+ * \brief Pool of buffers for raw IPFIX Messages
+ * \date 2026
+ */
+
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include "buffer_pool.h"
+
+#ifndef IPX_CLINE_SIZE
+/** Expected CPU cache-line size        */
+#define IPX_CLINE_SIZE 64
+#endif
+/** Cache-line alignment                */
+#define __ipx_cache_aligned __attribute__((__aligned__(IPX_CLINE_SIZE)))
+
+/** Size of an arena, i.e. a memory region divided into buffers (size of a huge page)       */
+#define ARENA_SIZE (2U * 1024U * 1024U)
+/** Number of size classes                                                                   */
+#define CLASS_CNT (6U)
+/** Capacity of buffers in the smallest class (in bytes)                                     */
+#define CLASS_SIZE_MIN (2048U)
+/** Number of allocations of a size class between trimming of its free-lists                 */
+#define TRIM_PERIOD (16384U)
+/** Special value of a free-list of returned buffers that marks a destroyed pool             */
+#define POOL_CLOSED ((struct buf_hdr *) UINTPTR_MAX)
+
+static_assert((CLASS_SIZE_MIN << (CLASS_CNT - 1)) == IPX_BUFFER_POOL_SIZE_MAX,
+    "The largest class must be able to hold a buffer of the maximum size");
+
+/** Use huge pages for new pools                                                             */
+static bool pool_hugepages = false;
+
+/** Header of a buffer (the buffer itself follows immediately after the header)              */
+struct buf_hdr {
+    /** Pool of the buffer                                                                   */
+    struct ipx_buffer_pool *pool;
+    /** Next buffer in a free-list (valid only inside the pool)                              */
+    struct buf_hdr *next;
+    /** Index of the size class                                                              */
+    uint32_t cls_idx;
+    /** Number of references to the buffer (accessed only atomically, see ipx_buffer_pool_ref()) */
+    uint32_t refs;
+} __ipx_cache_aligned;
+
+/** Size class                                                                               */
+struct pool_class {
+    /**
+     * Free-list of buffers returned by any thread (lock-free stack)
+     * \note The owner takes all buffers at once, therefore, the stack doesn't suffer from
+     *   the ABA problem. If the pool has been destroyed, the value is #POOL_CLOSED.
+     */
+    struct buf_hdr *returned __ipx_cache_aligned;
+
+    /** Free-list of buffers ready to reuse (accessed only by the owner)                      */
+    struct buf_hdr *local __ipx_cache_aligned;
+    /** Number of buffers in the local free-list                                              */
+    uint64_t local_cnt;
+    /** Free-list of trimmed buffers i.e. without physical memory (accessed only by the owner) */
+    struct buf_hdr *trimmed;
+    /** Number of buffers in the free-list of trimmed buffers                                 */
+    uint64_t trimmed_cnt;
+    /** Number of slots taken from arenas                                                     */
+    uint64_t slots;
+    /** High-water mark of buffers in use (since the last trimming)                           */
+    uint64_t hwm;
+    /** Number of allocations since the last trimming                                         */
+    uint32_t allocs;
+    /** Size of a slot, i.e. header + buffer (in bytes)                                       */
+    size_t slot_size;
+    /** Arena from which new slots are taken (NULL, if not available)                         */
+    uint8_t *arena;
+    /** Number of already used slots of the arena                                             */
+    size_t arena_used;
+};
+
+/** Pool of buffers                                                                          */
+struct ipx_buffer_pool {
+    /** Size classes (sorted by size of buffers)                                              */
+    struct pool_class classes[CLASS_CNT];
+
+    struct {
+        /** Sorted array of allocated arenas                                                  */
+        uint8_t **items;
+        /** Number of valid arenas                                                            */
+        size_t cnt;
+        /** Number of allocated items of the array                                            */
+        size_t alloc;
+        /** Huge pages are enabled                                                            */
+        bool hugepages;
+        /** Try to allocate new arenas from preallocated huge pages (MAP_HUGETLB)             */
+        bool hugetlb;
+        /** Size of a memory page (in bytes)                                                  */
+        size_t page_size;
+    } arenas; /**< Memory regions of the pool (accessed only by the owner)                   */
+
+    /**
+     * Reference counter (accessed only atomically)
+     * \note The value represents the owner and all slots taken from arenas that haven't been
+     *   reclaimed yet (i.e. buffers in use and in the free-lists)
+     */
+    uint64_t refs __ipx_cache_aligned;
+};
+
+void
+ipx_buffer_pool_hugepages_set(bool en)
+{
+    pool_hugepages = en;
+}
+
+ipx_buffer_pool_t *
+ipx_buffer_pool_create()
+{
+    struct ipx_buffer_pool *pool = aligned_alloc(IPX_CLINE_SIZE, sizeof(*pool));
+    if (!pool) {
+        return NULL;
+    }
+
+    for (uint32_t i = 0; i < CLASS_CNT; ++i) {
+        struct pool_class *cls = &pool->classes[i];
+        cls->returned = NULL;
+        cls->local = NULL;
+        cls->local_cnt = 0;
+        cls->trimmed = NULL;
+        cls->trimmed_cnt = 0;
+        cls->slots = 0;
+        cls->hwm = 0;
+        cls->allocs = 0;
+        cls->slot_size = sizeof(struct buf_hdr) + (((size_t) CLASS_SIZE_MIN) << i);
+        cls->arena = NULL;
+        cls->arena_used = 0;
+    }
+
+    pool->arenas.items = NULL;
+    pool->arenas.cnt = 0;
+    pool->arenas.alloc = 0;
+    pool->arenas.hugepages = pool_hugepages;
+    pool->arenas.hugetlb = pool_hugepages;
+    const long page_size = sysconf(_SC_PAGESIZE);
+    pool->arenas.page_size = (page_size > 0) ? (size_t) page_size : 4096U;
+    pool->refs = 1; // The owner
+    return pool;
+}
+
+/**
+ * \brief Allocate a new arena aligned to its size
+ * \param[in] pool Pool (only for configuration of huge pages)
+ * \return Pointer to the arena or NULL
+ */
+static uint8_t *
+arena_alloc(struct ipx_buffer_pool *pool)
+{
+    void *ptr;
+
+    if (pool->arenas.hugetlb) {
+        // Huge pages are always aligned to the size of a huge page
+        ptr = mmap(NULL, ARENA_SIZE, PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (ptr != MAP_FAILED && ((uintptr_t) ptr % ARENA_SIZE) == 0) {
+            return ptr;
+        }
+        if (ptr != MAP_FAILED) {
+            munmap(ptr, ARENA_SIZE);
+        }
+
+        // Huge pages are not available, don't try it again
+        pool->arenas.hugetlb = false;
+    }
+
+    // Allocate more memory and remove unaligned parts
+    ptr = mmap(NULL, 2 * ARENA_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (ptr == MAP_FAILED) {
+        return NULL;
+    }
+
+    const uintptr_t mask = (uintptr_t) ARENA_SIZE - 1;
+    uint8_t *start = ptr;
+    uint8_t *aligned = (uint8_t *) (((uintptr_t) start + mask) & ~mask);
+    size_t head = (size_t) (aligned - start);
+    if (head > 0) {
+        munmap(start, head);
+    }
+    munmap(aligned + ARENA_SIZE, ARENA_SIZE - head);
+
+    if (pool->arenas.hugepages) {
+        // Try at least transparent huge pages (failure is not important)
+        madvise(aligned, ARENA_SIZE, MADV_HUGEPAGE);
+    }
+
+    return aligned;
+}
+
+/**
+ * \brief Add a new arena to a size class
+ * \param[in] pool Pool
+ * \param[in] cls  Size class
+ * \return True on success, false on a memory allocation error
+ */
+static bool
+arena_add(struct ipx_buffer_pool *pool, struct pool_class *cls)
+{
+    if (pool->arenas.cnt == pool->arenas.alloc) {
+        const size_t alloc_new = (pool->arenas.alloc == 0) ? 16 : 2 * pool->arenas.alloc;
+        uint8_t **items_new = realloc(pool->arenas.items, alloc_new * sizeof(*items_new));
+        if (!items_new) {
+            return false;
+        }
+
+        pool->arenas.items = items_new;
+        pool->arenas.alloc = alloc_new;
+    }
+
+    uint8_t *arena = arena_alloc(pool);
+    if (!arena) {
+        return false;
+    }
+
+    // Keep the array sorted
+    size_t pos = pool->arenas.cnt;
+    while (pos > 0 && pool->arenas.items[pos - 1] > arena) {
+        pool->arenas.items[pos] = pool->arenas.items[pos - 1];
+        pos--;
+    }
+    pool->arenas.items[pos] = arena;
+    pool->arenas.cnt++;
+
+    cls->arena = arena;
+    cls->arena_used = 0;
+    return true;
+}
+
+/**
+ * \brief Free the pool and all its arenas
+ * \param[in] pool Pool
+ */
+static void
+pool_free(struct ipx_buffer_pool *pool)
+{
+    for (size_t i = 0; i < pool->arenas.cnt; ++i) {
+        munmap(pool->arenas.items[i], ARENA_SIZE);
+    }
+
+    free(pool->arenas.items);
+    free(pool);
+}
+
+/**
+ * \brief Release references to a pool (the pool is freed after the last reference)
+ * \param[in] pool Pool
+ * \param[in] cnt  Number of references to release
+ */
+static inline void
+pool_release(struct ipx_buffer_pool *pool, uint64_t cnt)
+{
+    if (cnt > 0 && __atomic_sub_fetch(&pool->refs, cnt, __ATOMIC_ACQ_REL) == 0) {
+        pool_free(pool);
+    }
+}
+
+/**
+ * \brief Get length of a free-list
+ * \param[in] list First buffer of the list (can be NULL)
+ * \return Number of buffers
+ */
+static uint64_t
+list_len(const struct buf_hdr *list)
+{
+    uint64_t cnt = 0;
+    for (; list != NULL; list = list->next) {
+        cnt++;
+    }
+    return cnt;
+}
+
+void
+ipx_buffer_pool_destroy(ipx_buffer_pool_t *pool)
+{
+    // Buffers in the free-lists will never be used again
+    uint64_t reclaimed = 0;
+    for (uint32_t i = 0; i < CLASS_CNT; ++i) {
+        struct pool_class *cls = &pool->classes[i];
+        reclaimed += cls->local_cnt + cls->trimmed_cnt;
+        cls->local = NULL;
+        cls->trimmed = NULL;
+
+        // From now, returned buffers are reclaimed immediately
+        reclaimed += list_len(__atomic_exchange_n(&cls->returned, POOL_CLOSED, __ATOMIC_ACQ_REL));
+    }
+
+    pool_release(pool, reclaimed + 1); // +1 for the owner
+}
+
+/**
+ * \brief Release physical memory of a free buffer
+ *
+ * Only whole pages inside the buffer are released, i.e. the header of the buffer and neighbouring
+ * slots are not affected. The virtual memory remains valid and it is backed by new zeroed pages
+ * as soon as the buffer is reused. If huge pages are enabled, the memory is kept.
+ * \param[in] pool Pool
+ * \param[in] hdr  Header of the buffer
+ */
+static void
+buf_trim(const struct ipx_buffer_pool *pool, struct buf_hdr *hdr)
+{
+    if (pool->arenas.hugepages) {
+        return;
+    }
+
+    const uintptr_t mask = (uintptr_t) pool->arenas.page_size - 1;
+    const uintptr_t buf_start = (uintptr_t) (hdr + 1);
+    const uintptr_t buf_end = buf_start + (((uintptr_t) CLASS_SIZE_MIN) << hdr->cls_idx);
+    const uintptr_t start = (buf_start + mask) & ~mask;
+    const uintptr_t end = buf_end & ~mask;
+    if (start < end) {
+        // Failure is not important, the memory is just kept
+        madvise((void *) start, end - start, MADV_DONTNEED);
+    }
+}
+
+/**
+ * \brief Trim the free-lists of a size class
+ *
+ * The class keeps enough free buffers to reach the high-water mark of buffers in use since
+ * the last trimming again, plus an arena worth of buffers. Physical
+ * memory of the remaining free buffers, i.e. the least recently returned ones, is released and
+ * the buffers are moved to the free-list of trimmed buffers, which is used only if other
+ * free-lists are empty.
+ * \param[in] pool Pool
+ * \param[in] cls  Size class
+ */
+static void
+class_trim(struct ipx_buffer_pool *pool, struct pool_class *cls)
+{
+    // Take all buffers returned by other threads (the most recently returned first)
+    struct buf_hdr *list = __atomic_exchange_n(&cls->returned, NULL, __ATOMIC_ACQUIRE);
+    struct buf_hdr *tail = NULL;
+    uint64_t list_cnt = 0;
+    for (struct buf_hdr *hdr = list; hdr != NULL; hdr = hdr->next) {
+        tail = hdr;
+        list_cnt++;
+    }
+    if (tail != NULL) {
+        tail->next = cls->local;
+        cls->local = list;
+        cls->local_cnt += list_cnt;
+    }
+
+    const uint64_t in_use = cls->slots - cls->local_cnt - cls->trimmed_cnt;
+    const uint64_t keep = ((cls->hwm > in_use) ? cls->hwm - in_use : 0)
+        + ARENA_SIZE / cls->slot_size;
+    cls->hwm = in_use;
+    cls->allocs = 0;
+    if (cls->local_cnt <= keep) {
+        return;
+    }
+
+    struct buf_hdr **pos = &cls->local;
+    for (uint64_t i = 0; i < keep; ++i) {
+        pos = &(*pos)->next;
+    }
+
+    struct buf_hdr *surplus = *pos;
+    *pos = NULL;
+    cls->local_cnt = keep;
+
+    while (surplus != NULL) {
+        struct buf_hdr *hdr = surplus;
+        surplus = hdr->next;
+
+        buf_trim(pool, hdr);
+        hdr->next = cls->trimmed;
+        cls->trimmed = hdr;
+        cls->trimmed_cnt++;
+    }
+}
+
+/**
+ * \brief Get a buffer of a size class if its local free-list is empty
+ *
+ * Buffers returned by other threads are preferred, then trimmed buffers and, finally, a new slot
+ * is taken from the arena. Since all returned buffers have been just taken, all other buffers
+ * are in use, therefore, the high-water mark of the class is updated here.
+ * \param[in] pool Pool
+ * \param[in] cls  Size class
+ * \param[in] cls_idx Index of the size class
+ * \return Header of the buffer or NULL (memory allocation error)
+ */
+static struct buf_hdr *
+class_refill(struct ipx_buffer_pool *pool, struct pool_class *cls, uint32_t cls_idx)
+{
+    assert(cls->local == NULL);
+    // Take all buffers returned by other threads
+    struct buf_hdr *hdr = __atomic_exchange_n(&cls->returned, NULL, __ATOMIC_ACQUIRE);
+    if (hdr != NULL) {
+        assert(hdr != POOL_CLOSED && hdr->pool == pool);
+        cls->local = hdr->next;
+        cls->local_cnt = list_len(hdr) - 1;
+    } else if (cls->trimmed != NULL) {
+        // Trimmed buffers are the last resort as they must be backed by new pages
+        hdr = cls->trimmed;
+        cls->trimmed = hdr->next;
+        cls->trimmed_cnt--;
+    } else {
+        // The free-lists are empty, take a new slot from the arena
+        if (!cls->arena || (cls->arena_used + 1) * cls->slot_size > ARENA_SIZE) {
+            if (!arena_add(pool, cls)) {
+                return NULL;
+            }
+        }
+
+        hdr = (struct buf_hdr *) (cls->arena + (cls->arena_used * cls->slot_size));
+        cls->arena_used++;
+        cls->slots++;
+        __atomic_add_fetch(&pool->refs, 1, __ATOMIC_RELAXED);
+
+        hdr->pool = pool;
+        hdr->cls_idx = cls_idx;
+    }
+
+    const uint64_t in_use = cls->slots - cls->local_cnt - cls->trimmed_cnt;
+    if (in_use > cls->hwm) {
+        cls->hwm = in_use;
+    }
+    return hdr;
+}
+
+uint8_t *
+ipx_buffer_pool_alloc(ipx_buffer_pool_t *pool, size_t size)
+{
+    if (size > IPX_BUFFER_POOL_SIZE_MAX) {
+        return NULL;
+    }
+
+    uint32_t cls_idx = 0;
+    while ((((size_t) CLASS_SIZE_MIN) << cls_idx) < size) {
+        cls_idx++;
+    }
+
+    struct pool_class *cls = &pool->classes[cls_idx];
+    struct buf_hdr *hdr = cls->local;
+    if (hdr != NULL) {
+        assert(hdr->pool == pool);
+        cls->local = hdr->next;
+        cls->local_cnt--;
+    } else if ((hdr = class_refill(pool, cls, cls_idx)) == NULL) {
+        return NULL;
+    }
+
+    hdr->next = NULL;
+    hdr->refs = 1;
+
+    if (++cls->allocs == TRIM_PERIOD) {
+        class_trim(pool, cls);
+    }
+    return (uint8_t *) (hdr + 1);
+}
+
+bool
+ipx_buffer_pool_owns(const ipx_buffer_pool_t *pool, const uint8_t *buffer)
+{
+    const uint8_t *arena = (const uint8_t *) ((uintptr_t) buffer & ~((uintptr_t) ARENA_SIZE - 1));
+    size_t lo = 0;
+    size_t hi = pool->arenas.cnt;
+
+    // Binary search in the sorted array of arenas
+    while (lo < hi) {
+        const size_t mid = lo + (hi - lo) / 2;
+        const uint8_t *item = pool->arenas.items[mid];
+        if (item == arena) {
+            return true;
+        }
+
+        if (item < arena) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    return false;
+}
+
+void
+ipx_buffer_pool_ref(uint8_t *buffer)
+{
+    struct buf_hdr *hdr = ((struct buf_hdr *) buffer) - 1;
+    __atomic_add_fetch(&hdr->refs, 1, __ATOMIC_RELAXED);
+}
+
+void
+ipx_buffer_pool_free(uint8_t *buffer)
+{
+    struct buf_hdr *hdr = ((struct buf_hdr *) buffer) - 1;
+    // The last reference is the most common case, avoid the atomic read-modify-write
+    if (__atomic_load_n(&hdr->refs, __ATOMIC_ACQUIRE) != 1
+            && __atomic_sub_fetch(&hdr->refs, 1, __ATOMIC_ACQ_REL) != 0) {
+        return;
+    }
+
+    struct ipx_buffer_pool *pool = hdr->pool;
+    struct pool_class *cls = &pool->classes[hdr->cls_idx];
+
+    struct buf_hdr *head = __atomic_load_n(&cls->returned, __ATOMIC_RELAXED);
+    do {
+        if (head == POOL_CLOSED) {
+            // The pool has been already destroyed
+            pool_release(pool, 1);
+            return;
+        }
+        hdr->next = head;
+    } while (!__atomic_compare_exchange_n(&cls->returned, &head, hdr, true,
+        __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+    // Note: The pool could have been freed by the owner here!
+}
@@ -0,0 +1,141 @@
+/**
+ * \file src/core/buffer_pool.h
+ * \brief Pool of buffers for raw IPFIX Messages (internal header file)
+ * \date 2026
+ */
+
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#ifndef IPFIXCOL_BUFFER_POOL_H
+#define IPFIXCOL_BUFFER_POOL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <ipfixcol2.h>
+
+/** Maximum size of a buffer that can be allocated from the pool (in bytes)                    */
+#define IPX_BUFFER_POOL_SIZE_MAX (65536U)
+
+/** Internal data type of the buffer pool */
+typedef struct ipx_buffer_pool ipx_buffer_pool_t;
+
+/**
+ * \brief Enable/disable huge pages for memory of newly created pools
+ *
+ * If enabled, the pool tries to allocate its memory from preallocated huge pages
+ * (i.e. MAP_HUGETLB). If it is not possible, the memory is allocated as usual and the kernel
+ * is only advised to use transparent huge pages. By default, huge pages are disabled.
+ * \param[in] en Enable/disable
+ */
+IPX_API void
+ipx_buffer_pool_hugepages_set(bool en);
+
+/**
+ * \brief Create a pool of buffers
+ *
+ * The pool provides buffers of a few size classes, up to #IPX_BUFFER_POOL_SIZE_MAX bytes.
+ * Memory of each class is divided into slots of large memory regions (arenas) that are never
+ * unmapped before the pool is destroyed. However, the free-lists of each class are periodically
+ * trimmed, i.e. physical memory of free buffers above the high-water mark of buffers in use
+ * since the previous trimming is returned to the system (unless huge pages are enabled).
+ *
+ * New buffers can be taken from the pool only by a single thread (i.e. the owner of the pool),
+ * however, the buffers can be returned by any thread.
+ * \return Pointer to the pool or NULL (memory allocation error)
+ */
+IPX_API ipx_buffer_pool_t *
+ipx_buffer_pool_create();
+
+/**
+ * \brief Destroy a pool of buffers
+ *
+ * Buffers that are still in use (e.g. referenced by messages in the pipeline) remain valid.
+ * Memory of the pool is released after the last of them is returned.
+ * \param[in] pool Pool to destroy
+ */
+IPX_API void
+ipx_buffer_pool_destroy(ipx_buffer_pool_t *pool);
+
+/**
+ * \brief Allocate a buffer
+ *
+ * \warning Only the owner of the pool can call this function.
+ * \param[in] pool Pool
+ * \param[in] size Required size of the buffer (in bytes)
+ * \return Pointer to the buffer
+ * \return NULL if the size exceeds #IPX_BUFFER_POOL_SIZE_MAX or a memory allocation error
+ *   has occurred
+ */
+IPX_API uint8_t *
+ipx_buffer_pool_alloc(ipx_buffer_pool_t *pool, size_t size);
+
+/**
+ * \brief Check if a buffer has been allocated by a pool
+ *
+ * The memory of the \p buffer is not accessed. Therefore, any valid pointer can be checked.
+ * \warning Only the owner of the pool can call this function.
+ * \param[in] pool   Pool
+ * \param[in] buffer Buffer to check
+ * \return True or false
+ */
+IPX_API bool
+ipx_buffer_pool_owns(const ipx_buffer_pool_t *pool, const uint8_t *buffer);
+
+/**
+ * \brief Add a reference to a buffer
+ *
+ * Each allocated buffer holds one reference. The buffer is returned to its pool after all
+ * references are released by ipx_buffer_pool_free(). Therefore, the buffer can be shared, for
+ * example, by multiple messages that refer to different parts of it.
+ * The function can be called by any thread that holds a reference.
+ * \warning The \p buffer MUST be allocated by a pool i.e. ipx_buffer_pool_alloc().
+ * \param[in] buffer Buffer
+ */
+IPX_API void
+ipx_buffer_pool_ref(uint8_t *buffer);
+
+/**
+ * \brief Release a reference to a buffer (and return it to its pool if it was the last one)
+ *
+ * The function can be called by any thread.
+ * \warning The \p buffer MUST be allocated by a pool i.e. ipx_buffer_pool_alloc().
+ * \param[in] buffer Buffer to return
+ */
+IPX_API void
+ipx_buffer_pool_free(uint8_t *buffer);
+
+#endif // IPFIXCOL_BUFFER_POOL_H
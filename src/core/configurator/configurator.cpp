@@ -49,6 +49,7 @@
 
 #include "configurator.hpp"
 #include "extensions.hpp"
+#include "instance_intermediate_mt.hpp"
 
 extern "C" {
 #include "../message_terminate.h"
@@ -56,6 +57,7 @@ extern "C" {
 #include "../plugin_output_mgr.h"
 #include "../verbose.h"
 #include "../context.h"
+#include "../tstore.h"
 #include "cpipe.h"
 }
 
@@ -96,6 +98,10 @@ ipx_configurator::ipx_configurator()
 {
     m_iemgr = nullptr;
     m_ring_size = RING_DEF_SIZE;
+    m_ring_type = IPX_RING_MUTEX;
+    m_hugepages = false;
+    m_stats_fmt = IPX_STATS_FMT_PROMETHEUS;
+    m_stats = nullptr;
 
     // Create a configuration pipe
     if (ipx_cpipe_init() != IPX_OK) {
@@ -231,6 +237,25 @@ ipx_configurator::set_buffer_size(uint32_t size)
     m_ring_size = size;
 }
 
+void
+ipx_configurator::set_buffer_type(enum ipx_ring_type type)
+{
+    m_ring_type = type;
+}
+
+void
+ipx_configurator::set_hugepages(bool en)
+{
+    m_hugepages = en;
+}
+
+void
+ipx_configurator::set_stats(const std::string &path, enum ipx_stats_fmt fmt)
+{
+    m_stats_path = path;
+    m_stats_fmt = fmt;
+}
+
 void
 ipx_configurator::startup(const ipx_config_model &model)
 {
@@ -241,6 +266,13 @@ ipx_configurator::startup(const ipx_config_model &model)
     IPX_INFO(comp_str, "Information Elements have been successfully loaded from '%s'.",
         m_iemgr_dir.c_str());
 
+    // All ring buffers created from now on will use the selected implementation
+    ipx_ring_type_set(m_ring_type);
+    // All pools of buffers created from now on will use the selected type of memory
+    ipx_buffer_pool_hugepages_set(m_hugepages);
+    // Measure time spent in plugins only if someone can read it
+    ipx_stats_timing_set(!m_stats_path.empty());
+
     // In case of an exception, smart pointers make sure that all instances are destroyed
     std::vector<std::unique_ptr<ipx_instance_output> > outputs;
     std::vector<std::unique_ptr<ipx_instance_intermediate> > inters;
@@ -254,12 +286,46 @@ ipx_configurator::startup(const ipx_config_model &model)
 
     for (const auto &inter : model.inters) {
         ipx_plugin_mgr::plugin_ref *ref = plugins.plugin_get(IPX_PT_INTERMEDIATE, inter.plugin);
-        inters.emplace_back(new ipx_instance_intermediate(inter.name, ref, m_ring_size));
+        if (inter.threads > 1) {
+            inters.emplace_back(new ipx_instance_intermediate_mt(inter.name, ref, m_ring_size,
+                inter.threads));
+        } else {
+            inters.emplace_back(new ipx_instance_intermediate(inter.name, ref, m_ring_size));
+        }
     }
 
     for (const auto &input : model.inputs) {
-        ipx_plugin_mgr::plugin_ref *ref = plugins.plugin_get(IPX_PT_INPUT, input.plugin);
-        inputs.emplace_back(new ipx_instance_input(input.name, ref, m_ring_size));
+        // All workers share the same template store (if enabled), saved once on release
+        std::shared_ptr<ipx_tstore_t> tstore;
+        if (!input.tstore_path.empty()) {
+            tstore.reset(ipx_tstore_create(input.name.c_str(), input.tstore_path.c_str(),
+                input.tstore_interval), [](ipx_tstore_t *store) {
+                    if (store != nullptr) {
+                        ipx_tstore_save(store);
+                        ipx_tstore_destroy(store);
+                    }
+                });
+            if (!tstore) {
+                throw std::runtime_error("Failed to create a template store of the instance '"
+                    + input.name + "'!");
+            }
+
+            // Failures are not fatal (templates will be received again)
+            ipx_tstore_load(tstore.get());
+        }
+
+        // Each worker is an independent replica of the instance with the same parameters
+        for (unsigned int id = 0; id < input.workers; ++id) {
+            ipx_plugin_mgr::plugin_ref *ref = plugins.plugin_get(IPX_PT_INPUT, input.plugin);
+            std::string name = input.name;
+            if (input.workers > 1) {
+                name += " (worker " + std::to_string(id) + ")";
+            }
+
+            inputs.emplace_back(new ipx_instance_input(name, ref, m_ring_size, input.parsers));
+            inputs.back()->set_worker(id, input.workers);
+            inputs.back()->set_tstore(tstore);
+        }
     }
 
     // Insert the output manager as the last intermediate plugin
@@ -287,6 +353,7 @@ ipx_configurator::startup(const ipx_config_model &model)
         if (cfg.odid_type != IPX_ODID_FILTER_NONE) {
             instance->set_filter(cfg.odid_type, cfg.odid_expression);
         }
+        instance->set_overflow(cfg.overflow);
 
         // Connect the output manager and the output instance
         output_manager->connect_to(*instance);
@@ -306,10 +373,12 @@ ipx_configurator::startup(const ipx_config_model &model)
         instance->init(cfg.params, m_iemgr, verbosity_str2level(cfg.verbosity));
     }
 
-    for (size_t i = 0; i < model.inputs.size(); ++i) {
-        ipx_instance_input *instance = inputs[i].get();
-        const ipx_plugin_input &cfg = model.inputs[i];
-        instance->init(cfg.params, m_iemgr, verbosity_str2level(cfg.verbosity));
+    size_t input_idx = 0; // Workers of each input instance are stored consecutively
+    for (const auto &cfg : model.inputs) {
+        for (unsigned int id = 0; id < cfg.workers; ++id) {
+            ipx_instance_input *instance = inputs[input_idx++].get();
+            instance->init(cfg.params, m_iemgr, verbosity_str2level(cfg.verbosity));
+        }
     }
 
     IPX_DEBUG(comp_str, "All instances have been successfully initialized.", '\0');
@@ -355,10 +424,52 @@ ipx_configurator::startup(const ipx_config_model &model)
     m_running_inputs = std::move(inputs);
     m_running_inter = std::move(inters);
     m_running_outputs = std::move(outputs);
+
+    if (!m_stats_path.empty()) {
+        stats_start();
+    }
+}
+
+/**
+ * @brief Register all running instances and start an endpoint of pipeline statistics
+ * @throw runtime_error if the endpoint cannot be started
+ */
+void
+ipx_configurator::stats_start()
+{
+    m_stats = ipx_stats_create();
+    if (!m_stats) {
+        throw std::runtime_error("Failed to create a collector of statistics (memory "
+            "allocation error)");
+    }
+
+    for (auto &input : m_running_inputs) {
+        input->stats_register(m_stats);
+    }
+    for (auto &inter : m_running_inter) {
+        inter->stats_register(m_stats);
+    }
+    for (auto &output : m_running_outputs) {
+        output->stats_register(m_stats);
+    }
+
+    if (ipx_stats_start(m_stats, m_stats_path.c_str(), m_stats_fmt, IPX_STATS_INTERVAL_DEF)
+            != IPX_OK) {
+        throw std::runtime_error("Failed to start the endpoint of statistics '" + m_stats_path
+            + "'");
+    }
+
+    IPX_INFO(comp_str, "Pipeline statistics are available at '%s'.", m_stats_path.c_str());
 }
 
 void ipx_configurator::cleanup()
 {
+    // The endpoint of statistics reads contexts of the instances, stop it first
+    if (m_stats) {
+        ipx_stats_destroy(m_stats);
+        m_stats = nullptr;
+    }
+
     // Wait for termination (destructor of smart pointers will call instance destructor)
     m_running_inputs.clear();
     m_running_inter.clear();
@@ -525,7 +636,7 @@ ipx_configurator::termination_stop_partly(const ipx_ctx_t *ctx)
     // Stop intermediate plugins
     for (auto &it : m_running_inter) {
         it->set_processing(false);
-        if (it->get_ctx() == ctx) {
+        if (it->has_ctx(ctx)) {
             return;
         }
     }
@@ -57,6 +57,7 @@
 extern "C" {
 #include <ipfixcol2.h>
 #include "../context.h"
+#include "../stats.h"
 }
 
 // Main configurator of the internal pipeline
@@ -91,6 +92,26 @@ public:
       */
      void
      set_buffer_size(uint32_t size);
+     /**
+      * @brief Define a type (implementation) of ring buffers
+      * @param[in] type Type
+      */
+     void
+     set_buffer_type(enum ipx_ring_type type);
+     /**
+      * @brief Enable/disable huge pages for pools of raw IPFIX Message buffers
+      * @param[in] en Enable/disable
+      */
+     void
+     set_hugepages(bool en);
+     /**
+      * @brief Define an endpoint of pipeline statistics
+      * @param[in] path Path to a periodically rewritten file or "unix:" + path to a socket
+      *   (empty string disables statistics)
+      * @param[in] fmt  Output format
+      */
+     void
+     set_stats(const std::string &path, enum ipx_stats_fmt fmt);
 
      /**
       * @brief Run the collector based on a configuration from the controller
@@ -118,8 +139,18 @@ private:
 
     /** Size of ring buffers                                                                   */
     uint32_t m_ring_size;
+    /** Type of ring buffers                                                                   */
+    enum ipx_ring_type m_ring_type;
+    /** Use huge pages for pools of raw IPFIX Message buffers                                  */
+    bool m_hugepages;
     /** Directory with definitions of Information Elements                                     */
     std::string m_iemgr_dir;
+    /** Endpoint of pipeline statistics (empty, if disabled)                                   */
+    std::string m_stats_path;
+    /** Output format of pipeline statistics                                                   */
+    enum ipx_stats_fmt m_stats_fmt;
+    /** Collector of pipeline statistics (can be nullptr)                                      */
+    ipx_stats_t *m_stats;
 
     /** Manager of Information Elements                                                        */
     fds_iemgr_t *m_iemgr;
@@ -144,6 +175,8 @@ private:
     startup(const ipx_config_model &model);
     void
     cleanup();
+    void
+    stats_start();
 
     bool
     termination_handle(const struct ipx_cpipe_req &req, ipx_controller *ctrl);
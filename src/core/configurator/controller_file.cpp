@@ -13,6 +13,7 @@
 #include <cstdlib>    // realpath
 #include <cstdio>     // fread, fseek
 #include <sys/stat.h> // stat
+#include <strings.h>  // strcasecmp
 
 #include "controller_file.hpp"
 
@@ -31,11 +32,16 @@ enum file_xml_nodes {
     IN_PLUGIN_PLUGIN,
     IN_PLUGIN_PARAMS,
     IN_PLUGIN_VERBOSITY,
+    IN_PLUGIN_PARSERS,
+    IN_PLUGIN_WORKERS,
+    IN_PLUGIN_TSTORE,
+    IN_PLUGIN_TSTORE_INTERVAL,
     // Intermediate plugin parameters
     INTER_PLUGIN_NAME,
     INTER_PLUGIN_PLUGIN,
     INTER_PLUGIN_PARAMS,
     INTER_PLUGIN_VERBOSITY,
+    INTER_PLUGIN_THREADS,
     // Output plugin parameters
     OUT_PLUGIN_NAME,
     OUT_PLUGIN_PLUGIN,
@@ -43,6 +49,7 @@ enum file_xml_nodes {
     OUT_PLUGIN_VERBOSITY,
     OUT_PLUGIN_ODID_ONLY,
     OUT_PLUGIN_ODID_EXCEPT,
+    OUT_PLUGIN_OVERFLOW,
 };
 
 /**
@@ -53,6 +60,11 @@ static const struct fds_xml_args args_instance_input[] = {
     FDS_OPTS_ELEM(IN_PLUGIN_NAME,      "name",       FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
     FDS_OPTS_ELEM(IN_PLUGIN_PLUGIN,    "plugin",     FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
     FDS_OPTS_ELEM(IN_PLUGIN_VERBOSITY, "verbosity",  FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(IN_PLUGIN_PARSERS,   "parsers",    FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(IN_PLUGIN_WORKERS,   "workers",    FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(IN_PLUGIN_TSTORE,    "templateStore", FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(IN_PLUGIN_TSTORE_INTERVAL, "templateStoreInterval", FDS_OPTS_T_UINT,
+        FDS_OPTS_P_OPT),
     FDS_OPTS_RAW( IN_PLUGIN_PARAMS,    "params",                        FDS_OPTS_P_OPT),
     FDS_OPTS_END
 };
@@ -74,6 +86,7 @@ static const struct fds_xml_args args_instance_inter[] = {
     FDS_OPTS_ELEM(INTER_PLUGIN_NAME,      "name",       FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
     FDS_OPTS_ELEM(INTER_PLUGIN_PLUGIN,    "plugin",     FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
     FDS_OPTS_ELEM(INTER_PLUGIN_VERBOSITY, "verbosity",  FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(INTER_PLUGIN_THREADS,   "threads",    FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
     FDS_OPTS_RAW( INTER_PLUGIN_PARAMS,    "params",                        FDS_OPTS_P_OPT),
     FDS_OPTS_END
 };
@@ -94,6 +107,7 @@ static const struct fds_xml_args args_instance_output[] = {
     FDS_OPTS_ELEM(OUT_PLUGIN_VERBOSITY,   "verbosity",  FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
     FDS_OPTS_ELEM(OUT_PLUGIN_ODID_EXCEPT, "odidExcept", FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
     FDS_OPTS_ELEM(OUT_PLUGIN_ODID_ONLY,   "odidOnly",   FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(OUT_PLUGIN_OVERFLOW,    "overflow",   FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
     FDS_OPTS_RAW( OUT_PLUGIN_PARAMS,      "params",                        FDS_OPTS_P_OPT),
     FDS_OPTS_END
 };
@@ -311,6 +325,27 @@ ipx_controller_file::parse_instance_input(fds_xml_ctx_t *ctx, ipx_config_model &
         case IN_PLUGIN_VERBOSITY:
             input.verbosity = content->ptr_string;
             break;
+        case IN_PLUGIN_PARSERS:
+            assert(content->type == FDS_OPTS_T_UINT);
+            // Out of range values are refused by the model
+            input.parsers = (content->val_uint > UINT_MAX)
+                ? UINT_MAX : (unsigned int) content->val_uint;
+            break;
+        case IN_PLUGIN_WORKERS:
+            assert(content->type == FDS_OPTS_T_UINT);
+            // Out of range values are refused by the model
+            input.workers = (content->val_uint > UINT_MAX)
+                ? UINT_MAX : (unsigned int) content->val_uint;
+            break;
+        case IN_PLUGIN_TSTORE:
+            input.tstore_path = content->ptr_string;
+            break;
+        case IN_PLUGIN_TSTORE_INTERVAL:
+            assert(content->type == FDS_OPTS_T_UINT);
+            // Out of range values are refused by the model
+            input.tstore_interval = (content->val_uint > UINT_MAX)
+                ? UINT_MAX : (unsigned int) content->val_uint;
+            break;
         case IN_PLUGIN_PARAMS:
             input.params = content->ptr_string;
             break;
@@ -347,6 +382,12 @@ ipx_controller_file::parse_instance_inter(fds_xml_ctx_t *ctx, ipx_config_model &
         case INTER_PLUGIN_VERBOSITY:
             inter.verbosity = content->ptr_string;
             break;
+        case INTER_PLUGIN_THREADS:
+            assert(content->type == FDS_OPTS_T_UINT);
+            // Out of range values are refused by the model
+            inter.threads = (content->val_uint > UINT_MAX)
+                ? UINT_MAX : (unsigned int) content->val_uint;
+            break;
         case INTER_PLUGIN_PARAMS:
             inter.params = content->ptr_string;
             break;
@@ -370,6 +411,7 @@ ipx_controller_file::parse_instance_output(fds_xml_ctx_t *ctx, ipx_config_model
 {
     struct ipx_plugin_output output;
     output.odid_type = IPX_ODID_FILTER_NONE; // default
+    output.overflow = IPX_OVERFLOW_BLOCK;    // default
     bool odid_set = false;
 
     const struct fds_xml_cont *content;
@@ -403,6 +445,18 @@ ipx_controller_file::parse_instance_output(fds_xml_ctx_t *ctx, ipx_config_model
                 break;
             }
             throw std::invalid_argument("Multiple definitions of <odidExcept>/<odidOnly>!");
+        case OUT_PLUGIN_OVERFLOW:
+            if (strcasecmp(content->ptr_string, "block") == 0) {
+                output.overflow = IPX_OVERFLOW_BLOCK;
+            } else if (strcasecmp(content->ptr_string, "drop-newest") == 0) {
+                output.overflow = IPX_OVERFLOW_DROP_NEWEST;
+            } else if (strcasecmp(content->ptr_string, "drop-oldest") == 0) {
+                output.overflow = IPX_OVERFLOW_DROP_OLDEST;
+            } else {
+                throw std::invalid_argument("Unknown overflow policy '"
+                    + std::string(content->ptr_string) + "' of the output instance!");
+            }
+            break;
         default:
             // Unexpected XML node within <output>!
             assert(false);
@@ -52,6 +52,7 @@
 extern "C" {
 #include <ipfixcol2.h>
 #include "../ring.h"
+#include "../stats.h"
 }
 
 /** Unique pointer type of an instance context */
@@ -157,6 +158,34 @@ public:
     set_processing(bool en) {
         ipx_ctx_processing_set(_ctx, en);
     }
+
+    /**
+     * \brief Register all contexts of the instance to a collector of statistics
+     *
+     * By default, only the context of the instance (without an input ring buffer) is registered.
+     * \param[in] stats Collector of statistics
+     * \throw runtime_error if the registration fails
+     */
+    virtual void
+    stats_register(ipx_stats_t *stats) {
+        stats_add(stats, _ctx, nullptr);
+    }
+
+protected:
+    /**
+     * \brief Register a context and its input ring buffer to a collector of statistics
+     * \param[in] stats Collector of statistics
+     * \param[in] ctx   Plugin context
+     * \param[in] ring  Input ring buffer of the context (can be nullptr)
+     * \throw runtime_error if the registration fails
+     */
+    void
+    stats_add(ipx_stats_t *stats, ipx_ctx_t *ctx, ipx_ring_t *ring) {
+        if (ipx_stats_register(stats, ctx, ring) != IPX_OK) {
+            throw std::runtime_error("Failed to register statistics of the instance '"
+                + _name + "'");
+        }
+    }
 };
 
 #endif //IPFIXCOL_INSTANCE_H
@@ -56,23 +56,45 @@ static const struct ipx_ctx_callbacks parser_callbacks = {
     &ipx_plugin_parser_destroy,
     nullptr, // No getter
     &ipx_plugin_parser_process,
-    nullptr  // No feedback
+    nullptr, // No feedback
+    nullptr, // No batch processing
+    &ipx_plugin_parser_idle
+};
+
+/** Description of the internal dispatcher of parser workers                                    */
+static const struct ipx_ctx_callbacks dispatcher_callbacks = {
+    // Static plugin, no library handles
+    nullptr,
+    &ipx_plugin_dispatcher_info,
+    // Only basic functions
+    &ipx_plugin_dispatcher_init,
+    &ipx_plugin_dispatcher_destroy,
+    nullptr, // No getter
+    &ipx_plugin_dispatcher_process,
+    nullptr, // No feedback
+    &ipx_plugin_dispatcher_process_batch,
+    nullptr  // No idle callback
 };
 
 ipx_instance_input::ipx_instance_input(const std::string &name, ipx_plugin_mgr::plugin_ref *ref,
-    uint32_t bsize) : ipx_instance(name, ref)
+    uint32_t bsize, unsigned int parsers) : ipx_instance(name, ref), _parser_list(nullptr),
+    _parser_shared(nullptr)
 {
     // Get the plugin callbacks
     const ipx_plugin_mgr::plugin *plugin = _plugin_ref->get_plugin();
     const struct ipx_ctx_callbacks *cbs = plugin->get_callbacks();
     assert(cbs != nullptr && plugin->get_type() == IPX_PT_INPUT);
 
-    // Create all components
-    std::string pname = name + " (parser)";
+    assert(parsers >= 1 && "At least one parser expected!");
+
+    // Create all components (multiple parsers are hidden behind a dispatcher)
+    const bool mt_parser = (parsers > 1);
+    std::string pname = name + (mt_parser ? " (parser dispatcher)" : " (parser)");
+    const struct ipx_ctx_callbacks *pcbs = mt_parser ? &dispatcher_callbacks : &parser_callbacks;
     unique_fpipe feedback(ipx_fpipe_create(), &ipx_fpipe_destroy);
     unique_ring  ring_wrap(ipx_ring_init(bsize, false), &ipx_ring_destroy);
     unique_ctx   input_wrap(ipx_ctx_create(name.c_str(), cbs), &ipx_ctx_destroy);
-    unique_ctx   parser_wrap(ipx_ctx_create(pname.c_str(), &parser_callbacks), &ipx_ctx_destroy);
+    unique_ctx   parser_wrap(ipx_ctx_create(pname.c_str(), pcbs), &ipx_ctx_destroy);
     if (!feedback || !ring_wrap || !parser_wrap || !input_wrap) {
         throw std::runtime_error("Failed to create components of an input instance!");
     }
@@ -83,9 +105,19 @@ ipx_instance_input::ipx_instance_input(const std::string &name, ipx_plugin_mgr::
     ipx_ctx_ring_src_set(parser_wrap.get(), ring_wrap.get());
 
     // If the input plugin supports processing of request to close a Transport Session
-    if (cbs->ts_close != nullptr) {
+    ipx_fpipe_t *parser_feedback = (cbs->ts_close != nullptr) ? feedback.get() : nullptr;
+    if (parser_feedback != nullptr && !mt_parser) {
         // Allow the parser sending request to close a Transport Session
-        ipx_ctx_fpipe_set(parser_wrap.get(), feedback.get());
+        ipx_ctx_fpipe_set(parser_wrap.get(), parser_feedback);
+    }
+
+    if (mt_parser) {
+        try {
+            parser_workers_create(parsers, bsize, parser_feedback);
+        } catch (...) {
+            parser_workers_destroy();
+            throw;
+        }
     }
 
     // Success
@@ -100,12 +132,80 @@ ipx_instance_input::~ipx_instance_input()
     // Destroy context (if running, wait for termination of threads)
     ipx_ctx_destroy(_ctx);
     ipx_ctx_destroy(_parser_ctx);
+    parser_workers_destroy();
 
     // Now we can destroy buffers
     ipx_fpipe_destroy(_input_feedback);
     ipx_ring_destroy(_parser_buffer);
 }
 
+/**
+ * \brief Create workers of the parser
+ *
+ * Each worker has its own input ring buffer, which is filled by the dispatcher of workers.
+ * \param[in] cnt      Number of workers
+ * \param[in] bsize    Size of the input ring buffer of each worker
+ * \param[in] feedback Feedback pipe to send requests to close a Transport Session (can be NULL)
+ * \throw runtime_error if any component fails to initialize
+ */
+void
+ipx_instance_input::parser_workers_create(unsigned int cnt, uint32_t bsize, ipx_fpipe_t *feedback)
+{
+    _parser_list = ipx_dispatcher_list_create();
+    _parser_shared = ipx_ctx_replicas_create();
+    if (!_parser_list || !_parser_shared) {
+        throw std::runtime_error("Failed to initialize a list of parser workers!");
+    }
+
+    for (unsigned int i = 0; i < cnt; ++i) {
+        const std::string wname = _name + " (parser#" + std::to_string(i) + ")";
+        unique_ring ring_wrap(ipx_ring_init(bsize, false), &ipx_ring_destroy);
+        unique_ctx  ctx_wrap(ipx_ctx_create(wname.c_str(), &parser_callbacks), &ipx_ctx_destroy);
+        if (!ring_wrap || !ctx_wrap) {
+            throw std::runtime_error("Failed to create components of a parser worker!");
+        }
+
+        if (ipx_dispatcher_list_add(_parser_list, ring_wrap.get()) != IPX_OK) {
+            throw std::runtime_error("Failed to add a parser worker to the list of workers!");
+        }
+
+        // Configure the components (connect them)
+        ipx_ctx_ring_src_set(ctx_wrap.get(), ring_wrap.get());
+        ipx_ctx_replica_set(ctx_wrap.get(), _parser_shared);
+        if (feedback != nullptr) {
+            ipx_ctx_fpipe_set(ctx_wrap.get(), feedback);
+        }
+
+        _parser_workers.push_back({ctx_wrap.release(), ring_wrap.release()});
+    }
+}
+
+/**
+ * \brief Destroy all workers of the parser (if any)
+ * \note If the threads are running, the function blocks until the threads are exited.
+ */
+void
+ipx_instance_input::parser_workers_destroy()
+{
+    for (auto &worker : _parser_workers) {
+        ipx_ctx_destroy(worker.ctx);
+    }
+
+    for (auto &worker : _parser_workers) {
+        ipx_ring_destroy(worker.ring);
+    }
+
+    _parser_workers.clear();
+    if (_parser_list != nullptr) {
+        ipx_dispatcher_list_destroy(_parser_list);
+        _parser_list = nullptr;
+    }
+    if (_parser_shared != nullptr) {
+        ipx_ctx_replicas_destroy(_parser_shared);
+        _parser_shared = nullptr;
+    }
+}
+
 void
 ipx_instance_input::init(const std::string &params, const fds_iemgr_t *iemgr, ipx_verb_level level)
 {
@@ -117,8 +217,23 @@ ipx_instance_input::init(const std::string &params, const fds_iemgr_t *iemgr, ip
     ipx_ctx_iemgr_set(_ctx, iemgr);
     ipx_ctx_verb_set(_parser_ctx, level);
     ipx_ctx_iemgr_set(_parser_ctx, iemgr);
+    for (auto &worker : _parser_workers) {
+        ipx_ctx_verb_set(worker.ctx, level);
+        ipx_ctx_iemgr_set(worker.ctx, iemgr);
+    }
 
     // Initialize
+    for (auto &worker : _parser_workers) {
+        if (ipx_ctx_init(worker.ctx, nullptr) != IPX_OK) {
+            throw std::runtime_error("Failed to initialize a worker of the IPFIX parser!");
+        }
+    }
+
+    if (_parser_list != nullptr) {
+        // The dispatcher of workers
+        ipx_ctx_private_set(_parser_ctx, _parser_list);
+    }
+
     if (ipx_ctx_init(_parser_ctx, nullptr) != IPX_OK) {
         throw std::runtime_error("Failed to initialize the parser of IPFIX Messages!");
     }
@@ -137,6 +252,12 @@ ipx_instance_input::start()
 
     /* FIXME: if the parser has stared but input plugin fails to start, stop the parser
      *        (probably by sending a termination message)                              */
+    for (auto &worker : _parser_workers) {
+        if (ipx_ctx_run(worker.ctx) != IPX_OK) {
+            throw std::runtime_error("Failed to start a thread of a parser worker.");
+        }
+    }
+
     if (ipx_ctx_run(_parser_ctx) != IPX_OK || ipx_ctx_run(_ctx) != IPX_OK) {
         throw std::runtime_error("Failed to start a thread of the input instance.");
     }
@@ -155,7 +276,15 @@ ipx_instance_input::connect_to(ipx_instance_intermediate &intermediate)
 {
     // Only configuration of uninitialized instances can be changed!
     assert(_state == state::NEW && intermediate._state == state::NEW);
-    ipx_ctx_ring_dst_set(_parser_ctx, intermediate.get_input());
+    if (_parser_workers.empty()) {
+        ipx_ctx_ring_dst_set(_parser_ctx, intermediate.get_input());
+    } else {
+        // All workers write into the same ring buffer
+        for (auto &worker : _parser_workers) {
+            ipx_ctx_ring_dst_set(worker.ctx, intermediate.get_input());
+        }
+        ipx_ring_mw_mode(intermediate.get_input(), true);
+    }
 
     intermediate._inputs_cnt++;
     if (intermediate._inputs_cnt > 1) {
@@ -170,6 +299,10 @@ ipx_instance_input::extensions_register(ipx_cfg_extensions *ext_mgr, size_t pos)
 {
     ext_mgr->register_instance(_ctx, pos);
     ext_mgr->register_instance(_parser_ctx, pos);
+    if (!_parser_workers.empty()) {
+        // All workers have the same configuration, register only one of them
+        ext_mgr->register_instance(_parser_workers.front().ctx, pos);
+    }
 }
 
 void
@@ -177,6 +310,9 @@ ipx_instance_input::extensions_resolve(ipx_cfg_extensions *ext_mgr)
 {
     ext_mgr->update_instance(_ctx);
     ext_mgr->update_instance(_parser_ctx);
+    for (auto &worker : _parser_workers) {
+        ext_mgr->update_instance(worker.ctx);
+    }
 }
 
 void
@@ -190,4 +326,40 @@ void
 ipx_instance_input::set_parser_processing(bool en)
 {
     ipx_ctx_processing_set(_parser_ctx, en);
+    for (auto &worker : _parser_workers) {
+        ipx_ctx_processing_set(worker.ctx, en);
+    }
+}
+
+void
+ipx_instance_input::set_worker(unsigned int id, unsigned int cnt)
+{
+    const struct ipx_plugin_info *info = _plugin_ref->get_plugin()->get_callbacks()->info;
+    if (cnt > 1 && (info->flags & IPX_PF_WORKERS) == 0) {
+        throw std::runtime_error("The plugin '" + std::string(info->name) + "' doesn't support "
+            "multiple workers!");
+    }
+
+    ipx_ctx_worker_set(_ctx, id, cnt);
+}
+
+void
+ipx_instance_input::set_tstore(std::shared_ptr<ipx_tstore_t> store)
+{
+    // The store must outlive all parser contexts (destroyed by the destructor)
+    _tstore = std::move(store);
+    ipx_ctx_tstore_set(_parser_ctx, _tstore.get());
+    for (auto &worker : _parser_workers) {
+        ipx_ctx_tstore_set(worker.ctx, _tstore.get());
+    }
+}
+
+void
+ipx_instance_input::stats_register(ipx_stats_t *stats)
+{
+    stats_add(stats, _ctx, nullptr);
+    stats_add(stats, _parser_ctx, _parser_buffer);
+    for (auto &worker : _parser_workers) {
+        stats_add(stats, worker.ctx, worker.ring);
+    }
 }
\ No newline at end of file
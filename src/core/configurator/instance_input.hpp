@@ -43,10 +43,13 @@
 #define IPFIXCOL_INSTANCE_INPUT_HPP
 
 #include <memory>
+#include <vector>
 #include "instance.hpp"
 
 extern "C" {
 #include "../fpipe.h"
+#include "../plugin_dispatcher.h"
+#include "../tstore.h"
 }
 
 /** Unique pointer type of a feedback pipe     */
@@ -79,6 +82,23 @@ using unique_fpipe = std::unique_ptr<ipx_fpipe_t, decltype(&ipx_fpipe_destroy)>;
  *                      +-------+      +--------+
  * \endverbatim
  *
+ * If the parser should run in multiple threads (workers), the parser context is replaced with
+ * a replica dispatcher (implemented as an internal plugin) that distributes IPFIX Messages among
+ * the workers based on their Transport Session and ODID. Therefore, each worker owns a disjoint
+ * partition of parser records (i.e. template managers) and no locking is required. The order
+ * of IPFIX Messages of the same Transport Session and ODID is preserved. Transport Session
+ * Messages are delivered to all workers and act as barriers, i.e. they are passed only once
+ * and after all preceding IPFIX Messages of all workers (see ipx_ctx_replica_set()).
+ *
+ * \verbatim
+ *                                                      +-----------+
+ *                      +-------+      +--------+  +----> Parser #0 +----+
+ *                      |       |      |        |  |    +-----------+    |
+ *          +-----------> Input +------> Disp.  +--+        ...          +----->
+ *             feedback |       | ring |        |  |    +-----------+    | (output not set yet)
+ *                      +-------+      +--------+  +----> Parser #N +----+
+ *                                                      +-----------+
+ * \endverbatim
  */
 class ipx_instance_input : public ipx_instance {
 protected:
@@ -87,9 +107,29 @@ protected:
 
     /** Ring buffer between the instance of an input plugin and instance of the parser           */
     ipx_ring_t  *_parser_buffer;
-    /** Instance of the parser plugin (internal)                                                 */
+    /** Instance of the parser plugin or the dispatcher of parser workers (internal)             */
     ipx_ctx_t   *_parser_ctx;
 
+    /** Worker of the parser (only if the parser runs in multiple threads)                       */
+    struct parser_worker {
+        /** Instance of the parser plugin (internal)                                             */
+        ipx_ctx_t *ctx;
+        /** Input ring buffer of the worker (written by the dispatcher)                          */
+        ipx_ring_t *ring;
+    };
+
+    /** Parser workers (empty if the parser runs in a single thread)                             */
+    std::vector<struct parser_worker> _parser_workers;
+    /** List of parser workers for the dispatcher (nullptr if there are no workers)              */
+    ipx_dispatcher_list_t *_parser_list;
+    /** Shared state of parser workers (nullptr if there are no workers)                         */
+    ipx_ctx_replicas_t *_parser_shared;
+    /** Template store of UDP sessions (can be shared by multiple workers, can be empty)         */
+    std::shared_ptr<ipx_tstore_t> _tstore;
+
+    void parser_workers_create(unsigned int cnt, uint32_t bsize, ipx_fpipe_t *feedback);
+    void parser_workers_destroy();
+
     // Disable copy constructors
     ipx_instance_input(const ipx_instance_input &) = delete;
     ipx_instance_input & operator=(const ipx_instance_input &) = delete;
@@ -102,11 +142,13 @@ public:
      *   The \p ref is plugin reference wrapper of the plugin. The wrapper helps to monitor number
      *   of plugins that use the plugin. The reference will be destroyed during this destruction
      *   of the object of this class.
-     * \param[in] name   Name of the instance
-     * \param[in] ref    Reference to the plugin (will be automatically delete on destroy)
-     * \param[in] bsize  Size of the ring buffer between the input instance and the parser instance
+     * \param[in] name    Name of the instance
+     * \param[in] ref     Reference to the plugin (will be automatically delete on destroy)
+     * \param[in] bsize   Size of the ring buffer between the input instance and the parser instance
+     * \param[in] parsers Number of parser workers (threads)
      */
-    ipx_instance_input(const std::string &name, ipx_plugin_mgr::plugin_ref *ref, uint32_t bsize);
+    ipx_instance_input(const std::string &name, ipx_plugin_mgr::plugin_ref *ref, uint32_t bsize,
+        unsigned int parsers = 1);
     /**
      * \brief Destroy the instance
      * \note
@@ -182,6 +224,38 @@ public:
      */
     void
     set_parser_processing(bool en);
+
+    /**
+     * \brief Set identification of the worker (if the instance is one of multiple workers)
+     *
+     * \note By default, the instance is the only worker.
+     * \see ipx_ctx_worker_get() for more details
+     * \param[in] id  Identification number of the worker
+     * \param[in] cnt Total number of workers
+     * \throw runtime_error if the plugin doesn't support multiple workers
+     */
+    void
+    set_worker(unsigned int id, unsigned int cnt);
+
+    /**
+     * \brief Set a template store of UDP sessions used by the parser (or parser workers)
+     *
+     * \note The store is shared by all workers of the instance and must be set before
+     *   initialization of the instance.
+     * \see ipx_parser_tstore_set() for more details
+     * \param[in] store Template store (can be empty)
+     */
+    void
+    set_tstore(std::shared_ptr<ipx_tstore_t> store);
+
+    /**
+     * \brief Register contexts of the plugin, the parser and parser workers to a collector of
+     *   statistics
+     * \param[in] stats Collector of statistics
+     * \throw runtime_error if the registration fails
+     */
+    void
+    stats_register(ipx_stats_t *stats) override;
 };
 
 #endif //IPFIXCOL_INSTANCE_INPUT_HPP
@@ -160,6 +160,25 @@ public:
     get_ctx() {
         return _ctx;
     }
+
+    /**
+     * \brief Check if the plugin context belongs to the instance
+     * \param[in] ctx Plugin context
+     */
+    virtual bool
+    has_ctx(const ipx_ctx_t *ctx) {
+        return _ctx == ctx;
+    }
+
+    /**
+     * \brief Register the context and the input ring buffer to a collector of statistics
+     * \param[in] stats Collector of statistics
+     * \throw runtime_error if the registration fails
+     */
+    void
+    stats_register(ipx_stats_t *stats) override {
+        stats_add(stats, _ctx, _instance_buffer);
+    }
 };
 
 #endif //IPFIXCOL_INSTANCE_INTERMEDIATE_HPP
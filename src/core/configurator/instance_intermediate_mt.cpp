@@ -0,0 +1,237 @@
+/**
+ * \file src/core/configurator/instance_intermediate_mt.cpp
+ * \brief Multi-threaded intermediate plugin instance wrapper (source file)
+ * \date 2026
+ */
+
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include "instance_intermediate_mt.hpp"
+
+/** Description of the internal replica dispatcher                                              */
+static const struct ipx_ctx_callbacks dispatcher_callbacks = {
+    // Static plugin, no library handles
+    nullptr,
+    &ipx_plugin_dispatcher_info,
+    // Only basic functions
+    &ipx_plugin_dispatcher_init,
+    &ipx_plugin_dispatcher_destroy,
+    nullptr, // No getter
+    &ipx_plugin_dispatcher_process,
+    nullptr, // No feedback
+    &ipx_plugin_dispatcher_process_batch,
+    nullptr  // No idle callback
+};
+
+ipx_instance_intermediate_mt::ipx_instance_intermediate_mt(const std::string &name,
+    ipx_plugin_mgr::plugin_ref *ref, uint32_t bsize, unsigned int threads)
+    : ipx_instance_intermediate(name, &dispatcher_callbacks, bsize), _list(nullptr),
+    _shared(nullptr)
+{
+    // The base class takes care of the plugin reference
+    _plugin_ref = ref;
+    assert(threads > 1 && "At least 2 replicas expected!");
+
+    // Get the plugin callbacks
+    const ipx_plugin_mgr::plugin *plugin = _plugin_ref->get_plugin();
+    const struct ipx_ctx_callbacks *cbs = plugin->get_callbacks();
+    assert(cbs != nullptr && plugin->get_type() == IPX_PT_INTERMEDIATE);
+
+    try {
+        _list = ipx_dispatcher_list_create();
+        _shared = ipx_ctx_replicas_create();
+        if (!_list || !_shared) {
+            throw std::runtime_error("Failed to initialize a list of replicas!");
+        }
+
+        for (unsigned int i = 0; i < threads; ++i) {
+            const std::string replica_name = _name + "#" + std::to_string(i);
+            unique_ring ring_wrap(ipx_ring_init(bsize, false), &ipx_ring_destroy);
+            unique_ctx ctx_wrap(ipx_ctx_create(replica_name.c_str(), cbs), &ipx_ctx_destroy);
+            if (!ring_wrap || !ctx_wrap) {
+                throw std::runtime_error("Failed to create components of a replica!");
+            }
+
+            if (ipx_dispatcher_list_add(_list, ring_wrap.get()) != IPX_OK) {
+                throw std::runtime_error("Failed to add a replica to the list of replicas!");
+            }
+
+            // Configure the components (connect them)
+            ipx_ctx_ring_src_set(ctx_wrap.get(), ring_wrap.get());
+            ipx_ctx_replica_set(ctx_wrap.get(), _shared);
+            _replicas.push_back({ctx_wrap.release(), ring_wrap.release()});
+        }
+    } catch (...) {
+        replicas_destroy();
+        throw;
+    }
+}
+
+ipx_instance_intermediate_mt::~ipx_instance_intermediate_mt()
+{
+    // The dispatcher must be terminated first
+    ipx_ctx_destroy(_ctx);
+    _ctx = nullptr;
+
+    // Now we can destroy the replicas
+    replicas_destroy();
+}
+
+/**
+ * \brief Destroy all replicas (contexts and ring buffers) and the list of replicas
+ *
+ * \note If the threads are running, the function blocks until the threads are exited.
+ */
+void
+ipx_instance_intermediate_mt::replicas_destroy()
+{
+    for (auto &rep : _replicas) {
+        ipx_ctx_destroy(rep.ctx);
+    }
+
+    for (auto &rep : _replicas) {
+        ipx_ring_destroy(rep.ring);
+    }
+
+    _replicas.clear();
+    if (_list != nullptr) {
+        ipx_dispatcher_list_destroy(_list);
+        _list = nullptr;
+    }
+    if (_shared != nullptr) {
+        ipx_ctx_replicas_destroy(_shared);
+        _shared = nullptr;
+    }
+}
+
+void
+ipx_instance_intermediate_mt::init(const std::string &params, const fds_iemgr_t *iemgr,
+    ipx_verb_level level)
+{
+    assert(iemgr != nullptr);
+    assert(_state == state::NEW); // Only not initialized instance can be initialized
+
+    // Initialize replicas
+    for (auto &rep : _replicas) {
+        ipx_ctx_verb_set(rep.ctx, level);
+        ipx_ctx_iemgr_set(rep.ctx, iemgr);
+
+        if (ipx_ctx_init(rep.ctx, params.c_str()) != IPX_OK) {
+            throw std::runtime_error("Failed to initialize a replica of the intermediate plugin!");
+        }
+    }
+
+    // Initialize the dispatcher (pass the list of replicas)
+    ipx_ctx_private_set(_ctx, _list);
+    ipx_instance_intermediate::init("", iemgr, level);
+}
+
+void
+ipx_instance_intermediate_mt::start()
+{
+    assert(_state == state::INITIALIZED); // Only initialized instances can start
+    for (auto &rep : _replicas) {
+        if (ipx_ctx_run(rep.ctx) != IPX_OK) {
+            throw std::runtime_error("Failed to start a thread of a replica of the intermediate "
+                "instance.");
+        }
+    }
+
+    // Start the dispatcher
+    ipx_instance_intermediate::start();
+}
+
+void
+ipx_instance_intermediate_mt::connect_to(ipx_instance_intermediate &intermediate)
+{
+    assert(_state == state::NEW); // Only configuration of an uninitialized instance can be changed!
+    ipx_ring_t *ring = intermediate.get_input();
+    for (auto &rep : _replicas) {
+        ipx_ctx_ring_dst_set(rep.ctx, ring);
+    }
+
+    // All replicas write to the same buffer
+    ipx_ring_mw_mode(ring, true);
+}
+
+void
+ipx_instance_intermediate_mt::extensions_register(ipx_cfg_extensions *ext_mgr, size_t pos)
+{
+    ext_mgr->register_instance(_replicas.front().ctx, pos);
+}
+
+void
+ipx_instance_intermediate_mt::extensions_resolve(ipx_cfg_extensions *ext_mgr)
+{
+    ext_mgr->update_instance(_ctx);
+    for (auto &rep : _replicas) {
+        ext_mgr->update_instance(rep.ctx);
+    }
+}
+
+void
+ipx_instance_intermediate_mt::set_processing(bool en)
+{
+    ipx_ctx_processing_set(_ctx, en);
+    for (auto &rep : _replicas) {
+        ipx_ctx_processing_set(rep.ctx, en);
+    }
+}
+
+bool
+ipx_instance_intermediate_mt::has_ctx(const ipx_ctx_t *ctx)
+{
+    if (ctx == _ctx) {
+        return true;
+    }
+
+    for (const auto &rep : _replicas) {
+        if (rep.ctx == ctx) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void
+ipx_instance_intermediate_mt::stats_register(ipx_stats_t *stats)
+{
+    ipx_instance_intermediate::stats_register(stats);
+    for (auto &rep : _replicas) {
+        stats_add(stats, rep.ctx, rep.ring);
+    }
+}
@@ -0,0 +1,184 @@
+/**
+ * \file src/core/configurator/instance_intermediate_mt.hpp
+ * \brief Multi-threaded intermediate plugin instance wrapper (header file)
+ * \date 2026
+ */
+
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#ifndef IPFIXCOL_INSTANCE_INTERMEDIATE_MT_HPP
+#define IPFIXCOL_INSTANCE_INTERMEDIATE_MT_HPP
+
+#include <vector>
+#include "instance_intermediate.hpp"
+
+extern "C" {
+#include "../plugin_dispatcher.h"
+}
+
+/**
+ * \brief Instance of an intermediate plugin running in multiple threads (replicas)
+ *
+ * The class takes care of (i.e. initialize, configure and destroy):
+ * - a plugin context of the replica dispatcher (implemented as an internal plugin)
+ * - an input ring buffer (inherited from the base class)
+ * - plugin contexts and input ring buffers of all replicas of the plugin instance
+ *
+ * Each replica is an independent instance of the plugin with the same configuration. The
+ * dispatcher passes IPFIX Messages of the same Transport Session and ODID always to the same
+ * replica, so their order is preserved. Other messages (Transport Session, Garbage, etc.) are
+ * passed to all replicas and only the last replica that processes them passes them further
+ * (see ipx_ctx_replica_set()). These messages act as barriers, i.e. they are never reordered
+ * with respect to IPFIX Messages. All replicas write into the same output ring buffer.
+ *
+ * \verbatim
+ *                              +---------+
+ *                        +-----> Inter#0 +-----+
+ *                  +------+    +---------+     |
+ *            +-----> Disp.|        ...         +----->
+ *             ring +------+    +---------+     | (output not set yet)
+ *                        +-----> Inter#N +-----+
+ *                              +---------+
+ * \endverbatim
+ */
+class ipx_instance_intermediate_mt : public ipx_instance_intermediate {
+private:
+    /** Replica of the plugin instance                                                           */
+    struct replica {
+        /** Plugin context                                                                       */
+        ipx_ctx_t *ctx;
+        /** Input ring buffer (written by the dispatcher)                                        */
+        ipx_ring_t *ring;
+    };
+
+    /** Replicas of the plugin instance                                                          */
+    std::vector<struct replica> _replicas;
+    /** List of replicas for the dispatcher                                                      */
+    ipx_dispatcher_list_t *_list;
+    /** Shared state of the replicas (ordering of shared messages)                               */
+    ipx_ctx_replicas_t *_shared;
+
+    void replicas_destroy();
+public:
+    /**
+     * \brief Create an instance of an intermediate plugin with multiple replicas
+     *
+     * \note
+     *   The \p ref is plugin reference wrapper of the plugin. The wrapper helps to monitor number
+     *   of plugins that use the plugin. The reference will be destroyed during this destruction
+     *   of the object of this class.
+     * \param[in] name    Name of the instance
+     * \param[in] ref     Reference to the plugin (will be automatically delete on destroy)
+     * \param[in] bsize   Size of the input ring buffer (and ring buffers of the replicas)
+     * \param[in] threads Number of replicas (at least 2)
+     * \throw runtime_error if any component fails to initialize
+     */
+    ipx_instance_intermediate_mt(const std::string &name, ipx_plugin_mgr::plugin_ref *ref,
+        uint32_t bsize, unsigned int threads);
+
+    /**
+     * \brief Destroy the instance
+     * \note
+     *   If the threads are running (start() has been called), the function blocks until the
+     *   threads are exited.
+     */
+    ~ipx_instance_intermediate_mt();
+
+    // Disable copy constructors
+    ipx_instance_intermediate_mt(const ipx_instance_intermediate_mt &) = delete;
+    ipx_instance_intermediate_mt &operator=(const ipx_instance_intermediate_mt &) = delete;
+
+    /**
+     * \brief Initialize the instance
+     *
+     * Initialize the dispatcher and all replicas of the plugin.
+     * \note
+     *   The instance MUST be connected connect_to() to an intermediate plugin before initialization
+     * \param[in] params XML parameters of the instance
+     * \param[in] iemgr  Reference to the manager of Information Elements
+     * \param[in] level  Verbosity level
+     * \throw runtime_error if the function fails to initialize all components
+     */
+    void init(const std::string &params, const fds_iemgr_t *iemgr, ipx_verb_level level) override;
+
+    /**
+     * \brief Start threads of all replicas and the dispatcher
+     * \throw runtime_error if a thread fails to the start
+     */
+    void start() override;
+
+    /**
+     * \brief Connect all replicas to another instance of an intermediate plugin
+     * \note Multi-writer mode of the input ring buffer of the \p intermediate is enabled.
+     * \param[in] intermediate Intermediate plugin to receive our messages
+     */
+    void connect_to(ipx_instance_intermediate &intermediate) override;
+
+    /**
+     * \brief Registered extensions and dependencies
+     * \note All replicas have the same configuration, therefore, only one of them is registered.
+     * \param[in] ext_mgr Extension manager
+     * \param[in] pos     Position of the instance in the collector pipeline
+     */
+    void extensions_register(ipx_cfg_extensions *ext_mgr, size_t pos) override;
+
+    /**
+     * \brief Resolve definition of the extension/dependency definitions of all replicas
+     * \param[in] ext_mgr Extension manager
+     */
+    void extensions_resolve(ipx_cfg_extensions *ext_mgr) override;
+
+    /**
+     * \brief Enable/disable processing of data messages by all replicas
+     * \param[in] en Enable/disable processing
+     */
+    void set_processing(bool en) override;
+
+    /**
+     * \brief Check if the context belongs to the instance (i.e. dispatcher or replica)
+     * \param[in] ctx Plugin context
+     */
+    bool has_ctx(const ipx_ctx_t *ctx) override;
+
+    /**
+     * \brief Register contexts of the dispatcher and all replicas to a collector of statistics
+     * \param[in] stats Collector of statistics
+     * \throw runtime_error if the registration fails
+     */
+    void stats_register(ipx_stats_t *stats) override;
+};
+
+#endif //IPFIXCOL_INSTANCE_INTERMEDIATE_MT_HPP
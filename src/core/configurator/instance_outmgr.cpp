@@ -55,7 +55,9 @@ static const struct ipx_ctx_callbacks output_mgr_callbacks = {
     &ipx_plugin_output_mgr_destroy,
     nullptr, // No getter
     &ipx_plugin_output_mgr_process,
-    nullptr  // No feedback
+    nullptr, // No feedback
+    nullptr, // No batch processing
+    &ipx_plugin_output_mgr_idle
 };
 
 
@@ -108,8 +110,13 @@ ipx_instance_outmgr::connect_to(ipx_instance_output &output)
     ipx_ring_t *ring = std::get<0>(connection);
     enum ipx_odid_filter_type filter_type = std::get<1>(connection);
     const ipx_orange_t *filter = std::get<2>(connection);
+    enum ipx_overflow_policy overflow = output.get_overflow();
 
-    if (ipx_output_mgr_list_add(_list, ring, filter_type, filter) != IPX_OK) {
+    if (ipx_output_mgr_list_add(_list, ring, filter_type, filter, overflow,
+            output.get_name().c_str()) != IPX_OK) {
         throw std::runtime_error("Failed to connect an output instance to the output manager!");
     }
+
+    // The destination has been appended to the end of the list
+    output.set_manager(_list, ipx_output_mgr_list_size(_list) - 1);
 }
\ No newline at end of file
@@ -64,6 +64,9 @@ ipx_instance_output::ipx_instance_output(const std::string &name,
     // Default parameters
     _type = IPX_ODID_FILTER_NONE;
     _filter = nullptr;
+    _overflow = IPX_OVERFLOW_BLOCK;
+    _mgr_list = nullptr;
+    _mgr_idx = 0;
 }
 
 ipx_instance_output::~ipx_instance_output()
@@ -109,6 +112,13 @@ ipx_instance_output::set_filter(ipx_odid_filter_type type, const std::string &ex
     _filter = filter_wrap.release();
 }
 
+void
+ipx_instance_output::set_overflow(enum ipx_overflow_policy policy)
+{
+    assert(_state == state::NEW); // Only configuration of an uninitialized instance can be changed!
+    _overflow = policy;
+}
+
 void ipx_instance_output::init(const std::string &params, const fds_iemgr_t *iemgr,
     ipx_verb_level level)
 {
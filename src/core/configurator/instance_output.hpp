@@ -47,6 +47,7 @@
 
 extern "C" {
 #include "../odid_range.h"
+#include "../plugin_output_mgr.h"
 }
 
 /** Unique pointer type of an ODID filter      */
@@ -77,6 +78,12 @@ protected:
     enum ipx_odid_filter_type _type;
     /** ODID filter (nullptr, if type == IPX_ODID_FILTER_NONE                                    */
     ipx_orange_t *_filter;
+    /** Policy applied by the output manager if the input ring buffer is full                   */
+    enum ipx_overflow_policy _overflow;
+    /** List of the output manager that feeds the instance (nullptr, if not connected)          */
+    const ipx_output_mgr_list_t *_mgr_list;
+    /** Index of the instance in the list of the output manager                                 */
+    size_t _mgr_idx;
 public:
     /**
      * \brief Create an instance of an output plugin
@@ -110,6 +117,31 @@ public:
      */
     void set_filter(ipx_odid_filter_type type, const std::string &expr);
 
+    /**
+     * \brief Set overflow policy of the input ring buffer (#IPX_OVERFLOW_BLOCK by default)
+     * \param[in] policy Overflow policy
+     */
+    void set_overflow(enum ipx_overflow_policy policy);
+
+    /**
+     * \brief Get overflow policy of the input ring buffer
+     */
+    enum ipx_overflow_policy
+    get_overflow() {
+        return _overflow;
+    }
+
+    /**
+     * \brief Set the output manager that feeds the instance (for statistics of dropped messages)
+     * \param[in] list List of destinations of the output manager
+     * \param[in] idx  Index of the instance in the list
+     */
+    void
+    set_manager(const ipx_output_mgr_list_t *list, size_t idx) {
+        _mgr_list = list;
+        _mgr_idx = idx;
+    }
+
     /**
      * \brief Initialize the instance
      *
@@ -137,6 +169,28 @@ public:
      */
     std::tuple<ipx_ring_t *, enum ipx_odid_filter_type, const ipx_orange_t *>
     get_input();
+
+    /**
+     * \brief Register the context and the input ring buffer to a collector of statistics
+     *
+     * If the instance is connected to the output manager, numbers of messages dropped due to
+     * the overflow policy are registered too.
+     * \param[in] stats Collector of statistics
+     * \throw runtime_error if the registration fails
+     */
+    void
+    stats_register(ipx_stats_t *stats) override {
+        if (!_mgr_list) {
+            stats_add(stats, _ctx, _instance_buffer);
+            return;
+        }
+
+        if (ipx_stats_register_output(stats, _ctx, _instance_buffer, _mgr_list, _mgr_idx)
+                != IPX_OK) {
+            throw std::runtime_error("Failed to register statistics of the instance '"
+                + _name + "'");
+        }
+    }
 };
 
 #endif //IPFIXCOL_INSTANCE_OUTPUT_HPP
@@ -93,6 +93,27 @@ ipx_config_model::add_instance(struct ipx_plugin_input &instance)
 {
     // Check parameters and name collisions
     check_common(&instance);
+    if (instance.parsers < 1 || instance.parsers > IPX_PLUGIN_INPUT_PARSERS_MAX) {
+        throw std::invalid_argument("Number of parsers ('<parsers>') of the instance '"
+            + instance.name + "' must be in range 1.."
+            + std::to_string(IPX_PLUGIN_INPUT_PARSERS_MAX) + "!");
+    }
+    if (instance.workers < 1 || instance.workers > IPX_PLUGIN_INPUT_WORKERS_MAX) {
+        throw std::invalid_argument("Number of workers ('<workers>') of the instance '"
+            + instance.name + "' must be in range 1.."
+            + std::to_string(IPX_PLUGIN_INPUT_WORKERS_MAX) + "!");
+    }
+    if (instance.tstore_interval > IPX_PLUGIN_INPUT_TSTORE_INTERVAL_MAX) {
+        throw std::invalid_argument("Interval of the template store ('<templateStoreInterval>') "
+            "of the instance '" + instance.name + "' must be in range 0.."
+            + std::to_string(IPX_PLUGIN_INPUT_TSTORE_INTERVAL_MAX) + "!");
+    }
+    if (instance.tstore_interval != 0 && instance.tstore_path.empty()) {
+        throw std::invalid_argument("Interval of the template store ('<templateStoreInterval>') "
+            "of the instance '" + instance.name + "' requires a path to the store "
+            "('<templateStore>')!");
+    }
+
     for (struct ipx_plugin_input &input : inputs) {
         if (instance.name != input.name) {
             continue;
@@ -110,6 +131,12 @@ ipx_config_model::add_instance(struct ipx_plugin_inter &instance)
 {
     // Check parameters and name collisions
     check_common(&instance);
+    if (instance.threads < 1 || instance.threads > IPX_PLUGIN_INTER_THREADS_MAX) {
+        throw std::invalid_argument("Number of threads ('<threads>') of the instance '"
+            + instance.name + "' must be in range 1.."
+            + std::to_string(IPX_PLUGIN_INTER_THREADS_MAX) + "!");
+    }
+
     for (struct ipx_plugin_inter &inter : inters) {
         if (instance.name != inter.name) {
             continue;
@@ -151,7 +178,17 @@ ipx_config_model::dump()
     // Input plugins
     std::cout << "Input plugins:\n";
     for (auto &in : inputs) {
-        std::cout << "\t- " << in.plugin << " / " << in.name << "\n";
+        std::cout << "\t- " << in.plugin << " / " << in.name;
+        if (in.parsers > 1) {
+            std::cout << " (parsers: " << in.parsers << ")";
+        }
+        if (in.workers > 1) {
+            std::cout << " (workers: " << in.workers << ")";
+        }
+        if (!in.tstore_path.empty()) {
+            std::cout << " (template store: " << in.tstore_path << ")";
+        }
+        std::cout << "\n";
     }
 
     if (inputs.empty()) {
@@ -163,7 +200,11 @@ ipx_config_model::dump()
     // Intermediate plugins
     std::cout << "Intermediate plugins:\n";
     for (auto &inter : inters) {
-        std::cout << "\t- " << inter.plugin << " / " << inter.name << "\n";
+        std::cout << "\t- " << inter.plugin << " / " << inter.name;
+        if (inter.threads > 1) {
+            std::cout << " (threads: " << inter.threads << ")";
+        }
+        std::cout << "\n";
     }
 
     if (inters.empty()) {
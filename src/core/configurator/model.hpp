@@ -47,6 +47,7 @@
 
 extern "C" {
 #include "../odid_range.h"
+#include "../plugin_output_mgr.h"
 }
 
 /** Common plugin configuration parameters                                  */
@@ -61,11 +62,33 @@ struct ipx_plugin_base {
     std::string verbosity;
 };
 
+/** Maximal number of parser workers of an input instance                      */
+#define IPX_PLUGIN_INPUT_PARSERS_MAX 64U
+/** Maximal number of workers (i.e. parallel replicas) of an input instance   */
+#define IPX_PLUGIN_INPUT_WORKERS_MAX 64U
+/** Maximal interval of periodic saving of a template store (in seconds)      */
+#define IPX_PLUGIN_INPUT_TSTORE_INTERVAL_MAX 86400U
+
 /** Configuration of an input plugin                                          */
-struct ipx_plugin_input  : ipx_plugin_base {};
+struct ipx_plugin_input  : ipx_plugin_base {
+    /** Number of threads of the NetFlow/IPFIX Message parser                 */
+    unsigned int parsers = 1;
+    /** Number of workers (i.e. parallel replicas of the instance)            */
+    unsigned int workers = 1;
+    /** Path to the template store of UDP sessions (if empty, disabled)        */
+    std::string tstore_path;
+    /** Interval of periodic saving of the template store (0 = on exit only)   */
+    unsigned int tstore_interval = 0;
+};
+
+/** Maximal number of threads (replicas) of an intermediate instance          */
+#define IPX_PLUGIN_INTER_THREADS_MAX 64U
 
 /** Configuration of an intermediate plugin                                   */
-struct ipx_plugin_inter  : ipx_plugin_base {};
+struct ipx_plugin_inter  : ipx_plugin_base {
+    /** Number of threads (i.e. parallel replicas of the instance)            */
+    unsigned int threads = 1;
+};
 
 /** Configuration of an output plugin                                         */
 struct ipx_plugin_output : ipx_plugin_base {
@@ -73,6 +96,8 @@ struct ipx_plugin_output : ipx_plugin_base {
     enum ipx_odid_filter_type odid_type;
     /** ODID filter expression                                                */
     std::string odid_expression;
+    /** Overflow policy of the input ring buffer                              */
+    enum ipx_overflow_policy overflow;
 };
 
 /** Parsed configuration of the collector                                      */
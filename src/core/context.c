@@ -46,6 +46,7 @@
 #include <errno.h>
 #include <signal.h>
 #include <sys/prctl.h>
+#include <time.h>
 
 #include "context.h"
 #include "extension.h"
@@ -54,11 +55,21 @@
 #include "fpipe.h"
 #include "ring.h"
 #include "message_ipfix.h"
+#include "message_base.h"
+#include "stats.h"
 #include "configurator/cpipe.h"
 
 /** Identification of this component (for log) */
 const char *comp_str = "Context";
 
+/** Internal plugins that distribute messages to multiple ring buffers (without output ring) */
+#define CTX_TYPE_DISTRIBUTOR(type) ((type) == IPX_PT_OUTPUT_MGR || (type) == IPX_PT_DISPATCHER)
+
+/** Maximal number of messages that an instance thread takes from its input ring buffer at once */
+#define CTX_BATCH_SIZE (64U)
+/** Time without messages after which an instance thread calls the idle callback (milliseconds)  */
+#define CTX_IDLE_TIMEOUT (100U)
+
 /** List of permissions */
 enum ipx_ctx_permissions {
     /** Permission to pass a message              */
@@ -77,13 +88,28 @@ enum ipx_ctx_state {
     IPX_CS_RUNNING
 };
 
+/**
+ * \brief Shared state of replicas of an intermediate instance
+ *
+ * All replicas receive shared messages in the same order, therefore, the N-th shared message
+ * of one replica is the N-th shared message of any other replica.
+ */
+struct ipx_ctx_replicas {
+    /** Number of shared messages already passed (or destroyed) by the last replica           */
+    uint64_t passed;
+    /** Mutex protecting the number of messages (readers may check it atomically)             */
+    pthread_mutex_t mutex;
+    /** Condition variable signaled whenever the number of passed messages is increased        */
+    pthread_cond_t cond;
+};
+
 /**
  * \brief Context a plugin instance
  */
 struct ipx_ctx {
     /** Instance identification name (usually from startup configuration)                        */
     char *name;
-    /** Plugin type (#IPX_PT_INPUT, #IPX_PT_INTERMEDIATE, #IPX_PT_OUTPUT or #IPX_PT_OUTPUT_MGR)  */
+    /** Plugin type (#IPX_PT_INPUT, #IPX_PT_INTERMEDIATE, #IPX_PT_OUTPUT or internal types)    */
     uint16_t type;
     /** Permission flags (see #ipx_ctx_permissions)                                              */
     uint32_t permissions;
@@ -154,6 +180,16 @@ struct ipx_ctx {
          * the input plugins MUST have the value corresponding to the number of input instances.
          */
         unsigned int term_msg_cnt;
+        /** Replica mode (shared messages are passed only by the last replica, can be NULL)      */
+        struct ipx_ctx_replicas *replicas;
+        /** Number of shared messages released by this replica                                   */
+        uint64_t replica_seq;
+        /** Identification number of the worker of an input instance                            */
+        unsigned int worker_id;
+        /** Total number of workers of an input instance                                         */
+        unsigned int worker_cnt;
+        /** Template store of UDP sessions (only for parsers, can be NULL)                       */
+        ipx_tstore_t *tstore;
     } cfg_system; /**< System configuration                                                      */
 
     struct {
@@ -162,6 +198,16 @@ struct ipx_ctx {
         /** Size of extension definitions in the array                                           */
         size_t items_cnt;
     } cfg_extension; /**< Extension configuration                                                */
+
+    /** Pool of IPFIX Message wrappers (only for input instances, otherwise NULL)               */
+    ipx_msg_ipfix_pool_t *msg_pool;
+    /** Pool of buffers for raw IPFIX Messages (only for input instances, otherwise NULL)       */
+    ipx_buffer_pool_t *buffer_pool;
+
+    /** Statistics of the instance (modified only by the thread of the instance)                 */
+    struct ipx_stats_ctx stats;
+    /** Measure time spent inside the plugin functions (read-only after start of the thread)     */
+    bool stats_timing;
 };
 
 ipx_ctx_t *
@@ -189,9 +235,17 @@ ipx_ctx_create(const char *name, const struct ipx_ctx_callbacks *callbacks)
     ctx->cfg_system.msg_mask_selected = 0; // No messages to process selected
     ctx->cfg_system.msg_mask_allowed = IPX_MSG_IPFIX | IPX_MSG_SESSION;
     ctx->cfg_system.term_msg_cnt = 1; // By default, wait for 1 termination message
+    ctx->cfg_system.replicas = NULL;
+    ctx->cfg_system.replica_seq = 0;
+    ctx->cfg_system.worker_id = 0;
+    ctx->cfg_system.worker_cnt = 1;
+    ctx->cfg_system.tstore = NULL;
 
     ctx->cfg_extension.items = NULL;
     ctx->cfg_extension.items_cnt = 0;
+    ctx->msg_pool = NULL;
+    ctx->buffer_pool = NULL;
+    ctx->stats_timing = false;
 
     if (callbacks == NULL) {
         // Dummy context for testing
@@ -238,10 +292,92 @@ ipx_ctx_destroy(ipx_ctx_t *ctx)
     }
     free(ctx->cfg_extension.items);
 
+    if (ctx->msg_pool != NULL) {
+        // Wrappers of messages still in the pipeline are freed later
+        ipx_msg_ipfix_pool_destroy(ctx->msg_pool);
+    }
+    if (ctx->buffer_pool != NULL) {
+        ipx_buffer_pool_destroy(ctx->buffer_pool);
+    }
+
     free(ctx->name);
     free(ctx);
 }
 
+ipx_msg_ipfix_pool_t *
+ipx_ctx_msg_pool_get(const ipx_ctx_t *ctx)
+{
+    return ctx->msg_pool;
+}
+
+ipx_buffer_pool_t *
+ipx_ctx_buffer_pool_get(const ipx_ctx_t *ctx)
+{
+    return ctx->buffer_pool;
+}
+
+struct ipx_stats_ctx *
+ipx_ctx_stats_get(ipx_ctx_t *ctx)
+{
+    return &ctx->stats;
+}
+
+/**
+ * \brief Update statistics of messages passing through the instance
+ *
+ * \note Must be called only by the thread of the instance before the message is passed on.
+ * \param[in] flow Counters to update
+ * \param[in] msg  Message
+ */
+static inline void
+ctx_stats_msg(struct ipx_stats_flow *flow, ipx_msg_t *msg)
+{
+    ipx_stats_cnt_add(&flow->msgs, 1);
+    if (ipx_msg_get_type(msg) != IPX_MSG_IPFIX) {
+        return;
+    }
+
+    const struct ipx_msg_ipfix *ipfix = (const struct ipx_msg_ipfix *) msg;
+    ipx_stats_cnt_add(&flow->recs, ipfix->rec_info.cnt_valid);
+    ipx_stats_cnt_add(&flow->bytes, ipfix->raw_size);
+}
+
+/**
+ * \brief Prepare a call of a plugin function (getter/processing)
+ * \param[in] ctx Plugin context
+ * \return Timestamp of the beginning of the call (0 if timing is disabled)
+ */
+static inline uint64_t
+ctx_stats_call_begin(const struct ipx_ctx *ctx)
+{
+    if (!ctx->stats_timing) {
+        return 0;
+    }
+
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000U + (uint64_t) ts.tv_nsec;
+}
+
+/**
+ * \brief Finish a call of a plugin function (getter/processing) and update statistics
+ * \param[in] ctx   Plugin context
+ * \param[in] begin Timestamp returned by ctx_stats_call_begin()
+ */
+static inline void
+ctx_stats_call_end(struct ipx_ctx *ctx, uint64_t begin)
+{
+    ipx_stats_cnt_add(&ctx->stats.calls, 1);
+    if (!ctx->stats_timing) {
+        return;
+    }
+
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    const uint64_t end = (uint64_t) ts.tv_sec * 1000000000U + (uint64_t) ts.tv_nsec;
+    ipx_stats_cnt_add(&ctx->stats.time_ns, end - begin);
+}
+
 size_t
 ipx_ctx_recsize_get(const ipx_ctx_t *ctx)
 {
@@ -264,6 +400,15 @@ ipx_ctx_name_get(const ipx_ctx_t *ctx)
     return ctx->name;
 }
 
+void
+ipx_ctx_worker_get(const ipx_ctx_t *ctx, unsigned int *id, unsigned int *cnt)
+{
+    if (id != NULL) {
+        *id = ctx->cfg_system.worker_id;
+    }
+    *cnt = ctx->cfg_system.worker_cnt;
+}
+
 enum ipx_verb_level
 ipx_ctx_verb_get(const ipx_ctx_t *ctx)
 {
@@ -287,6 +432,189 @@ ipx_ctx_term_cnt_set(ipx_ctx_t *ctx, unsigned int cnt)
     return IPX_OK;
 }
 
+ipx_ctx_replicas_t *
+ipx_ctx_replicas_create()
+{
+    struct ipx_ctx_replicas *replicas = calloc(1, sizeof(*replicas));
+    if (!replicas) {
+        IPX_ERROR(comp_str, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+        return NULL;
+    }
+
+    int rc;
+    if ((rc = pthread_mutex_init(&replicas->mutex, NULL)) != 0) {
+        IPX_ERROR(comp_str, "pthread_mutex_init() failed! (%s:%d, err: %d)", __FILE__, __LINE__,
+            rc);
+        free(replicas);
+        return NULL;
+    }
+
+    if ((rc = pthread_cond_init(&replicas->cond, NULL)) != 0) {
+        IPX_ERROR(comp_str, "pthread_cond_init() failed! (%s:%d, err: %d)", __FILE__, __LINE__,
+            rc);
+        pthread_mutex_destroy(&replicas->mutex);
+        free(replicas);
+        return NULL;
+    }
+
+    replicas->passed = 0;
+    return replicas;
+}
+
+void
+ipx_ctx_replicas_destroy(ipx_ctx_replicas_t *replicas)
+{
+    pthread_cond_destroy(&replicas->cond);
+    pthread_mutex_destroy(&replicas->mutex);
+    free(replicas);
+}
+
+void
+ipx_ctx_replica_set(ipx_ctx_t *ctx, ipx_ctx_replicas_t *replicas)
+{
+    ctx->cfg_system.replicas = replicas;
+    ctx->cfg_system.replica_seq = 0;
+}
+
+void
+ipx_ctx_worker_set(ipx_ctx_t *ctx, unsigned int id, unsigned int cnt)
+{
+    assert(id < cnt);
+    ctx->cfg_system.worker_id = id;
+    ctx->cfg_system.worker_cnt = cnt;
+}
+
+void
+ipx_ctx_tstore_set(ipx_ctx_t *ctx, ipx_tstore_t *store)
+{
+    ctx->cfg_system.tstore = store;
+}
+
+ipx_tstore_t *
+ipx_ctx_tstore_get(const ipx_ctx_t *ctx)
+{
+    return ctx->cfg_system.tstore;
+}
+
+/**
+ * \brief Wait until the last replica passes (or destroys) a shared message
+ * \param[in] replicas Shared state of replicas
+ * \param[in] seq      Sequence number of the shared message
+ */
+static void
+ctx_replicas_wait(struct ipx_ctx_replicas *replicas, uint64_t seq)
+{
+    if (__atomic_load_n(&replicas->passed, __ATOMIC_ACQUIRE) >= seq) {
+        return;
+    }
+
+    pthread_mutex_lock(&replicas->mutex);
+    while (replicas->passed < seq) {
+        pthread_cond_wait(&replicas->cond, &replicas->mutex);
+    }
+    pthread_mutex_unlock(&replicas->mutex);
+}
+
+/**
+ * \brief Let other replicas know that a shared message has been passed (or destroyed)
+ * \param[in] replicas Shared state of replicas
+ * \param[in] seq      Sequence number of the shared message
+ */
+static void
+ctx_replicas_done(struct ipx_ctx_replicas *replicas, uint64_t seq)
+{
+    pthread_mutex_lock(&replicas->mutex);
+    assert(replicas->passed + 1 == seq);
+    __atomic_store_n(&replicas->passed, seq, __ATOMIC_RELEASE);
+    pthread_cond_broadcast(&replicas->cond);
+    pthread_mutex_unlock(&replicas->mutex);
+}
+
+/**
+ * \brief Pass a batch of messages to the successor of the instance (not replica aware)
+ * \param[in] ctx  Plugin context
+ * \param[in] msgs Array of messages
+ * \param[in] cnt  Number of messages in the array
+ */
+static inline void
+ctx_msg_push_batch(struct ipx_ctx *ctx, ipx_msg_t **msgs, uint32_t cnt)
+{
+    for (uint32_t i = 0; i < cnt; ++i) {
+        ctx_stats_msg(&ctx->stats.out, msgs[i]);
+    }
+
+    ipx_ring_push_batch(ctx->pipeline.dst, msgs, cnt);
+}
+
+/**
+ * \brief Pass a message to the successor of the instance or destroy it
+ *
+ * In the replica mode, a message can be shared by multiple replicas of the instance and only
+ * the last of them passes or destroys it (see ipx_ctx_replica_set()). Other replicas wait until
+ * it has happened, so the shared message cannot be overtaken by messages that they pass later.
+ * Moreover, a replica releases its reference only after all preceding messages have been passed,
+ * so the shared message cannot overtake them either.
+ * \param[in] ctx  Plugin context
+ * \param[in] msg  Message
+ * \param[in] pass Pass the message (true) or destroy it (false)
+ */
+static void
+ctx_msg_dispose(struct ipx_ctx *ctx, ipx_msg_t *msg, bool pass)
+{
+    struct ipx_ctx_replicas *replicas = ctx->cfg_system.replicas;
+    const bool shared = (replicas != NULL && ipx_msg_header_cnt_shared(msg));
+    uint64_t seq = 0;
+
+    if (shared) {
+        seq = ++ctx->cfg_system.replica_seq;
+        if (!ipx_msg_header_cnt_dec(msg)) {
+            // Another replica will pass the message (it MUST NOT be touched anymore)
+            ctx_replicas_wait(replicas, seq);
+            return;
+        }
+    }
+
+    if (pass) {
+        ctx_stats_msg(&ctx->stats.out, msg);
+        ipx_ring_push(ctx->pipeline.dst, msg);
+    } else {
+        ipx_msg_destroy(msg);
+    }
+
+    if (shared) {
+        ctx_replicas_done(replicas, seq);
+    }
+}
+
+/**
+ * \brief Pass a batch of messages to the successor of the instance
+ *
+ * In the replica mode, shared messages are passed by ctx_msg_dispose() and the order of all
+ * messages is preserved.
+ * \param[in] ctx  Plugin context
+ * \param[in] msgs Array of messages
+ * \param[in] cnt  Number of messages in the array
+ */
+static void
+ctx_msg_pass_batch(struct ipx_ctx *ctx, ipx_msg_t **msgs, uint32_t cnt)
+{
+    uint32_t begin = 0;
+    if (ctx->cfg_system.replicas != NULL) {
+        for (uint32_t i = 0; i < cnt; ++i) {
+            if (!ipx_msg_header_cnt_shared(msgs[i])) {
+                continue;
+            }
+
+            // Preceding messages must be passed before the reference is released
+            ctx_msg_push_batch(ctx, &msgs[begin], i - begin);
+            ctx_msg_dispose(ctx, msgs[i], true);
+            begin = i + 1;
+        }
+    }
+
+    ctx_msg_push_batch(ctx, &msgs[begin], cnt - begin);
+}
+
 int
 ipx_ctx_subscribe(ipx_ctx_t *ctx, const ipx_msg_mask_t *mask_new, ipx_msg_mask_t *mask_old)
 {
@@ -332,7 +660,35 @@ ipx_ctx_msg_pass(ipx_ctx_t *ctx, ipx_msg_t *msg)
         return IPX_OK;
     }
 
-    ipx_ring_push(ctx->pipeline.dst, msg);
+    ctx_msg_dispose(ctx, msg, true);
+    return IPX_OK;
+}
+
+int
+ipx_ctx_msg_pass_batch(ipx_ctx_t *ctx, ipx_msg_t **msgs, uint32_t cnt)
+{
+    // Check permissions and arguments
+    if ((ctx->permissions & IPX_CP_MSG_PASS) == 0) {
+        IPX_CTX_DEBUG(ctx, "Called ipx_ctx_msg_pass_batch() but doesn't have permissions!", '\0');
+        return IPX_ERR_ARG;
+    }
+
+    for (uint32_t i = 0; i < cnt; ++i) {
+        if (msgs[i] == NULL) {
+            IPX_CTX_DEBUG(ctx, "Called ipx_ctx_msg_pass_batch() but a message is NULL!", '\0');
+            return IPX_ERR_ARG;
+        }
+    }
+
+    if (!ctx->pipeline.dst) {
+        // The successor is not connected (see ipx_ctx_msg_pass())
+        for (uint32_t i = 0; i < cnt; ++i) {
+            ipx_msg_destroy(msgs[i]);
+        }
+        return IPX_OK;
+    }
+
+    ctx_msg_pass_batch(ctx, msgs, cnt);
     return IPX_OK;
 }
 
@@ -566,7 +922,7 @@ init_check_intermediate(const ipx_ctx_t *ctx)
     /* Although the output manager is implemented as an intermediate plugin, it doesn't use
      * a standard output ring buffer.
      */
-    if (ctx->pipeline.dst == NULL && ctx->plugin_cbs->info->type != IPX_PT_OUTPUT_MGR) {
+    if (ctx->pipeline.dst == NULL && !CTX_TYPE_DISTRIBUTOR(ctx->plugin_cbs->info->type)) {
         IPX_CTX_ERROR(ctx, "Output ring buffer is not defined!", '\0');
         return IPX_ERR_ARG;
     }
@@ -689,6 +1045,7 @@ ipx_ctx_init(ipx_ctx_t *ctx, const char *params)
         break;
     case IPX_PT_INTERMEDIATE:
     case IPX_PT_OUTPUT_MGR:    // Output manager is implemented as an intermediate plugin
+    case IPX_PT_DISPATCHER:    // Replica dispatcher is implemented as an intermediate plugin
         rc = init_check_intermediate(ctx);
         break;
     case IPX_PT_OUTPUT:
@@ -709,6 +1066,25 @@ ipx_ctx_init(ipx_ctx_t *ctx, const char *params)
         return rc;
     }
 
+    if (plugin_type == IPX_PT_INPUT && ctx->msg_pool == NULL) {
+        // Wrappers of IPFIX Messages are allocated only by input instances
+        ctx->msg_pool = ipx_msg_ipfix_pool_create();
+        if (!ctx->msg_pool) {
+            IPX_CTX_ERROR(ctx, "Failed to create a pool of IPFIX Messages (%s:%d)!",
+                __FILE__, __LINE__);
+            return IPX_ERR_DENIED;
+        }
+    }
+
+    if (plugin_type == IPX_PT_INPUT && ctx->buffer_pool == NULL) {
+        // Raw IPFIX Messages are received only by input instances
+        ctx->buffer_pool = ipx_buffer_pool_create();
+        if (!ctx->buffer_pool) {
+            IPX_CTX_ERROR(ctx, "Failed to create a pool of buffers (%s:%d)!", __FILE__, __LINE__);
+            return IPX_ERR_DENIED;
+        }
+    }
+
     // Ok, everything seems fine, set default parameters
     switch (plugin_type) {
     case IPX_PT_INPUT:
@@ -720,10 +1096,11 @@ ipx_ctx_init(ipx_ctx_t *ctx, const char *params)
         ctx->permissions = IPX_CP_MSG_PASS | IPX_CP_MSG_SUB;
         break;
     case IPX_PT_OUTPUT_MGR:
+    case IPX_PT_DISPATCHER:
         /* By default, only ::IPX_MSG_IPFIX (IPFIX Message) and ::IPX_MSG_SESSION (Transport
          * Session Message) types can be passed to plugin instance for processing. However,
-         * implementation of the output manager (as an intermediate plugin) requires processing of
-         * almost all types of messages.
+         * implementation of the output manager and the replica dispatcher (as intermediate
+         * plugins) requires processing of almost all types of messages.
          */
         ctx->cfg_system.msg_mask_selected = IPX_MSG_MASK_ALL;
         ctx->cfg_system.msg_mask_allowed = IPX_MSG_MASK_ALL; // overwrite
@@ -912,7 +1289,9 @@ thread_input(void *arg)
         }
 
         // Try to get a new IPFIX message
+        uint64_t call_begin = ctx_stats_call_begin(ctx);
         rc = ctx->plugin_cbs->get(ctx, ctx->cfg_plugin.private);
+        ctx_stats_call_end(ctx, call_begin);
         thread_handle_rc(ctx, rc);
     }
 
@@ -921,11 +1300,81 @@ thread_input(void *arg)
     pthread_exit(NULL);
 }
 
+/**
+ * \brief Pass a batch of messages to the plugin instance
+ *
+ * \note Only for plugins that implement batch processing callback
+ * \param[in]     ctx  Instance context
+ * \param[in]     msgs Array of messages
+ * \param[in,out] cnt  Number of messages in the array (will be set to zero)
+ */
+static inline void
+thread_batch_process(struct ipx_ctx *ctx, ipx_msg_t **msgs, uint32_t *cnt)
+{
+    if (*cnt == 0) {
+        return;
+    }
+
+    uint64_t call_begin = ctx_stats_call_begin(ctx);
+    int rc = ctx->plugin_cbs->process_batch(ctx, ctx->cfg_plugin.private, msgs, *cnt);
+    ctx_stats_call_end(ctx, call_begin);
+    thread_handle_rc(ctx, rc);
+    *cnt = 0;
+}
+
+/**
+ * \brief Pass a batch of messages to the successor of the instance
+ *
+ * \param[in]     ctx  Instance context
+ * \param[in]     msgs Array of messages
+ * \param[in,out] cnt  Number of messages in the array (will be set to zero)
+ */
+static inline void
+thread_batch_pass(struct ipx_ctx *ctx, ipx_msg_t **msgs, uint32_t *cnt)
+{
+    if (*cnt == 0) {
+        return;
+    }
+
+    ctx_msg_pass_batch(ctx, msgs, *cnt);
+    *cnt = 0;
+}
+
+/**
+ * \brief Get new messages from the input ring buffer of the instance
+ *
+ * If the plugin has the idle callback, the function waits only for a limited time and the
+ * callback is called whenever no message arrives in time.
+ * \param[in]  ctx  Instance context
+ * \param[out] msgs Array for messages (at least #CTX_BATCH_SIZE elements)
+ * \return Number of messages (always at least 1)
+ */
+static inline uint32_t
+thread_batch_get(struct ipx_ctx *ctx, ipx_msg_t **msgs)
+{
+    if (ctx->plugin_cbs->idle == NULL) {
+        return ipx_ring_pop_batch(ctx->pipeline.src, msgs, CTX_BATCH_SIZE);
+    }
+
+    uint32_t cnt;
+    while ((cnt = ipx_ring_pop_batch_timed(ctx->pipeline.src, msgs, CTX_BATCH_SIZE,
+            CTX_IDLE_TIMEOUT)) == 0) {
+        // Nothing to do, let the plugin perform its periodic tasks
+        ctx->plugin_cbs->idle(ctx, ctx->cfg_plugin.private);
+    }
+
+    return cnt;
+}
+
 /**
  * \brief Intermediate instance control thread
  *
  * Infinite loop that process messages from an input ring buffer and eventually pass them to
- * an output ring buffer.
+ * an output ring buffer. Messages are taken from the input ring buffer in batches. If the plugin
+ * supports batch processing, consecutive messages for the plugin are passed at once. Messages
+ * that are not processed by the plugin are passed to the output ring buffer in batches too.
+ * In both cases, the order of messages is preserved. If the input ring buffer is empty for
+ * a while, the idle callback of the plugin (if any) is called.
  * \param[in] arg Instance context
  * \return NULL
  */
@@ -933,61 +1382,88 @@ static void *
 thread_intermediate(void *arg)
 {
     struct ipx_ctx *ctx = (struct ipx_ctx *) arg;
-    assert(ctx->type == IPX_PT_INTERMEDIATE || ctx->type == IPX_PT_OUTPUT_MGR);
+    assert(ctx->type == IPX_PT_INTERMEDIATE || CTX_TYPE_DISTRIBUTOR(ctx->type));
     thread_set_name(ctx->name);
 
     const char *plugin_name = ctx->plugin_cbs->info->name;
     IPX_CTX_DEBUG(ctx, "Instance thread of the intermediate plugin '%s' has started!", plugin_name);
 
-    ipx_msg_t *msg_ptr;
-    enum ipx_msg_type msg_type;
+    ipx_msg_t *msg_ptr = NULL;
+    enum ipx_msg_type msg_type = 0;
+
+    const bool batch_en = (ctx->plugin_cbs->process_batch != NULL);
+    ipx_msg_t *msgs_in[CTX_BATCH_SIZE];     // Messages from the input ring
+    ipx_msg_t *msgs_plugin[CTX_BATCH_SIZE]; // Messages for the plugin (batch processing only)
+    ipx_msg_t *msgs_pass[CTX_BATCH_SIZE];   // Messages to pass without processing
+    uint32_t plugin_cnt = 0;
+    uint32_t pass_cnt = 0;
 
     bool terminate = false;
     while (!terminate) {
-        // Get a new message for the buffer
-        msg_ptr = ipx_ring_pop(ctx->pipeline.src);
-        msg_type = ipx_msg_get_type(msg_ptr);
-        bool processed = false; // only not processed messages are automatically passed
-
-        if (msg_type == IPX_MSG_TERMINATE) {
-            ipx_msg_terminate_t *terminate_msg = ipx_msg_base2terminate(msg_ptr);
-            enum ipx_msg_terminate_type type = ipx_msg_terminate_get_type(terminate_msg);
-
-            if (type == IPX_MSG_TERMINATE_INSTANCE && (--ctx->cfg_system.term_msg_cnt) != 0) {
-                // Drop the message, we are still waiting for another termination request
-                IPX_CTX_DEBUG(ctx, "Termination message dropped. Waiting for %u remaining input "
-                    "plugin(s) to terminate.", ctx->cfg_system.term_msg_cnt);
-                ipx_msg_terminate_destroy(terminate_msg);
-                continue;
+        // Get new messages from the buffer
+        uint32_t msg_cnt = thread_batch_get(ctx, msgs_in);
+
+        for (uint32_t i = 0; i < msg_cnt && !terminate; ++i) {
+            msg_ptr = msgs_in[i];
+            msg_type = ipx_msg_get_type(msg_ptr);
+            bool processed = false; // only not processed messages are automatically passed
+            ctx_stats_msg(&ctx->stats.in, msg_ptr);
+
+            if (msg_type == IPX_MSG_TERMINATE) {
+                ipx_msg_terminate_t *terminate_msg = ipx_msg_base2terminate(msg_ptr);
+                enum ipx_msg_terminate_type type = ipx_msg_terminate_get_type(terminate_msg);
+
+                if (type == IPX_MSG_TERMINATE_INSTANCE && (--ctx->cfg_system.term_msg_cnt) != 0) {
+                    // Drop the message, we are still waiting for another termination request
+                    IPX_CTX_DEBUG(ctx, "Termination message dropped. Waiting for %u remaining "
+                        "input plugin(s) to terminate.", ctx->cfg_system.term_msg_cnt);
+                    ipx_msg_terminate_destroy(terminate_msg);
+                    continue;
+                }
+
+                if (type == IPX_MSG_TERMINATE_INSTANCE) {
+                    terminate = true;
+                }
             }
 
-            if (type == IPX_MSG_TERMINATE_INSTANCE) {
-                terminate = true;
+            if (!ipx_ctx_processing_get(ctx)
+                    && (msg_type == IPX_MSG_IPFIX || msg_type == IPX_MSG_SESSION)) {
+                // Data processing is disabled -> drop IPFIX and Session messages
+                ctx_msg_dispose(ctx, msg_ptr, false);
+                continue;
             }
-        }
 
-        if (!ipx_ctx_processing_get(ctx)
-                && (msg_type == IPX_MSG_IPFIX || msg_type == IPX_MSG_SESSION)) {
-            // Data processing is disabled -> drop IPFIX and Session messages
-            ipx_msg_destroy(msg_ptr);
-            continue;
-        }
+            bool msg_for_plugin = (msg_type & ctx->cfg_system.msg_mask_selected) != 0;
+            bool en = ipx_ctx_processing_get(ctx) || CTX_TYPE_DISTRIBUTOR(ctx->type);
+            if (en && msg_for_plugin) {
+                // Messages passed by the plugin must follow previously passed messages
+                thread_batch_pass(ctx, msgs_pass, &pass_cnt);
+
+                if (batch_en) {
+                    // Postpone processing until a message that should be passed or the end of batch
+                    msgs_plugin[plugin_cnt++] = msg_ptr;
+                } else {
+                    // Pass data to the plugin
+                    uint64_t call_begin = ctx_stats_call_begin(ctx);
+                    int rc = ctx->plugin_cbs->process(ctx, ctx->cfg_plugin.private, msg_ptr);
+                    ctx_stats_call_end(ctx, call_begin);
+                    thread_handle_rc(ctx, rc);
+                }
+                processed = true;
+            }
 
-        bool msg_for_plugin = (msg_type & ctx->cfg_system.msg_mask_selected) != 0;
-        if ((ipx_ctx_processing_get(ctx) || ctx->type == IPX_PT_OUTPUT_MGR) && msg_for_plugin) {
-            // Pass data to the plugin
-            int rc = ctx->plugin_cbs->process(ctx, ctx->cfg_plugin.private, msg_ptr);
-            thread_handle_rc(ctx, rc);
-            processed = true;
+            // The message hasn't been processed by the plugin
+            if (!processed && terminate != true) {
+                /* Not processed by the instance, pass the message.
+                 * Note: Termination message is passed after intermediate instance destructor! */
+                assert(!CTX_TYPE_DISTRIBUTOR(ctx->type));
+                thread_batch_process(ctx, msgs_plugin, &plugin_cnt);
+                msgs_pass[pass_cnt++] = msg_ptr;
+            }
         }
 
-        // The message hasn't been processed by the plugin
-        if (!processed && terminate != true) {
-            /* Not processed by the instance, pass the message.
-             * Note: Termination message is passed after intermediate instance destructor! */
-            assert(ctx->type != IPX_PT_OUTPUT_MGR);
-            ipx_ring_push(ctx->pipeline.dst, msg_ptr);
-        }
+        thread_batch_process(ctx, msgs_plugin, &plugin_cnt);
+        thread_batch_pass(ctx, msgs_pass, &pass_cnt);
     }
 
     // Destroy the instance (usually produce garbage messages)
@@ -996,9 +1472,9 @@ thread_intermediate(void *arg)
 
     // Pass the termination message as the last message to the buffer
     assert(msg_type == IPX_MSG_TERMINATE);
-    if (ctx->type != IPX_PT_OUTPUT_MGR) {
-        // All intermediate plugins (except the output manager) have to pass the message here
-        ipx_ring_push(ctx->pipeline.dst, msg_ptr);
+    if (!CTX_TYPE_DISTRIBUTOR(ctx->type)) {
+        // All intermediate plugins (except the distributors) have to pass the message here
+        ctx_msg_dispose(ctx, msg_ptr, true);
     }
 
     IPX_CTX_DEBUG(ctx, "Instance thread of the intermediate plugin '%s' has been terminated!",
@@ -1009,7 +1485,9 @@ thread_intermediate(void *arg)
 /**
  * \brief Output instance control thread
  *
- * Infinite loop that process messages from an input ring buffer.
+ * Infinite loop that process messages from an input ring buffer. Messages are taken from the
+ * input ring buffer in batches and, if the plugin supports batch processing, passed to the
+ * plugin at once.
  * \param[in] arg Instance context
  * \return NULL
  */
@@ -1023,32 +1501,53 @@ thread_output(void *arg)
     const char *plugin_name = ctx->plugin_cbs->info->name;
     IPX_CTX_DEBUG(ctx, "Instance thread of the output plugin '%s' has started!", plugin_name);
 
+    const bool batch_en = (ctx->plugin_cbs->process_batch != NULL);
+    ipx_msg_t *msgs_in[CTX_BATCH_SIZE];     // Messages from the input ring
+    ipx_msg_t *msgs_plugin[CTX_BATCH_SIZE]; // Messages for the plugin (batch processing only)
+    uint32_t plugin_cnt = 0;
+
     bool terminate = false;
     while (!terminate) {
-        // Get a new message for the buffer
-        ipx_msg_t *msg_ptr = ipx_ring_pop(ctx->pipeline.src);
-        enum ipx_msg_type msg_type = ipx_msg_get_type(msg_ptr);
-        bool msg_for_plugin = (msg_type & ctx->cfg_system.msg_mask_selected) != 0;
-
-        if (ipx_ctx_processing_get(ctx) && msg_for_plugin) {
-            // Process the message by the plugin
-            int rc = ctx->plugin_cbs->process(ctx, ctx->cfg_plugin.private, msg_ptr);
-            thread_handle_rc(ctx, rc);
-        }
+        // Get new messages from the buffer
+        uint32_t msg_cnt = ipx_ring_pop_batch(ctx->pipeline.src, msgs_in, CTX_BATCH_SIZE);
+
+        for (uint32_t i = 0; i < msg_cnt; ++i) {
+            ipx_msg_t *msg_ptr = msgs_in[i];
+            enum ipx_msg_type msg_type = ipx_msg_get_type(msg_ptr);
+            bool msg_for_plugin = (msg_type & ctx->cfg_system.msg_mask_selected) != 0;
+            ctx_stats_msg(&ctx->stats.in, msg_ptr);
+
+            if (ipx_ctx_processing_get(ctx) && msg_for_plugin) {
+                if (batch_en) {
+                    msgs_plugin[plugin_cnt++] = msg_ptr;
+                } else {
+                    // Process the message by the plugin
+                    uint64_t call_begin = ctx_stats_call_begin(ctx);
+                    int rc = ctx->plugin_cbs->process(ctx, ctx->cfg_plugin.private, msg_ptr);
+                    ctx_stats_call_end(ctx, call_begin);
+                    thread_handle_rc(ctx, rc);
+                }
+            }
 
-        if (msg_type == IPX_MSG_TERMINATE) {
-            ipx_msg_terminate_t *terminate_msg = ipx_msg_base2terminate(msg_ptr);
-            enum ipx_msg_terminate_type type = ipx_msg_terminate_get_type(terminate_msg);
-            if (type == IPX_MSG_TERMINATE_INSTANCE) {
-                // We received a request to terminate the instance
-                terminate = true;
+            if (msg_type == IPX_MSG_TERMINATE) {
+                ipx_msg_terminate_t *terminate_msg = ipx_msg_base2terminate(msg_ptr);
+                enum ipx_msg_terminate_type type = ipx_msg_terminate_get_type(terminate_msg);
+                if (type == IPX_MSG_TERMINATE_INSTANCE) {
+                    // We received a request to terminate the instance
+                    terminate = true;
+                }
             }
         }
 
-        // Decrement the counter - DO NOT TOUCH the message from this point beyond
-        if (ipx_msg_header_cnt_dec(msg_ptr)) {
-            // This instance is the last user, destroy it
-            ipx_msg_destroy(msg_ptr);
+        // Process the messages by the plugin
+        thread_batch_process(ctx, msgs_plugin, &plugin_cnt);
+
+        for (uint32_t i = 0; i < msg_cnt; ++i) {
+            // Decrement the counter - DO NOT TOUCH the message from this point beyond
+            if (ipx_msg_header_cnt_dec(msgs_in[i])) {
+                // This instance is the last user, destroy it
+                ipx_msg_destroy(msgs_in[i]);
+            }
         }
     }
 
@@ -1077,6 +1576,7 @@ ipx_ctx_run(ipx_ctx_t *ctx)
         break;
     case IPX_PT_INTERMEDIATE:
     case IPX_PT_OUTPUT_MGR:  // Output manager is implemented as intermediate plugin
+    case IPX_PT_DISPATCHER:  // Replica dispatcher is implemented as intermediate plugin
         thread_func = &thread_intermediate;
         break;
     case IPX_PT_OUTPUT:
@@ -1093,6 +1593,7 @@ ipx_ctx_run(ipx_ctx_t *ctx)
     sigfillset(&set_new);
     pthread_sigmask(SIG_SETMASK, &set_new, &set_old);
     ctx->state = IPX_CS_RUNNING;
+    ctx->stats_timing = ipx_stats_timing_get();
 
     // Start the thread
     int rc = pthread_create(&ctx->thread_id, NULL, thread_func, ctx);
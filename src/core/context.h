@@ -46,6 +46,10 @@
 #include <libfds.h>
 #include "fpipe.h"
 #include "ring.h"
+#include "message_ipfix.h"
+#include "buffer_pool.h"
+#include "stats.h"
+#include "tstore.h"
 
 /** List of plugin callbacks  */
 struct ipx_ctx_callbacks {
@@ -65,10 +69,16 @@ struct ipx_ctx_callbacks {
     int  (*process) (ipx_ctx_t *, void *, ipx_msg_t *);
     /** Close session request (INPUT plugins only, can be NULL)                 */
     void  (*ts_close)(ipx_ctx_t *, void *, const struct ipx_session *);
+    /** Batch process function (INTERMEDIATE and OUTPUT only, can be NULL)      */
+    int  (*process_batch)(ipx_ctx_t *, void *, ipx_msg_t **, size_t);
+    /** Idle function (internal INTERMEDIATE plugins only, can be NULL)         */
+    void (*idle)(ipx_ctx_t *, void *);
 };
 
 /** Identification number of output manager plugin */
 #define IPX_PT_OUTPUT_MGR 255
+/** Identification number of replica dispatcher plugin */
+#define IPX_PT_DISPATCHER 254
 
 /**
  * \brief Create a context
@@ -161,6 +171,45 @@ ipx_ctx_init(ipx_ctx_t *ctx, const char *params);
 IPX_API int
 ipx_ctx_run(ipx_ctx_t *ctx);
 
+/**
+ * \brief Get a pool of IPFIX Message wrappers
+ *
+ * The pool is available only for input instances, i.e. the instances that create IPFIX Messages.
+ * \param[in] ctx Plugin context
+ * \return Pointer to the pool or NULL (not available)
+ */
+IPX_API ipx_msg_ipfix_pool_t *
+ipx_ctx_msg_pool_get(const ipx_ctx_t *ctx);
+
+/**
+ * \brief Get a pool of buffers for raw IPFIX Messages
+ *
+ * The pool is available only for input instances, i.e. the instances that receive IPFIX Messages.
+ * \param[in] ctx Plugin context
+ * \return Pointer to the pool or NULL (not available)
+ */
+IPX_API ipx_buffer_pool_t *
+ipx_ctx_buffer_pool_get(const ipx_ctx_t *ctx);
+
+/**
+ * \brief Get statistics of the instance
+ *
+ * \warning Counters can be modified only by the thread of the instance (see ipx_stats_cnt_add()).
+ *   Other threads can only read them using atomic loads.
+ * \param[in] ctx Plugin context
+ * \return Pointer to the statistics
+ */
+IPX_API struct ipx_stats_ctx *
+ipx_ctx_stats_get(ipx_ctx_t *ctx);
+
+/**
+ * \brief Get a template store of UDP sessions
+ * \param[in] ctx Plugin context
+ * \return Pointer to the store or NULL (not configured)
+ */
+IPX_API ipx_tstore_t *
+ipx_ctx_tstore_get(const ipx_ctx_t *ctx);
+
 /**
  * \brief Get size of one IPFIX record with registered extensions (in bytes)
  * \param[in] ctx Plugin context
@@ -264,6 +313,76 @@ ipx_ctx_verb_set(ipx_ctx_t *ctx, enum ipx_verb_level verb);
 IPX_API int
 ipx_ctx_term_cnt_set(ipx_ctx_t *ctx, unsigned int cnt);
 
+/** Shared state of replicas of an intermediate instance (see ipx_ctx_replica_set())            */
+typedef struct ipx_ctx_replicas ipx_ctx_replicas_t;
+
+/**
+ * \brief Create a shared state of replicas of an intermediate instance
+ * \return Pointer to the state or NULL (memory allocation error)
+ */
+IPX_API ipx_ctx_replicas_t *
+ipx_ctx_replicas_create();
+
+/**
+ * \brief Destroy a shared state of replicas
+ * \warning Threads of all replicas that use the state MUST be already terminated.
+ * \param[in] replicas Shared state
+ */
+IPX_API void
+ipx_ctx_replicas_destroy(ipx_ctx_replicas_t *replicas);
+
+/**
+ * \brief Enable/disable replica mode of an intermediate instance
+ *
+ * If an intermediate instance runs in multiple threads (replicas), each replica has its own
+ * context and all replicas write to the same output ring buffer. The replica dispatcher passes
+ * IPFIX Messages to only one of the replicas, however, all other messages (e.g. Transport
+ * Session, Garbage and Termination messages) are shared by all replicas and the reference
+ * counter of the message is set to the number of replicas.
+ *
+ * In the replica mode, a shared message is passed to the output ring buffer (or destroyed,
+ * if processing is disabled) only by the last replica that releases it. Each replica releases
+ * the message only after all preceding messages have been passed and, if it is not the last
+ * one, waits until the last replica passes the message. In other words, shared messages act as
+ * barriers and the successor receives each of them only once, after all messages that preceded
+ * it and before all messages that followed it in any replica.
+ *
+ * \warning
+ *   This configuration parameter affects only intermediate plugins and MUST be set before the
+ *   thread of the instance is started. All replicas of the instance MUST use the same shared
+ *   state and the state MUST exist until the threads are terminated.
+ * \param[in] ctx      Plugin context
+ * \param[in] replicas Shared state of all replicas (NULL to disable)
+ */
+IPX_API void
+ipx_ctx_replica_set(ipx_ctx_t *ctx, ipx_ctx_replicas_t *replicas);
+
+/**
+ * \brief Set identification of the worker of an input instance
+ *
+ * \warning
+ *   This configuration parameter affects only input plugins and MUST be set before the
+ *   instance is initialized.
+ * \param[in] ctx Plugin context
+ * \param[in] id  Identification number of the worker (must be less than \p cnt)
+ * \param[in] cnt Total number of workers of the instance
+ */
+IPX_API void
+ipx_ctx_worker_set(ipx_ctx_t *ctx, unsigned int id, unsigned int cnt);
+
+/**
+ * \brief Set a template store of UDP sessions
+ *
+ * The store is used by the parser of an input instance (see ipx_parser_tstore_set()).
+ * \warning
+ *   This configuration parameter affects only parser instances and MUST be set before the
+ *   instance is initialized. The store MUST exist until the context is destroyed.
+ * \param[in] ctx   Plugin context
+ * \param[in] store Template store (can be NULL)
+ */
+IPX_API void
+ipx_ctx_tstore_set(ipx_ctx_t *ctx, ipx_tstore_t *store);
+
 /**
  * \brief Enable/disable data processing
  *
@@ -0,0 +1,395 @@
+/**
+ * \file src/core/epoch.c
+ * \brief Epoch-based reclamation of shared objects
+ * \date 2026
+ */
+
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include <assert.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "epoch.h"
+
+#ifndef IPX_CLINE_SIZE
+/** Expected CPU cache-line size        */
+#define IPX_CLINE_SIZE 64
+#endif
+/** Cache-line alignment                */
+#define __ipx_cache_aligned __attribute__((__aligned__(IPX_CLINE_SIZE)))
+
+/** Default number of pre-allocated items of a list of retired objects                       */
+#define LIST_DEF_CNT (16U)
+
+/** Reference counters of a thread                                                           */
+struct epoch_thread {
+    /** Number of acquired references per epoch slot (written only by the owner)             */
+    uint64_t acquired[IPX_EPOCH_WINDOW] __ipx_cache_aligned;
+    /** Number of released references per epoch slot (written only by the owner)             */
+    uint64_t released[IPX_EPOCH_WINDOW] __ipx_cache_aligned;
+
+    /** The record is used by a thread (accessed only atomically)                            */
+    bool in_use __ipx_cache_aligned;
+    /** Next record in the global list (the list is append-only)                             */
+    struct epoch_thread *next;
+};
+
+/** Global state of the epochs                                                               */
+static struct {
+    /** Current epoch (accessed only atomically)                                             */
+    uint64_t current __ipx_cache_aligned;
+    /** The last epoch whose all references have been released (accessed only atomically)    */
+    uint64_t passed __ipx_cache_aligned;
+    /** List of thread records (accessed only atomically)                                    */
+    struct epoch_thread *threads __ipx_cache_aligned;
+} epoch_global = {1, 0, NULL};
+
+/**
+ * Shared record for threads that failed to allocate their own record
+ * \note Unlike other records, its counters are always updated by atomic operations.
+ */
+static struct epoch_thread epoch_shared;
+
+/** Record of the current thread                                                             */
+static __thread struct epoch_thread *epoch_tls = NULL;
+/** Key for releasing records of terminated threads                                          */
+static pthread_key_t epoch_key;
+/** One-time initialization of the key                                                       */
+static pthread_once_t epoch_key_once = PTHREAD_ONCE_INIT;
+
+/**
+ * \brief Mark a record of a terminated thread as unused
+ * \param[in] data Record of the thread
+ */
+static void
+epoch_thread_exit(void *data)
+{
+    struct epoch_thread *rec = data;
+    __atomic_store_n(&rec->in_use, false, __ATOMIC_RELEASE);
+}
+
+/** Create the key for releasing thread records */
+static void
+epoch_key_create()
+{
+    if (pthread_key_create(&epoch_key, &epoch_thread_exit) != 0) {
+        // Records will be never reused, not a big problem
+        epoch_key = (pthread_key_t) -1;
+    }
+}
+
+/**
+ * \brief Get a record of the current thread
+ *
+ * If the thread doesn't have a record yet, an unused record is reused or a new one is created.
+ * \return Pointer to the record (never NULL)
+ */
+static struct epoch_thread *
+epoch_thread_get()
+{
+    struct epoch_thread *rec = epoch_tls;
+    if (rec != NULL) {
+        return rec;
+    }
+
+    // Try to reuse a record of a terminated thread (counters remain valid)
+    rec = __atomic_load_n(&epoch_global.threads, __ATOMIC_ACQUIRE);
+    for (; rec != NULL; rec = rec->next) {
+        bool exp = false;
+        if (__atomic_compare_exchange_n(&rec->in_use, &exp, true, false, __ATOMIC_ACQ_REL,
+                __ATOMIC_RELAXED)) {
+            break;
+        }
+    }
+
+    if (!rec) {
+        // Create a new record
+        rec = aligned_alloc(IPX_CLINE_SIZE, sizeof(*rec));
+        if (!rec) {
+            return &epoch_shared;
+        }
+
+        memset(rec, 0, sizeof(*rec));
+        rec->in_use = true;
+        rec->next = __atomic_load_n(&epoch_global.threads, __ATOMIC_RELAXED);
+        while (!__atomic_compare_exchange_n(&epoch_global.threads, &rec->next, rec, true,
+            __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+    }
+
+    pthread_once(&epoch_key_once, &epoch_key_create);
+    if (epoch_key != (pthread_key_t) -1) {
+        pthread_setspecific(epoch_key, rec);
+    }
+
+    epoch_tls = rec;
+    return rec;
+}
+
+/**
+ * \brief Increment a counter of a thread record
+ * \param[in] rec     Record of the current thread
+ * \param[in] counter Counter to increment
+ */
+static inline void
+epoch_counter_inc(struct epoch_thread *rec, uint64_t *counter)
+{
+    if (rec == &epoch_shared) {
+        __atomic_add_fetch(counter, 1, __ATOMIC_RELEASE);
+        return;
+    }
+
+    // Only the owner writes the counter
+    uint64_t value = __atomic_load_n(counter, __ATOMIC_RELAXED);
+    __atomic_store_n(counter, value + 1, __ATOMIC_RELEASE);
+}
+
+uint64_t
+ipx_epoch_acquire()
+{
+    struct epoch_thread *rec = epoch_thread_get();
+    uint64_t epoch = __atomic_load_n(&epoch_global.current, __ATOMIC_SEQ_CST);
+
+    while (true) {
+        const uint32_t slot = epoch % IPX_EPOCH_WINDOW;
+        epoch_counter_inc(rec, &rec->acquired[slot]);
+
+        /* The epoch could have been closed (and even passed) between the load and the increment.
+         * Check it again after the increment is globally visible. Together with the fence in
+         * ipx_epoch_passed(), either the epoch is still open or the increment is visible to
+         * everyone who checks whether the epoch has passed.
+         */
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+        const uint64_t current = __atomic_load_n(&epoch_global.current, __ATOMIC_SEQ_CST);
+        if (current == epoch) {
+            return epoch;
+        }
+
+        // Undo the reference (counters are never decremented) and try the new epoch
+        epoch_counter_inc(rec, &rec->released[slot]);
+        epoch = current;
+    }
+}
+
+void
+ipx_epoch_release(uint64_t epoch)
+{
+    assert(epoch != 0 && "Invalid epoch");
+    struct epoch_thread *rec = epoch_thread_get();
+    epoch_counter_inc(rec, &rec->released[epoch % IPX_EPOCH_WINDOW]);
+}
+
+uint64_t
+ipx_epoch_retire()
+{
+    uint64_t current = __atomic_load_n(&epoch_global.current, __ATOMIC_RELAXED);
+    uint64_t epoch_new;
+
+    /* Always perform a read-modify-write operation (even if the epoch doesn't change) to make
+     * previously acquired references of this thread visible to anyone who observes a newer epoch
+     */
+    do {
+        const uint64_t passed = __atomic_load_n(&epoch_global.passed, __ATOMIC_ACQUIRE);
+        // Epochs (passed, current] must be mapped to different slots
+        epoch_new = (current - passed < IPX_EPOCH_WINDOW - 1) ? current + 1 : current;
+    } while (!__atomic_compare_exchange_n(&epoch_global.current, &current, epoch_new, false,
+        __ATOMIC_ACQ_REL, __ATOMIC_RELAXED));
+
+    return current;
+}
+
+/**
+ * \brief Sum counters of all thread records
+ * \param[in] slot     Epoch slot
+ * \param[in] released Sum released (true) or acquired (false) counters
+ * \return Sum
+ */
+static uint64_t
+epoch_sum(uint32_t slot, bool released)
+{
+    uint64_t sum = 0;
+    const struct epoch_thread *rec = __atomic_load_n(&epoch_global.threads, __ATOMIC_ACQUIRE);
+    for (; rec != NULL; rec = rec->next) {
+        const uint64_t *counter = released ? &rec->released[slot] : &rec->acquired[slot];
+        sum += __atomic_load_n(counter, __ATOMIC_ACQUIRE);
+    }
+
+    const struct epoch_thread *shared = &epoch_shared;
+    const uint64_t *counter = released ? &shared->released[slot] : &shared->acquired[slot];
+    sum += __atomic_load_n(counter, __ATOMIC_ACQUIRE);
+    return sum;
+}
+
+bool
+ipx_epoch_passed(uint64_t epoch)
+{
+    uint64_t passed = __atomic_load_n(&epoch_global.passed, __ATOMIC_ACQUIRE);
+    if (epoch <= passed) {
+        return true;
+    }
+
+    while (passed < epoch) {
+        // Read-modify-write operation to synchronize with ipx_epoch_acquire() (see the fence)
+        uint64_t current = __atomic_fetch_add(&epoch_global.current, 0, __ATOMIC_SEQ_CST);
+        if (passed + 1 == current) {
+            /* The next epoch is still open (e.g. objects were retired when the window was full),
+             * close it so new references cannot be acquired in it anymore.
+             */
+            __atomic_compare_exchange_n(&epoch_global.current, &current, current + 1, false,
+                __ATOMIC_SEQ_CST, __ATOMIC_RELAXED);
+            continue;
+        }
+
+        /* A thread that acquires the epoch after this point will see the new current epoch and
+         * try again. Otherwise its increment of the acquired counter is visible below.
+         */
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+        /* Released counters MUST be read before acquired counters. Because a reference is always
+         * acquired before it is released, each observed release has a matching acquisition.
+         */
+        const uint32_t slot = (passed + 1) % IPX_EPOCH_WINDOW;
+        const uint64_t cnt_released = epoch_sum(slot, true);
+        const uint64_t cnt_acquired = epoch_sum(slot, false);
+        if (cnt_acquired != cnt_released) {
+            // Some references are still in use
+            break;
+        }
+
+        // On failure, "passed" is updated by someone else's progress
+        __atomic_compare_exchange_n(&epoch_global.passed, &passed, passed + 1, false,
+            __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+    }
+
+    return epoch <= __atomic_load_n(&epoch_global.passed, __ATOMIC_ACQUIRE);
+}
+
+/** Retired object                                                                           */
+struct epoch_item {
+    /** Retirement epoch                                                                     */
+    uint64_t epoch;
+    /** Retired object                                                                       */
+    void *object;
+    /** Destructor of the object                                                             */
+    ipx_epoch_cb cb;
+};
+
+/** List of retired objects (sorted by retirement epoch)                                     */
+struct ipx_epoch_list {
+    /** Array of retired objects                                                             */
+    struct epoch_item *items;
+    /** Index of the first valid item                                                        */
+    size_t begin;
+    /** Index after the last valid item                                                      */
+    size_t end;
+    /** Number of allocated items                                                            */
+    size_t alloc;
+};
+
+ipx_epoch_list_t *
+ipx_epoch_list_create()
+{
+    struct ipx_epoch_list *list = calloc(1, sizeof(*list));
+    if (!list) {
+        return NULL;
+    }
+
+    list->items = malloc(LIST_DEF_CNT * sizeof(*list->items));
+    if (!list->items) {
+        free(list);
+        return NULL;
+    }
+
+    list->alloc = LIST_DEF_CNT;
+    return list;
+}
+
+void
+ipx_epoch_list_destroy(ipx_epoch_list_t *list)
+{
+    for (size_t i = list->begin; i < list->end; ++i) {
+        list->items[i].cb(list->items[i].object);
+    }
+
+    free(list->items);
+    free(list);
+}
+
+int
+ipx_epoch_list_defer(ipx_epoch_list_t *list, void *object, ipx_epoch_cb cb)
+{
+    if (list->end == list->alloc) {
+        if (list->begin > 0) {
+            // Move valid items to the beginning
+            const size_t cnt = list->end - list->begin;
+            memmove(list->items, &list->items[list->begin], cnt * sizeof(*list->items));
+            list->begin = 0;
+            list->end = cnt;
+        } else {
+            const size_t alloc_new = 2 * list->alloc;
+            struct epoch_item *items_new = realloc(list->items, alloc_new * sizeof(*items_new));
+            if (!items_new) {
+                return IPX_ERR_NOMEM;
+            }
+
+            list->items = items_new;
+            list->alloc = alloc_new;
+        }
+    }
+
+    struct epoch_item *item = &list->items[list->end++];
+    item->epoch = ipx_epoch_retire();
+    item->object = object;
+    item->cb = cb;
+    return IPX_OK;
+}
+
+size_t
+ipx_epoch_list_reclaim(ipx_epoch_list_t *list)
+{
+    while (list->begin < list->end && ipx_epoch_passed(list->items[list->begin].epoch)) {
+        struct epoch_item *item = &list->items[list->begin++];
+        item->cb(item->object);
+    }
+
+    if (list->begin == list->end) {
+        list->begin = 0;
+        list->end = 0;
+    }
+
+    return list->end - list->begin;
+}
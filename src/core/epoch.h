@@ -0,0 +1,158 @@
+/**
+ * \file src/core/epoch.h
+ * \brief Epoch-based reclamation of shared objects (internal header file)
+ * \date 2026
+ */
+
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#ifndef IPFIXCOL_EPOCH_H
+#define IPFIXCOL_EPOCH_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <ipfixcol2.h>
+
+/**
+ * \defgroup ipxEpoch Epoch-based reclamation
+ * \brief Deferred destruction of objects referenced by messages in the pipeline
+ *
+ * Objects such as (Options) Templates and Template snapshots are referenced by IPFIX Messages
+ * that travel through the pipeline. When an object is replaced, it cannot be destroyed
+ * immediately because it can be still referenced by messages waiting in ring buffers or being
+ * processed by other threads.
+ *
+ * Every message that can hold references to such objects acquires the current (global) epoch
+ * before the references are created and releases it when the message is destroyed. Each thread
+ * publishes the number of acquired and released references per epoch in its own counters, so
+ * the fast path doesn't require any shared atomic operation. A replaced object is retired in
+ * the current epoch, which also starts a new epoch. The object can be destroyed as soon as all
+ * references of all epochs up to the retirement epoch have been released.
+ *
+ * Only a limited number of epochs (#IPX_EPOCH_WINDOW) can be tracked at the same time. If the
+ * window is full, the current epoch is not closed and objects are retired in the current epoch,
+ * which is closed later by ipx_epoch_passed(). This doesn't affect correctness, only the time
+ * of destruction.
+ * @{
+ */
+
+/** Maximum number of epochs that can be tracked at the same time                            */
+#define IPX_EPOCH_WINDOW (256U)
+
+/**
+ * \brief Acquire the current epoch
+ *
+ * Must be called before any reference to shared objects is created.
+ * \return Acquired epoch (never 0)
+ */
+IPX_API uint64_t
+ipx_epoch_acquire();
+
+/**
+ * \brief Release a previously acquired epoch
+ *
+ * Can be called by any thread (not only by the thread that acquired the epoch).
+ * \param[in] epoch Epoch returned by ipx_epoch_acquire()
+ */
+IPX_API void
+ipx_epoch_release(uint64_t epoch);
+
+/**
+ * \brief Retire objects in the current epoch and try to start a new one
+ *
+ * \note Objects retired in the returned epoch MUST NOT be accessible by newly acquired
+ *   references (i.e. they must be already replaced).
+ * \return Retirement epoch
+ */
+IPX_API uint64_t
+ipx_epoch_retire();
+
+/**
+ * \brief Check whether all references acquired up to the given epoch have been released
+ * \param[in] epoch Retirement epoch returned by ipx_epoch_retire()
+ * \return True if objects retired in the epoch can be destroyed. Otherwise false.
+ */
+IPX_API bool
+ipx_epoch_passed(uint64_t epoch);
+
+/** Destructor of a retired object                                                           */
+typedef void (*ipx_epoch_cb)(void *object);
+/** List of retired objects waiting for destruction                                          */
+typedef struct ipx_epoch_list ipx_epoch_list_t;
+
+/**
+ * \brief Create an empty list of retired objects
+ *
+ * The list is not thread-safe i.e. it should be used only by a single thread at a time.
+ * \return Pointer to the list or NULL (memory allocation error)
+ */
+IPX_API ipx_epoch_list_t *
+ipx_epoch_list_create();
+
+/**
+ * \brief Destroy a list of retired objects
+ *
+ * \warning All objects in the list are destroyed immediately without any check. The caller
+ *   MUST make sure that the objects are not referenced anymore.
+ * \param[in] list List to destroy
+ */
+IPX_API void
+ipx_epoch_list_destroy(ipx_epoch_list_t *list);
+
+/**
+ * \brief Retire an object and add it to a list of retired objects
+ *
+ * The object will be destroyed by ipx_epoch_list_reclaim() or ipx_epoch_list_destroy().
+ * \param[in] list   List of retired objects
+ * \param[in] object Object to retire
+ * \param[in] cb     Destructor of the object
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_NOMEM on a memory allocation error (the object is not retired)
+ */
+IPX_API int
+ipx_epoch_list_defer(ipx_epoch_list_t *list, void *object, ipx_epoch_cb cb);
+
+/**
+ * \brief Destroy retired objects that are not referenced anymore
+ * \param[in] list List of retired objects
+ * \return Number of objects still waiting for destruction
+ */
+IPX_API size_t
+ipx_epoch_list_reclaim(ipx_epoch_list_t *list);
+
+/**@}*/
+
+#endif // IPFIXCOL_EPOCH_H
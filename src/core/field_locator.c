@@ -0,0 +1,289 @@
+/**
+ * \file src/core/field_locator.c
+ * \brief Template field locators (source file)
+ * \date 2026
+ */
+
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <ipfixcol2.h>
+
+/** Default number of slots of the hash table (power of two)                                 */
+#define FLOC_DEF_SLOTS 64U
+/** Maximum number of cached templates (the cache is cleared when reached)                   */
+#define FLOC_MAX_RECS 65536U
+
+/**
+ * \brief Cached locators of a template
+ *
+ * Records are identified by the template pointer, however, the template could have been freed
+ * and another one allocated at the same address. Therefore, the definition of the template (i.e.
+ * its ID and raw Template Record) is stored after the fields and always compared with the
+ * definition of the template to look up.
+ */
+struct floc_rec {
+    /** Template                                                                              */
+    const struct fds_template *tmplt;
+    /** Template ID                                                                           */
+    uint16_t tmplt_id;
+    /** Length of the raw Template Record (stored after the fields)                           */
+    uint16_t raw_len;
+    /** Result of the lookup (#IPX_OK or #IPX_ERR_FORMAT)                                     */
+    int status;
+    /** Number of matching fields                                                             */
+    uint16_t cnt;
+    /** Matching fields                                                                       */
+    struct ipx_floc_field fields[];
+};
+
+struct ipx_floc {
+    /** Field selection callback                                                              */
+    ipx_floc_match_cb match;
+    /** User data of the callback                                                             */
+    void *data;
+    /** The most recently used record (consecutive records usually share the template)       */
+    const struct floc_rec *last;
+
+    /** Hash table of records (items are struct floc_rec)                                    */
+    struct ipx_htable table;
+};
+
+/**
+ * \brief Get the copy of the raw Template Record of a record
+ * \param[in] rec Record
+ * \return Pointer to the copy
+ */
+static inline const uint8_t *
+floc_rec_raw(const struct floc_rec *rec)
+{
+    return (const uint8_t *) &rec->fields[rec->cnt];
+}
+
+/**
+ * \brief Check if a record describes a template
+ * \param[in] rec   Record
+ * \param[in] tmplt Template
+ * \return True if the record was created from the same definition of the template
+ */
+static inline bool
+floc_rec_valid(const struct floc_rec *rec, const struct fds_template *tmplt)
+{
+    return rec->tmplt == tmplt && rec->tmplt_id == tmplt->id
+        && rec->raw_len == tmplt->raw.length
+        && memcmp(floc_rec_raw(rec), tmplt->raw.data, rec->raw_len) == 0;
+}
+
+/**
+ * \brief Hash function of a template reference
+ * \param[in] tmplt Template
+ * \return Hash value
+ */
+static inline uint64_t
+floc_hash(const struct fds_template *tmplt)
+{
+    return ipx_htable_mix((uint64_t) (uintptr_t) tmplt);
+}
+
+/**
+ * \brief Remove all records from the hash table
+ * \param[in] floc Cache
+ */
+static void
+floc_table_clear(ipx_floc_t *floc)
+{
+    for (size_t idx = 0; idx < floc->table.size; ++idx) {
+        free(floc->table.slots[idx].item);
+    }
+
+    ipx_htable_clear(&floc->table);
+    floc->last = NULL;
+}
+
+/**
+ * \brief Compare a record with a template pointer (callback of the hash table)
+ * \param[in] item Record
+ * \param[in] key  Template
+ * \return True if the record belongs to the template pointer
+ */
+static inline bool
+floc_rec_eq(const void *item, const void *key)
+{
+    return ((const struct floc_rec *) item)->tmplt == key;
+}
+
+/**
+ * \brief Make sure that a new record can be inserted into the hash table
+ *
+ * If the maximum number of records has been reached, the table is cleared first.
+ * \param[in] floc Cache
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_NOMEM if a memory allocation error has occurred
+ */
+static int
+floc_table_reserve(ipx_floc_t *floc)
+{
+    if (floc->table.used >= FLOC_MAX_RECS) {
+        floc_table_clear(floc);
+    }
+
+    return ipx_htable_reserve(&floc->table);
+}
+
+/**
+ * \brief Create a record with locators of matching fields of a template
+ * \param[in] floc  Cache
+ * \param[in] tmplt Template
+ * \return Pointer to the record or NULL (memory allocation error)
+ */
+static struct floc_rec *
+floc_rec_create(const ipx_floc_t *floc, const struct fds_template *tmplt)
+{
+    // Prepare space for all fields (the callback is called only once per field)
+    const uint16_t fields_max = tmplt->fields_cnt_total;
+    const uint16_t raw_len = tmplt->raw.length;
+    struct floc_rec *rec = malloc(sizeof(*rec) + fields_max * sizeof(rec->fields[0]) + raw_len);
+    if (!rec) {
+        return NULL;
+    }
+
+    rec->tmplt = tmplt;
+    rec->tmplt_id = tmplt->id;
+    rec->raw_len = raw_len;
+    rec->status = IPX_OK;
+    rec->cnt = 0;
+
+    for (uint16_t i = 0; i < fields_max; ++i) {
+        const struct fds_tfield *field = &tmplt->fields[i];
+        if (!floc->match(field, floc->data)) {
+            continue;
+        }
+
+        if (field->offset == FDS_IPFIX_VAR_IE_LEN || field->length == FDS_IPFIX_VAR_IE_LEN) {
+            // Position or length of the field differs in each Data Record
+            rec->status = IPX_ERR_FORMAT;
+            rec->cnt = 0;
+            break;
+        }
+
+        struct ipx_floc_field *loc = &rec->fields[rec->cnt++];
+        loc->offset = field->offset;
+        loc->length = field->length;
+        loc->info = field;
+    }
+
+    // Release unused space and append the definition of the template
+    const size_t size = sizeof(*rec) + rec->cnt * sizeof(rec->fields[0]) + raw_len;
+    struct floc_rec *rec_new = realloc(rec, size);
+    rec = (rec_new != NULL) ? rec_new : rec;
+    memcpy((uint8_t *) floc_rec_raw(rec), tmplt->raw.data, raw_len);
+    return rec;
+}
+
+ipx_floc_t *
+ipx_floc_create(ipx_floc_match_cb match, void *data)
+{
+    struct ipx_floc *floc = calloc(1, sizeof(*floc));
+    if (!floc) {
+        return NULL;
+    }
+
+    if (ipx_htable_init(&floc->table, FLOC_DEF_SLOTS) != IPX_OK) {
+        free(floc);
+        return NULL;
+    }
+
+    floc->match = match;
+    floc->data = data;
+    return floc;
+}
+
+void
+ipx_floc_destroy(ipx_floc_t *floc)
+{
+    floc_table_clear(floc);
+    ipx_htable_destroy(&floc->table);
+    free(floc);
+}
+
+int
+ipx_floc_get(ipx_floc_t *floc, const struct fds_template *tmplt,
+    const struct ipx_floc_field **fields, uint16_t *cnt)
+{
+    const uint64_t hash = floc_hash(tmplt);
+    const struct floc_rec *rec = floc->last;
+    if (rec == NULL || !floc_rec_valid(rec, tmplt)) {
+        // The record might describe a freed template previously allocated at the same address
+        struct ipx_htable_slot *slot = ipx_htable_find(&floc->table, hash, &floc_rec_eq, tmplt);
+        rec = (slot != NULL) ? slot->item : NULL;
+
+        if (slot != NULL && !floc_rec_valid(rec, tmplt)) {
+            // The original template has been freed and its address reused by this one
+            struct floc_rec *rec_new = floc_rec_create(floc, tmplt);
+            if (!rec_new) {
+                return IPX_ERR_NOMEM;
+            }
+
+            if (floc->last == slot->item) {
+                floc->last = NULL;
+            }
+            free(slot->item);
+            slot->item = rec_new;
+            rec = rec_new;
+        }
+    }
+
+    if (rec == NULL) {
+        if (floc_table_reserve(floc) != IPX_OK) {
+            return IPX_ERR_NOMEM;
+        }
+
+        struct floc_rec *rec_new = floc_rec_create(floc, tmplt);
+        if (!rec_new) {
+            return IPX_ERR_NOMEM;
+        }
+
+        ipx_htable_insert(&floc->table, hash, rec_new);
+        rec = rec_new;
+    }
+
+    floc->last = rec;
+    *fields = rec->fields;
+    *cnt = rec->cnt;
+    return rec->status;
+}
@@ -0,0 +1,138 @@
+/**
+ * \file src/core/htable.c
+ * \brief Hash table with open addressing (source file)
+ * \date 2026
+ */
+
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <ipfixcol2.h>
+
+int
+ipx_htable_init(struct ipx_htable *table, size_t size)
+{
+    table->slots = calloc(size, sizeof(*table->slots));
+    if (!table->slots) {
+        return IPX_ERR_NOMEM;
+    }
+
+    table->size = size;
+    table->used = 0;
+    return IPX_OK;
+}
+
+void
+ipx_htable_destroy(struct ipx_htable *table)
+{
+    free(table->slots);
+    table->slots = NULL;
+    table->size = 0;
+    table->used = 0;
+}
+
+void
+ipx_htable_clear(struct ipx_htable *table)
+{
+    memset(table->slots, 0, table->size * sizeof(*table->slots));
+    table->used = 0;
+}
+
+void
+ipx_htable_insert(struct ipx_htable *table, uint64_t hash, void *item)
+{
+    const size_t mask = table->size - 1;
+    size_t idx = hash & mask;
+    while (table->slots[idx].item != NULL) {
+        idx = (idx + 1) & mask;
+    }
+
+    table->slots[idx].hash = hash;
+    table->slots[idx].item = item;
+    table->used++;
+}
+
+int
+ipx_htable_reserve(struct ipx_htable *table)
+{
+    if (2 * (table->used + 1) <= table->size) {
+        return IPX_OK;
+    }
+
+    struct ipx_htable table_new;
+    if (ipx_htable_init(&table_new, 2 * table->size) != IPX_OK) {
+        return IPX_ERR_NOMEM;
+    }
+
+    for (size_t idx = 0; idx < table->size; ++idx) {
+        const struct ipx_htable_slot *slot = &table->slots[idx];
+        if (slot->item != NULL) {
+            ipx_htable_insert(&table_new, slot->hash, slot->item);
+        }
+    }
+
+    free(table->slots);
+    *table = table_new;
+    return IPX_OK;
+}
+
+void
+ipx_htable_remove(struct ipx_htable *table, struct ipx_htable_slot *slot)
+{
+    const size_t mask = table->size - 1;
+    size_t gap = (size_t) (slot - table->slots);
+    size_t idx = gap;
+
+    while (true) {
+        idx = (idx + 1) & mask;
+        const struct ipx_htable_slot *next = &table->slots[idx];
+        if (next->item == NULL) {
+            break;
+        }
+
+        // Move the item only if its preferred slot is not between the gap and its position
+        const size_t home = next->hash & mask;
+        if (((idx - home) & mask) >= ((idx - gap) & mask)) {
+            table->slots[gap] = *next;
+            gap = idx;
+        }
+    }
+
+    table->slots[gap].item = NULL;
+    table->used--;
+}
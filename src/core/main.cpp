@@ -46,6 +46,7 @@
 #include <unistd.h>
 #include <cstdlib>
 #include <cinttypes>
+#include <strings.h> // strcasecmp()
 
 #include <ipfixcol2.h>
 #include <iostream>
@@ -84,7 +85,8 @@ print_help()
 {
     std::cout
         << "IPFIX Collector daemon\n"
-        << "Usage: ipfixcol2 [-c FILE] [-p PATH] [-e DIR] [-P FILE] [-r SIZE] [-vVhLdu]\n"
+        << "Usage: ipfixcol2 [-c FILE] [-p PATH] [-e DIR] [-P FILE] [-r SIZE] [-R TYPE] [-vVhLdHu]\n"
+        << "                 [-s PATH] [-S FMT]\n"
         << "  -c FILE   Path to the startup configuration file\n"
         << "            (default: " << IPX_DEFAULT_STARTUP_CONFIG << ")\n"
         << "  -p PATH   Add path to a directory with plugins or to a file\n"
@@ -94,6 +96,12 @@ print_help()
         << "  -P FILE   Path to a PID file (without this option, no PID file is created)\n"
         << "  -d        Run as a standalone daemon process\n"
         << "  -r SIZE   Ring buffer size (default: " << ipx_configurator::RING_DEF_SIZE << ")\n"
+        << "  -R TYPE   Ring buffer implementation \"mutex\" or \"lockfree\" (default: mutex)\n"
+        << "  -H        Use huge pages for buffers of received IPFIX Messages\n"
+        << "  -s PATH   Publish pipeline statistics to a periodically rewritten file or,\n"
+        << "            if prefixed with \"" IPX_STATS_UNIX_PREFIX "\", to a Unix socket\n"
+        << "  -S FMT    Format of pipeline statistics \"prometheus\" or \"json\"\n"
+        << "            (default: prometheus)\n"
         << "  -h        Show this help message and exit\n"
         << "  -V        Show version information and exit\n"
         << "  -L        List all available plugins and exit\n"
@@ -190,6 +198,55 @@ ring_size_change(ipx_configurator &conf, const char *new_size)
     return IPX_OK;
 }
 
+/**
+ * \brief Change implementation of ring buffers
+ * \param[in] conf     IPFIXcol configurator
+ * \param[in] new_type New type (from command line)
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_FORMAT if the \p new_type is not valid type
+ */
+static int
+ring_type_change(ipx_configurator &conf, const char *new_type)
+{
+    enum ipx_ring_type type;
+    if (strcasecmp(new_type, "mutex") == 0) {
+        type = IPX_RING_MUTEX;
+    } else if (strcasecmp(new_type, "lockfree") == 0) {
+        type = IPX_RING_LOCKFREE;
+    } else {
+        IPX_ERROR(module, "Type '%s' of the ring buffers is not valid (expected 'mutex' or "
+            "'lockfree')!", new_type);
+        return IPX_ERR_FORMAT;
+    }
+
+    conf.set_buffer_type(type);
+    IPX_INFO(module, "Ring buffer type set to '%s'", new_type);
+    return IPX_OK;
+}
+
+/**
+ * \brief Change format of pipeline statistics
+ * \param[in] fmt_str Format name (from command line)
+ * \param[out] fmt    Format
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_FORMAT if the \p fmt_str is not valid format
+ */
+static int
+stats_fmt_parse(const char *fmt_str, enum ipx_stats_fmt &fmt)
+{
+    if (strcasecmp(fmt_str, "prometheus") == 0) {
+        fmt = IPX_STATS_FMT_PROMETHEUS;
+    } else if (strcasecmp(fmt_str, "json") == 0) {
+        fmt = IPX_STATS_FMT_JSON;
+    } else {
+        IPX_ERROR(module, "Format '%s' of statistics is not valid (expected 'prometheus' or "
+            "'json')!", fmt_str);
+        return IPX_ERR_FORMAT;
+    }
+
+    return IPX_OK;
+}
+
 /**
  * \brief Main function
  * \param[in] argc Number of arguments
@@ -202,6 +259,9 @@ int main(int argc, char *argv[])
     const char *cfg_iedir = nullptr;
     const char *pid_file = nullptr;
     const char *ring_size = nullptr;
+    const char *ring_type = nullptr;
+    const char *stats_path = nullptr;
+    const char *stats_fmt = nullptr;
     bool daemon_en = false;
     bool list_only = false;
     ipx_configurator configurator;
@@ -209,7 +269,7 @@ int main(int argc, char *argv[])
     // Parse configuration
     int opt;
     opterr = 0; // Disable default error messages
-    while ((opt = getopt(argc, argv, "c:vVhLdp:e:P:r:u")) != -1) {
+    while ((opt = getopt(argc, argv, "c:vVhLdp:e:P:r:R:Hus:S:")) != -1) {
         switch (opt) {
         case 'c': // Configuration file
             cfg_startup = optarg;
@@ -241,6 +301,18 @@ int main(int argc, char *argv[])
         case 'r': // Change ring size
             ring_size = optarg;
             break;
+        case 'R': // Change ring type
+            ring_type = optarg;
+            break;
+        case 'H': // Use huge pages
+            configurator.set_hugepages(true);
+            break;
+        case 's': // Endpoint of pipeline statistics
+            stats_path = optarg;
+            break;
+        case 'S': // Format of pipeline statistics
+            stats_fmt = optarg;
+            break;
         case 'u': // Disable automatic plugin unload
             configurator.plugins.auto_unload(false);
             break;
@@ -285,6 +357,20 @@ int main(int argc, char *argv[])
         return EXIT_FAILURE;
     }
 
+    if (ring_type != nullptr && ring_type_change(configurator, ring_type) != IPX_OK) {
+        // Failed to set the type
+        return EXIT_FAILURE;
+    }
+
+    if (stats_path != nullptr) {
+        enum ipx_stats_fmt fmt = IPX_STATS_FMT_PROMETHEUS;
+        if (stats_fmt != nullptr && stats_fmt_parse(stats_fmt, fmt) != IPX_OK) {
+            // Failed to set the format
+            return EXIT_FAILURE;
+        }
+        configurator.set_stats(stats_path, fmt);
+    }
+
     // Create a PID file
     if (pid_file != nullptr && pid_create(pid_file) != IPX_OK) {
         pid_file = nullptr; // Prevent removing the file
@@ -83,6 +83,7 @@ static inline void
 ipx_msg_header_init(struct ipx_msg *header, enum ipx_msg_type type)
 {
     header->type = type;
+    header->ref_cnt = 0;
 }
 
 /**
@@ -120,6 +121,20 @@ ipx_msg_header_cnt_dec(struct ipx_msg *header)
     return (__atomic_sub_fetch(&header->ref_cnt, 1U, __ATOMIC_SEQ_CST) == 0);
 }
 
+/**
+ * \brief Check if a message is shared by replicas of an intermediate instance
+ *
+ * If the reference counter is zero, the message has been never shared and the caller is
+ * its only user. Otherwise, the caller must release its reference by ipx_msg_header_cnt_dec().
+ * \param[in] header Pointer to the header of the message
+ * \return True or false
+ */
+static inline bool
+ipx_msg_header_cnt_shared(struct ipx_msg *header)
+{
+    return (__atomic_load_n(&header->ref_cnt, __ATOMIC_ACQUIRE) != 0);
+}
+
 /**
  * \brief Cast from a base message to an IPFIX message
  * \param[in] msg Pointer to the base message
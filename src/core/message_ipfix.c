@@ -44,53 +44,411 @@
 #include "message_base.h"
 #include "message_ipfix.h"
 #include "context.h"
+#include "buffer_pool.h"
+#include "epoch.h"
 
 #include <stddef.h> // offsetof
 #include <stdlib.h> // free
+#include <string.h> // memset
+
+#ifndef IPX_CLINE_SIZE
+/** Expected CPU cache-line size        */
+#define IPX_CLINE_SIZE 64
+#endif
+/** Cache-line alignment                */
+#define __ipx_cache_aligned __attribute__((__aligned__(IPX_CLINE_SIZE)))
+
+/** Number of size classes of the wrapper pool                                                */
+#define POOL_CLASS_CNT (6U)
+/** Size of wrappers in the smallest class of the pool (in bytes)                             */
+#define POOL_CLASS_SIZE_MIN (8192U)
+/** Maximum amount of memory cached in one class of the pool (in bytes)                       */
+#define POOL_CLASS_MEM_MAX (8U * 1024U * 1024U)
+/** Minimum number of wrappers that can be cached in one class of the pool                    */
+#define POOL_CLASS_CNT_MIN (32U)
+/** Expected average size of an IPFIX Data Record (used to estimate the size of a wrapper)    */
+#define POOL_REC_SIZE_HINT (48U)
+/** Special value of a free-list of returned wrappers that marks a destroyed pool             */
+#define POOL_CLOSED ((struct ipx_msg_ipfix *) UINTPTR_MAX)
 
 // Check correctness of structure implementation
 static_assert(offsetof(struct ipx_msg_ipfix, msg_header.type) == 0,
     "Message header must be the first element of each IPFIXcol message.");
 
+/** Size class of the pool                                                                    */
+struct pool_class {
+    /**
+     * Free-list of wrappers returned by any thread (lock-free stack)
+     * \note The owner takes all wrappers at once, therefore, the stack doesn't suffer from
+     *   the ABA problem. If the pool has been destroyed, the value is #POOL_CLOSED.
+     */
+    struct ipx_msg_ipfix *returned __ipx_cache_aligned;
+    /** Number of cached wrappers, i.e. in both free-lists (accessed only atomically)         */
+    uint32_t cnt;
+
+    /** Free-list of wrappers ready to reuse (accessed only by the owner)                      */
+    struct ipx_msg_ipfix *local __ipx_cache_aligned;
+    /** Maximum number of cached wrappers (additional returned wrappers are freed)           */
+    uint32_t cnt_max;
+    /** Size of wrappers in the class (in bytes)                                              */
+    size_t size;
+};
+
+/** Pool of IPFIX Message wrappers                                                            */
+struct ipx_msg_ipfix_pool {
+    /** Size classes (sorted by size of wrappers)                                             */
+    struct pool_class classes[POOL_CLASS_CNT];
+    /**
+     * Reference counter (accessed only atomically)
+     * \note The value represents the owner and all allocated wrappers that haven't been freed
+     *   yet (i.e. wrappers in the pipeline and in the free-lists)
+     */
+    uint64_t refs __ipx_cache_aligned;
+};
+
 size_t
 ipx_msg_ipfix_size(uint32_t rec_cnt, size_t rec_size)
 {
     return offsetof(struct ipx_msg_ipfix, recs) + (rec_cnt * rec_size);
 }
 
-ipx_msg_ipfix_t *
-ipx_msg_ipfix_create(const ipx_ctx_t *plugin_ctx, const struct ipx_msg_ctx *msg_ctx,
-    uint8_t *msg_data, uint16_t msg_size)
+ipx_msg_ipfix_pool_t *
+ipx_msg_ipfix_pool_create()
 {
-    const size_t rec_size = ipx_ctx_recsize_get(plugin_ctx);
-    const size_t new_size = ipx_msg_ipfix_size(REC_DEF_CNT, rec_size);
-    struct ipx_msg_ipfix *wrapper = calloc(1, new_size);
+    struct ipx_msg_ipfix_pool *pool = aligned_alloc(IPX_CLINE_SIZE, sizeof(*pool));
+    if (!pool) {
+        return NULL;
+    }
+
+    for (uint32_t i = 0; i < POOL_CLASS_CNT; ++i) {
+        struct pool_class *cls = &pool->classes[i];
+        cls->returned = NULL;
+        cls->cnt = 0;
+        cls->local = NULL;
+        cls->size = ((size_t) POOL_CLASS_SIZE_MIN) << i;
+        cls->cnt_max = POOL_CLASS_MEM_MAX / cls->size;
+        if (cls->cnt_max < POOL_CLASS_CNT_MIN) {
+            cls->cnt_max = POOL_CLASS_CNT_MIN;
+        }
+    }
+
+    pool->refs = 1; // The owner
+    return pool;
+}
+
+/**
+ * \brief Release a reference to a pool (the pool is freed after the last reference)
+ * \param[in] pool Pool
+ */
+static inline void
+pool_release(struct ipx_msg_ipfix_pool *pool)
+{
+    if (__atomic_sub_fetch(&pool->refs, 1, __ATOMIC_ACQ_REL) == 0) {
+        free(pool);
+    }
+}
+
+/**
+ * \brief Free a wrapper that belongs to a pool
+ * \param[in] wrapper Wrapper to free
+ */
+static inline void
+pool_wrapper_free(struct ipx_msg_ipfix *wrapper)
+{
+    struct ipx_msg_ipfix_pool *pool = wrapper->pool;
+    free(wrapper);
+    pool_release(pool);
+}
+
+/**
+ * \brief Free all wrappers in a free-list
+ * \param[in] list First wrapper of the list (can be NULL)
+ */
+static void
+pool_list_free(struct ipx_msg_ipfix *list)
+{
+    while (list != NULL) {
+        struct ipx_msg_ipfix *next = list->pool_next;
+        pool_wrapper_free(list);
+        list = next;
+    }
+}
+
+void
+ipx_msg_ipfix_pool_destroy(ipx_msg_ipfix_pool_t *pool)
+{
+    for (uint32_t i = 0; i < POOL_CLASS_CNT; ++i) {
+        struct pool_class *cls = &pool->classes[i];
+        pool_list_free(cls->local);
+        cls->local = NULL;
+
+        // From now, returned wrappers are freed immediately
+        pool_list_free(__atomic_exchange_n(&cls->returned, POOL_CLOSED, __ATOMIC_ACQ_REL));
+    }
+
+    pool_release(pool);
+}
+
+/**
+ * \brief Get a wrapper from a pool
+ *
+ * \warning Only the owner of the pool can call this function.
+ * \param[in] pool Pool
+ * \param[in] size Minimal size of the wrapper (in bytes)
+ * \return Pointer to the wrapper (only the \p pool and \p alloc_size fields are valid)
+ * \return NULL if the size is too big for the pool or a memory allocation has failed
+ */
+static struct ipx_msg_ipfix *
+pool_get(struct ipx_msg_ipfix_pool *pool, size_t size)
+{
+    struct pool_class *cls = NULL;
+    for (uint32_t i = 0; i < POOL_CLASS_CNT; ++i) {
+        if (pool->classes[i].size >= size) {
+            cls = &pool->classes[i];
+            break;
+        }
+    }
+
+    if (!cls) {
+        return NULL;
+    }
+
+    struct ipx_msg_ipfix *wrapper = cls->local;
+    if (!wrapper) {
+        // Take all wrappers returned by other threads
+        wrapper = __atomic_exchange_n(&cls->returned, NULL, __ATOMIC_ACQUIRE);
+    }
+
+    if (wrapper != NULL) {
+        assert(wrapper != POOL_CLOSED && wrapper->pool == pool);
+        cls->local = wrapper->pool_next;
+        __atomic_sub_fetch(&cls->cnt, 1, __ATOMIC_RELAXED);
+        wrapper->alloc_size = cls->size;
+        return wrapper;
+    }
+
+    // The pool is empty
+    wrapper = malloc(cls->size);
     if (!wrapper) {
         return NULL;
     }
 
+    __atomic_add_fetch(&pool->refs, 1, __ATOMIC_RELAXED);
+    wrapper->pool = pool;
+    wrapper->alloc_size = cls->size;
+    return wrapper;
+}
+
+/**
+ * \brief Return a wrapper to its pool
+ *
+ * The function can be called by any thread.
+ * \param[in] wrapper Wrapper to return
+ */
+static void
+pool_put(struct ipx_msg_ipfix *wrapper)
+{
+    struct ipx_msg_ipfix_pool *pool = wrapper->pool;
+    struct pool_class *cls = NULL;
+
+    // Find the class (the wrapper could have been reallocated and its size is arbitrary)
+    for (uint32_t i = POOL_CLASS_CNT; i-- > 0; ) {
+        if (pool->classes[i].size <= wrapper->alloc_size) {
+            cls = &pool->classes[i];
+            break;
+        }
+    }
+
+    assert(cls != NULL);
+    if (wrapper->alloc_size >= 2 * cls->size
+            || __atomic_load_n(&cls->cnt, __ATOMIC_RELAXED) >= cls->cnt_max) {
+        // Too big or too many cached wrappers
+        pool_wrapper_free(wrapper);
+        return;
+    }
+
+    __atomic_add_fetch(&cls->cnt, 1, __ATOMIC_RELAXED);
+    struct ipx_msg_ipfix *head = __atomic_load_n(&cls->returned, __ATOMIC_RELAXED);
+    do {
+        if (head == POOL_CLOSED) {
+            // The pool has been already destroyed
+            pool_wrapper_free(wrapper);
+            return;
+        }
+        wrapper->pool_next = head;
+    } while (!__atomic_compare_exchange_n(&cls->returned, &head, wrapper, true,
+        __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+    // Note: The wrapper or even the pool could have been freed by the owner here!
+}
+
+/**
+ * \brief Create a wrapper around a raw IPFIX (or NetFlow) Message
+ * \param[in] plugin_ctx Context of the plugin
+ * \param[in] msg_ctx    Message context
+ * \param[in] msg_data   IPFIX (or NetFlow) Message
+ * \param[in] msg_size   Size of the Message
+ * \param[in] raw_buffer Pooled buffer that holds the Message (NULL, if allocated by malloc())
+ * \return Pointer or NULL (memory allocation error)
+ */
+static struct ipx_msg_ipfix *
+msg_create(const ipx_ctx_t *plugin_ctx, const struct ipx_msg_ctx *msg_ctx,
+    uint8_t *msg_data, uint16_t msg_size, uint8_t *raw_buffer)
+{
+    const size_t rec_size = ipx_ctx_recsize_get(plugin_ctx);
+    // Estimate the number of Data Records to avoid reallocation of the wrapper during parsing
+    uint32_t rec_cnt = msg_size / POOL_REC_SIZE_HINT;
+    if (rec_cnt < REC_DEF_CNT) {
+        rec_cnt = REC_DEF_CNT;
+    }
+
+    const size_t new_size = ipx_msg_ipfix_size(rec_cnt, rec_size);
+    ipx_msg_ipfix_pool_t *pool = ipx_ctx_msg_pool_get(plugin_ctx);
+    struct ipx_msg_ipfix *wrapper = NULL;
+    if (pool != NULL) {
+        wrapper = pool_get(pool, new_size);
+    }
+
+    if (!wrapper) {
+        // Pool is not available or the message is too big
+        wrapper = malloc(new_size);
+        if (!wrapper) {
+            return NULL;
+        }
+        wrapper->pool = NULL;
+        wrapper->alloc_size = new_size;
+    }
+
+    // Clear everything except records (each record is cleared when added)
+    pool = wrapper->pool;
+    const size_t alloc_size = wrapper->alloc_size;
+    memset(wrapper, 0, offsetof(struct ipx_msg_ipfix, recs));
+    wrapper->pool = pool;
+    wrapper->alloc_size = alloc_size;
+
     ipx_msg_header_init(&wrapper->msg_header, IPX_MSG_IPFIX);
     wrapper->ctx = *msg_ctx;
     wrapper->raw_pkt = msg_data;
     wrapper->raw_size = msg_size;
+    wrapper->raw_buffer = raw_buffer;
     wrapper->sets.cnt_alloc = SET_DEF_CNT;
-    wrapper->rec_info.cnt_alloc = REC_DEF_CNT;
+    wrapper->rec_info.cnt_alloc = (alloc_size - offsetof(struct ipx_msg_ipfix, recs)) / rec_size;
     wrapper->rec_info.rec_size = rec_size;
     return wrapper;
 }
 
+ipx_msg_ipfix_t *
+ipx_msg_ipfix_create(const ipx_ctx_t *plugin_ctx, const struct ipx_msg_ctx *msg_ctx,
+    uint8_t *msg_data, uint16_t msg_size)
+{
+    ipx_buffer_pool_t *pool = ipx_ctx_buffer_pool_get(plugin_ctx);
+    const bool pooled = (pool != NULL && ipx_buffer_pool_owns(pool, msg_data));
+    return msg_create(plugin_ctx, msg_ctx, msg_data, msg_size, pooled ? msg_data : NULL);
+}
+
+ipx_msg_ipfix_t *
+ipx_msg_ipfix_create_ref(const ipx_ctx_t *plugin_ctx, const struct ipx_msg_ctx *msg_ctx,
+    uint8_t *buffer, uint8_t *msg_data, uint16_t msg_size)
+{
+    ipx_buffer_pool_t *pool = ipx_ctx_buffer_pool_get(plugin_ctx);
+    if (pool != NULL && ipx_buffer_pool_owns(pool, buffer)) {
+        struct ipx_msg_ipfix *msg = msg_create(plugin_ctx, msg_ctx, msg_data, msg_size, buffer);
+        if (msg != NULL) {
+            ipx_buffer_pool_ref(buffer);
+        }
+        return msg;
+    }
+
+    // The buffer cannot be shared, make a private copy
+    uint8_t *copy = ipx_msg_ipfix_buffer_alloc(plugin_ctx, msg_size);
+    if (!copy) {
+        return NULL;
+    }
+
+    memcpy(copy, msg_data, msg_size);
+    ipx_msg_ipfix_t *msg = ipx_msg_ipfix_create(plugin_ctx, msg_ctx, copy, msg_size);
+    if (!msg) {
+        ipx_msg_ipfix_buffer_free(plugin_ctx, copy);
+    }
+    return msg;
+}
+
+/**
+ * \brief Free the raw IPFIX (or NetFlow) packet of a message
+ * \param[in] msg IPFIX Message wrapper
+ */
+static inline void
+raw_free(struct ipx_msg_ipfix *msg)
+{
+    if (msg->raw_buffer != NULL) {
+        ipx_buffer_pool_free(msg->raw_buffer);
+    } else {
+        free(msg->raw_pkt);
+    }
+}
+
+void
+ipx_msg_ipfix_raw_replace(struct ipx_msg_ipfix *msg, uint8_t *data, uint16_t size)
+{
+    raw_free(msg);
+    msg->raw_pkt = data;
+    msg->raw_size = size;
+    msg->raw_buffer = NULL;
+}
+
+uint8_t *
+ipx_msg_ipfix_buffer_alloc(const ipx_ctx_t *plugin_ctx, size_t size)
+{
+    ipx_buffer_pool_t *pool = ipx_ctx_buffer_pool_get(plugin_ctx);
+    uint8_t *buffer = NULL;
+    if (pool != NULL) {
+        buffer = ipx_buffer_pool_alloc(pool, size);
+    }
+
+    if (!buffer) {
+        // Pool is not available or the buffer is too big
+        buffer = malloc(size);
+    }
+
+    return buffer;
+}
+
+void
+ipx_msg_ipfix_buffer_free(const ipx_ctx_t *plugin_ctx, uint8_t *buffer)
+{
+    if (!buffer) {
+        return;
+    }
+
+    ipx_buffer_pool_t *pool = ipx_ctx_buffer_pool_get(plugin_ctx);
+    if (pool != NULL && ipx_buffer_pool_owns(pool, buffer)) {
+        ipx_buffer_pool_free(buffer);
+    } else {
+        free(buffer);
+    }
+}
+
 void
 ipx_msg_ipfix_destroy(ipx_msg_ipfix_t *msg)
 {
     // Destroy the IPFIX packet
-    free(msg->raw_pkt);
+    raw_free(msg);
 
     // Destroy the wrapper
     if (msg->sets.extended) {
         free(msg->sets.extended);
     }
     ipx_msg_header_destroy((ipx_msg_t *) msg);
-    free(msg);
+
+    // References to templates, snapshots, etc. are not used anymore
+    if (msg->epoch != 0) {
+        ipx_epoch_release(msg->epoch);
+    }
+
+    if (msg->pool != NULL) {
+        pool_put(msg);
+    } else {
+        free(msg);
+    }
 }
 
 uint8_t *
@@ -182,6 +540,7 @@ ipx_msg_ipfix_add_drec_ref(struct ipx_msg_ipfix **msg_ref)
         }
 
         msg_new->rec_info.cnt_alloc = alloc_new;
+        msg_new->alloc_size = alloc_size;
         msg = msg_new;
         *msg_ref = msg_new;
     }
@@ -189,5 +548,41 @@ ipx_msg_ipfix_add_drec_ref(struct ipx_msg_ipfix **msg_ref)
     assert(msg->rec_info.cnt_valid < msg->rec_info.cnt_alloc);
     const size_t offset = msg->rec_info.cnt_valid * msg->rec_info.rec_size;
     msg->rec_info.cnt_valid++;
-    return ((struct ipx_ipfix_record *) (((uint8_t *) msg->recs) + offset));
+
+    struct ipx_ipfix_record *rec = (struct ipx_ipfix_record *) (((uint8_t *) msg->recs) + offset);
+    rec->ext_mask = 0;
+    return rec;
+}
+
+struct ipx_ipfix_record *
+ipx_msg_ipfix_add_drec_refs(struct ipx_msg_ipfix **msg_ref, uint32_t cnt)
+{
+    assert(cnt > 0);
+    struct ipx_msg_ipfix *msg = *msg_ref;
+    if (msg->rec_info.cnt_alloc - msg->rec_info.cnt_valid < cnt) {
+        // Reallocation of the message is necessary (at least double the size)
+        const uint64_t cnt_required = (uint64_t) msg->rec_info.cnt_valid + cnt;
+        uint64_t alloc_new = 2U * (uint64_t) msg->rec_info.cnt_alloc;
+        if (alloc_new < cnt_required) {
+            alloc_new = cnt_required;
+        }
+        if (alloc_new > UINT32_MAX) {
+            return NULL;
+        }
+
+        const size_t alloc_size = ipx_msg_ipfix_size((uint32_t) alloc_new, msg->rec_info.rec_size);
+        struct ipx_msg_ipfix *msg_new = realloc(msg, alloc_size);
+        if (!msg_new) {
+            return NULL;
+        }
+
+        msg_new->rec_info.cnt_alloc = (uint32_t) alloc_new;
+        msg_new->alloc_size = alloc_size;
+        msg = msg_new;
+        *msg_ref = msg_new;
+    }
+
+    const size_t offset = msg->rec_info.cnt_valid * msg->rec_info.rec_size;
+    msg->rec_info.cnt_valid += cnt;
+    return (struct ipx_ipfix_record *) (((uint8_t *) msg->recs) + offset);
 }
\ No newline at end of file
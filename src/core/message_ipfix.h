@@ -63,12 +63,25 @@ struct ipx_msg_ipfix {
     /** Message type ID. This MUST be always the first element!              */
     struct ipx_msg msg_header;
 
+    /** Pool of the wrapper (NULL, if the wrapper doesn't belong to a pool)  */
+    struct ipx_msg_ipfix_pool *pool;
+    /** Next wrapper in a free-list of the pool (valid only inside the pool) */
+    struct ipx_msg_ipfix *pool_next;
+    /** Size of the allocated memory block of the wrapper (in bytes)         */
+    size_t alloc_size;
+
     /** Packet context  */
     struct ipx_msg_ctx ctx;
     /** Raw IPFIX packet from a source (in Network Byte Order)               */
     uint8_t *raw_pkt;
     /** Size of raw message                                                  */
     uint16_t raw_size;
+    /** Buffer of a buffer pool that holds the raw IPFIX packet (NULL, if the
+     *  packet has been allocated by malloc())                              */
+    uint8_t *raw_buffer;
+    /** Epoch acquired by a parser before references to templates were added
+     *  (0 == no references, see ipx_epoch_acquire())                        */
+    uint64_t epoch;
 
     struct {
         /** Array of sets (valid only when #cnt_valid <= SET_DEF_CNT)       */
@@ -116,4 +129,56 @@ struct ipx_msg_ipfix {
 size_t
 ipx_msg_ipfix_size(uint32_t rec_cnt, size_t rec_size);
 
+/**
+ * \brief Add multiple new IPFIX Data Record descriptions at once
+ *
+ * The records are uninitialized (including the extension mask) and the user MUST fill them!
+ * They are stored consecutively, the distance between two records is the size of a record
+ * of the wrapper (i.e. \p msg_ref->rec_info.rec_size) which includes registered extensions.
+ * \warning The wrapper \p msg_ref can be reallocated and different pointer can be returned!
+ * \param[in,out] msg_ref IPFIX Message wrapper
+ * \param[in]     cnt     Number of records to add (must be non-zero)
+ * \return Pointer to the first record or NULL (memory allocation error)
+ */
+struct ipx_ipfix_record *
+ipx_msg_ipfix_add_drec_refs(struct ipx_msg_ipfix **msg_ref, uint32_t cnt);
+
+/**
+ * \brief Replace the raw IPFIX (or NetFlow) packet of a message
+ *
+ * The previous packet is freed (or returned to its buffer pool).
+ * \param[in] msg  IPFIX Message wrapper
+ * \param[in] data New packet (MUST be allocated by malloc())
+ * \param[in] size Size of the new packet
+ */
+void
+ipx_msg_ipfix_raw_replace(struct ipx_msg_ipfix *msg, uint8_t *data, uint16_t size);
+
+/** Pool of recyclable IPFIX Message wrappers                                */
+typedef struct ipx_msg_ipfix_pool ipx_msg_ipfix_pool_t;
+
+/**
+ * \brief Create a pool of IPFIX Message wrappers
+ *
+ * The pool keeps wrappers of destroyed IPFIX Messages in a few size classes so they can be
+ * reused by ipx_msg_ipfix_create() without calling the memory allocator. New wrappers can be
+ * taken from the pool only by a single thread (i.e. the thread of the input instance that owns
+ * the pool), however, wrappers can be returned by any thread (usually by a thread of the output
+ * instance that destroys the message).
+ * \return Pointer to the pool or NULL (memory allocation error)
+ */
+ipx_msg_ipfix_pool_t *
+ipx_msg_ipfix_pool_create();
+
+/**
+ * \brief Destroy a pool of IPFIX Message wrappers
+ *
+ * All cached wrappers are freed immediately. Wrappers that are still in use (i.e. messages
+ * in the pipeline) are freed when the messages are destroyed. The pool itself is freed as soon
+ * as the last message is destroyed.
+ * \param[in] pool Pool to destroy
+ */
+void
+ipx_msg_ipfix_pool_destroy(ipx_msg_ipfix_pool_t *pool);
+
 #endif // IPFIXCOL_MESSAGE_IPFIX_INTERNAL_H
@@ -542,9 +542,7 @@ ipx_nf5_conv_process(ipx_nf5_conv_t *conv, ipx_msg_ipfix_t *wrapper)
 
     // Finally, replace the converted NetFlow Message with the new IPFIX Message
     assert(next_set == (ipx_msg + ipx_size));
-    free(wrapper->raw_pkt);
-    wrapper->raw_pkt = ipx_msg;
-    wrapper->raw_size = (uint16_t) ipx_size;
+    ipx_msg_ipfix_raw_replace(wrapper, ipx_msg, (uint16_t) ipx_size);
     return IPX_OK;
 }
 
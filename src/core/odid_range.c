@@ -315,6 +315,67 @@ range_sort(struct ipx_orange *range)
     qsort(range->nodes, range->valid, elem_size, &range_node_cmp);
 }
 
+/**
+ * \brief Get the lowest value of a node
+ * \param[in] node Filter node
+ */
+static inline uint32_t
+range_node_min(const struct range_node *node)
+{
+    return (node->type == RANGE_NODE_VALUE) ? node->val : node->interval.from;
+}
+
+/**
+ * \brief Get the highest value of a node
+ * \param[in] node Filter node
+ */
+static inline uint32_t
+range_node_max(const struct range_node *node)
+{
+    return (node->type == RANGE_NODE_VALUE) ? node->val : node->interval.to;
+}
+
+/**
+ * \brief Merge overlapping and adjacent nodes
+ *
+ * After merging, the nodes are disjoint and, therefore, the array can be binary searched.
+ * \warning The nodes MUST be sorted first!
+ * \param range ODID range filter
+ */
+static void
+range_merge(struct ipx_orange *range)
+{
+    if (range->valid == 0) {
+        return;
+    }
+
+    size_t last = 0;
+    for (size_t idx = 1; idx < range->valid; ++idx) {
+        struct range_node *node_l = &range->nodes[last];
+        const struct range_node *node_r = &range->nodes[idx];
+        const uint32_t max_l = range_node_max(node_l);
+
+        if (max_l != UINT32_MAX && range_node_min(node_r) > max_l + 1) {
+            // Disjoint nodes, keep the next one
+            range->nodes[++last] = *node_r;
+            continue;
+        }
+
+        // Overlapping or adjacent nodes -> extend the previous one
+        const uint32_t max_r = range_node_max(node_r);
+        if (max_r <= max_l) {
+            continue;
+        }
+
+        const uint32_t min_l = range_node_min(node_l);
+        node_l->type = RANGE_NODE_INTERVAL;
+        node_l->interval.from = min_l;
+        node_l->interval.to = max_r;
+    }
+
+    range->valid = last + 1;
+}
+
 
 ipx_orange_t *
 ipx_orange_create()
@@ -381,34 +442,26 @@ ipx_orange_parse(ipx_orange_t *range, const char *expr)
 
     // Sort and optimize
     range_sort(range);
+    range_merge(range);
     return 0;
 }
 
 bool
 ipx_orange_in(const ipx_orange_t *range, uint32_t odid)
 {
-    // Try to find value in the sorted array
-    for (size_t idx = 0; idx < range->valid; ++idx) {
-        const struct range_node *node = &range->nodes[idx];
-        if (node->type == RANGE_NODE_VALUE) {
-            if (odid == node->val) {
-                // Found
-                return true;
-            }
-
-            if (odid < node->val) {
-                break;
-            }
-        }
-
-        if (node->type == RANGE_NODE_INTERVAL) {
-            if (odid >= node->interval.from && odid <= node->interval.to) {
-                return true;
-            }
-
-            if (odid < node->interval.from) {
-                break;
-            }
+    // Binary search in the sorted array of disjoint nodes
+    size_t low = 0;
+    size_t high = range->valid;
+    while (low < high) {
+        const size_t mid = low + (high - low) / 2;
+        const struct range_node *node = &range->nodes[mid];
+        if (odid < range_node_min(node)) {
+            high = mid;
+        } else if (odid > range_node_max(node)) {
+            low = mid + 1;
+        } else {
+            // Found
+            return true;
         }
     }
 
@@ -96,6 +96,9 @@ ipx_orange_parse(ipx_orange_t *range, const char *expr);
 
 /**
  * \brief Check if an ODID value is in the range
+ *
+ * \note Nodes of the filter are merged and sorted during parsing, therefore, the complexity
+ *   of the lookup is logarithmic.
  * \param[in] range ODID range filter
  * \param[in] odid  Observation Domain ID to test
  * \return True or false
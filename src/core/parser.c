@@ -40,7 +40,9 @@
  */
 
 #include <stdlib.h>
+#include <string.h>
 #include <inttypes.h>
+#include <time.h>
 #include <libfds.h>
 #include <ipfixcol2.h>
 
@@ -49,6 +51,8 @@
 #include "parser.h"
 #include "verbose.h"
 #include "fpipe.h"
+#include "epoch.h"
+#include "tstore.h"
 #include "netflow2ipfix/netflow2ipfix.h"
 #include "netflow2ipfix/netflow_structs.h"
 
@@ -77,6 +81,8 @@ struct stream_info {
 enum stream_ctx_flags {
     /** Ignore all IPFIX messages                                      */
     SCF_BLOCK = (1 << 0),
+    /** Templates should be restored from the template store          */
+    SCF_RESTORE = (1 << 1),
 };
 
 /** Type of source data                                                */
@@ -131,6 +137,16 @@ struct parser_rec {
 
     /** Context common for all streams            */
     struct stream_ctx *ctx;
+    /** Next record of the same Transport Session */
+    struct parser_rec *next;
+};
+
+/** Identification of a parser record (key of hash tables) */
+struct parser_key {
+    /** Transport Session                         */
+    const struct ipx_session *session;
+    /** Observation Domain ID                     */
+    uint32_t odid;
 };
 
 /** Main structure of IPFIX message parser         */
@@ -143,12 +159,25 @@ struct ipx_parser {
     /** Source of Information Elements             */
     const struct fds_iemgr *ie_mgr;
 
-    /** Number of pre-allocated records            */
-    size_t recs_alloc;
-    /** Number of valid records                    */
-    size_t recs_valid;
-    /** Array of records                           */
-    struct parser_rec *recs;
+    /** Records indexed by Transport Session and ODID (items are struct parser_rec) */
+    struct ipx_htable recs;
+    /** The first record of each Transport Session (other records are linked to it) */
+    struct ipx_htable sessions;
+    /** The last found record (can be NULL)        */
+    struct parser_rec *rec_last;
+
+    /** Retired templates and snapshots            */
+    ipx_epoch_list_t *deferred;
+
+    /** Template store of UDP sessions (can be NULL)                                */
+    ipx_tstore_t *tstore;
+    /** Monotonic time of the next periodic update of the template store (seconds) */
+    uint64_t tstore_next;
+
+    /** Statistics (points to #stats_local or to statistics of a plugin context) */
+    struct ipx_stats_parser *stats;
+    /** Local statistics (used if no other destination is defined)                */
+    struct ipx_stats_parser stats_local;
 };
 
 /**
@@ -244,6 +273,11 @@ stream_ctx_create(const struct ipx_parser *parser, const struct ipx_session *ses
             session->udp.lifetime.opts_tmplts);
         // Just session type must be correct
         assert(rc == FDS_OK);
+
+        if (parser->tstore != NULL) {
+            // Templates might have been stored before restart of the collector
+            ctx->flags |= SCF_RESTORE;
+        }
     }
 
     // Define source of Information Elements
@@ -297,18 +331,6 @@ stream_ctx_rec_cmp(const void *p1, const void *p2)
     }
 }
 
-/**
- * \brief Sort an array of records within a stream_ctx structure
- * \param[in] ctx Stream context
- */
-static void
-stream_ctx_rec_sort(struct stream_ctx *ctx)
-{
-    const size_t rec_size = sizeof(*ctx->infos);
-    const size_t rec_cnt = ctx->infos_valid;
-    qsort(ctx->infos, rec_cnt, rec_size, &stream_ctx_rec_cmp);
-}
-
 /**
  * \brief Find a stream_info record defined by Stream ID within a stream context
  * \param[in] ctx Stream context structure
@@ -369,74 +391,127 @@ stream_ctx_rec_get(struct stream_ctx **ctx, ipx_stream_t id)
         *ctx = ctx_new;
     }
 
-    // Create a new record, sort and return the record
-    info = &(*ctx)->infos[(*ctx)->infos_valid++];
+    // Find a position of the new record in the sorted array and make space for it
+    struct stream_info *infos = (*ctx)->infos;
+    size_t pos_low = 0;
+    size_t pos_high = (*ctx)->infos_valid;
+    while (pos_low < pos_high) {
+        const size_t pos_mid = pos_low + (pos_high - pos_low) / 2;
+        if (infos[pos_mid].id < id) {
+            pos_low = pos_mid + 1;
+        } else {
+            pos_high = pos_mid;
+        }
+    }
+
+    const size_t move_cnt = (*ctx)->infos_valid - pos_low;
+    memmove(&infos[pos_low + 1], &infos[pos_low], move_cnt * sizeof(*infos));
+    (*ctx)->infos_valid++;
+
+    info = &infos[pos_low];
     info->id = id;
     info->seq_num = 0;
     info->flags = 0;
-
-    stream_ctx_rec_sort(*ctx);
-    // Position has been changed... find it again
-    info = stream_ctx_rec_find(*ctx, id);
-    assert(info != NULL);
     return info;
 }
 
 /**
- * \brief Compare two parser_rec structures
- * \param[in] rec1 First structure
- * \param[in] rec2 Second structure
- * \return An integer less than, equal to, or greater than zero if the first argument is considered
- *   to be respectively less than, equal to, or greater than the second.
+ * \brief Calculate a hash of a combination of Transport Session and Observation Domain ID
+ * \param[in] session Transport Session
+ * \param[in] odid    Observation Domain ID
+ * \return Hash value
  */
-static int
-parser_rec_cmp(const void *rec1, const void *rec2)
+static inline uint64_t
+parser_hash(const struct ipx_session *session, uint32_t odid)
 {
-    const struct parser_rec *rec_l = rec1;
-    const struct parser_rec *rec_r = rec2;
+    // Sessions are aligned pointers, all bits must be mixed
+    return ipx_htable_mix((uint64_t) (uintptr_t) session
+        ^ ((uint64_t) odid * 0x9E3779B97F4A7C15ULL));
+}
 
-    // Array MUST be sorted primary by Transport Session
-    if (rec_l->session != rec_r->session) {
-        return (rec_l->session < rec_r->session) ? (-1) : 1;
-    }
+/**
+ * \brief Compare a record with a combination of Transport Session and ODID
+ * \param[in] item Parser record
+ * \param[in] key  Identification (struct parser_key)
+ * \return True if the record matches
+ */
+static inline bool
+parser_rec_eq(const void *item, const void *key)
+{
+    const struct parser_rec *rec = item;
+    const struct parser_key *id = key;
+    return rec->session == id->session && rec->odid == id->odid;
+}
 
-    if (rec_l->odid == rec_r->odid) {
-        return 0;
-    }
+/**
+ * \brief Compare a record with a Transport Session (ODID is ignored)
+ * \param[in] item Parser record
+ * \param[in] key  Transport Session
+ * \return True if the record belongs to the Transport Session
+ */
+static inline bool
+parser_session_eq(const void *item, const void *key)
+{
+    return ((const struct parser_rec *) item)->session == key;
+}
 
-    return (rec_l->odid < rec_r->odid) ? (-1) : 1;
+/**
+ * \brief Find the first record of a Transport Session
+ * \param[in] parser  Parser structure
+ * \param[in] session Transport Session
+ * \return Pointer to the record or NULL (not found)
+ */
+static inline struct parser_rec *
+parser_session_find(const struct ipx_parser *parser, const struct ipx_session *session)
+{
+    struct ipx_htable_slot *slot = ipx_htable_find(&parser->sessions, parser_hash(session, 0),
+        &parser_session_eq, session);
+    return (slot != NULL) ? slot->item : NULL;
 }
 
 /**
- * \brief Sort an array of parser records
- * \param parser Parser structure
+ * \brief Remove a record from a hash table
+ * \param[in] table Hash table
+ * \param[in] hash  Hash of the record in the table
+ * \param[in] rec   Record to remove (must be present in the table)
  */
 static void
-parser_rec_sort(struct ipx_parser *parser)
+parser_table_remove(struct ipx_htable *table, uint64_t hash, const struct parser_rec *rec)
 {
-    const size_t rec_cnt = parser->recs_valid;
-    const size_t rec_size = sizeof(*parser->recs);
-    qsort(parser->recs, rec_cnt, rec_size, &parser_rec_cmp);
+    struct ipx_htable_slot *slot = ipx_htable_find_item(table, hash, rec);
+    assert(slot != NULL && "The record must be present!");
+    ipx_htable_remove(table, slot);
 }
 
 /**
  * \brief Find a parser record defined by Transport Session and Observation Domain ID within
  *   a parser
+ *
+ * Consecutive messages usually belong to the same combination, therefore, the last found record
+ * is checked first.
  * \param[in] parser Parser structure
  * \param[in] ctx    IPFIX Message context (info about Transport Session, ODID)
  * \return On success returns a pointer to the structure. Otherwise the required record is not
  *   present.
  */
-static struct parser_rec *
+static inline struct parser_rec *
 parser_rec_find(struct ipx_parser *parser, const struct ipx_msg_ctx *ctx)
 {
-    const size_t rec_cnt = parser->recs_valid;
-    const size_t rec_size = sizeof(*parser->recs);
-    struct parser_rec key;
-    key.session = ctx->session;
-    key.odid = ctx->odid;
+    struct parser_rec *rec = parser->rec_last;
+    if (rec != NULL && rec->session == ctx->session && rec->odid == ctx->odid) {
+        return rec;
+    }
 
-    return bsearch(&key, parser->recs, rec_cnt, rec_size, &parser_rec_cmp);
+    const struct parser_key key = {ctx->session, ctx->odid};
+    struct ipx_htable_slot *slot = ipx_htable_find(&parser->recs,
+        parser_hash(ctx->session, ctx->odid), &parser_rec_eq, &key);
+    if (slot == NULL) {
+        return NULL;
+    }
+
+    rec = slot->item;
+    parser->rec_last = rec;
+    return rec;
 }
 
 /**
@@ -458,34 +533,39 @@ parser_rec_get(struct ipx_parser *parser, const struct ipx_msg_ctx *ctx)
         return rec;
     }
 
-    if (parser->recs_valid == parser->recs_alloc) {
-        const size_t alloc_new = 2 * parser->recs_alloc;
-        const size_t alloc_size = alloc_new * sizeof(*parser->recs);
-        struct parser_rec *recs_new = realloc(parser->recs, alloc_size);
-        if (!recs_new) {
-            return NULL;
-        }
+    if (ipx_htable_reserve(&parser->recs) != IPX_OK
+            || ipx_htable_reserve(&parser->sessions) != IPX_OK) {
+        return NULL;
+    }
 
-        parser->recs = recs_new;
-        parser->recs_alloc = alloc_new;
+    // Create a new record
+    rec = malloc(sizeof(*rec));
+    if (!rec) {
+        return NULL;
     }
 
-    // Add a new record, sort and return it
-    rec = &parser->recs[parser->recs_valid];
     rec->session = ctx->session;
     rec->odid = ctx->odid;
+    rec->next = NULL;
     rec->ctx = stream_ctx_create(parser, ctx->session);
     if (!rec->ctx) {
+        free(rec);
         return NULL;
     }
 
     PARSER_INFO(parser, ctx, "New connection detected!", '\0');
 
-    parser->recs_valid++;
-    parser_rec_sort(parser);
-    // Position has been changes... find it again
-    rec = parser_rec_find(parser, ctx);
-    assert(rec != NULL);
+    // Link the record with other records of the same Transport Session
+    struct parser_rec *first = parser_session_find(parser, ctx->session);
+    if (first != NULL) {
+        rec->next = first->next;
+        first->next = rec;
+    } else {
+        ipx_htable_insert(&parser->sessions, parser_hash(ctx->session, 0), rec);
+    }
+
+    ipx_htable_insert(&parser->recs, parser_hash(ctx->session, ctx->odid), rec);
+    parser->rec_last = rec;
     return rec;
 }
 
@@ -517,26 +597,26 @@ session_garbage_destroy(struct session_gabage *grb)
 }
 
 /**
- * \brief Create a garbage message with selected parser records
+ * \brief Create a garbage message with all parser records of a Transport Session
  *
  * \warning Selected records remains in the parser. They must be removed manually.
- * \param[in] parser Parser
- * \param[in] begin  Index of the first record to be included
- * \param[in] end    Index of "past-the-last" record to be included
+ * \param[in] first The first record of the Transport Session
  * \return Pointer or NULL (memory allocation error)
  */
 static ipx_msg_garbage_t *
-parser_rec_to_garbage(struct ipx_parser *parser, size_t begin, size_t end)
+parser_rec_to_garbage(const struct parser_rec *first)
 {
-    assert(begin < end);
-
     // Prepare data structures
     struct session_gabage *garbage = malloc(sizeof(*garbage));
     if (!garbage) {
         return NULL;
     }
 
-    garbage->rec_cnt = end - begin;
+    garbage->rec_cnt = 0;
+    for (const struct parser_rec *rec = first; rec != NULL; rec = rec->next) {
+        garbage->rec_cnt++;
+    }
+
     garbage->recs = malloc(garbage->rec_cnt * sizeof(*garbage->recs));
     if (!garbage->recs) {
         free(garbage);
@@ -544,9 +624,10 @@ parser_rec_to_garbage(struct ipx_parser *parser, size_t begin, size_t end)
     }
 
     // Copy records
-    for (size_t idx = begin, pos = 0; idx < end; ++idx, ++pos) {
+    size_t pos = 0;
+    for (const struct parser_rec *rec = first; rec != NULL; rec = rec->next) {
         assert(pos < garbage->rec_cnt);
-        garbage->recs[pos] = parser->recs[idx].ctx;
+        garbage->recs[pos++] = rec->ctx;
     }
 
     // Wrap the garbage
@@ -591,6 +672,8 @@ struct ipx_parser_data {
     struct ipx_msg_ipfix *ipfix_msg;
     /** Template manager                                */
     fds_tmgr_t *tmgr;
+    /** Current snapshot of the manager (NULL if not known yet or templates have changed) */
+    const fds_tsnapshot_t *snap;
 
     /** Number of parser data records                   */
     uint16_t data_recs;
@@ -788,8 +871,9 @@ parser_parse_def(struct ipx_parser_data *pdata, void *rec, enum fds_template_typ
 static inline int
 parser_parse_tset(struct ipx_parser_data *pdata, struct fds_ipfix_set_hdr *tset)
 {
-    // Processing templates
+    // Processing templates (the snapshot will be replaced)
     pdata->tmplt_changes = true;
+    pdata->snap = NULL;
 
     uint16_t set_id = ntohs(tset->flowset_id);
     assert(set_id == FDS_IPFIX_SET_TMPLT || set_id == FDS_IPFIX_SET_OPTS_TMPLT);
@@ -834,27 +918,25 @@ parser_parse_tset(struct ipx_parser_data *pdata, struct fds_ipfix_set_hdr *tset)
 }
 
 /**
- * \brief Parser Data Records in an IPFIX Set
+ * \brief Get the current snapshot of the Template manager
  *
- * First, find an (Options) Template necessary to decode structure of records in this Set and
- * then detect the start position of each Data Record and mark it.
+ * The snapshot is cached for all following Data Sets of the Message until templates are changed.
  * \param[in,out] pdata Parser internal data (Message context, Template manager, etc.)
- * \param[in]     dset  Pointer to the Set header
- * \return #IPX_OK on success (all records successfully processed)
- * \return #IPX_ERR_FORMAT if an unexpected formatting error has been detected
+ * \param[out]    snap  Snapshot
+ * \return #IPX_OK on success
  * \return #IPX_ERR_ARG in case of an internal error
  * \return #IPX_ERR_NOMEM if a memory allocation error has occurred
  */
 static inline int
-parser_parse_dset(struct ipx_parser_data *pdata, struct fds_ipfix_set_hdr *dset)
+parser_snapshot_get(struct ipx_parser_data *pdata, const fds_tsnapshot_t **snap)
 {
-    uint16_t set_id = ntohs(dset->flowset_id);
-    assert(set_id >= FDS_IPFIX_SET_MIN_DSET);
+    if (pdata->snap != NULL) {
+        *snap = pdata->snap;
+        return IPX_OK;
+    }
 
-    // Find a Snapshot
     int rc;
-    const fds_tsnapshot_t *snap;
-    if ((rc = fds_tmgr_snapshot_get(pdata->tmgr, &snap)) != FDS_OK) {
+    if ((rc = fds_tmgr_snapshot_get(pdata->tmgr, snap)) != FDS_OK) {
         // Something bad happened
         const struct ipx_msg_ctx *msg_ctx = &pdata->ipfix_msg->ctx;
         if (rc == FDS_ERR_NOMEM) {
@@ -870,15 +952,102 @@ parser_parse_dset(struct ipx_parser_data *pdata, struct fds_ipfix_set_hdr *dset)
         }
     }
 
+    pdata->snap = *snap;
+    return IPX_OK;
+}
+
+/**
+ * \brief Parse Data Records of a fixed-length (Options) Template in an IPFIX Set
+ *
+ * Size of all records is the same, therefore, the number of records and their positions follow
+ * directly from the length of the Set. Space for all references is reserved at once and the
+ * references are filled by a simple strided loop. Remaining bytes (shorter than a record) at
+ * the end of the Set are padding.
+ * \param[in,out] pdata Parser internal data (Message context, Template manager, etc.)
+ * \param[in]     dset  Pointer to the Set header
+ * \param[in]     tmplt Template of the Set (without variable-length fields)
+ * \param[in]     snap  Snapshot of the Template
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_NOMEM if a memory allocation error has occurred
+ */
+static inline int
+parser_parse_dset_fixed(struct ipx_parser_data *pdata, struct fds_ipfix_set_hdr *dset,
+    const struct fds_template *tmplt, const fds_tsnapshot_t *snap)
+{
+    const uint16_t rec_size = tmplt->data_length;
+    const uint16_t data_size = ntohs(dset->length) - FDS_IPFIX_SET_HDR_LEN;
+    const uint32_t rec_cnt = data_size / rec_size;
+    if (rec_cnt == 0) {
+        return IPX_OK;
+    }
+
+    struct ipx_ipfix_record *refs = ipx_msg_ipfix_add_drec_refs(&pdata->ipfix_msg, rec_cnt);
+    if (!refs) {
+        const struct ipx_msg_ctx *msg_ctx = &pdata->ipfix_msg->ctx;
+        PARSER_ERROR(pdata->parser, msg_ctx, "Memory allocation failed (%s:%d).",
+            __FILE__, __LINE__);
+        return IPX_ERR_NOMEM;
+    }
+
+    // Size of references depends on registered extensions
+    const size_t ref_size = pdata->ipfix_msg->rec_info.rec_size;
+    uint8_t *ref_ptr = (uint8_t *) refs;
+    uint8_t *rec_ptr = ((uint8_t *) dset) + FDS_IPFIX_SET_HDR_LEN;
+
+    for (uint32_t i = 0; i < rec_cnt; ++i) {
+        struct ipx_ipfix_record *ref = (struct ipx_ipfix_record *) (ref_ptr + i * ref_size);
+        ref->rec.data = rec_ptr + i * rec_size;
+        ref->rec.size = rec_size;
+        ref->rec.tmplt = tmplt;
+        ref->rec.snap = snap;
+        ref->ext_mask = 0;
+    }
+
+    pdata->data_recs += rec_cnt;
+    return IPX_OK;
+}
+
+/**
+ * \brief Parser Data Records in an IPFIX Set
+ *
+ * First, find an (Options) Template necessary to decode structure of records in this Set and
+ * then detect the start position of each Data Record and mark it.
+ * \param[in,out] pdata Parser internal data (Message context, Template manager, etc.)
+ * \param[in]     dset  Pointer to the Set header
+ * \return #IPX_OK on success (all records successfully processed)
+ * \return #IPX_ERR_FORMAT if an unexpected formatting error has been detected
+ * \return #IPX_ERR_ARG in case of an internal error
+ * \return #IPX_ERR_NOMEM if a memory allocation error has occurred
+ */
+static inline int
+parser_parse_dset(struct ipx_parser_data *pdata, struct fds_ipfix_set_hdr *dset)
+{
+    uint16_t set_id = ntohs(dset->flowset_id);
+    assert(set_id >= FDS_IPFIX_SET_MIN_DSET);
+
+    // Find a Snapshot
+    int rc;
+    const fds_tsnapshot_t *snap;
+    if ((rc = parser_snapshot_get(pdata, &snap)) != IPX_OK) {
+        // Proper error message has been already generated
+        return rc;
+    }
+
     // Find an (Options) Template
     const struct fds_template *tmplt = fds_tsnapshot_template_get(snap, set_id);
     if (!tmplt) {
         const struct ipx_msg_ctx *msg_ctx = &pdata->ipfix_msg->ctx;
         PARSER_WARNING(pdata->parser, msg_ctx, "Unable to parse IPFIX Data Set %" PRIu16 " "
             "due to missing (Options) Template.", set_id);
+        ipx_stats_cnt_add(&pdata->parser->stats->sets_no_tmplt, 1);
         return IPX_OK;
     }
 
+    if ((tmplt->flags & FDS_TEMPLATE_DYNAMIC) == 0 && tmplt->data_length > 0) {
+        // Fast path: all records have the same size
+        return parser_parse_dset_fixed(pdata, dset, tmplt, snap);
+    }
+
     struct fds_drec rec;
     rec.tmplt = tmplt;
     rec.snap = snap;
@@ -1015,9 +1184,11 @@ parser_parse_message(struct ipx_parser_data *pdata)
 static inline void
 parser_session_block_all(ipx_parser_t *parser)
 {
-    for (size_t idx = 0; idx < parser->recs_valid; ++idx) {
-        struct stream_ctx *ctx = parser->recs[idx].ctx;
-        ctx->flags |= SCF_BLOCK;
+    for (size_t idx = 0; idx < parser->recs.size; ++idx) {
+        struct parser_rec *rec = parser->recs.slots[idx].item;
+        if (rec != NULL) {
+            rec->ctx->flags |= SCF_BLOCK;
+        }
     }
 }
 
@@ -1142,6 +1313,87 @@ parser_convert(ipx_parser_t *parser, struct parser_rec *rec, ipx_msg_ipfix_t *ms
     return IPX_OK;
 }
 
+/**
+ * \brief Restore (Options) Templates of a parser record from the template store
+ *
+ * Only IPFIX records are restored as NetFlow converters maintain their own templates.
+ * \param[in] parser   Parser
+ * \param[in] rec      Parser record (the Export Time of its Template manager must be set)
+ * \param[in] msg_ctx  IPFIX Message context (for log messages)
+ * \param[in] exp_time Export Time of the current IPFIX Message
+ * \return True if any template has been restored. Otherwise false.
+ */
+static bool
+parser_tstore_restore(ipx_parser_t *parser, struct parser_rec *rec,
+    const struct ipx_msg_ctx *msg_ctx, uint32_t exp_time)
+{
+    rec->ctx->flags &= ~SCF_RESTORE;
+    if (rec->ctx->type != ST_IPFIX) {
+        return false;
+    }
+
+    unsigned int cnt;
+    int rc = ipx_tstore_restore(parser->tstore, rec->session, rec->odid, rec->ctx->mgr,
+        exp_time, &cnt);
+    if (rc == IPX_ERR_NOMEM) {
+        PARSER_WARNING(parser, msg_ctx, "Failed to restore (Options) Templates from the template "
+            "store due to a memory allocation error.", '\0');
+    } else if (rc == IPX_OK && cnt > 0) {
+        PARSER_INFO(parser, msg_ctx, "%u (Options) Template(s) restored from the template store.",
+            cnt);
+    }
+
+    return cnt > 0;
+}
+
+/**
+ * \brief Publish (Options) Templates of a parser record into the template store
+ *
+ * Only IPFIX records of UDP sessions with already known Export Time are published.
+ * \param[in] parser Parser
+ * \param[in] rec    Parser record
+ */
+static void
+parser_tstore_publish(ipx_parser_t *parser, const struct parser_rec *rec)
+{
+    if (rec->session->type != FDS_SESSION_UDP || rec->ctx->type != ST_IPFIX
+            || (rec->ctx->flags & SCF_RESTORE) != 0) {
+        return;
+    }
+
+    int rc = ipx_tstore_publish(parser->tstore, rec->session, rec->odid, rec->ctx->mgr);
+    if (rc == IPX_ERR_NOMEM) {
+        IPX_WARNING(parser->ident, "Failed to update the template store due to a memory "
+            "allocation error.", '\0');
+    }
+}
+
+/**
+ * \brief Periodically publish all templates into the template store and save it
+ * \param[in] parser Parser
+ */
+static void
+parser_tstore_tick(ipx_parser_t *parser)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+    const uint64_t now = (uint64_t) ts.tv_sec;
+
+    if (parser->tstore_next == 0) {
+        // The first call
+        parser->tstore_next = now + ipx_tstore_interval(parser->tstore);
+        return;
+    }
+
+    if (now < parser->tstore_next) {
+        return;
+    }
+
+    ipx_parser_tstore_publish(parser);
+    ipx_tstore_save_periodic(parser->tstore);
+    parser->tstore_next = now + ipx_tstore_interval(parser->tstore);
+}
+
 ipx_parser_t *
 ipx_parser_create(const char *ident, enum ipx_verb_level vlevel)
 {
@@ -1150,39 +1402,91 @@ ipx_parser_create(const char *ident, enum ipx_verb_level vlevel)
         return NULL;
     }
 
-    const size_t alloc_size = PARSER_DEF_RECS * sizeof(*parser->recs);
-    parser->recs = malloc(alloc_size);
-    if (!parser->recs) {
+    if (ipx_htable_init(&parser->recs, 2 * PARSER_DEF_RECS) != IPX_OK) {
+        free(parser);
+        return NULL;
+    }
+
+    if (ipx_htable_init(&parser->sessions, 2 * PARSER_DEF_RECS) != IPX_OK) {
+        ipx_htable_destroy(&parser->recs);
         free(parser);
         return NULL;
     }
 
     parser->ident = strdup(ident);
     if (!parser->ident) {
-        free(parser->recs);
+        ipx_htable_destroy(&parser->sessions);
+        ipx_htable_destroy(&parser->recs);
+        free(parser);
+        return NULL;
+    }
+
+    parser->deferred = ipx_epoch_list_create();
+    if (!parser->deferred) {
+        free(parser->ident);
+        ipx_htable_destroy(&parser->sessions);
+        ipx_htable_destroy(&parser->recs);
         free(parser);
         return NULL;
     }
 
     parser->vlevel = vlevel;
-    parser->recs_alloc = PARSER_DEF_RECS;
+    parser->rec_last = NULL;
     parser->ie_mgr = NULL;
+    parser->tstore = NULL;
+    parser->tstore_next = 0;
+    parser->stats = &parser->stats_local;
     return parser;
 }
 
 void
 ipx_parser_destroy(ipx_parser_t *parser)
 {
-    // Destroy all stream contexts
-    for (size_t idx = 0; idx < parser->recs_valid; ++idx) {
-        stream_ctx_destroy(parser->recs[idx].ctx);
+    // Destroy all records and stream contexts
+    for (size_t idx = 0; idx < parser->recs.size; ++idx) {
+        struct parser_rec *rec = parser->recs.slots[idx].item;
+        if (rec != NULL) {
+            stream_ctx_destroy(rec->ctx);
+            free(rec);
+        }
     }
 
+    // Destroy retired templates and snapshots
+    ipx_epoch_list_destroy(parser->deferred);
     free(parser->ident);
-    free(parser->recs);
+    ipx_htable_destroy(&parser->sessions);
+    ipx_htable_destroy(&parser->recs);
     free(parser);
 }
 
+void
+ipx_parser_stats_set(ipx_parser_t *parser, struct ipx_stats_parser *stats)
+{
+    parser->stats = (stats != NULL) ? stats : &parser->stats_local;
+}
+
+void
+ipx_parser_tstore_set(ipx_parser_t *parser, ipx_tstore_t *store)
+{
+    parser->tstore = store;
+    parser->tstore_next = 0;
+}
+
+void
+ipx_parser_tstore_publish(ipx_parser_t *parser)
+{
+    if (parser->tstore == NULL) {
+        return;
+    }
+
+    for (size_t idx = 0; idx < parser->recs.size; ++idx) {
+        const struct parser_rec *rec = parser->recs.slots[idx].item;
+        if (rec != NULL) {
+            parser_tstore_publish(parser, rec);
+        }
+    }
+}
+
 void
 ipx_parser_verb(ipx_parser_t *parser, enum ipx_verb_level *v_new, enum ipx_verb_level *v_old)
 {
@@ -1194,8 +1498,12 @@ ipx_parser_verb(ipx_parser_t *parser, enum ipx_verb_level *v_new, enum ipx_verb_
         parser->vlevel = *v_new;
 
         // Change verbosity of all converters too
-        for (size_t i = 0; i < parser->recs_valid; ++i) {
-            struct stream_ctx *ctx = parser->recs[i].ctx;
+        for (size_t i = 0; i < parser->recs.size; ++i) {
+            if (parser->recs.slots[i].item == NULL) {
+                continue;
+            }
+
+            struct stream_ctx *ctx = ((struct parser_rec *) parser->recs.slots[i].item)->ctx;
 
             if (ctx->type == ST_NETFLOW5 && ctx->converter.nf5 != NULL) {
                 ipx_nf5_conv_verb(ctx->converter.nf5, *v_new);
@@ -1271,8 +1579,11 @@ ipx_parser_process(ipx_parser_t *parser, ipx_msg_ipfix_t **ipfix, ipx_msg_garbag
             // Out of sequence message
             PARSER_WARNING(parser, msg_ctx, "Unexpected Sequence number (expected: "
                 "%" PRIu32 ", got: %" PRIu32 ").", info->seq_num, msg_seq);
+            ipx_stats_cnt_add(&parser->stats->seq_gaps, 1);
             if (parser_seq_num_cmp(msg_seq, info->seq_num) > 0) {
-                info->seq_num = msg_seq; // Newer than expected
+                // Newer than expected (Data Records in between are probably lost)
+                ipx_stats_cnt_add(&parser->stats->seq_lost, msg_seq - info->seq_num);
+                info->seq_num = msg_seq;
             } else {
                 old_oos = true; // Older than expected
             }
@@ -1309,14 +1620,22 @@ ipx_parser_process(ipx_parser_t *parser, ipx_msg_ipfix_t **ipfix, ipx_msg_garbag
         }
     }
 
+    // Restore templates received before restart of the collector (only the first message)
+    bool restored = false;
+    if ((rec->ctx->flags & SCF_RESTORE) != 0) {
+        restored = parser_tstore_restore(parser, rec, msg_ctx, ntohl(msg_data->export_time));
+    }
+
     // Parse IPFIX Sets
     struct ipx_parser_data parser_data = {
         .parser = parser,
         .ipfix_msg = *ipfix,
         .tmgr = tmgr,
+        .snap = NULL,
         .data_recs = 0,
-        .tmplt_changes = false
+        .tmplt_changes = restored
     };
+    (*ipfix)->epoch = ipx_epoch_acquire();
     rc = parser_parse_message(&parser_data);
 
     /* Warning: do NOT use "msg_ctx" because IPFIX message MAY be reallocated and the pointer
@@ -1344,15 +1663,31 @@ ipx_parser_process(ipx_parser_t *parser, ipx_msg_ipfix_t **ipfix, ipx_msg_garbag
         // There is potentially garbage to destroy
         fds_tgarbage_t *fds_garbage;
         if (fds_tmgr_garbage_get(tmgr, &fds_garbage) == FDS_OK && fds_garbage != NULL) {
-            ipx_msg_garbage_cb cb = (ipx_msg_garbage_cb) &fds_tmgr_garbage_destroy;
-            garbage_msg = ipx_msg_garbage_create(fds_garbage, cb);
+            ipx_epoch_cb epoch_cb = (ipx_epoch_cb) &fds_tmgr_garbage_destroy;
+            if (ipx_epoch_list_defer(parser->deferred, fds_garbage, epoch_cb) != IPX_OK) {
+                // Fallback: send the garbage through the pipeline
+                ipx_msg_garbage_cb cb = (ipx_msg_garbage_cb) &fds_tmgr_garbage_destroy;
+                garbage_msg = ipx_msg_garbage_create(fds_garbage, cb);
+            }
         }
     }
 
+    // Destroy previously retired templates and snapshots that are not referenced anymore
+    ipx_epoch_list_reclaim(parser->deferred);
+    if (parser->tstore != NULL && ipx_tstore_interval(parser->tstore) != 0) {
+        parser_tstore_tick(parser);
+    }
+
     *garbage = garbage_msg;
     return IPX_OK;
 }
 
+void
+ipx_parser_reclaim(ipx_parser_t *parser)
+{
+    ipx_epoch_list_reclaim(parser->deferred);
+}
+
 int
 ipx_parser_ie_source(ipx_parser_t *parser, const fds_iemgr_t *iemgr, ipx_msg_garbage_t **garbage)
 {
@@ -1360,9 +1695,13 @@ ipx_parser_ie_source(ipx_parser_t *parser, const fds_iemgr_t *iemgr, ipx_msg_gar
 
     // First, try to update all Template managers
     size_t idx;
-    for (idx = 0; idx < parser->recs_valid; idx++) {
-        // Skip disabled sources
-        struct stream_ctx *ctx = parser->recs[idx].ctx;
+    for (idx = 0; idx < parser->recs.size; idx++) {
+        // Skip empty slots and disabled sources
+        if (parser->recs.slots[idx].item == NULL) {
+            continue;
+        }
+
+        struct stream_ctx *ctx = ((struct parser_rec *) parser->recs.slots[idx].item)->ctx;
         if ((ctx->flags & SCF_BLOCK) != 0) {
             continue;
         }
@@ -1380,7 +1719,7 @@ ipx_parser_ie_source(ipx_parser_t *parser, const fds_iemgr_t *iemgr, ipx_msg_gar
 
     // Prepare to collect garbage
     ipx_gc_t *gc = NULL;
-    if ((gc = ipx_gc_create()) == NULL || ipx_gc_reserve(gc, parser->recs_valid) != IPX_OK) {
+    if ((gc = ipx_gc_create()) == NULL || ipx_gc_reserve(gc, parser->recs.used) != IPX_OK) {
         // Failed to create a garbage container
         ipx_gc_destroy(gc);
         parser_session_block_all(parser);
@@ -1388,9 +1727,13 @@ ipx_parser_ie_source(ipx_parser_t *parser, const fds_iemgr_t *iemgr, ipx_msg_gar
     }
 
     // Clean up
-    for (idx = 0; idx < parser->recs_valid; idx++) {
+    for (idx = 0; idx < parser->recs.size; idx++) {
+        if (parser->recs.slots[idx].item == NULL) {
+            continue;
+        }
+
         // Get old templates and snapshots as garbage
-        struct stream_ctx *ctx = parser->recs[idx].ctx;
+        struct stream_ctx *ctx = ((struct parser_rec *) parser->recs.slots[idx].item)->ctx;
         fds_tgarbage_t *fds_garbage;
 
         if (fds_tmgr_garbage_get(ctx->mgr, &fds_garbage) != FDS_OK) {
@@ -1429,71 +1772,56 @@ int
 ipx_parser_session_remove(ipx_parser_t *parser, const struct ipx_session *session,
     ipx_msg_garbage_t **garbage)
 {
-    size_t idx_start; // Index of the first occurrence of the session records
-    size_t idx_end;   // Index of the "past-the-last" occurrence of the session records
-
-    // Find records to remove (the array is primary sorted by Transport Session)
-    for (idx_start = 0; idx_start < parser->recs_valid; ++idx_start) {
-        if (parser->recs[idx_start].session == session) {
-            break;
-        }
-    }
-
-    if (idx_start == parser->recs_valid) {
+    struct parser_rec *first = parser_session_find(parser, session);
+    if (!first) {
         // Not found
         return IPX_ERR_NOTFOUND;
     }
 
-    for (idx_end = idx_start + 1; idx_end < parser->recs_valid; ++idx_end) {
-        if (parser->recs[idx_end].session != session) {
-            break;
+    // Keep the latest templates of the session for the case it appears again
+    if (parser->tstore != NULL) {
+        for (const struct parser_rec *rec = first; rec != NULL; rec = rec->next) {
+            parser_tstore_publish(parser, rec);
         }
     }
 
     // Move session data into garbage
-    ipx_msg_garbage_t *garbage_msg = parser_rec_to_garbage(parser, idx_start, idx_end);
+    ipx_msg_garbage_t *garbage_msg = parser_rec_to_garbage(first);
     /* Note: If the garbage message is NULL, allocation of the memory failed and information about
      * session will be lost. We cannot free structures here because someone still could use them.
      * (This will cause a memory leak but its better that segfault!)
      */
 
-    // Remove old records (order will remain still the same -> sort is not necessary)
-    while (idx_end < parser->recs_valid) {
-        parser->recs[idx_start++] = parser->recs[idx_end++];
+    // Remove old records
+    parser_table_remove(&parser->sessions, parser_hash(session, 0), first);
+    struct parser_rec *rec = first;
+    while (rec != NULL) {
+        struct parser_rec *next = rec->next;
+        parser_table_remove(&parser->recs, parser_hash(rec->session, rec->odid), rec);
+        free(rec);
+        rec = next;
     }
 
-    // Update number of valid records
-    parser->recs_valid = idx_start;
+    parser->rec_last = NULL;
     *garbage = garbage_msg;
+
+    // The session might have been the last source of messages, don't wait for the next one
+    ipx_epoch_list_reclaim(parser->deferred);
     return IPX_OK;
 }
 
 int
 ipx_parser_session_block(ipx_parser_t *parser, const struct ipx_session *session)
 {
-    size_t idx_start; // Index of the first occurrence of the session records
-
-    // Find records to remove (the array is primary sorted by Transport Session)
-    for (idx_start = 0; idx_start < parser->recs_valid; ++idx_start) {
-        if (parser->recs[idx_start].session == session) {
-            break;
-        }
-    }
-
-    if (idx_start == parser->recs_valid) {
+    struct parser_rec *first = parser_session_find(parser, session);
+    if (!first) {
         // Not found
         return IPX_ERR_NOTFOUND;
     }
 
-    for (size_t idx = idx_start; idx < parser->recs_valid; ++idx) {
-        struct parser_rec *rec = &parser->recs[idx];
-        if (rec->session != session) {
-            // Stop, found a different session
-            break;
-        }
-
-        // Set "block" flag
-        parser->recs[idx].ctx->flags |= SCF_BLOCK;
+    // Set "block" flag
+    for (struct parser_rec *rec = first; rec != NULL; rec = rec->next) {
+        rec->ctx->flags |= SCF_BLOCK;
     }
 
     return IPX_OK;
@@ -1504,19 +1832,29 @@ ipx_parser_session_for(ipx_parser_t *parser, ipx_parser_for_cb cb, void *data)
 {
     /* Keep on mind that ipx_parser_session_block() and ipx_parser_session_remove() can be
      * called within the callback function i.e. records can be removed from the parser during for
-     * loop!
+     * loop! The removal can move following records of the same cluster to the current slot,
+     * therefore, the iteration starts from an empty slot (i.e. a cluster boundary) and the
+     * current slot is checked again if its content has been changed.
      */
-    const struct ipx_session *now = NULL;
-    size_t idx = 0;
-    while (idx < parser->recs_valid) {
-        struct parser_rec *rec = &parser->recs[idx];
-        if (rec->session == now) {
-            // Skip already processed sessions
-            idx++;
+    struct ipx_htable *table = &parser->sessions;
+    const size_t mask = table->size - 1;
+    size_t start = 0;
+    while (table->slots[start].item != NULL) {
+        // The table is always at most half full
+        start++;
+    }
+
+    size_t idx = (start + 1) & mask;
+    while (idx != start) {
+        const struct parser_rec *first = table->slots[idx].item;
+        if (first == NULL) {
+            idx = (idx + 1) & mask;
             continue;
         }
 
-        now = rec->session;
-        cb(parser, now, data); // Number of valid records can be changed here!
+        cb(parser, first->session, data); // Records can be removed here!
+        if (table->slots[idx].item == first) {
+            idx = (idx + 1) & mask;
+        }
     }
 }
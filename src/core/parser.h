@@ -44,6 +44,8 @@
 
 #include <ipfixcol2/message.h>
 #include <ipfixcol2/verbose.h>
+#include "stats.h"
+#include "tstore.h"
 
 /**
  * \defgroup ipxParser IPFIX Message parser
@@ -80,7 +82,8 @@ ipx_parser_create(const char *ident, enum ipx_verb_level vlevel);
 /**
  * \brief Destroy an IPFIX parser
  *
- * \warning All template managers and their templates will be also immediately destroyed.
+ * \warning All template managers and their templates (including retired ones that are still
+ *   waiting for destruction) will be also immediately destroyed.
  * \param[in] parser Message parser
  */
 IPX_API void
@@ -98,6 +101,55 @@ ipx_parser_destroy(ipx_parser_t *parser);
 IPX_API void
 ipx_parser_verb(ipx_parser_t *parser, enum ipx_verb_level *v_new, enum ipx_verb_level *v_old);
 
+/**
+ * \brief Redirect statistics of the parser
+ *
+ * By default, the parser updates internal counters that are not accessible from outside.
+ * \warning Counters are updated only by the thread of the parser (see ipx_stats_cnt_add()).
+ * \param[in] parser Message parser
+ * \param[in] stats  Counters to update (NULL to use the internal counters)
+ */
+IPX_API void
+ipx_parser_stats_set(ipx_parser_t *parser, struct ipx_stats_parser *stats);
+
+/**
+ * \brief Set a template store of UDP sessions
+ *
+ * (Options) Templates of new IPFIX UDP sessions are restored from the store (if available)
+ * and the latest templates of all IPFIX UDP sessions are published into the store when a session
+ * is removed, periodically (if the store has non-zero interval) and by
+ * ipx_parser_tstore_publish(). Periodic publication may also save the store, however, at most
+ * once per interval for all parsers sharing it (see ipx_tstore_save_periodic()). Otherwise,
+ * saving of the store is up to its owner.
+ * \note NetFlow sessions are not stored as their converters maintain their own templates.
+ * \warning Must be set before the first message is processed.
+ * \param[in] parser Message parser
+ * \param[in] store  Template store (NULL to disable)
+ */
+IPX_API void
+ipx_parser_tstore_set(ipx_parser_t *parser, ipx_tstore_t *store);
+
+/**
+ * \brief Publish current (Options) Templates of all IPFIX UDP sessions into the template store
+ *
+ * If the template store is not set, the function does nothing.
+ * \param[in] parser Message parser
+ */
+IPX_API void
+ipx_parser_tstore_publish(ipx_parser_t *parser);
+
+/**
+ * \brief Destroy retired (Options) Templates and snapshots that are not referenced anymore
+ *
+ * Templates replaced or withdrawn during processing are destroyed as soon as all IPFIX
+ * Messages that could refer to them have been released. This is checked during processing of
+ * each message, however, if there are no new messages, the function should be called
+ * periodically.
+ * \param[in] parser Message parser
+ */
+IPX_API void
+ipx_parser_reclaim(ipx_parser_t *parser);
+
 /**
  * \brief Process IPFIX (or NetFlow) Message
  *
@@ -111,11 +163,17 @@ ipx_parser_verb(ipx_parser_t *parser, enum ipx_verb_level *v_new, enum ipx_verb_
  * IPFIX Message.
  *
  * \note
- *   If old or no more accessible templates/template snapshots are part of a template manager,
- *   the function creates a new \p garbage message. Garbage message is generated only if processing
- *   of the Message is successful. Keep on mind, that garbage message could include templates
- *   that are referenced from the Message. Therefore, parsed message \p msg MUST be destroyed
- *   BEFORE the \p garbage.
+ *   The Message acquires the current epoch (see ipx_epoch_acquire()) before references to
+ *   templates are added and releases it when it is destroyed. Old or no more accessible
+ *   templates/template snapshots of a template manager are retired by the parser and destroyed
+ *   during later calls of the function as soon as all Messages that could reference them have
+ *   been destroyed.
+ * \note
+ *   Only if the parser fails to retire the old templates/template snapshots (memory allocation
+ *   error), the function creates a new \p garbage message. Garbage message is generated only if
+ *   processing of the Message is successful. Keep on mind, that garbage message could include
+ *   templates that are referenced from the Message. Therefore, parsed message \p msg MUST be
+ *   destroyed BEFORE the \p garbage.
  * \note
  *   Wrapper \p msg could be reallocated if it is not able to handle required amount of IPFIX Data
  *   Records.
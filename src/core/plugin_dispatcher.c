@@ -0,0 +1,263 @@
+/**
+ * \file src/core/plugin_dispatcher.c
+ * \brief Internal replica dispatcher plugin (source file)
+ * \date 2026
+ */
+
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "plugin_dispatcher.h"
+#include "message_base.h"
+#include "context.h"
+
+/** Maximal number of messages waiting for a replica before they are added into its ring    */
+#define DISPATCHER_PENDING_MAX (64U)
+
+/** Definition of a connection with a replica                                                */
+struct ipx_dispatcher_rec {
+    /** Ring buffer connection (writer only)                                                 */
+    ipx_ring_t *ring;
+    /** Number of messages waiting to be added into the ring buffer                          */
+    uint32_t pending_cnt;
+    /** Messages waiting to be added into the ring buffer (batch processing only)            */
+    ipx_msg_t *pending[DISPATCHER_PENDING_MAX];
+};
+
+/** List of replicas */
+struct ipx_dispatcher_list {
+    /** Number of replicas         */
+    size_t size;
+    /** Array of records           */
+    struct ipx_dispatcher_rec *recs;
+};
+
+ipx_dispatcher_list_t *
+ipx_dispatcher_list_create()
+{
+    struct ipx_dispatcher_list *result = calloc(1, sizeof(*result));
+    if (!result) {
+        return NULL;
+    }
+
+    result->size = 0;
+    result->recs = NULL;
+    return result;
+}
+
+size_t
+ipx_dispatcher_list_size(const ipx_dispatcher_list_t *list)
+{
+    return list->size;
+}
+
+void
+ipx_dispatcher_list_destroy(ipx_dispatcher_list_t *list)
+{
+    free(list->recs);
+    free(list);
+}
+
+int
+ipx_dispatcher_list_add(ipx_dispatcher_list_t *list, ipx_ring_t *ring)
+{
+    // Check arguments
+    if (list == NULL || ring == NULL) {
+        return IPX_ERR_ARG;
+    }
+
+    // Add a new record
+    size_t new_size = list->size + 1;
+    size_t recs_size = new_size * sizeof(struct ipx_dispatcher_rec);
+    struct ipx_dispatcher_rec *new_recs = realloc(list->recs, recs_size);
+    if (!new_recs) {
+        return IPX_ERR_NOMEM;
+    }
+
+    list->size = new_size;
+    list->recs = new_recs;
+
+    struct ipx_dispatcher_rec *rec = &list->recs[new_size - 1];
+    rec->ring = ring;
+    rec->pending_cnt = 0;
+    return IPX_OK;
+}
+
+/**
+ * \brief Select a replica for an IPFIX Message
+ *
+ * The replica is determined by the Transport Session and the Observation Domain ID of
+ * the message, i.e. the same combination is always processed by the same replica.
+ * \param[in] list List of replicas
+ * \param[in] msg  IPFIX Message
+ * \return Replica record
+ */
+static inline struct ipx_dispatcher_rec *
+dispatcher_select(struct ipx_dispatcher_list *list, ipx_msg_t *msg)
+{
+    const struct ipx_msg_ctx *msg_ctx = ipx_msg_ipfix_get_ctx(ipx_msg_base2ipfix(msg));
+    uint64_t key = (uint64_t) (uintptr_t) msg_ctx->session;
+    key ^= (uint64_t) msg_ctx->odid * 0x9E3779B97F4A7C15ULL;
+
+    // Finalizer of MurmurHash3 (pointers are aligned and ODIDs are usually small numbers)
+    key ^= key >> 33;
+    key *= 0xFF51AFD7ED558CCDULL;
+    key ^= key >> 33;
+    key *= 0xC4CEB9FE1A85EC53ULL;
+    key ^= key >> 33;
+
+    return &list->recs[key % list->size];
+}
+
+/**
+ * \brief Add all messages waiting for a replica into its ring buffer
+ * \param[in] rec Replica record
+ */
+static inline void
+dispatcher_flush(struct ipx_dispatcher_rec *rec)
+{
+    ipx_ring_push_batch(rec->ring, rec->pending, rec->pending_cnt);
+    rec->pending_cnt = 0;
+}
+
+/**
+ * \brief Append a message to the messages waiting for a replica
+ * \param[in] rec Replica record
+ * \param[in] msg Message
+ */
+static inline void
+dispatcher_append(struct ipx_dispatcher_rec *rec, ipx_msg_t *msg)
+{
+    if (rec->pending_cnt == DISPATCHER_PENDING_MAX) {
+        dispatcher_flush(rec);
+    }
+
+    rec->pending[rec->pending_cnt++] = msg;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+const struct ipx_plugin_info ipx_plugin_dispatcher_info = {
+    .name    = "Replica dispatcher",
+    .dsc     = "Internal IPFIXcol plugin for passing messages to replicas of an instance.",
+    .type    = IPX_PT_DISPATCHER,
+    .flags   = 0,
+    .version = "1.0.0",
+    .ipx_min = "2.0.0"
+};
+
+int
+ipx_plugin_dispatcher_init(ipx_ctx_t *ctx, const char *params)
+{
+    (void) params;
+
+    // Check that all message types are subscribed
+    ipx_msg_mask_t mask = IPX_MSG_MASK_ALL;
+    if (ipx_ctx_subscribe(ctx, &mask, NULL) != IPX_OK) {
+        IPX_CTX_ERROR(ctx, "Unable to subscribe to all message types!", '\0');
+        return IPX_ERR_DENIED;
+    }
+
+    return IPX_OK;
+}
+
+void
+ipx_plugin_dispatcher_destroy(ipx_ctx_t *ctx, void *cfg)
+{
+    // Do nothing, private data should be freed by the configurator
+    (void) ctx;
+    (void) cfg;
+}
+
+int
+ipx_plugin_dispatcher_process(ipx_ctx_t *ctx, void *cfg, ipx_msg_t *msg)
+{
+    (void) ctx;
+    // List of replicas is prepared by the configurator
+    struct ipx_dispatcher_list *list = (struct ipx_dispatcher_list *) cfg;
+    assert(list != NULL && list->size > 0);
+
+    if (ipx_msg_get_type(msg) == IPX_MSG_IPFIX) {
+        // Only one replica
+        ipx_ring_push(dispatcher_select(list, msg)->ring, msg);
+        return IPX_OK;
+    }
+
+    // Set the number of references and pass the message to all replicas
+    ipx_msg_header_cnt_set(msg, (unsigned int) list->size);
+    for (size_t i = 0; i < list->size; ++i) {
+        ipx_ring_push(list->recs[i].ring, msg);
+    }
+
+    return IPX_OK;
+}
+
+int
+ipx_plugin_dispatcher_process_batch(ipx_ctx_t *ctx, void *cfg, ipx_msg_t **msgs, size_t cnt)
+{
+    (void) ctx;
+    // List of replicas is prepared by the configurator
+    struct ipx_dispatcher_list *list = (struct ipx_dispatcher_list *) cfg;
+    assert(list != NULL && list->size > 0);
+
+    for (size_t i = 0; i < cnt; ++i) {
+        ipx_msg_t *msg = msgs[i];
+        if (ipx_msg_get_type(msg) == IPX_MSG_IPFIX) {
+            // Only one replica
+            dispatcher_append(dispatcher_select(list, msg), msg);
+            continue;
+        }
+
+        /* Set the number of references and pass the message to all replicas
+         * Note: The message is a barrier for the replicas (see ipx_ctx_replica_set()), therefore,
+         *   it must be added into all ring buffers before any later message. Otherwise,
+         *   the dispatcher could wait for a replica that is waiting for the others.
+         */
+        ipx_msg_header_cnt_set(msg, (unsigned int) list->size);
+        for (size_t r = 0; r < list->size; ++r) {
+            dispatcher_append(&list->recs[r], msg);
+            dispatcher_flush(&list->recs[r]);
+        }
+    }
+
+    for (size_t r = 0; r < list->size; ++r) {
+        dispatcher_flush(&list->recs[r]);
+    }
+
+    return IPX_OK;
+}
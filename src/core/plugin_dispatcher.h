@@ -0,0 +1,141 @@
+/**
+ * \file src/core/plugin_dispatcher.h
+ * \brief Internal replica dispatcher plugin (header file)
+ * \date 2026
+ */
+
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#ifndef IPFIXCOL_PLUGIN_DISPATCHER_H
+#define IPFIXCOL_PLUGIN_DISPATCHER_H
+
+#include <ipfixcol2.h>
+#include "ring.h"
+
+/** Internal type of list of replicas */
+typedef struct ipx_dispatcher_list ipx_dispatcher_list_t;
+
+/**
+ * \brief Create a new list of replicas
+ *
+ * After initialization the list is empty
+ * \return Pointer or NULL (memory allocation error)
+ */
+ipx_dispatcher_list_t *
+ipx_dispatcher_list_create();
+
+/**
+ * \brief Get number of replicas in the list
+ * \param[in] list List of replicas
+ * \return Number of replicas
+ */
+size_t
+ipx_dispatcher_list_size(const ipx_dispatcher_list_t *list);
+
+/**
+ * \brief Destroy the list
+ *
+ * \note Ring buffers are NOT freed by this function!
+ * \param[in] list List of replicas
+ */
+void
+ipx_dispatcher_list_destroy(ipx_dispatcher_list_t *list);
+
+/**
+ * \brief Add a new replica to the list
+ * \param[in] list List of replicas
+ * \param[in] ring Input ring buffer of the replica (for a writer)
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_ARG in case of invalid arguments
+ * \return #IPX_ERR_NOMEM if a memory allocation error has occurred
+ */
+int
+ipx_dispatcher_list_add(ipx_dispatcher_list_t *list, ipx_ring_t *ring);
+
+// ------------------------------------------------------------------------------------------------
+
+/** Description of the replica dispatcher plugin */
+extern const struct ipx_plugin_info ipx_plugin_dispatcher_info;
+
+/**
+ * \brief Initialize the replica dispatcher
+ * \param[in] ctx    Plugin context
+ * \param[in] params Ignored (should be NULL)
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_DENIED in case of a fatal error
+ */
+int
+ipx_plugin_dispatcher_init(ipx_ctx_t *ctx, const char *params);
+
+/**
+ * \brief Destroy the replica dispatcher
+ * \param[in] ctx Plugin context
+ * \param[in] cfg Private instance data
+ */
+void
+ipx_plugin_dispatcher_destroy(ipx_ctx_t *ctx, void *cfg);
+
+/**
+ * \brief Pass a message to replicas of an intermediate instance
+ *
+ * An IPFIX Message is passed to exactly one replica, which is selected based on its Transport
+ * Session and Observation Domain ID. Therefore, all IPFIX Messages of the same combination
+ * are always processed by the same replica in the same order. All other messages (Transport
+ * Session, Garbage, Termination, etc.) are passed to all replicas and the reference counter
+ * of the message is set to the number of replicas (see ipx_ctx_replica_set()).
+ * \param[in] ctx Plugin context
+ * \param[in] cfg Private instance data
+ * \param[in] msg Message to process
+ * \return #IPX_OK on success
+ */
+int
+ipx_plugin_dispatcher_process(ipx_ctx_t *ctx, void *cfg, ipx_msg_t *msg);
+
+/**
+ * \brief Pass multiple messages to replicas of an intermediate instance
+ *
+ * Same as ipx_plugin_dispatcher_process(), but messages for the same replica are added into its
+ * ring buffer at once.
+ * \param[in] ctx  Plugin context
+ * \param[in] cfg  Private instance data
+ * \param[in] msgs Array of messages to process
+ * \param[in] cnt  Number of messages
+ * \return #IPX_OK on success
+ */
+int
+ipx_plugin_dispatcher_process_batch(ipx_ctx_t *ctx, void *cfg, ipx_msg_t **msgs, size_t cnt);
+
+#endif //IPFIXCOL_PLUGIN_DISPATCHER_H
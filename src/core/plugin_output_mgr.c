@@ -41,10 +41,24 @@
 
 #include <stdlib.h>
 #include <stddef.h>
+#include <string.h>
+#include <inttypes.h>
+#include <time.h>
 #include "plugin_output_mgr.h"
 #include "message_base.h"
 #include "context.h"
 
+/** Maximal number of messages waiting for an output with a non-blocking overflow policy     */
+#define OUTPUT_MGR_BACKLOG_SIZE (1024U)
+/** Maximal number of IPFIX Messages in the backlog (the rest is reserved for other messages)  */
+#define OUTPUT_MGR_BACKLOG_IPFIX (OUTPUT_MGR_BACKLOG_SIZE - OUTPUT_MGR_BACKLOG_SIZE / 4)
+/** Minimal interval between reports of dropped messages (seconds)                            */
+#define OUTPUT_MGR_REPORT_INTERVAL (1)
+/** Initial number of records of the routing cache (must be a power of two)                   */
+#define OUTPUT_MGR_CACHE_DEF (64U)
+/** Maximal number of records of the routing cache (must be a power of two)                   */
+#define OUTPUT_MGR_CACHE_MAX (65536U)
+
 /** Definition of a connection with an output instance      */
 struct ipx_output_mgr_rec {
     /** Ring buffer connection (writer only)                */
@@ -53,6 +67,58 @@ struct ipx_output_mgr_rec {
     enum ipx_odid_filter_type type;
     /** ODID filter (NULL if #type == IPX_ODID_FILTER_NONE) */
     const ipx_orange_t *odid_filter;
+    /** Overflow policy                                     */
+    enum ipx_overflow_policy overflow;
+    /** Name of the output instance (for reports)           */
+    char *name;
+
+    /** Statistics (updated only by the output manager)     */
+    struct {
+        /** Number of dropped IPFIX Messages                */
+        uint64_t msgs;
+        /** Number of dropped Data Records                  */
+        uint64_t recs;
+        /** Number of dropped IPFIX Messages (last report)  */
+        uint64_t msgs_reported;
+        /** Number of dropped Data Records (last report)    */
+        uint64_t recs_reported;
+    } dropped;
+
+    /**
+     * Messages that cannot be added into the ring buffer yet (circular buffer)
+     * \note Used only by non-blocking overflow policies (NULL otherwise)
+     */
+    struct {
+        /** Array of messages (#OUTPUT_MGR_BACKLOG_SIZE)    */
+        ipx_msg_t **msgs;
+        /** Index of the oldest message                     */
+        uint32_t head;
+        /** Number of messages                              */
+        uint32_t cnt;
+        /** Number of IPFIX Messages                        */
+        uint32_t ipfix_cnt;
+    } backlog;
+};
+
+/**
+ * \brief Compiled routing decision
+ *
+ * Destinations of IPFIX Messages with the same ODID. Since routing decisions are based on ODID
+ * filters, the number of different routes is limited by the number of filter nodes.
+ */
+struct output_mgr_route {
+    /** Number of destinations                                                               */
+    size_t cnt;
+    /** Indexes of destinations in the array of records                                      */
+    size_t dests[];
+};
+
+/** Record of the routing cache                                                              */
+struct output_mgr_cache_rec {
+    /** Observation Domain ID                                                                */
+    uint32_t odid;
+    /** Route of the ODID (NULL, if the record is empty)                                     */
+    const struct output_mgr_route *route;
 };
 
 /** List of output destinations */
@@ -61,8 +127,47 @@ struct ipx_output_mgr_list {
     size_t size;
     /** Array of records           */
     struct ipx_output_mgr_rec *recs;
+    /** Time of the last report of dropped messages */
+    time_t report_time;
+
+    /** Routing cache (ODID -> destinations), built lazily by the output manager  */
+    struct {
+        /** Hash table with open addressing (NULL, if not allocated yet)          */
+        struct output_mgr_cache_rec *table;
+        /** Number of records in the table (power of two)                          */
+        uint32_t size;
+        /** Number of used records in the table                                    */
+        uint32_t used;
+        /** Array of unique routes (shared by records of the table)                */
+        struct output_mgr_route **routes;
+        /** Number of unique routes                                                */
+        size_t routes_cnt;
+    } cache;
+
+    /** Temporary route (used if the routing cache cannot be extended)             */
+    struct output_mgr_route *route_tmp;
 };
 
+/**
+ * \brief Remove all records and routes from the routing cache
+ * \param[in] list List of output destinations
+ */
+static void
+output_mgr_cache_clear(struct ipx_output_mgr_list *list)
+{
+    for (size_t i = 0; i < list->cache.routes_cnt; ++i) {
+        free(list->cache.routes[i]);
+    }
+
+    free(list->cache.routes);
+    free(list->cache.table);
+    list->cache.routes = NULL;
+    list->cache.routes_cnt = 0;
+    list->cache.table = NULL;
+    list->cache.size = 0;
+    list->cache.used = 0;
+}
+
 ipx_output_mgr_list_t *
 ipx_output_mgr_list_create()
 {
@@ -73,12 +178,24 @@ ipx_output_mgr_list_create()
 
     result->size = 0;
     result->recs = NULL;
+    result->report_time = 0;
+    result->route_tmp = NULL;
     return result;
 }
 
 void
 ipx_output_mgr_list_destroy(ipx_output_mgr_list_t *list)
 {
+    for (size_t i = 0; i < list->size; ++i) {
+        struct ipx_output_mgr_rec *rec = &list->recs[i];
+        // Messages in the backlog should have been already delivered (termination message)
+        assert(rec->backlog.cnt == 0);
+        free(rec->backlog.msgs);
+        free(rec->name);
+    }
+
+    output_mgr_cache_clear(list);
+    free(list->route_tmp);
     free(list->recs);
     free(list);
 }
@@ -89,12 +206,19 @@ ipx_output_mgr_list_empty(const ipx_output_mgr_list_t *list)
     return (list->size == 0);
 }
 
+size_t
+ipx_output_mgr_list_size(const ipx_output_mgr_list_t *list)
+{
+    return list->size;
+}
+
 int
 ipx_output_mgr_list_add(ipx_output_mgr_list_t *list, ipx_ring_t *ring,
-    enum ipx_odid_filter_type odid_type, const ipx_orange_t *odid_filter)
+    enum ipx_odid_filter_type odid_type, const ipx_orange_t *odid_filter,
+    enum ipx_overflow_policy overflow, const char *name)
 {
     // Check arguments
-    if (list == NULL || ring == NULL) {
+    if (list == NULL || ring == NULL || name == NULL) {
         return IPX_ERR_ARG;
     }
 
@@ -103,24 +227,75 @@ ipx_output_mgr_list_add(ipx_output_mgr_list_t *list, ipx_ring_t *ring,
         return IPX_ERR_ARG;
     }
 
-    // Add a new record
+    // Prepare a backlog and a name
+    char *name_cpy = strdup(name);
+    ipx_msg_t **backlog = NULL;
+    if (overflow != IPX_OVERFLOW_BLOCK) {
+        backlog = malloc(OUTPUT_MGR_BACKLOG_SIZE * sizeof(*backlog));
+    }
+
+    if (!name_cpy || (overflow != IPX_OVERFLOW_BLOCK && !backlog)) {
+        free(name_cpy);
+        free(backlog);
+        return IPX_ERR_NOMEM;
+    }
+
+    // Add a new record (and make sure that the temporary route can hold all destinations)
     size_t new_size = list->size + 1;
     size_t recs_size = new_size * sizeof(struct ipx_output_mgr_rec);
+    size_t route_size = sizeof(struct output_mgr_route) + new_size * sizeof(size_t);
+    struct output_mgr_route *new_route = realloc(list->route_tmp, route_size);
+    if (!new_route) {
+        free(name_cpy);
+        free(backlog);
+        return IPX_ERR_NOMEM;
+    }
+
+    list->route_tmp = new_route;
     struct ipx_output_mgr_rec *new_recs = realloc(list->recs, recs_size);
     if (!new_recs) {
+        free(name_cpy);
+        free(backlog);
         return IPX_ERR_NOMEM;
     }
 
     list->size = new_size;
     list->recs = new_recs;
+    // All previous routing decisions are invalid
+    output_mgr_cache_clear(list);
 
     struct ipx_output_mgr_rec *rec = &list->recs[new_size - 1];
+    memset(rec, 0, sizeof(*rec));
     rec->ring = ring;
     rec->type = odid_type;
     rec->odid_filter = odid_filter;
+    rec->overflow = overflow;
+    rec->name = name_cpy;
+    rec->backlog.msgs = backlog;
+    return IPX_OK;
+}
+
+int
+ipx_output_mgr_list_dropped(const ipx_output_mgr_list_t *list, size_t idx, uint64_t *msgs,
+    uint64_t *recs)
+{
+    if (idx >= list->size) {
+        return IPX_ERR_NOTFOUND;
+    }
+
+    const struct ipx_output_mgr_rec *rec = &list->recs[idx];
+    *msgs = __atomic_load_n(&rec->dropped.msgs, __ATOMIC_RELAXED);
+    *recs = __atomic_load_n(&rec->dropped.recs, __ATOMIC_RELAXED);
     return IPX_OK;
 }
 
+void
+ipx_output_mgr_list_cached(const ipx_output_mgr_list_t *list, size_t *odids, size_t *routes)
+{
+    *odids = list->cache.used;
+    *routes = list->cache.routes_cnt;
+}
+
 // ------------------------------------------------------------------------------------------------
 
 const struct ipx_plugin_info ipx_plugin_output_mgr_info = {
@@ -150,18 +325,384 @@ ipx_plugin_output_mgr_init(ipx_ctx_t *ctx, const char *params)
 void
 ipx_plugin_output_mgr_destroy(ipx_ctx_t *ctx, void *cfg)
 {
-    // Do nothing, private data should be freed by the configurator
-    (void) ctx;
-    (void) cfg;
+    // Private data should be freed by the configurator, just report dropped messages
+    const struct ipx_output_mgr_list *list = (const struct ipx_output_mgr_list *) cfg;
+    for (size_t i = 0; list != NULL && i < list->size; ++i) {
+        const struct ipx_output_mgr_rec *rec = &list->recs[i];
+        if (rec->dropped.msgs == 0) {
+            continue;
+        }
+
+        IPX_CTX_WARNING(ctx, "Output instance '%s' dropped %" PRIu64 " IPFIX message(s) "
+            "with %" PRIu64 " Data Record(s) in total due to the overflow policy.", rec->name,
+            rec->dropped.msgs, rec->dropped.recs);
+    }
+}
+
+/**
+ * \brief Drop an IPFIX Message that cannot be delivered to an output instance
+ *
+ * The reference counter of the message is decremented and, if the destination was the last
+ * user, the message is destroyed.
+ * \param[in] rec Output destination
+ * \param[in] msg IPFIX Message
+ */
+static void
+output_mgr_drop(struct ipx_output_mgr_rec *rec, ipx_msg_t *msg)
+{
+    assert(ipx_msg_get_type(msg) == IPX_MSG_IPFIX);
+    uint32_t rec_cnt = ipx_msg_ipfix_get_drec_cnt(ipx_msg_base2ipfix(msg));
+    __atomic_store_n(&rec->dropped.msgs, rec->dropped.msgs + 1, __ATOMIC_RELAXED);
+    __atomic_store_n(&rec->dropped.recs, rec->dropped.recs + rec_cnt, __ATOMIC_RELAXED);
+
+    if (ipx_msg_header_cnt_dec(msg)) {
+        // Other destinations have already processed the message
+        ipx_msg_destroy(msg);
+    }
+}
+
+/**
+ * \brief Move as many messages as possible from the backlog into the ring buffer
+ * \param[in] rec   Output destination
+ * \param[in] block Wait until all messages are added
+ */
+static void
+output_mgr_backlog_flush(struct ipx_output_mgr_rec *rec, bool block)
+{
+    while (rec->backlog.cnt > 0) {
+        ipx_msg_t *msg = rec->backlog.msgs[rec->backlog.head];
+        if (block) {
+            ipx_ring_push(rec->ring, msg);
+        } else if (!ipx_ring_try_push(rec->ring, msg)) {
+            return;
+        }
+
+        rec->backlog.head = (rec->backlog.head + 1) % OUTPUT_MGR_BACKLOG_SIZE;
+        rec->backlog.cnt--;
+        if (ipx_msg_get_type(msg) == IPX_MSG_IPFIX) {
+            rec->backlog.ipfix_cnt--;
+        }
+    }
+}
+
+/**
+ * \brief Drop the oldest IPFIX Message in the backlog
+ *
+ * Older messages of other types (if any) keep their order and are moved to close the gap.
+ * \warning The backlog must contain at least one IPFIX Message.
+ * \param[in] rec Output destination
+ */
+static void
+output_mgr_backlog_drop(struct ipx_output_mgr_rec *rec)
+{
+    assert(rec->backlog.ipfix_cnt > 0);
+    ipx_msg_t **msgs = rec->backlog.msgs;
+    const uint32_t head = rec->backlog.head;
+    uint32_t pos = 0;
+    while (ipx_msg_get_type(msgs[(head + pos) % OUTPUT_MGR_BACKLOG_SIZE]) != IPX_MSG_IPFIX) {
+        pos++;
+    }
+
+    ipx_msg_t *oldest = msgs[(head + pos) % OUTPUT_MGR_BACKLOG_SIZE];
+    for (; pos > 0; --pos) {
+        const uint32_t idx = (head + pos) % OUTPUT_MGR_BACKLOG_SIZE;
+        msgs[idx] = msgs[(idx + OUTPUT_MGR_BACKLOG_SIZE - 1) % OUTPUT_MGR_BACKLOG_SIZE];
+    }
+
+    rec->backlog.head = (head + 1) % OUTPUT_MGR_BACKLOG_SIZE;
+    rec->backlog.cnt--;
+    rec->backlog.ipfix_cnt--;
+    output_mgr_drop(rec, oldest);
+}
+
+/**
+ * \brief Pass a message to an output instance with respect to its overflow policy
+ *
+ * If the ring buffer of the output is full, IPFIX Messages are dropped based on the policy.
+ * Other types of messages (Transport Session, Garbage, etc.) are never dropped, instead they
+ * wait in the backlog. IPFIX Messages can occupy at most #OUTPUT_MGR_BACKLOG_IPFIX records of
+ * the backlog, therefore, the rest of the backlog is always available for other messages.
+ * Only if the whole backlog is full (i.e. the reserved space has been exhausted by other
+ * messages), the function blocks until the oldest message is added into the ring buffer.
+ * Termination message always flushes the backlog.
+ * \param[in] rec Output destination
+ * \param[in] msg Message to pass (with already configured reference counter)
+ * \return True if the message has been dropped, false otherwise
+ */
+static bool
+output_mgr_deliver(struct ipx_output_mgr_rec *rec, ipx_msg_t *msg)
+{
+    if (rec->overflow == IPX_OVERFLOW_BLOCK) {
+        ipx_ring_push(rec->ring, msg);
+        return false;
+    }
+
+    // Older messages must be delivered first
+    output_mgr_backlog_flush(rec, false);
+    if (rec->backlog.cnt == 0 && ipx_ring_try_push(rec->ring, msg)) {
+        return false;
+    }
+
+    // The ring buffer is full
+    const enum ipx_msg_type type = ipx_msg_get_type(msg);
+    if (type == IPX_MSG_TERMINATE) {
+        output_mgr_backlog_flush(rec, true);
+        ipx_ring_push(rec->ring, msg);
+        return false;
+    }
+
+    if (type == IPX_MSG_IPFIX && rec->overflow == IPX_OVERFLOW_DROP_NEWEST) {
+        output_mgr_drop(rec, msg);
+        return true;
+    }
+
+    bool dropped = false;
+    if (type == IPX_MSG_IPFIX && rec->backlog.ipfix_cnt == OUTPUT_MGR_BACKLOG_IPFIX) {
+        // Make space for the new message by removing the oldest one (drop oldest policy)
+        output_mgr_backlog_drop(rec);
+        dropped = true;
+    }
+
+    while (rec->backlog.cnt == OUTPUT_MGR_BACKLOG_SIZE) {
+        // The reserved space is exhausted, wait until the oldest message can be added
+        ipx_msg_t *oldest = rec->backlog.msgs[rec->backlog.head];
+        rec->backlog.head = (rec->backlog.head + 1) % OUTPUT_MGR_BACKLOG_SIZE;
+        rec->backlog.cnt--;
+
+        if (ipx_msg_get_type(oldest) == IPX_MSG_IPFIX) {
+            rec->backlog.ipfix_cnt--;
+            output_mgr_drop(rec, oldest);
+            dropped = true;
+        } else {
+            ipx_ring_push(rec->ring, oldest);
+        }
+    }
+
+    uint32_t idx = (rec->backlog.head + rec->backlog.cnt) % OUTPUT_MGR_BACKLOG_SIZE;
+    rec->backlog.msgs[idx] = msg;
+    rec->backlog.cnt++;
+    if (type == IPX_MSG_IPFIX) {
+        rec->backlog.ipfix_cnt++;
+    }
+    return dropped;
+}
+
+/**
+ * \brief Report dropped messages of all output instances (rate limited)
+ * \param[in] ctx  Plugin context
+ * \param[in] list List of output destinations
+ */
+static void
+output_mgr_report(ipx_ctx_t *ctx, struct ipx_output_mgr_list *list)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+    if (ts.tv_sec - list->report_time < OUTPUT_MGR_REPORT_INTERVAL) {
+        return;
+    }
+
+    list->report_time = ts.tv_sec;
+    for (size_t i = 0; i < list->size; ++i) {
+        struct ipx_output_mgr_rec *rec = &list->recs[i];
+        if (rec->dropped.msgs == rec->dropped.msgs_reported) {
+            continue;
+        }
+
+        IPX_CTX_WARNING(ctx, "Output instance '%s' is not able to keep up. %" PRIu64 " IPFIX "
+            "message(s) with %" PRIu64 " Data Record(s) dropped since the last report (total: "
+            "%" PRIu64 " messages).", rec->name, rec->dropped.msgs - rec->dropped.msgs_reported,
+            rec->dropped.recs - rec->dropped.recs_reported, rec->dropped.msgs);
+        rec->dropped.msgs_reported = rec->dropped.msgs;
+        rec->dropped.recs_reported = rec->dropped.recs;
+    }
+}
+
+/**
+ * \brief Check if IPFIX Messages with a given ODID should be passed to an output instance
+ * \param[in] rec  Output destination
+ * \param[in] odid Observation Domain ID
+ * \return True or false
+ */
+static inline bool
+output_mgr_match(const struct ipx_output_mgr_rec *rec, uint32_t odid)
+{
+    switch (rec->type) {
+    case IPX_ODID_FILTER_ONLY:
+        return ipx_orange_in(rec->odid_filter, odid);
+    case IPX_ODID_FILTER_EXCEPT:
+        return !ipx_orange_in(rec->odid_filter, odid);
+    case IPX_ODID_FILTER_NONE:
+    default:
+        return true;
+    }
+}
+
+/**
+ * \brief Evaluate ODID filters of all output instances and store the result to the temporary route
+ * \param[in] list List of output destinations
+ * \param[in] odid Observation Domain ID
+ * \return The temporary route
+ */
+static struct output_mgr_route *
+output_mgr_route_compile(struct ipx_output_mgr_list *list, uint32_t odid)
+{
+    struct output_mgr_route *route = list->route_tmp;
+    route->cnt = 0;
+    for (size_t i = 0; i < list->size; ++i) {
+        if (output_mgr_match(&list->recs[i], odid)) {
+            route->dests[route->cnt++] = i;
+        }
+    }
+
+    return route;
+}
+
+/**
+ * \brief Get a slot of the routing cache
+ * \param[in] table Hash table
+ * \param[in] size  Number of records in the table (power of two)
+ * \param[in] odid  Observation Domain ID
+ * \return Pointer to the record with the ODID or to an empty record where it should be stored
+ */
+static inline struct output_mgr_cache_rec *
+output_mgr_cache_slot(struct output_mgr_cache_rec *table, uint32_t size, uint32_t odid)
+{
+    // Multiplicative hashing (ODIDs are often small consecutive numbers)
+    uint32_t idx = (uint32_t) (((uint64_t) odid * 0x9E3779B97F4A7C15ULL) >> 32) & (size - 1);
+    while (table[idx].route != NULL && table[idx].odid != odid) {
+        idx = (idx + 1) & (size - 1);
+    }
+
+    return &table[idx];
+}
+
+/**
+ * \brief Prepare the routing cache for a new record
+ *
+ * If the cache is not allocated yet or it is half full, its size is doubled. If the maximal
+ * size has been reached, all records are removed, however, the compiled routes are preserved.
+ * \param[in] list List of output destinations
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_NOMEM if a memory allocation error has occurred
+ */
+static int
+output_mgr_cache_reserve(struct ipx_output_mgr_list *list)
+{
+    if (list->cache.table != NULL && 2 * (list->cache.used + 1) <= list->cache.size) {
+        return IPX_OK;
+    }
+
+    if (list->cache.size == OUTPUT_MGR_CACHE_MAX) {
+        // Too many ODIDs, start over
+        memset(list->cache.table, 0, list->cache.size * sizeof(*list->cache.table));
+        list->cache.used = 0;
+        return IPX_OK;
+    }
+
+    uint32_t new_size = (list->cache.size == 0) ? OUTPUT_MGR_CACHE_DEF : 2 * list->cache.size;
+    struct output_mgr_cache_rec *new_table = calloc(new_size, sizeof(*new_table));
+    if (!new_table) {
+        return IPX_ERR_NOMEM;
+    }
+
+    for (uint32_t i = 0; i < list->cache.size; ++i) {
+        const struct output_mgr_cache_rec *rec = &list->cache.table[i];
+        if (rec->route == NULL) {
+            continue;
+        }
+
+        *output_mgr_cache_slot(new_table, new_size, rec->odid) = *rec;
+    }
+
+    free(list->cache.table);
+    list->cache.table = new_table;
+    list->cache.size = new_size;
+    return IPX_OK;
+}
+
+/**
+ * \brief Find a compiled route equal to the temporary route or add a new one
+ * \param[in] list List of output destinations
+ * \return Pointer to the route or NULL (memory allocation error)
+ */
+static const struct output_mgr_route *
+output_mgr_route_store(struct ipx_output_mgr_list *list)
+{
+    const struct output_mgr_route *tmp = list->route_tmp;
+    const size_t dests_size = tmp->cnt * sizeof(tmp->dests[0]);
+
+    for (size_t i = 0; i < list->cache.routes_cnt; ++i) {
+        const struct output_mgr_route *route = list->cache.routes[i];
+        if (route->cnt == tmp->cnt && memcmp(route->dests, tmp->dests, dests_size) == 0) {
+            return route;
+        }
+    }
+
+    size_t new_cnt = list->cache.routes_cnt + 1;
+    struct output_mgr_route **new_routes = realloc(list->cache.routes,
+        new_cnt * sizeof(*new_routes));
+    if (!new_routes) {
+        return NULL;
+    }
+
+    list->cache.routes = new_routes;
+    struct output_mgr_route *route = malloc(sizeof(*route) + dests_size);
+    if (!route) {
+        return NULL;
+    }
+
+    route->cnt = tmp->cnt;
+    memcpy(route->dests, tmp->dests, dests_size);
+    list->cache.routes[list->cache.routes_cnt++] = route;
+    return route;
+}
+
+/**
+ * \brief Get destinations of IPFIX Messages with a given ODID
+ *
+ * If the routing decision is not in the cache yet, ODID filters of all output instances are
+ * evaluated and the result is stored into the cache. If the cache cannot be extended, the
+ * temporary route is returned (valid only until the next call).
+ * \param[in] list List of output destinations
+ * \param[in] odid Observation Domain ID
+ * \return Route
+ */
+static const struct output_mgr_route *
+output_mgr_route_get(struct ipx_output_mgr_list *list, uint32_t odid)
+{
+    struct output_mgr_cache_rec *slot;
+    if (list->cache.table != NULL) {
+        slot = output_mgr_cache_slot(list->cache.table, list->cache.size, odid);
+        if (slot->route != NULL) {
+            return slot->route;
+        }
+    }
+
+    // Cache miss
+    const struct output_mgr_route *route = output_mgr_route_compile(list, odid);
+    if (output_mgr_cache_reserve(list) != IPX_OK) {
+        return route;
+    }
+
+    const struct output_mgr_route *stored = output_mgr_route_store(list);
+    if (!stored) {
+        return route;
+    }
+
+    slot = output_mgr_cache_slot(list->cache.table, list->cache.size, odid);
+    slot->odid = odid;
+    slot->route = stored;
+    list->cache.used++;
+    return stored;
 }
 
 int
 ipx_plugin_output_mgr_process(ipx_ctx_t *ctx, void *cfg, ipx_msg_t *msg)
 {
-    (void) ctx;
     // List of output destination is prepared by the configurator
     struct ipx_output_mgr_list *list = (struct ipx_output_mgr_list *) cfg;
     assert(list != NULL);
+    bool dropped = false;
 
     // Only IPFIX messages are filtered
     enum ipx_msg_type msg_type = ipx_msg_get_type(msg);
@@ -170,58 +711,45 @@ ipx_plugin_output_mgr_process(ipx_ctx_t *ctx, void *cfg, ipx_msg_t *msg)
         ipx_msg_header_cnt_set(msg, (unsigned int) list->size);
 
         for (size_t i = 0; i < list->size; ++i) {
-            ipx_ring_push(list->recs[i].ring, msg);
+            dropped |= output_mgr_deliver(&list->recs[i], msg);
         }
 
-        return IPX_OK;
-    }
-
-    // First, get number of destinations...
-    uint64_t dest_mask = 0;
-    unsigned int dest_cnt = 0;
-    uint32_t odid = ipx_msg_ipfix_get_ctx(ipx_msg_base2ipfix(msg))->odid;
-
-    for (size_t i = 0; i < list->size; ++i) {
-        struct ipx_output_mgr_rec *rec = &list->recs[i];
-        switch (rec->type) {
-        case IPX_ODID_FILTER_NONE:
-            // Add to the destinations
-            break;
-        case IPX_ODID_FILTER_ONLY:
-            if (ipx_orange_in(rec->odid_filter, odid)) {
-                break;    // Add to the destinations
-            } else {
-                continue; // Skip
-            }
-        case IPX_ODID_FILTER_EXCEPT:
-            if (ipx_orange_in(rec->odid_filter, odid)) {
-                continue; // Skip
-            } else {
-                break;    // Add to the destinations
-            }
+        if (dropped) {
+            output_mgr_report(ctx, list);
         }
 
-        dest_mask |= (1ULL << i);
-        dest_cnt++;
+        return IPX_OK;
     }
 
-    if (dest_cnt == 0) {
+    // Get destinations based on the ODID (usually cached)
+    uint32_t odid = ipx_msg_ipfix_get_ctx(ipx_msg_base2ipfix(msg))->odid;
+    const struct output_mgr_route *route = output_mgr_route_get(list, odid);
+    if (route->cnt == 0) {
         // No-one wants the message -> destroy
         ipx_msg_ipfix_destroy(ipx_msg_base2ipfix(msg));
         return IPX_OK;
     }
 
     // Set the number of references and send to all selected destinations
-    ipx_msg_header_cnt_set(msg, dest_cnt);
-    for (size_t dest_idx = 0; dest_mask != 0; dest_idx++, dest_mask >>= 1) {
-        if ((dest_mask & 0x1) == 0) {
-            // Skip
-            continue;
-        }
+    ipx_msg_header_cnt_set(msg, (unsigned int) route->cnt);
+    for (size_t i = 0; i < route->cnt; ++i) {
+        dropped |= output_mgr_deliver(&list->recs[route->dests[i]], msg);
+    }
 
-        struct ipx_output_mgr_rec *rec = &list->recs[dest_idx];
-        ipx_ring_push(rec->ring, msg);
+    if (dropped) {
+        output_mgr_report(ctx, list);
     }
 
     return IPX_OK;
-}
\ No newline at end of file
+}
+
+void
+ipx_plugin_output_mgr_idle(ipx_ctx_t *ctx, void *cfg)
+{
+    (void) ctx;
+    struct ipx_output_mgr_list *list = (struct ipx_output_mgr_list *) cfg;
+    for (size_t i = 0; list != NULL && i < list->size; ++i) {
+        // Messages must not wait in the backlog until the next message arrives
+        output_mgr_backlog_flush(&list->recs[i], false);
+    }
+}
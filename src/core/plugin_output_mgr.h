@@ -49,6 +49,16 @@
 /** Internal type of list of output destinations */
 typedef struct ipx_output_mgr_list ipx_output_mgr_list_t;
 
+/** Policy applied when an input ring buffer of an output instance is full */
+enum ipx_overflow_policy {
+    /** Wait until the output instance processes older messages (default)                    */
+    IPX_OVERFLOW_BLOCK,
+    /** Drop IPFIX Messages that cannot be added into the buffer                              */
+    IPX_OVERFLOW_DROP_NEWEST,
+    /** Drop the oldest IPFIX Messages waiting for the buffer to make space for new ones      */
+    IPX_OVERFLOW_DROP_OLDEST
+};
+
 /**
  * \brief Create a new output manager list
  *
@@ -66,6 +76,14 @@ ipx_output_mgr_list_create();
 bool
 ipx_output_mgr_list_empty(const ipx_output_mgr_list_t *list);
 
+/**
+ * \brief Get number of destinations in the list
+ * \param[in] list Output manager list
+ * \return Number of destinations
+ */
+size_t
+ipx_output_mgr_list_size(const ipx_output_mgr_list_t *list);
+
 /**
  * \brief Destroy the list
  *
@@ -77,17 +95,58 @@ ipx_output_mgr_list_destroy(ipx_output_mgr_list_t *list);
 
 /**
  * \brief Add a new destination to the list
+ *
+ * If the \p overflow policy is not #IPX_OVERFLOW_BLOCK, IPFIX Messages that cannot be added
+ * into the ring buffer of the output (i.e. it is full) are dropped. Other types of messages
+ * are never dropped. Messages that cannot be added immediately are kept in a small backlog
+ * of the output manager and the "drop oldest" policy drops the oldest messages from there.
+ * Part of the backlog is reserved for other messages than IPFIX Messages, so they are
+ * delayed instead of blocking the manager, unless the reserved part is also exhausted.
  * \param[in] list        Output manager list
  * \param[in] ring        Output plugin connection  (for a writer)
  * \param[in] odid_type   ODID filter type
  * \param[in] odid_filter ODID filter (should be NULL, if odid_type == IPX_ODID_FILTER_NONE)
+ * \param[in] overflow    Overflow policy
+ * \param[in] name        Name of the output instance (for reports of dropped messages)
  * \return #IPX_OK on success
  * \return #IPX_ERR_ARG in case of invalid combination of arguments
  * \return #IPX_ERR_NOMEM if a memory allocation error has occurred
  */
 int
 ipx_output_mgr_list_add(ipx_output_mgr_list_t *list, ipx_ring_t *ring,
-    enum ipx_odid_filter_type odid_type, const ipx_orange_t *odid_filter);
+    enum ipx_odid_filter_type odid_type, const ipx_orange_t *odid_filter,
+    enum ipx_overflow_policy overflow, const char *name);
+
+/**
+ * \brief Get number of messages dropped due to the overflow policy of a destination
+ *
+ * The counters are exported by the collector of pipeline statistics (see
+ * ipx_stats_register_output()).
+ * \note The function can be called from any thread.
+ * \param[in]  list Output manager list
+ * \param[in]  idx  Index of the destination (in order of addition)
+ * \param[out] msgs Number of dropped IPFIX Messages
+ * \param[out] recs Number of dropped Data Records
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_NOTFOUND if the destination doesn't exist
+ */
+int
+ipx_output_mgr_list_dropped(const ipx_output_mgr_list_t *list, size_t idx, uint64_t *msgs,
+    uint64_t *recs);
+
+/**
+ * \brief Get size of the routing cache
+ *
+ * The cache is built lazily by the output manager and it is cleared when a new destination
+ * is added to the list.
+ * \note Intended only for diagnostics and unit tests of the routing cache.
+ * \warning The function must be called from the thread of the output manager.
+ * \param[in]  list   Output manager list
+ * \param[out] odids  Number of cached ODIDs
+ * \param[out] routes Number of unique routes (destination lists) shared by cached ODIDs
+ */
+void
+ipx_output_mgr_list_cached(const ipx_output_mgr_list_t *list, size_t *odids, size_t *routes);
 
 // ------------------------------------------------------------------------------------------------
 
@@ -105,8 +164,9 @@ int
 ipx_plugin_output_mgr_init(ipx_ctx_t *ctx, const char *params);
 
 /**
- * \brief Destroy an IPFIX parser
- * \note The parser is send as a garbage message before destruction.
+ * \brief Destroy the output manager
+ * \note Private data (i.e. the list of destinations) are not freed. Only total numbers of dropped
+ *   messages are reported.
  * \param[in] ctx Plugin context
  * \param[in] cfg Private instance data
  */
@@ -127,4 +187,15 @@ ipx_plugin_output_mgr_destroy(ipx_ctx_t *ctx, void *cfg);
 int
 ipx_plugin_output_mgr_process(ipx_ctx_t *ctx, void *cfg, ipx_msg_t *msg);
 
+/**
+ * \brief Perform periodic tasks of the output manager when there are no messages to process
+ *
+ * Messages waiting in backlogs of output instances are added into their ring buffers (if
+ * possible).
+ * \param[in] ctx Plugin context
+ * \param[in] cfg Private instance data
+ */
+void
+ipx_plugin_output_mgr_idle(ipx_ctx_t *ctx, void *cfg);
+
 #endif //IPFIXCOL_PLUGIN_OUTPUT_MGR_H
@@ -76,6 +76,11 @@ ipx_plugin_parser_init(ipx_ctx_t *ctx, const char *params)
         return IPX_ERR_DENIED;
     }
 
+    // Parser counters are part of the statistics of the instance
+    ipx_parser_stats_set(parser, &ipx_ctx_stats_get(ctx)->parser);
+    // Templates of UDP sessions can be persistent across restarts
+    ipx_parser_tstore_set(parser, ipx_ctx_tstore_get(ctx));
+
     ipx_msg_garbage_t *garbage = NULL;
     if (ipx_parser_ie_source(parser, ipx_ctx_iemgr_get(ctx), &garbage) != IPX_OK) {
         IPX_CTX_ERROR(ctx, "Failed to create set a source of Information Elements!", '\0');
@@ -97,6 +102,14 @@ ipx_plugin_parser_destroy(ipx_ctx_t *ctx, void *cfg)
 {
     ipx_parser_t *parser = (ipx_parser_t *) cfg;
 
+    /* Publish the latest templates of UDP sessions (if enabled), the store is saved by its
+     * owner after all parsers sharing it are destroyed.
+     * Note: Transport Session close events might not be processed during termination.
+     */
+    if (ipx_ctx_tstore_get(ctx) != NULL) {
+        ipx_parser_tstore_publish(parser);
+    }
+
     // Create a garbage message
     ipx_msg_garbage_cb cb = (ipx_msg_garbage_cb) &ipx_parser_destroy;
     ipx_msg_garbage_t *garbage = ipx_msg_garbage_create(parser, cb);
@@ -263,6 +276,7 @@ parser_plugin_process_ipfix(ipx_ctx_t *ctx, ipx_parser_t *parser, ipx_msg_ipfix_
         return IPX_OK;
     }
 
+    ipx_stats_cnt_add(&ipx_ctx_stats_get(ctx)->parser.msg_dropped, 1);
     if (rc == IPX_ERR_DENIED) {
         // Due to previous failures, connection to the session is blocked
         ipx_msg_ipfix_destroy(ipfix);
@@ -313,3 +327,10 @@ ipx_plugin_parser_process(ipx_ctx_t *ctx, void *cfg, ipx_msg_t *msg)
 
     return IPX_OK;
 }
+
+void
+ipx_plugin_parser_idle(ipx_ctx_t *ctx, void *cfg)
+{
+    (void) ctx;
+    ipx_parser_reclaim((ipx_parser_t *) cfg);
+}
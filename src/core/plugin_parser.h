@@ -77,4 +77,14 @@ ipx_plugin_parser_destroy(ipx_ctx_t *ctx, void *cfg);
 int
 ipx_plugin_parser_process(ipx_ctx_t *ctx, void *cfg, ipx_msg_t *msg);
 
+/**
+ * \brief Perform periodic tasks of an IPFIX parser when there are no messages to process
+ *
+ * Retired (Options) Templates that are not referenced anymore are destroyed.
+ * \param[in] ctx Plugin context
+ * \param[in] cfg Private instance data
+ */
+void
+ipx_plugin_parser_idle(ipx_ctx_t *ctx, void *cfg);
+
 #endif // IPFIXCOL_PLUGIN_PARSER_H
@@ -40,9 +40,13 @@
  */
 
 #include <stdlib.h> // aligned_malloc
-//#include <unistd.h>
+#include <unistd.h>
 #include <pthread.h>
 #include <time.h>
+#include <limits.h>
+#include <errno.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
 
 #include "ring.h"
 #include "verbose.h"
@@ -66,6 +70,25 @@
 
 /** Internal identification of the ring buffer */
 static const char *module = "Ring buffer";
+/** Implementation of newly created ring buffers */
+static enum ipx_ring_type ring_type_default = IPX_RING_MUTEX;
+
+/**
+ * \brief Update a high-water mark of a ring buffer
+ * \note Must be called only by the reader.
+ * \param[in] hwm  High-water mark
+ * \param[in] used Number of messages in the ring buffer
+ */
+static inline void
+ring_hwm_update(uint32_t *hwm, uint32_t used)
+{
+    if (used > *hwm) {
+        __atomic_store_n(hwm, used, __ATOMIC_RELAXED);
+    }
+}
+
+// -------------------------------------------------------------------------------------------------
+// Mutex based implementation
 
 /** \brief Data structure for a reader only */
 struct ring_reader {
@@ -101,6 +124,8 @@ struct ring_reader {
 
     /** Previously read messages - only 0 or 1 */
     uint32_t last;
+    /** High-water mark (written only by the reader, read atomically by anyone) */
+    uint32_t hwm;
 };
 
 /** \brief Data structure for writers only */
@@ -160,8 +185,8 @@ struct ring_sync {
     pthread_cond_t     cond_writer;
 };
 
-/** \brief Ring buffer */
-struct ipx_ring {
+/** \brief Ring buffer (mutex based implementation) */
+struct ring_mtx {
     /** A Reader only structure (cache aligned)         */
     struct ring_reader reader      __ipx_cache_aligned;
     /** Writers only structure (cache aligned)          */
@@ -176,22 +201,21 @@ struct ipx_ring {
     ipx_msg_t        **data;
 };
 
-ipx_ring_t *
-ipx_ring_init(uint32_t size, bool mw_mode)
+/**
+ * \brief Initialize a mutex based ring buffer
+ * \param[in] ring    Uninitialized structure
+ * \param[in] size    Size of the ring buffer (number of pointers)
+ * \param[in] mw_mode Multi-writer mode
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_NOMEM in case of a memory allocation or initialization error
+ */
+static int
+ring_mtx_init(struct ring_mtx *ring, uint32_t size, bool mw_mode)
 {
-    ipx_ring_t *ring;
-
-    // Prepare data structures
-    ring = aligned_alloc(alignof(struct ipx_ring), sizeof(struct ipx_ring));
-    if (!ring) {
-        IPX_ERROR(module, "aligned_alloc() failed! (%s:%d)", __FILE__, __LINE__);
-        return NULL;
-    }
-
     ring->data = aligned_alloc(alignof(*ring->data), sizeof(*ring->data) * size);
     if (!ring->data) {
         IPX_ERROR(module, "aligned_alloc() failed! (%s:%d)", __FILE__, __LINE__);
-        goto exit_A;
+        return IPX_ERR_NOMEM;
     }
 
     // Initialize writers' spin lock
@@ -239,6 +263,7 @@ ipx_ring_init(uint32_t size, bool mw_mode)
     ring->reader.exchange_idx = 0;
     ring->reader.read_commit_idx = 0;
     ring->reader.last = 0;
+    ring->reader.hwm = 0;
 
     ring->writer.size = size;
     ring->writer.div_block = size / 8;
@@ -251,7 +276,7 @@ ipx_ring_init(uint32_t size, bool mw_mode)
     ring->sync.write_idx = size;
 
     ring->mw_mode = mw_mode;
-    return ring;
+    return IPX_OK;
 
     // In case failure
 exit_F:
@@ -264,13 +289,15 @@ exit_C:
     pthread_spin_destroy(&ring->writer_lock);
 exit_B:
     free(ring->data);
-exit_A:
-    free(ring);
-    return NULL;
+    return IPX_ERR_NOMEM;
 }
 
-void
-ipx_ring_destroy(ipx_ring_t *ring)
+/**
+ * \brief Destroy a mutex based ring buffer
+ * \param[in] ring Ring buffer
+ */
+static void
+ring_mtx_destroy(struct ring_mtx *ring)
 {
     // The last read message is not confirmed by the reader, it is 1 index behind -> "+ 1"
     if (ring->reader.read_idx + 1 != ring->writer.write_idx) {
@@ -284,7 +311,6 @@ ipx_ring_destroy(ipx_ring_t *ring)
     pthread_mutex_destroy(&ring->sync.mutex);
     pthread_spin_destroy(&ring->writer_lock);
     free(ring->data);
-    free(ring);
 }
 
 /**
@@ -308,17 +334,47 @@ ring_cond_timedwait(pthread_cond_t *restrict cond, pthread_mutex_t *restrict mut
     return pthread_cond_timedwait(cond, mutex, &ts);
 }
 
+/**
+ * \brief Get an absolute (monotonic) time of a deadline
+ * \param[out] ts   Deadline
+ * \param[in]  msec Number of milliseconds from now
+ */
+static inline void
+ring_deadline_set(struct timespec *ts, uint32_t msec)
+{
+    clock_gettime(CLOCK_MONOTONIC, ts);
+    ts->tv_sec += msec / 1000U;
+    ts->tv_nsec += (long) (msec % 1000U) * 1000000;
+    if (ts->tv_nsec >= 1000000000) {
+        ts->tv_nsec -= 1000000000;
+        ts->tv_sec += 1;
+    }
+}
+
+/**
+ * \brief Check if a deadline has expired
+ * \param[in] ts Deadline (see ring_deadline_set())
+ * \return True or false
+ */
+static inline bool
+ring_deadline_expired(const struct timespec *ts)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec > ts->tv_sec || (now.tv_sec == ts->tv_sec && now.tv_nsec >= ts->tv_nsec));
+}
+
 /**
  * \brief Get a new empty field
  *
  * \note The function blocks until a required memory is ready. Before the next call of this
- *   function, the function ipx_ring_commit() MUST be called first, to commit performed
+ *   function, the function ring_mtx_commit() MUST be called first, to commit performed
  *   modifications.
  * \param[in] ring Ring buffer
  * \return Pointer to a unused place in the buffer
  */
 static inline ipx_msg_t **
-ipx_ring_begin(ipx_ring_t *ring)
+ring_mtx_begin(struct ring_mtx *ring)
 {
     // Prepare the next pointer to write
     ipx_msg_t **msg = &ring->data[ring->writer.data_idx];
@@ -344,12 +400,37 @@ ipx_ring_begin(ipx_ring_t *ring)
     return msg;
 }
 
+/**
+ * \brief Try to get a new empty field (non-blocking)
+ *
+ * Unlike ring_mtx_begin(), the function doesn't wait until the reader releases some memory.
+ * The free space is checked without the lock, because the position released by the reader is
+ * updated atomically. Therefore, a writer polling a full buffer doesn't contend for the lock
+ * with the reader (committed messages are collected by the reader itself, if necessary).
+ * \note If a field is returned, the function ring_mtx_commit() MUST be called before the next
+ *   call of this function.
+ * \param[in] ring Ring buffer
+ * \return Pointer to a unused place in the buffer or NULL (the buffer is full)
+ */
+static inline ipx_msg_t **
+ring_mtx_try_begin(struct ring_mtx *ring)
+{
+    ipx_msg_t **msg = &ring->data[ring->writer.data_idx];
+    if (ring->writer.exchange_idx - ring->writer.write_idx > 0) {
+        return msg;
+    }
+
+    // Get an empty space released by the reader (if any)
+    ring->writer.exchange_idx = __atomic_load_n(&ring->sync.write_idx, __ATOMIC_ACQUIRE);
+    return (ring->writer.exchange_idx - ring->writer.write_idx > 0) ? msg : NULL;
+}
+
 /**
  * \brief Commit modifications of memory
  * \param[in] ring Ring buffer
  */
 static inline void
-ipx_ring_commit(ipx_ring_t *ring)
+ring_mtx_commit(struct ring_mtx *ring)
 {
     register uint32_t new_idx = 1;
     ring->writer.data_idx++;
@@ -373,8 +454,13 @@ ipx_ring_commit(ipx_ring_t *ring)
     }
 }
 
-void
-ipx_ring_push(ipx_ring_t *ring, ipx_msg_t *msg)
+/**
+ * \brief Add a message into a mutex based ring buffer
+ * \param[in] ring Ring buffer
+ * \param[in] msg  Message to be added into the ring buffer
+ */
+static inline void
+ring_mtx_push(struct ring_mtx *ring, ipx_msg_t *msg)
 {
     ipx_msg_t **msg_space;
 
@@ -382,18 +468,51 @@ ipx_ring_push(ipx_ring_t *ring, ipx_msg_t *msg)
         pthread_spin_lock(&ring->writer_lock);
     }
 
-    msg_space = ipx_ring_begin(ring);
+    msg_space = ring_mtx_begin(ring);
     *msg_space = msg;
-    ipx_ring_commit(ring);
+    ring_mtx_commit(ring);
 
     if (ring->mw_mode) {
         pthread_spin_unlock(&ring->writer_lock);
     }
 }
 
+/**
+ * \brief Try to add a message into a mutex based ring buffer (non-blocking)
+ * \param[in] ring Ring buffer
+ * \param[in] msg  Message to be added into the ring buffer
+ * \return True on success, false if the buffer is full
+ */
+static inline bool
+ring_mtx_try_push(struct ring_mtx *ring, ipx_msg_t *msg)
+{
+    ipx_msg_t **msg_space;
 
-ipx_msg_t *
-ipx_ring_pop(ipx_ring_t *ring)
+    if (ring->mw_mode) {
+        pthread_spin_lock(&ring->writer_lock);
+    }
+
+    msg_space = ring_mtx_try_begin(ring);
+    if (msg_space != NULL) {
+        *msg_space = msg;
+        ring_mtx_commit(ring);
+    }
+
+    if (ring->mw_mode) {
+        pthread_spin_unlock(&ring->writer_lock);
+    }
+
+    return (msg_space != NULL);
+}
+
+/**
+ * \brief Get a message from a mutex based ring buffer
+ * \param[in] ring    Ring buffer
+ * \param[in] timeout Maximal time to wait for the message (NULL to wait indefinitely)
+ * \return Pointer to the message or NULL (the timeout has expired)
+ */
+static inline ipx_msg_t *
+ring_mtx_pop(struct ring_mtx *ring, const struct timespec *timeout)
 {
     // Consider previous memory block as processed
     ring->reader.data_idx += ring->reader.last;
@@ -411,11 +530,14 @@ ipx_ring_pop(ipx_ring_t *ring)
     // Sync positions with writers, if necessary
     if (ring->reader.read_idx - ring->reader.read_commit_idx >= ring->reader.div_block) {
         pthread_mutex_lock(&ring->sync.mutex);
-        ring->sync.write_idx += ring->reader.read_idx - ring->reader.read_commit_idx;
+        // Release the space atomically, see ring_mtx_try_begin()
+        const uint32_t released = ring->reader.read_idx - ring->reader.read_commit_idx;
+        __atomic_store_n(&ring->sync.write_idx, ring->sync.write_idx + released, __ATOMIC_RELEASE);
         ring->reader.exchange_idx = ring->sync.read_idx;
         ring->reader.read_commit_idx = ring->reader.read_idx;
         pthread_cond_signal(&ring->sync.cond_writer);
         pthread_mutex_unlock(&ring->sync.mutex);
+        ring_hwm_update(&ring->reader.hwm, ring->reader.exchange_idx - ring->reader.read_idx);
     }
 
     if (ring->reader.exchange_idx - ring->reader.read_idx > 0) {
@@ -436,6 +558,7 @@ ipx_ring_pop(ipx_ring_t *ring)
 
         if (ring->reader.exchange_idx - ring->reader.read_idx > 0) {
             // TODO: prefetch
+            ring_hwm_update(&ring->reader.hwm, ring->reader.exchange_idx - ring->reader.read_idx);
             ring->reader.last = 1;
             return *msg; // Now, we can dereference the pointer
         }
@@ -450,11 +573,783 @@ ipx_ring_pop(ipx_ring_t *ring)
             ring->reader.last = 1;
             return *msg; // Now, we can dereference the pointer
         }
+
+        if (timeout != NULL && ring_deadline_expired(timeout)) {
+            return NULL;
+        }
+    }
+}
+
+/**
+ * \brief Add multiple messages into a mutex based ring buffer
+ *
+ * In the multi-writer mode, the writer lock is acquired only once for all messages.
+ * \param[in] ring Ring buffer
+ * \param[in] msgs Array of messages to be added into the ring buffer
+ * \param[in] cnt  Number of messages in the array
+ */
+static inline void
+ring_mtx_push_batch(struct ring_mtx *ring, ipx_msg_t **msgs, uint32_t cnt)
+{
+    ipx_msg_t **msg_space;
+
+    if (ring->mw_mode) {
+        pthread_spin_lock(&ring->writer_lock);
+    }
+
+    for (uint32_t i = 0; i < cnt; ++i) {
+        msg_space = ring_mtx_begin(ring);
+        *msg_space = msgs[i];
+        ring_mtx_commit(ring);
+    }
+
+    if (ring->mw_mode) {
+        pthread_spin_unlock(&ring->writer_lock);
+    }
+}
+
+/**
+ * \brief Get multiple messages from a mutex based ring buffer
+ *
+ * The function blocks until at least one message is ready (or the timeout expires). Other
+ * messages are taken only if they have been already exchanged with writers (i.e. without any
+ * further synchronization).
+ * \param[in]  ring    Ring buffer
+ * \param[out] msgs    Array for messages
+ * \param[in]  max     Maximal number of messages to get (must be non-zero)
+ * \param[in]  timeout Maximal time to wait for the first message (NULL to wait indefinitely)
+ * \return Number of messages stored into the array (zero only if the timeout has expired)
+ */
+static inline uint32_t
+ring_mtx_pop_batch(struct ring_mtx *ring, ipx_msg_t **msgs, uint32_t max,
+    const struct timespec *timeout)
+{
+    uint32_t cnt = 0;
+    ipx_msg_t *first = ring_mtx_pop(ring, timeout);
+    if (!first) {
+        return 0;
+    }
+    msgs[cnt++] = first;
+
+    // Note: The previously returned message is released during the next pop
+    while (cnt < max && ring->reader.exchange_idx - (ring->reader.read_idx + 1) > 0) {
+        msgs[cnt++] = ring_mtx_pop(ring, NULL);
+    }
+
+    return cnt;
+}
+
+// -------------------------------------------------------------------------------------------------
+// Lock-free implementation
+
+/** Initial number of spin iterations before a thread goes to sleep   */
+#define RING_LF_SPIN_DEF  (256U)
+/** Minimal number of spin iterations before a thread goes to sleep   */
+#define RING_LF_SPIN_MIN  (16U)
+/** Maximal number of spin iterations before a thread goes to sleep   */
+#define RING_LF_SPIN_MAX  (16384U)
+
+/** Hint for the CPU that the thread is in a busy-wait loop */
+#if defined(__x86_64__) || defined(__i386__)
+#define ring_cpu_relax() __builtin_ia32_pause()
+#elif defined(__aarch64__)
+#define ring_cpu_relax() __asm__ __volatile__("yield" ::: "memory")
+#else
+#define ring_cpu_relax() __asm__ __volatile__("" ::: "memory")
+#endif
+
+/**
+ * \brief Slot of the lock-free ring buffer
+ *
+ * The sequence number determines the owner of the slot. If it is equal to the position of
+ * a writer, the slot is empty and the writer can fill it. If it is equal to the position of the
+ * reader + 1, the slot holds a message that can be read.
+ */
+struct ring_lf_slot {
+    /** Sequence number (modified atomically)                                                   */
+    uint64_t   seq;
+    /** Message                                                                                 */
+    ipx_msg_t *msg;
+};
+
+/** \brief Parking place of sleeping threads (futex based) */
+struct ring_lf_park {
+    /** Futex word (incremented on every wake-up)                                               */
+    uint32_t futex;
+    /** Number of threads that are about to sleep or sleeping                                   */
+    uint32_t waiting;
+};
+
+/** \brief Ring buffer (lock-free implementation) */
+struct ring_lf {
+    struct {
+        /** Position of the next read operation                                                 */
+        uint64_t head;
+        /** Number of spin iterations before sleeping (adaptive)                                */
+        uint32_t spin_limit;
+        /** Number of read messages since the last check of sleeping writers                    */
+        uint32_t wake_cnt;
+        /** High-water mark (written only by the reader, read atomically by anyone)             */
+        uint32_t hwm;
+    } reader __ipx_cache_aligned; /**< Reader only data                                        */
+
+    struct {
+        /** Position of the next write operation (shared by writers in multi-writer mode)      */
+        uint64_t tail;
+        /** Number of spin iterations before sleeping (adaptive, shared by writers)            */
+        uint32_t spin_limit;
+    } writer __ipx_cache_aligned; /**< Writer(s) only data                                     */
+
+    /** Parking place of the reader                                                             */
+    struct ring_lf_park park_reader __ipx_cache_aligned;
+    /** Parking place of the writers                                                            */
+    struct ring_lf_park park_writer __ipx_cache_aligned;
+
+    /** Mask for conversion of a position to an index of a slot (i.e. size - 1)                 */
+    uint64_t             mask     __ipx_cache_aligned;
+    /**
+     * After reading this amount of messages, the reader checks if there are sleeping writers
+     * \note Sleeping writers are also always woken up before the reader goes to sleep.
+     */
+    uint32_t             div_block;
+    /** Multiple writers mode                                                                   */
+    bool                 mw_mode;
+    /** Ring data (array of slots)                                                              */
+    struct ring_lf_slot *slots;
+};
+
+/**
+ * \brief Wait on a futex until its value is changed (or a spurious wake-up)
+ * \param[in] addr    Futex word
+ * \param[in] val     Expected value
+ * \param[in] timeout Absolute monotonic time when to stop waiting (NULL to wait indefinitely)
+ */
+static inline void
+ring_futex_wait(uint32_t *addr, uint32_t val, const struct timespec *timeout)
+{
+    if (!timeout) {
+        syscall(SYS_futex, addr, FUTEX_WAIT_PRIVATE, val, NULL, NULL, 0);
+        return;
+    }
+
+    syscall(SYS_futex, addr, FUTEX_WAIT_BITSET_PRIVATE, val, timeout, NULL,
+        FUTEX_BITSET_MATCH_ANY);
+}
+
+/**
+ * \brief Wake up threads sleeping on a futex
+ * \param[in] addr Futex word
+ * \param[in] cnt  Maximal number of threads to wake up
+ */
+static inline void
+ring_futex_wake(uint32_t *addr, int cnt)
+{
+    syscall(SYS_futex, addr, FUTEX_WAKE_PRIVATE, cnt, NULL, NULL, 0);
+}
+
+/**
+ * \brief Update the adaptive spin limit
+ *
+ * If the waiting succeeded during spinning, the limit is increased. Otherwise, spinning is
+ * probably wasting CPU time and the limit is decreased.
+ * \param[in] limit   Spin limit to update
+ * \param[in] success Waiting succeeded during spinning
+ */
+static inline void
+ring_lf_spin_update(uint32_t *limit, bool success)
+{
+    uint32_t value = __atomic_load_n(limit, __ATOMIC_RELAXED);
+    if (success) {
+        value = (value >= RING_LF_SPIN_MAX / 2) ? RING_LF_SPIN_MAX : 2 * value;
+    } else {
+        value = (value <= RING_LF_SPIN_MIN * 2) ? RING_LF_SPIN_MIN : value / 2;
+    }
+    __atomic_store_n(limit, value, __ATOMIC_RELAXED);
+}
+
+/**
+ * \brief Wake up the reader, if it is sleeping
+ *
+ * \note Must be called after a new message has been published.
+ * \param[in] ring Ring buffer
+ */
+static inline void
+ring_lf_wake_reader(struct ring_lf *ring)
+{
+    // Make sure that the published slot is visible before checking the reader's state
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&ring->park_reader.waiting, __ATOMIC_RELAXED) == 0) {
+        return;
+    }
+
+    // Only the first writer that noticed the sleeping reader performs the syscall
+    if (__atomic_exchange_n(&ring->park_reader.waiting, 0, __ATOMIC_RELAXED) != 0) {
+        __atomic_add_fetch(&ring->park_reader.futex, 1U, __ATOMIC_RELEASE);
+        ring_futex_wake(&ring->park_reader.futex, 1);
+    }
+}
+
+/**
+ * \brief Wake up all writers, if any of them is sleeping
+ *
+ * \note Must be called after one or more slots have been released by the reader.
+ * \param[in] ring Ring buffer
+ */
+static inline void
+ring_lf_wake_writers(struct ring_lf *ring)
+{
+    // Make sure that the released slots are visible before checking the writers' state
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&ring->park_writer.waiting, __ATOMIC_RELAXED) == 0) {
+        return;
+    }
+
+    __atomic_add_fetch(&ring->park_writer.futex, 1U, __ATOMIC_RELEASE);
+    ring_futex_wake(&ring->park_writer.futex, INT_MAX);
+}
+
+/**
+ * \brief Get the number of messages in a lock-free ring buffer
+ *
+ * \note Writers waiting for an empty slot are not included.
+ * \param[in] ring Ring buffer
+ * \return Number of messages
+ */
+static inline uint32_t
+ring_lf_used(const struct ring_lf *ring)
+{
+    const uint64_t head = __atomic_load_n(&ring->reader.head, __ATOMIC_RELAXED);
+    const uint64_t tail = __atomic_load_n(&ring->writer.tail, __ATOMIC_RELAXED);
+    const uint64_t used = (tail > head) ? tail - head : 0;
+    return (uint32_t) ((used > ring->mask + 1) ? ring->mask + 1 : used);
+}
+
+/**
+ * \brief Update the high-water mark of a lock-free ring buffer
+ *
+ * \note Must be called only by the reader. To avoid frequent access to the cache line of the
+ *   writers, it should be called only occasionally (e.g. together with waking up writers).
+ * \param[in] ring Ring buffer
+ */
+static inline void
+ring_lf_hwm_update(struct ring_lf *ring)
+{
+    ring_hwm_update(&ring->reader.hwm, ring_lf_used(ring));
+}
+
+/**
+ * \brief Initialize a lock-free ring buffer
+ * \param[in] ring    Uninitialized structure
+ * \param[in] size    Size of the ring buffer (will be rounded up to a power of two)
+ * \param[in] mw_mode Multi-writer mode
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_NOMEM in case of a memory allocation error
+ */
+static int
+ring_lf_init(struct ring_lf *ring, uint32_t size, bool mw_mode)
+{
+    uint64_t size_real = 2;
+    while (size_real < size) {
+        size_real <<= 1;
+    }
+
+    const size_t alloc_size = sizeof(*ring->slots) * size_real;
+    ring->slots = aligned_alloc(IPX_CLINE_SIZE, alloc_size);
+    if (!ring->slots) {
+        IPX_ERROR(module, "aligned_alloc() failed! (%s:%d)", __FILE__, __LINE__);
+        return IPX_ERR_NOMEM;
+    }
+
+    // All slots are empty, i.e. ready for the writer at the same position
+    for (uint64_t i = 0; i < size_real; ++i) {
+        ring->slots[i].seq = i;
+        ring->slots[i].msg = NULL;
+    }
+
+    ring->reader.head = 0;
+    ring->reader.spin_limit = RING_LF_SPIN_DEF;
+    ring->reader.wake_cnt = 0;
+    ring->reader.hwm = 0;
+
+    ring->writer.tail = 0;
+    ring->writer.spin_limit = RING_LF_SPIN_DEF;
+
+    ring->park_reader.futex = 0;
+    ring->park_reader.waiting = 0;
+    ring->park_writer.futex = 0;
+    ring->park_writer.waiting = 0;
+
+    ring->mask = size_real - 1;
+    ring->div_block = (uint32_t) (size_real / 8);
+    ring->mw_mode = mw_mode;
+    return IPX_OK;
+}
+
+/**
+ * \brief Destroy a lock-free ring buffer
+ * \param[in] ring Ring buffer
+ */
+static void
+ring_lf_destroy(struct ring_lf *ring)
+{
+    const uint64_t tail = __atomic_load_n(&ring->writer.tail, __ATOMIC_RELAXED);
+    if (tail != ring->reader.head) {
+        uint64_t cnt = tail - ring->reader.head;
+        IPX_WARNING(module, "Destroying of a ring buffer that still contains %" PRIu64
+            " unprocessed message(s)!", cnt);
+    }
+
+    free(ring->slots);
+}
+
+/**
+ * \brief Wait until a writer can fill its reserved slot (i.e. the buffer is full)
+ *
+ * First, try to spin for a while and, if the slot is still not released by the reader, sleep.
+ * \param[in] ring Ring buffer
+ * \param[in] slot Reserved slot
+ * \param[in] pos  Position of the writer
+ */
+static void
+ring_lf_wait_writer(struct ring_lf *ring, struct ring_lf_slot *slot, uint64_t pos)
+{
+    const uint32_t limit = __atomic_load_n(&ring->writer.spin_limit, __ATOMIC_RELAXED);
+    for (uint32_t i = 0; i < limit; ++i) {
+        ring_cpu_relax();
+        if (__atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) == pos) {
+            ring_lf_spin_update(&ring->writer.spin_limit, true);
+            return;
+        }
+    }
+
+    ring_lf_spin_update(&ring->writer.spin_limit, false);
+    while (1) {
+        // Announce the intention to sleep and check the slot again (the reader might be faster)
+        uint32_t val = __atomic_load_n(&ring->park_writer.futex, __ATOMIC_ACQUIRE);
+        __atomic_add_fetch(&ring->park_writer.waiting, 1U, __ATOMIC_RELAXED);
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+        bool ready = (__atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) == pos);
+        if (!ready) {
+            ring_futex_wait(&ring->park_writer.futex, val, NULL);
+            ready = (__atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) == pos);
+        }
+
+        __atomic_sub_fetch(&ring->park_writer.waiting, 1U, __ATOMIC_RELAXED);
+        if (ready) {
+            return;
+        }
+    }
+}
+
+/**
+ * \brief Wait until the reader can read a slot (i.e. the buffer is empty)
+ *
+ * First, try to spin for a while and, if the slot is still not filled by a writer, sleep.
+ * \param[in] ring    Ring buffer
+ * \param[in] slot    Slot to read
+ * \param[in] pos     Position of the reader
+ * \param[in] timeout Maximal time to wait (NULL to wait indefinitely)
+ * \return True if the slot is ready, false if the timeout has expired
+ */
+static bool
+ring_lf_wait_reader(struct ring_lf *ring, struct ring_lf_slot *slot, uint64_t pos,
+    const struct timespec *timeout)
+{
+    const uint32_t limit = ring->reader.spin_limit;
+    for (uint32_t i = 0; i < limit; ++i) {
+        ring_cpu_relax();
+        if (__atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) == pos + 1) {
+            ring_lf_spin_update(&ring->reader.spin_limit, true);
+            return true;
+        }
+    }
+
+    ring_lf_spin_update(&ring->reader.spin_limit, false);
+
+    // Writers might wait for slots released since the last check, wake them before sleeping
+    ring->reader.wake_cnt = 0;
+    ring_lf_wake_writers(ring);
+
+    while (1) {
+        // Announce the intention to sleep and check the slot again (a writer might be faster)
+        uint32_t val = __atomic_load_n(&ring->park_reader.futex, __ATOMIC_ACQUIRE);
+        __atomic_store_n(&ring->park_reader.waiting, 1U, __ATOMIC_RELAXED);
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+        bool ready = (__atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) == pos + 1);
+        if (!ready) {
+            ring_futex_wait(&ring->park_reader.futex, val, timeout);
+            ready = (__atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) == pos + 1);
+        }
+
+        __atomic_store_n(&ring->park_reader.waiting, 0U, __ATOMIC_RELAXED);
+        if (ready) {
+            return true;
+        }
+
+        if (timeout != NULL && ring_deadline_expired(timeout)) {
+            return false;
+        }
+    }
+}
+
+/**
+ * \brief Add a message into a lock-free ring buffer
+ * \param[in] ring Ring buffer
+ * \param[in] msg  Message to be added into the ring buffer
+ */
+static inline void
+ring_lf_push(struct ring_lf *ring, ipx_msg_t *msg)
+{
+    // Reserve a slot (only multiple writers have to use atomic increment)
+    uint64_t pos;
+    if (ring->mw_mode) {
+        pos = __atomic_fetch_add(&ring->writer.tail, 1U, __ATOMIC_RELAXED);
+    } else {
+        pos = ring->writer.tail;
+        __atomic_store_n(&ring->writer.tail, pos + 1, __ATOMIC_RELAXED);
+    }
+
+    struct ring_lf_slot *slot = &ring->slots[pos & ring->mask];
+    if (__atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) != pos) {
+        // The buffer is full
+        ring_lf_wait_writer(ring, slot, pos);
+    }
+
+    // Fill and publish the slot
+    slot->msg = msg;
+    __atomic_store_n(&slot->seq, pos + 1, __ATOMIC_RELEASE);
+    ring_lf_wake_reader(ring);
+}
+
+/**
+ * \brief Try to add a message into a lock-free ring buffer (non-blocking)
+ *
+ * Unlike ring_lf_push(), a slot is reserved only if it is already empty. Therefore, the
+ * position of the writer(s) is never moved ahead of the reader by this function.
+ * \param[in] ring Ring buffer
+ * \param[in] msg  Message to be added into the ring buffer
+ * \return True on success, false if the buffer is full
+ */
+static inline bool
+ring_lf_try_push(struct ring_lf *ring, ipx_msg_t *msg)
+{
+    uint64_t pos = __atomic_load_n(&ring->writer.tail, __ATOMIC_RELAXED);
+    struct ring_lf_slot *slot;
+
+    while (1) {
+        slot = &ring->slots[pos & ring->mask];
+        int64_t diff = (int64_t) (__atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) - pos);
+        if (diff < 0) {
+            // The slot hasn't been released by the reader yet, i.e. the buffer is full
+            return false;
+        }
+
+        if (diff == 0) {
+            // The slot is empty, try to reserve it
+            if (!ring->mw_mode) {
+                __atomic_store_n(&ring->writer.tail, pos + 1, __ATOMIC_RELAXED);
+                break;
+            }
+
+            if (__atomic_compare_exchange_n(&ring->writer.tail, &pos, pos + 1, true,
+                    __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                break;
+            }
+
+            // Another writer has been faster (the position has been updated)
+            continue;
+        }
+
+        // Another writer has already filled the slot
+        pos = __atomic_load_n(&ring->writer.tail, __ATOMIC_RELAXED);
+    }
+
+    // Fill and publish the slot
+    slot->msg = msg;
+    __atomic_store_n(&slot->seq, pos + 1, __ATOMIC_RELEASE);
+    ring_lf_wake_reader(ring);
+    return true;
+}
+
+/**
+ * \brief Get a message from a lock-free ring buffer
+ * \param[in] ring Ring buffer
+ * \return Pointer to the message
+ */
+static inline ipx_msg_t *
+ring_lf_pop(struct ring_lf *ring)
+{
+    const uint64_t pos = ring->reader.head;
+    struct ring_lf_slot *slot = &ring->slots[pos & ring->mask];
+    if (__atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) != pos + 1) {
+        // The buffer is empty
+        ring_lf_wait_reader(ring, slot, pos, NULL);
+    }
+
+    // Read and release the slot for the writer that will take the position in the next round
+    ipx_msg_t *msg = slot->msg;
+    __atomic_store_n(&slot->seq, pos + ring->mask + 1, __ATOMIC_RELEASE);
+    __atomic_store_n(&ring->reader.head, pos + 1, __ATOMIC_RELAXED);
+
+    if (++ring->reader.wake_cnt >= ring->div_block) {
+        ring->reader.wake_cnt = 0;
+        ring_lf_hwm_update(ring);
+        ring_lf_wake_writers(ring);
+    }
+
+    return msg;
+}
+
+/**
+ * \brief Add multiple messages into a lock-free ring buffer
+ *
+ * All slots are reserved at once, therefore, messages of other writers are never interleaved
+ * with messages of the batch and, in the multi-writer mode, only one atomic operation is
+ * performed.
+ * \param[in] ring Ring buffer
+ * \param[in] msgs Array of messages to be added into the ring buffer
+ * \param[in] cnt  Number of messages in the array
+ */
+static inline void
+ring_lf_push_batch(struct ring_lf *ring, ipx_msg_t **msgs, uint32_t cnt)
+{
+    uint64_t pos;
+    if (ring->mw_mode) {
+        pos = __atomic_fetch_add(&ring->writer.tail, cnt, __ATOMIC_RELAXED);
+    } else {
+        pos = ring->writer.tail;
+        __atomic_store_n(&ring->writer.tail, pos + cnt, __ATOMIC_RELAXED);
+    }
+
+    for (uint32_t i = 0; i < cnt; ++i, ++pos) {
+        struct ring_lf_slot *slot = &ring->slots[pos & ring->mask];
+        if (__atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) != pos) {
+            // The buffer is full, the reader must know about already published messages
+            ring_lf_wake_reader(ring);
+            ring_lf_wait_writer(ring, slot, pos);
+        }
+
+        slot->msg = msgs[i];
+        __atomic_store_n(&slot->seq, pos + 1, __ATOMIC_RELEASE);
+    }
+
+    ring_lf_wake_reader(ring);
+}
+
+/**
+ * \brief Get multiple messages from a lock-free ring buffer
+ *
+ * The function blocks until at least one message is ready (or the timeout expires). Other
+ * messages are taken only if they are immediately available.
+ * \param[in]  ring    Ring buffer
+ * \param[out] msgs    Array for messages
+ * \param[in]  max     Maximal number of messages to get (must be non-zero)
+ * \param[in]  timeout Maximal time to wait for the first message (NULL to wait indefinitely)
+ * \return Number of messages stored into the array (zero only if the timeout has expired)
+ */
+static inline uint32_t
+ring_lf_pop_batch(struct ring_lf *ring, ipx_msg_t **msgs, uint32_t max,
+    const struct timespec *timeout)
+{
+    uint64_t pos = ring->reader.head;
+    struct ring_lf_slot *slot = &ring->slots[pos & ring->mask];
+    if (__atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) != pos + 1) {
+        // The buffer is empty
+        if (!ring_lf_wait_reader(ring, slot, pos, timeout)) {
+            return 0;
+        }
+    }
+
+    uint32_t cnt = 0;
+    do {
+        msgs[cnt++] = slot->msg;
+        __atomic_store_n(&slot->seq, pos + ring->mask + 1, __ATOMIC_RELEASE);
+        slot = &ring->slots[(++pos) & ring->mask];
+    } while (cnt < max && __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) == pos + 1);
+
+    __atomic_store_n(&ring->reader.head, pos, __ATOMIC_RELAXED);
+    ring->reader.wake_cnt += cnt;
+    if (ring->reader.wake_cnt >= ring->div_block) {
+        ring->reader.wake_cnt = 0;
+        ring_lf_hwm_update(ring);
+        ring_lf_wake_writers(ring);
+    }
+
+    return cnt;
+}
+
+// -------------------------------------------------------------------------------------------------
+// Public interface
+
+/** \brief Ring buffer */
+struct ipx_ring {
+    /** Implementation type (read-only)                 */
+    enum ipx_ring_type type;
+    union {
+        /** Mutex based implementation                  */
+        struct ring_mtx mtx;
+        /** Lock-free implementation                    */
+        struct ring_lf  lf;
+    };
+};
+
+void
+ipx_ring_type_set(enum ipx_ring_type type)
+{
+    ring_type_default = type;
+}
+
+enum ipx_ring_type
+ipx_ring_type_get(void)
+{
+    return ring_type_default;
+}
+
+ipx_ring_t *
+ipx_ring_init(uint32_t size, bool mw_mode)
+{
+    ipx_ring_t *ring;
+
+    // Prepare data structures
+    ring = aligned_alloc(alignof(struct ipx_ring), sizeof(struct ipx_ring));
+    if (!ring) {
+        IPX_ERROR(module, "aligned_alloc() failed! (%s:%d)", __FILE__, __LINE__);
+        return NULL;
+    }
+
+    int rc;
+    ring->type = ring_type_default;
+    switch (ring->type) {
+    case IPX_RING_LOCKFREE:
+        rc = ring_lf_init(&ring->lf, size, mw_mode);
+        break;
+    case IPX_RING_MUTEX:
+    default:
+        ring->type = IPX_RING_MUTEX;
+        rc = ring_mtx_init(&ring->mtx, size, mw_mode);
+        break;
+    }
+
+    if (rc != IPX_OK) {
+        free(ring);
+        return NULL;
+    }
+
+    return ring;
+}
+
+void
+ipx_ring_destroy(ipx_ring_t *ring)
+{
+    if (ring->type == IPX_RING_LOCKFREE) {
+        ring_lf_destroy(&ring->lf);
+    } else {
+        ring_mtx_destroy(&ring->mtx);
+    }
+
+    free(ring);
+}
+
+void
+ipx_ring_push(ipx_ring_t *ring, ipx_msg_t *msg)
+{
+    if (ring->type == IPX_RING_LOCKFREE) {
+        ring_lf_push(&ring->lf, msg);
+    } else {
+        ring_mtx_push(&ring->mtx, msg);
+    }
+}
+
+bool
+ipx_ring_try_push(ipx_ring_t *ring, ipx_msg_t *msg)
+{
+    if (ring->type == IPX_RING_LOCKFREE) {
+        return ring_lf_try_push(&ring->lf, msg);
+    } else {
+        return ring_mtx_try_push(&ring->mtx, msg);
+    }
+}
+
+ipx_msg_t *
+ipx_ring_pop(ipx_ring_t *ring)
+{
+    if (ring->type == IPX_RING_LOCKFREE) {
+        return ring_lf_pop(&ring->lf);
+    } else {
+        return ring_mtx_pop(&ring->mtx, NULL);
     }
 }
 
+void
+ipx_ring_push_batch(ipx_ring_t *ring, ipx_msg_t **msgs, uint32_t cnt)
+{
+    if (cnt == 0) {
+        return;
+    }
+
+    if (ring->type == IPX_RING_LOCKFREE) {
+        ring_lf_push_batch(&ring->lf, msgs, cnt);
+    } else {
+        ring_mtx_push_batch(&ring->mtx, msgs, cnt);
+    }
+}
+
+uint32_t
+ipx_ring_pop_batch(ipx_ring_t *ring, ipx_msg_t **msgs, uint32_t max)
+{
+    assert(max > 0);
+    if (ring->type == IPX_RING_LOCKFREE) {
+        return ring_lf_pop_batch(&ring->lf, msgs, max, NULL);
+    } else {
+        return ring_mtx_pop_batch(&ring->mtx, msgs, max, NULL);
+    }
+}
+
+uint32_t
+ipx_ring_pop_batch_timed(ipx_ring_t *ring, ipx_msg_t **msgs, uint32_t max, uint32_t msec)
+{
+    assert(max > 0);
+    struct timespec timeout;
+    ring_deadline_set(&timeout, msec);
+
+    if (ring->type == IPX_RING_LOCKFREE) {
+        return ring_lf_pop_batch(&ring->lf, msgs, max, &timeout);
+    } else {
+        return ring_mtx_pop_batch(&ring->mtx, msgs, max, &timeout);
+    }
+}
+
+void
+ipx_ring_stats_get(ipx_ring_t *ring, struct ipx_ring_stats *stats)
+{
+    if (ring->type == IPX_RING_LOCKFREE) {
+        struct ring_lf *lf = &ring->lf;
+        stats->size = (uint32_t) (lf->mask + 1);
+        stats->used = ring_lf_used(lf);
+        stats->hwm = __atomic_load_n(&lf->reader.hwm, __ATOMIC_RELAXED);
+        return;
+    }
+
+    // The position of the reader is known only from the last synchronization with writers
+    struct ring_mtx *mtx = &ring->mtx;
+    pthread_mutex_lock(&mtx->sync.mutex);
+    const uint32_t reader_idx = mtx->sync.write_idx - mtx->reader.size;
+    pthread_mutex_unlock(&mtx->sync.mutex);
+
+    const uint32_t used = __atomic_load_n(&mtx->writer.write_idx, __ATOMIC_RELAXED) - reader_idx;
+    stats->size = mtx->reader.size;
+    stats->used = (used > stats->size) ? stats->size : used;
+    stats->hwm = __atomic_load_n(&mtx->reader.hwm, __ATOMIC_RELAXED);
+}
+
 void
 ipx_ring_mw_mode(ipx_ring_t *ring, bool mode)
 {
-    ring->mw_mode = mode;
-}
\ No newline at end of file
+    if (ring->type == IPX_RING_LOCKFREE) {
+        ring->lf.mw_mode = mode;
+    } else {
+        ring->mtx.mw_mode = mode;
+    }
+}
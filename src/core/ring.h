@@ -59,12 +59,49 @@ extern "C" {
  * from one or more produces to a single reader. The ring buffer is supposed to be used as a part
  * of IPFIXcol internal message pipeline.
  *
+ * Two implementations with the same interface are available:
+ * - #IPX_RING_MUTEX: the reader and writers exchange their positions in blocks under a mutex and
+ *   use condition variables to wait for data/space.
+ * - #IPX_RING_LOCKFREE: every slot of the buffer holds a sequence number that determines its
+ *   owner, so the reader and writers synchronize only through the slot itself. In the single
+ *   writer mode, a writer doesn't perform any atomic read-modify-write operation. In the
+ *   multi-writer mode, writers reserve slots by atomic increment of a shared index. If there is
+ *   nothing to do, threads spin for a short (adaptive) period of time and then go to sleep on
+ *   a futex.
+ *
+ * The implementation is selected by ipx_ring_type_set() before a ring buffer is created.
+ *
  * @{
  */
 
 /** Internal ring buffer type  */
 typedef struct ipx_ring ipx_ring_t;
 
+/** Implementation of a ring buffer */
+enum ipx_ring_type {
+    /** Position exchange protected by a mutex (default)                                       */
+    IPX_RING_MUTEX,
+    /** Lock-free implementation with adaptive spin-then-futex waiting                         */
+    IPX_RING_LOCKFREE
+};
+
+/**
+ * \brief Set the implementation of newly created ring buffers
+ *
+ * Already existing ring buffers are not affected.
+ * \warning The function is not thread-safe and it is supposed to be called during startup.
+ * \param[in] type Implementation type
+ */
+IPX_API void
+ipx_ring_type_set(enum ipx_ring_type type);
+
+/**
+ * \brief Get the implementation of newly created ring buffers
+ * \return Implementation type
+ */
+IPX_API enum ipx_ring_type
+ipx_ring_type_get(void);
+
 /**
  * \brief Create a new ring buffer
  *
@@ -72,6 +109,7 @@ typedef struct ipx_ring ipx_ring_t;
  *   time, result is undefined!
  * \note Enabling \p mw_mode has significant impact on performance in case the protection is not
  *   necessary.
+ * \note The lock-free implementation rounds \p size up to the nearest power of two.
  * \param[in] size    Size of the ring buffer (number of pointers)
  * \param[in] mw_mode Multi-writer mode (multiple writers can writer into the buffer)
  * \return A pointer to the buffer or NULL (in case of an error).
@@ -99,6 +137,22 @@ ipx_ring_destroy(ipx_ring_t *ring);
 IPX_API void
 ipx_ring_push(ipx_ring_t *ring, ipx_msg_t *msg);
 
+/**
+ * \brief Try to add a message into the ring buffer without blocking
+ *
+ * The same as ipx_ring_push(), however, if there is no free space in the buffer, the function
+ * immediately returns and the message is not added.
+ * \note The mutex based implementation exchanges information about free space with the reader
+ *   only in blocks. Therefore, the buffer can be reported as full even if the reader has
+ *   already processed a few messages.
+ * \param[in] ring Ring buffer
+ * \param[in] msg  Message to be added into the ring buffer
+ * \return True if the message has been added
+ * \return False if the buffer is full
+ */
+IPX_API bool
+ipx_ring_try_push(ipx_ring_t *ring, ipx_msg_t *msg);
+
 /**
  * \brief Get a message from the ring buffer
  *
@@ -110,6 +164,51 @@ ipx_ring_push(ipx_ring_t *ring, ipx_msg_t *msg);
 IPX_API ipx_msg_t *
 ipx_ring_pop(ipx_ring_t *ring);
 
+/**
+ * \brief Add multiple messages into the ring buffer
+ *
+ * The messages are added in the same order as they are stored in the array. The cost of
+ * synchronization with the reader (and other writers) is shared by all messages.
+ * \note The function blocks until all messages are added.
+ * \note Messages of the batch are never interleaved with messages of other writers. The
+ *   lock-free implementation reserves slots for the whole batch at once and the mutex based
+ *   implementation holds the writer lock until the whole batch is added.
+ * \param[in] ring Ring buffer
+ * \param[in] msgs Array of messages to be added into the ring buffer
+ * \param[in] cnt  Number of messages in the array
+ */
+IPX_API void
+ipx_ring_push_batch(ipx_ring_t *ring, ipx_msg_t **msgs, uint32_t cnt);
+
+/**
+ * \brief Get one or more messages from the ring buffer
+ *
+ * The function blocks until at least one message is ready. After that, it takes all other
+ * messages that are immediately available (up to \p max) without waiting for more.
+ * \warning Cannot be used concurrently by multiple threads at the same time.
+ * \param[in]  ring Ring buffer
+ * \param[out] msgs Array for messages (at least \p max elements)
+ * \param[in]  max  Maximal number of messages to get (must be non-zero)
+ * \return Number of messages stored into the array (always at least 1)
+ */
+IPX_API uint32_t
+ipx_ring_pop_batch(ipx_ring_t *ring, ipx_msg_t **msgs, uint32_t max);
+
+/**
+ * \brief Get one or more messages from the ring buffer or give up after a timeout
+ *
+ * The same as ipx_ring_pop_batch(), however, if no message is ready within the given time,
+ * the function returns and no message is stored.
+ * \warning Cannot be used concurrently by multiple threads at the same time.
+ * \param[in]  ring Ring buffer
+ * \param[out] msgs Array for messages (at least \p max elements)
+ * \param[in]  max  Maximal number of messages to get (must be non-zero)
+ * \param[in]  msec Maximal time to wait for the first message (in milliseconds)
+ * \return Number of messages stored into the array (zero if the timeout has expired)
+ */
+IPX_API uint32_t
+ipx_ring_pop_batch_timed(ipx_ring_t *ring, ipx_msg_t **msgs, uint32_t max, uint32_t msec);
+
 /**
  * \brief Change (i.e. disable/enable) multi-writer mode
  *
@@ -122,6 +221,28 @@ ipx_ring_pop(ipx_ring_t *ring);
 IPX_API void
 ipx_ring_mw_mode(ipx_ring_t *ring, bool mode);
 
+/** Statistics of a ring buffer                                                              */
+struct ipx_ring_stats {
+    /** Capacity of the ring buffer (number of messages)                                       */
+    uint32_t size;
+    /** Number of messages in the ring buffer (approximate value)                              */
+    uint32_t used;
+    /** The highest number of messages observed by the reader (high-water mark)                */
+    uint32_t hwm;
+};
+
+/**
+ * \brief Get statistics of the ring buffer
+ *
+ * The function can be called by any thread while the ring buffer is used by a reader and
+ * writers. The high-water mark is updated only by the reader whenever it synchronizes with
+ * writers, therefore, all values are only approximate.
+ * \param[in]  ring  Ring buffer
+ * \param[out] stats Statistics
+ */
+IPX_API void
+ipx_ring_stats_get(ipx_ring_t *ring, struct ipx_ring_stats *stats);
+
 /**
  * @}
  */
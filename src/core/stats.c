@@ -0,0 +1,758 @@
+/**
+ * \file src/core/stats.c
+ * \brief Statistics of the collector pipeline (source file)
+ * \date 2026
+ */
+
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include <assert.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "stats.h"
+#include "context.h"
+#include "plugin_output_mgr.h"
+#include "plugin_parser.h"
+#include "verbose.h"
+
+/** Internal identification of the module */
+static const char *module = "Statistics";
+/** Measurement of time spent inside plugin functions */
+static bool stats_timing = false;
+
+/** Default number of pre-allocated registered instances                                     */
+#define STATS_DEF_CNT (16U)
+/** Timeout of sending statistics to a client of the Unix domain socket (in seconds)         */
+#define STATS_SEND_TIMEOUT (1)
+
+/** Registered instance                                                                      */
+struct stats_rec {
+    /** Context of the instance                                                              */
+    ipx_ctx_t *ctx;
+    /** Input ring buffer of the instance (can be NULL)                                      */
+    ipx_ring_t *ring;
+    /** The instance is the IPFIX Message parser                                             */
+    bool parser;
+    /** List of the output manager that feeds the instance (NULL if not an output instance)   */
+    const ipx_output_mgr_list_t *out_list;
+    /** Index of the instance in the list of the output manager                              */
+    size_t out_idx;
+};
+
+/** Collector of statistics                                                                  */
+struct ipx_stats {
+    /** Array of registered instances                                                        */
+    struct stats_rec *recs;
+    /** Number of valid records                                                              */
+    size_t recs_valid;
+    /** Number of allocated records                                                          */
+    size_t recs_alloc;
+
+    struct {
+        /** Thread is running                                                                */
+        bool running;
+        /** Thread identification                                                            */
+        pthread_t thread;
+        /** Pipe for waking up the thread (read end, write end)                              */
+        int stop_fd[2];
+        /** Listening Unix domain socket (-1 if the statistics are written into a file)      */
+        int sd;
+        /** Path to the file or the socket (without the prefix)                              */
+        char *path;
+        /** Path to a temporary file (only for files)                                        */
+        char *path_tmp;
+        /** Output format                                                                    */
+        enum ipx_stats_fmt fmt;
+        /** Interval of rewriting the file (milliseconds)                                    */
+        unsigned int interval;
+    } endpoint; /**< Local endpoint                                                           */
+};
+
+/** Snapshot of statistics of an instance                                                    */
+struct stats_snapshot {
+    /** Ring buffer capacity                                                                 */
+    uint64_t ring_size;
+    /** Ring buffer occupancy                                                                */
+    uint64_t ring_used;
+    /** Ring buffer high-water mark                                                          */
+    uint64_t ring_hwm;
+    /** IPFIX Messages dropped by the output manager due to the overflow policy              */
+    uint64_t out_dropped_msgs;
+    /** Data Records dropped by the output manager due to the overflow policy                */
+    uint64_t out_dropped_recs;
+    /** Counters of the instance                                                             */
+    struct ipx_stats_ctx ctx;
+};
+
+/** Flags of metrics                                                                         */
+enum stats_metric_flags {
+    /** Only instances with an input ring buffer                                              */
+    SMF_RING = (1 << 0),
+    /** Only instances of the IPFIX Message parser                                            */
+    SMF_PARSER = (1 << 1),
+    /** The value is in nanoseconds, but it's exported in seconds                             */
+    SMF_SECONDS = (1 << 2),
+    /** Only output instances (fed by the output manager)                                     */
+    SMF_OUTPUT = (1 << 3)
+};
+
+/** Description of an exported metric                                                       */
+struct stats_metric {
+    /** Name of the metric (without the prefix)                                              */
+    const char *name;
+    /** Prometheus type                                                                      */
+    const char *type;
+    /** Description                                                                          */
+    const char *help;
+    /** Offset of the value in the snapshot                                                  */
+    size_t offset;
+    /** Flags (see #stats_metric_flags)                                                      */
+    int flags;
+};
+
+/** Prefix of all Prometheus metrics                                                         */
+#define STATS_PREFIX "ipfixcol2_"
+/** Offset of a counter of an instance in the snapshot                                       */
+#define STATS_OFF(field) \
+    (offsetof(struct stats_snapshot, ctx) + offsetof(struct ipx_stats_ctx, field))
+
+/** List of exported metrics                                                                 */
+static const struct stats_metric stats_metrics[] = {
+    {"ring_size", "gauge", "Capacity of the input ring buffer",
+        offsetof(struct stats_snapshot, ring_size), SMF_RING},
+    {"ring_used", "gauge", "Number of messages in the input ring buffer",
+        offsetof(struct stats_snapshot, ring_used), SMF_RING},
+    {"ring_hwm", "gauge", "High-water mark of the input ring buffer",
+        offsetof(struct stats_snapshot, ring_hwm), SMF_RING},
+    {"messages_in_total", "counter", "Messages received by the instance",
+        STATS_OFF(in.msgs), 0},
+    {"records_in_total", "counter", "IPFIX Data Records received by the instance",
+        STATS_OFF(in.recs), 0},
+    {"bytes_in_total", "counter", "Bytes of IPFIX Messages received by the instance",
+        STATS_OFF(in.bytes), 0},
+    {"messages_out_total", "counter", "Messages passed by the instance",
+        STATS_OFF(out.msgs), 0},
+    {"records_out_total", "counter", "IPFIX Data Records passed by the instance",
+        STATS_OFF(out.recs), 0},
+    {"bytes_out_total", "counter", "Bytes of IPFIX Messages passed by the instance",
+        STATS_OFF(out.bytes), 0},
+    {"calls_total", "counter", "Calls of the getter/processing function of the instance",
+        STATS_OFF(calls), 0},
+    {"busy_seconds_total", "counter", "Time spent inside the getter/processing function",
+        STATS_OFF(time_ns), SMF_SECONDS},
+    {"parser_sets_no_template_total", "counter", "Data Sets skipped due to a missing Template",
+        STATS_OFF(parser.sets_no_tmplt), SMF_PARSER},
+    {"parser_seq_gaps_total", "counter", "Unexpected sequence numbers of IPFIX Messages",
+        STATS_OFF(parser.seq_gaps), SMF_PARSER},
+    {"parser_seq_lost_records_total", "counter", "Data Records lost due to sequence gaps",
+        STATS_OFF(parser.seq_lost), SMF_PARSER},
+    {"parser_messages_dropped_total", "counter", "IPFIX Messages dropped by the parser",
+        STATS_OFF(parser.msg_dropped), SMF_PARSER},
+    {"output_messages_dropped_total", "counter", "IPFIX Messages dropped due to the overflow "
+        "policy of the output instance", offsetof(struct stats_snapshot, out_dropped_msgs),
+        SMF_OUTPUT},
+    {"output_records_dropped_total", "counter", "Data Records dropped due to the overflow "
+        "policy of the output instance", offsetof(struct stats_snapshot, out_dropped_recs),
+        SMF_OUTPUT},
+};
+
+void
+ipx_stats_timing_set(bool en)
+{
+    stats_timing = en;
+}
+
+bool
+ipx_stats_timing_get()
+{
+    return stats_timing;
+}
+
+ipx_stats_t *
+ipx_stats_create()
+{
+    struct ipx_stats *stats = calloc(1, sizeof(*stats));
+    if (!stats) {
+        return NULL;
+    }
+
+    stats->recs = malloc(STATS_DEF_CNT * sizeof(*stats->recs));
+    if (!stats->recs) {
+        free(stats);
+        return NULL;
+    }
+
+    stats->recs_alloc = STATS_DEF_CNT;
+    stats->endpoint.running = false;
+    stats->endpoint.sd = -1;
+    return stats;
+}
+
+/**
+ * \brief Stop the endpoint thread and release its resources
+ * \param[in] stats Collector of statistics
+ */
+static void
+stats_endpoint_stop(struct ipx_stats *stats)
+{
+    if (!stats->endpoint.running) {
+        return;
+    }
+
+    // Wake up the thread
+    const char cmd = 'T';
+    if (write(stats->endpoint.stop_fd[1], &cmd, 1) != 1) {
+        IPX_WARNING(module, "Failed to send a termination request to the endpoint thread!", '\0');
+    }
+
+    pthread_join(stats->endpoint.thread, NULL);
+    stats->endpoint.running = false;
+
+    close(stats->endpoint.stop_fd[0]);
+    close(stats->endpoint.stop_fd[1]);
+    if (stats->endpoint.sd >= 0) {
+        close(stats->endpoint.sd);
+        unlink(stats->endpoint.path);
+        stats->endpoint.sd = -1;
+    }
+
+    free(stats->endpoint.path);
+    free(stats->endpoint.path_tmp);
+    stats->endpoint.path = NULL;
+    stats->endpoint.path_tmp = NULL;
+}
+
+void
+ipx_stats_destroy(ipx_stats_t *stats)
+{
+    stats_endpoint_stop(stats);
+    free(stats->recs);
+    free(stats);
+}
+
+/**
+ * \brief Add a new record of a registered instance
+ * \param[in] stats Collector of statistics
+ * \param[in] ctx   Context of the instance
+ * \param[in] ring  Input ring buffer of the instance (can be NULL)
+ * \return Pointer to the record or NULL (memory allocation error)
+ */
+static struct stats_rec *
+stats_rec_add(struct ipx_stats *stats, ipx_ctx_t *ctx, ipx_ring_t *ring)
+{
+    assert(!stats->endpoint.running && "Instances cannot be registered to a running endpoint");
+    if (stats->recs_valid == stats->recs_alloc) {
+        const size_t alloc_new = 2 * stats->recs_alloc;
+        struct stats_rec *recs_new = realloc(stats->recs, alloc_new * sizeof(*recs_new));
+        if (!recs_new) {
+            return NULL;
+        }
+
+        stats->recs = recs_new;
+        stats->recs_alloc = alloc_new;
+    }
+
+    struct stats_rec *rec = &stats->recs[stats->recs_valid++];
+    rec->ctx = ctx;
+    rec->ring = ring;
+    rec->parser = (ipx_ctx_plugininfo_get(ctx) == &ipx_plugin_parser_info);
+    rec->out_list = NULL;
+    rec->out_idx = 0;
+    return rec;
+}
+
+int
+ipx_stats_register(ipx_stats_t *stats, ipx_ctx_t *ctx, ipx_ring_t *ring)
+{
+    return (stats_rec_add(stats, ctx, ring) != NULL) ? IPX_OK : IPX_ERR_NOMEM;
+}
+
+int
+ipx_stats_register_output(ipx_stats_t *stats, ipx_ctx_t *ctx, ipx_ring_t *ring,
+    const ipx_output_mgr_list_t *list, size_t idx)
+{
+    struct stats_rec *rec = stats_rec_add(stats, ctx, ring);
+    if (!rec) {
+        return IPX_ERR_NOMEM;
+    }
+
+    rec->out_list = list;
+    rec->out_idx = idx;
+    return IPX_OK;
+}
+
+/**
+ * \brief Take a snapshot of statistics of an instance
+ * \param[in]  rec  Registered instance
+ * \param[out] snap Snapshot
+ */
+static void
+stats_snapshot_get(const struct stats_rec *rec, struct stats_snapshot *snap)
+{
+    memset(snap, 0, sizeof(*snap));
+    if (rec->ring != NULL) {
+        struct ipx_ring_stats ring_stats;
+        ipx_ring_stats_get(rec->ring, &ring_stats);
+        snap->ring_size = ring_stats.size;
+        snap->ring_used = ring_stats.used;
+        snap->ring_hwm = ring_stats.hwm;
+    }
+
+    if (rec->out_list != NULL) {
+        ipx_output_mgr_list_dropped(rec->out_list, rec->out_idx, &snap->out_dropped_msgs,
+            &snap->out_dropped_recs);
+    }
+
+    // The structure consists only of counters modified by another thread
+    const uint64_t *src = (const uint64_t *) ipx_ctx_stats_get(rec->ctx);
+    uint64_t *dst = (uint64_t *) &snap->ctx;
+    for (size_t i = 0; i < sizeof(snap->ctx) / sizeof(uint64_t); ++i) {
+        dst[i] = __atomic_load_n(&src[i], __ATOMIC_RELAXED);
+    }
+}
+
+/**
+ * \brief Get a value of a metric from a snapshot
+ * \param[in] snap   Snapshot
+ * \param[in] metric Metric
+ * \return Value
+ */
+static inline uint64_t
+stats_metric_value(const struct stats_snapshot *snap, const struct stats_metric *metric)
+{
+    return *(const uint64_t *) (((const uint8_t *) snap) + metric->offset);
+}
+
+/**
+ * \brief Check if a metric is available for an instance
+ * \param[in] rec    Registered instance
+ * \param[in] metric Metric
+ * \return True or false
+ */
+static inline bool
+stats_metric_valid(const struct stats_rec *rec, const struct stats_metric *metric)
+{
+    if ((metric->flags & SMF_RING) != 0 && rec->ring == NULL) {
+        return false;
+    }
+
+    if ((metric->flags & SMF_PARSER) != 0 && !rec->parser) {
+        return false;
+    }
+
+    if ((metric->flags & SMF_OUTPUT) != 0 && rec->out_list == NULL) {
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * \brief Write a metric value
+ * \param[in] out    Output stream
+ * \param[in] metric Metric
+ * \param[in] value  Value
+ */
+static void
+stats_value_print(FILE *out, const struct stats_metric *metric, uint64_t value)
+{
+    if ((metric->flags & SMF_SECONDS) != 0) {
+        fprintf(out, "%" PRIu64 ".%09" PRIu64, value / 1000000000U, value % 1000000000U);
+    } else {
+        fprintf(out, "%" PRIu64, value);
+    }
+}
+
+/**
+ * \brief Write an escaped string (Prometheus label value or JSON string)
+ * \param[in] out Output stream
+ * \param[in] str String to escape
+ */
+static void
+stats_escape_print(FILE *out, const char *str)
+{
+    for (const char *pos = str; *pos != '\0'; ++pos) {
+        const unsigned char c = (unsigned char) *pos;
+        switch (c) {
+        case '\\':
+            fputs("\\\\", out);
+            break;
+        case '"':
+            fputs("\\\"", out);
+            break;
+        case '\n':
+            fputs("\\n", out);
+            break;
+        default:
+            if (c < 0x20) {
+                // Other control characters are not expected, skip them
+                continue;
+            }
+            fputc(c, out);
+            break;
+        }
+    }
+}
+
+/**
+ * \brief Write statistics in the Prometheus text-based exposition format
+ * \param[in] stats Collector of statistics
+ * \param[in] snaps Snapshots of all registered instances
+ * \param[in] out   Output stream
+ */
+static void
+stats_dump_prometheus(const struct ipx_stats *stats, const struct stats_snapshot *snaps,
+    FILE *out)
+{
+    const size_t metrics_cnt = sizeof(stats_metrics) / sizeof(stats_metrics[0]);
+    for (size_t m_idx = 0; m_idx < metrics_cnt; ++m_idx) {
+        const struct stats_metric *metric = &stats_metrics[m_idx];
+        fprintf(out, "# HELP " STATS_PREFIX "%s %s\n", metric->name, metric->help);
+        fprintf(out, "# TYPE " STATS_PREFIX "%s %s\n", metric->name, metric->type);
+
+        for (size_t r_idx = 0; r_idx < stats->recs_valid; ++r_idx) {
+            const struct stats_rec *rec = &stats->recs[r_idx];
+            if (!stats_metric_valid(rec, metric)) {
+                continue;
+            }
+
+            fprintf(out, STATS_PREFIX "%s{instance=\"", metric->name);
+            stats_escape_print(out, ipx_ctx_name_get(rec->ctx));
+            fputs("\",plugin=\"", out);
+            stats_escape_print(out, ipx_ctx_plugininfo_get(rec->ctx)->name);
+            fputs("\"} ", out);
+            stats_value_print(out, metric, stats_metric_value(&snaps[r_idx], metric));
+            fputc('\n', out);
+        }
+    }
+}
+
+/**
+ * \brief Write statistics as a JSON document
+ * \param[in] stats Collector of statistics
+ * \param[in] snaps Snapshots of all registered instances
+ * \param[in] out   Output stream
+ */
+static void
+stats_dump_json(const struct ipx_stats *stats, const struct stats_snapshot *snaps, FILE *out)
+{
+    const size_t metrics_cnt = sizeof(stats_metrics) / sizeof(stats_metrics[0]);
+    fputs("{\"instances\":[", out);
+
+    for (size_t r_idx = 0; r_idx < stats->recs_valid; ++r_idx) {
+        const struct stats_rec *rec = &stats->recs[r_idx];
+        fputs((r_idx == 0) ? "{\"instance\":\"" : ",{\"instance\":\"", out);
+        stats_escape_print(out, ipx_ctx_name_get(rec->ctx));
+        fputs("\",\"plugin\":\"", out);
+        stats_escape_print(out, ipx_ctx_plugininfo_get(rec->ctx)->name);
+        fputc('"', out);
+
+        for (size_t m_idx = 0; m_idx < metrics_cnt; ++m_idx) {
+            const struct stats_metric *metric = &stats_metrics[m_idx];
+            if (!stats_metric_valid(rec, metric)) {
+                continue;
+            }
+
+            fprintf(out, ",\"%s\":", metric->name);
+            stats_value_print(out, metric, stats_metric_value(&snaps[r_idx], metric));
+        }
+        fputc('}', out);
+    }
+
+    fputs("]}\n", out);
+}
+
+int
+ipx_stats_dump(ipx_stats_t *stats, enum ipx_stats_fmt fmt, FILE *out)
+{
+    struct stats_snapshot *snaps = NULL;
+    if (stats->recs_valid > 0) {
+        snaps = malloc(stats->recs_valid * sizeof(*snaps));
+        if (!snaps) {
+            IPX_ERROR(module, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+            return IPX_ERR_DENIED;
+        }
+    }
+
+    for (size_t idx = 0; idx < stats->recs_valid; ++idx) {
+        stats_snapshot_get(&stats->recs[idx], &snaps[idx]);
+    }
+
+    switch (fmt) {
+    case IPX_STATS_FMT_JSON:
+        stats_dump_json(stats, snaps, out);
+        break;
+    case IPX_STATS_FMT_PROMETHEUS:
+    default:
+        stats_dump_prometheus(stats, snaps, out);
+        break;
+    }
+
+    free(snaps);
+    return (ferror(out) == 0) ? IPX_OK : IPX_ERR_DENIED;
+}
+
+/**
+ * \brief Rewrite the file with statistics
+ *
+ * The statistics are written into a temporary file that atomically replaces the original one.
+ * \param[in] stats Collector of statistics
+ */
+static void
+stats_file_write(struct ipx_stats *stats)
+{
+    FILE *file = fopen(stats->endpoint.path_tmp, "w");
+    if (!file) {
+        const char *err_str;
+        ipx_strerror(errno, err_str);
+        IPX_WARNING(module, "Failed to open file '%s': %s", stats->endpoint.path_tmp, err_str);
+        return;
+    }
+
+    int rc = ipx_stats_dump(stats, stats->endpoint.fmt, file);
+    if (fclose(file) != 0 || rc != IPX_OK) {
+        IPX_WARNING(module, "Failed to write statistics into '%s'.", stats->endpoint.path_tmp);
+        unlink(stats->endpoint.path_tmp);
+        return;
+    }
+
+    if (rename(stats->endpoint.path_tmp, stats->endpoint.path) != 0) {
+        const char *err_str;
+        ipx_strerror(errno, err_str);
+        IPX_WARNING(module, "Failed to replace file '%s': %s", stats->endpoint.path, err_str);
+        unlink(stats->endpoint.path_tmp);
+    }
+}
+
+/**
+ * \brief Accept a new client of the Unix domain socket and send statistics to it
+ * \param[in] stats Collector of statistics
+ */
+static void
+stats_socket_serve(struct ipx_stats *stats)
+{
+    int fd = accept(stats->endpoint.sd, NULL, NULL);
+    if (fd < 0) {
+        const char *err_str;
+        ipx_strerror(errno, err_str);
+        IPX_WARNING(module, "Failed to accept a new client: %s", err_str);
+        return;
+    }
+
+    // Do not let a slow client block the thread forever
+    struct timeval timeout = {.tv_sec = STATS_SEND_TIMEOUT, .tv_usec = 0};
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+    FILE *stream = fdopen(fd, "w");
+    if (!stream) {
+        close(fd);
+        return;
+    }
+
+    if (ipx_stats_dump(stats, stats->endpoint.fmt, stream) != IPX_OK) {
+        IPX_DEBUG(module, "Failed to send statistics to a client.", '\0');
+    }
+    fclose(stream); // Closes the socket too
+}
+
+/**
+ * \brief Thread of the local endpoint
+ * \param[in] arg Collector of statistics
+ * \return NULL
+ */
+static void *
+stats_thread(void *arg)
+{
+    struct ipx_stats *stats = arg;
+    const bool is_socket = (stats->endpoint.sd >= 0);
+    const int timeout = is_socket ? -1 : (int) stats->endpoint.interval;
+
+    struct pollfd fds[2];
+    fds[0].fd = stats->endpoint.stop_fd[0];
+    fds[0].events = POLLIN;
+    fds[1].fd = stats->endpoint.sd;
+    fds[1].events = POLLIN;
+    const nfds_t fds_cnt = is_socket ? 2 : 1;
+
+    while (true) {
+        if (!is_socket) {
+            stats_file_write(stats);
+        }
+
+        int rc = poll(fds, fds_cnt, timeout);
+        if (rc < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            const char *err_str;
+            ipx_strerror(errno, err_str);
+            IPX_ERROR(module, "poll() failed: %s", err_str);
+            break;
+        }
+
+        if ((fds[0].revents & POLLIN) != 0) {
+            // Termination request
+            break;
+        }
+
+        if (is_socket && (fds[1].revents & POLLIN) != 0) {
+            stats_socket_serve(stats);
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * \brief Create a listening Unix domain socket
+ * \param[in] path Path to the socket
+ * \return Socket descriptor or -1 on failure
+ */
+static int
+stats_socket_create(const char *path)
+{
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        IPX_ERROR(module, "Path to the Unix domain socket '%s' is too long!", path);
+        return -1;
+    }
+    strcpy(addr.sun_path, path);
+
+    int sd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (sd < 0) {
+        const char *err_str;
+        ipx_strerror(errno, err_str);
+        IPX_ERROR(module, "Failed to create a Unix domain socket: %s", err_str);
+        return -1;
+    }
+
+    // Remove a socket left by a previous run
+    unlink(path);
+    if (bind(sd, (const struct sockaddr *) &addr, sizeof(addr)) != 0 || listen(sd, 8) != 0) {
+        const char *err_str;
+        ipx_strerror(errno, err_str);
+        IPX_ERROR(module, "Failed to bind the Unix domain socket '%s': %s", path, err_str);
+        close(sd);
+        return -1;
+    }
+
+    return sd;
+}
+
+int
+ipx_stats_start(ipx_stats_t *stats, const char *path, enum ipx_stats_fmt fmt,
+    unsigned int interval)
+{
+    if (stats->endpoint.running) {
+        IPX_ERROR(module, "The endpoint is already running!", '\0');
+        return IPX_ERR_DENIED;
+    }
+
+    const size_t prefix_len = strlen(IPX_STATS_UNIX_PREFIX);
+    const bool is_socket = (strncmp(path, IPX_STATS_UNIX_PREFIX, prefix_len) == 0);
+    if (is_socket) {
+        path += prefix_len;
+    }
+
+    stats->endpoint.fmt = fmt;
+    stats->endpoint.interval = (interval > 0) ? interval : IPX_STATS_INTERVAL_DEF;
+    stats->endpoint.path = strdup(path);
+    stats->endpoint.path_tmp = malloc(strlen(path) + 5); // ".tmp" + '\0'
+    if (!stats->endpoint.path || !stats->endpoint.path_tmp) {
+        IPX_ERROR(module, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+        goto exit_path;
+    }
+    sprintf(stats->endpoint.path_tmp, "%s.tmp", path);
+
+    if (is_socket && (stats->endpoint.sd = stats_socket_create(path)) < 0) {
+        goto exit_path;
+    }
+
+    if (pipe(stats->endpoint.stop_fd) != 0) {
+        const char *err_str;
+        ipx_strerror(errno, err_str);
+        IPX_ERROR(module, "Failed to create a pipe: %s", err_str);
+        goto exit_socket;
+    }
+
+    // Block processing all signals in the new thread
+    sigset_t set_new, set_old;
+    sigfillset(&set_new);
+    pthread_sigmask(SIG_SETMASK, &set_new, &set_old);
+    int rc = pthread_create(&stats->endpoint.thread, NULL, &stats_thread, stats);
+    pthread_sigmask(SIG_SETMASK, &set_old, NULL);
+
+    if (rc != 0) {
+        const char *err_str;
+        ipx_strerror(rc, err_str);
+        IPX_ERROR(module, "Failed to start a thread. pthread_create() failed: %s", err_str);
+        goto exit_pipe;
+    }
+
+    stats->endpoint.running = true;
+    IPX_INFO(module, "Statistics are available at %s'%s'.",
+        is_socket ? "the Unix domain socket " : "", path);
+    return IPX_OK;
+
+exit_pipe:
+    close(stats->endpoint.stop_fd[0]);
+    close(stats->endpoint.stop_fd[1]);
+exit_socket:
+    if (stats->endpoint.sd >= 0) {
+        close(stats->endpoint.sd);
+        unlink(path);
+        stats->endpoint.sd = -1;
+    }
+exit_path:
+    free(stats->endpoint.path);
+    free(stats->endpoint.path_tmp);
+    stats->endpoint.path = NULL;
+    stats->endpoint.path_tmp = NULL;
+    return IPX_ERR_DENIED;
+}
@@ -0,0 +1,226 @@
+/**
+ * \file src/core/stats.h
+ * \brief Statistics of the collector pipeline (header file)
+ * \date 2026
+ */
+
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#ifndef IPFIXCOL_STATS_H
+#define IPFIXCOL_STATS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <ipfixcol2.h>
+#include "ring.h"
+#include "plugin_output_mgr.h"
+
+/**
+ * \defgroup ipxStats Pipeline statistics
+ * \brief Counters of plugin instances and ring buffers exported via a local endpoint
+ *
+ * Each instance context holds its own counters that are updated only by the thread of the
+ * instance. Therefore, no atomic read-modify-write operations are required on the processing
+ * path and the counters are simply aggregated on read.
+ * @{
+ */
+
+/** Counters of messages passing through an instance                                         */
+struct ipx_stats_flow {
+    /** Number of messages (all types)                                                        */
+    uint64_t msgs;
+    /** Number of IPFIX Data Records (only parsed IPFIX Messages)                             */
+    uint64_t recs;
+    /** Number of bytes of raw IPFIX Messages                                                 */
+    uint64_t bytes;
+};
+
+/** Counters of an IPFIX Message parser                                                      */
+struct ipx_stats_parser {
+    /** Number of Data Sets skipped due to a missing (Options) Template                       */
+    uint64_t sets_no_tmplt;
+    /** Number of unexpected sequence numbers (i.e. gaps or out of order messages)            */
+    uint64_t seq_gaps;
+    /** Number of Data Records missing due to sequence number gaps (estimation)              */
+    uint64_t seq_lost;
+    /** Number of IPFIX Messages dropped due to a malformed content, blocked session, etc.    */
+    uint64_t msg_dropped;
+};
+
+/**
+ * \brief Statistics of a plugin instance
+ * \warning Only the thread of the instance can modify the counters and only by the
+ *   ipx_stats_cnt_add() function.
+ */
+struct ipx_stats_ctx {
+    /** Messages received from the input ring buffer                                          */
+    struct ipx_stats_flow in;
+    /** Messages passed to the output ring buffer                                             */
+    struct ipx_stats_flow out;
+    /** Number of calls of the plugin's getter/processing function                            */
+    uint64_t calls;
+    /** Time spent inside the plugin's getter/processing function (in nanoseconds)           */
+    uint64_t time_ns;
+    /** Parser counters (only instances of the IPFIX Message parser)                          */
+    struct ipx_stats_parser parser;
+};
+
+/**
+ * \brief Increment a counter (single writer only)
+ *
+ * The counter can be safely read by other threads using an atomic load. Because there is
+ * only one writer, the operation doesn't require any atomic read-modify-write instruction.
+ * \param[in] cnt   Counter
+ * \param[in] value Value to add
+ */
+static inline void
+ipx_stats_cnt_add(uint64_t *cnt, uint64_t value)
+{
+    __atomic_store_n(cnt, __atomic_load_n(cnt, __ATOMIC_RELAXED) + value, __ATOMIC_RELAXED);
+}
+
+/**
+ * \brief Enable/disable measurement of time spent inside plugin functions (disabled by default)
+ *
+ * \note The change affects only instances started after the call.
+ * \param[in] en Enable/disable
+ */
+IPX_API void
+ipx_stats_timing_set(bool en);
+
+/**
+ * \brief Is measurement of time spent inside plugin functions enabled?
+ * \return True or false
+ */
+IPX_API bool
+ipx_stats_timing_get();
+
+/** Output format of statistics                                                              */
+enum ipx_stats_fmt {
+    /** Prometheus text-based exposition format                                               */
+    IPX_STATS_FMT_PROMETHEUS,
+    /** JSON document                                                                         */
+    IPX_STATS_FMT_JSON
+};
+
+/** Prefix of a path that represents a Unix domain socket                                    */
+#define IPX_STATS_UNIX_PREFIX "unix:"
+/** Default interval of rewriting of a file with statistics (in milliseconds)                */
+#define IPX_STATS_INTERVAL_DEF (1000U)
+
+/** Collector of pipeline statistics                                                         */
+typedef struct ipx_stats ipx_stats_t;
+
+/**
+ * \brief Create a collector of statistics
+ * \return Pointer to the collector or NULL (memory allocation error)
+ */
+IPX_API ipx_stats_t *
+ipx_stats_create();
+
+/**
+ * \brief Destroy a collector of statistics
+ *
+ * If the endpoint is running, it is stopped first.
+ * \param[in] stats Collector of statistics
+ */
+IPX_API void
+ipx_stats_destroy(ipx_stats_t *stats);
+
+/**
+ * \brief Register an instance and its input ring buffer
+ *
+ * \warning Instances can be registered only before the endpoint is started. The instance and
+ *   the ring buffer MUST exist until the collector is destroyed.
+ * \param[in] stats Collector of statistics
+ * \param[in] ctx   Context of the instance
+ * \param[in] ring  Input ring buffer of the instance (can be NULL)
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_NOMEM on a memory allocation error
+ */
+IPX_API int
+ipx_stats_register(ipx_stats_t *stats, ipx_ctx_t *ctx, ipx_ring_t *ring);
+
+/**
+ * \brief Register an output instance, its input ring buffer and its drop counters
+ *
+ * Same as ipx_stats_register(), however, numbers of IPFIX Messages and Data Records dropped
+ * by the output manager due to the overflow policy of the instance are exported too.
+ * \warning The list of the output manager MUST exist until the collector is destroyed.
+ * \param[in] stats Collector of statistics
+ * \param[in] ctx   Context of the output instance
+ * \param[in] ring  Input ring buffer of the instance (can be NULL)
+ * \param[in] list  List of destinations of the output manager
+ * \param[in] idx   Index of the instance in the list (see ipx_output_mgr_list_dropped())
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_NOMEM on a memory allocation error
+ */
+IPX_API int
+ipx_stats_register_output(ipx_stats_t *stats, ipx_ctx_t *ctx, ipx_ring_t *ring,
+    const ipx_output_mgr_list_t *list, size_t idx);
+
+/**
+ * \brief Write current statistics of all registered instances
+ * \param[in] stats Collector of statistics
+ * \param[in] fmt   Output format
+ * \param[in] out   Output stream
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_DENIED if the function failed to write the statistics
+ */
+IPX_API int
+ipx_stats_dump(ipx_stats_t *stats, enum ipx_stats_fmt fmt, FILE *out);
+
+/**
+ * \brief Start a local endpoint providing statistics
+ *
+ * If the \p path starts with #IPX_STATS_UNIX_PREFIX, a Unix domain socket is created and each
+ * client that connects to the socket receives the current statistics. Otherwise, the file is
+ * periodically rewritten (atomically, i.e. a reader always sees complete statistics).
+ * \param[in] stats    Collector of statistics
+ * \param[in] path     Path to a file or a Unix domain socket (with the prefix)
+ * \param[in] fmt      Output format
+ * \param[in] interval Interval of rewriting of the file (in milliseconds, ignored for sockets)
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_DENIED if the endpoint is already running or failed to start
+ */
+IPX_API int
+ipx_stats_start(ipx_stats_t *stats, const char *path, enum ipx_stats_fmt fmt,
+    unsigned int interval);
+
+/**@}*/
+
+#endif // IPFIXCOL_STATS_H
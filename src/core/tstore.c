@@ -0,0 +1,870 @@
+/**
+ * \file src/core/tstore.c
+ * \brief Persistent store of (Options) Templates of UDP sessions
+ * \date 2026
+ */
+
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include <assert.h>
+#include <errno.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+
+#include "tstore.h"
+#include "verbose.h"
+
+/*
+ * File format (all values are in network byte order):
+ *
+ * File header (24 bytes)
+ *   - magic "IPXT" (4B), version (2B), reserved (2B), time of saving (8B, UNIX timestamp),
+ *     number of records (4B), reserved (4B)
+ * Record header (60 bytes) of each combination of a Transport Session and an ODID
+ *   - IP version (1B, 4 or 6), reserved (1B), source port (2B), destination port (2B),
+ *     Template lifetime (2B), Options Template lifetime (2B), number of templates (2B),
+ *     ODID (4B), time of the last update (8B, UNIX timestamp), source address (16B),
+ *     destination address (16B), total size of all templates of the record (4B)
+ * Template (8 bytes + definition) of each (Options) Template of the record
+ *   - Set ID (1B, 2 = Template, 3 = Options Template), reserved (1B), length of the definition
+ *     (2B), Export Time of the last refresh (4B), definition (i.e. raw Template Record)
+ *
+ * In memory, templates of each record are kept in the same format as in the file.
+ */
+
+/** Magic identification of the file                                                         */
+#define TSTORE_MAGIC "IPXT"
+/** Version of the file format                                                               */
+#define TSTORE_VERSION 1U
+/** Size of the file header                                                                  */
+#define TSTORE_FILE_HDR_LEN 24U
+/** Size of the record header                                                                */
+#define TSTORE_REC_HDR_LEN 60U
+/** Size of the template header                                                              */
+#define TSTORE_TMPLT_HDR_LEN 8U
+/** Minimal size of a definition (i.e. Template Record header)                               */
+#define TSTORE_TMPLT_MIN_LEN 4U
+/** Default number of slots of the hash table (power of two)                                 */
+#define TSTORE_DEF_SLOTS 16U
+/** Set ID of Template Sets                                                                  */
+#define TSTORE_SET_TMPLT 2U
+/** Set ID of Options Template Sets                                                          */
+#define TSTORE_SET_OPTS 3U
+
+/** Identification of a combination of a Transport Session and an ODID                       */
+struct tstore_key {
+    /** Source IP address (IPv4 uses only the first 4 bytes, the rest is zeroed)             */
+    uint8_t addr_src[16];
+    /** Destination IP address (IPv4 uses only the first 4 bytes, the rest is zeroed)        */
+    uint8_t addr_dst[16];
+    /** Observation Domain ID                                                                */
+    uint32_t odid;
+    /** Source port                                                                          */
+    uint16_t port_src;
+    /** Destination port                                                                     */
+    uint16_t port_dst;
+    /** IP version (4 or 6)                                                                  */
+    uint8_t ip_ver;
+    /** Reserved (always zeroed, the key can be compared using memcmp())                     */
+    uint8_t reserved[7];
+};
+
+_Static_assert(sizeof(struct tstore_key) % sizeof(uint64_t) == 0, "Unexpected key padding");
+
+/** Stored templates of a combination of a Transport Session and an ODID                     */
+struct tstore_rec {
+    /** Identification                                                                       */
+    struct tstore_key key;
+    /** Time of the last update (UNIX timestamp)                                             */
+    uint64_t updated;
+    /** Template lifetime of the session (in seconds)                                        */
+    uint16_t lifetime_tmplts;
+    /** Options Template lifetime of the session (in seconds)                                */
+    uint16_t lifetime_opts;
+    /** Number of templates                                                                  */
+    uint16_t tmplt_cnt;
+    /** Size of serialized templates                                                         */
+    uint32_t size;
+    /** Serialized templates (can be NULL if there are no templates)                         */
+    uint8_t *data;
+};
+
+/** Template store                                                                           */
+struct ipx_tstore {
+    /** Identification of the owner (for log messages)                                       */
+    char *ident;
+    /** Path to the file                                                                     */
+    char *path;
+    /** Interval of periodic saving (in seconds)                                             */
+    uint32_t interval;
+    /** Monotonic time of the next periodic saving (claimed atomically by the saving caller)  */
+    uint64_t save_next;
+
+    /** Mutex protecting the table of records                                                */
+    pthread_mutex_t lock;
+    /** Table of records (items are struct tstore_rec)                                       */
+    struct ipx_htable table;
+};
+
+/** Auxiliary structure for serialization of templates of a snapshot                         */
+struct tstore_writer {
+    /** Write position (NULL to calculate the size only)                                     */
+    uint8_t *pos;
+    /** Total size of serialized templates                                                   */
+    size_t size;
+    /** Number of serialized templates                                                       */
+    size_t cnt;
+};
+
+static inline void
+tstore_put16(uint8_t *pos, uint16_t value)
+{
+    value = htons(value);
+    memcpy(pos, &value, sizeof(value));
+}
+
+static inline void
+tstore_put32(uint8_t *pos, uint32_t value)
+{
+    value = htonl(value);
+    memcpy(pos, &value, sizeof(value));
+}
+
+static inline void
+tstore_put64(uint8_t *pos, uint64_t value)
+{
+    tstore_put32(pos, (uint32_t) (value >> 32));
+    tstore_put32(pos + 4, (uint32_t) value);
+}
+
+static inline uint16_t
+tstore_get16(const uint8_t *pos)
+{
+    uint16_t value;
+    memcpy(&value, pos, sizeof(value));
+    return ntohs(value);
+}
+
+static inline uint32_t
+tstore_get32(const uint8_t *pos)
+{
+    uint32_t value;
+    memcpy(&value, pos, sizeof(value));
+    return ntohl(value);
+}
+
+static inline uint64_t
+tstore_get64(const uint8_t *pos)
+{
+    return ((uint64_t) tstore_get32(pos) << 32) | tstore_get32(pos + 4);
+}
+
+/**
+ * \brief Fill identification of a combination of a Transport Session and an ODID
+ * \param[out] key     Identification to fill
+ * \param[in]  session UDP Transport Session
+ * \param[in]  odid    Observation Domain ID
+ */
+static void
+tstore_key_init(struct tstore_key *key, const struct ipx_session *session, uint32_t odid)
+{
+    const struct ipx_session_net *net = &session->udp.net;
+    memset(key, 0, sizeof(*key));
+    key->odid = odid;
+    key->port_src = net->port_src;
+    key->port_dst = net->port_dst;
+
+    if (net->l3_proto == AF_INET) {
+        key->ip_ver = 4;
+        memcpy(key->addr_src, &net->addr_src.ipv4, sizeof(net->addr_src.ipv4));
+        memcpy(key->addr_dst, &net->addr_dst.ipv4, sizeof(net->addr_dst.ipv4));
+    } else {
+        key->ip_ver = 6;
+        memcpy(key->addr_src, &net->addr_src.ipv6, sizeof(net->addr_src.ipv6));
+        memcpy(key->addr_dst, &net->addr_dst.ipv6, sizeof(net->addr_dst.ipv6));
+    }
+}
+
+/**
+ * \brief Calculate a hash of an identification
+ * \param[in] key Identification
+ * \return Hash value
+ */
+static inline uint64_t
+tstore_hash(const struct tstore_key *key)
+{
+    uint64_t words[sizeof(*key) / sizeof(uint64_t)];
+    memcpy(words, key, sizeof(words));
+
+    uint64_t hash = 0;
+    for (size_t i = 0; i < sizeof(words) / sizeof(words[0]); ++i) {
+        hash = (hash ^ words[i]) * 0x9E3779B97F4A7C15ULL;
+    }
+
+    return ipx_htable_mix(hash);
+}
+
+/**
+ * \brief Destroy a record
+ * \param[in] rec Record to destroy
+ */
+static void
+tstore_rec_destroy(struct tstore_rec *rec)
+{
+    free(rec->data);
+    free(rec);
+}
+
+/**
+ * \brief Destroy a hash table and all its records
+ * \param[in] table Hash table
+ */
+static void
+tstore_table_clear(struct ipx_htable *table)
+{
+    for (size_t idx = 0; idx < table->size; ++idx) {
+        if (table->slots[idx].item != NULL) {
+            tstore_rec_destroy(table->slots[idx].item);
+        }
+    }
+
+    ipx_htable_destroy(table);
+}
+
+/**
+ * \brief Compare a record with an identification (callback of the hash table)
+ * \param[in] item Record
+ * \param[in] key  Identification
+ * \return True if the record matches the identification
+ */
+static inline bool
+tstore_rec_eq(const void *item, const void *key)
+{
+    const struct tstore_rec *rec = item;
+    return memcmp(&rec->key, key, sizeof(rec->key)) == 0;
+}
+
+/**
+ * \brief Find a record in a hash table
+ * \param[in] table Hash table
+ * \param[in] key   Identification of the record
+ * \return Pointer to the record or NULL (not found)
+ */
+static struct tstore_rec *
+tstore_table_find(const struct ipx_htable *table, const struct tstore_key *key)
+{
+    struct ipx_htable_slot *slot = ipx_htable_find(table, tstore_hash(key), &tstore_rec_eq, key);
+    return (slot != NULL) ? slot->item : NULL;
+}
+
+/**
+ * \brief Check whether templates of a record have expired
+ *
+ * The record is expired if it has not been updated for longer than the lifetime of its
+ * templates (i.e. the exporter has not been seen for a long time).
+ * \param[in] rec Record
+ * \param[in] now Current time (UNIX timestamp)
+ * \return True or false
+ */
+static inline bool
+tstore_rec_expired(const struct tstore_rec *rec, uint64_t now)
+{
+    uint64_t lifetime = (rec->lifetime_tmplts > rec->lifetime_opts)
+        ? rec->lifetime_tmplts : rec->lifetime_opts;
+    return rec->updated + lifetime < now;
+}
+
+/**
+ * \brief Remove expired records from a hash table
+ * \param[in] table Hash table
+ * \param[in] now   Current time (UNIX timestamp)
+ */
+static void
+tstore_table_prune(struct ipx_htable *table, uint64_t now)
+{
+    size_t idx = 0;
+    while (idx < table->size) {
+        struct ipx_htable_slot *slot = &table->slots[idx];
+        if (slot->item == NULL || !tstore_rec_expired(slot->item, now)) {
+            idx++;
+            continue;
+        }
+
+        // Another record could be moved to the slot, therefore, check the slot again
+        tstore_rec_destroy(slot->item);
+        ipx_htable_remove(table, slot);
+    }
+}
+
+/**
+ * \brief Check serialized templates of a record
+ * \param[in] data Serialized templates
+ * \param[in] size Size of serialized templates
+ * \param[in] cnt  Expected number of templates
+ * \return #IPX_OK if valid
+ * \return #IPX_ERR_FORMAT otherwise
+ */
+static int
+tstore_data_check(const uint8_t *data, uint32_t size, uint16_t cnt)
+{
+    const uint8_t *pos = data;
+    const uint8_t *end = data + size;
+    uint16_t found = 0;
+
+    while (pos < end) {
+        if ((size_t) (end - pos) < TSTORE_TMPLT_HDR_LEN) {
+            return IPX_ERR_FORMAT;
+        }
+
+        const uint16_t len = tstore_get16(pos + 2);
+        if ((pos[0] != TSTORE_SET_TMPLT && pos[0] != TSTORE_SET_OPTS)
+                || len < TSTORE_TMPLT_MIN_LEN
+                || (size_t) (end - pos) - TSTORE_TMPLT_HDR_LEN < len) {
+            return IPX_ERR_FORMAT;
+        }
+
+        pos += TSTORE_TMPLT_HDR_LEN + len;
+        found++;
+    }
+
+    return (found == cnt) ? IPX_OK : IPX_ERR_FORMAT;
+}
+
+/**
+ * \brief Parse records of the file into a hash table
+ *
+ * Expired records are skipped.
+ * \param[in] table Empty hash table to fill
+ * \param[in] data  Content of the file
+ * \param[in] size  Size of the content
+ * \param[in] now   Current time (UNIX timestamp)
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_FORMAT if the content is malformed or has unsupported version
+ * \return #IPX_ERR_NOMEM on a memory allocation error
+ */
+static int
+tstore_parse(struct ipx_htable *table, const uint8_t *data, size_t size, uint64_t now)
+{
+    if (size < TSTORE_FILE_HDR_LEN || memcmp(data, TSTORE_MAGIC, 4) != 0
+            || tstore_get16(data + 4) != TSTORE_VERSION) {
+        return IPX_ERR_FORMAT;
+    }
+
+    const uint32_t rec_cnt = tstore_get32(data + 16);
+    const uint8_t *pos = data + TSTORE_FILE_HDR_LEN;
+    const uint8_t *end = data + size;
+
+    for (uint32_t i = 0; i < rec_cnt; ++i) {
+        if ((size_t) (end - pos) < TSTORE_REC_HDR_LEN) {
+            return IPX_ERR_FORMAT;
+        }
+
+        struct tstore_rec rec;
+        memset(&rec, 0, sizeof(rec));
+        rec.key.ip_ver = pos[0];
+        rec.key.port_src = tstore_get16(pos + 2);
+        rec.key.port_dst = tstore_get16(pos + 4);
+        rec.lifetime_tmplts = tstore_get16(pos + 6);
+        rec.lifetime_opts = tstore_get16(pos + 8);
+        rec.tmplt_cnt = tstore_get16(pos + 10);
+        rec.key.odid = tstore_get32(pos + 12);
+        rec.updated = tstore_get64(pos + 16);
+        memcpy(rec.key.addr_src, pos + 24, 16);
+        memcpy(rec.key.addr_dst, pos + 40, 16);
+        rec.size = tstore_get32(pos + 56);
+        pos += TSTORE_REC_HDR_LEN;
+
+        if ((rec.key.ip_ver != 4 && rec.key.ip_ver != 6)
+                || (size_t) (end - pos) < rec.size
+                || tstore_data_check(pos, rec.size, rec.tmplt_cnt) != IPX_OK) {
+            return IPX_ERR_FORMAT;
+        }
+
+        if (rec.key.ip_ver == 4) {
+            // Only the first 4 bytes are used
+            memset(rec.key.addr_src + 4, 0, 12);
+            memset(rec.key.addr_dst + 4, 0, 12);
+        }
+
+        const uint8_t *rec_data = pos;
+        pos += rec.size;
+        if (rec.tmplt_cnt == 0 || tstore_rec_expired(&rec, now)
+                || tstore_table_find(table, &rec.key) != NULL) {
+            // Nothing to restore or duplicate
+            continue;
+        }
+
+        struct tstore_rec *rec_new = malloc(sizeof(*rec_new));
+        uint8_t *data_new = malloc(rec.size);
+        if (!rec_new || !data_new || ipx_htable_reserve(table) != IPX_OK) {
+            free(rec_new);
+            free(data_new);
+            return IPX_ERR_NOMEM;
+        }
+
+        memcpy(data_new, rec_data, rec.size);
+        *rec_new = rec;
+        rec_new->data = data_new;
+        ipx_htable_insert(table, tstore_hash(&rec_new->key), rec_new);
+    }
+
+    return (pos == end) ? IPX_OK : IPX_ERR_FORMAT;
+}
+
+/**
+ * \brief Write a record into a file
+ * \param[in] file File
+ * \param[in] rec  Record to write
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_DENIED on failure
+ */
+static int
+tstore_write_rec(FILE *file, const struct tstore_rec *rec)
+{
+    uint8_t hdr[TSTORE_REC_HDR_LEN];
+    memset(hdr, 0, sizeof(hdr));
+    hdr[0] = rec->key.ip_ver;
+    tstore_put16(hdr + 2, rec->key.port_src);
+    tstore_put16(hdr + 4, rec->key.port_dst);
+    tstore_put16(hdr + 6, rec->lifetime_tmplts);
+    tstore_put16(hdr + 8, rec->lifetime_opts);
+    tstore_put16(hdr + 10, rec->tmplt_cnt);
+    tstore_put32(hdr + 12, rec->key.odid);
+    tstore_put64(hdr + 16, rec->updated);
+    memcpy(hdr + 24, rec->key.addr_src, 16);
+    memcpy(hdr + 40, rec->key.addr_dst, 16);
+    tstore_put32(hdr + 56, rec->size);
+
+    if (fwrite(hdr, sizeof(hdr), 1, file) != 1) {
+        return IPX_ERR_DENIED;
+    }
+
+    if (rec->size > 0 && fwrite(rec->data, rec->size, 1, file) != 1) {
+        return IPX_ERR_DENIED;
+    }
+
+    return IPX_OK;
+}
+
+/**
+ * \brief Serialize a template (callback of fds_tsnapshot_for())
+ * \param[in] tmplt Template to serialize
+ * \param[in] data  Writer (see #tstore_writer)
+ * \return Always true (process all templates)
+ */
+static bool
+tstore_writer_cb(const struct fds_template *tmplt, void *data)
+{
+    struct tstore_writer *writer = data;
+    const uint16_t len = tmplt->raw.length;
+
+    if (writer->pos != NULL) {
+        uint8_t *pos = writer->pos;
+        pos[0] = (tmplt->type == FDS_TYPE_TEMPLATE) ? TSTORE_SET_TMPLT : TSTORE_SET_OPTS;
+        pos[1] = 0;
+        tstore_put16(pos + 2, len);
+        tstore_put32(pos + 4, tmplt->time.last_seen);
+        memcpy(pos + TSTORE_TMPLT_HDR_LEN, tmplt->raw.data, len);
+        writer->pos += TSTORE_TMPLT_HDR_LEN + len;
+    }
+
+    writer->size += TSTORE_TMPLT_HDR_LEN + len;
+    writer->cnt++;
+    return true;
+}
+
+/**
+ * \brief Get the current monotonic time
+ * \return Time in seconds
+ */
+static inline uint64_t
+tstore_monotonic()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+    return (uint64_t) ts.tv_sec;
+}
+
+ipx_tstore_t *
+ipx_tstore_create(const char *ident, const char *path, uint32_t interval)
+{
+    struct ipx_tstore *store = calloc(1, sizeof(*store));
+    if (!store) {
+        return NULL;
+    }
+
+    store->ident = strdup(ident);
+    store->path = strdup(path);
+    if (!store->ident || !store->path) {
+        free(store->path);
+        free(store->ident);
+        free(store);
+        return NULL;
+    }
+
+    if (ipx_htable_init(&store->table, TSTORE_DEF_SLOTS) != IPX_OK) {
+        free(store->path);
+        free(store->ident);
+        free(store);
+        return NULL;
+    }
+
+    if (pthread_mutex_init(&store->lock, NULL) != 0) {
+        ipx_htable_destroy(&store->table);
+        free(store->path);
+        free(store->ident);
+        free(store);
+        return NULL;
+    }
+
+    store->interval = interval;
+    store->save_next = tstore_monotonic() + interval;
+    return store;
+}
+
+void
+ipx_tstore_destroy(ipx_tstore_t *store)
+{
+    pthread_mutex_destroy(&store->lock);
+    tstore_table_clear(&store->table);
+    free(store->path);
+    free(store->ident);
+    free(store);
+}
+
+uint32_t
+ipx_tstore_interval(const ipx_tstore_t *store)
+{
+    return store->interval;
+}
+
+int
+ipx_tstore_load(ipx_tstore_t *store)
+{
+    const char *err_str;
+    FILE *file = fopen(store->path, "rb");
+    if (!file) {
+        if (errno == ENOENT) {
+            IPX_INFO(store->ident, "Template store '%s' doesn't exist yet.", store->path);
+            return IPX_ERR_NOTFOUND;
+        }
+
+        ipx_strerror(errno, err_str);
+        IPX_ERROR(store->ident, "Failed to open template store '%s': %s", store->path,
+            err_str);
+        return IPX_ERR_DENIED;
+    }
+
+    struct stat file_info;
+    uint8_t *data = NULL;
+    size_t size = 0;
+    int rc = IPX_OK;
+
+    if (fstat(fileno(file), &file_info) != 0) {
+        rc = IPX_ERR_DENIED;
+    } else if ((size = (size_t) file_info.st_size) == 0) {
+        rc = IPX_ERR_FORMAT;
+    } else if ((data = malloc(size)) == NULL) {
+        rc = IPX_ERR_NOMEM;
+    } else if (fread(data, size, 1, file) != 1) {
+        rc = IPX_ERR_DENIED;
+    }
+    fclose(file);
+
+    struct ipx_htable table;
+    if (rc == IPX_OK && ipx_htable_init(&table, TSTORE_DEF_SLOTS) != IPX_OK) {
+        rc = IPX_ERR_NOMEM;
+    }
+
+    if (rc == IPX_OK) {
+        rc = tstore_parse(&table, data, size, (uint64_t) time(NULL));
+        if (rc != IPX_OK) {
+            tstore_table_clear(&table);
+        }
+    }
+    free(data);
+
+    switch (rc) {
+    case IPX_OK:
+        break;
+    case IPX_ERR_FORMAT:
+        IPX_WARNING(store->ident, "Template store '%s' is malformed or has unsupported "
+            "version. Its content is ignored.", store->path);
+        return rc;
+    case IPX_ERR_NOMEM:
+        IPX_ERROR(store->ident, "A memory allocation failed (%s:%d).", __FILE__, __LINE__);
+        return rc;
+    default:
+        IPX_ERROR(store->ident, "Failed to read template store '%s'.", store->path);
+        return rc;
+    }
+
+    pthread_mutex_lock(&store->lock);
+    tstore_table_clear(&store->table);
+    store->table = table;
+    pthread_mutex_unlock(&store->lock);
+
+    IPX_INFO(store->ident, "Templates of %zu Transport Session(s) and ODID(s) loaded from "
+        "template store '%s'.", table.used, store->path);
+    return IPX_OK;
+}
+
+int
+ipx_tstore_save(ipx_tstore_t *store)
+{
+    const char *err_str;
+    const size_t path_len = strlen(store->path);
+    char *path_tmp = malloc(path_len + sizeof(".tmp"));
+    if (!path_tmp) {
+        IPX_ERROR(store->ident, "A memory allocation failed (%s:%d).", __FILE__, __LINE__);
+        return IPX_ERR_DENIED;
+    }
+    memcpy(path_tmp, store->path, path_len);
+    memcpy(path_tmp + path_len, ".tmp", sizeof(".tmp"));
+
+    FILE *file = fopen(path_tmp, "wb");
+    if (!file) {
+        ipx_strerror(errno, err_str);
+        IPX_ERROR(store->ident, "Failed to create template store '%s': %s", path_tmp, err_str);
+        free(path_tmp);
+        return IPX_ERR_DENIED;
+    }
+
+    pthread_mutex_lock(&store->lock);
+    const uint64_t now = (uint64_t) time(NULL);
+    tstore_table_prune(&store->table, now);
+
+    uint8_t hdr[TSTORE_FILE_HDR_LEN];
+    memset(hdr, 0, sizeof(hdr));
+    memcpy(hdr, TSTORE_MAGIC, 4);
+    tstore_put16(hdr + 4, TSTORE_VERSION);
+    tstore_put64(hdr + 8, now);
+    tstore_put32(hdr + 16, (uint32_t) store->table.used);
+
+    int rc = (fwrite(hdr, sizeof(hdr), 1, file) == 1) ? IPX_OK : IPX_ERR_DENIED;
+    for (size_t idx = 0; rc == IPX_OK && idx < store->table.size; ++idx) {
+        const struct tstore_rec *rec = store->table.slots[idx].item;
+        if (rec != NULL) {
+            rc = tstore_write_rec(file, rec);
+        }
+    }
+    pthread_mutex_unlock(&store->lock);
+
+    if (rc == IPX_OK && (fflush(file) != 0 || fsync(fileno(file)) != 0)) {
+        rc = IPX_ERR_DENIED;
+    }
+    if (fclose(file) != 0) {
+        rc = IPX_ERR_DENIED;
+    }
+    if (rc == IPX_OK && rename(path_tmp, store->path) != 0) {
+        rc = IPX_ERR_DENIED;
+    }
+
+    if (rc != IPX_OK) {
+        ipx_strerror(errno, err_str);
+        IPX_ERROR(store->ident, "Failed to save template store '%s': %s", store->path, err_str);
+        unlink(path_tmp);
+    }
+
+    free(path_tmp);
+    return rc;
+}
+
+int
+ipx_tstore_save_periodic(ipx_tstore_t *store)
+{
+    if (store->interval == 0) {
+        return IPX_OK;
+    }
+
+    const uint64_t now = tstore_monotonic();
+    uint64_t next = __atomic_load_n(&store->save_next, __ATOMIC_RELAXED);
+    if (now < next) {
+        return IPX_OK;
+    }
+
+    // Only one of concurrent callers claims the saving
+    if (!__atomic_compare_exchange_n(&store->save_next, &next, now + store->interval, false,
+            __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+        return IPX_OK;
+    }
+
+    return ipx_tstore_save(store);
+}
+
+int
+ipx_tstore_publish(ipx_tstore_t *store, const struct ipx_session *session, uint32_t odid,
+    fds_tmgr_t *tmgr)
+{
+    const fds_tsnapshot_t *snap;
+    if (session->type != FDS_SESSION_UDP || fds_tmgr_snapshot_get(tmgr, &snap) != FDS_OK) {
+        return IPX_ERR_ARG;
+    }
+
+    if (session->udp.lifetime.tmplts == 0 && session->udp.lifetime.opts_tmplts == 0) {
+        // Templates without a lifetime never expire in the session but cannot be restored
+        return IPX_OK;
+    }
+
+    // Calculate the size of all templates first
+    struct tstore_writer writer = {.pos = NULL, .size = 0, .cnt = 0};
+    fds_tsnapshot_for(snap, &tstore_writer_cb, &writer);
+
+    uint8_t *data = NULL;
+    const size_t size = writer.size;
+    const size_t cnt = writer.cnt;
+    if (size > 0) {
+        if ((data = malloc(size)) == NULL) {
+            return IPX_ERR_NOMEM;
+        }
+
+        writer.pos = data;
+        fds_tsnapshot_for(snap, &tstore_writer_cb, &writer);
+        assert(writer.pos == data + size);
+    }
+
+    struct tstore_key key;
+    tstore_key_init(&key, session, odid);
+
+    pthread_mutex_lock(&store->lock);
+    struct tstore_rec *rec = tstore_table_find(&store->table, &key);
+    if (!rec) {
+        if (cnt == 0) {
+            // Nothing to store
+            pthread_mutex_unlock(&store->lock);
+            return IPX_OK;
+        }
+
+        if (ipx_htable_reserve(&store->table) != IPX_OK
+                || (rec = calloc(1, sizeof(*rec))) == NULL) {
+            pthread_mutex_unlock(&store->lock);
+            free(data);
+            return IPX_ERR_NOMEM;
+        }
+
+        rec->key = key;
+        ipx_htable_insert(&store->table, tstore_hash(&rec->key), rec);
+    }
+
+    free(rec->data);
+    rec->data = data;
+    rec->size = (uint32_t) size;
+    rec->tmplt_cnt = (uint16_t) cnt;
+    rec->lifetime_tmplts = session->udp.lifetime.tmplts;
+    rec->lifetime_opts = session->udp.lifetime.opts_tmplts;
+    rec->updated = (uint64_t) time(NULL);
+    pthread_mutex_unlock(&store->lock);
+    return IPX_OK;
+}
+
+int
+ipx_tstore_restore(ipx_tstore_t *store, const struct ipx_session *session, uint32_t odid,
+    fds_tmgr_t *tmgr, uint32_t exp_time, unsigned int *cnt)
+{
+    *cnt = 0;
+    if (session->type != FDS_SESSION_UDP) {
+        return IPX_ERR_NOTFOUND;
+    }
+
+    struct tstore_key key;
+    tstore_key_init(&key, session, odid);
+
+    // Make a copy of the templates so the store is not locked while they are parsed
+    pthread_mutex_lock(&store->lock);
+    const struct tstore_rec *rec = tstore_table_find(&store->table, &key);
+    if (!rec || rec->size == 0) {
+        pthread_mutex_unlock(&store->lock);
+        return IPX_ERR_NOTFOUND;
+    }
+
+    const uint32_t size = rec->size;
+    uint8_t *data = malloc(size);
+    if (!data) {
+        pthread_mutex_unlock(&store->lock);
+        return IPX_ERR_NOMEM;
+    }
+    memcpy(data, rec->data, size);
+    pthread_mutex_unlock(&store->lock);
+
+    const uint8_t *pos = data;
+    const uint8_t *end = data + size;
+    int rc = IPX_OK;
+
+    while (pos < end) {
+        const enum fds_template_type type = (pos[0] == TSTORE_SET_TMPLT)
+            ? FDS_TYPE_TEMPLATE : FDS_TYPE_TEMPLATE_OPTS;
+        const uint16_t len = tstore_get16(pos + 2);
+        const uint32_t last_seen = tstore_get32(pos + 4);
+        const uint8_t *raw = pos + TSTORE_TMPLT_HDR_LEN;
+        pos += TSTORE_TMPLT_HDR_LEN + len;
+
+        // Skip templates that would be already expired (Export Time can be in history)
+        const uint16_t lifetime = (type == FDS_TYPE_TEMPLATE)
+            ? session->udp.lifetime.tmplts : session->udp.lifetime.opts_tmplts;
+        if ((int32_t) (exp_time - last_seen) > (int32_t) lifetime) {
+            continue;
+        }
+
+        struct fds_template *tmplt;
+        uint16_t tmplt_len = len;
+        if (fds_template_parse(type, raw, &tmplt_len, &tmplt) != FDS_OK) {
+            continue;
+        }
+
+        int ret = fds_tmgr_template_add(tmgr, tmplt);
+        if (ret == FDS_OK) {
+            (*cnt)++;
+            continue;
+        }
+
+        fds_template_destroy(tmplt);
+        if (ret == FDS_ERR_NOMEM) {
+            rc = IPX_ERR_NOMEM;
+            break;
+        }
+    }
+
+    free(data);
+    return rc;
+}
@@ -0,0 +1,177 @@
+/**
+ * \file src/core/tstore.h
+ * \brief Persistent store of (Options) Templates of UDP sessions (internal header file)
+ * \date 2026
+ */
+
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#ifndef IPFIXCOL_TSTORE_H
+#define IPFIXCOL_TSTORE_H
+
+#include <stdint.h>
+#include <ipfixcol2.h>
+#include <libfds.h>
+
+/**
+ * \defgroup ipxTstore Template store
+ * \brief Persistence of (Options) Templates of UDP Transport Sessions across restarts
+ *
+ * Exporters over UDP usually refresh (Options) Templates only periodically. If the collector is
+ * restarted, Data Records received before the next refresh cannot be interpreted. The store keeps
+ * the latest template definitions of each combination of a Transport Session and an ODID and
+ * saves them into a file. After the restart, the definitions are loaded from the file and
+ * restored as soon as the same combination appears again.
+ *
+ * Templates are restored only if they would not be expired at the Export Time of the first
+ * received IPFIX Message (see the template lifetimes of the UDP session). Sessions with both
+ * lifetimes set to 0 (i.e. templates never expire) are not stored at all as the age of their
+ * templates cannot be verified. The store is shared by all parsers of an input instance and all
+ * functions are thread-safe. Parsers only publish their templates, the store is saved by its
+ * owner on termination and periodically by the parser that claims the interval first (see
+ * ipx_tstore_save_periodic()).
+ * @{
+ */
+
+/** Template store                                                                           */
+typedef struct ipx_tstore ipx_tstore_t;
+
+/**
+ * \brief Create an empty template store
+ * \param[in] ident    Identification of the store owner (for log messages)
+ * \param[in] path     Path to the file of the store
+ * \param[in] interval Interval of periodic saving in seconds (0 = only on termination)
+ * \return Pointer to the store or NULL (memory allocation error)
+ */
+IPX_API ipx_tstore_t *
+ipx_tstore_create(const char *ident, const char *path, uint32_t interval);
+
+/**
+ * \brief Destroy a template store
+ * \note The content of the store is NOT saved. Use ipx_tstore_save() before if required.
+ * \param[in] store Template store
+ */
+IPX_API void
+ipx_tstore_destroy(ipx_tstore_t *store);
+
+/**
+ * \brief Get the interval of periodic saving
+ * \param[in] store Template store
+ * \return Interval in seconds (0 = only on termination)
+ */
+IPX_API uint32_t
+ipx_tstore_interval(const ipx_tstore_t *store);
+
+/**
+ * \brief Load content of the store from its file
+ *
+ * Previously loaded or published templates are replaced. Records of Transport Sessions that
+ * have not been updated for longer than the lifetime of their templates are dropped.
+ * \param[in] store Template store
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_NOTFOUND if the file doesn't exist (the store is empty)
+ * \return #IPX_ERR_FORMAT if the file is malformed or has unsupported version (the store is
+ *   empty)
+ * \return #IPX_ERR_DENIED if the file cannot be read
+ * \return #IPX_ERR_NOMEM on a memory allocation error
+ */
+IPX_API int
+ipx_tstore_load(ipx_tstore_t *store);
+
+/**
+ * \brief Save content of the store into its file
+ *
+ * The file is replaced atomically i.e. the content is written into a temporary file which is
+ * renamed afterwards. Records of Transport Sessions that have not been updated for longer than
+ * the lifetime of their templates are dropped.
+ * \param[in] store Template store
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_DENIED if the file cannot be written
+ */
+IPX_API int
+ipx_tstore_save(ipx_tstore_t *store);
+
+/**
+ * \brief Save content of the store into its file if the interval of periodic saving elapsed
+ *
+ * The first caller after the interval elapsed claims the saving, so the file is written at most
+ * once per interval regardless of the number of parsers calling the function.
+ * \param[in] store Template store
+ * \return #IPX_OK on success, if the saving is not due yet or periodic saving is disabled
+ * \return #IPX_ERR_DENIED if the file cannot be written
+ */
+IPX_API int
+ipx_tstore_save_periodic(ipx_tstore_t *store);
+
+/**
+ * \brief Publish current (Options) Templates of a combination of Transport Session and ODID
+ *
+ * All valid templates in the current snapshot of the Template manager replace previously
+ * published templates of the same combination. Sessions with both template lifetimes set to 0
+ * are ignored.
+ * \param[in] store   Template store
+ * \param[in] session Transport Session (must be UDP)
+ * \param[in] odid    Observation Domain ID
+ * \param[in] tmgr    Template manager (the Export Time must be already set)
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_ARG if the session is not UDP or the snapshot is not available
+ * \return #IPX_ERR_NOMEM on a memory allocation error
+ */
+IPX_API int
+ipx_tstore_publish(ipx_tstore_t *store, const struct ipx_session *session, uint32_t odid,
+    fds_tmgr_t *tmgr);
+
+/**
+ * \brief Restore (Options) Templates of a combination of Transport Session and ODID
+ *
+ * Stored templates that would be already expired at the given Export Time are skipped.
+ * \param[in]  store     Template store
+ * \param[in]  session   Transport Session (must be UDP)
+ * \param[in]  odid      Observation Domain ID
+ * \param[in]  tmgr      Template manager (the Export Time must be already set)
+ * \param[in]  exp_time  Current Export Time of the Template manager
+ * \param[out] cnt       Number of restored templates
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_NOTFOUND if the store doesn't hold any templates of the combination
+ * \return #IPX_ERR_NOMEM on a memory allocation error
+ */
+IPX_API int
+ipx_tstore_restore(ipx_tstore_t *store, const struct ipx_session *session, uint32_t odid,
+    fds_tmgr_t *tmgr, uint32_t exp_time, unsigned int *cnt);
+
+/**@}*/
+
+#endif // IPFIXCOL_TSTORE_H
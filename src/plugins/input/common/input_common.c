@@ -0,0 +1,85 @@
+/**
+ * \file src/plugins/input/common/input_common.c
+ * \brief Common functions of input plugins for NetFlow/IPFIX over UDP (source file)
+ * \date 2026
+ */
+
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include "input_common.h"
+
+void
+input_pass_flush(struct input_pass *pass)
+{
+    if (pass->cnt == 0) {
+        return;
+    }
+
+    ipx_ctx_msg_pass_batch(pass->ctx, pass->msgs, pass->cnt);
+    pass->cnt = 0;
+}
+
+bool
+input_msg_check(const uint8_t *msg, uint32_t msg_size, bool strict, uint32_t *odid)
+{
+    if (msg_size < sizeof(uint16_t) || msg_size > UINT16_MAX) {
+        return false;
+    }
+
+    switch (read_u16(msg)) {
+    case FDS_IPFIX_VERSION: // IPFIX
+        if (msg_size < FDS_IPFIX_MSG_HDR_LEN || (strict && read_u16(msg + 2) != msg_size)) {
+            return false;
+        }
+        *odid = read_u32(msg + 12);
+        return true;
+    case NF9_HDR_VERSION: // NetFlow v9
+        if (msg_size < NF9_HDR_LEN) {
+            return false;
+        }
+        *odid = read_u32(msg + NF9_SRC_ID_OFFSET);
+        return true;
+    case NF5_HDR_VERSION: // NetFlow v5 (Source ID is not available -> always 0)
+        if (msg_size < NF5_HDR_LEN
+                || (strict && NF5_HDR_LEN + read_u16(msg + 2) * NF5_REC_LEN != msg_size)) {
+            return false;
+        }
+        *odid = 0;
+        return true;
+    default:
+        return false;
+    }
+}
@@ -0,0 +1,174 @@
+/**
+ * \file src/plugins/input/common/input_common.h
+ * \brief Common functions of input plugins for NetFlow/IPFIX over UDP (header file)
+ * \date 2026
+ */
+
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#ifndef INPUT_COMMON_H
+#define INPUT_COMMON_H
+
+#include <ipfixcol2.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+/** Max number of messages passed at once                                                        */
+#define INPUT_PASS_MAX    (256)
+
+/** Version identification in NetFlow v5 header                                                  */
+#define NF5_HDR_VERSION   (5)
+/** Length of NetFlow v5 header (in bytes)                                                       */
+#define NF5_HDR_LEN       (24U)
+/** Length of NetFlow v5 record (in bytes)                                                       */
+#define NF5_REC_LEN       (48U)
+/** Version identification in NetFlow v9 header                                                  */
+#define NF9_HDR_VERSION   (9)
+/** Length of NetFlow v9 header (in bytes)                                                       */
+#define NF9_HDR_LEN       (20U)
+/** Offset of Source ID in NetFlow v9 header (in bytes)                                          */
+#define NF9_SRC_ID_OFFSET (16U)
+
+/** Read a 16-bit unsigned integer in network byte order                                        */
+static inline uint16_t
+read_u16(const uint8_t *ptr)
+{
+    return (uint16_t) ((ptr[0] << 8) | ptr[1]);
+}
+
+/** Read a 32-bit unsigned integer in network byte order                                        */
+static inline uint32_t
+read_u32(const uint8_t *ptr)
+{
+    return ((uint32_t) read_u16(ptr) << 16) | read_u16(ptr + 2);
+}
+
+/** Messages prepared to be passed at once                                                       */
+struct input_pass {
+    /** Instance context                                                                         */
+    ipx_ctx_t *ctx;
+    /** Messages prepared to be passed                                                           */
+    ipx_msg_t *msgs[INPUT_PASS_MAX];
+    /** Number of prepared messages                                                              */
+    uint32_t cnt;
+};
+
+/**
+ * \brief Initialize an empty array of messages to pass
+ * \param[in] pass Array of messages
+ * \param[in] ctx  Instance context
+ */
+static inline void
+input_pass_init(struct input_pass *pass, ipx_ctx_t *ctx)
+{
+    pass->ctx = ctx;
+    pass->cnt = 0;
+}
+
+/**
+ * \brief Pass all prepared messages at once
+ * \param[in] pass Array of messages
+ */
+void
+input_pass_flush(struct input_pass *pass);
+
+/**
+ * \brief Add a message to the array of messages to pass
+ *
+ * If the array is full, all prepared messages are passed first.
+ * \param[in] pass Array of messages
+ * \param[in] msg  Message
+ */
+static inline void
+input_pass_add(struct input_pass *pass, ipx_msg_t *msg)
+{
+    if (pass->cnt == INPUT_PASS_MAX) {
+        input_pass_flush(pass);
+    }
+
+    pass->msgs[pass->cnt++] = msg;
+}
+
+/**
+ * \brief Calculate hash of a Transport Session identification
+ * \param[in] net Identification of the Session (unused bytes must be zeroed)
+ * \return Hash value
+ */
+static inline uint64_t
+input_net_hash(const struct ipx_session_net *net)
+{
+    uint64_t parts[4];
+    memcpy(&parts[0], &net->addr_src, sizeof(net->addr_src));
+    memcpy(&parts[2], &net->addr_dst, sizeof(net->addr_dst));
+
+    uint64_t key = ((uint64_t) net->l3_proto << 32) | ((uint64_t) net->port_src << 16)
+        | net->port_dst;
+    key ^= parts[0] ^ (parts[1] * 0xC2B2AE3D27D4EB4FULL) ^ (parts[2] * 0x9E3779B97F4A7C15ULL)
+        ^ (parts[3] * 0x165667B19E3779F9ULL);
+    return ipx_htable_mix(key);
+}
+
+/**
+ * \brief Compare Transport Session identifications (callback of a hash table)
+ *
+ * Items of the hash table must start with the identification (i.e. struct ipx_session_net).
+ * \param[in] item Item of the hash table
+ * \param[in] key  Identification (unused bytes must be zeroed)
+ * \return True if the identifications are the same
+ */
+static inline bool
+input_net_eq(const void *item, const void *key)
+{
+    return memcmp(item, key, sizeof(struct ipx_session_net)) == 0;
+}
+
+/**
+ * \brief Check the header of a NetFlow/IPFIX message and extract ODID/Source ID
+ *
+ * If \p strict is set, the length of the message must also match the length declared in the
+ * header (IPFIX) or the number of records (NetFlow v5). This is useful for skipping other types
+ * of traffic, if the message could be a payload of any UDP datagram.
+ * \param[in]  msg      Message
+ * \param[in]  msg_size Size of the message
+ * \param[in]  strict   Perform additional checks
+ * \param[out] odid     Observation Domain ID/Source ID (always 0 for NetFlow v5)
+ * \return True if the header is valid, false otherwise
+ */
+bool
+input_msg_check(const uint8_t *msg, uint32_t msg_size, bool strict, uint32_t *odid);
+
+#endif // INPUT_COMMON_H
@@ -0,0 +1,462 @@
+/**
+ * \file src/plugins/input/common/reasm.c
+ * \brief Decoding of UDP datagrams and reassembly of fragmented IP datagrams (source file)
+ * \date 2026
+ */
+
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include "input_common.h"
+#include "reasm.h"
+
+/** Length of IPv4 header without options (in bytes)                                             */
+#define IPV4_HDR_LEN  (20U)
+/** Length of IPv6 header (in bytes)                                                             */
+#define IPV6_HDR_LEN  (40U)
+/** Length of IPv6 Fragment extension header (in bytes)                                          */
+#define IPV6_FRAG_LEN (8U)
+/** Length of UDP header (in bytes)                                                              */
+#define UDP_HDR_LEN   (8U)
+
+/** Size of a unit of fragment offsets [bytes]                                                   */
+#define UNIT_SIZE     (8U)
+/** Max number of units of a payload                                                             */
+#define UNIT_CNT      ((REASM_SIZE_MAX + UNIT_SIZE - 1) / UNIT_SIZE)
+
+/** Datagram in progress                                                                         */
+struct reasm_rec {
+    /** Identification of the datagram                                                           */
+    struct reasm_key key;
+    /** Hash of the identification                                                               */
+    uint64_t hash;
+    /** The record is in use (i.e. present in the hash table)                                    */
+    bool used;
+    /** Previous record in the list ordered by the last update (NULL, if the first)              */
+    struct reasm_rec *lru_prev;
+    /** Next record in the list ordered by the last update (NULL, if the last)                   */
+    struct reasm_rec *lru_next;
+    /** Time of the last received fragment                                                       */
+    uint64_t last_seen;
+    /** Total size of the payload (0 if the last fragment hasn't been received yet)              */
+    uint32_t total;
+    /** End of the furthest received fragment                                                    */
+    uint32_t end_max;
+    /** Number of received units (see #UNIT_SIZE)                                                */
+    uint32_t filled;
+    /** Bitmap of received units                                                                 */
+    uint64_t bitmap[(UNIT_CNT + 63) / 64];
+    /** Payload of the datagram (allocated on the first use of the record)                      */
+    uint8_t *payload;
+};
+
+/** Reassembly structure                                                                         */
+struct reasm {
+    /** Inactivity timeout of a datagram                                                         */
+    uint64_t timeout;
+    /** Number of records                                                                        */
+    unsigned int cnt;
+    /** Records of datagrams in progress (key: struct reasm_key)                                 */
+    struct ipx_htable table;
+    /** The most recently updated record                                                         */
+    struct reasm_rec *lru_head;
+    /** The least recently updated record (unused records are always at the tail)               */
+    struct reasm_rec *lru_tail;
+    /** Records of datagrams                                                                     */
+    struct reasm_rec recs[];
+};
+
+/**
+ * \brief Remove a record from the list of records ordered by the last update
+ * \param[in] reasm Reassembly structure
+ * \param[in] rec   Record to remove
+ */
+static inline void
+lru_unlink(struct reasm *reasm, struct reasm_rec *rec)
+{
+    if (rec->lru_prev != NULL) {
+        rec->lru_prev->lru_next = rec->lru_next;
+    } else {
+        reasm->lru_head = rec->lru_next;
+    }
+
+    if (rec->lru_next != NULL) {
+        rec->lru_next->lru_prev = rec->lru_prev;
+    } else {
+        reasm->lru_tail = rec->lru_prev;
+    }
+
+    rec->lru_prev = NULL;
+    rec->lru_next = NULL;
+}
+
+/**
+ * \brief Insert a record at the head of the list (i.e. the most recently updated record)
+ * \param[in] reasm Reassembly structure
+ * \param[in] rec   Record (not present in the list)
+ */
+static inline void
+lru_push_head(struct reasm *reasm, struct reasm_rec *rec)
+{
+    rec->lru_next = reasm->lru_head;
+    if (rec->lru_next != NULL) {
+        rec->lru_next->lru_prev = rec;
+    } else {
+        reasm->lru_tail = rec;
+    }
+    reasm->lru_head = rec;
+}
+
+/**
+ * \brief Insert a record at the tail of the list (i.e. the first record to reuse)
+ * \param[in] reasm Reassembly structure
+ * \param[in] rec   Record (not present in the list)
+ */
+static inline void
+lru_push_tail(struct reasm *reasm, struct reasm_rec *rec)
+{
+    rec->lru_prev = reasm->lru_tail;
+    if (rec->lru_prev != NULL) {
+        rec->lru_prev->lru_next = rec;
+    } else {
+        reasm->lru_head = rec;
+    }
+    reasm->lru_tail = rec;
+}
+
+/**
+ * \brief Calculate hash of a datagram identification
+ * \param[in] key Identification (unused bytes must be zeroed)
+ * \return Hash value
+ */
+static inline uint64_t
+reasm_hash(const struct reasm_key *key)
+{
+    static_assert(sizeof(*key) % sizeof(uint64_t) == 0, "Unexpected size of the key");
+    uint64_t parts[sizeof(*key) / sizeof(uint64_t)];
+    memcpy(parts, key, sizeof(parts));
+
+    uint64_t hash = 0;
+    for (size_t i = 0; i < sizeof(parts) / sizeof(parts[0]); ++i) {
+        hash = ipx_htable_mix(hash ^ parts[i]);
+    }
+    return hash;
+}
+
+/**
+ * \brief Compare identification of a record with a key (callback of the hash table)
+ * \param[in] item Record
+ * \param[in] key  Identification of a datagram
+ * \return True if the identifications are the same
+ */
+static bool
+reasm_rec_eq(const void *item, const void *key)
+{
+    const struct reasm_rec *rec = item;
+    return memcmp(&rec->key, key, sizeof(rec->key)) == 0;
+}
+
+reasm_t *
+reasm_create(unsigned int cnt, uint64_t timeout)
+{
+    assert(cnt > 0);
+    struct reasm *reasm = calloc(1, sizeof(*reasm) + cnt * sizeof(reasm->recs[0]));
+    if (!reasm) {
+        return NULL;
+    }
+
+    // The table is never more than half full
+    size_t table_size = 1;
+    while (table_size < 2 * (size_t) cnt) {
+        table_size *= 2;
+    }
+
+    if (ipx_htable_init(&reasm->table, table_size) != IPX_OK) {
+        free(reasm);
+        return NULL;
+    }
+
+    reasm->timeout = timeout;
+    reasm->cnt = cnt;
+    for (unsigned int i = 0; i < cnt; ++i) {
+        lru_push_tail(reasm, &reasm->recs[i]);
+    }
+    return reasm;
+}
+
+void
+reasm_destroy(reasm_t *reasm)
+{
+    for (unsigned int i = 0; i < reasm->cnt; ++i) {
+        free(reasm->recs[i].payload);
+    }
+    ipx_htable_destroy(&reasm->table);
+    free(reasm);
+}
+
+/**
+ * \brief Drop a datagram and make its record available for reuse
+ * \param[in] reasm Reassembly structure
+ * \param[in] rec   Record of the datagram
+ */
+static void
+reasm_release(struct reasm *reasm, struct reasm_rec *rec)
+{
+    struct ipx_htable_slot *slot = ipx_htable_find_item(&reasm->table, rec->hash, rec);
+    assert(slot != NULL);
+    ipx_htable_remove(&reasm->table, slot);
+    rec->used = false;
+
+    lru_unlink(reasm, rec);
+    lru_push_tail(reasm, rec);
+}
+
+/**
+ * \brief Find a record of a datagram or prepare a new one
+ *
+ * If the datagram is not present (or it has expired), a free record or the least recently
+ * updated record (in this order) is reset and returned. In any case, the record becomes
+ * the most recently updated one.
+ * \param[in] reasm Reassembly structure
+ * \param[in] key   Identification of the datagram
+ * \param[in] now   Current time
+ * \return Pointer to the record
+ */
+static struct reasm_rec *
+reasm_find(struct reasm *reasm, const struct reasm_key *key, uint64_t now)
+{
+    const uint64_t hash = reasm_hash(key);
+    struct ipx_htable_slot *slot = ipx_htable_find(&reasm->table, hash, &reasm_rec_eq, key);
+    struct reasm_rec *rec = (slot != NULL) ? slot->item : NULL;
+    if (rec != NULL && rec->last_seen + reasm->timeout < now) {
+        // Expired, start again
+        reasm_release(reasm, rec);
+        rec = NULL;
+    }
+
+    if (!rec) {
+        rec = reasm->lru_tail;
+        if (rec->used) {
+            reasm_release(reasm, rec);
+        }
+
+        rec->key = *key;
+        rec->hash = hash;
+        rec->used = true;
+        rec->total = 0;
+        rec->end_max = 0;
+        rec->filled = 0;
+        memset(rec->bitmap, 0, sizeof(rec->bitmap));
+        ipx_htable_insert(&reasm->table, hash, rec);
+    }
+
+    rec->last_seen = now;
+    lru_unlink(reasm, rec);
+    lru_push_head(reasm, rec);
+    return rec;
+}
+
+enum reasm_status
+reasm_add(reasm_t *reasm, const struct reasm_key *key, uint64_t now, uint32_t offset,
+    const uint8_t *data, uint32_t size, bool more, const uint8_t **payload,
+    uint32_t *payload_size)
+{
+    // Only the last fragment can have size which is not a multiple of the unit size
+    const uint32_t end = offset + size;
+    if (size == 0 || end > REASM_SIZE_MAX || offset % UNIT_SIZE != 0
+            || (more && size % UNIT_SIZE != 0)) {
+        // Don't even look for the datagram, it cannot be a valid fragment of any datagram
+        return REASM_INVALID;
+    }
+
+    struct reasm_rec *rec = reasm_find(reasm, key, now);
+
+    // Nothing can be located beyond the end of the last fragment
+    if ((!more && rec->total != 0 && rec->total != end)
+            || (!more && rec->end_max > end)
+            || (rec->total != 0 && end > rec->total)) {
+        reasm_release(reasm, rec);
+        return REASM_INVALID;
+    }
+
+    if (!rec->payload) {
+        rec->payload = malloc(REASM_SIZE_MAX);
+        if (!rec->payload) {
+            reasm_release(reasm, rec);
+            return REASM_INVALID;
+        }
+    }
+
+    if (!more) {
+        rec->total = end;
+    }
+    if (end > rec->end_max) {
+        rec->end_max = end;
+    }
+
+    // Copy the data and mark the units as received (overlapping data are simply overwritten)
+    memcpy(rec->payload + offset, data, size);
+    const uint32_t unit_end = (end + UNIT_SIZE - 1) / UNIT_SIZE;
+    for (uint32_t unit = offset / UNIT_SIZE; unit < unit_end; ++unit) {
+        const uint64_t mask = 1ULL << (unit % 64);
+        if ((rec->bitmap[unit / 64] & mask) == 0) {
+            rec->bitmap[unit / 64] |= mask;
+            rec->filled++;
+        }
+    }
+
+    if (rec->total == 0 || rec->filled != (rec->total + UNIT_SIZE - 1) / UNIT_SIZE) {
+        return REASM_MORE;
+    }
+
+    // Complete, the record can be reused but the payload is valid until the next call
+    reasm_release(reasm, rec);
+    *payload = rec->payload;
+    *payload_size = rec->total;
+    return REASM_DONE;
+}
+
+enum reasm_status
+reasm_udp(reasm_t *reasm, const uint8_t *pkt, uint32_t pkt_len, uint64_t now,
+    struct ipx_session_net *net, const uint8_t **payload, uint32_t *payload_size)
+{
+    memset(net, 0, sizeof(*net));
+    struct reasm_key key;
+    memset(&key, 0, sizeof(key));
+
+    const uint8_t *l4;
+    uint32_t l4_len;
+    uint32_t frag_offset = 0;
+    bool frag_more = false;
+    bool is_frag = false;
+    uint8_t l4_proto;
+
+    if (pkt_len < 1) {
+        return REASM_INVALID;
+    }
+
+    switch (pkt[0] >> 4) {
+    case 4: { // IPv4
+        const uint32_t hdr_len = (pkt[0] & 0x0FU) * 4U;
+        if (pkt_len < IPV4_HDR_LEN || hdr_len < IPV4_HDR_LEN || read_u16(pkt + 2) < hdr_len
+                || read_u16(pkt + 2) > pkt_len) {
+            return REASM_INVALID;
+        }
+
+        net->l3_proto = AF_INET;
+        memcpy(&net->addr_src.ipv4, pkt + 12, sizeof(net->addr_src.ipv4));
+        memcpy(&net->addr_dst.ipv4, pkt + 16, sizeof(net->addr_dst.ipv4));
+        l4_proto = pkt[9];
+        l4 = pkt + hdr_len;
+        l4_len = read_u16(pkt + 2) - hdr_len;
+
+        // More Fragments flag and Fragment Offset
+        const uint16_t frag = read_u16(pkt + 6);
+        if ((frag & 0x3FFFU) != 0) {
+            is_frag = true;
+            frag_more = (frag & 0x2000U) != 0;
+            frag_offset = (frag & 0x1FFFU) * 8U;
+            key.id = read_u16(pkt + 4);
+        }
+        break;
+    }
+    case 6: { // IPv6
+        if (pkt_len < IPV6_HDR_LEN || IPV6_HDR_LEN + read_u16(pkt + 4) > pkt_len) {
+            return REASM_INVALID;
+        }
+
+        net->l3_proto = AF_INET6;
+        memcpy(&net->addr_src.ipv6, pkt + 8, sizeof(net->addr_src.ipv6));
+        memcpy(&net->addr_dst.ipv6, pkt + 24, sizeof(net->addr_dst.ipv6));
+        l4_proto = pkt[6];
+        l4 = pkt + IPV6_HDR_LEN;
+        l4_len = read_u16(pkt + 4);
+
+        // Only the Fragment extension header is expected (other headers are not supported)
+        if (l4_proto == IPPROTO_FRAGMENT) {
+            if (l4_len < IPV6_FRAG_LEN) {
+                return REASM_INVALID;
+            }
+
+            l4_proto = l4[0];
+            frag_offset = read_u16(l4 + 2) & 0xFFF8U;
+            frag_more = (read_u16(l4 + 2) & 0x0001U) != 0;
+            is_frag = (frag_offset != 0 || frag_more); // Ignore atomic fragments
+            key.id = read_u32(l4 + 4);
+            l4 += IPV6_FRAG_LEN;
+            l4_len -= IPV6_FRAG_LEN;
+        }
+        break;
+    }
+    default:
+        return REASM_IGNORED;
+    }
+
+    if (l4_proto != IPPROTO_UDP) {
+        return REASM_IGNORED;
+    }
+
+    if (is_frag) {
+        key.l3_proto = net->l3_proto;
+        key.l4_proto = l4_proto;
+        memcpy(&key.addr_src, &net->addr_src, sizeof(key.addr_src));
+        memcpy(&key.addr_dst, &net->addr_dst, sizeof(key.addr_dst));
+
+        enum reasm_status status = reasm_add(reasm, &key, now, frag_offset, l4, l4_len,
+            frag_more, &l4, &l4_len);
+        if (status != REASM_DONE) {
+            return status;
+        }
+    }
+
+    // UDP header
+    if (l4_len < UDP_HDR_LEN) {
+        return REASM_INVALID;
+    }
+
+    const uint32_t udp_len = read_u16(l4 + 4);
+    if (udp_len < UDP_HDR_LEN || udp_len > l4_len) {
+        return REASM_INVALID;
+    }
+
+    net->port_src = read_u16(l4);
+    net->port_dst = read_u16(l4 + 2);
+    *payload = l4 + UDP_HDR_LEN;
+    *payload_size = udp_len - UDP_HDR_LEN;
+    return REASM_DONE;
+}
@@ -0,0 +1,156 @@
+/**
+ * \file src/plugins/input/common/reasm.h
+ * \brief Decoding of UDP datagrams and reassembly of fragmented IP datagrams (header file)
+ * \date 2026
+ */
+
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#ifndef REASM_H
+#define REASM_H
+
+#include <ipfixcol2.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <netinet/in.h>
+
+/** Max size of a reassembled payload of an IP datagram [bytes]                                  */
+#define REASM_SIZE_MAX (65535U)
+
+/**
+ * \brief Identification of a fragmented IP datagram
+ * \warning The structure is compared as a block of memory, therefore, it MUST be zeroed before
+ *   it is filled (e.g. by memset())!
+ */
+struct reasm_key {
+    /** L3 Protocol type (AF_INET6 or AF_INET)                                                  */
+    uint8_t l3_proto;
+    /** L4 Protocol (i.e. Protocol/Next Header of the fragmented payload)                        */
+    uint8_t l4_proto;
+    /** Identification of the datagram (16 bits for IPv4, 32 bits for IPv6)                     */
+    uint32_t id;
+
+    union {
+        struct in6_addr ipv6;  /**< IPv6 address (l3_proto == AF_INET6)                          */
+        struct in_addr  ipv4;  /**< IPv4 address (l3_proto == AF_INET)                           */
+    } addr_src;                /**< Source IP address                                            */
+
+    union {
+        struct in6_addr ipv6;  /**< IPv6 address (l3_proto == AF_INET6)                          */
+        struct in_addr  ipv4;  /**< IPv4 address (l3_proto == AF_INET)                           */
+    } addr_dst;                /**< Destination IP address                                       */
+};
+
+/** Result of adding a fragment                                                                  */
+enum reasm_status {
+    /** The datagram is complete (the payload is available)                                      */
+    REASM_DONE,
+    /** More fragments of the datagram are required                                              */
+    REASM_MORE,
+    /** The fragment is malformed (or memory allocation failed) and the datagram was dropped     */
+    REASM_INVALID,
+    /** The packet doesn't contain a UDP datagram (see reasm_udp())                              */
+    REASM_IGNORED
+};
+
+/** Internal reassembly structure                                                                */
+typedef struct reasm reasm_t;
+
+/**
+ * \brief Create a new reassembly structure
+ *
+ * The structure holds at most \p cnt datagrams at the same time. If a fragment of a new datagram
+ * is added and there is no free slot, the least recently updated datagram is dropped.
+ * \param[in] cnt     Max number of datagrams reassembled concurrently
+ * \param[in] timeout Number of time units without any fragment after which an incomplete
+ *   datagram is dropped
+ * \return Pointer to the structure or NULL (memory allocation error)
+ */
+reasm_t *
+reasm_create(unsigned int cnt, uint64_t timeout);
+
+/**
+ * \brief Destroy a reassembly structure (including incomplete datagrams)
+ * \param[in] reasm Reassembly structure
+ */
+void
+reasm_destroy(reasm_t *reasm);
+
+/**
+ * \brief Add a fragment of an IP datagram
+ *
+ * If the fragment completes the datagram, the reassembled payload is returned. The payload
+ * is valid only until the next call of the function.
+ * \param[in]  reasm  Reassembly structure
+ * \param[in]  key    Identification of the datagram
+ * \param[in]  now    Current time (the same units as the timeout)
+ * \param[in]  offset Offset of the fragment in the payload [bytes]
+ * \param[in]  data   Data of the fragment
+ * \param[in]  size   Size of the fragment [bytes]
+ * \param[in]  more   More fragments follow (i.e. it is not the last fragment)
+ * \param[out] payload Reassembled payload (only if #REASM_DONE is returned)
+ * \param[out] payload_size Size of the reassembled payload (only if #REASM_DONE is returned)
+ * \return #REASM_DONE, #REASM_MORE or #REASM_INVALID (see ::reasm_status)
+ */
+enum reasm_status
+reasm_add(reasm_t *reasm, const struct reasm_key *key, uint64_t now, uint32_t offset,
+    const uint8_t *data, uint32_t size, bool more, const uint8_t **payload,
+    uint32_t *payload_size);
+
+/**
+ * \brief Get a UDP datagram from an IP packet
+ *
+ * The packet must start with IPv4 or IPv6 header. If the packet is a fragment of a UDP datagram,
+ * it is added to the reassembly structure and the datagram is returned as soon as all its
+ * fragments have been added. Only the Fragment extension header is supported in IPv6 packets.
+ * The returned payload is valid until the next call of reasm_add() or reasm_udp().
+ * \param[in]  reasm   Reassembly structure
+ * \param[in]  pkt     IP packet (i.e. starting with the network header)
+ * \param[in]  pkt_len Length of the packet
+ * \param[in]  now     Current time (the same units as the timeout of the reassembly structure)
+ * \param[out] net     Addresses and ports of the datagram (unused bytes are zeroed)
+ * \param[out] payload UDP payload
+ * \param[out] payload_size Size of the UDP payload
+ * \return #REASM_DONE if the datagram is available (all output parameters are filled)
+ * \return #REASM_MORE if the packet is a fragment and more fragments are required
+ * \return #REASM_IGNORED if the packet is not an IPv4/IPv6 packet with a UDP datagram
+ * \return #REASM_INVALID if the packet or the datagram is malformed
+ */
+enum reasm_status
+reasm_udp(reasm_t *reasm, const uint8_t *pkt, uint32_t pkt_len, uint64_t now,
+    struct ipx_session_net *net, const uint8_t **payload, uint32_t *payload_size);
+
+#endif // REASM_H
@@ -0,0 +1,278 @@
+/**
+ * \file src/plugins/input/packet/config.c
+ * \brief Configuration parser of packet input plugin (source file)
+ * \date 2026
+ */
+
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include "config.h"
+
+/** Minimal connection timeout                                                                   */
+#define CONN_TIMEOUT_MIN (10)
+/** Default connection timeout                                                                   */
+#define CONN_TIMEOUT_DEF (600)
+/** Default Template Lifetime                                                                    */
+#define LIFETIME_DATA_DEF (1800)
+/** Default Options Template Lifetime                                                            */
+#define LIFETIME_OPTS_DEF (1800)
+/** Minimal size of a block of the capture ring (must fit the largest IP packet) [KiB]         */
+#define BLOCK_SIZE_MIN (128)
+/** Default size of a block of the capture ring [KiB]                                            */
+#define BLOCK_SIZE_DEF (1024)
+/** Maximal size of a block of the capture ring [KiB]                                            */
+#define BLOCK_SIZE_MAX (65536)
+/** Minimal number of blocks of the capture ring                                                 */
+#define BLOCK_CNT_MIN (2)
+/** Default number of blocks of the capture ring                                                 */
+#define BLOCK_CNT_DEF (32)
+/** Maximal number of blocks of the capture ring                                                 */
+#define BLOCK_CNT_MAX (4096)
+/** Default timeout of a partially filled block [milliseconds]                                   */
+#define BLOCK_TIMEOUT_DEF (10)
+/** Maximal timeout of a partially filled block [milliseconds]                                   */
+#define BLOCK_TIMEOUT_MAX (1000)
+
+/*
+ * <params>
+ *  <interface>...</interface>                    <!-- mandatory                 -->
+ *  <localPort>...</localPort>                    <!-- optional                  -->
+ *  <templateLifeTime>...</templateLifeTime>      <!-- optional                  -->
+ *  <optionsTemplateLifeTime>...</optionsTemplateLifeTime> <!-- optional         -->
+ *  <connectionTimeout>...</connectionTimeout>    <!-- optional                  -->
+ *  <blockSize>...</blockSize>                    <!-- optional                  -->
+ *  <blockCount>...</blockCount>                  <!-- optional                  -->
+ *  <blockTimeout>...</blockTimeout>              <!-- optional                  -->
+ * </params>
+ */
+
+/** XML nodes */
+enum params_xml_nodes {
+    NODE_IFC = 1,
+    NODE_PORT,
+    NODE_LT_DATA,
+    NODE_LT_OPTS,
+    NODE_TIMEOUT,
+    NODE_BLOCK_SIZE,
+    NODE_BLOCK_CNT,
+    NODE_BLOCK_TIMEOUT
+};
+
+/** Definition of the \<params\> node  */
+static const struct fds_xml_args args_params[] = {
+    FDS_OPTS_ROOT("params"),
+    FDS_OPTS_ELEM(NODE_IFC,           "interface",               FDS_OPTS_T_STRING, 0),
+    FDS_OPTS_ELEM(NODE_PORT,          "localPort",               FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(NODE_LT_DATA,       "templateLifeTime",        FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(NODE_LT_OPTS,       "optionsTemplateLifeTime", FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(NODE_TIMEOUT,       "connectionTimeout",       FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(NODE_BLOCK_SIZE,    "blockSize",               FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(NODE_BLOCK_CNT,     "blockCount",              FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(NODE_BLOCK_TIMEOUT, "blockTimeout",            FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
+    FDS_OPTS_END
+};
+
+/**
+ * \brief Process \<params\> node
+ * \param[in] ctx  Plugin context
+ * \param[in] root XML context to process
+ * \param[in] cfg  Parsed configuration
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_FORMAT in case of failure
+ */
+static int
+config_parser_root(ipx_ctx_t *ctx, fds_xml_ctx_t *root, struct packet_config *cfg)
+{
+    const struct fds_xml_cont *content;
+    while (fds_xml_next(root, &content) != FDS_EOC) {
+        switch (content->id) {
+        case NODE_IFC:
+            // Network interface
+            assert(content->type == FDS_OPTS_T_STRING);
+            if (strlen(content->ptr_string) == 0
+                    || strlen(content->ptr_string) >= sizeof(cfg->ifc_name)) {
+                IPX_CTX_ERROR(ctx, "Name of the network interface is empty or too long!", '\0');
+                return IPX_ERR_FORMAT;
+            }
+            strcpy(cfg->ifc_name, content->ptr_string);
+            break;
+        case NODE_PORT:
+            // Local port
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint < 1 || content->val_uint > UINT16_MAX) {
+                IPX_CTX_ERROR(ctx, "Local port value must be between 1..%" PRIu16, UINT16_MAX);
+                return IPX_ERR_FORMAT;
+            }
+            cfg->local_port = (uint16_t) content->val_uint;
+            break;
+        case NODE_LT_DATA:
+            // Template Lifetime
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint > UINT16_MAX) {
+                IPX_CTX_ERROR(ctx, "Template Lifetime must be between 0..%" PRIu16, UINT16_MAX);
+                return IPX_ERR_FORMAT;
+            }
+            cfg->lifetime_data = (uint16_t) content->val_uint;
+            break;
+        case NODE_LT_OPTS:
+            // Options Template Lifetime
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint > UINT16_MAX) {
+                IPX_CTX_ERROR(ctx, "Options Template Lifetime must be between 0..%" PRIu16,
+                    UINT16_MAX);
+                return IPX_ERR_FORMAT;
+            }
+            cfg->lifetime_opts = (uint16_t) content->val_uint;
+            break;
+        case NODE_TIMEOUT:
+            // Connection timeout
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint < CONN_TIMEOUT_MIN || content->val_uint > UINT16_MAX) {
+                IPX_CTX_ERROR(ctx, "Connection timeout must be between %" PRIu16 "..%" PRIu16,
+                    (uint16_t) CONN_TIMEOUT_MIN, UINT16_MAX);
+                return IPX_ERR_FORMAT;
+            }
+            cfg->timeout_conn = (uint16_t) content->val_uint;
+            break;
+        case NODE_BLOCK_SIZE:
+            // Size of a ring block (power of two, always a multiple of the page size)
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint < BLOCK_SIZE_MIN || content->val_uint > BLOCK_SIZE_MAX
+                    || (content->val_uint & (content->val_uint - 1)) != 0) {
+                IPX_CTX_ERROR(ctx, "Block size must be a power of two between %d..%d KiB",
+                    BLOCK_SIZE_MIN, BLOCK_SIZE_MAX);
+                return IPX_ERR_FORMAT;
+            }
+            cfg->block_size = (uint32_t) content->val_uint * 1024U;
+            break;
+        case NODE_BLOCK_CNT:
+            // Number of ring blocks
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint < BLOCK_CNT_MIN || content->val_uint > BLOCK_CNT_MAX) {
+                IPX_CTX_ERROR(ctx, "Block count must be between %d..%d", BLOCK_CNT_MIN,
+                    BLOCK_CNT_MAX);
+                return IPX_ERR_FORMAT;
+            }
+            cfg->block_cnt = (uint32_t) content->val_uint;
+            break;
+        case NODE_BLOCK_TIMEOUT:
+            // Timeout of a partially filled block
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint < 1 || content->val_uint > BLOCK_TIMEOUT_MAX) {
+                IPX_CTX_ERROR(ctx, "Block timeout must be between 1..%d ms", BLOCK_TIMEOUT_MAX);
+                return IPX_ERR_FORMAT;
+            }
+            cfg->block_timeout = (uint32_t) content->val_uint;
+            break;
+        default:
+            // Internal error
+            assert(false);
+        }
+    }
+
+    return IPX_OK;
+}
+
+/**
+ * \brief Set default parameters of the configuration
+ * \param[in] cfg Configuration
+ */
+static void
+config_default_set(struct packet_config *cfg)
+{
+    cfg->local_port = 4739; // Default port
+    cfg->timeout_conn = CONN_TIMEOUT_DEF;
+    cfg->lifetime_data = LIFETIME_DATA_DEF;
+    cfg->lifetime_opts = LIFETIME_OPTS_DEF;
+    cfg->block_size = BLOCK_SIZE_DEF * 1024U;
+    cfg->block_cnt = BLOCK_CNT_DEF;
+    cfg->block_timeout = BLOCK_TIMEOUT_DEF;
+}
+
+struct packet_config *
+config_parse(ipx_ctx_t *ctx, const char *params)
+{
+    struct packet_config *cfg = calloc(1, sizeof(*cfg));
+    if (!cfg) {
+        IPX_CTX_ERROR(ctx, "Memory allocation error (%s:%d)", __FILE__, __LINE__);
+        return NULL;
+    }
+
+    // Set default parameters
+    config_default_set(cfg);
+
+    // Create an XML parser
+    fds_xml_t *parser = fds_xml_create();
+    if (!parser) {
+        IPX_CTX_ERROR(ctx, "Memory allocation error (%s:%d)", __FILE__, __LINE__);
+        config_destroy(cfg);
+        return NULL;
+    }
+
+    if (fds_xml_set_args(parser, args_params) != IPX_OK) {
+        IPX_CTX_ERROR(ctx, "Failed to parse the description of an XML document!", '\0');
+        fds_xml_destroy(parser);
+        config_destroy(cfg);
+        return NULL;
+    }
+
+    fds_xml_ctx_t *params_ctx = fds_xml_parse_mem(parser, params, true);
+    if (params_ctx == NULL) {
+        IPX_CTX_ERROR(ctx, "Failed to parse the configuration: %s", fds_xml_last_err(parser));
+        fds_xml_destroy(parser);
+        config_destroy(cfg);
+        return NULL;
+    }
+
+    // Parse parameters
+    int rc = config_parser_root(ctx, params_ctx, cfg);
+    fds_xml_destroy(parser);
+    if (rc != IPX_OK) {
+        config_destroy(cfg);
+        return NULL;
+    }
+
+    return cfg;
+}
+
+void
+config_destroy(struct packet_config *cfg)
+{
+    free(cfg);
+}
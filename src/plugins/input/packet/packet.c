@@ -0,0 +1,823 @@
+/**
+ * \file src/plugins/input/packet/packet.c
+ * \brief Packet capture (TPACKET_V3) input plugin for IPFIXcol 2
+ * \date 2026
+ */
+
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include <ipfixcol2.h>
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/mman.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <net/if.h>
+#include <linux/if_ether.h>
+#include <linux/if_packet.h>
+#include <linux/filter.h>
+#include <poll.h>
+#include <time.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <inttypes.h>
+#include "config.h"
+#include "input_common.h"
+#include "reasm.h"
+
+/** Identification of an invalid socket descriptor                                               */
+#define INVALID_FD        (-1)
+/** Timeout for a getter operation - i.e. poll timeout [in milliseconds]                         */
+#define GETTER_TIMEOUT    (10)
+/** Number of seconds between timer events (inactive sessions, statistics) [seconds]             */
+#define TIMER_INTERVAL    (2)
+/** Max number of IP datagrams reassembled concurrently                                          */
+#define REASM_CNT         (64)
+/** Timeout of an incomplete IP datagram [seconds]                                               */
+#define REASM_TIMEOUT     (5)
+/** Default size of the hash table of active sources (must be a power of two)                    */
+#define ACTIVE_DEF_SIZE   (64)
+
+/** Plugin description */
+IPX_API struct ipx_plugin_info ipx_plugin_info = {
+    // Plugin type
+    .type = IPX_PT_INPUT,
+    // Plugin identification name
+    .name = "packet",
+    // Brief description of plugin
+    .dsc = "Input plugin for IPFIX/NetFlow v5/v9 over UDP captured from a network interface.",
+    // Configuration flags (reserved for future use)
+    .flags = 0,
+    // Plugin version string (like "1.2.3")
+    .version = "2.0.0",
+    // Minimal IPFIXcol version string (like "1.2.3")
+    .ipx_min = "2.3.0"
+};
+
+/**
+ * \brief Description of a UDP Transport Session
+ * \note The identification must be the first member (see input_net_eq())
+ */
+struct packet_source {
+    /** Identification of the Session (addresses and ports, unused bytes are always zeroed)     */
+    struct ipx_session_net net;
+    /** Hash of the identification                                                               */
+    uint64_t hash;
+
+    /** Description of  the Transport Session                                                    */
+    struct ipx_session *session;
+
+    /** Time when the source was last seen [seconds]                                             */
+    uint64_t last_seen;
+    /** More recently active source (NULL if this is the most recently active one)              */
+    struct packet_source *lru_prev;
+    /** Less recently active source (NULL if this is the least recently active one)             */
+    struct packet_source *lru_next;
+    /** No message has been received from the Session yet                                        */
+    bool new_connection;
+};
+
+/** Instance data                                                                                */
+struct packet_data {
+    /** Parsed configuration parameters                                                          */
+    struct packet_config *config;
+    /** Instance context                                                                         */
+    ipx_ctx_t *ctx;
+    /** Current time (monotonic clock updated by the getter) [seconds]                           */
+    uint64_t now;
+    /** Time of the last timer event [seconds]                                                   */
+    uint64_t timer_last;
+
+    struct {
+        /** Packet socket (#INVALID_FD if not valid)                                             */
+        int fd;
+        /** Memory mapped ring of blocks (NULL if not mapped)                                    */
+        uint8_t *map;
+        /** Size of a block                                                                      */
+        size_t block_size;
+        /** Number of blocks                                                                     */
+        unsigned int block_cnt;
+        /** Index of the next block to process                                                   */
+        unsigned int block_idx;
+    } ring; /**< Capture ring                                                                    */
+
+    struct {
+        /** Hash table of active sources (items are struct packet_source)                        */
+        struct ipx_htable table;
+        /** The most recently active source                                                      */
+        struct packet_source *lru_head;
+        /** The least recently active source                                                     */
+        struct packet_source *lru_tail;
+    } active; /**< Active connections                                                            */
+
+    /** Reassembly of fragmented datagrams                                                       */
+    reasm_t *reasm;
+    /** Number of malformed packets since the last timer event                                  */
+    uint64_t invalid_cnt;
+
+    /** Messages to pass                                                                         */
+    struct input_pass pass;
+};
+
+// -------------------------------------------------------------------------------------------------
+
+/**
+ * \brief Remove a source from the list of sources ordered by their last activity
+ * \param[in] instance Instance data
+ * \param[in] src      Source to remove
+ */
+static inline void
+lru_unlink(struct packet_data *instance, struct packet_source *src)
+{
+    if (src->lru_prev != NULL) {
+        src->lru_prev->lru_next = src->lru_next;
+    } else {
+        instance->active.lru_head = src->lru_next;
+    }
+
+    if (src->lru_next != NULL) {
+        src->lru_next->lru_prev = src->lru_prev;
+    } else {
+        instance->active.lru_tail = src->lru_prev;
+    }
+
+    src->lru_prev = NULL;
+    src->lru_next = NULL;
+}
+
+/**
+ * \brief Mark a source as active now
+ *
+ * The source is moved to the head of the list of sources ordered by their last activity.
+ * Therefore, inactive sources are always at the tail of the list.
+ * \param[in] instance Instance data
+ * \param[in] src      Source
+ */
+static inline void
+lru_touch(struct packet_data *instance, struct packet_source *src)
+{
+    src->last_seen = instance->now;
+    if (instance->active.lru_head == src) {
+        return;
+    }
+
+    if (src->lru_prev != NULL || instance->active.lru_tail == src) {
+        lru_unlink(instance, src);
+    }
+
+    src->lru_next = instance->active.lru_head;
+    if (src->lru_next != NULL) {
+        src->lru_next->lru_prev = src;
+    } else {
+        instance->active.lru_tail = src;
+    }
+    instance->active.lru_head = src;
+}
+
+/**
+ * \brief Add a new record of a Transport Session
+ * \param[in] instance Instance data
+ * \param[in] net      Identification of the source (unused bytes must be zeroed)
+ * \param[in] hash     Hash of the source identification (see input_net_hash())
+ * \return Pointer to the newly added record or NULL (memory allocation error)
+ */
+static struct packet_source *
+active_add(struct packet_data *instance, const struct ipx_session_net *net, uint64_t hash)
+{
+    char src_addr_str[INET6_ADDRSTRLEN] = {0};
+    inet_ntop(net->l3_proto, &net->addr_src, src_addr_str, INET6_ADDRSTRLEN);
+
+    const struct packet_config *cfg = instance->config;
+    struct ipx_session *session = ipx_session_new_udp(net, cfg->lifetime_data, cfg->lifetime_opts);
+    if (!session) {
+        IPX_CTX_ERROR(instance->ctx, "Failed to create a Transport Session description of %s.",
+            src_addr_str);
+        return NULL;
+    }
+
+    // Create a new record
+    struct packet_source *rec2add = calloc(1, sizeof(*rec2add));
+    if (!rec2add) {
+        IPX_CTX_ERROR(instance->ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+        ipx_session_destroy(session);
+        return NULL;
+    }
+
+    rec2add->net = *net;
+    rec2add->hash = hash;
+    rec2add->session = session;
+    rec2add->new_connection = true; // Session Message hasn't been send yet
+
+    // Insert into the table of active connections
+    if (ipx_htable_reserve(&instance->active.table) != IPX_OK) {
+        IPX_CTX_ERROR(instance->ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+        free(rec2add);
+        ipx_session_destroy(session);
+        return NULL;
+    }
+
+    IPX_CTX_INFO(instance->ctx, "New exporter connected from '%s'.", src_addr_str);
+    ipx_htable_insert(&instance->active.table, hash, rec2add);
+    lru_touch(instance, rec2add);
+    return rec2add;
+}
+
+/**
+ * \brief Remove an active Transport Session
+ *
+ * Prepare a Session Message - close event (if necessary) and remove the corresponding
+ * session from the table of active connections.
+ * \param[in] instance Instance data
+ * \param[in] src      Source to remove
+ */
+static void
+active_remove(struct packet_data *instance, struct packet_source *src)
+{
+    IPX_CTX_INFO(instance->ctx, "Transport Session '%s' closed!", src->session->ident);
+
+    // Have we received at least one valid record?
+    if (src->new_connection) {
+        // No messages have been passed with a reference to this session -> destroy immediately
+        ipx_session_destroy(src->session);
+    } else {
+        // Generate a Session message (order of the messages MUST be preserved)
+        ipx_msg_session_t *msg_sess = ipx_msg_session_create(src->session, IPX_MSG_SESSION_CLOSE);
+        if (!msg_sess) {
+            IPX_CTX_WARNING(instance->ctx, "Failed to create a Session message! Instances of "
+                "plugins will not be informed about the closed Transport Session '%s' (%s:%d)",
+                src->session->ident, __FILE__, __LINE__);
+            // Do not free the session structure because it still can be used by other plugins
+        } else {
+            // Pass the message and put the Session into the garbage
+            input_pass_add(&instance->pass, ipx_msg_session2base(msg_sess));
+
+            ipx_msg_garbage_cb cb = (ipx_msg_garbage_cb) &ipx_session_destroy;
+            ipx_msg_garbage_t *msg_garbage = ipx_msg_garbage_create(src->session, cb);
+            if (!msg_garbage) {
+                IPX_CTX_ERROR(instance->ctx, "Memory allocation failed! (%s:%d)", __FILE__,
+                    __LINE__);
+            } else {
+                input_pass_add(&instance->pass, ipx_msg_garbage2base(msg_garbage));
+            }
+        }
+    }
+
+    // Now we can free the wrapper
+    lru_unlink(instance, src);
+    struct ipx_htable_slot *slot = ipx_htable_find_item(&instance->active.table, src->hash, src);
+    assert(slot != NULL && "The source must be present!");
+    ipx_htable_remove(&instance->active.table, slot);
+    free(src);
+}
+
+/**
+ * \brief Get a reference to a Transport Session
+ *
+ * First, try to find in among already active Transport Sessions. If it is not present, create
+ * a new one and store it into the table of active Sessions. The Session is marked as active.
+ * \param[in] instance Instance data
+ * \param[in] net      Identification of the source (unused bytes must be zeroed)
+ * \return Pointer to the Session or NULL (typically memory allocation error)
+ */
+static struct packet_source *
+active_get(struct packet_data *instance, const struct ipx_session_net *net)
+{
+    const uint64_t hash = input_net_hash(net);
+    struct ipx_htable_slot *slot = ipx_htable_find(&instance->active.table, hash, &input_net_eq,
+        net);
+    if (slot != NULL) {
+        struct packet_source *src = slot->item;
+        lru_touch(instance, src);
+        return src;
+    }
+
+    // Not found, add a new record
+    return active_add(instance, net, hash);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+/**
+ * \brief Process a NetFlow/IPFIX message (i.e. payload of a UDP datagram)
+ *
+ * Check the message header and extract ODID/Source ID. If it is the first valid message of the
+ * Transport Session, a Session message is prepared first. The message is copied into a buffer
+ * from the pool of the instance, wrapped and added to the messages to pass.
+ * \param[in] instance Instance data
+ * \param[in] source   Source of the message
+ * \param[in] data     Message
+ * \param[in] msg_size Size of the message
+ */
+static void
+process_message(struct packet_data *instance, struct packet_source *source, const uint8_t *data,
+    uint16_t msg_size)
+{
+    // Check NetFlow/IPFIX header length and extract ODID/Source ID
+    uint32_t msg_odid;
+    if (!input_msg_check(data, msg_size, false, &msg_odid)) {
+        IPX_CTX_ERROR(instance->ctx, "Receiver an invalid NetFlow/IPFIX Message header from '%s'. "
+            "The message will be dropped!", source->session->ident);
+        return;
+    }
+
+    uint8_t *buffer = ipx_msg_ipfix_buffer_alloc(instance->ctx, msg_size);
+    if (!buffer) {
+        IPX_CTX_ERROR(instance->ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+        return;
+    }
+    memcpy(buffer, data, msg_size);
+
+    if (source->new_connection) {
+        // Send information about the new Transport Session
+        source->new_connection = false;
+        ipx_msg_session_t *msg = ipx_msg_session_create(source->session, IPX_MSG_SESSION_OPEN);
+        if (!msg) {
+            IPX_CTX_WARNING(instance->ctx, "Failed to create a Session message! Instances of "
+                "plugins will not be informed about the new Transport Session '%s' (%s:%d).",
+                source->session->ident, __FILE__, __LINE__);
+        } else {
+            input_pass_add(&instance->pass, ipx_msg_session2base(msg));
+        }
+    }
+
+    // Create a message wrapper and pass the message
+    struct ipx_msg_ctx msg_ctx;
+    msg_ctx.session = source->session;
+    msg_ctx.odid = msg_odid;
+    msg_ctx.stream = 0; // Streams are not supported over UDP
+
+    ipx_msg_ipfix_t *msg = ipx_msg_ipfix_create(instance->ctx, &msg_ctx, buffer, msg_size);
+    if (!msg) {
+        IPX_CTX_ERROR(instance->ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+        ipx_msg_ipfix_buffer_free(instance->ctx, buffer);
+        return;
+    }
+
+    input_pass_add(&instance->pass, ipx_msg_ipfix2base(msg));
+}
+
+/**
+ * \brief Process a captured IP packet
+ *
+ * Reassemble fragmented datagrams and process the payload of UDP datagrams sent to the local
+ * port. Everything else is silently ignored. Malformed packets are only counted (see
+ * process_timer()).
+ * \param[in] instance Instance data
+ * \param[in] pkt      IP packet (i.e. starting with the network header)
+ * \param[in] pkt_len  Length of the packet
+ */
+static void
+process_packet(struct packet_data *instance, const uint8_t *pkt, uint32_t pkt_len)
+{
+    struct ipx_session_net net;
+    const uint8_t *payload;
+    uint32_t payload_size;
+
+    switch (reasm_udp(instance->reasm, pkt, pkt_len, instance->now, &net, &payload,
+            &payload_size)) {
+    case REASM_DONE:
+        break;
+    case REASM_INVALID:
+        instance->invalid_cnt++;
+        return;
+    default:
+        return;
+    }
+
+    if (net.port_dst != instance->config->local_port) {
+        return; // Other traffic (e.g. fragments of unrelated datagrams)
+    }
+
+    if (payload_size < sizeof(uint16_t) || payload_size > UINT16_MAX) {
+        instance->invalid_cnt++;
+        return;
+    }
+
+    struct packet_source *source = active_get(instance, &net);
+    if (!source) { // Memory allocation error!
+        return;
+    }
+
+    process_message(instance, source, payload, (uint16_t) payload_size);
+}
+
+/**
+ * \brief Process all packets of a block of the capture ring
+ *
+ * Packets sent by the host itself (e.g. captured on the loopback interface twice) are skipped.
+ * \param[in] instance Instance data
+ * \param[in] block    Block of the ring (owned by the plugin)
+ */
+static void
+process_block(struct packet_data *instance, const struct tpacket_block_desc *block)
+{
+    const uint32_t pkt_cnt = block->hdr.bh1.num_pkts;
+    const uint8_t *ptr = (const uint8_t *) block + block->hdr.bh1.offset_to_first_pkt;
+
+    for (uint32_t i = 0; i < pkt_cnt; ++i) {
+        const struct tpacket3_hdr *hdr = (const struct tpacket3_hdr *) ptr;
+        const struct sockaddr_ll *sll = (const struct sockaddr_ll *)
+            (ptr + TPACKET_ALIGN(sizeof(struct tpacket3_hdr)));
+
+        if (sll->sll_pkttype != PACKET_OUTGOING) {
+            if (hdr->tp_snaplen != hdr->tp_len) {
+                instance->invalid_cnt++; // Truncated packet
+            } else {
+                const uint32_t net_offset = hdr->tp_net - hdr->tp_mac;
+                process_packet(instance, ptr + hdr->tp_net, hdr->tp_snaplen - net_offset);
+            }
+        }
+
+        ptr += hdr->tp_next_offset;
+    }
+}
+
+/**
+ * \brief Process a timer event
+ *
+ * Close inactive Transport Sessions and report packets dropped by the kernel (i.e. the capture
+ * ring was full) and malformed packets since the last event.
+ * \param[in] instance Instance data
+ */
+static void
+process_timer(struct packet_data *instance)
+{
+    instance->timer_last = instance->now;
+
+    // Close inactive Transport Sessions (the least recently active are at the tail)
+    const uint64_t timeout = instance->config->timeout_conn;
+    struct packet_source *src;
+    while ((src = instance->active.lru_tail) != NULL && src->last_seen + timeout < instance->now) {
+        active_remove(instance, src);
+    }
+
+    // Statistics of the socket are reset by each read
+    struct tpacket_stats_v3 stats;
+    socklen_t stats_len = sizeof(stats);
+    if (getsockopt(instance->ring.fd, SOL_PACKET, PACKET_STATISTICS, &stats, &stats_len) == 0
+            && stats.tp_drops > 0) {
+        IPX_CTX_WARNING(instance->ctx, "%u packet(s) dropped by the kernel because the capture "
+            "ring was full. Consider increasing its size.", stats.tp_drops);
+    }
+
+    if (instance->invalid_cnt > 0) {
+        IPX_CTX_WARNING(instance->ctx, "%" PRIu64 " malformed packet(s) dropped.",
+            instance->invalid_cnt);
+        instance->invalid_cnt = 0;
+    }
+
+    IPX_CTX_DEBUG(instance->ctx, "The instance holds information about %zu active session(s).",
+        instance->active.table.used);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+/**
+ * \brief Attach a filter of NetFlow/IPFIX packets to a packet socket
+ *
+ * The filter accepts only UDP datagrams (over IPv4/IPv6) sent to the local port and all
+ * fragments of UDP datagrams that might belong to them (only the first fragment contains
+ * the port number). Offsets are relative to the network header (i.e. SOCK_DGRAM).
+ * \param[in] sd   Packet socket
+ * \param[in] port Local port
+ * \return 0 on success, -1 otherwise (errno is set appropriately)
+ */
+static int
+ring_filter(int sd, uint16_t port)
+{
+    struct sock_filter code[] = {
+        // A = version of the IP header
+        BPF_STMT(BPF_LD  | BPF_B   | BPF_ABS, 0),                  //  0
+        BPF_STMT(BPF_ALU | BPF_RSH | BPF_K,   4),                  //  1
+        BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K,   4, 0, 7),            //  2: IPv4 or goto 10
+        // IPv4: UDP only, non-first fragments are accepted, otherwise check the port
+        BPF_STMT(BPF_LD  | BPF_B   | BPF_ABS, 9),                  //  3
+        BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K,   IPPROTO_UDP, 0, 12), //  4: UDP or drop
+        BPF_STMT(BPF_LD  | BPF_H   | BPF_ABS, 6),                  //  5
+        BPF_JUMP(BPF_JMP | BPF_JSET | BPF_K,  0x1FFF, 9, 0),       //  6: fragment -> accept
+        BPF_STMT(BPF_LDX | BPF_B   | BPF_MSH, 0),                  //  7: X = header length
+        BPF_STMT(BPF_LD  | BPF_H   | BPF_IND, 2),                  //  8
+        BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K,   port, 6, 7),         //  9: accept or drop
+        // IPv6: UDP (check the port) or Fragment header (accepted)
+        BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K,   6, 0, 6),            // 10: IPv6 or drop
+        BPF_STMT(BPF_LD  | BPF_B   | BPF_ABS, 6),                  // 11
+        BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K,   IPPROTO_FRAGMENT, 3, 0), // 12: accept
+        BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K,   IPPROTO_UDP, 0, 3),  // 13: UDP or drop
+        BPF_STMT(BPF_LD  | BPF_H   | BPF_ABS, 40 + 2),             // 14: after IPv6 header
+        BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K,   port, 0, 1),         // 15: accept or drop
+        BPF_STMT(BPF_RET | BPF_K,             UINT32_MAX),         // 16: accept
+        BPF_STMT(BPF_RET | BPF_K,             0)                   // 17: drop
+    };
+
+    struct sock_fprog prog;
+    prog.len = sizeof(code) / sizeof(code[0]);
+    prog.filter = code;
+    return setsockopt(sd, SOL_SOCKET, SO_ATTACH_FILTER, &prog, sizeof(prog));
+}
+
+/**
+ * \brief Create a packet socket with a memory mapped capture ring (TPACKET_V3)
+ *
+ * The socket is bound to the interface after the filter and the ring are ready, therefore,
+ * no unrelated packets are captured.
+ * \param[in] instance Instance data
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_DENIED on failure
+ */
+static int
+ring_init(struct packet_data *instance)
+{
+    const struct packet_config *cfg = instance->config;
+    const char *err_str;
+    instance->ring.fd = INVALID_FD;
+    instance->ring.map = NULL;
+
+    const unsigned int ifc_idx = if_nametoindex(cfg->ifc_name);
+    if (ifc_idx == 0) {
+        ipx_strerror(errno, err_str);
+        IPX_CTX_ERROR(instance->ctx, "Unable to find network interface '%s': %s",
+            cfg->ifc_name, err_str);
+        return IPX_ERR_DENIED;
+    }
+
+    // Protocol 0, i.e. no packets are received until the socket is bound
+    int sd = socket(AF_PACKET, SOCK_DGRAM, 0);
+    if (sd == -1) {
+        ipx_strerror(errno, err_str);
+        IPX_CTX_ERROR(instance->ctx, "Failed to create a packet socket (the CAP_NET_RAW "
+            "capability is required): %s", err_str);
+        return IPX_ERR_DENIED;
+    }
+    instance->ring.fd = sd;
+
+    if (ring_filter(sd, cfg->local_port) == -1) {
+        ipx_strerror(errno, err_str);
+        IPX_CTX_ERROR(instance->ctx, "Failed to attach a packet filter: %s", err_str);
+        return IPX_ERR_DENIED;
+    }
+
+    int version = TPACKET_V3;
+    if (setsockopt(sd, SOL_PACKET, PACKET_VERSION, &version, sizeof(version)) == -1) {
+        ipx_strerror(errno, err_str);
+        IPX_CTX_ERROR(instance->ctx, "Failed to enable TPACKET_V3: %s", err_str);
+        return IPX_ERR_DENIED;
+    }
+
+    // Frames have variable length in TPACKET_V3, the frame size is required only for validation
+    struct tpacket_req3 req;
+    memset(&req, 0, sizeof(req));
+    req.tp_block_size = cfg->block_size;
+    req.tp_block_nr = cfg->block_cnt;
+    req.tp_frame_size = TPACKET_ALIGNMENT << 7;
+    req.tp_frame_nr = (cfg->block_size / req.tp_frame_size) * cfg->block_cnt;
+    req.tp_retire_blk_tov = cfg->block_timeout;
+    if (setsockopt(sd, SOL_PACKET, PACKET_RX_RING, &req, sizeof(req)) == -1) {
+        ipx_strerror(errno, err_str);
+        IPX_CTX_ERROR(instance->ctx, "Failed to create a capture ring (%" PRIu32 " x %" PRIu32
+            " bytes): %s", cfg->block_cnt, cfg->block_size, err_str);
+        return IPX_ERR_DENIED;
+    }
+
+    const size_t map_size = (size_t) cfg->block_size * cfg->block_cnt;
+    void *map = mmap(NULL, map_size, PROT_READ | PROT_WRITE, MAP_SHARED, sd, 0);
+    if (map == MAP_FAILED) {
+        ipx_strerror(errno, err_str);
+        IPX_CTX_ERROR(instance->ctx, "Failed to map the capture ring: %s", err_str);
+        return IPX_ERR_DENIED;
+    }
+    instance->ring.map = map;
+    instance->ring.block_size = cfg->block_size;
+    instance->ring.block_cnt = cfg->block_cnt;
+    instance->ring.block_idx = 0;
+
+#ifdef PACKET_IGNORE_OUTGOING
+    // Optional (Linux 4.20+), outgoing packets are also skipped during processing
+    int on = 1;
+    setsockopt(sd, SOL_PACKET, PACKET_IGNORE_OUTGOING, &on, sizeof(on));
+#endif
+
+    struct sockaddr_ll addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sll_family = AF_PACKET;
+    addr.sll_protocol = htons(ETH_P_ALL);
+    addr.sll_ifindex = (int) ifc_idx;
+    if (bind(sd, (struct sockaddr *) &addr, sizeof(addr)) == -1) {
+        ipx_strerror(errno, err_str);
+        IPX_CTX_ERROR(instance->ctx, "Failed to bind the packet socket to interface '%s': %s",
+            cfg->ifc_name, err_str);
+        return IPX_ERR_DENIED;
+    }
+
+    IPX_CTX_INFO(instance->ctx, "Capturing on interface '%s' (port %" PRIu16 ", ring %" PRIu32
+        " x %" PRIu32 " KiB)", cfg->ifc_name, cfg->local_port, cfg->block_cnt,
+        cfg->block_size / 1024U);
+    return IPX_OK;
+}
+
+/**
+ * \brief Unmap the capture ring and close the packet socket
+ * \param[in] instance Instance data
+ */
+static void
+ring_destroy(struct packet_data *instance)
+{
+    if (instance->ring.map != NULL) {
+        munmap(instance->ring.map, instance->ring.block_size * instance->ring.block_cnt);
+        instance->ring.map = NULL;
+    }
+
+    if (instance->ring.fd != INVALID_FD) {
+        close(instance->ring.fd);
+        instance->ring.fd = INVALID_FD;
+    }
+}
+
+/**
+ * \brief Get a block of the capture ring
+ * \param[in] instance Instance data
+ * \param[in] idx      Index of the block
+ * \return Pointer to the block
+ */
+static inline struct tpacket_block_desc *
+ring_block(const struct packet_data *instance, unsigned int idx)
+{
+    return (struct tpacket_block_desc *) (instance->ring.map + idx * instance->ring.block_size);
+}
+
+/**
+ * \brief Check if a block of the capture ring is owned by the plugin
+ * \param[in] block Block of the ring
+ * \return True or false
+ */
+static inline bool
+ring_block_ready(struct tpacket_block_desc *block)
+{
+    return (__atomic_load_n(&block->hdr.bh1.block_status, __ATOMIC_ACQUIRE) & TP_STATUS_USER) != 0;
+}
+
+/**
+ * \brief Update the current time of the instance
+ * \param[in] instance Instance data
+ */
+static void
+time_update(struct packet_data *instance)
+{
+    struct timespec ts;
+    if (clock_gettime(CLOCK_MONOTONIC_COARSE, &ts) == 0) {
+        instance->now = (uint64_t) ts.tv_sec;
+    }
+}
+
+// -------------------------------------------------------------------------------------------------
+
+int
+ipx_plugin_init(ipx_ctx_t *ctx, const char *params)
+{
+    struct packet_data *data = calloc(1, sizeof(*data));
+    if (!data) {
+        IPX_CTX_ERROR(ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+        return IPX_ERR_DENIED;
+    }
+
+    data->ctx = ctx;
+    time_update(data);
+    data->timer_last = data->now;
+    input_pass_init(&data->pass, ctx);
+    data->reasm = reasm_create(REASM_CNT, REASM_TIMEOUT);
+    if (ipx_htable_init(&data->active.table, ACTIVE_DEF_SIZE) != IPX_OK || !data->reasm) {
+        IPX_CTX_ERROR(ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+        if (data->reasm) {
+            reasm_destroy(data->reasm);
+        }
+        ipx_htable_destroy(&data->active.table);
+        free(data);
+        return IPX_ERR_DENIED;
+    }
+
+    // Parse configuration
+    data->config = config_parse(ctx, params);
+    if (!data->config) {
+        reasm_destroy(data->reasm);
+        ipx_htable_destroy(&data->active.table);
+        free(data);
+        return IPX_ERR_DENIED;
+    }
+
+    // Create the capture ring
+    if (ring_init(data) != IPX_OK) {
+        ring_destroy(data);
+        config_destroy(data->config);
+        reasm_destroy(data->reasm);
+        ipx_htable_destroy(&data->active.table);
+        free(data);
+        return IPX_ERR_DENIED;
+    }
+
+    ipx_ctx_private_set(ctx, data);
+    return IPX_OK;
+}
+
+void
+ipx_plugin_destroy(ipx_ctx_t *ctx, void *cfg)
+{
+    (void) ctx;
+    struct packet_data *data = (struct packet_data *) cfg;
+    ring_destroy(data);
+
+    // Close all Transport Session (this generates Session messages per each active Session)
+    while (data->active.lru_head != NULL) {
+        active_remove(data, data->active.lru_head);
+    }
+    input_pass_flush(&data->pass);
+    assert(data->active.table.used == 0);
+    ipx_htable_destroy(&data->active.table);
+
+    reasm_destroy(data->reasm);
+    config_destroy(data->config);
+    free(data);
+}
+
+int
+ipx_plugin_get(ipx_ctx_t *ctx, void *cfg)
+{
+    struct packet_data *data = (struct packet_data *) cfg;
+    time_update(data);
+    if (data->now >= data->timer_last + TIMER_INTERVAL) {
+        process_timer(data);
+    }
+
+    if (!ring_block_ready(ring_block(data, data->ring.block_idx))) {
+        input_pass_flush(&data->pass);
+
+        // Wait for a block
+        struct pollfd pfd;
+        pfd.fd = data->ring.fd;
+        pfd.events = POLLIN | POLLERR;
+        pfd.revents = 0;
+        if (poll(&pfd, 1, GETTER_TIMEOUT) == -1) {
+            // Failed
+            int error_code = errno;
+            const char *err_str;
+            ipx_strerror(error_code, err_str);
+            IPX_CTX_ERROR(ctx, "poll() failed: %s", err_str);
+            if (error_code == EINTR) {
+                return IPX_OK;
+            }
+            // Fatal error -> stop the plugin
+            return IPX_ERR_DENIED;
+        }
+
+        return IPX_OK;
+    }
+
+    // Process all ready blocks (at most one round of the ring) and return them to the kernel
+    for (unsigned int i = 0; i < data->ring.block_cnt; ++i) {
+        struct tpacket_block_desc *block = ring_block(data, data->ring.block_idx);
+        if (!ring_block_ready(block)) {
+            break;
+        }
+
+        process_block(data, block);
+        __atomic_store_n(&block->hdr.bh1.block_status, TP_STATUS_KERNEL, __ATOMIC_RELEASE);
+        data->ring.block_idx = (data->ring.block_idx + 1) % data->ring.block_cnt;
+    }
+
+    input_pass_flush(&data->pass);
+    return IPX_OK;
+}
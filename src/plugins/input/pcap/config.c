@@ -0,0 +1,216 @@
+/**
+ * \file src/plugins/input/pcap/config.c
+ * \brief Configuration parser of pcap input plugin (source file)
+ * \date 2026
+ */
+
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include "config.h"
+
+/** Default Template Lifetime                                                                    */
+#define LIFETIME_DATA_DEF (1800)
+/** Default Options Template Lifetime                                                            */
+#define LIFETIME_OPTS_DEF (1800)
+
+/*
+ * <params>
+ *  <path>...</path>                              <!-- mandatory                 -->
+ *  <localPort>...</localPort>                    <!-- optional                  -->
+ *  <templateLifeTime>...</templateLifeTime>      <!-- optional                  -->
+ *  <optionsTemplateLifeTime>...</optionsTemplateLifeTime> <!-- optional         -->
+ *  <speed>...</speed>                            <!-- optional                  -->
+ * </params>
+ */
+
+/** XML nodes */
+enum params_xml_nodes {
+    NODE_PATH = 1,
+    NODE_PORT,
+    NODE_LT_DATA,
+    NODE_LT_OPTS,
+    NODE_SPEED
+};
+
+/** Definition of the \<params\> node  */
+static const struct fds_xml_args args_params[] = {
+    FDS_OPTS_ROOT("params"),
+    FDS_OPTS_ELEM(NODE_PATH,    "path",                    FDS_OPTS_T_STRING, 0),
+    FDS_OPTS_ELEM(NODE_PORT,    "localPort",               FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(NODE_LT_DATA, "templateLifeTime",        FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(NODE_LT_OPTS, "optionsTemplateLifeTime", FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(NODE_SPEED,   "speed",                   FDS_OPTS_T_DOUBLE, FDS_OPTS_P_OPT),
+    FDS_OPTS_END
+};
+
+/**
+ * \brief Process \<params\> node
+ * \param[in] ctx  Plugin context
+ * \param[in] root XML context to process
+ * \param[in] cfg  Parsed configuration
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_FORMAT in case of failure
+ */
+static int
+config_parser_root(ipx_ctx_t *ctx, fds_xml_ctx_t *root, struct pcap_config *cfg)
+{
+    const struct fds_xml_cont *content;
+    while (fds_xml_next(root, &content) != FDS_EOC) {
+        switch (content->id) {
+        case NODE_PATH:
+            // File(s) path
+            assert(content->type == FDS_OPTS_T_STRING);
+            cfg->path = strdup(content->ptr_string);
+            if (!cfg->path) {
+                IPX_CTX_ERROR(ctx, "Memory allocation error (%s:%d)", __FILE__, __LINE__);
+                return IPX_ERR_FORMAT;
+            }
+            break;
+        case NODE_PORT:
+            // Local port
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint > UINT16_MAX) {
+                IPX_CTX_ERROR(ctx, "Local port value must be between 0..%" PRIu16, UINT16_MAX);
+                return IPX_ERR_FORMAT;
+            }
+            cfg->local_port = (uint16_t) content->val_uint;
+            break;
+        case NODE_LT_DATA:
+            // Template Lifetime
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint > UINT16_MAX) {
+                IPX_CTX_ERROR(ctx, "Template Lifetime must be between 0..%" PRIu16, UINT16_MAX);
+                return IPX_ERR_FORMAT;
+            }
+            cfg->lifetime_data = (uint16_t) content->val_uint;
+            break;
+        case NODE_LT_OPTS:
+            // Options Template Lifetime
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint > UINT16_MAX) {
+                IPX_CTX_ERROR(ctx, "Options Template Lifetime must be between 0..%" PRIu16,
+                    UINT16_MAX);
+                return IPX_ERR_FORMAT;
+            }
+            cfg->lifetime_opts = (uint16_t) content->val_uint;
+            break;
+        case NODE_SPEED:
+            // Replay speed
+            assert(content->type == FDS_OPTS_T_DOUBLE);
+            if (!(content->val_double >= 0.0)) {
+                IPX_CTX_ERROR(ctx, "Speed must be a non-negative number!", '\0');
+                return IPX_ERR_FORMAT;
+            }
+            cfg->speed = content->val_double;
+            break;
+        default:
+            // Internal error
+            assert(false);
+        }
+    }
+
+    return IPX_OK;
+}
+
+/**
+ * \brief Set default parameters of the configuration
+ * \param[in] cfg Configuration
+ */
+static void
+config_default_set(struct pcap_config *cfg)
+{
+    cfg->path = NULL;
+    cfg->local_port = 0; // Any port
+    cfg->lifetime_data = LIFETIME_DATA_DEF;
+    cfg->lifetime_opts = LIFETIME_OPTS_DEF;
+    cfg->speed = 0.0; // As fast as possible
+}
+
+struct pcap_config *
+config_parse(ipx_ctx_t *ctx, const char *params)
+{
+    struct pcap_config *cfg = calloc(1, sizeof(*cfg));
+    if (!cfg) {
+        IPX_CTX_ERROR(ctx, "Memory allocation error (%s:%d)", __FILE__, __LINE__);
+        return NULL;
+    }
+
+    // Set default parameters
+    config_default_set(cfg);
+
+    // Create an XML parser
+    fds_xml_t *parser = fds_xml_create();
+    if (!parser) {
+        IPX_CTX_ERROR(ctx, "Memory allocation error (%s:%d)", __FILE__, __LINE__);
+        config_destroy(cfg);
+        return NULL;
+    }
+
+    if (fds_xml_set_args(parser, args_params) != IPX_OK) {
+        IPX_CTX_ERROR(ctx, "Failed to parse the description of an XML document!", '\0');
+        fds_xml_destroy(parser);
+        config_destroy(cfg);
+        return NULL;
+    }
+
+    fds_xml_ctx_t *params_ctx = fds_xml_parse_mem(parser, params, true);
+    if (params_ctx == NULL) {
+        IPX_CTX_ERROR(ctx, "Failed to parse the configuration: %s", fds_xml_last_err(parser));
+        fds_xml_destroy(parser);
+        config_destroy(cfg);
+        return NULL;
+    }
+
+    // Parse parameters
+    int rc = config_parser_root(ctx, params_ctx, cfg);
+    fds_xml_destroy(parser);
+    if (rc != IPX_OK) {
+        config_destroy(cfg);
+        return NULL;
+    }
+
+    return cfg;
+}
+
+void
+config_destroy(struct pcap_config *cfg)
+{
+    free(cfg->path);
+    free(cfg);
+}
@@ -0,0 +1,1093 @@
+/**
+ * \file src/plugins/input/pcap/pcap.c
+ * \brief Offline pcap/pcapng replay input plugin for IPFIXcol 2
+ * \date 2026
+ */
+
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include <ipfixcol2.h>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <assert.h>
+#include <byteswap.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <glob.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "config.h"
+#include "input_common.h"
+#include "reasm.h"
+
+/** Max number of captured packets processed by a single getter call                             */
+#define GETTER_PKTS       (256)
+/** Max time to wait for the captured pace in a single getter call [milliseconds]                */
+#define GETTER_SLEEP_MAX  (100)
+/** Max number of IP datagrams reassembled concurrently                                          */
+#define REASM_CNT         (64)
+/** Timeout of an incomplete IP datagram (in capture time) [seconds]                             */
+#define REASM_TIMEOUT     (5)
+/** Default size of the hash table of active sources (must be a power of two)                    */
+#define ACTIVE_DEF_SIZE   (64)
+
+/** Magic number of pcap files with timestamps in microseconds                                   */
+#define PCAP_MAGIC_US     (0xA1B2C3D4U)
+/** Magic number of pcap files with timestamps in nanoseconds                                    */
+#define PCAP_MAGIC_NS     (0xA1B23C4DU)
+/** Length of pcap file header (in bytes)                                                        */
+#define PCAP_HDR_LEN      (24U)
+/** Length of pcap record header (in bytes)                                                      */
+#define PCAP_REC_LEN      (16U)
+
+/** Type of pcapng Section Header Block (the same in both byte orders)                           */
+#define PCAPNG_SHB        (0x0A0D0D0AU)
+/** Byte-Order Magic of pcapng Section Header Block                                              */
+#define PCAPNG_BOM        (0x1A2B3C4DU)
+/** Type of pcapng Interface Description Block                                                   */
+#define PCAPNG_IDB        (1U)
+/** Type of pcapng Packet Block (obsolete)                                                       */
+#define PCAPNG_PB         (2U)
+/** Type of pcapng Simple Packet Block                                                           */
+#define PCAPNG_SPB        (3U)
+/** Type of pcapng Enhanced Packet Block                                                         */
+#define PCAPNG_EPB        (6U)
+/** Length of pcapng block header and trailer (type and twice the length, in bytes)              */
+#define PCAPNG_BLOCK_LEN  (12U)
+/** Code of pcapng option with resolution of timestamps (Interface Description Block)            */
+#define PCAPNG_OPT_TSRES  (9U)
+
+/** Link types (LINKTYPE_* values) of captured packets                                           */
+enum link_type {
+    LINK_NULL      = 0,   /**< BSD loopback (4 bytes of protocol family in host byte order)   */
+    LINK_ETHERNET  = 1,   /**< Ethernet (optionally with VLAN tags)                           */
+    LINK_RAW_12    = 12,  /**< Raw IP (value used by some platforms)                          */
+    LINK_RAW_14    = 14,  /**< Raw IP (value used by some platforms)                          */
+    LINK_RAW       = 101, /**< Raw IP                                                         */
+    LINK_LOOP      = 108, /**< OpenBSD loopback (4 bytes of protocol family)                  */
+    LINK_SLL       = 113, /**< Linux "cooked" capture v1                                      */
+    LINK_IPV4      = 228, /**< Raw IPv4                                                       */
+    LINK_IPV6      = 229, /**< Raw IPv6                                                       */
+    LINK_SLL2      = 276  /**< Linux "cooked" capture v2                                      */
+};
+
+/** Plugin description */
+IPX_API struct ipx_plugin_info ipx_plugin_info = {
+    // Plugin type
+    .type = IPX_PT_INPUT,
+    // Plugin identification name
+    .name = "pcap",
+    // Brief description of plugin
+    .dsc = "Input plugin for IPFIX/NetFlow v5/v9 over UDP captured in pcap/pcapng files.",
+    // Configuration flags (reserved for future use)
+    .flags = 0,
+    // Plugin version string (like "1.2.3")
+    .version = "2.0.0",
+    // Minimal IPFIXcol version string (like "1.2.3")
+    .ipx_min = "2.3.0"
+};
+
+/** Capture interface (i.e. properties of captured packets)                                      */
+struct pcap_ifc {
+    /** Link type (see ::link_type)                                                              */
+    uint32_t link_type;
+    /** Max length of captured packets (0 == unlimited)                                          */
+    uint32_t snaplen;
+    /** Number of timestamp units per second                                                     */
+    uint64_t ts_units;
+};
+
+/** Captured packet                                                                              */
+struct pcap_pkt {
+    /** The packet is valid (i.e. waiting for processing)                                        */
+    bool valid;
+    /** Captured data (points to the mapped file)                                                */
+    const uint8_t *data;
+    /** Length of captured data                                                                  */
+    uint32_t len;
+    /** Link type (see ::link_type)                                                              */
+    uint32_t link_type;
+    /** Timestamp [nanoseconds since the epoch]                                                  */
+    uint64_t ts;
+};
+
+/**
+ * \brief Description of a UDP Transport Session
+ * \note The identification must be the first member (see input_net_eq())
+ */
+struct pcap_source {
+    /** Identification of the Session (addresses and ports, unused bytes are always zeroed)     */
+    struct ipx_session_net net;
+    /** Description of  the Transport Session                                                    */
+    struct ipx_session *session;
+    /** No message has been received from the Session yet                                        */
+    bool new_connection;
+};
+
+/** Instance data                                                                                */
+struct pcap_data {
+    /** Parsed configuration parameters                                                          */
+    struct pcap_config *config;
+    /** Instance context                                                                         */
+    ipx_ctx_t *ctx;
+
+    /** List of all files to read (matching file path)                                           */
+    glob_t file_list;
+    /** Index of the next file to read (see file_list->gl_pathv)                                 */
+    size_t file_next_idx;
+
+    struct {
+        /** Name/path of the file (NULL if no file is opened)                                    */
+        const char *name;
+        /** Mapped content of the file                                                           */
+        const uint8_t *map;
+        /** Size of the file                                                                     */
+        size_t size;
+        /** Position of the reader                                                               */
+        size_t offset;
+        /** The file is in pcapng format (otherwise pcap)                                        */
+        bool is_ng;
+        /** The file (section) has different byte order than the host                            */
+        bool swap;
+        /** Capture interfaces of the current section (exactly one for pcap files)               */
+        struct pcap_ifc *ifcs;
+        /** Number of capture interfaces                                                         */
+        size_t ifc_cnt;
+        /** Timestamp of the last packet (used by blocks without timestamps)                     */
+        uint64_t ts_last;
+
+        /** Number of captured packets                                                           */
+        uint64_t cnt_pkts;
+        /** Number of NetFlow/IPFIX messages                                                     */
+        uint64_t cnt_msgs;
+        /** Number of malformed packets                                                          */
+        uint64_t cnt_invalid;
+    } file; /**< Currently opened file                                                           */
+
+    /** The next packet to process                                                               */
+    struct pcap_pkt pending;
+
+    struct {
+        /** Timestamp of a reference packet (0 == not started yet)                               */
+        uint64_t ts_base;
+        /** Monotonic time at which the reference packet was processed [nanoseconds]           */
+        uint64_t clock_base;
+    } pace; /**< Replay with the captured pace                                                   */
+
+    /** Hash table of active connections (items are struct pcap_source)                          */
+    struct ipx_htable active;
+
+    /** Reassembly of fragmented datagrams                                                       */
+    reasm_t *reasm;
+
+    /** Messages to pass                                                                         */
+    struct input_pass pass;
+};
+
+// -------------------------------------------------------------------------------------------------
+
+/** Read a 16-bit unsigned integer in byte order of the current file                            */
+static inline uint16_t
+file_u16(const struct pcap_data *data, const uint8_t *ptr)
+{
+    uint16_t value;
+    memcpy(&value, ptr, sizeof(value));
+    return data->file.swap ? bswap_16(value) : value;
+}
+
+/** Read a 32-bit unsigned integer in byte order of the current file                            */
+static inline uint32_t
+file_u32(const struct pcap_data *data, const uint8_t *ptr)
+{
+    uint32_t value;
+    memcpy(&value, ptr, sizeof(value));
+    return data->file.swap ? bswap_32(value) : value;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+/**
+ * \brief Get a reference to a Transport Session
+ *
+ * First, try to find in among already active Transport Sessions. If it is not present, create
+ * a new one and store it into the table of active Sessions.
+ * \param[in] data Instance data
+ * \param[in] net  Identification of the source (unused bytes must be zeroed)
+ * \return Pointer to the Session or NULL (typically memory allocation error)
+ */
+static struct pcap_source *
+active_get(struct pcap_data *data, const struct ipx_session_net *net)
+{
+    const uint64_t hash = input_net_hash(net);
+    struct ipx_htable_slot *slot = ipx_htable_find(&data->active, hash, &input_net_eq, net);
+    if (slot != NULL) {
+        return slot->item;
+    }
+
+    // Not found, add a new record
+    char src_addr_str[INET6_ADDRSTRLEN] = {0};
+    inet_ntop(net->l3_proto, &net->addr_src, src_addr_str, INET6_ADDRSTRLEN);
+
+    const struct pcap_config *cfg = data->config;
+    struct ipx_session *session = ipx_session_new_udp(net, cfg->lifetime_data, cfg->lifetime_opts);
+    if (!session) {
+        IPX_CTX_ERROR(data->ctx, "Failed to create a Transport Session description of %s.",
+            src_addr_str);
+        return NULL;
+    }
+
+    struct pcap_source *src = calloc(1, sizeof(*src));
+    if (!src) {
+        IPX_CTX_ERROR(data->ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+        ipx_session_destroy(session);
+        return NULL;
+    }
+
+    src->net = *net;
+    src->session = session;
+    src->new_connection = true; // Session Message hasn't been send yet
+    if (ipx_htable_reserve(&data->active) != IPX_OK) {
+        IPX_CTX_ERROR(data->ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+        free(src);
+        ipx_session_destroy(session);
+        return NULL;
+    }
+
+    IPX_CTX_INFO(data->ctx, "New exporter found '%s'.", src_addr_str);
+    ipx_htable_insert(&data->active, hash, src);
+    return src;
+}
+
+/**
+ * \brief Close all Transport Sessions
+ *
+ * Prepare Session Messages - close event (if necessary) and remove all sessions from the table
+ * of active connections.
+ * \param[in] data Instance data
+ */
+static void
+active_close_all(struct pcap_data *data)
+{
+    for (size_t i = 0; i < data->active.size; ++i) {
+        struct pcap_source *src = data->active.slots[i].item;
+        if (src == NULL) {
+            continue;
+        }
+
+        IPX_CTX_INFO(data->ctx, "Transport Session '%s' closed!", src->session->ident);
+
+        if (src->new_connection) {
+            // No messages have been passed with a reference to this session -> destroy it
+            ipx_session_destroy(src->session);
+            free(src);
+            continue;
+        }
+
+        // Generate a Session message (order of the messages MUST be preserved)
+        ipx_msg_session_t *msg_sess = ipx_msg_session_create(src->session, IPX_MSG_SESSION_CLOSE);
+        if (!msg_sess) {
+            IPX_CTX_WARNING(data->ctx, "Failed to create a Session message! Instances of "
+                "plugins will not be informed about the closed Transport Session '%s' (%s:%d)",
+                src->session->ident, __FILE__, __LINE__);
+            // Do not free the session structure because it still can be used by other plugins
+        } else {
+            // Pass the message and put the Session into the garbage
+            input_pass_add(&data->pass, ipx_msg_session2base(msg_sess));
+
+            ipx_msg_garbage_cb cb = (ipx_msg_garbage_cb) &ipx_session_destroy;
+            ipx_msg_garbage_t *msg_garbage = ipx_msg_garbage_create(src->session, cb);
+            if (!msg_garbage) {
+                IPX_CTX_ERROR(data->ctx, "Memory allocation failed! (%s:%d)", __FILE__,
+                    __LINE__);
+            } else {
+                input_pass_add(&data->pass, ipx_msg_garbage2base(msg_garbage));
+            }
+        }
+
+        free(src);
+    }
+
+    ipx_htable_clear(&data->active);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+/**
+ * \brief Check if a link type is supported
+ * \param[in] link_type Link type
+ * \return True or false
+ */
+static bool
+link_supported(uint32_t link_type)
+{
+    switch (link_type) {
+    case LINK_NULL:
+    case LINK_ETHERNET:
+    case LINK_RAW_12:
+    case LINK_RAW_14:
+    case LINK_RAW:
+    case LINK_LOOP:
+    case LINK_SLL:
+    case LINK_IPV4:
+    case LINK_IPV6:
+    case LINK_SLL2:
+        return true;
+    default:
+        return false;
+    }
+}
+
+/**
+ * \brief Check if an EtherType identifies IPv4 or IPv6
+ * \param[in] ether_type EtherType
+ * \return True or false
+ */
+static inline bool
+link_is_ip(uint16_t ether_type)
+{
+    return ether_type == 0x0800U || ether_type == 0x86DDU;
+}
+
+/**
+ * \brief Skip the link layer header of a captured packet
+ * \param[in]  pkt    Captured packet
+ * \param[out] ip_len Length of the network layer packet
+ * \return Pointer to the network layer packet or NULL (not an IP packet, unsupported link)
+ */
+static const uint8_t *
+link_decode(const struct pcap_pkt *pkt, uint32_t *ip_len)
+{
+    const uint8_t *data = pkt->data;
+    uint32_t offset;
+
+    switch (pkt->link_type) {
+    case LINK_RAW_12:
+    case LINK_RAW_14:
+    case LINK_RAW:
+    case LINK_IPV4:
+    case LINK_IPV6:
+        offset = 0;
+        break;
+    case LINK_NULL:
+    case LINK_LOOP:
+        // Protocol family in various byte orders, the IP header will be checked anyway
+        offset = 4;
+        break;
+    case LINK_ETHERNET: {
+        offset = 14;
+        if (pkt->len < offset) {
+            return NULL;
+        }
+
+        // Skip VLAN tags (802.1Q, 802.1ad, QinQ)
+        uint16_t ether_type = read_u16(data + 12);
+        while (ether_type == 0x8100U || ether_type == 0x88A8U || ether_type == 0x9100U) {
+            if (pkt->len < offset + 4) {
+                return NULL;
+            }
+            ether_type = read_u16(data + offset + 2);
+            offset += 4;
+        }
+
+        if (!link_is_ip(ether_type)) {
+            return NULL;
+        }
+        break;
+    }
+    case LINK_SLL:
+        offset = 16;
+        if (pkt->len < offset || !link_is_ip(read_u16(data + 14))) {
+            return NULL;
+        }
+        break;
+    case LINK_SLL2:
+        offset = 20;
+        if (pkt->len < offset || !link_is_ip(read_u16(data))) {
+            return NULL;
+        }
+        break;
+    default:
+        return NULL;
+    }
+
+    if (pkt->len < offset) {
+        return NULL;
+    }
+
+    *ip_len = pkt->len - offset;
+    return data + offset;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+/**
+ * \brief Add a capture interface of the current file
+ * \param[in] data      Instance data
+ * \param[in] link_type Link type
+ * \param[in] snaplen   Max length of captured packets
+ * \param[in] ts_units  Number of timestamp units per second
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_NOMEM if a memory allocation error has occurred
+ */
+static int
+file_ifc_add(struct pcap_data *data, uint32_t link_type, uint32_t snaplen, uint64_t ts_units)
+{
+    const size_t new_size = (data->file.ifc_cnt + 1) * sizeof(struct pcap_ifc);
+    struct pcap_ifc *new_ifcs = realloc(data->file.ifcs, new_size);
+    if (!new_ifcs) {
+        IPX_CTX_ERROR(data->ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+        return IPX_ERR_NOMEM;
+    }
+
+    if (!link_supported(link_type)) {
+        IPX_CTX_WARNING(data->ctx, "File '%s' contains packets with unsupported link type "
+            "%" PRIu32 ". These packets will be ignored.", data->file.name, link_type);
+    }
+
+    struct pcap_ifc *ifc = &new_ifcs[data->file.ifc_cnt++];
+    ifc->link_type = link_type;
+    ifc->snaplen = snaplen;
+    ifc->ts_units = ts_units;
+    data->file.ifcs = new_ifcs;
+    return IPX_OK;
+}
+
+/**
+ * \brief Convert a timestamp of a capture interface to nanoseconds
+ * \param[in] ifc   Capture interface
+ * \param[in] value Timestamp (in units of the interface)
+ * \return Timestamp in nanoseconds
+ */
+static inline uint64_t
+file_ts2ns(const struct pcap_ifc *ifc, uint64_t value)
+{
+    return (uint64_t) (((unsigned __int128) value * 1000000000U) / ifc->ts_units);
+}
+
+/**
+ * \brief Close the current file
+ * \param[in] data Instance data
+ */
+static void
+file_close(struct pcap_data *data)
+{
+    if (!data->file.name) {
+        return;
+    }
+
+    IPX_CTX_INFO(data->ctx, "File '%s' processed (packets: %" PRIu64 ", NetFlow/IPFIX "
+        "messages: %" PRIu64 ", malformed packets: %" PRIu64 ")", data->file.name,
+        data->file.cnt_pkts, data->file.cnt_msgs, data->file.cnt_invalid);
+
+    munmap((void *) data->file.map, data->file.size);
+    free(data->file.ifcs);
+    data->file.name = NULL;
+    data->file.map = NULL;
+    data->file.ifcs = NULL;
+    data->file.ifc_cnt = 0;
+}
+
+/**
+ * \brief Open the next file with captured packets
+ *
+ * Files that cannot be opened and files in unknown format are skipped.
+ * \param[in] data Instance data
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_EOF if no more files are available
+ * \return #IPX_ERR_NOMEM if a memory allocation error has occurred
+ */
+static int
+file_open_next(struct pcap_data *data)
+{
+    const char *err_str;
+    assert(data->file.name == NULL && "The previous file must be closed!");
+
+    while (data->file_next_idx < data->file_list.gl_pathc) {
+        const char *name = data->file_list.gl_pathv[data->file_next_idx++];
+        const size_t name_len = strlen(name);
+        if (name[name_len - 1] == '/') {
+            continue; // Directory (GLOB_MARK)
+        }
+
+        int fd = open(name, O_RDONLY);
+        if (fd == -1) {
+            ipx_strerror(errno, err_str);
+            IPX_CTX_ERROR(data->ctx, "Failed to open '%s': %s", name, err_str);
+            continue;
+        }
+
+        struct stat file_stat;
+        if (fstat(fd, &file_stat) == -1 || file_stat.st_size < (off_t) PCAP_HDR_LEN) {
+            IPX_CTX_ERROR(data->ctx, "Skipping empty or inaccessible file '%s'", name);
+            close(fd);
+            continue;
+        }
+
+        const size_t size = (size_t) file_stat.st_size;
+        void *map = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (map == MAP_FAILED) {
+            ipx_strerror(errno, err_str);
+            IPX_CTX_ERROR(data->ctx, "Failed to map '%s': %s", name, err_str);
+            continue;
+        }
+        madvise(map, size, MADV_SEQUENTIAL);
+
+        data->file.name = name;
+        data->file.map = map;
+        data->file.size = size;
+        data->file.ts_last = 0;
+        data->file.cnt_pkts = 0;
+        data->file.cnt_msgs = 0;
+        data->file.cnt_invalid = 0;
+
+        uint32_t magic;
+        memcpy(&magic, map, sizeof(magic));
+        if (magic == PCAPNG_SHB) {
+            // The byte order is determined by the Section Header Block
+            data->file.is_ng = true;
+            data->file.swap = false;
+            data->file.offset = 0;
+        } else if (magic == PCAP_MAGIC_US || magic == PCAP_MAGIC_NS
+                || magic == bswap_32(PCAP_MAGIC_US) || magic == bswap_32(PCAP_MAGIC_NS)) {
+            data->file.is_ng = false;
+            data->file.swap = (magic != PCAP_MAGIC_US && magic != PCAP_MAGIC_NS);
+            data->file.offset = PCAP_HDR_LEN;
+
+            // Link type is in the lower 16 bits (the upper bits might describe FCS)
+            const uint8_t *hdr = data->file.map;
+            const uint64_t units = (file_u32(data, hdr) == PCAP_MAGIC_NS) ? 1000000000U : 1000000U;
+            const uint32_t snaplen = file_u32(data, hdr + 16);
+            const uint32_t link_type = file_u32(data, hdr + 20) & 0xFFFFU;
+            if (file_ifc_add(data, link_type, snaplen, units) != IPX_OK) {
+                return IPX_ERR_NOMEM;
+            }
+        } else {
+            IPX_CTX_ERROR(data->ctx, "Skipping non-pcap file '%s'", name);
+            munmap(map, size);
+            data->file.name = NULL;
+            data->file.map = NULL;
+            continue;
+        }
+
+        IPX_CTX_INFO(data->ctx, "Reading from file '%s'...", name);
+        return IPX_OK;
+    }
+
+    return IPX_ERR_EOF;
+}
+
+/**
+ * \brief Get the next packet from the current file in pcap format
+ * \param[in]  data Instance data
+ * \param[out] pkt  Packet
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_EOF if the end-of-file has been reached
+ * \return #IPX_ERR_FORMAT if the file is malformed
+ */
+static int
+file_next_pcap(struct pcap_data *data, struct pcap_pkt *pkt)
+{
+    const size_t remain = data->file.size - data->file.offset;
+    if (remain == 0) {
+        return IPX_ERR_EOF;
+    }
+
+    const uint8_t *rec = data->file.map + data->file.offset;
+    if (remain < PCAP_REC_LEN || file_u32(data, rec + 8) > remain - PCAP_REC_LEN) {
+        return IPX_ERR_FORMAT;
+    }
+
+    const struct pcap_ifc *ifc = &data->file.ifcs[0];
+    const uint64_t ts_sec = file_u32(data, rec);
+    const uint64_t ts_frac = file_u32(data, rec + 4);
+    pkt->ts = file_ts2ns(ifc, ts_sec * ifc->ts_units + ts_frac);
+    pkt->len = file_u32(data, rec + 8);
+    pkt->data = rec + PCAP_REC_LEN;
+    pkt->link_type = ifc->link_type;
+    data->file.offset += PCAP_REC_LEN + pkt->len;
+    return IPX_OK;
+}
+
+/**
+ * \brief Process options of a pcapng Interface Description Block and add the interface
+ * \param[in] data     Instance data
+ * \param[in] body     Body of the block
+ * \param[in] body_len Length of the body
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_FORMAT if the block is malformed
+ * \return #IPX_ERR_NOMEM if a memory allocation error has occurred
+ */
+static int
+file_ng_idb(struct pcap_data *data, const uint8_t *body, uint32_t body_len)
+{
+    if (body_len < 8) {
+        return IPX_ERR_FORMAT;
+    }
+
+    const uint32_t link_type = file_u16(data, body);
+    const uint32_t snaplen = file_u32(data, body + 4);
+    uint64_t ts_units = 1000000U; // Default resolution is in microseconds
+
+    uint32_t offset = 8;
+    while (offset + 4 <= body_len) {
+        const uint16_t opt_code = file_u16(data, body + offset);
+        const uint16_t opt_len = file_u16(data, body + offset + 2);
+        offset += 4;
+        if (opt_code == 0 || offset + opt_len > body_len) {
+            break; // End of options
+        }
+
+        if (opt_code == PCAPNG_OPT_TSRES && opt_len >= 1) {
+            // Negative power of 10 or 2 (the most significant bit)
+            const uint8_t res = body[offset];
+            const uint8_t exp = res & 0x7FU;
+            if ((res & 0x80U) != 0 ? exp > 63 : exp > 19) {
+                return IPX_ERR_FORMAT;
+            }
+
+            if ((res & 0x80U) != 0) {
+                ts_units = 1ULL << exp;
+            } else {
+                ts_units = 1;
+                for (uint8_t i = 0; i < exp; ++i) {
+                    ts_units *= 10U;
+                }
+            }
+        }
+
+        offset += (opt_len + 3U) & ~3U; // Padded to 32 bits
+    }
+
+    return file_ifc_add(data, link_type, snaplen, ts_units);
+}
+
+/**
+ * \brief Get the next packet from the current file in pcapng format
+ *
+ * Blocks of other types than Section Header Block, Interface Description Block and packet
+ * blocks (Enhanced, Simple and obsolete Packet Block) are skipped.
+ * \param[in]  data Instance data
+ * \param[out] pkt  Packet
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_EOF if the end-of-file has been reached
+ * \return #IPX_ERR_FORMAT if the file is malformed
+ * \return #IPX_ERR_NOMEM if a memory allocation error has occurred
+ */
+static int
+file_next_pcapng(struct pcap_data *data, struct pcap_pkt *pkt)
+{
+    while (true) {
+        const size_t remain = data->file.size - data->file.offset;
+        if (remain == 0) {
+            return IPX_ERR_EOF;
+        }
+
+        const uint8_t *block = data->file.map + data->file.offset;
+        if (remain < PCAPNG_BLOCK_LEN) {
+            return IPX_ERR_FORMAT;
+        }
+
+        uint32_t type;
+        memcpy(&type, block, sizeof(type));
+        if (type == PCAPNG_SHB) {
+            // New section (possibly with a different byte order and new interfaces)
+            uint32_t bom;
+            if (remain < PCAPNG_BLOCK_LEN + 4) {
+                return IPX_ERR_FORMAT;
+            }
+            memcpy(&bom, block + 8, sizeof(bom));
+            if (bom != PCAPNG_BOM && bom != bswap_32(PCAPNG_BOM)) {
+                return IPX_ERR_FORMAT;
+            }
+
+            data->file.swap = (bom != PCAPNG_BOM);
+            data->file.ifc_cnt = 0;
+        } else {
+            type = file_u32(data, block);
+        }
+
+        const uint32_t block_len = file_u32(data, block + 4);
+        if (block_len < PCAPNG_BLOCK_LEN || block_len % 4 != 0 || block_len > remain) {
+            return IPX_ERR_FORMAT;
+        }
+
+        const uint8_t *body = block + 8;
+        const uint32_t body_len = block_len - PCAPNG_BLOCK_LEN;
+        data->file.offset += block_len;
+
+        uint32_t ifc_id;
+        uint64_t ts;
+        uint32_t cap_len;
+        switch (type) {
+        case PCAPNG_IDB: {
+            int rc = file_ng_idb(data, body, body_len);
+            if (rc != IPX_OK) {
+                return rc;
+            }
+            continue;
+        }
+        case PCAPNG_EPB:
+        case PCAPNG_PB:
+            if (body_len < 20) {
+                return IPX_ERR_FORMAT;
+            }
+
+            // Packet Block has 16-bit Interface ID (followed by 16-bit drop counter)
+            ifc_id = (type == PCAPNG_EPB) ? file_u32(data, body) : file_u16(data, body);
+            ts = ((uint64_t) file_u32(data, body + 4) << 32) | file_u32(data, body + 8);
+            cap_len = file_u32(data, body + 12);
+            if (ifc_id >= data->file.ifc_cnt || cap_len > body_len - 20) {
+                return IPX_ERR_FORMAT;
+            }
+
+            ts = file_ts2ns(&data->file.ifcs[ifc_id], ts);
+            body += 20;
+            break;
+        case PCAPNG_SPB:
+            // Simple Packet Block doesn't have a timestamp and always belongs to the 1st interface
+            if (body_len < 4 || data->file.ifc_cnt == 0) {
+                return IPX_ERR_FORMAT;
+            }
+
+            ifc_id = 0;
+            ts = data->file.ts_last;
+            cap_len = file_u32(data, body);
+            if (cap_len > body_len - 4) {
+                cap_len = body_len - 4;
+            }
+            if (data->file.ifcs[0].snaplen != 0 && cap_len > data->file.ifcs[0].snaplen) {
+                cap_len = data->file.ifcs[0].snaplen;
+            }
+            body += 4;
+            break;
+        default:
+            // Other blocks are ignored
+            continue;
+        }
+
+        pkt->ts = ts;
+        pkt->len = cap_len;
+        pkt->data = body;
+        pkt->link_type = data->file.ifcs[ifc_id].link_type;
+        data->file.ts_last = ts;
+        return IPX_OK;
+    }
+}
+
+/**
+ * \brief Get the next captured packet
+ *
+ * If the end of the current file has been reached (or the file is corrupted), the next file
+ * is opened.
+ * \param[in]  data Instance data
+ * \param[out] pkt  Packet
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_EOF if no more packets are available
+ * \return #IPX_ERR_NOMEM if a memory allocation error has occurred
+ */
+static int
+packet_next(struct pcap_data *data, struct pcap_pkt *pkt)
+{
+    while (true) {
+        int rc;
+        if (!data->file.name) {
+            rc = file_open_next(data);
+            if (rc != IPX_OK) {
+                return rc;
+            }
+        }
+
+        rc = data->file.is_ng ? file_next_pcapng(data, pkt) : file_next_pcap(data, pkt);
+        switch (rc) {
+        case IPX_OK:
+            data->file.cnt_pkts++;
+            return IPX_OK;
+        case IPX_ERR_FORMAT:
+            IPX_CTX_ERROR(data->ctx, "File '%s' is corrupted (offset %zu)! The rest of the file "
+                "will be skipped.", data->file.name, data->file.offset);
+            break;
+        case IPX_ERR_NOMEM:
+            return rc;
+        default:
+            break;
+        }
+
+        file_close(data);
+    }
+}
+
+// -------------------------------------------------------------------------------------------------
+
+/**
+ * \brief Process a captured packet
+ *
+ * Skip the link layer header, reassemble fragmented datagrams and process the payload
+ * of UDP datagrams with NetFlow/IPFIX messages. Everything else is silently ignored.
+ * \param[in] data Instance data
+ * \param[in] pkt  Captured packet
+ */
+static void
+process_packet(struct pcap_data *data, const struct pcap_pkt *pkt)
+{
+    uint32_t ip_len;
+    const uint8_t *ip = link_decode(pkt, &ip_len);
+    if (!ip) {
+        return;
+    }
+
+    struct ipx_session_net net;
+    const uint8_t *payload;
+    uint32_t payload_size;
+    const uint64_t now = pkt->ts / 1000000000U;
+    switch (reasm_udp(data->reasm, ip, ip_len, now, &net, &payload, &payload_size)) {
+    case REASM_DONE:
+        break;
+    case REASM_INVALID:
+        data->file.cnt_invalid++;
+        return;
+    default:
+        return;
+    }
+
+    const uint16_t port = data->config->local_port;
+    uint32_t odid;
+    if (port != 0 && net.port_dst != port) {
+        return;
+    }
+
+    // If the local port is not specified, skip other types of traffic by additional checks
+    if (!input_msg_check(payload, payload_size, port == 0, &odid)) {
+        if (port != 0) {
+            data->file.cnt_invalid++;
+        }
+        return;
+    }
+
+    struct pcap_source *source = active_get(data, &net);
+    if (!source) { // Memory allocation error!
+        return;
+    }
+
+    uint8_t *buffer = ipx_msg_ipfix_buffer_alloc(data->ctx, payload_size);
+    if (!buffer) {
+        IPX_CTX_ERROR(data->ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+        return;
+    }
+    memcpy(buffer, payload, payload_size);
+
+    if (source->new_connection) {
+        // Send information about the new Transport Session
+        source->new_connection = false;
+        ipx_msg_session_t *msg = ipx_msg_session_create(source->session, IPX_MSG_SESSION_OPEN);
+        if (!msg) {
+            IPX_CTX_WARNING(data->ctx, "Failed to create a Session message! Instances of "
+                "plugins will not be informed about the new Transport Session '%s' (%s:%d).",
+                source->session->ident, __FILE__, __LINE__);
+        } else {
+            input_pass_add(&data->pass, ipx_msg_session2base(msg));
+        }
+    }
+
+    // Create a message wrapper and pass the message
+    struct ipx_msg_ctx msg_ctx;
+    msg_ctx.session = source->session;
+    msg_ctx.odid = odid;
+    msg_ctx.stream = 0; // Streams are not supported over UDP
+
+    ipx_msg_ipfix_t *msg = ipx_msg_ipfix_create(data->ctx, &msg_ctx, buffer,
+        (uint16_t) payload_size);
+    if (!msg) {
+        IPX_CTX_ERROR(data->ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+        ipx_msg_ipfix_buffer_free(data->ctx, buffer);
+        return;
+    }
+
+    input_pass_add(&data->pass, ipx_msg_ipfix2base(msg));
+    data->file.cnt_msgs++;
+}
+
+/**
+ * \brief Get time to wait before a packet can be processed to keep the captured pace
+ *
+ * The first packet (and a packet with a timestamp lower than the reference one) becomes
+ * a new reference, i.e. it is processed immediately.
+ * \param[in] data Instance data
+ * \param[in] ts   Timestamp of the packet [nanoseconds]
+ * \return Time to wait [nanoseconds]
+ */
+static uint64_t
+pace_delay(struct pcap_data *data, uint64_t ts)
+{
+    struct timespec now_ts;
+    clock_gettime(CLOCK_MONOTONIC, &now_ts);
+    const uint64_t now = (uint64_t) now_ts.tv_sec * 1000000000U + (uint64_t) now_ts.tv_nsec;
+
+    if (data->pace.ts_base == 0 || ts < data->pace.ts_base) {
+        data->pace.ts_base = ts;
+        data->pace.clock_base = now;
+        return 0;
+    }
+
+    const double diff = (double) (ts - data->pace.ts_base) / data->config->speed;
+    const uint64_t target = data->pace.clock_base + (uint64_t) diff;
+    return (target > now) ? target - now : 0;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+int
+ipx_plugin_init(ipx_ctx_t *ctx, const char *params)
+{
+    struct pcap_data *data = calloc(1, sizeof(*data));
+    if (!data) {
+        IPX_CTX_ERROR(ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+        return IPX_ERR_DENIED;
+    }
+
+    data->ctx = ctx;
+    input_pass_init(&data->pass, ctx);
+    data->reasm = reasm_create(REASM_CNT, REASM_TIMEOUT);
+    if (ipx_htable_init(&data->active, ACTIVE_DEF_SIZE) != IPX_OK || !data->reasm) {
+        IPX_CTX_ERROR(ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+        if (data->reasm) {
+            reasm_destroy(data->reasm);
+        }
+        ipx_htable_destroy(&data->active);
+        free(data);
+        return IPX_ERR_DENIED;
+    }
+
+    // Parse configuration
+    data->config = config_parse(ctx, params);
+    if (!data->config) {
+        reasm_destroy(data->reasm);
+        ipx_htable_destroy(&data->active);
+        free(data);
+        return IPX_ERR_DENIED;
+    }
+
+    // Prepare list of all files to read
+    const int glob_flags = GLOB_MARK | GLOB_BRACE | GLOB_TILDE_CHECK;
+    int rc = glob(data->config->path, glob_flags, NULL, &data->file_list);
+    if (rc != 0) {
+        if (rc == GLOB_NOMATCH) {
+            IPX_CTX_ERROR(ctx, "No file matches the given file pattern!", '\0');
+        } else {
+            IPX_CTX_ERROR(ctx, "Failed to list files to process!", '\0');
+        }
+        config_destroy(data->config);
+        reasm_destroy(data->reasm);
+        ipx_htable_destroy(&data->active);
+        free(data);
+        return IPX_ERR_DENIED;
+    }
+
+    IPX_CTX_INFO(ctx, "%zu file(s) will be processed", data->file_list.gl_pathc);
+    ipx_ctx_private_set(ctx, data);
+    return IPX_OK;
+}
+
+void
+ipx_plugin_destroy(ipx_ctx_t *ctx, void *cfg)
+{
+    (void) ctx;
+    struct pcap_data *data = (struct pcap_data *) cfg;
+
+    // Close all Transport Session (this generates Session messages per each active Session)
+    active_close_all(data);
+    input_pass_flush(&data->pass);
+    ipx_htable_destroy(&data->active);
+
+    file_close(data);
+    globfree(&data->file_list);
+    reasm_destroy(data->reasm);
+    config_destroy(data->config);
+    free(data);
+}
+
+int
+ipx_plugin_get(ipx_ctx_t *ctx, void *cfg)
+{
+    struct pcap_data *data = (struct pcap_data *) cfg;
+
+    for (unsigned int i = 0; i < GETTER_PKTS; ++i) {
+        if (!data->pending.valid) {
+            switch (packet_next(data, &data->pending)) {
+            case IPX_OK:
+                data->pending.valid = true;
+                break;
+            case IPX_ERR_EOF:
+                // No more data
+                active_close_all(data);
+                input_pass_flush(&data->pass);
+                return IPX_ERR_EOF;
+            default:
+                IPX_CTX_ERROR(ctx, "Fatal error!", '\0');
+                input_pass_flush(&data->pass);
+                return IPX_ERR_DENIED;
+            }
+        }
+
+        if (data->config->speed > 0.0) {
+            const uint64_t delay = pace_delay(data, data->pending.ts);
+            if (delay > 0) {
+                // Pass prepared messages and wait (at most for a limited time)
+                input_pass_flush(&data->pass);
+                const uint64_t delay_max = GETTER_SLEEP_MAX * 1000000ULL;
+                const uint64_t sleep = (delay < delay_max) ? delay : delay_max;
+                struct timespec ts;
+                ts.tv_sec = (time_t) (sleep / 1000000000U);
+                ts.tv_nsec = (long) (sleep % 1000000000U);
+                nanosleep(&ts, NULL);
+                return IPX_OK;
+            }
+        }
+
+        process_packet(data, &data->pending);
+        data->pending.valid = false;
+    }
+
+    input_pass_flush(&data->pass);
+    return IPX_OK;
+}
@@ -63,6 +63,10 @@
 #define GETTER_TIMEOUT    (10)
 /** Max sockets events processed in the getter - i.e. epoll_wait array size                      */
 #define GETTER_MAX_EVENTS (16)
+/** Size of a receive buffer of a connection (must be able to hold the largest message)          */
+#define RECV_BUFFER_SIZE  (65536U)
+/** Max number of messages passed at once                                                        */
+#define PASS_MAX          (64)
 
 /** Plugin description */
 IPX_API struct ipx_plugin_info ipx_plugin_info = {
@@ -72,10 +76,10 @@ IPX_API struct ipx_plugin_info ipx_plugin_info = {
     .name = "tcp",
     // Brief description of plugin
     .dsc = "Input plugins for IPFIX/NetFlow v5/v9 over Transmission Control Protocol.",
-    // Configuration flags (reserved for future use)
-    .flags = 0,
+    // Configuration flags (multiple workers share the local port)
+    .flags = IPX_PF_WORKERS,
     // Plugin version string (like "1.2.3")
-    .version = "2.0.0",
+    .version = "2.1.0",
     // Minimal IPFIXcol version string (like "1.2.3")
     .ipx_min = "2.0.0"
 };
@@ -89,12 +93,24 @@ struct tcp_pair {
     /** No message has been received from the Session yet                                        */
     bool new_connection;
 
-    /** Partly received message that waits for completition                                      */
-    uint8_t *msg;
-    /** Allocated size of the partly received <em>msg</em> message                               */
-    uint16_t msg_size;
-    /** Already receive part of the <em>msg</em> message                                         */
-    uint16_t msg_offset;
+    /**
+     * Receive buffer of #RECV_BUFFER_SIZE bytes (NULL, if there are no unprocessed data)
+     * \note The buffer is allocated by ipx_msg_ipfix_buffer_alloc() and shared with messages
+     *   sliced out of it. Therefore, the processed part of the buffer MUST NOT be modified.
+     */
+    uint8_t *buffer;
+    /** Offset of the first unprocessed byte in the buffer                                       */
+    uint32_t buffer_start;
+    /** Offset of the end of received data in the buffer                                         */
+    uint32_t buffer_end;
+};
+
+/** Messages prepared to be passed                                                               */
+struct tcp_pass {
+    /** Array of messages                                                                        */
+    ipx_msg_t *msgs[PASS_MAX];
+    /** Number of messages                                                                       */
+    uint32_t cnt;
 };
 
 /** Instance data                                                                                */
@@ -109,6 +125,8 @@ struct tcp_data {
         size_t cnt;
         /** Array of sockets                                                                     */
         int *sockets;
+        /** Total number of workers sharing the local port (SO_REUSEPORT if more than 1)         */
+        unsigned int worker_cnt;
 
         /** Epoll file descriptor                                                                */
         int epoll_fd;
@@ -247,9 +265,7 @@ active_session_remove_aux(struct tcp_data *data, size_t idx)
     }
 
     // Free internal structures and remove the pair from the list (do NOT free SESSION)
-    if (pair->msg) {
-        free(pair->msg);
-    }
+    ipx_msg_ipfix_buffer_free(data->ctx, pair->buffer);
 
     close(pair->fd);
     free(pair);
@@ -528,11 +544,12 @@ listener_stop(ipx_ctx_t *ctx, struct tcp_data *data)
  * \param[in] addr     Local IPv4/IPv6 address and port of the socket(sockaddr_in6 or sockaddr_in)
  * \param[in] addrlen  Size of the address
  * \param[in] ipv6only Accept only IPv6 addresses (only for AF_INET6 and the wildcard address)
+ * \param[in] workers  Number of workers sharing the address (SO_REUSEPORT if more than 1)
  * \return On failure returns #INVALID_FD. Otherwise returns valid socket descriptor.
  */
 static int
 server_bind_address(ipx_ctx_t *ctx, const struct sockaddr *addr, socklen_t addrlen,
-    bool ipv6only)
+    bool ipv6only, unsigned int workers)
 {
     sa_family_t family = addr->sa_family;
     assert(family == AF_INET || family == AF_INET6);
@@ -554,6 +571,15 @@ server_bind_address(ipx_ctx_t *ctx, const struct sockaddr *addr, socklen_t addrl
             "the port can be used again. (error: %s)", err_str);
     }
 
+    // Share the port with other workers (the kernel distributes new connections among them)
+    if (workers > 1 && setsockopt(sd, SOL_SOCKET, SO_REUSEPORT, &on, sizeof(on)) == -1) {
+        ipx_strerror(errno, err_str);
+        IPX_CTX_ERROR(ctx, "Cannot turn on socket option SO_REUSEPORT required by multiple "
+            "workers: %s", err_str);
+        close(sd);
+        return INVALID_FD;
+    }
+
     // Make sure that IPv6 only is disabled
     if (family == AF_INET6) {
         if (!ipv6only && setsockopt(sd, IPPROTO_IPV6, IPV6_V6ONLY, &off, sizeof(off)) == -1) {
@@ -647,7 +673,8 @@ listener_init(ipx_ctx_t *ctx, struct tcp_data *instance)
         addr.sin6_port = htons(instance->config->local_port);
         addr.sin6_addr = in6addr_any;
 
-        int sd = server_bind_address(ctx, (struct sockaddr *) &addr, sizeof(addr), false);
+        int sd = server_bind_address(ctx, (struct sockaddr *) &addr, sizeof(addr), false,
+            instance->listen.worker_cnt);
         if (sd == INVALID_FD) {
             free(sockets);
             close(epoll_fd);
@@ -702,7 +729,8 @@ listener_init(ipx_ctx_t *ctx, struct tcp_data *instance)
             ipv6only = true;
         }
 
-        int sd = server_bind_address(ctx, (struct sockaddr *) &addr_helper, addrlen, ipv6only);
+        int sd = server_bind_address(ctx, (struct sockaddr *) &addr_helper, addrlen, ipv6only,
+            instance->listen.worker_cnt);
         if (sd == INVALID_FD) {
             // Failed
             break;
@@ -825,51 +853,76 @@ active_destroy(ipx_ctx_t *ctx, struct tcp_data *instance)
 }
 
 /**
- * \brief Try to read an IPFIX Message header
+ * \brief Pass all prepared messages at once
+ * \param[in] ctx  Instance context
+ * \param[in] pass Prepared messages
+ */
+static void
+socket_pass_flush(ipx_ctx_t *ctx, struct tcp_pass *pass)
+{
+    if (pass->cnt == 0) {
+        return;
+    }
+
+    ipx_ctx_msg_pass_batch(ctx, pass->msgs, pass->cnt);
+    pass->cnt = 0;
+}
+
+/**
+ * \brief Add a message to the array of messages to pass
  *
- * The whole header might not be available right now. In that case, the function
- * will only read and store available part and it will successfully return. When
- * this happens, the allocated message is smaller that IPFIX Message header. The
- * next call of this function will tried to read the rest.
+ * If the array is full, all prepared messages are passed first.
+ * \param[in] ctx  Instance context
+ * \param[in] pass Prepared messages
+ * \param[in] msg  Message to add
+ */
+static inline void
+socket_pass_add(ipx_ctx_t *ctx, struct tcp_pass *pass, ipx_msg_t *msg)
+{
+    if (pass->cnt == PASS_MAX) {
+        socket_pass_flush(ctx, pass);
+    }
+
+    pass->msgs[pass->cnt++] = msg;
+}
+
+/**
+ * \brief Receive available data from a socket into the receive buffer of the connection
  *
- * If the whole header is available, the function will allocate message buffer
- * sufficient for the rest of the message.
+ * Data are appended to the unprocessed part of the buffer. If there is no buffer (i.e. all
+ * previously received data have been processed), a new one is allocated first.
+ * Only one recv() call is performed, i.e. the rest of the data is received when the socket is
+ * ready again.
  *
- * \param[in] ctx  Instance data (necessary for passing messages)
+ * \param[in] ctx  Instance context
  * \param[in] pair Connection pair (socket descriptor and session) to receive from
- * \return #IPX_OK on success
+ * \return #IPX_OK on success (even if no data are available right now)
  * \return #IPX_ERR_EOF if the socket has been closed
- * \return #IPX_ERR_FORMAT if the message (or stream) is malformed and the connection MUST be closed
+ * \return #IPX_ERR_FORMAT if the connection failed or has been unexpectedly closed
  * \return #IPX_ERR_NOMEM on a memory allocation error and the connection MUST be closed
  */
 static int
-socket_process_receive_header(ipx_ctx_t *ctx, struct tcp_pair *pair)
+socket_process_receive(ipx_ctx_t *ctx, struct tcp_pair *pair)
 {
-    struct fds_ipfix_msg_hdr hdr = {0};
-    uint8_t *hdr_raw = (uint8_t *) &hdr;
-
-    uint16_t remains = FDS_IPFIX_MSG_HDR_LEN;
-    uint16_t offset = 0;
-    ssize_t len;
-
-    uint8_t *msg_buffer;
-    uint16_t msg_version;
-    uint16_t msg_size;
-
-    assert(!pair->msg || pair->msg_offset < FDS_IPFIX_MSG_HDR_LEN);
-
-    if (pair->msg) {
-        // Fill the header with previously received data
-        offset = pair->msg_offset;
-        remains = FDS_IPFIX_MSG_HDR_LEN - offset;
-
-        memcpy(hdr_raw, pair->msg, offset);
+    if (!pair->buffer) {
+        pair->buffer = ipx_msg_ipfix_buffer_alloc(ctx, RECV_BUFFER_SIZE);
+        if (!pair->buffer) {
+            IPX_CTX_ERROR(ctx,
+                "Connection with '%s' closed due to memory allocation failure! (%s:%d).",
+                pair->session->ident, __FILE__, __LINE__);
+            return IPX_ERR_NOMEM;
+        }
+        pair->buffer_start = 0;
+        pair->buffer_end = 0;
     }
 
-    len = recv(pair->fd, &hdr_raw[offset], remains, 0);
+    const uint32_t partial = pair->buffer_end - pair->buffer_start;
+    const size_t remains = RECV_BUFFER_SIZE - pair->buffer_end;
+    assert(remains > 0 && "The buffer always has a space for the rest of a partial message");
+    ssize_t len = recv(pair->fd, &pair->buffer[pair->buffer_end], remains, 0);
     if (len == 0) {
         // Connection has been closed
-        if (offset > 0) {
+        if (partial > 0) {
             IPX_CTX_WARNING(ctx, "Connection with '%s' has been unexpectly closed",
                 pair->session->ident);
             return IPX_ERR_FORMAT;
@@ -893,122 +946,125 @@ socket_process_receive_header(ipx_ctx_t *ctx, struct tcp_pair *pair)
         return IPX_ERR_FORMAT;
     }
 
-    offset += len;
-
-    if (offset < FDS_IPFIX_MSG_HDR_LEN) {
-        // We don't have whole IPFIX Message header
-        uint8_t *ptr = realloc(pair->msg, offset);
-        if (!ptr) {
-            IPX_CTX_ERROR(ctx,
-                "Connection with '%s' closed due to memory allocation failure! (%s:%d).",
-                pair->session->ident, __FILE__, __LINE__);
-            return IPX_ERR_NOMEM;
-        }
-
-        memcpy(ptr, hdr_raw, offset);
-        pair->msg = ptr;
-        pair->msg_offset = offset;
-        pair->msg_size = offset;
+    pair->buffer_end += (uint32_t) len;
+    return IPX_OK;
+}
 
+/**
+ * \brief Keep only the unprocessed part of the receive buffer
+ *
+ * If everything has been processed, the buffer is released (i.e. it remains only referenced
+ * by messages sliced out of it). If a partly received message (or its header) might not fit
+ * into the rest of the buffer, the message is copied into a new buffer. Otherwise, the rest of
+ * the message will be received into the same buffer.
+ *
+ * \param[in] ctx      Instance context
+ * \param[in] pair     Connection pair (socket descriptor and session)
+ * \param[in] msg_size Size of the partly received message (0, if the header is not complete)
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_NOMEM on a memory allocation error and the connection MUST be closed
+ */
+static int
+socket_process_trim(ipx_ctx_t *ctx, struct tcp_pair *pair, uint16_t msg_size)
+{
+    const uint32_t partial = pair->buffer_end - pair->buffer_start;
+    if (partial == 0) {
+        // Everything has been processed
+        ipx_msg_ipfix_buffer_free(ctx, pair->buffer);
+        pair->buffer = NULL;
         return IPX_OK;
     }
 
-    // Check the IPFIX Message header
-    msg_version = ntohs(hdr.version);
-    msg_size = ntohs(hdr.length);
-
-    if (msg_version != FDS_IPFIX_VERSION || msg_size < FDS_IPFIX_MSG_HDR_LEN) {
-        // Invalid header version
-        IPX_CTX_WARNING(ctx,
-            "Connection with '%s' closed due to invalid IPFIX Message header.",
-            pair->session->ident);
-        return IPX_ERR_FORMAT;
+    const uint32_t required = (msg_size != 0) ? msg_size : FDS_IPFIX_MSG_HDR_LEN;
+    if (pair->buffer_start + required <= RECV_BUFFER_SIZE) {
+        // The rest of the message will fit
+        return IPX_OK;
     }
 
-    // Preallocated buffer for the rest of the IPFIX Message body
-    msg_buffer = realloc(pair->msg, msg_size);
-    if (!msg_buffer) {
+    // The message straddles the edge of the buffer -> copy it into a new buffer
+    uint8_t *buffer_new = ipx_msg_ipfix_buffer_alloc(ctx, RECV_BUFFER_SIZE);
+    if (!buffer_new) {
         IPX_CTX_ERROR(ctx,
             "Connection with '%s' closed due to memory allocation failure! (%s:%d).",
             pair->session->ident, __FILE__, __LINE__);
         return IPX_ERR_NOMEM;
     }
 
-    memcpy(msg_buffer, hdr_raw, FDS_IPFIX_MSG_HDR_LEN);
-    pair->msg = msg_buffer;
-    pair->msg_offset = FDS_IPFIX_MSG_HDR_LEN;
-    pair->msg_size = msg_size;
-
+    memcpy(buffer_new, &pair->buffer[pair->buffer_start], partial);
+    ipx_msg_ipfix_buffer_free(ctx, pair->buffer);
+    pair->buffer = buffer_new;
+    pair->buffer_start = 0;
+    pair->buffer_end = partial;
     return IPX_OK;
 }
 
 /**
- * \brief Try to read an IPFIX Message body
+ * \brief Slice out all fully received IPFIX Messages from the receive buffer
  *
- * The whole body might not be available right now. In that case, the function
- * will only read and store available part and it will successfully return. When
- * this happens, the message offset is smaller that the message size. The next call
- * of this function will tried to read the rest.
+ * Each message is wrapped without copying, i.e. the message refers to its part of the receive
+ * buffer, and prepared to be passed. If the Transport Session hasn't been announced yet,
+ * a Session message is prepared first. A partly received message (if any) is kept in the
+ * receive buffer.
  *
- * \param[in] ctx  Instance data (necessary for passing messages)
- * \param[in] pair Connection pair (socket descriptor and session) to receive from
+ * \param[in] ctx  Instance context
+ * \param[in] pair Connection pair (socket descriptor and session)
+ * \param[in] pass Messages prepared to be passed
  * \return #IPX_OK on success
  * \return #IPX_ERR_FORMAT if the message (or stream) is malformed and the connection MUST be closed
  * \return #IPX_ERR_NOMEM on a memory allocation error and the connection MUST be closed
  */
 static int
-socket_process_receive_body(ipx_ctx_t *ctx, struct tcp_pair *pair)
+socket_process_slice(ipx_ctx_t *ctx, struct tcp_pair *pair, struct tcp_pass *pass)
 {
-    const uint16_t remains = pair->msg_size - pair->msg_offset;
-    assert(pair->msg && pair->msg_offset >= FDS_IPFIX_MSG_HDR_LEN);
-
-    if (remains == 0) {
-        // This is an IPFIX Message without body...
+    if (!pair->buffer) {
+        // Nothing has been received
         return IPX_OK;
     }
 
-    ssize_t len = recv(pair->fd, &pair->msg[pair->msg_offset], remains, 0);
-    if (len == 0) {
-        // Connection closed
-        IPX_CTX_WARNING(ctx, "Connection from '%s' has been unexpectly closed",
-            pair->session->ident);
-        return IPX_ERR_FORMAT;
-    }
-
-    if (len < 0) {
-        // Something went wrong
-        const char *err_str;
+    while (pair->buffer_end - pair->buffer_start >= FDS_IPFIX_MSG_HDR_LEN) {
+        // Messages are not aligned in the buffer -> copy the header
+        uint8_t *msg_raw = &pair->buffer[pair->buffer_start];
+        struct fds_ipfix_msg_hdr hdr;
+        memcpy(&hdr, msg_raw, FDS_IPFIX_MSG_HDR_LEN);
+
+        // Check the IPFIX Message header
+        const uint16_t msg_version = ntohs(hdr.version);
+        const uint16_t msg_size = ntohs(hdr.length);
+        if (msg_version != FDS_IPFIX_VERSION || msg_size < FDS_IPFIX_MSG_HDR_LEN) {
+            // Invalid header version
+            IPX_CTX_WARNING(ctx,
+                "Connection with '%s' closed due to invalid IPFIX Message header.",
+                pair->session->ident);
+            return IPX_ERR_FORMAT;
+        }
 
-        if (errno == EWOULDBLOCK || errno == EAGAIN) {
-            return IPX_OK;
+        if (pair->buffer_end - pair->buffer_start < msg_size) {
+            // Incomplete IPFIX Message, read the rest later...
+            return socket_process_trim(ctx, pair, msg_size);
         }
 
-        ipx_strerror(errno, err_str);
-        IPX_CTX_WARNING(ctx, "Connection with '%s' failed: %s",
-            pair->session->ident, err_str);
-        return IPX_ERR_FORMAT;
-    }
+        if (pair->new_connection) {
+            // Send information about the new Transport Session
+            ipx_msg_session_t *msg = ipx_msg_session_create(pair->session, IPX_MSG_SESSION_OPEN);
+            if (!msg) {
+                IPX_CTX_ERROR(ctx,
+                    "Connection with '%s' closed due to memory allocation failure! (%s:%d).",
+                    pair->session->ident, __FILE__, __LINE__);
+                return IPX_ERR_NOMEM;
+            }
 
-    pair->msg_offset += (uint16_t) len;
-    return IPX_OK;
-}
+            socket_pass_add(ctx, pass, ipx_msg_session2base(msg));
+            pair->new_connection = false;
+        }
 
-/**
- * \brief Try to pass fully received IPFIX Message to the collector.
- *
- * \param[in] ctx  Instance data (necessary for passing messages)
- * \param[in] pair Connection pair (socket descriptor and session)
- * \return #IPX_OK on success
- * \return #IPX_ERR_NOMEM on a memory allocation error and the connection MUST be closed
- */
-static int
-socket_process_pass_msg(ipx_ctx_t *ctx, struct tcp_pair *pair)
-{
-    assert(pair->msg && pair->msg_offset == pair->msg_size && "Partly received message");
+        // Create a message wrapper that refers to the receive buffer and pass the message
+        struct ipx_msg_ctx msg_ctx;
+        msg_ctx.session = pair->session;
+        msg_ctx.odid = ntohl(hdr.odid);
+        msg_ctx.stream = 0; // Streams are not supported over TCP
 
-    if (pair->new_connection) {
-        // Send information about the new Transport Session
-        ipx_msg_session_t *msg = ipx_msg_session_create(pair->session, IPX_MSG_SESSION_OPEN);
+        ipx_msg_ipfix_t *msg = ipx_msg_ipfix_create_ref(ctx, &msg_ctx, pair->buffer, msg_raw,
+            msg_size);
         if (!msg) {
             IPX_CTX_ERROR(ctx,
                 "Connection with '%s' closed due to memory allocation failure! (%s:%d).",
@@ -1016,36 +1072,18 @@ socket_process_pass_msg(ipx_ctx_t *ctx, struct tcp_pair *pair)
             return IPX_ERR_NOMEM;
         }
 
-        ipx_ctx_msg_pass(ctx, ipx_msg_session2base(msg));
-        pair->new_connection = false;
+        socket_pass_add(ctx, pass, ipx_msg_ipfix2base(msg));
+        pair->buffer_start += msg_size;
     }
 
-    // Create a message wrapper and pass the message
-    struct ipx_msg_ctx msg_ctx;
-    msg_ctx.session = pair->session;
-    msg_ctx.odid = ntohl(((struct fds_ipfix_msg_hdr *) pair->msg)->odid);
-    msg_ctx.stream = 0; // Streams are not supported over TCP
-
-    ipx_msg_ipfix_t *msg = ipx_msg_ipfix_create(ctx, &msg_ctx, pair->msg, pair->msg_size);
-    if (!msg) {
-        IPX_CTX_ERROR(ctx,
-            "Connection with '%s' closed due to memory allocation failure! (%s:%d).",
-            pair->session->ident, __FILE__, __LINE__);
-        return IPX_ERR_NOMEM;
-    }
-
-    ipx_ctx_msg_pass(ctx, ipx_msg_ipfix2base(msg));
-
-    pair->msg = NULL;
-    pair->msg_offset = 0;
-    pair->msg_size = 0;
-
-    return IPX_OK;
+    return socket_process_trim(ctx, pair, 0);
 }
 
 /**
- * \brief Get an IPFIX message from a socket and pass it
+ * \brief Get IPFIX messages from a socket and pass them
  *
+ * Available data are received by a single recv() call and all complete messages are passed
+ * at once.
  * \param[in] ctx  Instance data (necessary for passing messages)
  * \param[in] pair Connection pair (socket descriptor and session) to receive from
  * \return #IPX_OK on success
@@ -1056,34 +1094,17 @@ socket_process_pass_msg(ipx_ctx_t *ctx, struct tcp_pair *pair)
 static int
 socket_process(ipx_ctx_t *ctx, struct tcp_pair *pair)
 {
-    int ret;
-
-    if (!pair->msg || pair->msg_offset < FDS_IPFIX_MSG_HDR_LEN) {
-        // Try to receive IPFIX Message header first
-        ret = socket_process_receive_header(ctx, pair);
-        if (ret != IPX_OK) {
-            return ret;
-        }
+    struct tcp_pass pass;
+    pass.cnt = 0;
 
-        if (pair->msg_offset < FDS_IPFIX_MSG_HDR_LEN) {
-            // Incomplete IPFIX Message header, read the rest later...
-            return IPX_OK;
-        }
-    }
-
-    // Receive rest of the message body
-    ret = socket_process_receive_body(ctx, pair);
-    if (ret != IPX_OK) {
-        return ret;
-    }
-
-    if (pair->msg_offset < pair->msg_size) {
-        // Incomplete IPFIX Message body, read the rest later...
-        return IPX_OK;
+    int ret = socket_process_receive(ctx, pair);
+    if (ret == IPX_OK) {
+        ret = socket_process_slice(ctx, pair, &pass);
     }
 
-    // Pass the message
-    return socket_process_pass_msg(ctx, pair);
+    // Already prepared messages MUST be passed before the Transport Session is closed
+    socket_pass_flush(ctx, &pass);
+    return ret;
 }
 
 // -------------------------------------------------------------------------------------------------
@@ -1097,6 +1118,7 @@ ipx_plugin_init(ipx_ctx_t *ctx, const char *params)
         return IPX_ERR_DENIED;
     }
     data->ctx = ctx;
+    ipx_ctx_worker_get(ctx, NULL, &data->listen.worker_cnt);
 
     // Parse configuration
     data->config = config_parse(ctx, params);
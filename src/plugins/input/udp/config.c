@@ -53,6 +53,10 @@
 #define LIFETIME_DATA_DEF (1800)
 /** Default Options Template Lifetime                                                            */
 #define LIFETIME_OPTS_DEF (1800)
+/** Default number of datagrams received by a single system call                                 */
+#define BATCH_SIZE_DEF (32)
+/** Maximal number of datagrams received by a single system call                                 */
+#define BATCH_SIZE_MAX (256)
 
 /*
  * <params>
@@ -61,6 +65,7 @@
  *  <templateLifeTime>...</templateLifeTime>      <!-- optional                  -->
  *  <optionsTemplateLifeTime>...</optionsTemplateLifeTime> <!-- optional         -->
  *  <connectionTimeout>...</connectionTimeout>    <!-- optional                  -->
+ *  <batchSize>...</batchSize>                    <!-- optional                  -->
  * </params>
  */
 
@@ -70,7 +75,8 @@ enum params_xml_nodes {
     NODE_IPADDR,
     NODE_LT_DATA,
     NODE_LT_OPTS,
-    NODE_TIMEOUT
+    NODE_TIMEOUT,
+    NODE_BATCH
 };
 
 /** Definition of the \<params\> node  */
@@ -81,6 +87,7 @@ static const struct fds_xml_args args_params[] = {
     FDS_OPTS_ELEM(NODE_LT_DATA, "templateLifeTime",        FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
     FDS_OPTS_ELEM(NODE_LT_OPTS, "optionsTemplateLifeTime", FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
     FDS_OPTS_ELEM(NODE_TIMEOUT, "connectionTimeout",       FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(NODE_BATCH,   "batchSize",               FDS_OPTS_T_UINT,   FDS_OPTS_P_OPT),
     FDS_OPTS_END
 };
 
@@ -187,6 +194,16 @@ config_parser_root(ipx_ctx_t *ctx, fds_xml_ctx_t *root, struct udp_config *cfg)
             }
             cfg->timeout_conn = (uint16_t) content->val_uint;
             break;
+        case NODE_BATCH:
+            // Number of datagrams per system call
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint < 1 || content->val_uint > BATCH_SIZE_MAX) {
+                IPX_CTX_ERROR(ctx, "Batch size must be between 1..%" PRIu16,
+                    (uint16_t) BATCH_SIZE_MAX);
+                return IPX_ERR_FORMAT;
+            }
+            cfg->batch_size = (uint16_t) content->val_uint;
+            break;
         default:
             // Internal error
             assert(false);
@@ -208,6 +225,7 @@ config_default_set(struct udp_config *cfg)
     cfg->timeout_conn = CONN_TIMEOUT_DEF;
     cfg->lifetime_data = LIFETIME_DATA_DEF;
     cfg->lifetime_opts = LIFETIME_OPTS_DEF;
+    cfg->batch_size = BATCH_SIZE_DEF;
 }
 
 struct udp_config *
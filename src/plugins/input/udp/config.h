@@ -67,6 +67,8 @@ struct udp_config {
     uint16_t lifetime_opts;
     /** Connection timeout                                                                       */
     uint16_t timeout_conn;
+    /** Max number of datagrams received by a single system call (1 == without recvmmsg())     */
+    uint16_t batch_size;
 
     struct {
         /** Size of the array                                                                    */
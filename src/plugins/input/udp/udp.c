@@ -39,6 +39,8 @@
  *
  */
 
+// Get GNU specific recvmmsg() function
+#define _GNU_SOURCE
 #include <ipfixcol2.h>
 
 #include <sys/types.h>
@@ -53,7 +55,10 @@
 #include <errno.h>
 #include <inttypes.h>
 #include <sys/ioctl.h>
+#include <string.h>
+#include <linux/filter.h>
 #include "config.h"
+#include "input_common.h"
 
 /** Identification of an invalid socket descriptor                                               */
 #define INVALID_FD        (-1)
@@ -65,6 +70,10 @@
 #define TIMER_INTERVAL    (2)
 /** Required minimal size of receive buffer size [bytes] (otherwise produces a warning message)  */
 #define UDP_RMEM_REQ      (1024*1024)
+/** Size of a receive slot for batch processing, i.e. max size of a datagram [bytes]             */
+#define SLOT_SIZE         (65536U)
+/** Size of a head of the receive slot (messages that fit are passed without copying) [bytes]    */
+#define SLOT_HEAD_SIZE    (2048U)
 
 /** Plugin description */
 IPX_API struct ipx_plugin_info ipx_plugin_info = {
@@ -74,89 +83,39 @@ IPX_API struct ipx_plugin_info ipx_plugin_info = {
     .name = "udp",
     // Brief description of plugin
     .dsc = "Input plugins for IPFIX/NetFlow v5/v9 over User Datagram Protocol.",
-    // Configuration flags (reserved for future use)
-    .flags = 0,
+    // Configuration flags (multiple workers share the local port)
+    .flags = IPX_PF_WORKERS,
     // Plugin version string (like "1.2.3")
     .version = "2.1.0",
     // Minimal IPFIXcol version string (like "1.2.3")
     .ipx_min = "2.1.0"
 };
 
-/**
- * @struct nf5_msg_hdr
- * @brief NetFlow v5 Packet Header structure
- * @warning All values are stored in Network Byte Order!
- */
-struct __attribute__((__packed__)) nf5_msg_hdr {
-    /// NetFlow export format version number
-    uint16_t version;
-    /// Number of flows exported in this packet (1 - 30)
-    uint16_t count;
-    /// Current time in milliseconds since the export device booted
-    uint32_t sys_uptime;
-    /// Current count of seconds since 0000 UTC 1970
-    uint32_t unix_sec;
-    /// Residual nanoseconds since 0000 UTC 1970
-    uint32_t unix_nsec;
-    /// Sequence counter of total flows seen
-    uint32_t flow_seq;
-    /// Type of flow-switching engine
-    uint8_t  engine_type;
-    /// Slot number of the flow-switching engine
-    uint8_t  engine_id;
-    /// First two bits hold the sampling mode. Remaining 14 bits hold value of sampling interval
-    uint16_t sampling_interval;
-};
-
-/** Version identification in NetFlow v5 header                                                  */
-#define NF5_HDR_VERSION   (5)
-/** Length of NetFlow v5 header (in bytes)                                                       */
-#define NF5_HDR_LEN       (sizeof(struct nf5_msg_hdr))
-
-/**
- * @struct nf9_msg_hdr
- * @brief NetFlow v9 Packet Header structure
- * @warning All values are stored in Network Byte Order!
- */
-struct __attribute__((__packed__)) nf9_msg_hdr {
-    /// Version of Flow Record format exported in this packet
-    uint16_t version;
-    /// The total number of records in the Export Packet
-    uint16_t count;
-    /// Time in milliseconds since this device was first booted
-    uint32_t sys_uptime;
-    /// Time in seconds since 0000 UTC 1970, at which the Export Packet leaves the Exporter
-    uint32_t unix_sec;
-    /// Incremental sequence counter of all Export Packets by the Exporter
-    uint32_t seq_number;
-    /// Exporter Observation Domain
-    uint32_t source_id;
-};
-
-/** Version identification in NetFlow v9 header                                                  */
-#define NF9_HDR_VERSION   (9)
-/** Length of NetFlow v9 header (in bytes)                                                       */
-#define NF9_HDR_LEN       (sizeof(struct nf9_msg_hdr))
-
-
 /** Description of a UDP Transport Session                                                       */
 struct udp_source {
     /** Identification of local socket (on which the data came)                                  */
     int local_fd;
     /** Source (i.e. remote) IP address and port                                                 */
     struct sockaddr_storage src_addr;
+    /** Hash of the identification (local socket, remote IP address and port)                    */
+    uint64_t hash;
 
     /** Description of  the Transport Session                                                    */
     struct ipx_session *session;
 
-    /** Timestamp of check when the source was last seen                                         */
-    time_t last_seen;
-    /** Number of received messages since last check                                             */
-    uint32_t msg_cnt;
+    /** Timer tick in which the source was last seen                                             */
+    uint64_t last_tick;
+    /** Next source in the same slot of the timing wheel                                         */
+    struct udp_source *wheel_next;
     /** No message has been received from the Session yet                                        */
     bool new_connection;
 };
 
+/** Default size of the hash table of active sources (must be a power of two)                    */
+#define ACTIVE_DEF_SIZE   (64)
+/** Number of slots of the timing wheel (must be a power of two)                                 */
+#define WHEEL_SIZE        (256)
+
 /** Instance data                                                                                */
 struct udp_data {
     /** Parsed configuration parameters                                                          */
@@ -171,6 +130,8 @@ struct udp_data {
         int *sockets;
         /** New size of receive buffer (try to change only if not equal to zero)                 */
         int rmem_size;
+        /** Total number of workers sharing the local port (SO_REUSEPORT if more than 1)         */
+        unsigned int worker_cnt;
 
         /** Epoll file descriptor (binded sockets and timer)                                     */
         int epoll_fd;
@@ -178,16 +139,85 @@ struct udp_data {
         int timer_fd;
     } listen; /**< Sockets to listen for data                                                    */
 
+    /** Hash table of active connections (items are struct udp_source)                           */
+    struct ipx_htable active;
+
     struct {
-        /** Size of the array                                                                    */
-        size_t cnt;
-        /** Array of active sources (identification and corresponding Transport Session)         */
-        struct udp_source **sources;
-    } active; /**< Active connections                                                            */
+        /** Lists of sources to check in the corresponding timer tick (modulo #WHEEL_SIZE)       */
+        struct udp_source *slots[WHEEL_SIZE];
+        /** Number of timer ticks since the start of the instance                                */
+        uint64_t now;
+        /** Number of timer ticks without any message after which a source is closed             */
+        uint64_t timeout;
+    } wheel; /**< Timing wheel of inactivity timeouts                                            */
+
+    struct {
+        /** Number of receive slots (i.e. max number of datagrams per recvmmsg() call)           */
+        unsigned int cnt;
+        /** Headers of the receive slots (NULL if batch processing is disabled)                  */
+        struct mmsghdr *hdrs;
+        /** I/O vectors of the receive slots (head and tail of each slot)                        */
+        struct iovec *iovs;
+        /** Source addresses of received datagrams                                               */
+        struct sockaddr_storage *addrs;
+        /** Tails of the receive slots (i.e. overflow areas of large datagrams)                  */
+        uint8_t *tails;
+
+        /** Messages prepared to be passed (up to 2 messages per datagram)                       */
+        ipx_msg_t **msgs;
+        /** Number of prepared messages                                                          */
+        uint32_t msgs_cnt;
+    } batch; /**< Batch processing of datagrams                                                  */
 };
 
 // -------------------------------------------------------------------------------------------------
 
+/**
+ * \brief Attach a program that distributes datagrams among sockets of workers
+ *
+ * All sockets bound to the same local address and port with SO_REUSEPORT form a group and the
+ * program selects the socket by a hash of the source IP address of each datagram. Sockets of
+ * workers are added to the group in the order of their initialization. Therefore, all
+ * datagrams of an exporter are received by the same worker, regardless of its source port.
+ * \param[in] sd      Socket descriptor (with SO_REUSEPORT)
+ * \param[in] workers Number of sockets in the group
+ * \return 0 on success, -1 otherwise (errno is set appropriately)
+ */
+static int
+address_steer(int sd, unsigned int workers)
+{
+    struct sock_filter code[] = {
+        // A = version of the IP header
+        BPF_STMT(BPF_LD  | BPF_B   | BPF_ABS, SKF_NET_OFF + 0),
+        BPF_STMT(BPF_ALU | BPF_RSH | BPF_K,   4),
+        BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K,   4, 0, 2),
+        // IPv4: A = source address
+        BPF_STMT(BPF_LD  | BPF_W   | BPF_ABS, SKF_NET_OFF + 12),
+        BPF_JUMP(BPF_JMP | BPF_JA,            10, 0, 0),
+        // IPv6: A = XOR of all words of the source address
+        BPF_STMT(BPF_LD  | BPF_W   | BPF_ABS, SKF_NET_OFF + 8),
+        BPF_STMT(BPF_MISC | BPF_TAX,          0),
+        BPF_STMT(BPF_LD  | BPF_W   | BPF_ABS, SKF_NET_OFF + 12),
+        BPF_STMT(BPF_ALU | BPF_XOR | BPF_X,   0),
+        BPF_STMT(BPF_MISC | BPF_TAX,          0),
+        BPF_STMT(BPF_LD  | BPF_W   | BPF_ABS, SKF_NET_OFF + 16),
+        BPF_STMT(BPF_ALU | BPF_XOR | BPF_X,   0),
+        BPF_STMT(BPF_MISC | BPF_TAX,          0),
+        BPF_STMT(BPF_LD  | BPF_W   | BPF_ABS, SKF_NET_OFF + 20),
+        BPF_STMT(BPF_ALU | BPF_XOR | BPF_X,   0),
+        // Return index of the socket: (A * golden ratio >> 16) % workers
+        BPF_STMT(BPF_ALU | BPF_MUL | BPF_K,   0x9E3779B1U),
+        BPF_STMT(BPF_ALU | BPF_RSH | BPF_K,   16),
+        BPF_STMT(BPF_ALU | BPF_MOD | BPF_K,   workers),
+        BPF_STMT(BPF_RET | BPF_A,             0)
+    };
+
+    struct sock_fprog prog;
+    prog.len = sizeof(code) / sizeof(code[0]);
+    prog.filter = code;
+    return setsockopt(sd, SOL_SOCKET, SO_ATTACH_REUSEPORT_CBPF, &prog, sizeof(prog));
+}
+
 /**
  * \brief Create a new socket, bind it to a local address and enable listening for connections
  *
@@ -197,11 +227,12 @@ struct udp_data {
  * \param[in] addrlen  Size of the address
  * \param[in] ipv6only Accept only IPv6 addresses (only for AF_INET6 and the wildcard address)
  * \param[in] rbuffer  Change the receive buffer size (ignored, if zero or negative)
+ * \param[in] workers  Number of workers sharing the address (SO_REUSEPORT if more than 1)
  * \return On failure returns #INVALID_FD. Otherwise returns valid socket descriptor.
  */
 static int
 address_bind(ipx_ctx_t *ctx, const struct sockaddr *addr, socklen_t addrlen, bool ipv6only,
-    int rbuffer)
+    int rbuffer, unsigned int workers)
 {
     sa_family_t family = addr->sa_family;
     assert(family == AF_INET || family == AF_INET6);
@@ -223,6 +254,15 @@ address_bind(ipx_ctx_t *ctx, const struct sockaddr *addr, socklen_t addrlen, boo
             "the port can be used again. (error: %s)", err_str);
     }
 
+    // Share the port with other workers
+    if (workers > 1 && setsockopt(sd, SOL_SOCKET, SO_REUSEPORT, &on, sizeof(on)) == -1) {
+        ipx_strerror(errno, err_str);
+        IPX_CTX_ERROR(ctx, "Cannot turn on socket option SO_REUSEPORT required by multiple "
+            "workers: %s", err_str);
+        close(sd);
+        return INVALID_FD;
+    }
+
     // Make sure that IPv6 only is disabled
     if (family == AF_INET6) {
         if (!ipv6only && setsockopt(sd, IPPROTO_IPV6, IPV6_V6ONLY, &off, sizeof(off)) == -1) {
@@ -285,6 +325,14 @@ address_bind(ipx_ctx_t *ctx, const struct sockaddr *addr, socklen_t addrlen, boo
         return INVALID_FD;
     }
 
+    // Pin each exporter to one worker
+    if (workers > 1 && address_steer(sd, workers) == -1) {
+        ipx_strerror(errno, err_str);
+        IPX_CTX_WARNING(ctx, "Failed to attach a steering program to the socket (local IP: %s, "
+            "port %" PRIu16 "). Messages of an exporter that uses multiple source ports might be "
+            "processed by different workers. (error: %s)", addr_str, port, err_str);
+    }
+
     IPX_CTX_INFO(ctx, "Bind succeed on %s (port %" PRIu16 ")", addr_str, port);
     return sd;
 }
@@ -322,7 +370,7 @@ listener_bind(struct udp_data *instance)
         addr.sin6_addr = in6addr_any;
 
         int sd = address_bind(instance->ctx, (struct sockaddr *) &addr, sizeof(addr), false,
-            instance->listen.rmem_size);
+            instance->listen.rmem_size, instance->listen.worker_cnt);
         if (sd == INVALID_FD) {
             free(sockets);
             return IPX_ERR_DENIED;
@@ -375,7 +423,7 @@ listener_bind(struct udp_data *instance)
         }
 
         int sd = address_bind(instance->ctx, (struct sockaddr *) &addr_helper, addrlen, ipv6only,
-            instance->listen.rmem_size);
+            instance->listen.rmem_size, instance->listen.worker_cnt);
         if (sd == INVALID_FD) {
             // Failed
             break;
@@ -543,17 +591,114 @@ listener_destroy(struct udp_data *instance)
     close(instance->listen.timer_fd);
 }
 
+/**
+ * \brief Calculate a hash of a source identification
+ * \param[in] src_fd Socket descriptor of local address on which the source data come
+ * \param[in] addr   Remote IPv4/IPv6 address (and port)
+ * \return Hash value
+ */
+static inline uint64_t
+active_hash(int src_fd, const struct sockaddr *addr)
+{
+    uint64_t key = (uint64_t) (unsigned int) src_fd * 0x9E3779B97F4A7C15ULL;
+    if (addr->sa_family == AF_INET) {
+        const struct sockaddr_in *addr_v4 = (const struct sockaddr_in *) addr;
+        key ^= ((uint64_t) addr_v4->sin_addr.s_addr << 16) | addr_v4->sin_port;
+    } else {
+        const struct sockaddr_in6 *addr_v6 = (const struct sockaddr_in6 *) addr;
+        uint64_t parts[2];
+        memcpy(parts, &addr_v6->sin6_addr, sizeof(parts));
+        key ^= parts[0] ^ (parts[1] * 0xC2B2AE3D27D4EB4FULL) ^ addr_v6->sin6_port;
+    }
+
+    return ipx_htable_mix(key);
+}
+
+/**
+ * \brief Check if a source matches a given identification
+ * \param[in] src    Source to compare
+ * \param[in] src_fd Socket descriptor of local address on which the source data come
+ * \param[in] addr   Remote IPv4/IPv6 address (and port)
+ * \return True if matches, false otherwise
+ */
+static inline bool
+active_match(const struct udp_source *src, int src_fd, const struct sockaddr *addr)
+{
+    if (src->local_fd != src_fd) {
+        return false; // Different local socket
+    }
+
+    if (src->src_addr.ss_family != addr->sa_family) {
+        return false; // Different IP address family (IPv4 vs IPv6)
+    }
+
+    if (addr->sa_family == AF_INET) {
+        // IPv4 addresses
+        const struct sockaddr_in *to_find = (const struct sockaddr_in *) addr;
+        const struct sockaddr_in *to_cmp = (const struct sockaddr_in *) &src->src_addr;
+        return to_find->sin_port == to_cmp->sin_port
+            && memcmp(&to_find->sin_addr, &to_cmp->sin_addr, sizeof(struct in_addr)) == 0;
+    }
+
+    // IPv6 addresses
+    assert(addr->sa_family == AF_INET6);
+    const struct sockaddr_in6 *to_find = (const struct sockaddr_in6 *) addr;
+    const struct sockaddr_in6 *to_cmp = (const struct sockaddr_in6 *) &src->src_addr;
+    return to_find->sin6_port == to_cmp->sin6_port
+        && memcmp(&to_find->sin6_addr, &to_cmp->sin6_addr, sizeof(struct in6_addr)) == 0;
+}
+
+/** Identification of a source (key of the hash table of active sources)                         */
+struct active_key {
+    /** Socket descriptor of local address on which the source data come                         */
+    int src_fd;
+    /** Remote IPv4/IPv6 address (and port)                                                      */
+    const struct sockaddr *addr;
+};
+
+/**
+ * \brief Compare a source with an identification (callback of the hash table)
+ * \param[in] item Source
+ * \param[in] key  Identification (struct active_key)
+ * \return True if matches, false otherwise
+ */
+static inline bool
+active_eq(const void *item, const void *key)
+{
+    const struct active_key *id = key;
+    return active_match(item, id->src_fd, id->addr);
+}
+
+/**
+ * \brief Schedule an inactivity check of a source in the timing wheel
+ *
+ * The check is planned to the first timer tick in which the source could be considered
+ * inactive (based on the tick in which it was last seen).
+ * \param[in] instance Instance data
+ * \param[in] src      Source (must not be in the wheel)
+ */
+static inline void
+wheel_schedule(struct udp_data *instance, struct udp_source *src)
+{
+    const uint64_t due = src->last_tick + instance->wheel.timeout + 1;
+    struct udp_source **slot = &instance->wheel.slots[due & (WHEEL_SIZE - 1)];
+    src->wheel_next = *slot;
+    *slot = src;
+}
+
 /**
  * \brief Add a new record of a Transport Session
  *
- * New record is added into the list of active connections.
+ * New record is added into the table of active connections and its inactivity check is
+ * scheduled.
  * \param[in] instance Instance data
  * \param[in] src_fd   Socket descriptor of local address on which the source data come
  * \param[in] src_addr Remote IPv4/IPv6 address to add
+ * \param[in] hash     Hash of the source identification (see active_hash())
  * \return Pointer to the newly added record or NULL (memory allocation error)
  */
 static struct udp_source *
-active_add(struct udp_data *instance, int src_fd, const struct sockaddr *src_addr)
+active_add(struct udp_data *instance, int src_fd, const struct sockaddr *src_addr, uint64_t hash)
 {
     socklen_t src_addrlen;
 
@@ -631,15 +776,13 @@ active_add(struct udp_data *instance, int src_fd, const struct sockaddr *src_add
 
     rec2add->local_fd = src_fd;
     memcpy(&rec2add->src_addr, src_addr, src_addrlen);
+    rec2add->hash = hash;
     rec2add->session = session;
-    rec2add->last_seen = time(NULL); // now!
-    rec2add->msg_cnt = 0;
+    rec2add->last_tick = instance->wheel.now; // now!
     rec2add->new_connection = true; // Session Message hasn't been send yet
 
-    // Append the list of active connections
-    const size_t new_size = (instance->active.cnt + 1) * sizeof(struct udp_source *);
-    struct udp_source **new_sources = realloc(instance->active.sources, new_size);
-    if (!new_sources) {
+    // Insert into the table of active connections
+    if (ipx_htable_reserve(&instance->active) != IPX_OK) {
         IPX_CTX_ERROR(instance->ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
         free(rec2add);
         ipx_session_destroy(session);
@@ -647,26 +790,23 @@ active_add(struct udp_data *instance, int src_fd, const struct sockaddr *src_add
     }
 
     IPX_CTX_INFO(instance->ctx, "New exporter connected from '%s'.", src_addr_str);
-    new_sources[instance->active.cnt] = rec2add;
-    instance->active.sources = new_sources;
-    instance->active.cnt++;
+    ipx_htable_insert(&instance->active, hash, rec2add);
+    wheel_schedule(instance, rec2add);
     return rec2add;
 }
 
 /**
- * \brief Remove an active Transport Session with a given index
+ * \brief Remove an active Transport Session
  *
  * Generate and pass a Session Message - connect event (if necessary) and remove the corresponding
- * session (defined by an index) from the list.
- * \note After removing of the Session the array of active Transport Sessions is not order by
- *   activity anymore.
+ * session from the table of active connections.
+ * \warning The source must be already removed from the timing wheel!
  * \param[in] instance Instance data
- * \param[in] idx      Index of the instance to remove
+ * \param[in] src      Source to remove
  */
 static void
-active_remove_by_id(struct udp_data *instance, size_t idx)
+active_remove(struct udp_data *instance, struct udp_source *src)
 {
-    struct udp_source *src = instance->active.sources[idx];
     IPX_CTX_INFO(instance->ctx, "Transport Session '%s' closed!", src->session->ident);
 
     // Have we received at least one valid record?
@@ -699,15 +839,10 @@ active_remove_by_id(struct udp_data *instance, size_t idx)
     }
 
     // Now we can free the wrapper
+    struct ipx_htable_slot *slot = ipx_htable_find_item(&instance->active, src->hash, src);
+    assert(slot != NULL && "The source must be present!");
+    ipx_htable_remove(&instance->active, slot);
     free(src);
-    if (idx == instance->active.cnt - 1) {
-        // The last element in the array
-        instance->active.cnt--;
-    } else {
-        // Replace it with the last one
-        instance->active.sources[idx] = instance->active.sources[instance->active.cnt - 1];
-        instance->active.cnt--;
-    }
 }
 
 /**
@@ -716,67 +851,23 @@ active_remove_by_id(struct udp_data *instance, size_t idx)
  * \param[in] instance Instance data
  * \param[in] src_fd   Socket descriptor of local address on which the source data come
  * \param[in] addr     Remote IPv4/IPv6 Address to find
+ * \param[in] hash     Hash of the source identification (see active_hash())
  * \return Pointer to the record or NULL (the record doesn't exist)
  */
-static struct udp_source *
-active_find(struct udp_data *instance, int src_fd, const struct sockaddr *addr)
+static inline struct udp_source *
+active_find(const struct udp_data *instance, int src_fd, const struct sockaddr *addr,
+    uint64_t hash)
 {
-    size_t idx;
-
-    // The array is not sorted, we have to go through
-    for (idx = 0; idx < instance->active.cnt; ++idx) {
-        struct udp_source *src = instance->active.sources[idx];
-        if (src->local_fd != src_fd) {
-            continue; // Different local socket
-        }
-
-        if (src->src_addr.ss_family != addr->sa_family) {
-            continue; // Different IP address family (IPv4 vs IPv6)
-        }
-
-        if (addr->sa_family == AF_INET) {
-            // IPv4 addresses
-            const struct sockaddr_in *to_find = (const struct sockaddr_in *) addr;
-            const struct sockaddr_in *to_cmp = (const struct sockaddr_in *) &src->src_addr;
-            if (to_find->sin_port != to_cmp->sin_port) {
-                continue; // Different ports
-            }
-
-            if (memcmp(&to_find->sin_addr, &to_cmp->sin_addr, sizeof(struct in_addr)) != 0) {
-                continue;
-            }
-            // Found
-            break;
-        } else {
-            // IPv6 addresses
-            assert(addr->sa_family == AF_INET6);
-            const struct sockaddr_in6 *to_find = (const struct sockaddr_in6 *) addr;
-            const struct sockaddr_in6 *to_cmp = (const struct sockaddr_in6 *) &src->src_addr;
-            if (to_find->sin6_port != to_cmp->sin6_port) {
-                continue; // Different ports
-            }
-
-            if (memcmp(&to_find->sin6_addr, &to_cmp->sin6_addr, sizeof(struct in6_addr)) != 0) {
-                continue;
-            }
-            // Found
-            break;
-        }
-    }
-
-    if (idx == instance->active.cnt) {
-        // Not found
-        return NULL;
-    }
-
-    return instance->active.sources[idx];
+    const struct active_key key = {src_fd, addr};
+    struct ipx_htable_slot *slot = ipx_htable_find(&instance->active, hash, &active_eq, &key);
+    return (slot != NULL) ? slot->item : NULL;
 }
 
 /**
  * \brief Get a reference to a Transport Session
  *
  * First, try to find in among already active Transport Sessions. If it is not present, create
- * a new one and store it into the array of active Sessions.
+ * a new one and store it into the table of active Sessions.
  * \param[in] instance Instance data
  * \param[in] src_fd   Socket descriptor to which is the Session connected
  * \param[in] addr     Remove IPv4/IPv6 address (and port) of the session
@@ -786,84 +877,49 @@ static struct udp_source *
 active_get(struct udp_data *instance, int src_fd, const struct sockaddr *addr)
 {
     // Try to find
-    struct udp_source *src = active_find(instance, src_fd, addr);
+    const uint64_t hash = active_hash(src_fd, addr);
+    struct udp_source *src = active_find(instance, src_fd, addr, hash);
     if (src != NULL) {
         return src;
     }
 
     // Not found, add a new record
-    return active_add(instance, src_fd, addr);
-}
-
-/**
- * \brief Compare 2 active Transport Session by activity
- *
- * \note The sessions are primary sorted by number of messages received since the last reset of
- * counters. Secondary, if the both counters are zero, the sessions are sorted by the timestamp
- * of their last occurrence.
- * \param p1 First Transport Session
- * \param p2 Second Transport Session
- * \return
- *   The comparison function returns an integer less than, equal to, or greater than zero if the
- *   first Session is considered to be respectively more, equal to, or less active than the
- *   second.
- */
-static int
-active_cmp_activity(const void *p1, const void *p2)
-{
-    const struct udp_source *left =  *(const struct udp_source **) p1;
-    const struct udp_source *right = *(const struct udp_source **) p2;
-
-    // Primary, compare by number of messages since the last reset of counter
-    if (left->msg_cnt != right->msg_cnt) {
-        return (left->msg_cnt > right->msg_cnt) ? (-1) : 1; // Sort in descending order
-    }
-
-    if (left->msg_cnt != 0) {
-        // Both have the same non-zero value of counters,
-        return 0;
-    }
-
-    assert(left->msg_cnt == 0 && right->msg_cnt == 0);
-    // Secondary, compare by the last seen timestamps
-    if (left->last_seen == right->last_seen) {
-        return 0;
-    }
-
-    return (left->last_seen > right->last_seen) ? (-1) : 1;
+    return active_add(instance, src_fd, addr, hash);
 }
 
 /**
- * \brief Sort all active Transport Session by activity and reset activity counters
+ * \brief Advance the timing wheel by one tick and close inactive Transport Sessions
  *
- * The most active Transport Session go to the front. Activity is compared by number of received
- * IPFIX Messages since the last restart of counters.
+ * Only sources planned to the new tick are checked. Sources that have been seen since they
+ * were scheduled are planned again based on their last activity, the others are closed.
+ * Therefore, the per-message processing doesn't have to touch the wheel at all.
  * \param[in] instance Instance data
  */
 static void
-active_sort_and_reset(struct udp_data *instance)
+wheel_tick(struct udp_data *instance)
 {
-    const size_t rec_size = sizeof(*instance->active.sources);
-    qsort(instance->active.sources, instance->active.cnt, rec_size, &active_cmp_activity);
-
-    time_t now = time(NULL);
-    for (size_t i = 0; i < instance->active.cnt; ++i) {
-        struct udp_source *src = instance->active.sources[i];
-        if (src->msg_cnt == 0) {
-            // No new messages since the last check
-            continue;
+    const uint64_t now = ++instance->wheel.now;
+    struct udp_source **slot = &instance->wheel.slots[now & (WHEEL_SIZE - 1)];
+    struct udp_source *src = *slot;
+    *slot = NULL; // Rescheduled sources can be planned into the same slot again
+
+    while (src != NULL) {
+        struct udp_source *next = src->wheel_next;
+        if (src->last_tick + instance->wheel.timeout < now) {
+            // Remove and generate Session message - close event, if necessary
+            active_remove(instance, src);
+        } else {
+            wheel_schedule(instance, src);
         }
-
-        src->last_seen = now;
-        src->msg_cnt = 0;
+        src = next;
     }
 }
 
 /**
  * \brief Process a timer event
  *
- * Sort all sources by their activity (number of messages sent between timer events) and
- * close inactive Transport Sessions.
+ * Advance the timing wheel by the number of expired timer intervals and close inactive
+ * Transport Sessions.
  * \param[in] instance Instance data
  * \param[in] fd       File descriptor of a timer
  */
@@ -882,32 +938,106 @@ process_timer(struct udp_data *instance, int fd)
         return;
     }
 
-    // The inactive Transport Sessions will be at the end of the (sorted) array
-    active_sort_and_reset(instance);
+    if (event_cnt > WHEEL_SIZE) {
+        // Missed ticks, one round of the wheel is enough to check all sources
+        instance->wheel.now += event_cnt - WHEEL_SIZE;
+        event_cnt = WHEEL_SIZE;
+    }
 
-    time_t now = time(NULL);
-    size_t idx;
-    for (idx = 0; idx < instance->active.cnt; ++idx) {
-        if (instance->active.sources[idx]->last_seen + instance->config->timeout_conn >= now) {
-            continue;
-        }
+    for (uint64_t i = 0; i < event_cnt; ++i) {
+        wheel_tick(instance);
+    }
 
-        // Close this Session and all that follows
-        break;
+    IPX_CTX_DEBUG(instance->ctx, "The instance holds information about %zu active session(s).",
+        instance->active.used);
+}
+
+/**
+ * \brief Add a message to the array of messages to pass
+ * \param[in] instance Instance data
+ * \param[in] msg      Message
+ */
+static inline void
+pass_add(struct udp_data *instance, ipx_msg_t *msg)
+{
+    assert(instance->batch.msgs_cnt < 2U * instance->batch.cnt);
+    instance->batch.msgs[instance->batch.msgs_cnt++] = msg;
+}
+
+/**
+ * \brief Pass all prepared messages at once
+ * \param[in] instance Instance data
+ */
+static void
+pass_flush(struct udp_data *instance)
+{
+    if (instance->batch.msgs_cnt == 0) {
+        return;
     }
 
-    while (idx < instance->active.cnt) {
-        // Remove and generate Session message - close event, if necessary
-        assert(instance->active.sources[idx]->last_seen + instance->config->timeout_conn < now);
-        active_remove_by_id(instance, idx);
+    ipx_ctx_msg_pass_batch(instance->ctx, instance->batch.msgs, instance->batch.msgs_cnt);
+    instance->batch.msgs_cnt = 0;
+}
+
+/**
+ * \brief Process a received IPFIX/NetFlow message
+ *
+ * Check the message header and extract ODID/Source ID. If it is the first valid message of the
+ * Transport Session, a Session message is prepared first. The message is wrapped and added to
+ * the messages to pass (see pass_flush()).
+ * \note The buffer is always consumed (i.e. wrapped or freed).
+ * \param[in] instance Instance data
+ * \param[in] source   Source of the message
+ * \param[in] buffer   Message (allocated by ipx_msg_ipfix_buffer_alloc())
+ * \param[in] msg_size Size of the message
+ */
+static void
+process_datagram(struct udp_data *instance, struct udp_source *source, uint8_t *buffer,
+    uint16_t msg_size)
+{
+    // Check NetFlow/IPFIX header length and extract ODID/Source ID
+    uint32_t msg_odid;
+    if (!input_msg_check(buffer, msg_size, false, &msg_odid)) {
+        IPX_CTX_ERROR(instance->ctx, "Receiver an invalid NetFlow/IPFIX Message header from '%s'. "
+            "The message will be dropped!", source->session->ident);
+        ipx_msg_ipfix_buffer_free(instance->ctx, buffer);
+        return;
     }
 
-    IPX_CTX_DEBUG(instance->ctx, "The instance holds information about %zu active session(s).",
-        instance->active.cnt);
+    if (source->new_connection) {
+        // Send information about the new Transport Session
+        source->new_connection = false;
+        ipx_msg_session_t *msg = ipx_msg_session_create(source->session, IPX_MSG_SESSION_OPEN);
+        if (!msg) {
+            IPX_CTX_WARNING(instance->ctx, "Failed to create a Session message! Instances of "
+                "plugins will not be informed about the new Transport Session '%s' (%s:%d).",
+                source->session->ident, __FILE__, __LINE__);
+        } else {
+            pass_add(instance, ipx_msg_session2base(msg));
+        }
+    }
+
+    // Create a message wrapper and pass the message
+    struct ipx_msg_ctx msg_ctx;
+    msg_ctx.session = source->session;
+    msg_ctx.odid = msg_odid;
+    msg_ctx.stream = 0; // Streams are not supported over UDP
+
+    ipx_msg_ipfix_t *msg = ipx_msg_ipfix_create(instance->ctx, &msg_ctx, buffer, msg_size);
+    if (!msg) {
+        IPX_CTX_ERROR(instance->ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+        ipx_msg_ipfix_buffer_free(instance->ctx, buffer);
+        return;
+    }
+
+    pass_add(instance, ipx_msg_ipfix2base(msg));
+    source->last_tick = instance->wheel.now;
 }
 
 /**
  * \brief Get an IPFIX/NetFlow message from a socket and pass it
+ *
+ * \note Used only if batch processing is disabled (i.e. batch size is 1).
  * \param[in] instance Instance data
  * \param[in] sd       File descriptor of the socket
  */
@@ -940,8 +1070,8 @@ process_socket(struct udp_data *instance, int sd)
         return;
     }
 
-    // Allocate the buffer
-    uint8_t *buffer = malloc(msg_size * sizeof(uint8_t));
+    // Allocate the buffer (from the pool of the collector)
+    uint8_t *buffer = ipx_msg_ipfix_buffer_alloc(instance->ctx, (size_t) msg_size);
     if (!buffer) {
         IPX_CTX_ERROR(instance->ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
         return;
@@ -955,95 +1085,188 @@ process_socket(struct udp_data *instance, int sd)
         // Failed
         ipx_strerror(errno, err_str);
         IPX_CTX_ERROR(instance->ctx, "Failed to read a datagram. recvfrom() failed %s", err_str);
-        free(buffer);
+        ipx_msg_ipfix_buffer_free(instance->ctx, buffer);
         return;
     }
 
     if (ret != msg_size) {
         IPX_CTX_ERROR(instance->ctx, "Read operation failed! Got %zu of %zu bytes!",
             (size_t) ret, (size_t) msg_size);
-        free(buffer);
+        ipx_msg_ipfix_buffer_free(instance->ctx, buffer);
         return;
     }
 
     // Find the source
     struct udp_source *source = active_get(instance, sd, (struct sockaddr *) &addr);
     if (!source) { // Memory allocation error!
-        free(buffer);
+        ipx_msg_ipfix_buffer_free(instance->ctx, buffer);
         return;
     }
 
-    // Check NetFlow/IPFIX header length and extract ODID/Source ID
-    const uint16_t msg_ver = ntohs(*(uint16_t *) buffer);
-    uint32_t msg_odid = 0;
-    bool is_len_ok = true;
-
-    switch (msg_ver) {
-    case FDS_IPFIX_VERSION: // IPFIX
-        if (msg_size < FDS_IPFIX_MSG_HDR_LEN) {
-            is_len_ok = false;
-            break;
-        }
+    process_datagram(instance, source, buffer, (uint16_t) msg_size);
+    pass_flush(instance);
+}
 
-        msg_odid = ntohl(((const struct fds_ipfix_msg_hdr *) buffer)->odid);
-        break;
-    case NF9_HDR_VERSION: // NetFlow v9
-        if (msg_size < (int) NF9_HDR_LEN) {
-            is_len_ok = false;
-            break;
-        }
+/**
+ * \brief Get multiple IPFIX/NetFlow messages from a socket and pass them
+ *
+ * Datagrams are received by a single recvmmsg() call into preallocated receive slots. Each slot
+ * consists of a head (a buffer from the pool of the instance) and a tail (an overflow area).
+ * Messages that fit into the head are passed without copying and the slot gets a new head
+ * before the next call. Larger messages are copied into a new buffer of the exact size.
+ * \param[in] instance Instance data
+ * \param[in] sd       File descriptor of the socket
+ */
+static void
+process_socket_batch(struct udp_data *instance, int sd)
+{
+    struct mmsghdr *hdrs = instance->batch.hdrs;
+    struct iovec *iovs = instance->batch.iovs;
+    const char *err_str;
 
-        msg_odid = ntohl(((const struct nf9_msg_hdr *) buffer)->source_id);
-        break;
-    case NF5_HDR_VERSION: // NetFlow v5
-        if (msg_size < (int) NF5_HDR_LEN) {
-            is_len_ok = false;
-            break;
+    // Prepare heads of the receive slots
+    unsigned int slot_cnt;
+    for (slot_cnt = 0; slot_cnt < instance->batch.cnt; ++slot_cnt) {
+        struct iovec *head = &iovs[2 * slot_cnt];
+        if (!head->iov_base) {
+            head->iov_base = ipx_msg_ipfix_buffer_alloc(instance->ctx, SLOT_HEAD_SIZE);
+            if (!head->iov_base) {
+                break;
+            }
         }
 
-        // Source ID is not available in NetFlow v5 -> always 0
-        msg_odid = 0;
-        break;
-    default:
-        is_len_ok = false;
-        break;
+        hdrs[slot_cnt].msg_hdr.msg_namelen = sizeof(instance->batch.addrs[slot_cnt]);
     }
 
-    if (!is_len_ok) {
-        IPX_CTX_ERROR(instance->ctx, "Receiver an invalid NetFlow/IPFIX Message header from '%s'. "
-            "The message will be dropped!", source->session->ident);
-        free(buffer);
+    if (slot_cnt == 0) {
+        IPX_CTX_ERROR(instance->ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
         return;
     }
 
-    if (source->new_connection) {
-        // Send information about the new Transport Session
-        source->new_connection = false;
-        ipx_msg_session_t *msg = ipx_msg_session_create(source->session, IPX_MSG_SESSION_OPEN);
-        if (!msg) {
-            IPX_CTX_WARNING(instance->ctx, "Failed to create a Session message! Instances of "
-                "plugins will not be informed about the new Transport Session '%s' (%s:%d).",
-                source->session->ident, __FILE__, __LINE__);
+    int recv_cnt = recvmmsg(sd, hdrs, slot_cnt, MSG_DONTWAIT, NULL);
+    if (recv_cnt == -1) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            return; // Nothing to read
+        }
+
+        ipx_strerror(errno, err_str);
+        IPX_CTX_ERROR(instance->ctx, "Failed to read datagrams. recvmmsg() failed: %s", err_str);
+        return;
+    }
+
+    struct udp_source *source = NULL;
+    for (int i = 0; i < recv_cnt; ++i) {
+        const struct msghdr *hdr = &hdrs[i].msg_hdr;
+        const unsigned int msg_size = hdrs[i].msg_len;
+        if ((hdr->msg_flags & MSG_TRUNC) != 0 || msg_size < sizeof(uint16_t)
+                || msg_size > UINT16_MAX) {
+            IPX_CTX_WARNING(instance->ctx, "Received an invalid datagram (%u bytes long)",
+                msg_size);
+            continue;
+        }
+
+        // Consecutive datagrams usually come from the same source
+        const struct sockaddr *addr = (const struct sockaddr *) hdr->msg_name;
+        if (!source || !active_match(source, sd, addr)) {
+            source = active_get(instance, sd, addr);
+            if (!source) { // Memory allocation error!
+                continue;
+            }
+        }
+
+        struct iovec *head = &iovs[2 * i];
+        uint8_t *buffer;
+        if (msg_size <= SLOT_HEAD_SIZE) {
+            // Take the head of the slot
+            buffer = head->iov_base;
+            head->iov_base = NULL;
         } else {
-            ipx_ctx_msg_pass(instance->ctx, ipx_msg_session2base(msg));
+            buffer = ipx_msg_ipfix_buffer_alloc(instance->ctx, msg_size);
+            if (!buffer) {
+                IPX_CTX_ERROR(instance->ctx, "Memory allocation failed! (%s:%d)", __FILE__,
+                    __LINE__);
+                continue;
+            }
+
+            memcpy(buffer, head->iov_base, SLOT_HEAD_SIZE);
+            memcpy(buffer + SLOT_HEAD_SIZE, head[1].iov_base, msg_size - SLOT_HEAD_SIZE);
         }
+
+        process_datagram(instance, source, buffer, (uint16_t) msg_size);
     }
 
-    // Create a message wrapper and pass the message
-    struct ipx_msg_ctx msg_ctx;
-    msg_ctx.session = source->session;
-    msg_ctx.odid = msg_odid;
-    msg_ctx.stream = 0; // Streams are not supported over UDP
+    pass_flush(instance);
+}
 
-    ipx_msg_ipfix_t *msg = ipx_msg_ipfix_create(instance->ctx, &msg_ctx, buffer, (uint16_t) msg_size);
-    if (!msg) {
-        IPX_CTX_ERROR(instance->ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
-        free(buffer);
-        return;
+/**
+ * \brief Initialize structures for batch processing of datagrams
+ *
+ * Heads of the receive slots are allocated later by the thread of the instance (i.e. the owner
+ * of the pool of buffers).
+ * \param[in] instance Instance data
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_NOMEM if a memory allocation error has occurred
+ */
+static int
+batch_init(struct udp_data *instance)
+{
+    const unsigned int cnt = instance->config->batch_size;
+    instance->batch.cnt = cnt;
+    instance->batch.msgs_cnt = 0;
+    instance->batch.msgs = calloc(2U * cnt, sizeof(*instance->batch.msgs));
+    if (!instance->batch.msgs) {
+        return IPX_ERR_NOMEM;
     }
 
-    ipx_ctx_msg_pass(instance->ctx, ipx_msg_ipfix2base(msg));
-    source->msg_cnt++;
+    if (cnt == 1) {
+        // Batch processing is disabled, i.e. datagrams are received one by one
+        return IPX_OK;
+    }
+
+    instance->batch.hdrs = calloc(cnt, sizeof(*instance->batch.hdrs));
+    instance->batch.iovs = calloc(2U * cnt, sizeof(*instance->batch.iovs));
+    instance->batch.addrs = calloc(cnt, sizeof(*instance->batch.addrs));
+    instance->batch.tails = malloc(cnt * (SLOT_SIZE - SLOT_HEAD_SIZE));
+    if (!instance->batch.hdrs || !instance->batch.iovs || !instance->batch.addrs
+            || !instance->batch.tails) {
+        return IPX_ERR_NOMEM;
+    }
+
+    for (unsigned int i = 0; i < cnt; ++i) {
+        struct iovec *iov = &instance->batch.iovs[2 * i];
+        iov[0].iov_base = NULL; // Allocated on demand
+        iov[0].iov_len = SLOT_HEAD_SIZE;
+        iov[1].iov_base = &instance->batch.tails[i * (SLOT_SIZE - SLOT_HEAD_SIZE)];
+        iov[1].iov_len = SLOT_SIZE - SLOT_HEAD_SIZE;
+
+        struct msghdr *hdr = &instance->batch.hdrs[i].msg_hdr;
+        hdr->msg_name = &instance->batch.addrs[i];
+        hdr->msg_namelen = sizeof(instance->batch.addrs[i]);
+        hdr->msg_iov = iov;
+        hdr->msg_iovlen = 2;
+    }
+
+    return IPX_OK;
+}
+
+/**
+ * \brief Destroy structures for batch processing of datagrams
+ * \param[in] instance Instance data
+ */
+static void
+batch_destroy(struct udp_data *instance)
+{
+    if (instance->batch.iovs != NULL) {
+        for (unsigned int i = 0; i < instance->batch.cnt; ++i) {
+            ipx_msg_ipfix_buffer_free(instance->ctx, instance->batch.iovs[2 * i].iov_base);
+        }
+    }
+
+    free(instance->batch.tails);
+    free(instance->batch.addrs);
+    free(instance->batch.iovs);
+    free(instance->batch.hdrs);
+    free(instance->batch.msgs);
 }
 
 // -------------------------------------------------------------------------------------------------
@@ -1058,19 +1281,38 @@ ipx_plugin_init(ipx_ctx_t *ctx, const char *params)
     }
 
     data->ctx = ctx;
-    data->active.cnt = 0;
-    data->active.sources = NULL;
+    ipx_ctx_worker_get(ctx, NULL, &data->listen.worker_cnt);
+    if (ipx_htable_init(&data->active, ACTIVE_DEF_SIZE) != IPX_OK) {
+        IPX_CTX_ERROR(ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+        free(data);
+        return IPX_ERR_DENIED;
+    }
 
     // Parse configuration
     data->config = config_parse(ctx, params);
     if (!data->config) {
+        ipx_htable_destroy(&data->active);
+        free(data);
+        return IPX_ERR_DENIED;
+    }
+
+    // Sessions are closed after the first timer event that follows the timeout
+    data->wheel.timeout = data->config->timeout_conn / TIMER_INTERVAL + 1;
+
+    if (batch_init(data) != IPX_OK) {
+        IPX_CTX_ERROR(ctx, "Memory allocation failed! (%s:%d)", __FILE__, __LINE__);
+        batch_destroy(data);
+        config_destroy(data->config);
+        ipx_htable_destroy(&data->active);
         free(data);
         return IPX_ERR_DENIED;
     }
 
     // Bind to local addresses and arm a timer
     if (listener_init(data) != IPX_OK) {
+        batch_destroy(data);
         config_destroy(data->config);
+        ipx_htable_destroy(&data->active);
         free(data);
         return IPX_ERR_DENIED;
     }
@@ -1088,10 +1330,18 @@ ipx_plugin_destroy(ipx_ctx_t *ctx, void *cfg)
     listener_destroy(data);
 
     // Close all Transport Session (this generates Session messages per each active Session)
-    while (data->active.cnt > 0) {
-        active_remove_by_id(data, 0);
+    for (size_t i = 0; i < WHEEL_SIZE; ++i) {
+        struct udp_source *src = data->wheel.slots[i];
+        data->wheel.slots[i] = NULL;
+        while (src != NULL) {
+            struct udp_source *next = src->wheel_next;
+            active_remove(data, src);
+            src = next;
+        }
     }
-    free(data->active.sources);
+    assert(data->active.used == 0);
+    ipx_htable_destroy(&data->active);
+    batch_destroy(data);
 
     config_destroy(data->config);
     free(data);
@@ -1135,7 +1385,11 @@ ipx_plugin_get(ipx_ctx_t *ctx, void *cfg)
             continue;
         }
 
-        process_socket(data, sd);
+        if (data->batch.hdrs != NULL) {
+            process_socket_batch(data, sd);
+        } else {
+            process_socket(data, sd);
+        }
     }
 
     return IPX_OK;
@@ -90,17 +90,37 @@
 
 #include "panonymizer.h"
 
-static	uint8_t m_key[16]; //128 bit secret key
-static	uint8_t m_pad[16]; //128 bit secret pad
+#if defined(__x86_64__) || defined(__i386__)
+#define PANON_AESNI 1
+#include <cpuid.h>
+#include <emmintrin.h>
+#include <wmmintrin.h>
+
+// Number of independent blocks encrypted at once. The aesenc instruction has a latency
+// of several cycles but can be issued every cycle, so interleaving the rounds of multiple
+// blocks keeps the pipeline full. 8 blocks also match the number of bits in a byte.
+#define AESNI_LANES 8
+
+static int aesni_supported(void);
+static uint32_t anonymize_otp_aesni(const PAnonymizer_t *ctx, const uint32_t orig_addr,
+	int from, uint32_t otp);
+static void anonymize_otp_v6_aesni(const PAnonymizer_t *ctx, const uint64_t orig_addr[2],
+	int from, uint64_t otp[2]);
+#endif
 
 // Init
-void PAnonymizer_Init(uint8_t * key) {
-  //initialize the 128-bit secret key.
-  memcpy(m_key, key, 16);
-  //initialize the Rijndael cipher.
-  Rijndael_init(ECB, Encrypt, key, Key16Bytes, NULL);
+int PAnonymizer_Init(PAnonymizer_t *ctx, const uint8_t * key) {
+  memset(ctx, 0, sizeof(*ctx));
+  //initialize the Rijndael cipher with the 128-bit secret key.
+  if (Rijndael_keyInit(&ctx->key, key, Key16Bytes) != RIJNDAEL_SUCCESS) {
+    return 1;
+  }
   //initialize the 128-bit secret pad. The pad is encrypted before being used for padding.
-  Rijndael_blockEncrypt(key + 16, 128, m_pad);
+  Rijndael_keyEncrypt(&ctx->key, key + 16, ctx->pad);
+#ifdef PANON_AESNI
+  ctx->aesni = aesni_supported();
+#endif
+  return 0;
 }
 
 int ParseCryptoPAnKey ( char *s, char *key ) {
@@ -142,14 +162,29 @@ uint32_t len = strlen(s);
 } // End of ParseCryptoPAnKey
 
 //Anonymization funtion
-uint32_t anonymize(const uint32_t orig_addr) {
+uint32_t anonymize(const PAnonymizer_t *ctx, const uint32_t orig_addr) {
+    //XOR the orginal address with the pseudorandom one-time-pad
+    return anonymize_otp(ctx, orig_addr, 0, 0) ^ orig_addr;
+}
+
+uint32_t anonymize_otp(const PAnonymizer_t *ctx, const uint32_t orig_addr, int from, uint32_t otp) {
+    const uint8_t *m_pad = ctx->pad;
     uint8_t rin_output[16];
     uint8_t rin_input[16];
 
-    uint32_t result = 0;
+    uint32_t result;
     uint32_t first4bytes_pad, first4bytes_input;
     int pos;
 
+    // Keep only the bits of the cached prefixes
+    result = (from > 0) ? (otp & (UINT32_MAX << (32 - from))) : 0;
+
+#ifdef PANON_AESNI
+    if (ctx->aesni) {
+	return anonymize_otp_aesni(ctx, orig_addr, from, result);
+    }
+#endif
+
     memcpy(rin_input, m_pad, 16);
     first4bytes_pad = (((uint32_t) m_pad[0]) << 24) + (((uint32_t) m_pad[1]) << 16) +
 	(((uint32_t) m_pad[2]) << 8) + (uint32_t) m_pad[3];
@@ -157,7 +192,7 @@ uint32_t anonymize(const uint32_t orig_addr) {
     // For each prefixes with length from 0 to 31, generate a bit using the Rijndael cipher,
     // which is used as a pseudorandom function here. The bits generated in every rounds
     // are combineed into a pseudorandom one-time-pad.
-    for (pos = 0; pos <= 31 ; pos++) {
+    for (pos = from; pos <= 31 ; pos++) {
 
 	//Padding: The most significant pos bits are taken from orig_addr. The other 128-pos
         //bits are taken from m_pad. The variables first4bytes_pad and first4bytes_input are used
@@ -175,33 +210,49 @@ uint32_t anonymize(const uint32_t orig_addr) {
 
 	//Encryption: The Rijndael cipher is used as pseudorandom function. During each
 	//round, only the first bit of rin_output is used.
-	Rijndael_blockEncrypt(rin_input, 128, rin_output);
+	Rijndael_keyEncrypt(&ctx->key, rin_input, rin_output);
 
 	//Combination: the bits are combined into a pseudorandom one-time-pad
-	result |=  (rin_output[0] >> 7) << (31-pos);
+	result |=  ((uint32_t) rin_output[0] >> 7) << (31-pos);
     }
-    //XOR the orginal address with the pseudorandom one-time-pad
-    return result ^ orig_addr;
+    return result;
 }
 
 /* little endian CPU's are boring! - but give it a try
  * orig_addr is a ptr to memory, return by inet_pton for IPv6
  * anon_addr return the result in the same order
  */
-void anonymize_v6(const uint64_t orig_addr[2], uint64_t *anon_addr) {
+void anonymize_v6(const PAnonymizer_t *ctx, const uint64_t orig_addr[2], uint64_t *anon_addr) {
+	anonymize_otp_v6(ctx, orig_addr, 0, anon_addr);
+
+    //XOR the orginal address with the pseudorandom one-time-pad
+	anon_addr[0] ^= orig_addr[0];
+	anon_addr[1] ^= orig_addr[1];
+}
+
+void anonymize_otp_v6(const PAnonymizer_t *ctx, const uint64_t orig_addr[2], int from, uint64_t otp[2]) {
+    const uint8_t *m_pad = ctx->pad;
     uint8_t rin_output[16], *orig_bytes, *result;
     uint8_t rin_input[16];
 
     int pos, i, bit_num, left_byte;
 
-	anon_addr[0] = anon_addr[1] = 0;
-	result 		 = (uint8_t *)anon_addr;
+	// Keep only the bytes of the cached prefixes
+	result 		 = (uint8_t *)otp;
 	orig_bytes 	 = (uint8_t *)orig_addr;
+	memset(result + (from >> 3), 0, 16 - (from >> 3));
+
+#ifdef PANON_AESNI
+	if (ctx->aesni) {
+		anonymize_otp_v6_aesni(ctx, orig_addr, from, otp);
+		return;
+	}
+#endif
 
     // For each prefixes with length from 0 to 127, generate a bit using the Rijndael cipher,
     // which is used as a pseudorandom function here. The bits generated in every rounds
     // are combineed into a pseudorandom one-time-pad.
-    for (pos = 0; pos <= 127 ; pos++) {
+    for (pos = from; pos <= 127 ; pos++) {
 		bit_num = pos & 0x7;
 		left_byte = (pos >> 3);
 
@@ -215,14 +266,129 @@ void anonymize_v6(const uint64_t orig_addr[2], uint64_t *anon_addr) {
 
 		//Encryption: The Rijndael cipher is used as pseudorandom function. During each
 		//round, only the first bit of rin_output is used.
-		Rijndael_blockEncrypt(rin_input, 128, rin_output);
+		Rijndael_keyEncrypt(&ctx->key, rin_input, rin_output);
 
 		//Combination: the bits are combined into a pseudorandom one-time-pad
 		result[left_byte] |= (rin_output[0] >> 7) << bit_num;
 
     }
-    //XOR the orginal address with the pseudorandom one-time-pad
-	anon_addr[0] ^= orig_addr[0];
-	anon_addr[1] ^= orig_addr[1];
+}
+
+#ifdef PANON_AESNI
+
+// Check that the CPU supports AES-NI instructions
+static int aesni_supported(void) {
+	unsigned int eax, ebx, ecx, edx;
+
+	if (__get_cpuid(1, &eax, &ebx, &ecx, &edx) == 0) {
+		return 0;
+	}
+	return (ecx & bit_AES) != 0 && (edx & bit_SSE2) != 0;
+}
+
+// Encrypt AESNI_LANES independent blocks at once, round by round
+__attribute__((target("aes,sse2")))
+static inline void aesni_encrypt_lanes(const __m128i *rk, uint32_t rounds,
+	__m128i blocks[AESNI_LANES]) {
+	uint32_t r;
+	int i;
+
+	for (i = 0; i < AESNI_LANES; i++) {
+		blocks[i] = _mm_xor_si128(blocks[i], rk[0]);
+	}
+	for (r = 1; r < rounds; r++) {
+		for (i = 0; i < AESNI_LANES; i++) {
+			blocks[i] = _mm_aesenc_si128(blocks[i], rk[r]);
+		}
+	}
+	for (i = 0; i < AESNI_LANES; i++) {
+		blocks[i] = _mm_aesenclast_si128(blocks[i], rk[rounds]);
+	}
+}
+
+// Load the expanded key. Round keys of the software cipher are already in byte order.
+__attribute__((target("aes,sse2")))
+static inline void aesni_load_key(const PAnonymizer_t *ctx, __m128i rk[_MAX_ROUNDS+1]) {
+	uint32_t r;
+
+	for (r = 0; r <= ctx->key.rounds; r++) {
+		rk[r] = _mm_loadu_si128((const __m128i *) ctx->key.expandedKey[r]);
+	}
+}
+
+// Same as anonymize_otp(), but the prefix blocks are encrypted AESNI_LANES at a time
+__attribute__((target("aes,sse2")))
+static uint32_t anonymize_otp_aesni(const PAnonymizer_t *ctx, const uint32_t orig_addr,
+	int from, uint32_t otp) {
+	__m128i rk[_MAX_ROUNDS+1];
+	__m128i blocks[AESNI_LANES];
+	const __m128i pad = _mm_loadu_si128((const __m128i *) ctx->pad);
+	const uint32_t first4bytes_pad = (((uint32_t) ctx->pad[0]) << 24) +
+		(((uint32_t) ctx->pad[1]) << 16) + (((uint32_t) ctx->pad[2]) << 8) +
+		(uint32_t) ctx->pad[3];
+	uint32_t first4bytes_input, result = otp;
+	int pos, i;
+
+	aesni_load_key(ctx, rk);
+
+	for (pos = from; pos <= 31; pos += AESNI_LANES) {
+		for (i = 0; i < AESNI_LANES; i++) {
+			const int bits = pos + i;
+			if (bits == 0) {
+				first4bytes_input = first4bytes_pad;
+			} else {
+				first4bytes_input = ((orig_addr >> (32 - bits)) << (32 - bits))
+					| ((first4bytes_pad << bits) >> bits);
+			}
+			// Replace the first 4 bytes of the pad (x86 is little endian)
+			blocks[i] = _mm_xor_si128(pad, _mm_cvtsi32_si128(
+				(int) __builtin_bswap32(first4bytes_input ^ first4bytes_pad)));
+		}
+
+		aesni_encrypt_lanes(rk, ctx->key.rounds, blocks);
 
+		// The most significant bit of the first output byte
+		for (i = 0; i < AESNI_LANES; i++) {
+			result |= ((uint32_t) _mm_movemask_epi8(blocks[i]) & 1U) << (31 - (pos + i));
+		}
+	}
+	return result;
 }
+
+// Same as anonymize_otp_v6(), but the 8 prefix blocks of each byte are encrypted at once
+__attribute__((target("aes,sse2")))
+static void anonymize_otp_v6_aesni(const PAnonymizer_t *ctx, const uint64_t orig_addr[2],
+	int from, uint64_t otp[2]) {
+	__m128i rk[_MAX_ROUNDS+1];
+	__m128i blocks[AESNI_LANES];
+	const __m128i addr = _mm_loadu_si128((const __m128i *) orig_addr);
+	const __m128i pad = _mm_loadu_si128((const __m128i *) ctx->pad);
+	const __m128i idx = _mm_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+	uint8_t *result = (uint8_t *) otp;
+	int left_byte, bit_num;
+
+	aesni_load_key(ctx, rk);
+
+	for (left_byte = from >> 3; left_byte < 16; left_byte++) {
+		const __m128i sel = _mm_set1_epi8((char) left_byte);
+		// Bytes before left_byte are taken from the address, the rest from the pad
+		const __m128i head = _mm_cmpgt_epi8(sel, idx);
+		const __m128i base = _mm_or_si128(_mm_and_si128(head, addr), _mm_andnot_si128(head, pad));
+		const __m128i cur = _mm_and_si128(_mm_cmpeq_epi8(sel, idx), addr);
+
+		// As in the software version, the top bit_num+1 bits of the address byte are ORed
+		// with the whole pad byte
+		for (bit_num = 0; bit_num < AESNI_LANES; bit_num++) {
+			const __m128i mask = _mm_set1_epi8((char) (0xFF << (7 - bit_num)));
+			blocks[bit_num] = _mm_or_si128(base, _mm_and_si128(cur, mask));
+		}
+
+		aesni_encrypt_lanes(rk, ctx->key.rounds, blocks);
+
+		for (bit_num = 0; bit_num < AESNI_LANES; bit_num++) {
+			result[left_byte] |= (uint8_t) ((_mm_movemask_epi8(blocks[bit_num]) & 1) << bit_num);
+		}
+	}
+}
+
+#endif // PANON_AESNI
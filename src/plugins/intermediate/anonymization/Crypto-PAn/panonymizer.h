@@ -82,15 +82,32 @@
 
 #include "rijndael.h"
 
+// Anonymizer state (one per plugin instance, read-only after PAnonymizer_Init)
+typedef struct {
+	Rijndael_key key; // expanded 128-bit secret key
+	uint8_t pad[16];  // 128-bit encrypted secret pad
+	int aesni;        // non-zero if AES-NI instructions are used
+} PAnonymizer_t;
+
 // PAnonymizer_Init need a 256-bit key
 // The first 128 bits of the key are used as the secret key for rijndael cipher
 // The second 128 bits of the key are used as the secret pad for padding
-void PAnonymizer_Init(uint8_t * key);
+// AES-NI instructions are used if supported by the CPU, the result is the same.
+// Returns 0 on success, non-zero otherwise
+int PAnonymizer_Init(PAnonymizer_t *ctx, const uint8_t *key);
 
 int ParseCryptoPAnKey ( char *s, char *key );
 
-uint32_t anonymize( const uint32_t orig_addr);
+uint32_t anonymize(const PAnonymizer_t *ctx, const uint32_t orig_addr);
+
+void anonymize_v6(const PAnonymizer_t *ctx, const uint64_t orig_addr[2], uint64_t *anon_addr);
+
+// Compute only the pseudorandom one-time-pad of an address (i.e. address ^ anonymized address)
+// Bits generated for prefixes shorter than 'from' bits are taken from 'otp' instead, which
+// must be the one-time-pad of an address with the same prefix. 'from' must be a multiple of 8.
+uint32_t anonymize_otp(const PAnonymizer_t *ctx, const uint32_t orig_addr, int from, uint32_t otp);
 
-void anonymize_v6(const uint64_t orig_addr[2], uint64_t *anon_addr);
+void anonymize_otp_v6(const PAnonymizer_t *ctx, const uint64_t orig_addr[2], int from,
+	uint64_t otp[2]);
 
 #endif //_PANONYMIZER_H_
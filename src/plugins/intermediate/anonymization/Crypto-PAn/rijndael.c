@@ -1040,16 +1040,15 @@ static uint8_t	m_state = Invalid;
 static uint8_t	m_mode;
 static uint8_t	m_direction;
 static uint8_t	m_initVector[MAX_IV_SIZE];
-static uint32_t	m_uRounds;
-static uint8_t	m_expandedKey[_MAX_ROUNDS+1][4][4];
+static Rijndael_key	m_key;
 
-static void keySched(uint8_t key[_MAX_KEY_COLUMNS][4]);
+static void keySched(Rijndael_key *k, uint8_t key[_MAX_KEY_COLUMNS][4]);
 
-static void keyEncToDec(void);
+static void keyEncToDec(Rijndael_key *k);
 
-static void encrypt(const uint8_t a[16], uint8_t b[16]);
+static void encrypt(const Rijndael_key *k, const uint8_t a[16], uint8_t b[16]);
 
-static void decrypt(const uint8_t a[16], uint8_t b[16]);
+static void decrypt(const Rijndael_key *k, const uint8_t a[16], uint8_t b[16]);
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // API
@@ -1093,15 +1092,15 @@ uint8_t keyMatrix[_MAX_KEY_COLUMNS][4];
 	{
 		case Key16Bytes:
 			uKeyLenInBytes = 16;
-			m_uRounds = 10;
+			m_key.rounds = 10;
 		break;
 		case Key24Bytes:
 			uKeyLenInBytes = 24;
-			m_uRounds = 12;
+			m_key.rounds = 12;
 		break;
 		case Key32Bytes:
 			uKeyLenInBytes = 32;
-			m_uRounds = 14;
+			m_key.rounds = 14;
 		break;
 		default:
 			return RIJNDAEL_UNSUPPORTED_KEY_LENGTH;
@@ -1115,9 +1114,9 @@ uint8_t keyMatrix[_MAX_KEY_COLUMNS][4];
 
 	for(i = 0;i < uKeyLenInBytes;i++)keyMatrix[i >> 2][i & 3] = key[i];
 
-	keySched(keyMatrix);
+	keySched(&m_key, keyMatrix);
 
-	if(m_direction == Decrypt)keyEncToDec();
+	if(m_direction == Decrypt)keyEncToDec(&m_key);
 
 	m_state = Valid;
 
@@ -1140,7 +1139,7 @@ int Rijndael_blockEncrypt(const uint8_t *input,int inputLen,uint8_t *outBuffer)
 		case ECB:
 			for(i = numBlocks;i > 0;i--)
 			{
-				encrypt(input,outBuffer);
+				encrypt(&m_key, input,outBuffer);
 				input += 16;
 				outBuffer += 16;
 			}
@@ -1150,7 +1149,7 @@ int Rijndael_blockEncrypt(const uint8_t *input,int inputLen,uint8_t *outBuffer)
 			((uint32_t*)block)[1] = ((uint32_t*)m_initVector)[1] ^ ((uint32_t*)input)[1];
 			((uint32_t*)block)[2] = ((uint32_t*)m_initVector)[2] ^ ((uint32_t*)input)[2];
 			((uint32_t*)block)[3] = ((uint32_t*)m_initVector)[3] ^ ((uint32_t*)input)[3];
-			encrypt(block,outBuffer);
+			encrypt(&m_key, block,outBuffer);
 			input += 16;
 			for(i = numBlocks - 1;i > 0;i--)
 			{
@@ -1159,7 +1158,7 @@ int Rijndael_blockEncrypt(const uint8_t *input,int inputLen,uint8_t *outBuffer)
 				((uint32_t*)block)[2] = ((uint32_t*)outBuffer)[2] ^ ((uint32_t*)input)[2];
 				((uint32_t*)block)[3] = ((uint32_t*)outBuffer)[3] ^ ((uint32_t*)input)[3];
 				outBuffer += 16;
-				encrypt(block,outBuffer);
+				encrypt(&m_key, block,outBuffer);
 				input += 16;
 			}
 		break;
@@ -1180,7 +1179,7 @@ int Rijndael_blockEncrypt(const uint8_t *input,int inputLen,uint8_t *outBuffer)
 					*((uint32_t*)(block+ 4)) = *((uint32_t*)iv[1]);
 					*((uint32_t*)(block+ 8)) = *((uint32_t*)iv[2]);
 					*((uint32_t*)(block+12)) = *((uint32_t*)iv[3]);
-					encrypt(block,block);
+					encrypt(&m_key, block,block);
 					outBuffer[k/8] ^= (block[0] & 0x80) >> (k & 7);
 					iv[0][0] = (iv[0][0] << 1) | (iv[0][1] >> 7);
 					iv[0][1] = (iv[0][1] << 1) | (iv[0][2] >> 7);
@@ -1226,7 +1225,7 @@ int Rijndael_padEncrypt(const uint8_t *input, int inputOctets, uint8_t *outBuffe
 		case ECB:
 			for(i = numBlocks; i > 0; i--)
 			{
-				encrypt(input, outBuffer);
+				encrypt(&m_key, input, outBuffer);
 				input += 16;
 				outBuffer += 16;
 			}
@@ -1234,7 +1233,7 @@ int Rijndael_padEncrypt(const uint8_t *input, int inputOctets, uint8_t *outBuffe
 //			assert(padLen > 0 && padLen <= 16);
 			memcpy(block, input, 16 - padLen);
 			memset(block + 16 - padLen, padLen, padLen);
-			encrypt(block,outBuffer);
+			encrypt(&m_key, block,outBuffer);
 		break;
 		case CBC:
 			iv = m_initVector;
@@ -1244,7 +1243,7 @@ int Rijndael_padEncrypt(const uint8_t *input, int inputOctets, uint8_t *outBuffe
 				((uint32_t*)block)[1] = ((uint32_t*)input)[1] ^ ((uint32_t*)iv)[1];
 				((uint32_t*)block)[2] = ((uint32_t*)input)[2] ^ ((uint32_t*)iv)[2];
 				((uint32_t*)block)[3] = ((uint32_t*)input)[3] ^ ((uint32_t*)iv)[3];
-				encrypt(block, outBuffer);
+				encrypt(&m_key, block, outBuffer);
 				iv = outBuffer;
 				input += 16;
 				outBuffer += 16;
@@ -1257,7 +1256,7 @@ int Rijndael_padEncrypt(const uint8_t *input, int inputOctets, uint8_t *outBuffe
 			for (i = 16 - padLen; i < 16; i++) {
 				block[i] = (uint8_t)padLen ^ iv[i];
 			}
-			encrypt(block,outBuffer);
+			encrypt(&m_key, block,outBuffer);
 		break;
 		default:
 			return -1;
@@ -1284,7 +1283,7 @@ int Rijndael_blockDecrypt(const uint8_t *input, int inputLen, uint8_t *outBuffer
 		case ECB:
 			for (i = numBlocks; i > 0; i--)
 			{
-				decrypt(input,outBuffer);
+				decrypt(&m_key, input,outBuffer);
 				input += 16;
 				outBuffer += 16;
 			}
@@ -1300,7 +1299,7 @@ int Rijndael_blockDecrypt(const uint8_t *input, int inputLen, uint8_t *outBuffer
 #endif
 			for (i = numBlocks; i > 0; i--)
 			{
-				decrypt(input, block);
+				decrypt(&m_key, input, block);
 				((uint32_t*)block)[0] ^= *((uint32_t*)iv[0]);
 				((uint32_t*)block)[1] ^= *((uint32_t*)iv[1]);
 				((uint32_t*)block)[2] ^= *((uint32_t*)iv[2]);
@@ -1335,7 +1334,7 @@ int Rijndael_blockDecrypt(const uint8_t *input, int inputLen, uint8_t *outBuffer
 					*((uint32_t*)(block+ 4)) = *((uint32_t*)iv[1]);
 					*((uint32_t*)(block+ 8)) = *((uint32_t*)iv[2]);
 					*((uint32_t*)(block+12)) = *((uint32_t*)iv[3]);
-					encrypt(block, block);
+					encrypt(&m_key, block, block);
 					iv[0][0] = (iv[0][0] << 1) | (iv[0][1] >> 7);
 					iv[0][1] = (iv[0][1] << 1) | (iv[0][2] >> 7);
 					iv[0][2] = (iv[0][2] << 1) | (iv[0][3] >> 7);
@@ -1383,12 +1382,12 @@ int Rijndael_padDecrypt(const uint8_t *input, int inputOctets, uint8_t *outBuffe
 		case ECB:
 			for (i = numBlocks - 1; i > 0; i--)
 			{
-				decrypt(input, outBuffer);
+				decrypt(&m_key, input, outBuffer);
 				input += 16;
 				outBuffer += 16;
 			}
 
-			decrypt(input, block);
+			decrypt(&m_key, input, block);
 			padLen = block[15];
 			if (padLen >= 16)return RIJNDAEL_CORRUPTED_DATA;
 			for(i = 16 - padLen; i < 16; i++)
@@ -1402,7 +1401,7 @@ int Rijndael_padDecrypt(const uint8_t *input, int inputOctets, uint8_t *outBuffe
 			/* all blocks but last */
 			for (i = numBlocks - 1; i > 0; i--)
 			{
-				decrypt(input, block);
+				decrypt(&m_key, input, block);
 				((uint32_t*)block)[0] ^= iv[0];
 				((uint32_t*)block)[1] ^= iv[1];
 				((uint32_t*)block)[2] ^= iv[2];
@@ -1413,7 +1412,7 @@ int Rijndael_padDecrypt(const uint8_t *input, int inputOctets, uint8_t *outBuffe
 				outBuffer += 16;
 			}
 			/* last block */
-			decrypt(input, block);
+			decrypt(&m_key, input, block);
 			((uint32_t*)block)[0] ^= iv[0];
 			((uint32_t*)block)[1] ^= iv[1];
 			((uint32_t*)block)[2] ^= iv[2];
@@ -1435,12 +1434,50 @@ int Rijndael_padDecrypt(const uint8_t *input, int inputOctets, uint8_t *outBuffe
 	return 16*numBlocks - padLen;
 }
 
+int Rijndael_keyInit(Rijndael_key *k, const uint8_t *key, int keyLen)
+{
+uint32_t i, uKeyLenInBytes;
+uint8_t keyMatrix[_MAX_KEY_COLUMNS][4];
+
+	switch(keyLen)
+	{
+		case Key16Bytes:
+			uKeyLenInBytes = 16;
+			k->rounds = 10;
+		break;
+		case Key24Bytes:
+			uKeyLenInBytes = 24;
+			k->rounds = 12;
+		break;
+		case Key32Bytes:
+			uKeyLenInBytes = 32;
+			k->rounds = 14;
+		break;
+		default:
+			return RIJNDAEL_UNSUPPORTED_KEY_LENGTH;
+		break;
+	}
+
+	if(!key)return RIJNDAEL_BAD_KEY;
+
+	for(i = 0;i < uKeyLenInBytes;i++)keyMatrix[i >> 2][i & 3] = key[i];
+
+	keySched(k, keyMatrix);
+
+	return RIJNDAEL_SUCCESS;
+}
+
+void Rijndael_keyEncrypt(const Rijndael_key *k, const uint8_t input[16], uint8_t outBuffer[16])
+{
+	encrypt(k, input, outBuffer);
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // ALGORITHM
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 
-void keySched(uint8_t key[_MAX_KEY_COLUMNS][4])
+void keySched(Rijndael_key *k, uint8_t key[_MAX_KEY_COLUMNS][4])
 {
 	int j,rconpointer = 0;
 	int r = 0;
@@ -1448,7 +1485,7 @@ void keySched(uint8_t key[_MAX_KEY_COLUMNS][4])
 
 	// Calculate the necessary round keys
 	// The number of calculations depends on keyBits and blockBits
-	int uKeyColumns = m_uRounds - 6;
+	int uKeyColumns = k->rounds - 6;
 
 	uint8_t tempKey[_MAX_KEY_COLUMNS][4];
 
@@ -1460,11 +1497,11 @@ void keySched(uint8_t key[_MAX_KEY_COLUMNS][4])
 	}
 
 	// copy values into round key array
-	for(j = 0;(j < uKeyColumns) && (r <= m_uRounds); )
+	for(j = 0;(j < uKeyColumns) && (r <= k->rounds); )
 	{
 		for(;(j < uKeyColumns) && (t < 4); j++, t++)
 		{
-			*((uint32_t*)m_expandedKey[r][t]) = *((uint32_t*)tempKey[j]);
+			*((uint32_t*)k->expandedKey[r][t]) = *((uint32_t*)tempKey[j]);
 		}
 
 
@@ -1475,7 +1512,7 @@ void keySched(uint8_t key[_MAX_KEY_COLUMNS][4])
 		}
 	}
 
-	while(r <= m_uRounds)
+	while(r <= k->rounds)
 	{
 		tempKey[0][0] ^= S[tempKey[uKeyColumns-1][1]];
 		tempKey[0][1] ^= S[tempKey[uKeyColumns-1][2]];
@@ -1503,11 +1540,11 @@ void keySched(uint8_t key[_MAX_KEY_COLUMNS][4])
 				*((uint32_t*)tempKey[j]) ^= *((uint32_t*)tempKey[j-1]);
 			}
 		}
-		for(j = 0; (j < uKeyColumns) && (r <= m_uRounds); )
+		for(j = 0; (j < uKeyColumns) && (r <= k->rounds); )
 		{
 			for(; (j < uKeyColumns) && (t < 4); j++, t++)
 			{
-				*((uint32_t*)m_expandedKey[r][t]) = *((uint32_t*)tempKey[j]);
+				*((uint32_t*)k->expandedKey[r][t]) = *((uint32_t*)tempKey[j]);
 			}
 			if(t == 4)
 			{
@@ -1518,33 +1555,33 @@ void keySched(uint8_t key[_MAX_KEY_COLUMNS][4])
 	}
 }
 
-void keyEncToDec()
+void keyEncToDec(Rijndael_key *k)
 {
 	int r;
 	uint8_t *w;
 
-	for(r = 1; r < m_uRounds; r++)
+	for(r = 1; r < k->rounds; r++)
 	{
-		w = m_expandedKey[r][0];
+		w = k->expandedKey[r][0];
 		*((uint32_t*)w) = *((uint32_t*)U1[w[0]]) ^ *((uint32_t*)U2[w[1]]) ^ *((uint32_t*)U3[w[2]]) ^ *((uint32_t*)U4[w[3]]);
-		w = m_expandedKey[r][1];
+		w = k->expandedKey[r][1];
 		*((uint32_t*)w) = *((uint32_t*)U1[w[0]]) ^ *((uint32_t*)U2[w[1]]) ^ *((uint32_t*)U3[w[2]]) ^ *((uint32_t*)U4[w[3]]);
-		w = m_expandedKey[r][2];
+		w = k->expandedKey[r][2];
 		*((uint32_t*)w) = *((uint32_t*)U1[w[0]]) ^ *((uint32_t*)U2[w[1]]) ^ *((uint32_t*)U3[w[2]]) ^ *((uint32_t*)U4[w[3]]);
-		w = m_expandedKey[r][3];
+		w = k->expandedKey[r][3];
 		*((uint32_t*)w) = *((uint32_t*)U1[w[0]]) ^ *((uint32_t*)U2[w[1]]) ^ *((uint32_t*)U3[w[2]]) ^ *((uint32_t*)U4[w[3]]);
 	}
 }
 
-void encrypt(const uint8_t a[16], uint8_t b[16])
+void encrypt(const Rijndael_key *k, const uint8_t a[16], uint8_t b[16])
 {
 	int r;
 	uint8_t temp[4][4];
 
-    *((uint32_t*)temp[0]) = *((uint32_t*)(a   )) ^ *((uint32_t*)m_expandedKey[0][0]);
-    *((uint32_t*)temp[1]) = *((uint32_t*)(a+ 4)) ^ *((uint32_t*)m_expandedKey[0][1]);
-    *((uint32_t*)temp[2]) = *((uint32_t*)(a+ 8)) ^ *((uint32_t*)m_expandedKey[0][2]);
-    *((uint32_t*)temp[3]) = *((uint32_t*)(a+12)) ^ *((uint32_t*)m_expandedKey[0][3]);
+    *((uint32_t*)temp[0]) = *((uint32_t*)(a   )) ^ *((uint32_t*)k->expandedKey[0][0]);
+    *((uint32_t*)temp[1]) = *((uint32_t*)(a+ 4)) ^ *((uint32_t*)k->expandedKey[0][1]);
+    *((uint32_t*)temp[2]) = *((uint32_t*)(a+ 8)) ^ *((uint32_t*)k->expandedKey[0][2]);
+    *((uint32_t*)temp[3]) = *((uint32_t*)(a+12)) ^ *((uint32_t*)k->expandedKey[0][3]);
     *((uint32_t*)(b    )) = *((uint32_t*)T1[temp[0][0]])
 						^ *((uint32_t*)T2[temp[1][1]])
 						^ *((uint32_t*)T3[temp[2][2]])
@@ -1561,12 +1598,12 @@ void encrypt(const uint8_t a[16], uint8_t b[16])
 						^ *((uint32_t*)T2[temp[0][1]])
 						^ *((uint32_t*)T3[temp[1][2]])
 						^ *((uint32_t*)T4[temp[2][3]]);
-	for(r = 1; r < m_uRounds-1; r++)
+	for(r = 1; r < k->rounds-1; r++)
 	{
-		*((uint32_t*)temp[0]) = *((uint32_t*)(b   )) ^ *((uint32_t*)m_expandedKey[r][0]);
-		*((uint32_t*)temp[1]) = *((uint32_t*)(b+ 4)) ^ *((uint32_t*)m_expandedKey[r][1]);
-		*((uint32_t*)temp[2]) = *((uint32_t*)(b+ 8)) ^ *((uint32_t*)m_expandedKey[r][2]);
-		*((uint32_t*)temp[3]) = *((uint32_t*)(b+12)) ^ *((uint32_t*)m_expandedKey[r][3]);
+		*((uint32_t*)temp[0]) = *((uint32_t*)(b   )) ^ *((uint32_t*)k->expandedKey[r][0]);
+		*((uint32_t*)temp[1]) = *((uint32_t*)(b+ 4)) ^ *((uint32_t*)k->expandedKey[r][1]);
+		*((uint32_t*)temp[2]) = *((uint32_t*)(b+ 8)) ^ *((uint32_t*)k->expandedKey[r][2]);
+		*((uint32_t*)temp[3]) = *((uint32_t*)(b+12)) ^ *((uint32_t*)k->expandedKey[r][3]);
 
 		*((uint32_t*)(b    )) = *((uint32_t*)T1[temp[0][0]])
 							^ *((uint32_t*)T2[temp[1][1]])
@@ -1585,10 +1622,10 @@ void encrypt(const uint8_t a[16], uint8_t b[16])
 							^ *((uint32_t*)T3[temp[1][2]])
 							^ *((uint32_t*)T4[temp[2][3]]);
 	}
-	*((uint32_t*)temp[0]) = *((uint32_t*)(b   )) ^ *((uint32_t*)m_expandedKey[m_uRounds-1][0]);
-	*((uint32_t*)temp[1]) = *((uint32_t*)(b+ 4)) ^ *((uint32_t*)m_expandedKey[m_uRounds-1][1]);
-	*((uint32_t*)temp[2]) = *((uint32_t*)(b+ 8)) ^ *((uint32_t*)m_expandedKey[m_uRounds-1][2]);
-	*((uint32_t*)temp[3]) = *((uint32_t*)(b+12)) ^ *((uint32_t*)m_expandedKey[m_uRounds-1][3]);
+	*((uint32_t*)temp[0]) = *((uint32_t*)(b   )) ^ *((uint32_t*)k->expandedKey[k->rounds-1][0]);
+	*((uint32_t*)temp[1]) = *((uint32_t*)(b+ 4)) ^ *((uint32_t*)k->expandedKey[k->rounds-1][1]);
+	*((uint32_t*)temp[2]) = *((uint32_t*)(b+ 8)) ^ *((uint32_t*)k->expandedKey[k->rounds-1][2]);
+	*((uint32_t*)temp[3]) = *((uint32_t*)(b+12)) ^ *((uint32_t*)k->expandedKey[k->rounds-1][3]);
 	b[ 0] = T1[temp[0][0]][1];
 	b[ 1] = T1[temp[1][1]][1];
 	b[ 2] = T1[temp[2][2]][1];
@@ -1605,21 +1642,21 @@ void encrypt(const uint8_t a[16], uint8_t b[16])
 	b[13] = T1[temp[0][1]][1];
 	b[14] = T1[temp[1][2]][1];
 	b[15] = T1[temp[2][3]][1];
-	*((uint32_t*)(b   )) ^= *((uint32_t*)m_expandedKey[m_uRounds][0]);
-	*((uint32_t*)(b+ 4)) ^= *((uint32_t*)m_expandedKey[m_uRounds][1]);
-	*((uint32_t*)(b+ 8)) ^= *((uint32_t*)m_expandedKey[m_uRounds][2]);
-	*((uint32_t*)(b+12)) ^= *((uint32_t*)m_expandedKey[m_uRounds][3]);
+	*((uint32_t*)(b   )) ^= *((uint32_t*)k->expandedKey[k->rounds][0]);
+	*((uint32_t*)(b+ 4)) ^= *((uint32_t*)k->expandedKey[k->rounds][1]);
+	*((uint32_t*)(b+ 8)) ^= *((uint32_t*)k->expandedKey[k->rounds][2]);
+	*((uint32_t*)(b+12)) ^= *((uint32_t*)k->expandedKey[k->rounds][3]);
 }
 
-void decrypt(const uint8_t a[16], uint8_t b[16])
+void decrypt(const Rijndael_key *k, const uint8_t a[16], uint8_t b[16])
 {
 	int r;
 	uint8_t temp[4][4];
 
-    *((uint32_t*)temp[0]) = *((uint32_t*)(a   )) ^ *((uint32_t*)m_expandedKey[m_uRounds][0]);
-    *((uint32_t*)temp[1]) = *((uint32_t*)(a+ 4)) ^ *((uint32_t*)m_expandedKey[m_uRounds][1]);
-    *((uint32_t*)temp[2]) = *((uint32_t*)(a+ 8)) ^ *((uint32_t*)m_expandedKey[m_uRounds][2]);
-    *((uint32_t*)temp[3]) = *((uint32_t*)(a+12)) ^ *((uint32_t*)m_expandedKey[m_uRounds][3]);
+    *((uint32_t*)temp[0]) = *((uint32_t*)(a   )) ^ *((uint32_t*)k->expandedKey[k->rounds][0]);
+    *((uint32_t*)temp[1]) = *((uint32_t*)(a+ 4)) ^ *((uint32_t*)k->expandedKey[k->rounds][1]);
+    *((uint32_t*)temp[2]) = *((uint32_t*)(a+ 8)) ^ *((uint32_t*)k->expandedKey[k->rounds][2]);
+    *((uint32_t*)temp[3]) = *((uint32_t*)(a+12)) ^ *((uint32_t*)k->expandedKey[k->rounds][3]);
 
     *((uint32_t*)(b   )) = *((uint32_t*)T5[temp[0][0]])
            ^ *((uint32_t*)T6[temp[3][1]])
@@ -1637,12 +1674,12 @@ void decrypt(const uint8_t a[16], uint8_t b[16])
            ^ *((uint32_t*)T6[temp[2][1]])
            ^ *((uint32_t*)T7[temp[1][2]])
            ^ *((uint32_t*)T8[temp[0][3]]);
-	for(r = m_uRounds-1; r > 1; r--)
+	for(r = k->rounds-1; r > 1; r--)
 	{
-		*((uint32_t*)temp[0]) = *((uint32_t*)(b   )) ^ *((uint32_t*)m_expandedKey[r][0]);
-		*((uint32_t*)temp[1]) = *((uint32_t*)(b+ 4)) ^ *((uint32_t*)m_expandedKey[r][1]);
-		*((uint32_t*)temp[2]) = *((uint32_t*)(b+ 8)) ^ *((uint32_t*)m_expandedKey[r][2]);
-		*((uint32_t*)temp[3]) = *((uint32_t*)(b+12)) ^ *((uint32_t*)m_expandedKey[r][3]);
+		*((uint32_t*)temp[0]) = *((uint32_t*)(b   )) ^ *((uint32_t*)k->expandedKey[r][0]);
+		*((uint32_t*)temp[1]) = *((uint32_t*)(b+ 4)) ^ *((uint32_t*)k->expandedKey[r][1]);
+		*((uint32_t*)temp[2]) = *((uint32_t*)(b+ 8)) ^ *((uint32_t*)k->expandedKey[r][2]);
+		*((uint32_t*)temp[3]) = *((uint32_t*)(b+12)) ^ *((uint32_t*)k->expandedKey[r][3]);
 		*((uint32_t*)(b   )) = *((uint32_t*)T5[temp[0][0]])
            ^ *((uint32_t*)T6[temp[3][1]])
            ^ *((uint32_t*)T7[temp[2][2]])
@@ -1661,10 +1698,10 @@ void decrypt(const uint8_t a[16], uint8_t b[16])
            ^ *((uint32_t*)T8[temp[0][3]]);
 	}
 
-	*((uint32_t*)temp[0]) = *((uint32_t*)(b   )) ^ *((uint32_t*)m_expandedKey[1][0]);
-	*((uint32_t*)temp[1]) = *((uint32_t*)(b+ 4)) ^ *((uint32_t*)m_expandedKey[1][1]);
-	*((uint32_t*)temp[2]) = *((uint32_t*)(b+ 8)) ^ *((uint32_t*)m_expandedKey[1][2]);
-	*((uint32_t*)temp[3]) = *((uint32_t*)(b+12)) ^ *((uint32_t*)m_expandedKey[1][3]);
+	*((uint32_t*)temp[0]) = *((uint32_t*)(b   )) ^ *((uint32_t*)k->expandedKey[1][0]);
+	*((uint32_t*)temp[1]) = *((uint32_t*)(b+ 4)) ^ *((uint32_t*)k->expandedKey[1][1]);
+	*((uint32_t*)temp[2]) = *((uint32_t*)(b+ 8)) ^ *((uint32_t*)k->expandedKey[1][2]);
+	*((uint32_t*)temp[3]) = *((uint32_t*)(b+12)) ^ *((uint32_t*)k->expandedKey[1][3]);
 	b[ 0] = S5[temp[0][0]];
 	b[ 1] = S5[temp[3][1]];
 	b[ 2] = S5[temp[2][2]];
@@ -1681,8 +1718,8 @@ void decrypt(const uint8_t a[16], uint8_t b[16])
 	b[13] = S5[temp[2][1]];
 	b[14] = S5[temp[1][2]];
 	b[15] = S5[temp[0][3]];
-	*((uint32_t*)(b   )) ^= *((uint32_t*)m_expandedKey[0][0]);
-	*((uint32_t*)(b+ 4)) ^= *((uint32_t*)m_expandedKey[0][1]);
-	*((uint32_t*)(b+ 8)) ^= *((uint32_t*)m_expandedKey[0][2]);
-	*((uint32_t*)(b+12)) ^= *((uint32_t*)m_expandedKey[0][3]);
+	*((uint32_t*)(b   )) ^= *((uint32_t*)k->expandedKey[0][0]);
+	*((uint32_t*)(b+ 4)) ^= *((uint32_t*)k->expandedKey[0][1]);
+	*((uint32_t*)(b+ 8)) ^= *((uint32_t*)k->expandedKey[0][2]);
+	*((uint32_t*)(b+12)) ^= *((uint32_t*)k->expandedKey[0][3]);
 }
@@ -74,6 +74,8 @@
 
 #ifndef _RIJNDAEL_H_
 #define _RIJNDAEL_H_ 1
+
+#include <stdint.h>
 //
 // File : rijndael.h
 // Creation date : Sun Nov 5 2000 03:21:05 CEST
@@ -154,6 +156,15 @@ enum Direction { Encrypt , Decrypt };
 enum Mode { ECB , CBC , CFB1 };
 enum KeyLength { Key16Bytes , Key24Bytes , Key32Bytes };
 
+// Expanded encryption key
+// Unlike the init() API below, which works on a single file-static session,
+// an expanded key is owned by the caller and can be used by multiple threads.
+// expandedKey[r] is the AES round key r in byte order.
+typedef struct {
+	uint32_t rounds;
+	uint8_t  expandedKey[_MAX_ROUNDS+1][4][4];
+} Rijndael_key;
+
 //////////////////////////////////////////////////////////////////////////////////////////
 // API
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -197,4 +208,12 @@ int Rijndael_blockDecrypt(const uint8_t *input, int inputLen, uint8_t *outBuffer
 // outBuffer must be at least inputLen bytes long
 // Returns the decrypted buffer length in BYTES and an error code < 0 in case of error
 int Rijndael_padDecrypt(const uint8_t *input, int inputOctets, uint8_t *outBuffer);
+
+// keyInit(): Expands an encryption key into a caller-owned structure
+// Returns RIJNDAEL_SUCCESS or an error code
+// key       : array of unsigned octets , it can be 16 , 24 or 32 bytes long
+// keyLen    : Key16Bytes , Key24Bytes or Key32Bytes
+int Rijndael_keyInit(Rijndael_key *k, const uint8_t *key, int keyLen);
+// Encrypts a single 16 byte block (ECB) with an expanded key
+void Rijndael_keyEncrypt(const Rijndael_key *k, const uint8_t input[16], uint8_t outBuffer[16]);
 #endif
@@ -43,7 +43,9 @@
 #include <stdlib.h>
 #include <unistd.h>
 #include <inttypes.h>
+#include <time.h>
 
+#include "cache.h"
 #include "config.h"
 #include "Crypto-PAn/panonymizer.h"
 
@@ -58,7 +60,7 @@ IPX_API struct ipx_plugin_info ipx_plugin_info = {
     // Configuration flags (reserved for future use)
     .flags = 0,
     // Plugin version string (like "1.2.3")
-    .version = "2.0.0",
+    .version = "2.3.0",
     // Minimal IPFIXcol version string (like "1.2.3")
     .ipx_min = "2.0.0"
 };
@@ -67,8 +69,35 @@ IPX_API struct ipx_plugin_info ipx_plugin_info = {
 struct instance_data {
     /** Parsed configuration of the instance  */
     struct anon_config *config;
+    /** Crypto-PAn state (valid only in the Crypto-PAn mode) */
+    PAnonymizer_t cryptopan;
+    /** Cache of Crypto-PAn results (can be NULL)             */
+    anon_cache_t *cache;
+    /** Time of the next report of cache statistics (seconds) */
+    time_t stats_next;
+    /** Locators of IP address fields in templates            */
+    ipx_floc_t *floc;
 };
 
+/**
+ * \brief Check if a template field is an IPv4/IPv6 address
+ * \param[in] field Template field
+ * \param[in] data  Unused
+ * \return True or false
+ */
+static bool
+anonymize_field_match(const struct fds_tfield *field, void *data)
+{
+    (void) data;
+    if (field->def == NULL) {
+        // Skip unknown fields
+        return false;
+    }
+
+    const enum fds_iemgr_element_type type = field->def->data_type;
+    return type == FDS_ET_IPV4_ADDRESS || type == FDS_ET_IPV6_ADDRESS;
+}
+
 /**
  * \brief Anonymize an IPv4/IPv6 address by setting lower half of the address to be zeros
  * \param field IPFIX field with an address to anonymize
@@ -90,14 +119,19 @@ anonymize_trunc(struct fds_drec_field *field)
 
 /**
  * \brief Anonymize an IPv4/IPV6 address using Crypto-PAn anonymization technique
+ * \param[in] data  Instance data
  * \param[in] field IPFIX field with an address to anonymize
  */
 static void
-anonymize_cryptopan(struct fds_drec_field *field)
+anonymize_cryptopan(struct instance_data *data, struct fds_drec_field *field)
 {
     if (field->size == 4) {
         uint32_t *mem = (uint32_t *) field->data;
-        (*mem) = htonl(anonymize(ntohl(*mem)));
+        if (data->cache != NULL) {
+            (*mem) = htonl(anon_cache_ipv4(data->cache, &data->cryptopan, ntohl(*mem)));
+        } else {
+            (*mem) = htonl(anonymize(&data->cryptopan, ntohl(*mem)));
+        }
         return;
     }
 
@@ -105,12 +139,89 @@ anonymize_cryptopan(struct fds_drec_field *field)
         uint64_t addr_orig[2];
         uint64_t addr_anon[2];
         memcpy(addr_orig, field->data, field->size);
-        anonymize_v6(addr_orig, addr_anon);
+        if (data->cache != NULL) {
+            anon_cache_ipv6(data->cache, &data->cryptopan, addr_orig, addr_anon);
+        } else {
+            anonymize_v6(&data->cryptopan, addr_orig, addr_anon);
+        }
         memcpy(field->data, addr_anon, field->size);
         return;
     }
 }
 
+/**
+ * \brief Print cache statistics of an address family
+ * \param[in] ctx   Instance context
+ * \param[in] name  Name of the address family
+ * \param[in] stats Statistics
+ */
+static void
+cache_stats_print(ipx_ctx_t *ctx, const char *name, const struct anon_cache_stats *stats)
+{
+    uint64_t hits = 0;
+    double ratio[ANON_CACHE_LEVELS];
+
+    for (size_t i = 0; i < ANON_CACHE_LEVELS; ++i) {
+        hits += stats->hits[i];
+        ratio[i] = (stats->lookups > 0) ? (100.0 * stats->hits[i] / stats->lookups) : 0.0;
+    }
+
+    IPX_CTX_INFO(ctx, "Cache (%s): %" PRIu64 " lookups, %" PRIu64 " misses, hits: "
+        "/%u %.1f%%, /%u %.1f%%, /%u %.1f%%", name, stats->lookups, stats->lookups - hits,
+        stats->bits[0], ratio[0], stats->bits[1], ratio[1], stats->bits[2], ratio[2]);
+}
+
+/**
+ * \brief Print cache statistics of the instance (if enabled and the interval has elapsed)
+ * \param[in] ctx   Instance context
+ * \param[in] data  Instance data
+ * \param[in] force Print the statistics even if the interval has not elapsed yet
+ */
+static void
+cache_stats_report(ipx_ctx_t *ctx, struct instance_data *data, bool force)
+{
+    if (data->cache == NULL || data->config->cache_stats == 0) {
+        return;
+    }
+
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+    if (!force && ts.tv_sec < data->stats_next) {
+        return;
+    }
+
+    struct anon_cache_stats ipv4;
+    struct anon_cache_stats ipv6;
+    anon_cache_stats(data->cache, &ipv4, &ipv6);
+    cache_stats_print(ctx, "IPv4", &ipv4);
+    cache_stats_print(ctx, "IPv6", &ipv6);
+    data->stats_next = ts.tv_sec + data->config->cache_stats;
+}
+
+/**
+ * \brief Anonymize an IPv4/IPv6 address field using the selected technique
+ * \param[in] ctx   Instance context
+ * \param[in] data  Instance data
+ * \param[in] field IPFIX field with an address to anonymize
+ */
+static void
+anonymize_field(ipx_ctx_t *ctx, struct instance_data *data, struct fds_drec_field *field)
+{
+    if (field->size != 4U && field->size != 16U) {
+        IPX_CTX_DEBUG(ctx, "Unable to anonymize an IP address with invalid size "
+            "(%" PRIu16 "bytes)!", field->size);
+        return;
+    }
+
+    if (data->config->mode == AN_TRUNC) {
+        // Truncate the address
+        anonymize_trunc(field);
+    } else {
+        // Crypto-PAn
+        anonymize_cryptopan(data, field);
+    }
+}
+
 // -------------------------------------------------------------------------------------------------
 
 int
@@ -128,7 +239,43 @@ ipx_plugin_init(ipx_ctx_t *ctx, const char *params)
     }
 
     if (data->config->mode == AN_CRYPTOPAN) {
-        PAnonymizer_Init((uint8_t *)data->config->crypto_key);
+        if (PAnonymizer_Init(&data->cryptopan, (uint8_t *) data->config->crypto_key) != 0) {
+            IPX_CTX_ERROR(ctx, "Failed to initialize Crypto-PAn anonymization!", '\0');
+            config_destroy(data->config);
+            free(data);
+            return IPX_ERR_DENIED;
+        }
+
+        IPX_CTX_INFO(ctx, "Crypto-PAn uses %s implementation of AES.",
+            data->cryptopan.aesni ? "AES-NI" : "software");
+    }
+
+    if (data->config->mode == AN_CRYPTOPAN && data->config->cache_size > 0) {
+        const size_t size = (size_t) data->config->cache_size * 1024U;
+        data->cache = anon_cache_create(size);
+        if (!data->cache) {
+            IPX_CTX_ERROR(ctx, "Failed to create a cache of %" PRIu32 " kilobytes! (too small "
+                "or a memory allocation error)", data->config->cache_size);
+            config_destroy(data->config);
+            free(data);
+            return IPX_ERR_DENIED;
+        }
+
+        // Schedule the first report of statistics
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+        data->stats_next = ts.tv_sec + data->config->cache_stats;
+    }
+
+    data->floc = ipx_floc_create(&anonymize_field_match, NULL);
+    if (!data->floc) {
+        IPX_CTX_ERROR(ctx, "Memory allocation error (%s:%d)", __FILE__, __LINE__);
+        if (data->cache != NULL) {
+            anon_cache_destroy(data->cache);
+        }
+        config_destroy(data->config);
+        free(data);
+        return IPX_ERR_DENIED;
     }
 
     ipx_ctx_private_set(ctx, data);
@@ -138,9 +285,14 @@ ipx_plugin_init(ipx_ctx_t *ctx, const char *params)
 void
 ipx_plugin_destroy(ipx_ctx_t *ctx, void *cfg)
 {
-    (void) ctx; // Suppress warnings
     struct instance_data *data = (struct instance_data *) cfg;
 
+    if (data->cache != NULL) {
+        cache_stats_report(ctx, data, true);
+        anon_cache_destroy(data->cache);
+    }
+
+    ipx_floc_destroy(data->floc);
     config_destroy(data->config);
     free(data);
 }
@@ -155,40 +307,38 @@ ipx_plugin_process(ipx_ctx_t *ctx, void *cfg, ipx_msg_t *msg)
     const uint32_t rec_cnt = ipx_msg_ipfix_get_drec_cnt(ipfix_msg);
     for (uint32_t i = 0; i < rec_cnt; ++i) {
         struct ipx_ipfix_record *rec = ipx_msg_ipfix_get_drec(ipfix_msg, i);
+        struct fds_drec *drec = &rec->rec;
+
+        // Jump directly to IPv4/IPv6 addresses with a fixed position in the record
+        const struct ipx_floc_field *locs;
+        uint16_t loc_cnt;
+        if (ipx_floc_get(data->floc, drec->tmplt, &locs, &loc_cnt) == IPX_OK) {
+            for (uint16_t idx = 0; idx < loc_cnt; ++idx) {
+                struct fds_drec_field field;
+                field.data = drec->data + locs[idx].offset;
+                field.size = locs[idx].length;
+                field.info = locs[idx].info;
+                anonymize_field(ctx, data, &field);
+            }
+            continue;
+        }
 
-        // Go through the record and anonymize all IPv4/IPv6 addresses
+        // Otherwise go through the record and anonymize all IPv4/IPv6 addresses
         struct fds_drec_iter it;
-        fds_drec_iter_init(&it, &rec->rec, 0);
+        fds_drec_iter_init(&it, drec, 0);
 
         while (fds_drec_iter_next(&it) != FDS_EOC) {
-            const struct fds_tfield *info = it.field.info;
-            if (info->def == NULL) {
-                // Skip unknown fields
-                continue;
-            }
-
-            const enum fds_iemgr_element_type type = info->def->data_type;
-            if (type != FDS_ET_IPV4_ADDRESS && type != FDS_ET_IPV6_ADDRESS) {
+            if (!anonymize_field_match(it.field.info, NULL)) {
                 // Not an IPv4/IPv6 address
                 continue;
             }
 
-            if (it.field.size != 4U && it.field.size != 16U) {
-                IPX_CTX_DEBUG(ctx, "Unable to anonymize an IP address with invalid size "
-                    "(%" PRIu16 "bytes)!", it.field.size);
-                continue;
-            }
-
-            if (data->config->mode == AN_TRUNC) {
-                // Truncate the address
-                anonymize_trunc(&it.field);
-            } else {
-                // Crypto-PAn
-                anonymize_cryptopan(&it.field);
-            }
+            anonymize_field(ctx, data, &it.field);
         }
     }
 
+    cache_stats_report(ctx, data, false);
+
     // Always pass the message
     ipx_ctx_msg_pass(ctx, msg);
     return IPX_OK;
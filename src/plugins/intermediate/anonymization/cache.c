@@ -0,0 +1,332 @@
+/**
+ * \file src/plugins/intermediate/anonymization/cache.c
+ * \brief Cache of Crypto-PAn one-time-pads (source file)
+ * \date 2026
+ */
+
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include "cache.h"
+
+/** Number of entries in a set                                              */
+#define CACHE_WAYS 2
+
+/** Cache entry                                                             */
+struct cache_entry {
+    /** Address prefix (IPv4 addresses use only the first element)          */
+    uint64_t key[2];
+    /** One-time-pad of the prefix (IPv4 addresses use only the first element) */
+    uint64_t otp[2];
+    /** Entry is in use                                                      */
+    bool valid;
+};
+
+/** Set of entries (the most recently used first)                           */
+struct cache_set {
+    struct cache_entry ways[CACHE_WAYS];
+};
+
+/** Table of prefixes of the same length                                    */
+struct cache_level {
+    /** Array of sets                                                        */
+    struct cache_set *sets;
+    /** Number of sets - 1 (the number is a power of two)                   */
+    uint64_t mask;
+    /** Prefix length (in bits)                                             */
+    uint8_t bits;
+    /** Number of hits                                                       */
+    uint64_t hits;
+};
+
+/** Cache of an address family                                              */
+struct cache_family {
+    /** Tables of prefixes (the longest first)                              */
+    struct cache_level levels[ANON_CACHE_LEVELS];
+    /** Number of lookups                                                    */
+    uint64_t lookups;
+};
+
+struct anon_cache {
+    /** IPv4 addresses (/32, /24, /16)                                       */
+    struct cache_family ipv4;
+    /** IPv6 addresses (/128, /64, /48)                                      */
+    struct cache_family ipv6;
+};
+
+/** Cached prefix lengths of IPv4 addresses (multiples of 8, the longest first) */
+static const uint8_t levels_ipv4[ANON_CACHE_LEVELS] = {32, 24, 16};
+/** Cached prefix lengths of IPv6 addresses (multiples of 8, the longest first) */
+static const uint8_t levels_ipv6[ANON_CACHE_LEVELS] = {128, 64, 48};
+
+/**
+ * \brief Hash function of an address prefix
+ * \note Finalizer of MurmurHash3
+ */
+static inline uint64_t
+cache_hash(const uint64_t key[2])
+{
+    uint64_t h = key[0] ^ (key[1] * 0x9e3779b97f4a7c15ULL);
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+/**
+ * \brief Initialize tables of an address family
+ * \param[in] family Address family to initialize
+ * \param[in] bits   Prefix lengths of the tables
+ * \param[in] size   Maximum memory of each table (in bytes)
+ * \return true on success, false otherwise
+ */
+static bool
+cache_family_init(struct cache_family *family, const uint8_t bits[ANON_CACHE_LEVELS],
+    size_t size)
+{
+    // Number of sets is the highest power of two that fits into the limit
+    size_t set_cnt = 1;
+    while (set_cnt * 2 * sizeof(struct cache_set) <= size) {
+        set_cnt *= 2;
+    }
+
+    for (size_t i = 0; i < ANON_CACHE_LEVELS; ++i) {
+        struct cache_level *level = &family->levels[i];
+        level->sets = calloc(set_cnt, sizeof(*level->sets));
+        if (!level->sets) {
+            return false;
+        }
+
+        level->mask = set_cnt - 1;
+        level->bits = bits[i];
+    }
+
+    return true;
+}
+
+/**
+ * \brief Free tables of an address family
+ * \param[in] family Address family
+ */
+static void
+cache_family_free(struct cache_family *family)
+{
+    for (size_t i = 0; i < ANON_CACHE_LEVELS; ++i) {
+        free(family->levels[i].sets);
+    }
+}
+
+/**
+ * \brief Find the longest cached prefix of an address
+ *
+ * If the prefix is found, its entry is moved to the front of the set.
+ * \param[in]  family Address family
+ * \param[in]  keys   Address prefixes of all levels
+ * \param[out] otp    One-time-pad of the found prefix
+ * \return Index of the level with the prefix or #ANON_CACHE_LEVELS if not found
+ */
+static size_t
+cache_family_find(struct cache_family *family, const uint64_t keys[ANON_CACHE_LEVELS][2],
+    uint64_t otp[2])
+{
+    family->lookups++;
+
+    for (size_t i = 0; i < ANON_CACHE_LEVELS; ++i) {
+        struct cache_level *level = &family->levels[i];
+        struct cache_set *set = &level->sets[cache_hash(keys[i]) & level->mask];
+
+        for (size_t w = 0; w < CACHE_WAYS; ++w) {
+            struct cache_entry *entry = &set->ways[w];
+            if (!entry->valid || entry->key[0] != keys[i][0] || entry->key[1] != keys[i][1]) {
+                continue;
+            }
+
+            otp[0] = entry->otp[0];
+            otp[1] = entry->otp[1];
+            if (w != 0) {
+                // Keep the most recently used entry at the front
+                const struct cache_entry tmp = *entry;
+                memmove(&set->ways[1], &set->ways[0], w * sizeof(*entry));
+                set->ways[0] = tmp;
+            }
+
+            level->hits++;
+            return i;
+        }
+    }
+
+    return ANON_CACHE_LEVELS;
+}
+
+/**
+ * \brief Add prefixes of an address to the levels before the found one
+ *
+ * The least recently used entry of each set is replaced.
+ * \param[in] family Address family
+ * \param[in] keys   Address prefixes of all levels
+ * \param[in] cnt    Number of levels to fill (starting from the longest prefix)
+ * \param[in] otp    One-time-pad of the address
+ */
+static void
+cache_family_insert(struct cache_family *family, const uint64_t keys[ANON_CACHE_LEVELS][2],
+    size_t cnt, const uint64_t otp[2])
+{
+    for (size_t i = 0; i < cnt; ++i) {
+        struct cache_level *level = &family->levels[i];
+        struct cache_set *set = &level->sets[cache_hash(keys[i]) & level->mask];
+
+        memmove(&set->ways[1], &set->ways[0], (CACHE_WAYS - 1) * sizeof(set->ways[0]));
+        set->ways[0].key[0] = keys[i][0];
+        set->ways[0].key[1] = keys[i][1];
+        set->ways[0].otp[0] = otp[0];
+        set->ways[0].otp[1] = otp[1];
+        set->ways[0].valid = true;
+    }
+}
+
+/**
+ * \brief Get and reset statistics of an address family
+ * \param[in]  family Address family
+ * \param[out] stats  Statistics
+ */
+static void
+cache_family_stats(struct cache_family *family, struct anon_cache_stats *stats)
+{
+    stats->lookups = family->lookups;
+    family->lookups = 0;
+
+    for (size_t i = 0; i < ANON_CACHE_LEVELS; ++i) {
+        stats->hits[i] = family->levels[i].hits;
+        stats->bits[i] = family->levels[i].bits;
+        family->levels[i].hits = 0;
+    }
+}
+
+anon_cache_t *
+anon_cache_create(size_t size)
+{
+    // Each address family has the same number of tables of the same size
+    const size_t table_size = size / (2 * ANON_CACHE_LEVELS);
+    if (table_size < sizeof(struct cache_set)) {
+        return NULL;
+    }
+
+    struct anon_cache *cache = calloc(1, sizeof(*cache));
+    if (!cache) {
+        return NULL;
+    }
+
+    if (!cache_family_init(&cache->ipv4, levels_ipv4, table_size)
+            || !cache_family_init(&cache->ipv6, levels_ipv6, table_size)) {
+        anon_cache_destroy(cache);
+        return NULL;
+    }
+
+    return cache;
+}
+
+void
+anon_cache_destroy(anon_cache_t *cache)
+{
+    cache_family_free(&cache->ipv4);
+    cache_family_free(&cache->ipv6);
+    free(cache);
+}
+
+uint32_t
+anon_cache_ipv4(anon_cache_t *cache, const PAnonymizer_t *pan, uint32_t addr)
+{
+    struct cache_family *family = &cache->ipv4;
+    uint64_t keys[ANON_CACHE_LEVELS][2];
+    uint64_t otp[2] = {0, 0};
+
+    for (size_t i = 0; i < ANON_CACHE_LEVELS; ++i) {
+        const uint8_t bits = family->levels[i].bits;
+        keys[i][0] = (bits == 32) ? addr : (addr & ~(UINT32_MAX >> bits));
+        keys[i][1] = 0;
+    }
+
+    const size_t idx = cache_family_find(family, keys, otp);
+    if (idx == 0) {
+        // Complete address
+        return ((uint32_t) otp[0]) ^ addr;
+    }
+
+    // Compute only bits after the cached prefix (if any)
+    const int from = (idx < ANON_CACHE_LEVELS) ? family->levels[idx].bits : 0;
+    otp[0] = anonymize_otp(pan, addr, from, (uint32_t) otp[0]);
+    cache_family_insert(family, keys, idx, otp);
+    return ((uint32_t) otp[0]) ^ addr;
+}
+
+void
+anon_cache_ipv6(anon_cache_t *cache, const PAnonymizer_t *pan, const uint64_t addr[2],
+    uint64_t res[2])
+{
+    struct cache_family *family = &cache->ipv6;
+    uint64_t keys[ANON_CACHE_LEVELS][2];
+    uint64_t otp[2] = {0, 0};
+
+    for (size_t i = 0; i < ANON_CACHE_LEVELS; ++i) {
+        // Bytes of the address are in network byte order and prefixes are multiples of 8 bits
+        const uint8_t bytes = family->levels[i].bits / 8U;
+        keys[i][0] = keys[i][1] = 0;
+        memcpy(keys[i], addr, bytes);
+    }
+
+    const size_t idx = cache_family_find(family, keys, otp);
+    if (idx != 0) {
+        // Compute only bits after the cached prefix (if any)
+        const int from = (idx < ANON_CACHE_LEVELS) ? family->levels[idx].bits : 0;
+        anonymize_otp_v6(pan, addr, from, otp);
+        cache_family_insert(family, keys, idx, otp);
+    }
+
+    res[0] = otp[0] ^ addr[0];
+    res[1] = otp[1] ^ addr[1];
+}
+
+void
+anon_cache_stats(anon_cache_t *cache, struct anon_cache_stats *ipv4,
+    struct anon_cache_stats *ipv6)
+{
+    cache_family_stats(&cache->ipv4, ipv4);
+    cache_family_stats(&cache->ipv6, ipv6);
+}
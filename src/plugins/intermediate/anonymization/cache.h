@@ -0,0 +1,122 @@
+/**
+ * \file src/plugins/intermediate/anonymization/cache.h
+ * \brief Cache of Crypto-PAn one-time-pads (header file)
+ * \date 2026
+ */
+
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#ifndef ANON_CACHE_H
+#define ANON_CACHE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "Crypto-PAn/panonymizer.h"
+
+/** Number of cached prefix lengths of each address family                  */
+#define ANON_CACHE_LEVELS 3
+
+/**
+ * \brief Cache of Crypto-PAn results
+ *
+ * The anonymized address is the original address XOR-ed with a one-time-pad, where the n-th
+ * bit of the pad depends only on the first n bits of the address. Therefore, the cache stores
+ * pads of complete addresses (IPv4 /32, IPv6 /128) and of their common prefixes
+ * (IPv4 /24 and /16, IPv6 /64 and /48). A new address that shares a cached prefix needs to
+ * compute only the bits after the prefix.
+ *
+ * Each prefix length has its own bounded 2-way set associative table with LRU replacement.
+ * The cache is not thread-safe.
+ */
+typedef struct anon_cache anon_cache_t;
+
+/** Statistics of an address family                                         */
+struct anon_cache_stats {
+    /** Number of lookups                                                    */
+    uint64_t lookups;
+    /** Number of hits of each prefix length (the longest first)            */
+    uint64_t hits[ANON_CACHE_LEVELS];
+    /** Cached prefix lengths (the longest first)                           */
+    uint8_t bits[ANON_CACHE_LEVELS];
+};
+
+/**
+ * \brief Create a cache
+ * \param[in] size Maximum memory used by the cache (in bytes)
+ * \return Pointer to the cache or NULL (memory allocation error or the size is too small)
+ */
+anon_cache_t *
+anon_cache_create(size_t size);
+
+/**
+ * \brief Destroy a cache
+ * \param[in] cache Cache to destroy
+ */
+void
+anon_cache_destroy(anon_cache_t *cache);
+
+/**
+ * \brief Anonymize an IPv4 address using the cache
+ * \param[in] cache Cache
+ * \param[in] pan   Crypto-PAn state (must be the same for all calls with the cache)
+ * \param[in] addr  IPv4 address (host byte order)
+ * \return Anonymized address (host byte order)
+ */
+uint32_t
+anon_cache_ipv4(anon_cache_t *cache, const PAnonymizer_t *pan, uint32_t addr);
+
+/**
+ * \brief Anonymize an IPv6 address using the cache
+ * \param[in]  cache Cache
+ * \param[in]  pan   Crypto-PAn state (must be the same for all calls with the cache)
+ * \param[in]  addr  IPv6 address (network byte order)
+ * \param[out] res   Anonymized address (network byte order)
+ */
+void
+anon_cache_ipv6(anon_cache_t *cache, const PAnonymizer_t *pan, const uint64_t addr[2],
+    uint64_t res[2]);
+
+/**
+ * \brief Get and reset statistics of the cache
+ * \param[in]  cache Cache
+ * \param[out] ipv4  Statistics of IPv4 addresses since the previous call
+ * \param[out] ipv6  Statistics of IPv6 addresses since the previous call
+ */
+void
+anon_cache_stats(anon_cache_t *cache, struct anon_cache_stats *ipv4,
+    struct anon_cache_stats *ipv6);
+
+#endif // ANON_CACHE_H
@@ -45,14 +45,19 @@
 
 /*
  * <params>
- *  <delay>...</delay>          <!-- in microseconds -->
+ *  <type>...</type>
+ *  <key>...</key>                         <!-- optional -->
+ *  <cacheSize>...</cacheSize>             <!-- optional, in kilobytes -->
+ *  <cacheStatsInterval>...</cacheStatsInterval> <!-- optional, in seconds -->
  * </params>
  */
 
 /** XML nodes */
 enum params_xml_nodes {
     ANON_TYPE = 1,
-    ANON_KEY
+    ANON_KEY,
+    ANON_CACHE_SIZE,
+    ANON_CACHE_STATS
 };
 
 /** Definition of the \<params\> node  */
@@ -60,6 +65,8 @@ static const struct fds_xml_args args_params[] = {
     FDS_OPTS_ROOT("params"),
     FDS_OPTS_ELEM(ANON_TYPE, "type", FDS_OPTS_T_STRING, 0),
     FDS_OPTS_ELEM(ANON_KEY,  "key",  FDS_OPTS_T_STRING, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(ANON_CACHE_SIZE,  "cacheSize",          FDS_OPTS_T_UINT, FDS_OPTS_P_OPT),
+    FDS_OPTS_ELEM(ANON_CACHE_STATS, "cacheStatsInterval", FDS_OPTS_T_UINT, FDS_OPTS_P_OPT),
     FDS_OPTS_END
 };
 
@@ -111,6 +118,22 @@ config_parser_root(ipx_ctx_t *ctx, fds_xml_ctx_t *root, struct anon_config *cfg)
                 return IPX_ERR_FORMAT;
             }
             break;
+        case ANON_CACHE_SIZE:
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint > UINT32_MAX / 1024U) {
+                IPX_CTX_ERROR(ctx, "Size of the cache <cacheSize> is too big!", '\0');
+                return IPX_ERR_FORMAT;
+            }
+            cfg->cache_size = (uint32_t) content->val_uint;
+            break;
+        case ANON_CACHE_STATS:
+            assert(content->type == FDS_OPTS_T_UINT);
+            if (content->val_uint > UINT32_MAX) {
+                IPX_CTX_ERROR(ctx, "Interval <cacheStatsInterval> is too big!", '\0');
+                return IPX_ERR_FORMAT;
+            }
+            cfg->cache_stats = (uint32_t) content->val_uint;
+            break;
         default:
             // Internal error
             assert(false);
@@ -158,6 +181,10 @@ config_check(ipx_ctx_t *ctx, struct anon_config *cfg)
         IPX_CTX_WARNING(ctx, "Selected technique ignores the given key.", '\0');
     }
 
+    if (cfg->mode == AN_CRYPTOPAN && cfg->cache_size == 0 && cfg->cache_stats != 0) {
+        IPX_CTX_WARNING(ctx, "The cache is disabled, its statistics will not be available.", '\0');
+    }
+
     return IPX_OK;
 }
 
@@ -172,6 +199,8 @@ config_parse(ipx_ctx_t *ctx, const char *params)
 
     // Set default parameters
     cfg->crypto_key = NULL;
+    cfg->cache_size = ANON_CACHE_SIZE_DEF;
+    cfg->cache_stats = 0;
 
     // Create an XML parser
     fds_xml_t *parser = fds_xml_create();
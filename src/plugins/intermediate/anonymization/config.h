@@ -47,6 +47,8 @@
 
 /** Length of anonymization key                          */
 #define ANON_KEY_LEN 32
+/** Default size of the Crypto-PAn cache (in kilobytes)  */
+#define ANON_CACHE_SIZE_DEF 4096U
 
 /** Supported anonymization techniques                   */
 enum anon_mode {
@@ -62,7 +64,10 @@ struct anon_config {
     enum anon_mode mode;
     /** CryptoPan key (can be NULL, if not set)          */
     char *crypto_key;
-
+    /** Size of the Crypto-PAn cache (in kilobytes, 0 = disabled) */
+    uint32_t cache_size;
+    /** Interval of cache statistics (in seconds, 0 = disabled)   */
+    uint32_t cache_stats;
 };
 
 /**
@@ -0,0 +1,870 @@
+/**
+ * \file src/plugins/output/common/JsonSerializer.cpp
+ * \brief Template-specialised JSON serializer (source file)
+ * \date 2026
+ */
+
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <new>
+#include <arpa/inet.h>
+
+#include "JsonSerializer.hpp"
+
+/** Header of a record based on a Template                                                       */
+#define HEAD_ENTRY "{\"@type\":\"ipfix.entry\""
+/** Header of a record based on an Options Template                                             */
+#define HEAD_OPTS  "{\"@type\":\"ipfix.optionsEntry\""
+/** Private Enterprise Number of reverse Information Elements (RFC 5103)                         */
+#define PEN_REVERSE 29305U
+/** Number of memorised values of each short field rendered by libfds                           */
+#define MEMO_SIZE 256U
+/** Initial free space for the generic converter if a string is added after other content      */
+#define FALLBACK_BASE 4096U
+
+/** Type of field formatter                                                                      */
+enum class FieldType {
+    UINT,     /**< Unsigned integer                                                          */
+    INT,      /**< Signed integer                                                            */
+    IPV4,     /**< IPv4 address                                                              */
+    IPV6,     /**< IPv6 address                                                              */
+    TS_UNIX,  /**< Timestamp as a number of milliseconds since the UNIX epoch                */
+    TS_ISO,   /**< Timestamp in ISO 8601 format with milliseconds                            */
+    HEX,      /**< Octet array as a hexadecimal string (e.g. "0x0A1B")                       */
+    MAC,      /**< MAC address (e.g. "0A:1B:2C:3D:4E:5F")                                    */
+    LIBFDS    /**< Value rendered by libfds                                                  */
+};
+
+/** Memorised value of a short field                                                             */
+struct FieldMemo {
+    /** Raw value of the field (UINT32_MAX, if the slot is empty)                                */
+    uint32_t raw = UINT32_MAX;
+    /** Converted value                                                                          */
+    std::string value;
+};
+
+/** Deleter of a template                                                                        */
+struct TemplateDeleter {
+    void operator()(struct fds_template *tmplt) const {fds_template_destroy(tmplt);};
+};
+
+/** Conversion plan of a single field                                                            */
+struct JsonSerializer::Field {
+    /** Formatter                                                                                */
+    FieldType type;
+    /** Offset of the field from the start of the record                                         */
+    uint16_t offset;
+    /** Length of the field                                                                      */
+    uint16_t length;
+    /** Data type of the field (only for timestamps)                                             */
+    enum fds_iemgr_element_type data_type;
+    /** Hexadecimal digits used by libfds (only for FieldType::HEX and FieldType::MAC)          */
+    const char *digits = nullptr;
+    /** Pre-rendered key fragment (e.g. ',"iana:octetDeltaCount":')                              */
+    std::string key;
+
+    /** One-field template for rendering by libfds (only for FieldType::LIBFDS)                  */
+    std::unique_ptr<struct fds_template, TemplateDeleter> tmplt;
+    /** Position of the value in the string rendered by libfds (only for FieldType::LIBFDS)      */
+    size_t value_pos = 0;
+    /** Memorised values (only for FieldType::LIBFDS fields of up to 2 bytes, otherwise NULL)   */
+    std::unique_ptr<FieldMemo[]> memo;
+};
+
+/** Conversion plan of a template                                                                */
+struct JsonSerializer::Plan {
+    /** Key of the plan (template pointer + reverse flag)                                        */
+    uintptr_t key;
+    /** Copy of the template definition                                                          */
+    std::vector<uint8_t> raw;
+    /** All records must be converted by fds_drec2json()                                         */
+    bool generic = false;
+    /** Record header (i.e. '{"@type":"ipfix.entry"')                                           */
+    std::string head;
+    /** Fields                                                                                   */
+    std::vector<Field> fields;
+    /** Maximum length of a converted record (excluding values rendered by libfds)             */
+    size_t size_max = 0;
+};
+
+/**
+ * \brief Make sure that the output buffer is at least \p n bytes long
+ * \param[in,out] buffer Output buffer (can be NULL)
+ * \param[in,out] size   Size of the output buffer
+ * \param[in]     n      Required size
+ * \return True on success, false on memory allocation error
+ */
+static inline bool
+buffer_reserve(char **buffer, size_t *size, size_t n)
+{
+    if (n <= *size) {
+        return true;
+    }
+
+    const size_t new_size = (n > 2 * (*size)) ? n : 2 * (*size);
+    char *new_buffer = static_cast<char *>(realloc(*buffer, new_size));
+    if (!new_buffer) {
+        return false;
+    }
+
+    *buffer = new_buffer;
+    *size = new_size;
+    return true;
+}
+
+/**
+ * \brief Write an unsigned integer in decimal notation
+ * \param[in] pos   Output position (at least 20 bytes must be available)
+ * \param[in] value Value to write
+ * \return Position after the last written character
+ */
+static inline char *
+write_uint(char *pos, uint64_t value)
+{
+    static const char digits[] =
+        "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+        "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+        "8081828384858687888990919293949596979899";
+
+    char tmp[20];
+    char *end = tmp + sizeof(tmp);
+    char *start = end;
+
+    while (value >= 100) {
+        const unsigned idx = static_cast<unsigned>(value % 100) * 2;
+        value /= 100;
+        *(--start) = digits[idx + 1];
+        *(--start) = digits[idx];
+    }
+
+    if (value >= 10) {
+        const unsigned idx = static_cast<unsigned>(value) * 2;
+        *(--start) = digits[idx + 1];
+        *(--start) = digits[idx];
+    } else {
+        *(--start) = static_cast<char>('0' + value);
+    }
+
+    const size_t len = static_cast<size_t>(end - start);
+    memcpy(pos, start, len);
+    return pos + len;
+}
+
+/**
+ * \brief Write a signed integer in decimal notation
+ * \param[in] pos   Output position (at least 20 bytes must be available)
+ * \param[in] value Value to write
+ * \return Position after the last written character
+ */
+static inline char *
+write_int(char *pos, int64_t value)
+{
+    if (value >= 0) {
+        return write_uint(pos, static_cast<uint64_t>(value));
+    }
+
+    *(pos++) = '-';
+    return write_uint(pos, ~static_cast<uint64_t>(value) + 1U);
+}
+
+/**
+ * \brief Write a quoted IPv4 address in dotted-decimal notation
+ * \param[in] pos  Output position (at least 17 bytes must be available)
+ * \param[in] addr IPv4 address (4 bytes, network byte order)
+ * \return Position after the last written character
+ */
+static inline char *
+write_ipv4(char *pos, const uint8_t *addr)
+{
+    *(pos++) = '"';
+    for (unsigned i = 0; i < 4; ++i) {
+        const unsigned octet = addr[i];
+        if (octet >= 100) {
+            *(pos++) = static_cast<char>('0' + octet / 100);
+        }
+        if (octet >= 10) {
+            *(pos++) = static_cast<char>('0' + (octet / 10) % 10);
+        }
+        *(pos++) = static_cast<char>('0' + octet % 10);
+        *(pos++) = (i < 3) ? '.' : '"';
+    }
+
+    return pos;
+}
+
+/** Uppercase hexadecimal digits                                                                 */
+static const char HEX_UPPER[] = "0123456789ABCDEF";
+/** Lowercase hexadecimal digits                                                                 */
+static const char HEX_LOWER[] = "0123456789abcdef";
+
+/**
+ * \brief Write an octet array as a quoted hexadecimal string with the "0x" prefix
+ * \param[in] pos    Output position (at least 2 * len + 4 bytes must be available)
+ * \param[in] data   Octet array
+ * \param[in] len    Length of the array
+ * \param[in] digits Hexadecimal digits
+ * \return Position after the last written character
+ */
+static inline char *
+write_hex(char *pos, const uint8_t *data, uint16_t len, const char *digits)
+{
+    *(pos++) = '"';
+    *(pos++) = '0';
+    *(pos++) = 'x';
+    for (uint16_t i = 0; i < len; ++i) {
+        *(pos++) = digits[data[i] >> 4];
+        *(pos++) = digits[data[i] & 0x0F];
+    }
+    *(pos++) = '"';
+    return pos;
+}
+
+/**
+ * \brief Write a quoted MAC address
+ * \param[in] pos    Output position (at least 19 bytes must be available)
+ * \param[in] addr   MAC address (6 bytes)
+ * \param[in] digits Hexadecimal digits
+ * \return Position after the last written character
+ */
+static inline char *
+write_mac(char *pos, const uint8_t *addr, const char *digits)
+{
+    *(pos++) = '"';
+    for (unsigned i = 0; i < 6; ++i) {
+        *(pos++) = digits[addr[i] >> 4];
+        *(pos++) = digits[addr[i] & 0x0F];
+        *(pos++) = (i < 5) ? ':' : '"';
+    }
+    return pos;
+}
+
+/**
+ * \brief Check if a field is affected by protocol or TCP flags formatting
+ * \param[in] en    Enterprise Number
+ * \param[in] id    Information Element ID
+ * \param[in] flags Conversion flags
+ */
+static inline bool
+is_formatted(uint32_t en, uint16_t id, uint32_t flags)
+{
+    if (en != 0 && en != PEN_REVERSE) {
+        return false;
+    }
+
+    return (id == 4 && (flags & FDS_CD2J_FORMAT_PROTO) != 0)
+        || (id == 6 && (flags & FDS_CD2J_FORMAT_TCPFLAGS) != 0);
+}
+
+JsonSerializer::JsonSerializer(uint32_t flags)
+    : m_flags((flags & ~uint32_t(FDS_CD2J_BIFLOW_REVERSE)) | FDS_CD2J_ALLOW_REALLOC)
+{
+    m_ts_str[0] = '\0';
+}
+
+JsonSerializer::~JsonSerializer()
+{
+    free(m_aux_buffer);
+}
+
+int
+JsonSerializer::convert(const struct fds_drec *rec, bool reverse, const fds_iemgr_t *iemgr,
+    char **buffer, size_t *size, size_t offset)
+{
+    Plan *plan = plan_get(rec, reverse, iemgr);
+    if (plan != nullptr && !plan->generic) {
+        int rc = plan_apply(*plan, rec, iemgr, buffer, size, offset);
+        if (rc >= 0) {
+            return rc;
+        }
+    }
+
+    // Fallback to the generic converter
+    const uint32_t flags = m_flags | (reverse ? FDS_CD2J_BIFLOW_REVERSE : 0);
+    if (offset == 0) {
+        return fds_drec2json(rec, flags, iemgr, buffer, size);
+    }
+
+    // The generic converter would reallocate only the rest of the buffer, enlarge it here
+    size_t size_req = offset + FALLBACK_BASE;
+    while (true) {
+        if (!buffer_reserve(buffer, size, size_req)) {
+            return FDS_ERR_NOMEM;
+        }
+
+        char *rest = *buffer + offset;
+        size_t rest_size = *size - offset;
+        int rc = fds_drec2json(rec, flags & ~uint32_t(FDS_CD2J_ALLOW_REALLOC), iemgr, &rest,
+            &rest_size);
+        if (rc != FDS_ERR_BUFFER) {
+            return rc;
+        }
+        size_req = 2 * (*size);
+    }
+}
+
+/**
+ * \brief Get a conversion plan of a record (compile it, if necessary)
+ *
+ * A plan is identified by the template pointer, however, the template could have been freed
+ * and another one allocated at the same address. Therefore, the definition of the template is
+ * always compared with the definition used to compile the plan.
+ * \param[in] rec     Data Record
+ * \param[in] reverse Reverse point of view
+ * \param[in] iemgr   Manager of Information Elements
+ * \return Pointer to the plan or NULL (memory allocation error)
+ */
+JsonSerializer::Plan *
+JsonSerializer::plan_get(const struct fds_drec *rec, bool reverse, const fds_iemgr_t *iemgr)
+{
+    if (iemgr != m_iemgr) {
+        // Definitions of Information Elements might have changed
+        m_plans.clear();
+        m_last = nullptr;
+        m_iemgr = iemgr;
+    }
+
+    const struct fds_template *tmplt = rec->tmplt;
+    const uintptr_t key = reinterpret_cast<uintptr_t>(tmplt) | (reverse ? 1U : 0U);
+    Plan *plan = m_last;
+
+    if (plan == nullptr || plan->key != key) {
+        auto it = m_plans.find(key);
+        plan = (it != m_plans.end()) ? it->second.get() : nullptr;
+    }
+
+    if (plan != nullptr && plan->raw.size() == tmplt->raw.length
+            && memcmp(plan->raw.data(), tmplt->raw.data, tmplt->raw.length) == 0) {
+        m_last = plan;
+        return plan;
+    }
+
+    // Compile a new plan
+    m_last = nullptr;
+    std::unique_ptr<Plan> new_plan = plan_compile(rec, reverse, iemgr);
+    if (!new_plan) {
+        return nullptr;
+    }
+
+    if (m_plans.size() >= PLANS_MAX && m_plans.find(key) == m_plans.end()) {
+        // Plans of withdrawn templates are never removed otherwise
+        m_plans.clear();
+    }
+
+    plan = new_plan.get();
+    m_plans[key] = std::move(new_plan);
+    m_last = plan;
+    return plan;
+}
+
+/**
+ * \brief Compile a conversion plan of a record
+ *
+ * The plan is checked against fds_drec2json() using the record. If the outputs differ, the
+ * plan is marked as generic.
+ * \param[in] rec     Data Record
+ * \param[in] reverse Reverse point of view
+ * \param[in] iemgr   Manager of Information Elements
+ * \return Pointer to the plan or NULL (memory allocation error)
+ */
+std::unique_ptr<JsonSerializer::Plan>
+JsonSerializer::plan_compile(const struct fds_drec *rec, bool reverse, const fds_iemgr_t *iemgr)
+{
+    const struct fds_template *tmplt = rec->tmplt;
+    std::unique_ptr<Plan> plan(new(std::nothrow) Plan);
+    if (!plan) {
+        return nullptr;
+    }
+
+    plan->key = reinterpret_cast<uintptr_t>(tmplt) | (reverse ? 1U : 0U);
+    plan->raw.assign(tmplt->raw.data, tmplt->raw.data + tmplt->raw.length);
+    if ((tmplt->flags & (FDS_TEMPLATE_DYNAMIC | FDS_TEMPLATE_MULTI_IE)) != 0) {
+        // Field positions are not fixed or multiple occurrences are merged into an array
+        plan->generic = true;
+        return plan;
+    }
+
+    plan->head = (tmplt->type == FDS_TYPE_TEMPLATE_OPTS) ? HEAD_OPTS : HEAD_ENTRY;
+    plan->size_max = plan->head.size() + 2U; // "}\0"
+
+    // Iterate over fields in the same way as fds_drec2json()
+    uint16_t iter_flags = reverse ? FDS_DREC_BIFLOW_REV : FDS_DREC_BIFLOW_FWD;
+    iter_flags |= (m_flags & FDS_CD2J_IGNORE_UNKNOWN) ? FDS_DREC_UNKNOWN_SKIP : 0;
+    iter_flags |= (m_flags & FDS_CD2J_REVERSE_SKIP) ? FDS_DREC_REVERSE_SKIP : 0;
+
+    struct fds_drec_iter iter;
+    fds_drec_iter_init(&iter, const_cast<struct fds_drec *>(rec), iter_flags);
+    while (fds_drec_iter_next(&iter) != FDS_EOC) {
+        plan->fields.emplace_back();
+        Field &field = plan->fields.back();
+        if (!field_prepare(field, iter.field, iemgr)) {
+            plan->generic = true;
+            plan->fields.clear();
+            return plan;
+        }
+
+        plan->size_max += field.key.size();
+        switch (field.type) {
+        case FieldType::UINT:
+        case FieldType::INT:
+        case FieldType::TS_UNIX:
+            plan->size_max += 20U;
+            break;
+        case FieldType::IPV4:
+            plan->size_max += 17U;
+            break;
+        case FieldType::IPV6:
+            plan->size_max += INET6_ADDRSTRLEN + 2U;
+            break;
+        case FieldType::TS_ISO:
+            plan->size_max += sizeof(m_ts_str) + 7U; // quotes + ".000Z"
+            break;
+        case FieldType::HEX:
+            plan->size_max += 2U * field.length + 4U;
+            break;
+        case FieldType::MAC:
+            plan->size_max += 19U;
+            break;
+        case FieldType::LIBFDS:
+            break;
+        }
+    }
+
+    // Check the plan against the generic converter
+    char *check_buffer = nullptr;
+    size_t check_size = 0;
+    int check_len = plan_apply(*plan, rec, iemgr, &check_buffer, &check_size, 0);
+    const uint32_t flags = m_flags | (reverse ? FDS_CD2J_BIFLOW_REVERSE : 0);
+    int ref_len = fds_drec2json(rec, flags, iemgr, &m_aux_buffer, &m_aux_size);
+    if (check_len < 0 || check_len != ref_len
+            || memcmp(check_buffer, m_aux_buffer, size_t(ref_len)) != 0) {
+        plan->generic = true;
+        plan->fields.clear();
+    }
+
+    free(check_buffer);
+    return plan;
+}
+
+/**
+ * \brief Prepare conversion of a field
+ * \param[out] field Field plan to fill
+ * \param[in]  data  Field of the first record
+ * \param[in]  iemgr Manager of Information Elements
+ * \return True on success, false if the field cannot be converted by the plan
+ */
+bool
+JsonSerializer::field_prepare(Field &field, const struct fds_drec_field &data,
+    const fds_iemgr_t *iemgr)
+{
+    const struct fds_tfield *info = data.info;
+    const struct fds_iemgr_elem *def = info->def;
+    const bool numeric = (m_flags & FDS_CD2J_NUMERIC_ID) != 0 || def == nullptr;
+
+    if (data.size != info->length || info->length == FDS_IPFIX_VAR_IE_LEN) {
+        return false;
+    }
+
+    field.offset = info->offset;
+    field.length = info->length;
+    field.data_type = (def != nullptr) ? def->data_type : FDS_ET_OCTET_ARRAY;
+
+    // Pre-render the key
+    char key_buffer[64];
+    if (numeric) {
+        snprintf(key_buffer, sizeof(key_buffer), ",\"en%" PRIu32 ":id%" PRIu16 "\":",
+            info->en, info->id);
+        field.key = key_buffer;
+    } else {
+        field.key = ",\"";
+        field.key += def->scope->name;
+        field.key += ":";
+        field.key += def->name;
+        field.key += "\":";
+    }
+
+    // Select a formatter (fields without a definition are octet arrays)
+    field.type = FieldType::LIBFDS;
+    const uint16_t len = field.length;
+    const bool octets_uint = (m_flags & FDS_CD2J_OCTETS_NOINT) == 0 && len >= 1 && len <= 8;
+    if (!is_formatted(info->en, info->id, m_flags)
+            && (def == nullptr || !is_formatted(def->scope->pen, def->id, m_flags))) {
+        switch (field.data_type) {
+        case FDS_ET_UNSIGNED_8:
+        case FDS_ET_UNSIGNED_16:
+        case FDS_ET_UNSIGNED_32:
+        case FDS_ET_UNSIGNED_64:
+            field.type = (len >= 1 && len <= 8) ? FieldType::UINT : FieldType::LIBFDS;
+            break;
+        case FDS_ET_SIGNED_8:
+        case FDS_ET_SIGNED_16:
+        case FDS_ET_SIGNED_32:
+        case FDS_ET_SIGNED_64:
+            field.type = (len >= 1 && len <= 8) ? FieldType::INT : FieldType::LIBFDS;
+            break;
+        case FDS_ET_IPV4_ADDRESS:
+            field.type = (len == 4) ? FieldType::IPV4 : FieldType::LIBFDS;
+            break;
+        case FDS_ET_IPV6_ADDRESS:
+            field.type = (len == 16) ? FieldType::IPV6 : FieldType::LIBFDS;
+            break;
+        case FDS_ET_DATE_TIME_SECONDS:
+        case FDS_ET_DATE_TIME_MILLISECONDS:
+        case FDS_ET_DATE_TIME_MICROSECONDS:
+        case FDS_ET_DATE_TIME_NANOSECONDS:
+            if (len == ((def->data_type == FDS_ET_DATE_TIME_SECONDS) ? 4 : 8)) {
+                field.type = (m_flags & FDS_CD2J_TS_FORMAT_MSEC)
+                    ? FieldType::TS_ISO : FieldType::TS_UNIX;
+            }
+            break;
+        case FDS_ET_OCTET_ARRAY:
+            if (len >= 1) {
+                field.type = octets_uint ? FieldType::UINT : FieldType::HEX;
+            }
+            break;
+        case FDS_ET_MAC_ADDRESS:
+            field.type = (len == 6) ? FieldType::MAC : FieldType::LIBFDS;
+            break;
+        default:
+            break;
+        }
+    }
+
+    // Formatting of octet arrays and MAC addresses is verified against libfds below
+    const bool probe = field.data_type == FDS_ET_OCTET_ARRAY
+        || field.data_type == FDS_ET_MAC_ADDRESS;
+    if (field.type != FieldType::LIBFDS && !probe) {
+        return true;
+    }
+
+    // Prepare a one-field template with the same definition of the Information Element
+    const uint32_t en = numeric ? info->en : def->scope->pen;
+    const uint16_t id = numeric ? info->id : def->id;
+    uint8_t raw[12];
+    uint16_t raw_len = (en != 0) ? 12 : 8;
+    const uint16_t raw_hdr[] = {htons(256), htons(1), htons(id | ((en != 0) ? 0x8000 : 0)),
+        htons(len)};
+    const uint32_t raw_en = htonl(en);
+    memcpy(raw, raw_hdr, sizeof(raw_hdr));
+    memcpy(raw + sizeof(raw_hdr), &raw_en, sizeof(raw_en));
+
+    struct fds_template *tmplt;
+    if (fds_template_parse(FDS_TYPE_TEMPLATE, raw, &raw_len, &tmplt) != FDS_OK) {
+        return false;
+    }
+    field.tmplt.reset(tmplt);
+    if (iemgr != nullptr && fds_template_ies_define(tmplt, iemgr, false) != FDS_OK) {
+        return false;
+    }
+
+    // Find the position of the value in the rendered string, i.e. after '{"@type":"...","key":'
+    struct fds_drec rec;
+    rec.data = data.data;
+    rec.size = len;
+    rec.tmplt = tmplt;
+    rec.snap = nullptr;
+    const uint32_t flags = m_flags & ~uint32_t(FDS_CD2J_REVERSE_SKIP | FDS_CD2J_IGNORE_UNKNOWN);
+    int rc = fds_drec2json(&rec, flags, iemgr, &m_aux_buffer, &m_aux_size);
+    if (rc < 0) {
+        return false;
+    }
+
+    const size_t head_len = strlen(HEAD_ENTRY);
+    if (size_t(rc) <= head_len + 2U
+            || strncmp(m_aux_buffer, HEAD_ENTRY ",\"", head_len + 2U) != 0) {
+        return false;
+    }
+    const char *key_end = strstr(m_aux_buffer + head_len + 2U, "\":");
+    if (key_end == nullptr) {
+        return false;
+    }
+
+    field.value_pos = static_cast<size_t>(key_end - m_aux_buffer) + 2U;
+    if (field.type != FieldType::LIBFDS) {
+        if (field_probe(field, iemgr)) {
+            field.tmplt.reset();
+            return true;
+        }
+        field.type = FieldType::LIBFDS;
+    }
+
+    if (len <= 2) {
+        field.memo.reset(new(std::nothrow) FieldMemo[MEMO_SIZE]);
+        if (!field.memo) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * \brief Check that a natively formatted field matches the output of libfds
+ *
+ * A probe value with all hexadecimal digits is rendered by libfds and by the formatter of
+ * the field. For hexadecimal formatters, the case of digits used by libfds is selected.
+ * \param[in,out] field Field plan (with a prepared one-field template)
+ * \param[in]     iemgr Manager of Information Elements
+ * \return True if the formatter produces the same output as libfds, false otherwise
+ */
+bool
+JsonSerializer::field_probe(Field &field, const fds_iemgr_t *iemgr)
+{
+    std::vector<uint8_t> data(field.length);
+    for (size_t i = 0; i < data.size(); ++i) {
+        data[i] = static_cast<uint8_t>(0x01 + 0x89 * (i % 16));
+    }
+
+    const char *ref;
+    size_t ref_len;
+    if (!value_render(field, data.data(), iemgr, &ref, &ref_len)) {
+        return false;
+    }
+
+    std::vector<char> value(2U * field.length + 24U);
+    for (const char *digits : {HEX_UPPER, HEX_LOWER}) {
+        char *end = value.data();
+        switch (field.type) {
+        case FieldType::UINT: {
+            uint64_t uint;
+            fds_get_uint_be(data.data(), field.length, &uint);
+            end = write_uint(end, uint);
+            } break;
+        case FieldType::HEX:
+            end = write_hex(end, data.data(), field.length, digits);
+            break;
+        case FieldType::MAC:
+            end = write_mac(end, data.data(), digits);
+            break;
+        default:
+            return false;
+        }
+
+        if (size_t(end - value.data()) == ref_len && memcmp(value.data(), ref, ref_len) == 0) {
+            field.digits = digits;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * \brief Render a value of a field by libfds
+ * \param[in]  field Field plan
+ * \param[in]  data  Field data
+ * \param[in]  iemgr Manager of Information Elements
+ * \param[out] value Rendered value (valid until the next call)
+ * \param[out] len   Length of the value
+ * \return True on success, false on failure
+ */
+bool
+JsonSerializer::value_render(Field &field, const uint8_t *data, const fds_iemgr_t *iemgr,
+    const char **value, size_t *len)
+{
+    FieldMemo *memo = nullptr;
+    if (field.memo) {
+        const uint32_t raw = (field.length == 1) ? data[0] : (uint32_t(data[0]) << 8) | data[1];
+        memo = &field.memo[(raw ^ (raw >> 8)) % MEMO_SIZE];
+        if (memo->raw == raw) {
+            *value = memo->value.data();
+            *len = memo->value.size();
+            return true;
+        }
+        memo->raw = UINT32_MAX;
+    }
+
+    struct fds_drec rec;
+    rec.data = const_cast<uint8_t *>(data);
+    rec.size = field.length;
+    rec.tmplt = field.tmplt.get();
+    rec.snap = nullptr;
+    const uint32_t flags = m_flags & ~uint32_t(FDS_CD2J_REVERSE_SKIP | FDS_CD2J_IGNORE_UNKNOWN);
+    int rc = fds_drec2json(&rec, flags, iemgr, &m_aux_buffer, &m_aux_size);
+    if (rc < 0 || size_t(rc) <= field.value_pos || m_aux_buffer[rc - 1] != '}') {
+        return false;
+    }
+
+    *value = m_aux_buffer + field.value_pos;
+    *len = size_t(rc) - field.value_pos - 1U;
+    if (memo != nullptr) {
+        memo->value.assign(*value, *len);
+        memo->raw = (field.length == 1) ? data[0] : (uint32_t(data[0]) << 8) | data[1];
+    }
+    return true;
+}
+
+/**
+ * \brief Write a quoted timestamp in ISO 8601 format with milliseconds
+ * \param[in] pos Output position
+ * \param[in] ts  Number of milliseconds since the UNIX epoch
+ * \return Position after the last written character or NULL on failure
+ */
+char *
+JsonSerializer::write_datetime(char *pos, uint64_t ts)
+{
+    const uint64_t secs = ts / 1000U;
+    const unsigned msecs = static_cast<unsigned>(ts % 1000U);
+
+    if (secs != m_ts_secs) {
+        // Records usually contain many timestamps of the same second
+        const time_t time_sec = static_cast<time_t>(secs);
+        struct tm time_tm;
+        if (gmtime_r(&time_sec, &time_tm) == nullptr) {
+            return nullptr;
+        }
+
+        size_t len = strftime(m_ts_str, sizeof(m_ts_str), "%Y-%m-%dT%H:%M:%S", &time_tm);
+        if (len == 0) {
+            return nullptr;
+        }
+        m_ts_secs = secs;
+        m_ts_len = len;
+    }
+
+    *(pos++) = '"';
+    memcpy(pos, m_ts_str, m_ts_len);
+    pos += m_ts_len;
+    *(pos++) = '.';
+    *(pos++) = static_cast<char>('0' + msecs / 100);
+    *(pos++) = static_cast<char>('0' + (msecs / 10) % 10);
+    *(pos++) = static_cast<char>('0' + msecs % 10);
+    *(pos++) = 'Z';
+    *(pos++) = '"';
+    return pos;
+}
+
+/**
+ * \brief Convert a record using a conversion plan
+ * \param[in]     plan   Conversion plan
+ * \param[in]     rec    Data Record
+ * \param[in]     iemgr  Manager of Information Elements
+ * \param[in,out] buffer Output buffer (can be NULL)
+ * \param[in,out] size   Size of the output buffer
+ * \return Length of the JSON string on success
+ * \return #FDS_ERR_NOMEM on memory allocation error
+ * \return #FDS_ERR_ARG if the record must be converted by fds_drec2json()
+ */
+int
+JsonSerializer::plan_apply(Plan &plan, const struct fds_drec *rec, const fds_iemgr_t *iemgr,
+    char **buffer, size_t *size, size_t offset)
+{
+    if (!buffer_reserve(buffer, size, offset + plan.size_max)) {
+        return FDS_ERR_NOMEM;
+    }
+
+    char *pos = *buffer + offset;
+    memcpy(pos, plan.head.data(), plan.head.size());
+    pos += plan.head.size();
+
+    for (Field &field : plan.fields) {
+        const uint8_t *data = rec->data + field.offset;
+
+        if (field.type == FieldType::LIBFDS) {
+            const char *value;
+            size_t value_len;
+            if (!value_render(field, data, iemgr, &value, &value_len)) {
+                return FDS_ERR_ARG;
+            }
+
+            const size_t used = static_cast<size_t>(pos - *buffer);
+            if (!buffer_reserve(buffer, size, plan.size_max + used + value_len)) {
+                return FDS_ERR_NOMEM;
+            }
+            pos = *buffer + used;
+            memcpy(pos, field.key.data(), field.key.size());
+            pos += field.key.size();
+            memcpy(pos, value, value_len);
+            pos += value_len;
+            continue;
+        }
+
+        memcpy(pos, field.key.data(), field.key.size());
+        pos += field.key.size();
+
+        switch (field.type) {
+        case FieldType::UINT: {
+            uint64_t value;
+            fds_get_uint_be(data, field.length, &value);
+            pos = write_uint(pos, value);
+            } break;
+        case FieldType::INT: {
+            int64_t value;
+            fds_get_int_be(data, field.length, &value);
+            pos = write_int(pos, value);
+            } break;
+        case FieldType::IPV4:
+            pos = write_ipv4(pos, data);
+            break;
+        case FieldType::IPV6:
+            *(pos++) = '"';
+            if (inet_ntop(AF_INET6, data, pos, INET6_ADDRSTRLEN) == nullptr) {
+                return FDS_ERR_ARG;
+            }
+            pos += strlen(pos);
+            *(pos++) = '"';
+            break;
+        case FieldType::TS_UNIX:
+        case FieldType::TS_ISO: {
+            uint64_t value;
+            if (fds_get_datetime_lp_be(data, field.length, field.data_type, &value) != FDS_OK) {
+                return FDS_ERR_ARG;
+            }
+            if (field.type == FieldType::TS_UNIX) {
+                pos = write_uint(pos, value);
+            } else if ((pos = write_datetime(pos, value)) == nullptr) {
+                return FDS_ERR_ARG;
+            }
+            } break;
+        case FieldType::HEX:
+            pos = write_hex(pos, data, field.length, field.digits);
+            break;
+        case FieldType::MAC:
+            pos = write_mac(pos, data, field.digits);
+            break;
+        case FieldType::LIBFDS:
+            break;
+        }
+    }
+
+    *(pos++) = '}';
+    *pos = '\0';
+    return static_cast<int>(pos - (*buffer + offset));
+}
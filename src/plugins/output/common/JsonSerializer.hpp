@@ -0,0 +1,147 @@
+/**
+ * \file src/plugins/output/common/JsonSerializer.hpp
+ * \brief Template-specialised JSON serializer (header file)
+ * \date 2026
+ */
+
+
+/* Copyright (C) 2026 CESNET, z.s.p.o.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the Company nor the names of its contributors
+ *    may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * ALTERNATIVELY, provided that this notice is retained in full, this
+ * product may be distributed under the terms of the GNU General Public
+ * License (GPL) version 2 or later, in which case the provisions
+ * of the GPL apply INSTEAD OF those given above.
+ *
+ * This software is provided ``as is'', and any express or implied
+ * warranties, including, but not limited to, the implied warranties of
+ * merchantability and fitness for a particular purpose are disclaimed.
+ * In no event shall the company or contributors be liable for any
+ * direct, indirect, incidental, special, exemplary, or consequential
+ * damages (including, but not limited to, procurement of substitute
+ * goods or services; loss of use, data, or profits; or business
+ * interruption) however caused and on any theory of liability, whether
+ * in contract, strict liability, or tort (including negligence or
+ * otherwise) arising in any way out of the use of this software, even
+ * if advised of the possibility of such damage.
+ *
+ */
+
+#ifndef JSON_SERIALIZER_H
+#define JSON_SERIALIZER_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <libfds.h>
+
+/**
+ * \brief Template-specialised converter of IPFIX Data Records to JSON
+ *
+ * The converter produces exactly the same output as fds_drec2json(). However, on the first
+ * occurrence of a template, it compiles a conversion plan with pre-rendered "key": fragments
+ * and a specialised formatter for each field. Records based on the template are later
+ * converted without any lookups of Information Element definitions or formatting flags.
+ *
+ * Integers, IP addresses, timestamps, fixed-length octet arrays and MAC addresses are
+ * formatted directly (formatting of octet arrays and MAC addresses is verified against libfds
+ * using a probe value). Values of other fields (e.g. strings, formatted protocols and TCP
+ * flags) are rendered by libfds and values of short fields are memorised. Templates with dynamic fields or multiple occurrences
+ * of the same Information Element are converted only by fds_drec2json(). Each new plan is
+ * checked against fds_drec2json() on the first record and if the outputs differ, the
+ * template is also converted only by fds_drec2json().
+ */
+class JsonSerializer {
+public:
+    /**
+     * \brief Constructor
+     * \param[in] flags Conversion flags of fds_drec2json() (FDS_CD2J_*, the reverse flag is
+     *   ignored)
+     */
+    explicit JsonSerializer(uint32_t flags);
+    /** Destructor */
+    ~JsonSerializer();
+    // Disable copy constructors
+    JsonSerializer(const JsonSerializer &) = delete;
+    JsonSerializer &operator=(const JsonSerializer &) = delete;
+
+    /**
+     * \brief Convert an IPFIX Data Record to a JSON string
+     *
+     * Behaves as fds_drec2json() with automatic reallocation of the output buffer. The string
+     * is written at the \p offset of the buffer and the preceding content (e.g. previously
+     * converted records) is preserved, even if the buffer is reallocated.
+     * \param[in]     rec     Data Record to convert
+     * \param[in]     reverse Convert from reverse point of view (affects only biflow records)
+     * \param[in]     iemgr   Manager of Information Elements (can be NULL)
+     * \param[in,out] buffer  Output buffer (can be NULL, only if \p offset is zero)
+     * \param[in,out] size    Size of the output buffer
+     * \param[in]     offset  Position of the JSON string in the buffer (at most \p size)
+     * \return Length of the JSON string (excluding the terminating null byte) on success
+     * \return Negative value (FDS_ERR_*) on failure
+     */
+    int
+    convert(const struct fds_drec *rec, bool reverse, const fds_iemgr_t *iemgr, char **buffer,
+        size_t *size, size_t offset = 0);
+
+private:
+    struct Field;
+    struct Plan;
+
+    /** Maximum number of cached conversion plans                                                */
+    static constexpr size_t PLANS_MAX = 4096;
+
+    /** Conversion flags of fds_drec2json() (without the reverse flag)                           */
+    uint32_t m_flags;
+    /** Manager of Information Elements used by the compiled plans                              */
+    const fds_iemgr_t *m_iemgr = nullptr;
+    /** Compiled plans (key: template pointer + reverse flag)                                    */
+    std::unordered_map<uintptr_t, std::unique_ptr<Plan>> m_plans;
+    /** The most recently used plan (can be NULL)                                               */
+    Plan *m_last = nullptr;
+
+    /** Auxiliary buffer for fds_drec2json()                                                     */
+    char *m_aux_buffer = nullptr;
+    /** Size of the auxiliary buffer                                                             */
+    size_t m_aux_size = 0;
+
+    /** Seconds since the UNIX epoch of the last formatted timestamp                            */
+    uint64_t m_ts_secs = UINT64_MAX;
+    /** Date and time part of the last formatted timestamp (e.g. "2018-05-11T19:44:29")         */
+    char m_ts_str[32];
+    /** Length of the date and time part                                                         */
+    size_t m_ts_len = 0;
+
+    Plan *
+    plan_get(const struct fds_drec *rec, bool reverse, const fds_iemgr_t *iemgr);
+    std::unique_ptr<Plan>
+    plan_compile(const struct fds_drec *rec, bool reverse, const fds_iemgr_t *iemgr);
+    bool
+    field_prepare(Field &field, const struct fds_drec_field &data, const fds_iemgr_t *iemgr);
+    bool
+    field_probe(Field &field, const fds_iemgr_t *iemgr);
+    int
+    plan_apply(Plan &plan, const struct fds_drec *rec, const fds_iemgr_t *iemgr, char **buffer,
+        size_t *size, size_t offset);
+    bool
+    value_render(Field &field, const uint8_t *data, const fds_iemgr_t *iemgr, const char **value,
+        size_t *len);
+    char *
+    write_datetime(char *pos, uint64_t ts);
+};
+
+#endif // JSON_SERIALIZER_H
@@ -86,6 +86,8 @@ Storage::Storage(const ipx_ctx_t *ctx, const struct cfg_format &fmt)
     if (!m_format.octets_as_uint) {
         m_flags |= FDS_CD2J_OCTETS_NOINT;
     }
+
+    m_serializer.reset(new JsonSerializer(m_flags));
 }
 
 Storage::~Storage()
@@ -425,10 +427,7 @@ void
 Storage::convert(struct fds_drec &rec, const fds_iemgr_t *iemgr, fds_ipfix_msg_hdr *hdr, bool reverse)
 {
     // Convert the record
-    uint32_t flags = m_flags;
-    flags |= reverse ? FDS_CD2J_BIFLOW_REVERSE : 0;
-
-    int rc = fds_drec2json(&rec, flags, iemgr, &m_record.buffer, &m_record.size_alloc);
+    int rc = m_serializer->convert(&rec, reverse, iemgr, &m_record.buffer, &m_record.size_alloc);
     if (rc < 0) {
         throw std::runtime_error("Conversion to JSON failed (probably a memory allocation error)!");
     }
@@ -42,11 +42,13 @@
 #ifndef JSON_STORAGE_H
 #define JSON_STORAGE_H
 
+#include <memory>
 #include <string>
 #include <vector>
 #include <arpa/inet.h>
 #include <ipfixcol2.h>
 #include "Config.hpp"
+#include "JsonSerializer.hpp"
 
 /** Base class                                                                                   */
 class Output {
@@ -94,6 +96,8 @@ private:
     struct cfg_format m_format;
     /** Conversion flags for libfds converter                                                    */
     uint32_t m_flags;
+    /** Template-specialised converter of Data Records                                          */
+    std::unique_ptr<JsonSerializer> m_serializer;
     /** IPv4/IPv6 exporter address of the current message (can be nullptr)                       */
     const char *m_src_addr = nullptr;
 
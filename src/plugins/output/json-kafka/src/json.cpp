@@ -58,7 +58,7 @@ IPX_API struct ipx_plugin_info ipx_plugin_info = {
     // Configuration flags (reserved for future use)
     IPX_PF_DEEPBIND,
     // Plugin version string (like "1.2.3")
-    "2.2.0",
+    "2.3.0",
     // Minimal IPFIXcol version string (like "1.2.3")
     "2.2.0"
 };
@@ -245,6 +245,20 @@ File::process(const char *str, size_t len)
     return IPX_OK;
 }
 
+/**
+ * \brief Store a batch of records to a file
+ *
+ * All records are written at once, i.e. the lock is acquired only once per batch.
+ * \param[in] batch Records to store
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_DENIED in case of a fatal error (the output cannot continue)
+ */
+int
+File::process_batch(const struct OutputBatch &batch)
+{
+    return process(batch.data, batch.size);
+}
+
 void
 File::flush()
 {
@@ -61,6 +61,8 @@ public:
 
     // Store a record to the file
     int process(const char *str, size_t len);
+    // Store a batch of records to the file
+    int process_batch(const struct OutputBatch &batch);
 
     void flush();
 private:
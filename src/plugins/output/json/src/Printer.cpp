@@ -55,3 +55,10 @@ Printer::process(const char *str, size_t len)
     printf("%s", temp.c_str());
     return IPX_OK;
 }
+
+int
+Printer::process_batch(const struct OutputBatch &batch)
+{
+    fwrite(batch.data, 1, batch.size, stdout);
+    return IPX_OK;
+}
@@ -63,6 +63,14 @@ public:
      * \return #IPX_ERR_DENIED in case of fatal failure
      */
     int process(const char *str, size_t len);
+
+    /**
+     * \brief Print a batch of records on standard output
+     * \param[in] batch Records to print
+     * \return #IPX_OK on success
+     * \return #IPX_ERR_DENIED in case of fatal failure
+     */
+    int process_batch(const struct OutputBatch &batch);
 };
 
 #endif // JSON_PRINTER_H
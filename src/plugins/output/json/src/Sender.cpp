@@ -53,6 +53,8 @@
 #define INVALID_FD (-1)
 /** Delay between reconnection attempts (seconds)  */
 #define RECONN_DELAY (5)
+/** Maximum size of a UDP datagram with multiple records (fits into common MTU) */
+#define DGRAM_SIZE   (1400)
 
 /**
  * \brief Class constructor
@@ -85,6 +87,29 @@ Sender::~Sender()
  */
 int
 Sender::process(const char *str, size_t len)
+{
+    struct iovec rec;
+    rec.iov_base = const_cast<char *>(str);
+    rec.iov_len = len;
+
+    struct OutputBatch batch;
+    batch.data = str;
+    batch.size = len;
+    batch.recs = &rec;
+    batch.cnt = 1;
+    return process_batch(batch);
+}
+
+/**
+ * \brief Send a batch of JSON records
+ *
+ * Over TCP, all records are sent by a single call of send(). Over UDP, records are packed
+ * into datagrams up to #DGRAM_SIZE bytes and all datagrams are sent by sendmmsg().
+ * \param[in] batch Records to send
+ * \return Always #IPX_OK
+ */
+int
+Sender::process_batch(const struct OutputBatch &batch)
 {
     if (sd == INVALID_FD) {
         // Not connected -> try to reconnect
@@ -107,8 +132,17 @@ Sender::process(const char *str, size_t len)
         }
     }
 
-    // Send not previously send data (only for non-blocking mode)
     enum Send_status status;
+    if (params.proto == cfg_send::SEND_PROTO_UDP) {
+        // Datagrams are never sent partly
+        if (send_datagrams(batch) == SEND_FAILED) {
+            close(sd);
+            sd = INVALID_FD;
+        }
+        return IPX_OK;
+    }
+
+    // Send not previously send data (only for non-blocking mode)
     if (!params.blocking && !msg_rest.empty()) {
         status = send(msg_rest.c_str(), msg_rest.size());
         switch (status) {
@@ -126,7 +160,7 @@ Sender::process(const char *str, size_t len)
     }
 
     // Send new data
-    status = send(str, len);
+    status = send(batch.data, batch.size);
     switch (status) {
     case SEND_OK:
     case SEND_WOULDBLOCK:
@@ -257,4 +291,66 @@ Sender::send(const char *str, size_t len)
     std::string tmp(ptr, todo);
     msg_rest.assign(tmp);
     return SEND_WOULDBLOCK;
-}
\ No newline at end of file
+}
+
+/**
+ * \brief Send JSON records over UDP
+ *
+ * Consecutive records are packed into datagrams up to #DGRAM_SIZE bytes (a larger record
+ * is sent in its own datagram) and all datagrams are passed to the kernel by sendmmsg().
+ * In non-blocking mode, datagrams that cannot be sent immediately are dropped.
+ * \param[in] batch Records to send
+ * \return #SEND_OK on success
+ * \return #SEND_WOULDBLOCK if some datagrams were dropped
+ * \return #SEND_FAILED in case of broken connection
+ */
+enum Sender::Send_status
+Sender::send_datagrams(const struct OutputBatch &batch)
+{
+    // Records are stored one after another, therefore, each datagram is a contiguous block
+    dgram_data.clear();
+    for (size_t i = 0; i < batch.cnt; ) {
+        struct iovec dgram = batch.recs[i++];
+        while (i < batch.cnt && dgram.iov_len + batch.recs[i].iov_len <= DGRAM_SIZE) {
+            dgram.iov_len += batch.recs[i++].iov_len;
+        }
+        dgram_data.push_back(dgram);
+    }
+
+    dgram_hdrs.resize(dgram_data.size());
+    for (size_t i = 0; i < dgram_data.size(); ++i) {
+        memset(&dgram_hdrs[i], 0, sizeof(dgram_hdrs[i]));
+        dgram_hdrs[i].msg_hdr.msg_iov = &dgram_data[i];
+        dgram_hdrs[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    int flags = MSG_NOSIGNAL;
+    if (!params.blocking) {
+        flags |= MSG_DONTWAIT;
+    }
+
+    size_t sent = 0;
+    while (sent < dgram_hdrs.size()) {
+        int now = sendmmsg(sd, &dgram_hdrs[sent], dgram_hdrs.size() - sent, flags);
+        if (now == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (!params.blocking && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                // Non-blocking mode
+                return SEND_WOULDBLOCK;
+            }
+
+            // Connection failed
+            char buffer[128];
+            const char *err_str = strerror_r(errno, buffer, 128);
+            IPX_CTX_INFO(_ctx, "(Send output) Destination '%s:%" PRIu16 "' disconnected: %s",
+                params.addr.c_str(), params.port, err_str);
+            return SEND_FAILED;
+        }
+
+        sent += static_cast<size_t>(now);
+    }
+
+    return SEND_OK;
+}
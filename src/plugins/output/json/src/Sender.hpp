@@ -42,6 +42,8 @@
 #ifndef JSON_SENDER_H
 #define JSON_SENDER_H
 
+#include <vector>
+#include <sys/socket.h>
 #include "Storage.hpp"
 
 /** JSON sender (over TCP or UDP)                                                 */
@@ -54,6 +56,8 @@ public:
 
     // Processing records
     int process(const char *str, size_t len);
+    // Processing a batch of records
+    int process_batch(const struct OutputBatch &batch);
 
 private:
     /** Transmission status */
@@ -71,9 +75,14 @@ private:
     struct cfg_send params;
     /** Time of the last connection attempt                                       */
     struct timespec connection_time;
+    /** Datagrams to send (only for UDP)                                          */
+    std::vector<struct iovec> dgram_data;
+    /** Headers of the datagrams to send (only for UDP)                           */
+    std::vector<struct mmsghdr> dgram_hdrs;
 
     int connect();
     enum Send_status send(const char *str, size_t len);
+    enum Send_status send_datagrams(const struct OutputBatch &batch);
 };
 
 #endif // JSON_SENDER_H
@@ -310,8 +310,29 @@ Server::msg_send(const char *data, ssize_t len, client_t &client)
  */
 int Server::process(const char *str, size_t len)
 {
-    const char *data = str;
-    ssize_t length = len;
+    struct iovec rec;
+    rec.iov_base = const_cast<char *>(str);
+    rec.iov_len = len;
+
+    struct OutputBatch batch;
+    batch.data = str;
+    batch.size = len;
+    batch.recs = &rec;
+    batch.cnt = 1;
+    return process_batch(batch);
+}
+
+/**
+ * \brief Send a batch of records to all connected clients
+ *
+ * All records are sent to each client by a single call of send().
+ * \param[in] batch JSON Records
+ * \return Always #IPX_OK
+ */
+int Server::process_batch(const struct OutputBatch &batch)
+{
+    const char *data = batch.data;
+    ssize_t length = batch.size;
 
     // Are there new clients?
     if (_acceptor->new_clients_ready) {
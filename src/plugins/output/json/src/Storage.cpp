@@ -51,6 +51,8 @@ using namespace std;
 #define BUFFER_BASE   4096
 /** Size of local conversion buffers (for snprintf)    */
 #define LOCAL_BSIZE   64
+/** Size of a batch to pass to outputs before the end of an IPFIX Message */
+#define BATCH_SIZE    (1024 * 1024)
 
 Storage::Storage(const ipx_ctx_t *ctx, const struct cfg_format &fmt)
     : m_ctx(ctx), m_format(fmt)
@@ -59,6 +61,7 @@ Storage::Storage(const ipx_ctx_t *ctx, const struct cfg_format &fmt)
     m_record.buffer = nullptr;
     m_record.size_used = 0;
     m_record.size_alloc = 0;
+    m_record.rec_start = 0;
 
     // Prepare conversion flags
     m_flags = FDS_CD2J_ALLOW_REALLOC; // Allow automatic reallocation of the buffer
@@ -86,6 +89,8 @@ Storage::Storage(const ipx_ctx_t *ctx, const struct cfg_format &fmt)
     if (!m_format.octets_as_uint) {
         m_flags |= FDS_CD2J_OCTETS_NOINT;
     }
+
+    m_serializer.reset(new JsonSerializer(m_flags));
 }
 
 Storage::~Storage()
@@ -114,8 +119,11 @@ Storage::buffer_reserve(size_t n)
         return;
     }
 
-    // Prepare a new buffer and copy the content
-    const size_t new_size = ((n / BUFFER_BASE) + 1) * BUFFER_BASE;
+    // Prepare a new buffer and copy the content (the whole batch is stored in the buffer)
+    size_t new_size = ((n / BUFFER_BASE) + 1) * BUFFER_BASE;
+    if (new_size < 2 * buffer_alloc()) {
+        new_size = 2 * buffer_alloc();
+    }
     char *new_buffer = (char *) realloc(m_record.buffer, new_size * sizeof(char));
     if (!new_buffer) {
         throw std::bad_alloc();
@@ -142,6 +150,78 @@ Storage::buffer_append(const char *str)
     m_record.size_used += len - 1;
 }
 
+/**
+ * \brief Add the converted record to the batch of records
+ *
+ * The record has been converted directly behind the previous records of the batch, so only
+ * its length is stored. If the batch is too large, it is immediately passed to all outputs.
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_DENIED if an output fails to store the records
+ * \throws bad_alloc in case of a memory allocation error
+ */
+int
+Storage::batch_add()
+{
+    m_batch_lens.push_back(buffer_used() - m_record.rec_start);
+    m_record.rec_start = buffer_used();
+
+    if (buffer_used() < BATCH_SIZE) {
+        return IPX_OK;
+    }
+
+    return batch_flush();
+}
+
+/**
+ * \brief Pass the batch of records to all outputs and clear it
+ * \return #IPX_OK on success
+ * \return #IPX_ERR_DENIED if an output fails to store the records
+ */
+int
+Storage::batch_flush()
+{
+    if (m_batch_lens.empty()) {
+        return IPX_OK;
+    }
+
+    // The buffer could have been reallocated, so the descriptions are prepared only now
+    m_batch_recs.resize(m_batch_lens.size());
+    char *pos = m_record.buffer;
+    for (size_t i = 0; i < m_batch_lens.size(); ++i) {
+        m_batch_recs[i].iov_base = pos;
+        m_batch_recs[i].iov_len = m_batch_lens[i];
+        pos += m_batch_lens[i];
+    }
+
+    struct OutputBatch batch;
+    batch.data = m_record.buffer;
+    batch.size = m_record.rec_start;
+    batch.recs = m_batch_recs.data();
+    batch.cnt = m_batch_recs.size();
+
+    int ret = IPX_OK;
+    for (Output *output : m_outputs) {
+        if (output->process_batch(batch) != IPX_OK) {
+            ret = IPX_ERR_DENIED;
+            break;
+        }
+    }
+
+    batch_clear();
+    return ret;
+}
+
+/**
+ * \brief Remove all records from the batch (without passing them to outputs)
+ */
+void
+Storage::batch_clear()
+{
+    m_batch_lens.clear();
+    m_record.size_used = 0;
+    m_record.rec_start = 0;
+}
+
 void
 Storage::output_add(Output *output)
 {
@@ -276,17 +356,15 @@ Storage::convert_tset(struct ipx_ipfix_set *set, const struct fds_ipfix_msg_hdr
 
     // Iteration through all (Options) Templates in the Set
     while (fds_tset_iter_next(&tset_iter) == FDS_OK) {
-        // Buffer is empty
-        m_record.size_used = 0;
+        // Start a new record behind the previous ones
+        m_record.size_used = m_record.rec_start;
 
         // Read and print single template
         convert_tmplt_rec(&tset_iter, set_id, hdr);
 
         // Store it
-        for (Output *output : m_outputs) {
-            if (output->process(m_record.buffer, m_record.size_used) != IPX_OK) {
-                return IPX_ERR_DENIED;
-            }
+        if (batch_add() != IPX_OK) {
+            return IPX_ERR_DENIED;
         }
     }
 
@@ -301,6 +379,9 @@ Storage::records_store(ipx_msg_ipfix_t *msg, const fds_iemgr_t *iemgr)
     bool flush = false;
     int ret = IPX_OK;
 
+    // Drop records left by a previous message whose conversion failed (an exception)
+    batch_clear();
+
     // Extract IPv4/IPv6 address of the exporter, if required
     m_src_addr = nullptr;
     char src_addr[INET6_ADDRSTRLEN];
@@ -347,11 +428,9 @@ Storage::records_store(ipx_msg_ipfix_t *msg, const fds_iemgr_t *iemgr)
         convert(ipfix_rec->rec, iemgr, hdr, false);
 
         // Store it
-        for (Output *output : m_outputs) {
-            if (output->process(m_record.buffer, m_record.size_used) != IPX_OK) {
-                ret = IPX_ERR_DENIED;
-                goto endloop;
-            }
+        if (batch_add() != IPX_OK) {
+            ret = IPX_ERR_DENIED;
+            goto endloop;
         }
 
         if (!m_format.split_biflow || (ipfix_rec->rec.tmplt->flags & FDS_TEMPLATE_BIFLOW) == 0) {
@@ -363,15 +442,20 @@ Storage::records_store(ipx_msg_ipfix_t *msg, const fds_iemgr_t *iemgr)
         convert(ipfix_rec->rec, iemgr, hdr, true);
 
         // Store it
-        for (Output *output : m_outputs) {
-            if (output->process(m_record.buffer, m_record.size_used) != IPX_OK) {
-                ret = IPX_ERR_DENIED;
-                goto endloop;
-            }
+        if (batch_add() != IPX_OK) {
+            ret = IPX_ERR_DENIED;
+            goto endloop;
         }
     }
 
 endloop:
+    // Pass the remaining records to the outputs (all at once)
+    if (ret == IPX_OK) {
+        ret = batch_flush();
+    } else {
+        batch_clear();
+    }
+
     if (flush) {
         for (Output *output : m_outputs) {
             output->flush();
@@ -425,15 +509,14 @@ void
 Storage::convert(struct fds_drec &rec, const fds_iemgr_t *iemgr, fds_ipfix_msg_hdr *hdr, bool reverse)
 {
     // Convert the record
-    uint32_t flags = m_flags;
-    flags |= reverse ? FDS_CD2J_BIFLOW_REVERSE : 0;
-
-    int rc = fds_drec2json(&rec, flags, iemgr, &m_record.buffer, &m_record.size_alloc);
+    // The record is converted directly into the batch, behind the previous records
+    int rc = m_serializer->convert(&rec, reverse, iemgr, &m_record.buffer, &m_record.size_alloc,
+        m_record.rec_start);
     if (rc < 0) {
         throw std::runtime_error("Conversion to JSON failed (probably a memory allocation error)!");
     }
 
-    m_record.size_used = size_t(rc);
+    m_record.size_used = m_record.rec_start + size_t(rc);
 
     if (m_format.detailed_info) {
         // Remove '}' parenthesis at the end of the record
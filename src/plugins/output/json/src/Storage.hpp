@@ -42,11 +42,26 @@
 #ifndef JSON_STORAGE_H
 #define JSON_STORAGE_H
 
+#include <memory>
 #include <string>
 #include <vector>
 #include <arpa/inet.h>
+#include <sys/uio.h>
 #include <ipfixcol2.h>
 #include "Config.hpp"
+#include "JsonSerializer.hpp"
+
+/** Batch of converted JSON records                                                              */
+struct OutputBatch {
+    /** All records stored one after another                                                     */
+    const char *data;
+    /** Total size of all records                                                                */
+    size_t size;
+    /** Individual records (each one points into the data)                                       */
+    const struct iovec *recs;
+    /** Number of records                                                                        */
+    size_t cnt;
+};
 
 /** Base class                                                                                   */
 class Output {
@@ -76,6 +91,27 @@ public:
     virtual int
     process(const char *str, size_t len) = 0;
 
+    /**
+     * \brief Process a batch of converted JSON records
+     *
+     * By default, records are passed one by one to process(). Outputs that are able to write
+     * the whole batch at once should override it.
+     * \param[in] batch Records to process
+     * \return #IPX_OK on success
+     * \return #IPX_ERR_DENIED in case of a fatal error (the output cannot continue)
+     */
+    virtual int
+    process_batch(const struct OutputBatch &batch)
+    {
+        for (size_t i = 0; i < batch.cnt; ++i) {
+            const struct iovec &rec = batch.recs[i];
+            if (process(static_cast<const char *>(rec.iov_base), rec.iov_len) != IPX_OK) {
+                return IPX_ERR_DENIED;
+            }
+        }
+        return IPX_OK;
+    };
+
     /**
      * \brief Flush buffered records
      */
@@ -94,6 +130,8 @@ private:
     struct cfg_format m_format;
     /** Conversion flags for libfds converter                                                    */
     uint32_t m_flags;
+    /** Template-specialised converter of Data Records                                          */
+    std::unique_ptr<JsonSerializer> m_serializer;
     /** IPv4/IPv6 exporter address of the current message (can be nullptr)                       */
     const char *m_src_addr = nullptr;
 
@@ -101,7 +139,13 @@ private:
         char *buffer;
         size_t size_alloc;
         size_t size_used;
-    } m_record; /**< Converted JSON record                                                       */
+        size_t rec_start;
+    } m_record; /**< Batch of records waiting for outputs and the record being converted        */
+
+    /** Lengths of the records waiting to be passed to outputs (stored one after another)       */
+    std::vector<size_t> m_batch_lens;
+    /** Description of the records passed to outputs                                            */
+    std::vector<struct iovec> m_batch_recs;
 
     // Convert an IPFIX record to a JSON string
     void convert(struct fds_drec &rec, const fds_iemgr_t *iemgr, struct fds_ipfix_msg_hdr *hdr, bool reverse = false);
@@ -116,6 +160,12 @@ private:
     void buffer_append(const char *str);
     // Reserve memory for a JSON string
     void buffer_reserve(size_t n);
+    // Add the converted record to the batch
+    int batch_add();
+    // Pass the batch to all outputs
+    int batch_flush();
+    // Remove all records from the batch
+    void batch_clear();
     // Convert set to JSON string
     int convert_tset(struct ipx_ipfix_set *set, const struct fds_ipfix_msg_hdr *hdr);
     // Convert template record to a JSON string
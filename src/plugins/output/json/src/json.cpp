@@ -62,7 +62,7 @@ IPX_API struct ipx_plugin_info ipx_plugin_info = {
     // Configuration flags (reserved for future use)
     0,
     // Plugin version string (like "1.2.3")
-    "2.2.0",
+    "2.4.0",
     // Minimal IPFIXcol version string (like "1.2.3")
     "2.1.0"
 };
@@ -64,7 +64,7 @@ IPX_API struct ipx_plugin_info ipx_plugin_info = {
     // Configuration flags (reserved for future use)
     .flags = 0,
     // Plugin version string (like "1.2.3")
-    .version = "2.0.0",
+    .version = "2.1.0",
     // Minimal IPFIXcol version string (like "1.2.3")
     .ipx_min = "2.0.0"
 };
@@ -75,6 +75,8 @@ struct instance_data {
     struct instance_config *config;
     /** Current time (seconds since the Epoch) */
     uint64_t ts_now;
+    /** Locators of timestamp fields           */
+    ipx_floc_t *floc;
 
     /** Context reference (only for log!)      */
     ipx_ctx_t *ctx;
@@ -85,6 +87,26 @@ static void
 timestamp_check(const struct instance_data *inst, ipx_msg_ipfix_t *msg,
     const struct fds_drec_field *field);
 
+/**
+ * \brief Check if a template field is a timestamp to check
+ * \param[in] field Template field
+ * \param[in] data  Unused
+ * \return True or false
+ */
+static bool
+timestamp_match(const struct fds_tfield *field, void *data)
+{
+    (void) data;
+
+    if (field->en != PEN_IANA && field->en != PEN_IANA_REV) {
+        // We don't check non-standard fields
+        return false;
+    }
+
+    // We want to check only IE elements within the range 150 - 157
+    return field->id >= 150U && field->id <= 157U;
+}
+
 int
 ipx_plugin_init(ipx_ctx_t *ctx, const char *params)
 {
@@ -99,6 +121,14 @@ ipx_plugin_init(ipx_ctx_t *ctx, const char *params)
         return IPX_ERR_DENIED;
     }
 
+    data->floc = ipx_floc_create(&timestamp_match, NULL);
+    if (!data->floc) {
+        IPX_CTX_ERROR(ctx, "Memory allocation error (%s:%d)", __FILE__, __LINE__);
+        config_destroy(data->config);
+        free(data);
+        return IPX_ERR_DENIED;
+    }
+
     data->ctx = ctx;
     ipx_ctx_private_set(ctx, data);
     return IPX_OK;
@@ -110,6 +140,7 @@ ipx_plugin_destroy(ipx_ctx_t *ctx, void *cfg)
     (void) ctx; // Suppress warnings
 
     struct instance_data *data = (struct instance_data *) cfg;
+    ipx_floc_destroy(data->floc);
     config_destroy(data->config);
     free(data);
 }
@@ -127,23 +158,29 @@ ipx_plugin_process(ipx_ctx_t *ctx, void *cfg, ipx_msg_t *msg)
     // For each Data Record in the message
     uint32_t rec_cnt = ipx_msg_ipfix_get_drec_cnt(ipfix_msg);
     for (uint32_t i = 0; i < rec_cnt; ++i) {
-        // For each field in the Data Record
         struct ipx_ipfix_record *rec = ipx_msg_ipfix_get_drec(ipfix_msg, i);
-        struct fds_drec_iter it;
-
-        fds_drec_iter_init(&it, &rec->rec, 0);
-        while (fds_drec_iter_next(&it) != FDS_EOC) {
-            // Is it a timestamp?
-            const uint16_t field_id = it.field.info->id;
-            const uint32_t field_en = it.field.info->en;
+        struct fds_drec *drec = &rec->rec;
 
-            if (field_en != PEN_IANA && field_en != PEN_IANA_REV) {
-                // We don't check non-standard fields
-                continue;
+        // Jump directly to timestamps with a fixed position in the Data Record
+        const struct ipx_floc_field *locs;
+        uint16_t loc_cnt;
+        if (ipx_floc_get(data->floc, drec->tmplt, &locs, &loc_cnt) == IPX_OK) {
+            for (uint16_t idx = 0; idx < loc_cnt; ++idx) {
+                struct fds_drec_field field;
+                field.data = drec->data + locs[idx].offset;
+                field.size = locs[idx].length;
+                field.info = locs[idx].info;
+                timestamp_check(data, ipfix_msg, &field);
             }
+            continue;
+        }
 
-            if (field_id < 150U || field_id > 157U) {
-                // We want to check only IE elements within the range 150 - 157
+        // Otherwise, for each field in the Data Record
+        struct fds_drec_iter it;
+        fds_drec_iter_init(&it, drec, 0);
+        while (fds_drec_iter_next(&it) != FDS_EOC) {
+            // Is it a timestamp?
+            if (!timestamp_match(it.field.info, NULL)) {
                 continue;
             }
 
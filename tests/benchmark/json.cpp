@@ -0,0 +1,214 @@
+/**
+ * \file tests/benchmark/json.cpp
+ * \brief Benchmark of the template-specialised JSON serializer against fds_drec2json()
+ *
+ * Usage: bench_json [records] [rounds]
+ */
+
+#include <chrono>
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <libfds.h>
+
+#include "JsonSerializer.hpp"
+
+using bench_clock = std::chrono::steady_clock;
+
+/** Definition of a template field: Enterprise Number, Information Element ID and length */
+struct field_def {
+    uint32_t en;
+    uint16_t id;
+    uint16_t len;
+};
+
+/** Fields of an IPv4 flow record (see the example in the JSON plugin documentation) */
+static const std::vector<field_def> fields_ipv4 = {
+    {0, 1, 8}, {0, 2, 8}, {0, 152, 8}, {0, 153, 8}, {0, 10, 4}, {0, 60, 1}, {0, 8, 4},
+    {0, 12, 4}, {0, 5, 1}, {0, 192, 1}, {0, 4, 1}, {0, 6, 2}, {0, 7, 2}, {0, 11, 2},
+    {0, 14, 4}, {0, 34, 4}, {0, 35, 1}
+};
+
+/** Fields of an IPv6 flow record */
+static const std::vector<field_def> fields_ipv6 = {
+    {0, 1, 8}, {0, 2, 8}, {0, 152, 8}, {0, 153, 8}, {0, 27, 16}, {0, 28, 16}, {0, 4, 1},
+    {0, 6, 1}, {0, 7, 2}, {0, 11, 2}, {0, 136, 1}
+};
+
+/**
+ * \brief Create a template
+ * \param[in] id     Template ID
+ * \param[in] fields Template fields
+ * \param[in] iemgr  Manager of Information Elements
+ * \return Pointer to the template
+ */
+static struct fds_template *
+template_create(uint16_t id, const std::vector<field_def> &fields, const fds_iemgr_t *iemgr)
+{
+    std::vector<uint16_t> raw = {htons(id), htons(static_cast<uint16_t>(fields.size()))};
+    for (const auto &field : fields) {
+        raw.push_back(htons(field.id | ((field.en != 0) ? 0x8000 : 0)));
+        raw.push_back(htons(field.len));
+        if (field.en != 0) {
+            raw.push_back(htons(static_cast<uint16_t>(field.en >> 16)));
+            raw.push_back(htons(static_cast<uint16_t>(field.en & 0xFFFF)));
+        }
+    }
+
+    struct fds_template *tmplt;
+    uint16_t len = static_cast<uint16_t>(raw.size() * sizeof(uint16_t));
+    if (fds_template_parse(FDS_TYPE_TEMPLATE, raw.data(), &len, &tmplt) != FDS_OK
+            || fds_template_ies_define(tmplt, iemgr, false) != FDS_OK) {
+        fprintf(stderr, "Failed to create a template!\n");
+        exit(EXIT_FAILURE);
+    }
+
+    return tmplt;
+}
+
+/**
+ * \brief Generate pseudo-random records
+ * \param[in] tmplt Template of the records
+ * \param[in] cnt   Number of records
+ * \return Data of the records (each record has size of tmplt->data_length)
+ */
+static std::vector<uint8_t>
+records_generate(const struct fds_template *tmplt, uint32_t cnt)
+{
+    std::vector<uint8_t> data(size_t(tmplt->data_length) * cnt);
+    for (auto &byte : data) {
+        byte = static_cast<uint8_t>(rand());
+    }
+
+    // Use realistic timestamps
+    for (uint32_t i = 0; i < cnt; ++i) {
+        uint8_t *rec = &data[size_t(tmplt->data_length) * i];
+        for (uint16_t f = 0; f < tmplt->fields_cnt_total; ++f) {
+            const struct fds_tfield *field = &tmplt->fields[f];
+            if (field->en != 0 || (field->id != 152 && field->id != 153)) {
+                continue;
+            }
+            uint64_t ts = 1526067869006ULL + i * 10U + field->id;
+            for (int b = 7; b >= 0; --b, ts >>= 8) {
+                rec[field->offset + b] = static_cast<uint8_t>(ts & 0xFF);
+            }
+        }
+    }
+
+    return data;
+}
+
+/**
+ * \brief Measure conversion of records
+ * \param[in] name   Name of the measurement
+ * \param[in] tmplt  Template of the records
+ * \param[in] data   Data of the records
+ * \param[in] flags  Conversion flags
+ * \param[in] iemgr  Manager of Information Elements
+ * \param[in] rounds Number of rounds
+ */
+static void
+measure(const char *name, const struct fds_template *tmplt, std::vector<uint8_t> &data,
+    uint32_t flags, const fds_iemgr_t *iemgr, uint32_t rounds)
+{
+    const uint32_t cnt = static_cast<uint32_t>(data.size() / tmplt->data_length);
+    JsonSerializer serializer(flags);
+    char *buffer_ref = nullptr;
+    char *buffer_new = nullptr;
+    size_t size_ref = 0;
+    size_t size_new = 0;
+
+    struct fds_drec rec;
+    rec.size = tmplt->data_length;
+    rec.tmplt = tmplt;
+    rec.snap = nullptr;
+
+    // Check that both outputs are the same
+    for (uint32_t i = 0; i < cnt; ++i) {
+        rec.data = &data[size_t(tmplt->data_length) * i];
+        int rc_ref = fds_drec2json(&rec, flags, iemgr, &buffer_ref, &size_ref);
+        int rc_new = serializer.convert(&rec, false, iemgr, &buffer_new, &size_new);
+        if (rc_ref < 0 || rc_ref != rc_new || memcmp(buffer_ref, buffer_new, rc_ref) != 0) {
+            fprintf(stderr, "Outputs differ!\nfds_drec2json: %s\nSerializer:    %s\n",
+                buffer_ref, buffer_new);
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    const uint64_t ops = uint64_t(cnt) * rounds;
+    auto start = bench_clock::now();
+    for (uint32_t r = 0; r < rounds; ++r) {
+        for (uint32_t i = 0; i < cnt; ++i) {
+            rec.data = &data[size_t(tmplt->data_length) * i];
+            fds_drec2json(&rec, flags, iemgr, &buffer_ref, &size_ref);
+        }
+    }
+    std::chrono::duration<double, std::nano> time_ref = bench_clock::now() - start;
+
+    start = bench_clock::now();
+    for (uint32_t r = 0; r < rounds; ++r) {
+        for (uint32_t i = 0; i < cnt; ++i) {
+            rec.data = &data[size_t(tmplt->data_length) * i];
+            serializer.convert(&rec, false, iemgr, &buffer_new, &size_new);
+        }
+    }
+    std::chrono::duration<double, std::nano> time_new = bench_clock::now() - start;
+
+    printf("%-28s %12" PRIu64 " %16.1f %16.1f %8.2fx\n", name, ops, time_ref.count() / ops,
+        time_new.count() / ops, time_ref.count() / time_new.count());
+    free(buffer_ref);
+    free(buffer_new);
+}
+
+int
+main(int argc, char **argv)
+{
+    uint32_t records = 10000;
+    uint32_t rounds = 100;
+    if (argc > 1) {
+        records = static_cast<uint32_t>(strtoul(argv[1], nullptr, 10));
+    }
+    if (argc > 2) {
+        rounds = static_cast<uint32_t>(strtoul(argv[2], nullptr, 10));
+    }
+    if (records == 0 || rounds == 0) {
+        fprintf(stderr, "Usage: %s [records] [rounds]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    fds_iemgr_t *iemgr = fds_iemgr_create();
+    if (!iemgr || fds_iemgr_read_dir(iemgr, fds_api_cfg_dir()) != FDS_OK) {
+        fprintf(stderr, "Failed to load definitions of Information Elements!\n");
+        return EXIT_FAILURE;
+    }
+
+    struct fds_template *tmplt_ipv4 = template_create(256, fields_ipv4, iemgr);
+    struct fds_template *tmplt_ipv6 = template_create(257, fields_ipv6, iemgr);
+    std::vector<uint8_t> data_ipv4 = records_generate(tmplt_ipv4, records);
+    std::vector<uint8_t> data_ipv6 = records_generate(tmplt_ipv6, records);
+
+    // Default configuration of the JSON output and all conversions disabled
+    const uint32_t flags_fmt = FDS_CD2J_ALLOW_REALLOC | FDS_CD2J_FORMAT_TCPFLAGS
+        | FDS_CD2J_TS_FORMAT_MSEC | FDS_CD2J_FORMAT_PROTO | FDS_CD2J_NON_PRINTABLE
+        | FDS_CD2J_OCTETS_NOINT;
+    const uint32_t flags_raw = FDS_CD2J_ALLOW_REALLOC | FDS_CD2J_NON_PRINTABLE
+        | FDS_CD2J_OCTETS_NOINT | FDS_CD2J_NUMERIC_ID;
+
+    printf("Records: %" PRIu32 ", rounds: %" PRIu32 "\n\n", records, rounds);
+    printf("%-28s %12s %16s %16s %9s\n", "records", "operations", "libfds [ns]",
+        "serializer [ns]", "speedup");
+    measure("IPv4 (formatted)", tmplt_ipv4, data_ipv4, flags_fmt, iemgr, rounds);
+    measure("IPv4 (raw, numeric IDs)", tmplt_ipv4, data_ipv4, flags_raw, iemgr, rounds);
+    measure("IPv6 (formatted)", tmplt_ipv6, data_ipv6, flags_fmt, iemgr, rounds);
+    measure("IPv6 (raw, numeric IDs)", tmplt_ipv6, data_ipv6, flags_raw, iemgr, rounds);
+
+    fds_template_destroy(tmplt_ipv4);
+    fds_template_destroy(tmplt_ipv6);
+    fds_iemgr_destroy(iemgr);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,181 @@
+/**
+ * \file tests/benchmark/parser.cpp
+ * \brief Benchmark of Transport Session lookup in the IPFIX Message parser
+ *
+ * Usage: bench_parser [sessions] [rounds]
+ */
+
+#include <chrono>
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <libfds.h>
+#include <ipfixcol2.h>
+
+extern "C" {
+#include <core/context.h>
+#include <core/parser.h>
+}
+
+using bench_clock = std::chrono::steady_clock;
+
+/**
+ * \brief Process an IPFIX Message without any Sets (only the header)
+ * \param[in] parser  Parser
+ * \param[in] ctx     Context of the message creator
+ * \param[in] session Transport Session
+ * \param[in] odid    Observation Domain ID
+ */
+static void
+msg_process(ipx_parser_t *parser, const ipx_ctx_t *ctx, const struct ipx_session *session,
+    uint32_t odid)
+{
+    auto hdr = static_cast<struct fds_ipfix_msg_hdr *>(calloc(1, FDS_IPFIX_MSG_HDR_LEN));
+    if (!hdr) {
+        fprintf(stderr, "Memory allocation failed!\n");
+        exit(EXIT_FAILURE);
+    }
+    hdr->version = htons(FDS_IPFIX_VERSION);
+    hdr->length = htons(FDS_IPFIX_MSG_HDR_LEN);
+    hdr->odid = htonl(odid);
+
+    struct ipx_msg_ctx msg_ctx;
+    memset(&msg_ctx, 0, sizeof(msg_ctx));
+    msg_ctx.session = session;
+    msg_ctx.odid = odid;
+    ipx_msg_ipfix_t *msg = ipx_msg_ipfix_create(ctx, &msg_ctx, reinterpret_cast<uint8_t *>(hdr),
+        FDS_IPFIX_MSG_HDR_LEN);
+    if (!msg) {
+        fprintf(stderr, "Failed to create an IPFIX Message!\n");
+        exit(EXIT_FAILURE);
+    }
+
+    ipx_msg_garbage_t *garbage;
+    if (ipx_parser_process(parser, &msg, &garbage) != IPX_OK) {
+        fprintf(stderr, "Failed to process an IPFIX Message!\n");
+        exit(EXIT_FAILURE);
+    }
+    if (garbage) {
+        ipx_msg_garbage_destroy(garbage);
+    }
+    ipx_msg_ipfix_destroy(msg);
+}
+
+/** Print duration of a phase per operation */
+static void
+print_phase(const char *name, bench_clock::time_point start, uint64_t ops)
+{
+    std::chrono::duration<double, std::nano> elapsed = bench_clock::now() - start;
+    printf("%-28s %12" PRIu64 " %14.1f\n", name, ops, elapsed.count() / ops);
+}
+
+int
+main(int argc, char **argv)
+{
+    uint32_t sessions_cnt = 100000;
+    uint32_t rounds = 10;
+    if (argc > 1) {
+        sessions_cnt = static_cast<uint32_t>(strtoul(argv[1], nullptr, 10));
+    }
+    if (argc > 2) {
+        rounds = static_cast<uint32_t>(strtoul(argv[2], nullptr, 10));
+    }
+    if (sessions_cnt == 0 || rounds == 0) {
+        fprintf(stderr, "Usage: %s [sessions] [rounds]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    fds_iemgr_t *iemgr = fds_iemgr_create();
+    ipx_parser_t *parser = ipx_parser_create("bench (parser)", IPX_VERB_ERROR);
+    ipx_ctx_t *ctx = ipx_ctx_create("bench", nullptr);
+    if (!iemgr || !parser || !ctx) {
+        fprintf(stderr, "Failed to initialize the parser!\n");
+        return EXIT_FAILURE;
+    }
+
+    ipx_msg_garbage_t *garbage;
+    if (ipx_parser_ie_source(parser, iemgr, &garbage) != IPX_OK) {
+        fprintf(stderr, "Failed to set the source of Information Elements!\n");
+        return EXIT_FAILURE;
+    }
+    if (garbage) {
+        ipx_msg_garbage_destroy(garbage);
+    }
+
+    // Each UDP exporter is identified by a unique combination of an IP address and a port
+    std::vector<struct ipx_session *> sessions;
+    sessions.reserve(sessions_cnt);
+    for (uint32_t i = 0; i < sessions_cnt; ++i) {
+        struct ipx_session_net net;
+        memset(&net, 0, sizeof(net));
+        net.l3_proto = AF_INET;
+        net.port_src = static_cast<uint16_t>(1024 + (i % 60000));
+        net.port_dst = 4739;
+        net.addr_src.ipv4.s_addr = htonl(0x0A000000U + i / 60000);
+        net.addr_dst.ipv4.s_addr = htonl(0x7F000001U);
+
+        struct ipx_session *session = ipx_session_new_udp(&net, 0, 0);
+        if (!session) {
+            fprintf(stderr, "Failed to create a Transport Session!\n");
+            return EXIT_FAILURE;
+        }
+        sessions.push_back(session);
+    }
+
+    printf("Sessions: %" PRIu32 ", rounds: %" PRIu32 "\n\n", sessions_cnt, rounds);
+    printf("%-28s %12s %14s\n", "phase", "operations", "time/op [ns]");
+
+    // New sessions
+    auto start = bench_clock::now();
+    for (auto session : sessions) {
+        msg_process(parser, ctx, session, 1);
+    }
+    print_phase("new session", start, sessions_cnt);
+
+    // Messages from all exporters are interleaved
+    start = bench_clock::now();
+    for (uint32_t r = 0; r < rounds; ++r) {
+        for (auto session : sessions) {
+            msg_process(parser, ctx, session, 1);
+        }
+    }
+    print_phase("interleaved sessions", start, uint64_t(rounds) * sessions_cnt);
+
+    // Bursts of messages from the same exporter
+    start = bench_clock::now();
+    const uint32_t burst = 8;
+    for (uint32_t r = 0; r < rounds; ++r) {
+        for (auto session : sessions) {
+            for (uint32_t i = 0; i < burst; ++i) {
+                msg_process(parser, ctx, session, 1);
+            }
+        }
+    }
+    print_phase("bursts of 8 messages", start, uint64_t(rounds) * sessions_cnt * burst);
+
+    // Removal of sessions
+    start = bench_clock::now();
+    for (auto session : sessions) {
+        if (ipx_parser_session_remove(parser, session, &garbage) != IPX_OK) {
+            fprintf(stderr, "Failed to remove a Transport Session!\n");
+            return EXIT_FAILURE;
+        }
+        if (garbage) {
+            ipx_msg_garbage_destroy(garbage);
+        }
+    }
+    print_phase("session removal", start, sessions_cnt);
+
+    for (auto session : sessions) {
+        ipx_session_destroy(session);
+    }
+    ipx_ctx_destroy(ctx);
+    ipx_parser_destroy(parser);
+    fds_iemgr_destroy(iemgr);
+    return EXIT_SUCCESS;
+}
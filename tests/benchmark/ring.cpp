@@ -0,0 +1,160 @@
+/**
+ * \file tests/benchmark/ring.cpp
+ * \brief Throughput and latency benchmark of ring buffer implementations
+ *
+ * Usage: bench_ring [messages] [ring size]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+extern "C" {
+#include <core/ring.h>
+}
+
+using bench_clock = std::chrono::steady_clock;
+
+/** Convert a sequence number to a fake message pointer (messages are never dereferenced) */
+static ipx_msg_t *
+num2msg(uintptr_t value)
+{
+    return reinterpret_cast<ipx_msg_t *>(value + 1);
+}
+
+/** Name of a ring implementation */
+static const char *
+type2str(enum ipx_ring_type type)
+{
+    switch (type) {
+    case IPX_RING_MUTEX:    return "mutex";
+    case IPX_RING_LOCKFREE: return "lockfree";
+    default:                return "unknown";
+    }
+}
+
+/**
+ * \brief Measure throughput of the ring with one or more writers
+ * \param[in] writers Number of writer threads
+ * \param[in] cnt     Total number of messages
+ * \param[in] size    Size of the ring
+ * \return Number of messages per second
+ */
+static double
+bench_throughput(unsigned int writers, uint64_t cnt, uint32_t size)
+{
+    ipx_ring_t *ring = ipx_ring_init(size, writers > 1);
+    if (!ring) {
+        fprintf(stderr, "Failed to initialize the ring!\n");
+        exit(EXIT_FAILURE);
+    }
+
+    const uint64_t per_writer = cnt / writers;
+    const uint64_t total = per_writer * writers;
+    std::vector<std::thread> threads;
+
+    auto start = bench_clock::now();
+    for (unsigned int i = 0; i < writers; ++i) {
+        threads.emplace_back([ring, per_writer]() {
+            for (uint64_t i = 0; i < per_writer; ++i) {
+                ipx_ring_push(ring, num2msg(i));
+            }
+        });
+    }
+
+    for (uint64_t i = 0; i < total; ++i) {
+        (void) ipx_ring_pop(ring);
+    }
+    auto end = bench_clock::now();
+
+    for (auto &thread : threads) {
+        thread.join();
+    }
+
+    ipx_ring_destroy(ring);
+    std::chrono::duration<double> elapsed = end - start;
+    return total / elapsed.count();
+}
+
+/**
+ * \brief Measure round-trip latency using two rings (ping-pong)
+ * \param[in] cnt  Number of round trips
+ * \param[in] size Size of the rings
+ * \param[out] p50 Median round-trip time (in nanoseconds)
+ * \param[out] p99 99th percentile of the round-trip time (in nanoseconds)
+ */
+static void
+bench_latency(uint64_t cnt, uint32_t size, double *p50, double *p99)
+{
+    ipx_ring_t *ping = ipx_ring_init(size, false);
+    ipx_ring_t *pong = ipx_ring_init(size, false);
+    if (!ping || !pong) {
+        fprintf(stderr, "Failed to initialize the ring!\n");
+        exit(EXIT_FAILURE);
+    }
+
+    std::thread echo([ping, pong, cnt]() {
+        for (uint64_t i = 0; i < cnt; ++i) {
+            ipx_ring_push(pong, ipx_ring_pop(ping));
+        }
+    });
+
+    std::vector<double> samples;
+    samples.reserve(cnt);
+    for (uint64_t i = 0; i < cnt; ++i) {
+        auto start = bench_clock::now();
+        ipx_ring_push(ping, num2msg(i));
+        (void) ipx_ring_pop(pong);
+        auto end = bench_clock::now();
+        samples.push_back(std::chrono::duration<double, std::nano>(end - start).count());
+    }
+
+    echo.join();
+    ipx_ring_destroy(ping);
+    ipx_ring_destroy(pong);
+
+    std::sort(samples.begin(), samples.end());
+    *p50 = samples[samples.size() / 2];
+    *p99 = samples[(samples.size() * 99) / 100];
+}
+
+int
+main(int argc, char **argv)
+{
+    uint64_t cnt = 10000000;
+    uint32_t size = 8192;
+    if (argc > 1) {
+        cnt = strtoull(argv[1], nullptr, 10);
+    }
+    if (argc > 2) {
+        size = static_cast<uint32_t>(strtoul(argv[2], nullptr, 10));
+    }
+    if (cnt == 0 || size == 0) {
+        fprintf(stderr, "Usage: %s [messages] [ring size]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    // Note: The mutex ring publishes messages in blocks, i.e. a lonely message waits for
+    //   a timeout of the reader. Therefore, only a small number of round trips is measured.
+    const uint64_t lat_cnt = std::min<uint64_t>(cnt, 1000);
+    printf("Messages: %" PRIu64 ", ring size: %" PRIu32 ", CPUs: %u\n\n", cnt, size,
+        std::thread::hardware_concurrency());
+    printf("%-10s %14s %14s %12s %12s\n", "type", "1W [msg/s]", "4W [msg/s]",
+        "RTT p50 [ns]", "RTT p99 [ns]");
+
+    for (enum ipx_ring_type type : {IPX_RING_MUTEX, IPX_RING_LOCKFREE}) {
+        ipx_ring_type_set(type);
+        double single = bench_throughput(1, cnt, size);
+        double multi = bench_throughput(4, cnt, size);
+        double p50, p99;
+        bench_latency(lat_cnt, size, &p50, &p99);
+        printf("%-10s %14.0f %14.0f %12.0f %12.0f\n", type2str(type), single, multi, p50, p99);
+    }
+
+    return EXIT_SUCCESS;
+}
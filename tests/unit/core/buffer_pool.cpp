@@ -0,0 +1,244 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <thread>
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <cstring>
+#include <unistd.h>
+#include <sys/mman.h>
+
+extern "C" {
+#include <core/buffer_pool.h>
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+// Buffers of all sizes must be usable and recognized as buffers of the pool
+TEST(BufferPool, allocSizes)
+{
+    ipx_buffer_pool_t *pool = ipx_buffer_pool_create();
+    ASSERT_NE(pool, nullptr);
+
+    std::vector<uint8_t *> buffers;
+    for (size_t size = 1; size <= IPX_BUFFER_POOL_SIZE_MAX; size = size * 3 + 1) {
+        uint8_t *buffer = ipx_buffer_pool_alloc(pool, size);
+        ASSERT_NE(buffer, nullptr);
+        memset(buffer, 0xAB, size);
+        EXPECT_TRUE(ipx_buffer_pool_owns(pool, buffer));
+        EXPECT_TRUE(ipx_buffer_pool_owns(pool, buffer + size - 1));
+        buffers.push_back(buffer);
+    }
+
+    uint8_t *buffer = ipx_buffer_pool_alloc(pool, IPX_BUFFER_POOL_SIZE_MAX);
+    ASSERT_NE(buffer, nullptr);
+    memset(buffer, 0xCD, IPX_BUFFER_POOL_SIZE_MAX);
+    buffers.push_back(buffer);
+
+    // Too big buffer and memory that doesn't belong to the pool
+    EXPECT_EQ(ipx_buffer_pool_alloc(pool, IPX_BUFFER_POOL_SIZE_MAX + 1), nullptr);
+    uint8_t local;
+    EXPECT_FALSE(ipx_buffer_pool_owns(pool, &local));
+    std::unique_ptr<uint8_t[]> heap(new uint8_t[16]);
+    EXPECT_FALSE(ipx_buffer_pool_owns(pool, heap.get()));
+
+    for (auto buf : buffers) {
+        ipx_buffer_pool_free(buf);
+    }
+    ipx_buffer_pool_destroy(pool);
+}
+
+// Returned buffers must be reused
+TEST(BufferPool, reuse)
+{
+    ipx_buffer_pool_t *pool = ipx_buffer_pool_create();
+    ASSERT_NE(pool, nullptr);
+
+    uint8_t *first = ipx_buffer_pool_alloc(pool, 1500);
+    ASSERT_NE(first, nullptr);
+    ipx_buffer_pool_free(first);
+
+    uint8_t *second = ipx_buffer_pool_alloc(pool, 1000);
+    EXPECT_EQ(first, second);
+    ipx_buffer_pool_free(second);
+    ipx_buffer_pool_destroy(pool);
+}
+
+/** Check if the first whole memory page inside a buffer is resident */
+static bool
+page_resident(const uint8_t *buffer)
+{
+    const uintptr_t page_size = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+    uintptr_t page = (reinterpret_cast<uintptr_t>(buffer) + page_size - 1) & ~(page_size - 1);
+    unsigned char vec;
+    EXPECT_EQ(mincore(reinterpret_cast<void *>(page), page_size, &vec), 0);
+    return (vec & 1) != 0;
+}
+
+// Memory of free buffers above the high-water mark must be released after a burst
+TEST(BufferPool, trim)
+{
+    ipx_buffer_pool_hugepages_set(false);
+    ipx_buffer_pool_t *pool = ipx_buffer_pool_create();
+    ASSERT_NE(pool, nullptr);
+
+    // Burst
+    const size_t burst_cnt = 256;
+    std::vector<uint8_t *> burst;
+    for (size_t i = 0; i < burst_cnt; ++i) {
+        uint8_t *buffer = ipx_buffer_pool_alloc(pool, IPX_BUFFER_POOL_SIZE_MAX);
+        ASSERT_NE(buffer, nullptr);
+        memset(buffer, 0xAB, IPX_BUFFER_POOL_SIZE_MAX);
+        EXPECT_TRUE(page_resident(buffer));
+        burst.push_back(buffer);
+    }
+    for (auto buffer : burst) {
+        ipx_buffer_pool_free(buffer);
+    }
+
+    // Low traffic, only a few buffers in use at the same time
+    for (size_t i = 0; i < 100000; ++i) {
+        uint8_t *buffer = ipx_buffer_pool_alloc(pool, IPX_BUFFER_POOL_SIZE_MAX);
+        ASSERT_NE(buffer, nullptr);
+        buffer[0] = 0xCD;
+        ipx_buffer_pool_free(buffer);
+    }
+
+    size_t released = 0;
+    for (auto buffer : burst) {
+        if (!page_resident(buffer)) {
+            released++;
+        }
+    }
+    EXPECT_GE(released, burst_cnt / 2);
+
+    // Trimmed buffers must be usable again (zeroed by the system)
+    std::vector<uint8_t *> again;
+    for (size_t i = 0; i < burst_cnt; ++i) {
+        uint8_t *buffer = ipx_buffer_pool_alloc(pool, IPX_BUFFER_POOL_SIZE_MAX);
+        ASSERT_NE(buffer, nullptr);
+        memset(buffer, 0xEF, IPX_BUFFER_POOL_SIZE_MAX);
+        again.push_back(buffer);
+    }
+    std::sort(burst.begin(), burst.end());
+    std::sort(again.begin(), again.end());
+    EXPECT_EQ(burst, again);
+
+    for (auto buffer : again) {
+        ipx_buffer_pool_free(buffer);
+    }
+    ipx_buffer_pool_destroy(pool);
+}
+
+// A shared buffer must be returned after the last reference is released
+TEST(BufferPool, refs)
+{
+    ipx_buffer_pool_t *pool = ipx_buffer_pool_create();
+    ASSERT_NE(pool, nullptr);
+
+    uint8_t *buffer = ipx_buffer_pool_alloc(pool, 4000);
+    ASSERT_NE(buffer, nullptr);
+    ipx_buffer_pool_ref(buffer);
+    ipx_buffer_pool_ref(buffer);
+
+    ipx_buffer_pool_free(buffer);
+    ipx_buffer_pool_free(buffer);
+    uint8_t *other = ipx_buffer_pool_alloc(pool, 4000);
+    ASSERT_NE(other, nullptr);
+    EXPECT_NE(other, buffer);
+
+    // The last reference returns the buffer
+    ipx_buffer_pool_free(buffer);
+    ipx_buffer_pool_free(other);
+    uint8_t *first = ipx_buffer_pool_alloc(pool, 4000);
+    uint8_t *second = ipx_buffer_pool_alloc(pool, 4000);
+    EXPECT_TRUE((first == buffer && second == other) || (first == other && second == buffer));
+
+    // Reused buffers hold only a single reference
+    ipx_buffer_pool_free(first);
+    ipx_buffer_pool_free(second);
+    uint8_t *third = ipx_buffer_pool_alloc(pool, 4000);
+    EXPECT_TRUE(third == buffer || third == other);
+    ipx_buffer_pool_free(third);
+    ipx_buffer_pool_destroy(pool);
+}
+
+// Huge pages are optional, the pool must work even if they are not available
+TEST(BufferPool, hugepages)
+{
+    ipx_buffer_pool_hugepages_set(true);
+    ipx_buffer_pool_t *pool = ipx_buffer_pool_create();
+    ipx_buffer_pool_hugepages_set(false);
+    ASSERT_NE(pool, nullptr);
+
+    std::vector<uint8_t *> buffers;
+    for (unsigned int i = 0; i < 100; ++i) {
+        uint8_t *buffer = ipx_buffer_pool_alloc(pool, 65000);
+        ASSERT_NE(buffer, nullptr);
+        memset(buffer, 0, 65000);
+        EXPECT_TRUE(ipx_buffer_pool_owns(pool, buffer));
+        buffers.push_back(buffer);
+    }
+
+    for (auto buffer : buffers) {
+        ipx_buffer_pool_free(buffer);
+    }
+    ipx_buffer_pool_destroy(pool);
+}
+
+// Buffers allocated by the owner and returned by other threads, some of them after the pool
+TEST(BufferPool, crossThread)
+{
+    const unsigned int threads_cnt = 4;
+    const unsigned int rounds = 200;
+    const unsigned int batch = 256;
+    ipx_buffer_pool_t *pool = ipx_buffer_pool_create();
+    ASSERT_NE(pool, nullptr);
+
+    for (unsigned int round = 0; round < rounds; ++round) {
+        std::vector<std::vector<uint8_t *>> buffers(threads_cnt);
+        for (auto &vec : buffers) {
+            for (unsigned int i = 0; i < batch; ++i) {
+                const size_t size = (i % 2) ? 1500 : 65000;
+                uint8_t *buffer = ipx_buffer_pool_alloc(pool, size);
+                ASSERT_NE(buffer, nullptr);
+                memset(buffer, static_cast<int>(i), size);
+                vec.push_back(buffer);
+            }
+        }
+
+        std::vector<std::thread> threads;
+        for (auto &vec : buffers) {
+            threads.emplace_back([&vec]() {
+                for (auto buffer : vec) {
+                    ipx_buffer_pool_free(buffer);
+                }
+            });
+        }
+        for (auto &thread : threads) {
+            thread.join();
+        }
+    }
+
+    // Destroy the pool while some buffers are still in use
+    std::vector<uint8_t *> alive;
+    for (unsigned int i = 0; i < batch; ++i) {
+        uint8_t *buffer = ipx_buffer_pool_alloc(pool, 9000);
+        ASSERT_NE(buffer, nullptr);
+        alive.push_back(buffer);
+    }
+
+    ipx_buffer_pool_destroy(pool);
+
+    std::thread late([&alive]() {
+        for (auto buffer : alive) {
+            memset(buffer, 0, 9000);
+            ipx_buffer_pool_free(buffer);
+        }
+    });
+    late.join();
+}
@@ -0,0 +1,55 @@
+#include <gtest/gtest.h>
+#include <vector>
+
+#include <ipfixcol2.h>
+
+extern "C" {
+#include <core/context.h>
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+// An instance is a single worker by default
+TEST(Context, workerDefault)
+{
+    ipx_ctx_t *ctx = ipx_ctx_create("input", nullptr);
+    ASSERT_NE(ctx, nullptr);
+
+    unsigned int id = 100;
+    unsigned int cnt = 100;
+    ipx_ctx_worker_get(ctx, &id, &cnt);
+    EXPECT_EQ(id, 0U);
+    EXPECT_EQ(cnt, 1U);
+    ipx_ctx_destroy(ctx);
+}
+
+// Each replica of an instance gets its own identification
+TEST(Context, workerSet)
+{
+    const unsigned int workers = 4;
+    std::vector<ipx_ctx_t *> replicas;
+    for (unsigned int i = 0; i < workers; ++i) {
+        ipx_ctx_t *ctx = ipx_ctx_create("input", nullptr);
+        ASSERT_NE(ctx, nullptr);
+        ipx_ctx_worker_set(ctx, i, workers);
+        replicas.push_back(ctx);
+    }
+
+    for (unsigned int i = 0; i < workers; ++i) {
+        unsigned int id;
+        unsigned int cnt;
+        ipx_ctx_worker_get(replicas[i], &id, &cnt);
+        EXPECT_EQ(id, i);
+        EXPECT_EQ(cnt, workers);
+
+        // Only the number of workers
+        cnt = 0;
+        ipx_ctx_worker_get(replicas[i], nullptr, &cnt);
+        EXPECT_EQ(cnt, workers);
+        ipx_ctx_destroy(replicas[i]);
+    }
+}
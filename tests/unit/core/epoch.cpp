@@ -0,0 +1,223 @@
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+#include <atomic>
+#include <cstdint>
+
+extern "C" {
+#include <core/epoch.h>
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+/** Destructor of a fake retired object (increments a counter) */
+static void
+counter_inc(void *object)
+{
+    (*static_cast<unsigned int *>(object))++;
+}
+
+// Retired epoch must pass only after all references acquired up to the epoch are released
+TEST(Epoch, passed)
+{
+    uint64_t ref1 = ipx_epoch_acquire();
+    ASSERT_NE(ref1, 0U);
+    uint64_t retired1 = ipx_epoch_retire();
+    EXPECT_GE(retired1, ref1);
+    EXPECT_FALSE(ipx_epoch_passed(retired1));
+
+    // References acquired after retirement must not block the retired epoch
+    uint64_t ref2 = ipx_epoch_acquire();
+    EXPECT_GT(ref2, retired1);
+    ipx_epoch_release(ref1);
+    EXPECT_TRUE(ipx_epoch_passed(retired1));
+
+    uint64_t retired2 = ipx_epoch_retire();
+    EXPECT_FALSE(ipx_epoch_passed(retired2));
+    ipx_epoch_release(ref2);
+    EXPECT_TRUE(ipx_epoch_passed(retired2));
+}
+
+// If the window of epochs is full, the retirement epoch doesn't change
+TEST(Epoch, windowFull)
+{
+    uint64_t ref = ipx_epoch_acquire();
+    uint64_t retired = 0;
+    for (unsigned int i = 0; i < 2 * IPX_EPOCH_WINDOW; ++i) {
+        uint64_t epoch = ipx_epoch_retire();
+        EXPECT_GE(epoch, retired);
+        retired = epoch;
+    }
+    EXPECT_LT(retired - ref, IPX_EPOCH_WINDOW);
+    EXPECT_FALSE(ipx_epoch_passed(retired));
+
+    ipx_epoch_release(ref);
+    EXPECT_TRUE(ipx_epoch_passed(retired));
+}
+
+// Objects in a list must be destroyed in order and only when they are not referenced
+TEST(Epoch, list)
+{
+    unsigned int destroyed = 0;
+    ipx_epoch_list_t *list = ipx_epoch_list_create();
+    ASSERT_NE(list, nullptr);
+
+    std::vector<uint64_t> refs;
+    for (unsigned int i = 0; i < 100; ++i) {
+        refs.push_back(ipx_epoch_acquire());
+        ASSERT_EQ(ipx_epoch_list_defer(list, &destroyed, &counter_inc), IPX_OK);
+    }
+    EXPECT_EQ(ipx_epoch_list_reclaim(list), 100U);
+
+    for (unsigned int i = 0; i < refs.size(); ++i) {
+        ipx_epoch_release(refs[i]);
+        EXPECT_EQ(ipx_epoch_list_reclaim(list), refs.size() - i - 1);
+        EXPECT_EQ(destroyed, i + 1);
+    }
+
+    // The rest of the objects must be destroyed with the list
+    uint64_t ref = ipx_epoch_acquire();
+    ASSERT_EQ(ipx_epoch_list_defer(list, &destroyed, &counter_inc), IPX_OK);
+    EXPECT_EQ(ipx_epoch_list_reclaim(list), 1U);
+    ipx_epoch_list_destroy(list);
+    EXPECT_EQ(destroyed, 101U);
+    ipx_epoch_release(ref);
+}
+
+// References acquired by a producer and released by consumers in other threads
+TEST(Epoch, crossThread)
+{
+    const unsigned int consumers_cnt = 4;
+    const unsigned int cnt = 100000;
+    ipx_epoch_list_t *list = ipx_epoch_list_create();
+    ASSERT_NE(list, nullptr);
+
+    // Each "object" is valid until it is destroyed by the list
+    std::vector<std::atomic<bool>> valid(cnt);
+    for (auto &item : valid) {
+        item = true;
+    }
+
+    // References (epoch, object) passed to consumers (pre-allocated, never reallocated)
+    std::vector<std::vector<std::pair<uint64_t, unsigned int>>> refs(consumers_cnt);
+    std::vector<std::atomic<unsigned int>> published(consumers_cnt);
+    for (unsigned int id = 0; id < consumers_cnt; ++id) {
+        refs[id].resize(cnt / consumers_cnt + 1);
+        published[id] = 0;
+    }
+
+    std::atomic<bool> failed(false);
+    std::vector<std::thread> consumers;
+    for (unsigned int id = 0; id < consumers_cnt; ++id) {
+        consumers.emplace_back([&, id]() {
+            const unsigned int total = (cnt - id + consumers_cnt - 1) / consumers_cnt;
+            for (unsigned int idx = 0; idx < total; ++idx) {
+                while (published[id].load() <= idx) {
+                    std::this_thread::yield();
+                }
+                const auto &ref = refs[id][idx];
+                if (!valid[ref.second].load()) {
+                    failed = true;
+                }
+                ipx_epoch_release(ref.first);
+            }
+        });
+    }
+
+    auto cb = [](void *obj) {
+        static_cast<std::atomic<bool> *>(obj)->store(false);
+    };
+    for (unsigned int i = 0; i < cnt; ++i) {
+        // Acquire a reference to the current object and retire the previous one
+        const unsigned int id = i % consumers_cnt;
+        const unsigned int idx = published[id].load();
+        refs[id][idx] = {ipx_epoch_acquire(), i};
+        published[id].store(idx + 1);
+        if (i > 0) {
+            EXPECT_EQ(ipx_epoch_list_defer(list, &valid[i - 1], cb), IPX_OK);
+        }
+        ipx_epoch_list_reclaim(list);
+    }
+
+    for (auto &consumer : consumers) {
+        consumer.join();
+    }
+    EXPECT_FALSE(failed);
+
+    // All retired objects must be destroyed, only the last one is still valid
+    EXPECT_EQ(ipx_epoch_list_reclaim(list), 0U);
+    for (unsigned int i = 0; i + 1 < cnt; ++i) {
+        ASSERT_FALSE(valid[i].load());
+    }
+    EXPECT_TRUE(valid[cnt - 1].load());
+    ipx_epoch_list_destroy(list);
+}
+
+// Epochs closed by other threads while references are being acquired
+TEST(Epoch, concurrentAcquire)
+{
+    const unsigned int readers_cnt = 4;
+    const unsigned int closers_cnt = 2;
+    const unsigned int cnt = 200000;
+    ipx_epoch_list_t *list = ipx_epoch_list_create();
+    ASSERT_NE(list, nullptr);
+
+    std::vector<std::atomic<bool>> valid(cnt);
+    for (auto &item : valid) {
+        item = true;
+    }
+
+    std::atomic<unsigned int> shared(0);
+    std::atomic<bool> stop(false);
+    std::atomic<bool> failed(false);
+    std::vector<std::thread> threads;
+
+    // Readers access the current object only within an acquired epoch
+    for (unsigned int id = 0; id < readers_cnt; ++id) {
+        threads.emplace_back([&]() {
+            while (!stop.load()) {
+                const uint64_t epoch = ipx_epoch_acquire();
+                const unsigned int idx = shared.load();
+                for (unsigned int i = 0; i < 8; ++i) {
+                    if (!valid[idx].load()) {
+                        failed = true;
+                    }
+                }
+                ipx_epoch_release(epoch);
+            }
+        });
+    }
+
+    // Other threads close open epochs as fast as possible
+    for (unsigned int id = 0; id < closers_cnt; ++id) {
+        threads.emplace_back([&]() {
+            while (!stop.load()) {
+                ipx_epoch_passed(ipx_epoch_retire());
+            }
+        });
+    }
+
+    auto cb = [](void *obj) {
+        static_cast<std::atomic<bool> *>(obj)->store(false);
+    };
+    for (unsigned int i = 1; i < cnt; ++i) {
+        // Replace the object and retire the previous one
+        shared.store(i);
+        EXPECT_EQ(ipx_epoch_list_defer(list, &valid[i - 1], cb), IPX_OK);
+        ipx_epoch_list_reclaim(list);
+    }
+
+    stop = true;
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    EXPECT_FALSE(failed);
+
+    EXPECT_EQ(ipx_epoch_list_reclaim(list), 0U);
+    EXPECT_TRUE(valid[cnt - 1].load());
+    ipx_epoch_list_destroy(list);
+}
@@ -0,0 +1,205 @@
+#include <gtest/gtest.h>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <set>
+#include <vector>
+
+#include <ipfixcol2.h>
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+/** Template Record (ID 256): sourceIPv4Address, sourceTransportPort, destinationIPv4Address */
+static const uint8_t tmplt_fixed[] = {
+    0x01, 0x00, 0x00, 0x03,
+    0x00, 0x08, 0x00, 0x04,
+    0x00, 0x07, 0x00, 0x02,
+    0x00, 0x0C, 0x00, 0x04
+};
+
+/** Template Record (ID 256): destinationIPv4Address, sourceTransportPort, sourceIPv4Address */
+static const uint8_t tmplt_swapped[] = {
+    0x01, 0x00, 0x00, 0x03,
+    0x00, 0x0C, 0x00, 0x04,
+    0x00, 0x07, 0x00, 0x02,
+    0x00, 0x08, 0x00, 0x04
+};
+
+/** Template Record (ID 257): sourceIPv4Address, interfaceName (variable), destinationIPv4Address */
+static const uint8_t tmplt_dynamic[] = {
+    0x01, 0x01, 0x00, 0x03,
+    0x00, 0x08, 0x00, 0x04,
+    0x00, 0x52, 0xFF, 0xFF,
+    0x00, 0x0C, 0x00, 0x04
+};
+
+class FieldLocator : public ::testing::Test {
+protected:
+    /** IDs of IANA fields to locate */
+    std::set<uint16_t> ids;
+    /** Number of calls of the match callback */
+    unsigned int calls = 0;
+
+    struct fds_template *tmplt_parse(const uint8_t *raw, uint16_t size) {
+        struct fds_template *tmplt = nullptr;
+        uint16_t len = size;
+        EXPECT_EQ(fds_template_parse(FDS_TYPE_TEMPLATE, raw, &len, &tmplt), FDS_OK);
+        return tmplt;
+    }
+
+    static bool match(const struct fds_tfield *field, void *data) {
+        auto *self = static_cast<FieldLocator *>(data);
+        self->calls++;
+        return field->en == 0 && self->ids.count(field->id) > 0;
+    }
+};
+
+// Positions of matching fields of a fixed-length template
+TEST_F(FieldLocator, fixed)
+{
+    struct fds_template *tmplt = tmplt_parse(tmplt_fixed, sizeof(tmplt_fixed));
+    ASSERT_NE(tmplt, nullptr);
+    ids = {8, 12};
+
+    ipx_floc_t *floc = ipx_floc_create(&FieldLocator::match, this);
+    ASSERT_NE(floc, nullptr);
+
+    const struct ipx_floc_field *fields;
+    uint16_t cnt;
+    ASSERT_EQ(ipx_floc_get(floc, tmplt, &fields, &cnt), IPX_OK);
+    ASSERT_EQ(cnt, 2U);
+    EXPECT_EQ(fields[0].offset, 0U);
+    EXPECT_EQ(fields[0].length, 4U);
+    EXPECT_EQ(fields[0].info->id, 8U);
+    EXPECT_EQ(fields[1].offset, 6U);
+    EXPECT_EQ(fields[1].length, 4U);
+    EXPECT_EQ(fields[1].info->id, 12U);
+
+    // The result is cached
+    const unsigned int calls_prev = calls;
+    ASSERT_EQ(ipx_floc_get(floc, tmplt, &fields, &cnt), IPX_OK);
+    EXPECT_EQ(cnt, 2U);
+    EXPECT_EQ(calls, calls_prev);
+
+    ipx_floc_destroy(floc);
+    fds_template_destroy(tmplt);
+}
+
+// Fields after a variable-length field don't have a fixed position
+TEST_F(FieldLocator, dynamic)
+{
+    struct fds_template *tmplt = tmplt_parse(tmplt_dynamic, sizeof(tmplt_dynamic));
+    ASSERT_NE(tmplt, nullptr);
+    const struct ipx_floc_field *fields;
+    uint16_t cnt;
+
+    ids = {8};
+    ipx_floc_t *floc = ipx_floc_create(&FieldLocator::match, this);
+    ASSERT_NE(floc, nullptr);
+    ASSERT_EQ(ipx_floc_get(floc, tmplt, &fields, &cnt), IPX_OK);
+    ASSERT_EQ(cnt, 1U);
+    EXPECT_EQ(fields[0].offset, 0U);
+    ipx_floc_destroy(floc);
+
+    ids = {8, 12};
+    floc = ipx_floc_create(&FieldLocator::match, this);
+    ASSERT_NE(floc, nullptr);
+    EXPECT_EQ(ipx_floc_get(floc, tmplt, &fields, &cnt), IPX_ERR_FORMAT);
+    EXPECT_EQ(cnt, 0U);
+    ipx_floc_destroy(floc);
+
+    ids = {};
+    floc = ipx_floc_create(&FieldLocator::match, this);
+    ASSERT_NE(floc, nullptr);
+    EXPECT_EQ(ipx_floc_get(floc, tmplt, &fields, &cnt), IPX_OK);
+    EXPECT_EQ(cnt, 0U);
+    ipx_floc_destroy(floc);
+
+    fds_template_destroy(tmplt);
+}
+
+// A new template allocated at the address of a freed one must not use the cached positions
+TEST_F(FieldLocator, addressReuse)
+{
+    struct fds_template *tmplt_a = tmplt_parse(tmplt_fixed, sizeof(tmplt_fixed));
+    struct fds_template *tmplt_b = tmplt_parse(tmplt_swapped, sizeof(tmplt_swapped));
+    ASSERT_NE(tmplt_a, nullptr);
+    ASSERT_NE(tmplt_b, nullptr);
+    ASSERT_EQ(tmplt_a->fields_cnt_total, tmplt_b->fields_cnt_total);
+    ids = {8};
+
+    // Both templates are copied to the same memory to simulate reuse of the address
+    const size_t size = offsetof(struct fds_template, fields)
+        + tmplt_a->fields_cnt_total * sizeof(struct fds_tfield);
+    struct fds_template *tmplt = static_cast<struct fds_template *>(malloc(size));
+    ASSERT_NE(tmplt, nullptr);
+
+    ipx_floc_t *floc = ipx_floc_create(&FieldLocator::match, this);
+    ASSERT_NE(floc, nullptr);
+    const struct ipx_floc_field *fields;
+    uint16_t cnt;
+
+    memcpy(tmplt, tmplt_a, size);
+    ASSERT_EQ(ipx_floc_get(floc, tmplt, &fields, &cnt), IPX_OK);
+    ASSERT_EQ(cnt, 1U);
+    EXPECT_EQ(fields[0].offset, 0U);
+
+    memcpy(tmplt, tmplt_b, size);
+    unsigned int calls_prev = calls;
+    ASSERT_EQ(ipx_floc_get(floc, tmplt, &fields, &cnt), IPX_OK);
+    ASSERT_EQ(cnt, 1U);
+    EXPECT_EQ(fields[0].offset, 6U);
+    EXPECT_GT(calls, calls_prev);
+
+    // The same definition at the same address is still cached
+    calls_prev = calls;
+    ASSERT_EQ(ipx_floc_get(floc, tmplt, &fields, &cnt), IPX_OK);
+    ASSERT_EQ(cnt, 1U);
+    EXPECT_EQ(fields[0].offset, 6U);
+    EXPECT_EQ(calls, calls_prev);
+
+    ipx_floc_destroy(floc);
+    free(tmplt);
+    fds_template_destroy(tmplt_a);
+    fds_template_destroy(tmplt_b);
+}
+
+// Many templates in the same cache
+TEST_F(FieldLocator, manyTemplates)
+{
+    const size_t tmplt_cnt = 200;
+    std::vector<struct fds_template *> tmplts;
+    for (size_t i = 0; i < tmplt_cnt; ++i) {
+        struct fds_template *tmplt = tmplt_parse(tmplt_fixed, sizeof(tmplt_fixed));
+        ASSERT_NE(tmplt, nullptr);
+        tmplts.push_back(tmplt);
+    }
+
+    ids = {7};
+    ipx_floc_t *floc = ipx_floc_create(&FieldLocator::match, this);
+    ASSERT_NE(floc, nullptr);
+
+    for (int round = 0; round < 2; ++round) {
+        for (auto tmplt : tmplts) {
+            const struct ipx_floc_field *fields;
+            uint16_t cnt;
+            ASSERT_EQ(ipx_floc_get(floc, tmplt, &fields, &cnt), IPX_OK);
+            ASSERT_EQ(cnt, 1U);
+            EXPECT_EQ(fields[0].offset, 4U);
+            EXPECT_EQ(fields[0].info, &tmplt->fields[1]);
+        }
+    }
+
+    // Each template has been processed only once
+    EXPECT_EQ(calls, tmplt_cnt * 3);
+
+    ipx_floc_destroy(floc);
+    for (auto tmplt : tmplts) {
+        fds_template_destroy(tmplt);
+    }
+}
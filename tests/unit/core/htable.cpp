@@ -0,0 +1,153 @@
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <cstdlib>
+#include <map>
+#include <vector>
+
+#include <ipfixcol2.h>
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+/** Item of the hash table */
+struct item {
+    uint32_t key;
+    uint64_t hash;
+};
+
+static bool
+item_eq(const void *item, const void *key)
+{
+    return static_cast<const struct item *>(item)->key == *static_cast<const uint32_t *>(key);
+}
+
+/**
+ * Test fixture with an empty hash table and items with configurable hash values
+ *
+ * The number of different hash values can be limited to create long clusters of colliding items.
+ */
+class HTable : public ::testing::Test {
+protected:
+    struct ipx_htable table;
+    std::map<uint32_t, struct item *> items;
+
+    void SetUp() override {
+        ASSERT_EQ(ipx_htable_init(&table, 4), IPX_OK);
+    }
+
+    void TearDown() override {
+        for (auto &it : items) {
+            delete it.second;
+        }
+        ipx_htable_destroy(&table);
+    }
+
+    struct ipx_htable_slot *
+    find(uint32_t key, uint64_t hash) {
+        return ipx_htable_find(&table, hash, &item_eq, &key);
+    }
+
+    void
+    insert(uint32_t key, uint64_t hash) {
+        struct item *rec = new item{key, hash};
+        items[key] = rec;
+        ASSERT_EQ(ipx_htable_reserve(&table), IPX_OK);
+        ipx_htable_insert(&table, hash, rec);
+    }
+
+    void
+    remove(uint32_t key) {
+        struct item *rec = items[key];
+        struct ipx_htable_slot *slot = ipx_htable_find_item(&table, rec->hash, rec);
+        ASSERT_NE(slot, nullptr);
+        ipx_htable_remove(&table, slot);
+        items.erase(key);
+        delete rec;
+    }
+
+    // All inserted items (and nothing else) must be found
+    void
+    check() {
+        ASSERT_EQ(table.used, items.size());
+        ASSERT_LE(2 * table.used, table.size);
+        for (auto &it : items) {
+            struct ipx_htable_slot *slot = find(it.first, it.second->hash);
+            ASSERT_NE(slot, nullptr) << "key: " << it.first;
+            EXPECT_EQ(slot->item, it.second);
+            EXPECT_EQ(slot->hash, it.second->hash);
+        }
+
+        size_t cnt = 0;
+        for (size_t i = 0; i < table.size; ++i) {
+            cnt += (table.slots[i].item != nullptr) ? 1 : 0;
+        }
+        EXPECT_EQ(cnt, items.size());
+    }
+};
+
+// Insert items, the table must grow
+TEST_F(HTable, insert)
+{
+    for (uint32_t key = 0; key < 1000; ++key) {
+        insert(key, ipx_htable_mix(key));
+    }
+    check();
+    EXPECT_EQ(find(1000, ipx_htable_mix(1000)), nullptr);
+}
+
+// Random insertions and removals with many collisions (backward shift deletion)
+TEST_F(HTable, removeCollisions)
+{
+    srand(42);
+    for (unsigned int round = 0; round < 20000; ++round) {
+        const uint32_t key = rand() % 512;
+        // Only a few hash values, i.e. long clusters that wrap around the end of the table
+        const uint64_t hash = (key % 7) | 0xFFFFFFF0U;
+        if (items.count(key) != 0) {
+            remove(key);
+            EXPECT_EQ(find(key, hash), nullptr);
+        } else {
+            insert(key, hash);
+        }
+
+        if (round % 1000 == 0) {
+            check();
+        }
+    }
+    check();
+
+    while (!items.empty()) {
+        remove(items.begin()->first);
+    }
+    check();
+}
+
+// Remove items while iterating over the slots
+TEST_F(HTable, removeIterate)
+{
+    for (uint32_t key = 0; key < 300; ++key) {
+        insert(key, key % 5);
+    }
+
+    size_t idx = 0;
+    while (idx < table.size) {
+        const struct item *rec = static_cast<const struct item *>(table.slots[idx].item);
+        if (rec == nullptr || rec->key % 2 != 0) {
+            idx++;
+            continue;
+        }
+
+        // Another item could be moved to the slot, therefore, the slot is checked again
+        remove(rec->key);
+    }
+    check();
+
+    ipx_htable_clear(&table);
+    EXPECT_EQ(table.used, 0U);
+    for (auto &it : items) {
+        EXPECT_EQ(find(it.first, it.second->hash), nullptr);
+    }
+}
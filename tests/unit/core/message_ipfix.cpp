@@ -0,0 +1,301 @@
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+#include <libfds.h>
+#include <ipfixcol2.h>
+
+extern "C" {
+#include <core/context.h>
+#include <core/fpipe.h>
+#include <core/ring.h>
+#include <core/message_ipfix.h>
+#include <core/buffer_pool.h>
+}
+
+#include "tools/FakePlugin.h"
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+/** Create an IPFIX Message wrapper around a fake packet of a given size */
+static ipx_msg_ipfix_t *
+msg_create(const ipx_ctx_t *ctx, uint16_t size)
+{
+    struct ipx_msg_ctx msg_ctx;
+    memset(&msg_ctx, 0, sizeof(msg_ctx));
+    uint8_t *data = static_cast<uint8_t *>(calloc(1, size));
+    if (!data) {
+        return nullptr;
+    }
+
+    ipx_msg_ipfix_t *msg = ipx_msg_ipfix_create(ctx, &msg_ctx, data, size);
+    if (!msg) {
+        free(data);
+    }
+    return msg;
+}
+
+/** Test fixture with an initialized context of an input instance (i.e. with a wrapper pool) */
+class MsgPool : public ::testing::Test {
+protected:
+    fds_iemgr_t *iemgr = nullptr;
+    ipx_fpipe_t *fpipe = nullptr;
+    ipx_ring_t *ring = nullptr;
+    ipx_ctx_t *ctx = nullptr;
+
+    void SetUp() override {
+        iemgr = fds_iemgr_create();
+        fpipe = ipx_fpipe_create();
+        ring = ipx_ring_init(64, false);
+        ctx = ipx_ctx_create("pool-test", &fake_input_cbs);
+        ASSERT_NE(iemgr, nullptr);
+        ASSERT_NE(fpipe, nullptr);
+        ASSERT_NE(ring, nullptr);
+        ASSERT_NE(ctx, nullptr);
+
+        ipx_ctx_fpipe_set(ctx, fpipe);
+        ipx_ctx_ring_dst_set(ctx, ring);
+        ipx_ctx_iemgr_set(ctx, iemgr);
+        ASSERT_EQ(ipx_ctx_init(ctx, nullptr), IPX_OK);
+        ASSERT_NE(ipx_ctx_msg_pool_get(ctx), nullptr);
+    }
+
+    void TearDown() override {
+        if (ctx) {
+            ipx_ctx_destroy(ctx);
+        }
+        if (ring) {
+            ipx_ring_destroy(ring);
+        }
+        if (fpipe) {
+            ipx_fpipe_destroy(fpipe);
+        }
+        if (iemgr) {
+            fds_iemgr_destroy(iemgr);
+        }
+    }
+};
+
+// Context without a pool, the size of the wrapper must be estimated from the size of the message
+TEST(MsgIpfix, sizeHint)
+{
+    ipx_ctx_t *ctx = ipx_ctx_create("dummy", nullptr);
+    ASSERT_NE(ctx, nullptr);
+    EXPECT_EQ(ipx_ctx_msg_pool_get(ctx), nullptr);
+
+    const uint16_t msg_size = 60000;
+    ipx_msg_ipfix_t *msg = msg_create(ctx, msg_size);
+    ASSERT_NE(msg, nullptr);
+    ipx_msg_ipfix_t *msg_orig = msg;
+
+    // Records of a typical size must not require reallocation of the wrapper
+    const uint32_t rec_cnt = msg_size / 48U;
+    for (uint32_t i = 0; i < rec_cnt; ++i) {
+        struct ipx_ipfix_record *rec = ipx_msg_ipfix_add_drec_ref(&msg);
+        ASSERT_NE(rec, nullptr);
+        EXPECT_EQ(rec->ext_mask, 0U);
+    }
+    EXPECT_EQ(msg, msg_orig);
+    EXPECT_EQ(ipx_msg_ipfix_get_drec_cnt(msg), rec_cnt);
+
+    // Reallocation must still work
+    for (uint32_t i = 0; i < rec_cnt; ++i) {
+        ASSERT_NE(ipx_msg_ipfix_add_drec_ref(&msg), nullptr);
+    }
+    EXPECT_EQ(ipx_msg_ipfix_get_drec_cnt(msg), 2 * rec_cnt);
+
+    ipx_msg_ipfix_destroy(msg);
+    ipx_ctx_destroy(ctx);
+}
+
+// Multiple records reserved at once must be consecutive and indexable one by one
+TEST(MsgIpfix, addMultiple)
+{
+    ipx_ctx_t *ctx = ipx_ctx_create("dummy", nullptr);
+    ASSERT_NE(ctx, nullptr);
+    ipx_msg_ipfix_t *msg = msg_create(ctx, 100);
+    ASSERT_NE(msg, nullptr);
+
+    ASSERT_NE(ipx_msg_ipfix_add_drec_ref(&msg), nullptr);
+    const uint32_t rec_cnt = 1000; // Requires reallocation
+    struct ipx_ipfix_record *recs = ipx_msg_ipfix_add_drec_refs(&msg, rec_cnt);
+    ASSERT_NE(recs, nullptr);
+    EXPECT_EQ(ipx_msg_ipfix_get_drec_cnt(msg), rec_cnt + 1);
+    EXPECT_EQ(ipx_msg_ipfix_get_drec(msg, 1), recs);
+
+    const size_t rec_size = ipx_ctx_recsize_get(ctx);
+    for (uint32_t i = 0; i < rec_cnt; ++i) {
+        uint8_t *rec_ptr = reinterpret_cast<uint8_t *>(recs) + i * rec_size;
+        EXPECT_EQ(ipx_msg_ipfix_get_drec(msg, i + 1),
+            reinterpret_cast<struct ipx_ipfix_record *>(rec_ptr));
+    }
+    EXPECT_EQ(ipx_msg_ipfix_get_drec(msg, rec_cnt + 1), nullptr);
+
+    ipx_msg_ipfix_destroy(msg);
+    ipx_ctx_destroy(ctx);
+}
+
+// Wrapper of a destroyed message must be reused and look like a new one
+TEST_F(MsgPool, reuse)
+{
+    ipx_msg_ipfix_t *msg = msg_create(ctx, 1500);
+    ASSERT_NE(msg, nullptr);
+    for (uint32_t i = 0; i < 10; ++i) {
+        struct ipx_ipfix_record *rec = ipx_msg_ipfix_add_drec_ref(&msg);
+        ASSERT_NE(rec, nullptr);
+        rec->ext_mask = UINT64_MAX;
+    }
+    ipx_msg_ipfix_t *msg_old = msg;
+    ipx_msg_ipfix_destroy(msg);
+
+    msg = msg_create(ctx, 1500);
+    ASSERT_NE(msg, nullptr);
+    EXPECT_EQ(msg, msg_old);
+    EXPECT_EQ(ipx_msg_ipfix_get_drec_cnt(msg), 0U);
+    EXPECT_EQ(ipx_msg_ipfix_get_drec(msg, 0), nullptr);
+    struct ipx_ipfix_record *rec = ipx_msg_ipfix_add_drec_ref(&msg);
+    ASSERT_NE(rec, nullptr);
+    EXPECT_EQ(rec->ext_mask, 0U);
+    ipx_msg_ipfix_destroy(msg);
+}
+
+// Raw packets allocated from the pool of buffers must be returned when the message is destroyed
+TEST_F(MsgPool, rawBuffer)
+{
+    uint8_t *buffer = ipx_msg_ipfix_buffer_alloc(ctx, 1500);
+    ASSERT_NE(buffer, nullptr);
+    EXPECT_TRUE(ipx_buffer_pool_owns(ipx_ctx_buffer_pool_get(ctx), buffer));
+
+    struct ipx_msg_ctx msg_ctx;
+    memset(&msg_ctx, 0, sizeof(msg_ctx));
+    ipx_msg_ipfix_t *msg = ipx_msg_ipfix_create(ctx, &msg_ctx, buffer, 1500);
+    ASSERT_NE(msg, nullptr);
+    EXPECT_EQ(ipx_msg_ipfix_get_packet(msg), buffer);
+    ipx_msg_ipfix_destroy(msg);
+
+    // The buffer must be available again
+    uint8_t *buffer_new = ipx_msg_ipfix_buffer_alloc(ctx, 1500);
+    EXPECT_EQ(buffer_new, buffer);
+    ipx_msg_ipfix_buffer_free(ctx, buffer_new);
+
+    // Buffers of a dummy context are allocated using malloc()
+    ipx_ctx_t *dummy = ipx_ctx_create("dummy", nullptr);
+    ASSERT_NE(dummy, nullptr);
+    buffer = ipx_msg_ipfix_buffer_alloc(dummy, 1500);
+    ASSERT_NE(buffer, nullptr);
+    msg = ipx_msg_ipfix_create(dummy, &msg_ctx, buffer, 1500);
+    ASSERT_NE(msg, nullptr);
+    ipx_msg_ipfix_destroy(msg);
+    ipx_ctx_destroy(dummy);
+}
+
+// Messages that refer to a shared buffer must keep it until all of them are destroyed
+TEST_F(MsgPool, rawBufferShared)
+{
+    const uint16_t msg_size = 1000;
+    uint8_t *buffer = ipx_msg_ipfix_buffer_alloc(ctx, 4 * msg_size);
+    ASSERT_NE(buffer, nullptr);
+    memset(buffer, 0xAB, 4 * msg_size);
+
+    struct ipx_msg_ctx msg_ctx;
+    memset(&msg_ctx, 0, sizeof(msg_ctx));
+    std::vector<ipx_msg_ipfix_t *> msgs;
+    for (uint16_t i = 0; i < 4; ++i) {
+        uint8_t *msg_data = &buffer[i * msg_size];
+        ipx_msg_ipfix_t *msg = ipx_msg_ipfix_create_ref(ctx, &msg_ctx, buffer, msg_data, msg_size);
+        ASSERT_NE(msg, nullptr);
+        EXPECT_EQ(ipx_msg_ipfix_get_packet(msg), msg_data);
+        msgs.push_back(msg);
+    }
+
+    // Release the reference of the creator and all messages except the last one
+    ipx_msg_ipfix_buffer_free(ctx, buffer);
+    for (size_t i = 0; i < msgs.size() - 1; ++i) {
+        ipx_msg_ipfix_destroy(msgs[i]);
+    }
+    uint8_t *buffer_new = ipx_msg_ipfix_buffer_alloc(ctx, 4 * msg_size);
+    ASSERT_NE(buffer_new, nullptr);
+    EXPECT_NE(buffer_new, buffer);
+    EXPECT_EQ(ipx_msg_ipfix_get_packet(msgs.back())[0], 0xAB);
+
+    // The last message returns the buffer
+    ipx_msg_ipfix_destroy(msgs.back());
+    ipx_msg_ipfix_buffer_free(ctx, buffer_new);
+    uint8_t *first = ipx_msg_ipfix_buffer_alloc(ctx, 4 * msg_size);
+    uint8_t *second = ipx_msg_ipfix_buffer_alloc(ctx, 4 * msg_size);
+    EXPECT_TRUE(first == buffer || second == buffer);
+    ipx_msg_ipfix_buffer_free(ctx, first);
+    ipx_msg_ipfix_buffer_free(ctx, second);
+
+    // Buffers of a dummy context cannot be shared, messages get their own copy
+    ipx_ctx_t *dummy = ipx_ctx_create("dummy", nullptr);
+    ASSERT_NE(dummy, nullptr);
+    buffer = ipx_msg_ipfix_buffer_alloc(dummy, 2 * msg_size);
+    ASSERT_NE(buffer, nullptr);
+    memset(buffer, 0xCD, 2 * msg_size);
+    ipx_msg_ipfix_t *msg = ipx_msg_ipfix_create_ref(dummy, &msg_ctx, buffer, &buffer[msg_size],
+        msg_size);
+    ASSERT_NE(msg, nullptr);
+    EXPECT_NE(ipx_msg_ipfix_get_packet(msg), &buffer[msg_size]);
+    EXPECT_EQ(ipx_msg_ipfix_get_packet(msg)[msg_size - 1], 0xCD);
+    ipx_msg_ipfix_buffer_free(dummy, buffer);
+    ipx_msg_ipfix_destroy(msg);
+    ipx_ctx_destroy(dummy);
+}
+
+// Messages created by the owner and destroyed by other threads, some of them after the pool
+TEST_F(MsgPool, crossThread)
+{
+    const unsigned int threads_cnt = 4;
+    const unsigned int rounds = 200;
+    const unsigned int batch = 64;
+
+    for (unsigned int round = 0; round < rounds; ++round) {
+        std::vector<std::vector<ipx_msg_ipfix_t *>> msgs(threads_cnt);
+        for (auto &vec : msgs) {
+            for (unsigned int i = 0; i < batch; ++i) {
+                // Mix of different size classes
+                ipx_msg_ipfix_t *msg = msg_create(ctx, (i % 2) ? 1500 : 65000);
+                ASSERT_NE(msg, nullptr);
+                vec.push_back(msg);
+            }
+        }
+
+        std::vector<std::thread> threads;
+        for (auto &vec : msgs) {
+            threads.emplace_back([&vec]() {
+                for (auto msg : vec) {
+                    ipx_msg_ipfix_destroy(msg);
+                }
+            });
+        }
+        for (auto &thread : threads) {
+            thread.join();
+        }
+    }
+
+    // Destroy the pool while some messages are still in use
+    std::vector<ipx_msg_ipfix_t *> alive;
+    for (unsigned int i = 0; i < batch; ++i) {
+        ipx_msg_ipfix_t *msg = msg_create(ctx, 1500);
+        ASSERT_NE(msg, nullptr);
+        alive.push_back(msg);
+    }
+
+    ipx_ctx_destroy(ctx);
+    ctx = nullptr;
+
+    std::thread late([&alive]() {
+        for (auto msg : alive) {
+            ipx_msg_ipfix_destroy(msg);
+        }
+    });
+    late.join();
+}
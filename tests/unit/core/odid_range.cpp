@@ -0,0 +1,72 @@
+#include <gtest/gtest.h>
+#include <cstdint>
+
+extern "C" {
+#include <core/odid_range.h>
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+/** Test fixture with an empty ODID range filter */
+class ORange : public ::testing::Test {
+protected:
+    ipx_orange_t *range = nullptr;
+
+    void SetUp() override {
+        range = ipx_orange_create();
+        ASSERT_NE(range, nullptr);
+    }
+
+    void TearDown() override {
+        ipx_orange_destroy(range);
+    }
+};
+
+// Values and intervals
+TEST_F(ORange, simple)
+{
+    ASSERT_EQ(ipx_orange_parse(range, "1-5, 7, 10-"), IPX_OK);
+    for (uint32_t odid = 0; odid < 20; ++odid) {
+        bool expected = (odid >= 1 && odid <= 5) || odid == 7 || odid >= 10;
+        EXPECT_EQ(ipx_orange_in(range, odid), expected) << "ODID: " << odid;
+    }
+    EXPECT_TRUE(ipx_orange_in(range, UINT32_MAX));
+}
+
+// Overlapping, adjacent and unsorted nodes must be merged
+TEST_F(ORange, merged)
+{
+    ASSERT_EQ(ipx_orange_parse(range, "20-30, 8, 1-3, 4, 25-40, 6-7, 41, 100"), IPX_OK);
+    for (uint32_t odid = 0; odid < 120; ++odid) {
+        bool expected = (odid >= 1 && odid <= 4) || (odid >= 6 && odid <= 8)
+            || (odid >= 20 && odid <= 41) || odid == 100;
+        EXPECT_EQ(ipx_orange_in(range, odid), expected) << "ODID: " << odid;
+    }
+}
+
+// Boundaries of the ODID space
+TEST_F(ORange, boundaries)
+{
+    ASSERT_EQ(ipx_orange_parse(range, "-10, 4294967290-, 4294967295"), IPX_OK);
+    EXPECT_TRUE(ipx_orange_in(range, 0));
+    EXPECT_TRUE(ipx_orange_in(range, 10));
+    EXPECT_FALSE(ipx_orange_in(range, 11));
+    EXPECT_FALSE(ipx_orange_in(range, 4294967289U));
+    EXPECT_TRUE(ipx_orange_in(range, 4294967290U));
+    EXPECT_TRUE(ipx_orange_in(range, UINT32_MAX));
+}
+
+// Malformed expressions
+TEST_F(ORange, malformed)
+{
+    EXPECT_EQ(ipx_orange_parse(range, ""), IPX_ERR_FORMAT);
+    EXPECT_EQ(ipx_orange_parse(range, "-"), IPX_ERR_FORMAT);
+    EXPECT_EQ(ipx_orange_parse(range, "5-1"), IPX_ERR_FORMAT);
+    EXPECT_EQ(ipx_orange_parse(range, "1, x"), IPX_ERR_FORMAT);
+    EXPECT_EQ(ipx_orange_parse(range, "4294967296"), IPX_ERR_FORMAT);
+    EXPECT_FALSE(ipx_orange_in(range, 1));
+}
@@ -0,0 +1,339 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <vector>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include <ipfixcol2.h>
+
+extern "C" {
+#include <core/context.h>
+#include <core/ring.h>
+#include <core/message_base.h>
+#include <core/odid_range.h>
+#include <core/plugin_output_mgr.h>
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+static void
+garbage_cb(void *data)
+{
+    (void) data;
+}
+
+/**
+ * Test fixture with an output manager connected to output ring buffers
+ *
+ * The manager is not running in a thread, its callbacks are called directly. Output
+ * instances are simulated by reading their ring buffers.
+ */
+class OutputMgr : public ::testing::TestWithParam<enum ipx_ring_type> {
+protected:
+    static const uint32_t RING_SIZE = 64;
+
+    enum ipx_ring_type type_old;
+    ipx_ctx_t *ctx = nullptr;
+    ipx_output_mgr_list_t *list = nullptr;
+    std::vector<ipx_ring_t *> rings;
+    std::vector<ipx_orange_t *> filters;
+    struct ipx_session *session = nullptr;
+
+    void SetUp() override {
+        type_old = ipx_ring_type_get();
+        ipx_ring_type_set(GetParam());
+
+        ctx = ipx_ctx_create("output manager", nullptr);
+        list = ipx_output_mgr_list_create();
+        ASSERT_NE(ctx, nullptr);
+        ASSERT_NE(list, nullptr);
+
+        struct ipx_session_net net;
+        memset(&net, 0, sizeof(net));
+        net.l3_proto = AF_INET;
+        session = ipx_session_new_tcp(&net);
+        ASSERT_NE(session, nullptr);
+    }
+
+    void TearDown() override {
+        for (auto ring : rings) {
+            drain(ring);
+        }
+        if (list) {
+            ipx_output_mgr_list_destroy(list);
+        }
+        for (auto ring : rings) {
+            ipx_ring_destroy(ring);
+        }
+        for (auto filter : filters) {
+            ipx_orange_destroy(filter);
+        }
+        if (ctx) {
+            ipx_ctx_destroy(ctx);
+        }
+        if (session) {
+            ipx_session_destroy(session);
+        }
+        ipx_ring_type_set(type_old);
+    }
+
+    /** Add a destination with its own ring buffer (and an optional ODID filter) */
+    ipx_ring_t *
+    dest_add(enum ipx_overflow_policy overflow,
+        enum ipx_odid_filter_type type = IPX_ODID_FILTER_NONE, const char *expr = nullptr) {
+        ipx_orange_t *filter = nullptr;
+        if (type != IPX_ODID_FILTER_NONE) {
+            filter = ipx_orange_create();
+            if (!filter) {
+                return nullptr;
+            }
+            filters.push_back(filter);
+            if (ipx_orange_parse(filter, expr) != IPX_OK) {
+                return nullptr;
+            }
+        }
+
+        ipx_ring_t *ring = ipx_ring_init(RING_SIZE, false);
+        if (!ring) {
+            return nullptr;
+        }
+
+        rings.push_back(ring);
+        if (ipx_output_mgr_list_add(list, ring, type, filter, overflow, "output") != IPX_OK) {
+            return nullptr;
+        }
+        return ring;
+    }
+
+    /** Pass an IPFIX Message and return indexes of destinations that received it */
+    std::vector<size_t>
+    route(uint32_t odid) {
+        std::vector<size_t> dests;
+        ipx_msg_t *msg = ipfix_create(odid);
+        EXPECT_NE(msg, nullptr);
+        EXPECT_EQ(ipx_plugin_output_mgr_process(ctx, list, msg), IPX_OK);
+
+        for (size_t i = 0; i < rings.size(); ++i) {
+            ipx_msg_t *recv;
+            while (ipx_ring_pop_batch_timed(rings[i], &recv, 1, 0) == 1) {
+                EXPECT_EQ(recv, msg);
+                dests.push_back(i);
+                // The message is shared by all destinations
+                if (ipx_msg_header_cnt_dec(recv)) {
+                    ipx_msg_destroy(recv);
+                }
+            }
+        }
+        return dests;
+    }
+
+    /** Create an IPFIX Message (without any records) */
+    ipx_msg_t *
+    ipfix_create(uint32_t odid) {
+        struct ipx_msg_ctx msg_ctx;
+        memset(&msg_ctx, 0, sizeof(msg_ctx));
+        msg_ctx.session = session;
+        msg_ctx.odid = odid;
+
+        const uint16_t size = 16;
+        uint8_t *data = static_cast<uint8_t *>(calloc(1, size));
+        if (!data) {
+            return nullptr;
+        }
+
+        ipx_msg_ipfix_t *msg = ipx_msg_ipfix_create(ctx, &msg_ctx, data, size);
+        if (!msg) {
+            free(data);
+            return nullptr;
+        }
+        return ipx_msg_ipfix2base(msg);
+    }
+
+    /** Read all messages from a ring buffer (without waiting) and destroy them */
+    static std::vector<enum ipx_msg_type>
+    drain(ipx_ring_t *ring) {
+        std::vector<enum ipx_msg_type> types;
+        ipx_msg_t *msg;
+        while (ipx_ring_pop_batch_timed(ring, &msg, 1, 0) == 1) {
+            types.push_back(ipx_msg_get_type(msg));
+            ipx_msg_destroy(msg);
+        }
+        return types;
+    }
+};
+
+INSTANTIATE_TEST_CASE_P(Types, OutputMgr, ::testing::Values(IPX_RING_MUTEX, IPX_RING_LOCKFREE));
+
+// Other messages than IPFIX Messages must not block the manager if IPFIX Messages fill the backlog
+TEST_P(OutputMgr, backlogReserve)
+{
+    ipx_ring_t *ring = dest_add(IPX_OVERFLOW_DROP_OLDEST);
+    ASSERT_NE(ring, nullptr);
+    void *cfg = list;
+
+    // Fill the ring buffer and the backlog (the output instance doesn't read anything)
+    const unsigned int ipfix_cnt = 2000;
+    for (unsigned int i = 0; i < ipfix_cnt; ++i) {
+        ipx_msg_t *msg = ipfix_create(1);
+        ASSERT_NE(msg, nullptr);
+        ASSERT_EQ(ipx_plugin_output_mgr_process(ctx, cfg, msg), IPX_OK);
+    }
+
+    uint64_t dropped_msgs, dropped_recs;
+    ASSERT_EQ(ipx_output_mgr_list_dropped(list, 0, &dropped_msgs, &dropped_recs), IPX_OK);
+    EXPECT_GT(dropped_msgs, 0U);
+    EXPECT_EQ(dropped_recs, 0U);
+
+    // The reserved space of the backlog is used (the call would block otherwise)
+    const unsigned int garbage_cnt = 10;
+    for (unsigned int i = 0; i < garbage_cnt; ++i) {
+        ipx_msg_garbage_t *msg = ipx_msg_garbage_create(nullptr, &garbage_cb);
+        ASSERT_NE(msg, nullptr);
+        ASSERT_EQ(ipx_plugin_output_mgr_process(ctx, cfg, ipx_msg_garbage2base(msg)), IPX_OK);
+    }
+
+    // The output instance catches up, the backlog is flushed even if no message arrives
+    unsigned int recv_ipfix = 0;
+    unsigned int recv_garbage = 0;
+    for (unsigned int round = 0; round < 1000 && recv_garbage < garbage_cnt; ++round) {
+        for (auto type : drain(ring)) {
+            if (type == IPX_MSG_IPFIX) {
+                EXPECT_EQ(recv_garbage, 0U) << "IPFIX Message overtook a garbage message";
+                recv_ipfix++;
+            } else {
+                ASSERT_EQ(type, IPX_MSG_GARBAGE);
+                recv_garbage++;
+            }
+        }
+        ipx_plugin_output_mgr_idle(ctx, cfg);
+    }
+
+    EXPECT_EQ(recv_garbage, garbage_cnt);
+    ASSERT_EQ(ipx_output_mgr_list_dropped(list, 0, &dropped_msgs, &dropped_recs), IPX_OK);
+    EXPECT_EQ(recv_ipfix + dropped_msgs, ipfix_cnt);
+}
+
+// Messages waiting in the backlog are delivered by the idle callback
+TEST_P(OutputMgr, idleFlush)
+{
+    ipx_ring_t *ring = dest_add(IPX_OVERFLOW_DROP_NEWEST);
+    ASSERT_NE(ring, nullptr);
+    void *cfg = list;
+
+    // Fill the ring buffer with IPFIX Messages, the rest is dropped
+    const unsigned int ipfix_cnt = 4 * RING_SIZE;
+    for (unsigned int i = 0; i < ipfix_cnt; ++i) {
+        ipx_msg_t *msg = ipfix_create(1);
+        ASSERT_NE(msg, nullptr);
+        ASSERT_EQ(ipx_plugin_output_mgr_process(ctx, cfg, msg), IPX_OK);
+    }
+
+    // A garbage message is never dropped, it waits in the backlog
+    ipx_msg_garbage_t *garbage = ipx_msg_garbage_create(nullptr, &garbage_cb);
+    ASSERT_NE(garbage, nullptr);
+    ASSERT_EQ(ipx_plugin_output_mgr_process(ctx, cfg, ipx_msg_garbage2base(garbage)), IPX_OK);
+
+    std::vector<enum ipx_msg_type> types = drain(ring);
+    ASSERT_FALSE(types.empty());
+    EXPECT_EQ(std::count(types.begin(), types.end(), IPX_MSG_GARBAGE), 0);
+
+    // No other message arrives, however, the garbage message must be delivered
+    ipx_plugin_output_mgr_idle(ctx, cfg);
+    types = drain(ring);
+    ASSERT_EQ(types.size(), 1U);
+    EXPECT_EQ(types[0], IPX_MSG_GARBAGE);
+
+    uint64_t dropped_msgs, dropped_recs;
+    ASSERT_EQ(ipx_output_mgr_list_dropped(list, 0, &dropped_msgs, &dropped_recs), IPX_OK);
+    EXPECT_GT(dropped_msgs, 0U);
+}
+
+// Routes of ODIDs must be cached and more than 64 destinations must be supported
+TEST_P(OutputMgr, routingCache)
+{
+    // Destination 0 receives everything, destination "i" only ODID "i", the last one all except
+    // ODIDs 1-10
+    const size_t dest_cnt = 100;
+    ASSERT_NE(dest_add(IPX_OVERFLOW_BLOCK), nullptr);
+    for (size_t i = 1; i < dest_cnt - 1; ++i) {
+        std::string expr = std::to_string(i);
+        ASSERT_NE(dest_add(IPX_OVERFLOW_BLOCK, IPX_ODID_FILTER_ONLY, expr.c_str()), nullptr);
+    }
+    ASSERT_NE(dest_add(IPX_OVERFLOW_BLOCK, IPX_ODID_FILTER_EXCEPT, "1-10"), nullptr);
+
+    size_t odids, routes;
+    ipx_output_mgr_list_cached(list, &odids, &routes);
+    EXPECT_EQ(odids, 0U);
+    EXPECT_EQ(routes, 0U);
+
+    // ODIDs with and without own destination (all fit into the ring buffers)
+    std::vector<uint32_t> odid_list;
+    for (uint32_t odid = 0; odid < 30; ++odid) {
+        odid_list.push_back(odid);
+        odid_list.push_back(odid + 1000);
+    }
+
+    for (unsigned int round = 0; round < 3; ++round) {
+        for (uint32_t odid : odid_list) {
+            ipx_msg_t *msg = ipfix_create(odid);
+            ASSERT_NE(msg, nullptr);
+            ASSERT_EQ(ipx_plugin_output_mgr_process(ctx, list, msg), IPX_OK);
+        }
+
+        // Check ODIDs received by each destination
+        for (size_t i = 0; i < dest_cnt; ++i) {
+            std::vector<uint32_t> exp;
+            for (uint32_t odid : odid_list) {
+                if (i == 0 || odid == i || (i == dest_cnt - 1 && (odid < 1 || odid > 10))) {
+                    exp.push_back(odid);
+                }
+            }
+
+            std::vector<uint32_t> recv;
+            ipx_msg_t *msg;
+            while (ipx_ring_pop_batch_timed(rings[i], &msg, 1, 0) == 1) {
+                recv.push_back(ipx_msg_ipfix_get_ctx(ipx_msg_base2ipfix(msg))->odid);
+                // The message is shared by all destinations
+                if (ipx_msg_header_cnt_dec(msg)) {
+                    ipx_msg_destroy(msg);
+                }
+            }
+            EXPECT_EQ(recv, exp) << "Destination " << i << " (round " << round << ")";
+        }
+
+        // Repeated ODIDs are served from the cache, ODIDs without own destination share a route
+        ipx_output_mgr_list_cached(list, &odids, &routes);
+        EXPECT_EQ(odids, odid_list.size());
+        EXPECT_EQ(routes, 30U);
+    }
+}
+
+// Adding a destination must invalidate cached routes
+TEST_P(OutputMgr, routingCacheInvalidation)
+{
+    ASSERT_NE(dest_add(IPX_OVERFLOW_BLOCK, IPX_ODID_FILTER_ONLY, "1-5"), nullptr);
+    EXPECT_EQ(route(1), std::vector<size_t>({0}));
+    EXPECT_EQ(route(6), std::vector<size_t>());
+
+    size_t odids, routes;
+    ipx_output_mgr_list_cached(list, &odids, &routes);
+    EXPECT_EQ(odids, 2U);
+    EXPECT_EQ(routes, 2U);
+
+    ASSERT_NE(dest_add(IPX_OVERFLOW_BLOCK, IPX_ODID_FILTER_EXCEPT, "1"), nullptr);
+    ipx_output_mgr_list_cached(list, &odids, &routes);
+    EXPECT_EQ(odids, 0U);
+    EXPECT_EQ(routes, 0U);
+
+    EXPECT_EQ(route(1), std::vector<size_t>({0}));
+    EXPECT_EQ(route(2), std::vector<size_t>({0, 1}));
+    EXPECT_EQ(route(6), std::vector<size_t>({1}));
+    ipx_output_mgr_list_cached(list, &odids, &routes);
+    EXPECT_EQ(odids, 3U);
+    EXPECT_EQ(routes, 3U);
+}
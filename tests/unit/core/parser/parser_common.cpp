@@ -1,4 +1,7 @@
 #include <gtest/gtest.h>
+#include <algorithm>
+#include <vector>
+#include <cstring>
 #include <MsgGen.h>
 #include <ipfixcol2/session.h>
 
@@ -161,5 +164,245 @@ TEST_P(Common, simple)
     ipx_msg_ipfix_destroy(ipfix_msg);
 }
 
+// Fixed-length templates (with padding) and a variable-length template must match the iterator
+TEST_P(Common, fixedLengthSets)
+{
+    ipfix_trec trec_fixed(256);
+    trec_fixed.add_field(8, 4);  // SRC IPv4 address
+    trec_fixed.add_field(12, 4); // DST IPv4 address
+    trec_fixed.add_field(1, 8);  // bytes
+    ipfix_trec trec_var(257);
+    trec_var.add_field(1, 8);    // bytes
+    trec_var.add_field(82, ipfix_trec::SIZE_VAR); // interfaceName
+    ipfix_trec trec_late(258);
+    trec_late.add_field(2, 4);   // packets
+    trec_late.add_field(4, 1);   // protocolIdentifier
+
+    ipfix_set set_tmplts(2);
+    set_tmplts.add_rec(trec_fixed);
+    set_tmplts.add_rec(trec_var);
+    ipfix_set set_tmplts_late(2);
+    set_tmplts_late.add_rec(trec_late);
+
+    // Fixed-length records followed by padding shorter than a record
+    ipfix_set set_fixed(256);
+    for (uint64_t i = 0; i < 5; ++i) {
+        ipfix_drec drec;
+        drec.append_ip("127.0.0.1");
+        drec.append_ip("127.0.0.2");
+        drec.append_uint(i, 8);
+        set_fixed.add_rec(drec);
+    }
+    set_fixed.add_padding(3);
+
+    ipfix_set set_var(257);
+    for (uint64_t i = 0; i < 3; ++i) {
+        ipfix_drec drec;
+        drec.append_uint(i, 8);
+        drec.append_string(std::string(i + 1, 'x'));
+        set_var.add_rec(drec);
+    }
+
+    // Template defined in the middle of the message (the snapshot must be refreshed)
+    ipfix_set set_late(258);
+    for (uint64_t i = 0; i < 7; ++i) {
+        ipfix_drec drec;
+        drec.append_uint(i, 4);
+        drec.append_uint(6, 1);
+        set_late.add_rec(drec);
+    }
+
+    ipfix_msg msg;
+    msg.add_set(set_tmplts);
+    msg.add_set(set_fixed);
+    msg.add_set(set_var);
+    msg.add_set(set_fixed);
+    msg.add_set(set_tmplts_late);
+    msg.add_set(set_late);
+
+    struct ipx_msg_ctx msg_ctx = {session, 1, 0};
+    uint16_t msg_size = msg.size();
+    uint8_t *msg_data = reinterpret_cast<uint8_t *>(msg.release());
+    ipx_msg_ipfix_t *ipfix_msg = ipx_msg_ipfix_create(ctx, &msg_ctx, msg_data, msg_size);
+    ASSERT_NE(ipfix_msg, nullptr);
+
+    ipx_msg_garbage *garbage;
+    ASSERT_EQ(ipx_parser_process(parser, &ipfix_msg, &garbage), IPX_OK);
+    ASSERT_EQ(ipx_msg_ipfix_get_drec_cnt(ipfix_msg), 5U + 3U + 5U + 7U);
+
+    // Compare positions of records with the generic Data Set iterator
+    struct ipx_ipfix_set *sets;
+    size_t sets_cnt;
+    ipx_msg_ipfix_get_sets(ipfix_msg, &sets, &sets_cnt);
+    ASSERT_EQ(sets_cnt, 6U);
+
+    uint32_t rec_idx = 0;
+    for (size_t i = 0; i < sets_cnt; ++i) {
+        struct fds_ipfix_set_hdr *set_hdr = sets[i].ptr;
+        if (ntohs(set_hdr->flowset_id) < FDS_IPFIX_SET_MIN_DSET) {
+            continue;
+        }
+
+        ipx_ipfix_record *first = ipx_msg_ipfix_get_drec(ipfix_msg, rec_idx);
+        ASSERT_NE(first, nullptr);
+        ASSERT_EQ(first->rec.tmplt->id, ntohs(set_hdr->flowset_id));
+
+        struct fds_dset_iter iter;
+        fds_dset_iter_init(&iter, set_hdr, first->rec.tmplt);
+        while (fds_dset_iter_next(&iter) == FDS_OK) {
+            ipx_ipfix_record *rec = ipx_msg_ipfix_get_drec(ipfix_msg, rec_idx++);
+            ASSERT_NE(rec, nullptr);
+            EXPECT_EQ(rec->rec.data, iter.rec);
+            EXPECT_EQ(rec->rec.size, iter.size);
+            EXPECT_EQ(rec->rec.tmplt, first->rec.tmplt);
+            EXPECT_NE(rec->rec.snap, nullptr);
+        }
+    }
+    EXPECT_EQ(rec_idx, ipx_msg_ipfix_get_drec_cnt(ipfix_msg));
+
+    // Values of the last fixed-length record
+    ipx_ipfix_record *rec = ipx_msg_ipfix_get_drec(ipfix_msg, 5U + 3U + 4U);
+    ASSERT_NE(rec, nullptr);
+    fds_drec_field field;
+    uint64_t value;
+    ASSERT_GE(fds_drec_find(&rec->rec, 0, 1, &field), 0); // bytes
+    ASSERT_EQ(fds_get_uint_be(field.data, field.size, &value), FDS_OK);
+    EXPECT_EQ(value, 4U);
+
+    if (garbage) {
+        ipx_msg_garbage_destroy(garbage);
+    }
+    ipx_msg_ipfix_destroy(ipfix_msg);
+}
+
+
+// Max message (65000 records in one message)...
+
+// ------------------------------------------------------------------------------------------------
+
+/** Process an IPFIX Message without any Sets and return the result of the parser */
+static int
+process_empty(ipx_parser_t *parser, const ipx_ctx_t *ctx, const ipx_session *session,
+    uint32_t odid)
+{
+    ipfix_msg msg;
+    msg.set_odid(odid);
+    struct ipx_msg_ctx msg_ctx = {session, odid, 0};
+    uint16_t msg_size = msg.size();
+    uint8_t *msg_data = reinterpret_cast<uint8_t *>(msg.release());
+    ipx_msg_ipfix_t *ipfix_msg = ipx_msg_ipfix_create(ctx, &msg_ctx, msg_data, msg_size);
+    if (!ipfix_msg) {
+        free(msg_data);
+        return IPX_ERR_NOMEM;
+    }
+
+    ipx_msg_garbage *garbage;
+    int rc = ipx_parser_process(parser, &ipfix_msg, &garbage);
+    if (rc == IPX_OK && garbage != nullptr) {
+        ipx_msg_garbage_destroy(garbage);
+    }
+    ipx_msg_ipfix_destroy(ipfix_msg);
+    return rc;
+}
+
+/** Callback of ipx_parser_session_for(), removes every second Transport Session */
+static void
+session_for_cb(ipx_parser_t *parser, const struct ipx_session *ts, void *data)
+{
+    auto visited = static_cast<std::vector<const struct ipx_session *> *>(data);
+    if (visited->size() % 2 == 0) {
+        ipx_msg_garbage *garbage;
+        EXPECT_EQ(ipx_parser_session_remove(parser, ts, &garbage), IPX_OK);
+        if (garbage) {
+            ipx_msg_garbage_destroy(garbage);
+        }
+    }
+    visited->push_back(ts);
+}
+
+// Many Transport Sessions with multiple ODIDs, blocking, removal and iteration over sessions
+TEST(Sessions, manySessions)
+{
+    const uint32_t sessions_cnt = 2000;
+    const uint32_t odid_cnt = 3;
+
+    ipx_parser_t *parser = ipx_parser_create("Sessions (parser)", IPX_VERB_ERROR);
+    ipx_ctx_t *ctx = ipx_ctx_create("Sessions", nullptr);
+    fds_iemgr_t *iemgr = fds_iemgr_create();
+    ASSERT_NE(parser, nullptr);
+    ASSERT_NE(ctx, nullptr);
+    ASSERT_NE(iemgr, nullptr);
+
+    ipx_msg_garbage *garbage;
+    ASSERT_EQ(ipx_parser_ie_source(parser, iemgr, &garbage), IPX_OK);
+    if (garbage) {
+        ipx_msg_garbage_destroy(garbage);
+    }
 
-// Max message (65000 records in one message)...
\ No newline at end of file
+    std::vector<struct ipx_session *> sessions;
+    for (uint32_t i = 0; i < sessions_cnt; ++i) {
+        ipx_session_net net_cfg;
+        memset(&net_cfg, 0, sizeof(net_cfg));
+        net_cfg.l3_proto = AF_INET;
+        net_cfg.port_src = static_cast<uint16_t>(1024 + i);
+        net_cfg.port_dst = 4739;
+        ASSERT_EQ(inet_pton(AF_INET, "192.168.0.2", &net_cfg.addr_src.ipv4), 1);
+        ASSERT_EQ(inet_pton(AF_INET, "192.168.0.1", &net_cfg.addr_dst.ipv4), 1);
+        struct ipx_session *session = ipx_session_new_udp(&net_cfg, 0, 0);
+        ASSERT_NE(session, nullptr);
+        sessions.push_back(session);
+    }
+
+    // Interleaved messages of all combinations
+    for (uint32_t odid = 0; odid < odid_cnt; ++odid) {
+        for (auto session : sessions) {
+            ASSERT_EQ(process_empty(parser, ctx, session, odid), IPX_OK);
+        }
+    }
+
+    // Block every third session (all its ODIDs), remove every fifth session
+    for (uint32_t i = 0; i < sessions_cnt; ++i) {
+        if (i % 3 == 0) {
+            EXPECT_EQ(ipx_parser_session_block(parser, sessions[i]), IPX_OK);
+        }
+        if (i % 5 == 0) {
+            ASSERT_EQ(ipx_parser_session_remove(parser, sessions[i], &garbage), IPX_OK);
+            ASSERT_NE(garbage, nullptr);
+            ipx_msg_garbage_destroy(garbage);
+            EXPECT_EQ(ipx_parser_session_remove(parser, sessions[i], &garbage),
+                IPX_ERR_NOTFOUND);
+            EXPECT_EQ(ipx_parser_session_block(parser, sessions[i]), IPX_ERR_NOTFOUND);
+        }
+    }
+
+    for (uint32_t odid = 0; odid < odid_cnt; ++odid) {
+        for (uint32_t i = 0; i < sessions_cnt; ++i) {
+            // Removed sessions are accepted as new ones
+            int rc_exp = (i % 3 == 0 && i % 5 != 0) ? IPX_ERR_DENIED : IPX_OK;
+            EXPECT_EQ(process_empty(parser, ctx, sessions[i], odid), rc_exp);
+        }
+    }
+
+    // Each session must be visited exactly once, even if the callback removes it
+    std::vector<const struct ipx_session *> visited;
+    ipx_parser_session_for(parser, &session_for_cb, &visited);
+    std::sort(visited.begin(), visited.end());
+    EXPECT_EQ(visited.size(), sessions_cnt);
+    EXPECT_EQ(std::unique(visited.begin(), visited.end()), visited.end());
+
+    // Sessions visited as second, fourth, etc. must remain in the parser
+    size_t remaining = 0;
+    for (auto session : sessions) {
+        if (ipx_parser_session_block(parser, session) == IPX_OK) {
+            remaining++;
+        }
+    }
+    EXPECT_EQ(remaining, sessions_cnt / 2);
+
+    ipx_parser_destroy(parser);
+    for (auto session : sessions) {
+        ipx_session_destroy(session);
+    }
+    ipx_ctx_destroy(ctx);
+    fds_iemgr_destroy(iemgr);
+}
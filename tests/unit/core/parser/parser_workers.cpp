@@ -0,0 +1,321 @@
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+#include <map>
+#include <tuple>
+#include <cstring>
+#include <MsgGen.h>
+#include <ipfixcol2/session.h>
+
+extern "C" {
+    #include <core/context.h>
+    #include <core/ring.h>
+    #include <core/message_base.h>
+    #include <core/message_terminate.h>
+    #include <core/plugin_dispatcher.h>
+    #include <core/plugin_parser.h>
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+// Callbacks of parser workers (the same as used by the configurator)
+static const struct ipx_ctx_callbacks parser_cbs = {
+    nullptr, &ipx_plugin_parser_info, &ipx_plugin_parser_init, &ipx_plugin_parser_destroy,
+    nullptr, &ipx_plugin_parser_process, nullptr, nullptr, &ipx_plugin_parser_idle
+};
+
+// Callbacks of the dispatcher of parser workers
+static const struct ipx_ctx_callbacks disp_cbs = {
+    nullptr, &ipx_plugin_dispatcher_info, &ipx_plugin_dispatcher_init,
+    &ipx_plugin_dispatcher_destroy, nullptr, &ipx_plugin_dispatcher_process, nullptr,
+    &ipx_plugin_dispatcher_process_batch, nullptr
+};
+
+/**
+ * Test fixture with a dispatcher and multiple parser workers
+ *
+ * Parameters: the ring buffer implementation and the number of workers
+ */
+class Workers : public ::testing::TestWithParam<std::tuple<enum ipx_ring_type, unsigned int>> {
+protected:
+    static const uint16_t TMPLT_ID = 256;
+
+    enum ipx_ring_type type_old;
+    fds_iemgr_t *iemgr = nullptr;
+    ipx_ring_t *ring_in = nullptr;
+    ipx_ring_t *ring_out = nullptr;
+    ipx_ctx_t *disp = nullptr;
+    ipx_dispatcher_list_t *list = nullptr;
+    ipx_ctx_replicas_t *shared = nullptr;
+    std::vector<ipx_ring_t *> rings;
+    std::vector<ipx_ctx_t *> workers;
+    std::vector<struct ipx_session *> sessions;
+
+    void SetUp() override {
+        type_old = ipx_ring_type_get();
+        ipx_ring_type_set(std::get<0>(GetParam()));
+
+        iemgr = fds_iemgr_create();
+        ring_in = ipx_ring_init(64, false);
+        ring_out = ipx_ring_init(64, true);
+        disp = ipx_ctx_create("dispatcher", &disp_cbs);
+        list = ipx_dispatcher_list_create();
+        shared = ipx_ctx_replicas_create();
+        ASSERT_NE(iemgr, nullptr);
+        ASSERT_NE(ring_in, nullptr);
+        ASSERT_NE(ring_out, nullptr);
+        ASSERT_NE(disp, nullptr);
+        ASSERT_NE(list, nullptr);
+        ASSERT_NE(shared, nullptr);
+        ASSERT_EQ(fds_iemgr_read_file(iemgr, "data/iana_part.xml", false), FDS_OK);
+
+        for (unsigned int i = 0; i < std::get<1>(GetParam()); ++i) {
+            // Small ring buffers make the dispatcher wait for the workers
+            ipx_ring_t *ring = ipx_ring_init(16, false);
+            ipx_ctx_t *ctx = ipx_ctx_create("parser", &parser_cbs);
+            ASSERT_NE(ring, nullptr);
+            ASSERT_NE(ctx, nullptr);
+            rings.push_back(ring);
+            workers.push_back(ctx);
+
+            ASSERT_EQ(ipx_dispatcher_list_add(list, ring), IPX_OK);
+            ipx_ctx_ring_src_set(ctx, ring);
+            ipx_ctx_ring_dst_set(ctx, ring_out);
+            ipx_ctx_replica_set(ctx, shared);
+            ipx_ctx_iemgr_set(ctx, iemgr);
+            ipx_ctx_verb_set(ctx, IPX_VERB_ERROR);
+            ASSERT_EQ(ipx_ctx_init(ctx, nullptr), IPX_OK);
+        }
+
+        ipx_ctx_ring_src_set(disp, ring_in);
+        ipx_ctx_iemgr_set(disp, iemgr);
+        ipx_ctx_private_set(disp, list);
+        ASSERT_EQ(ipx_ctx_init(disp, nullptr), IPX_OK);
+    }
+
+    void TearDown() override {
+        // Contexts first (threads are joined)
+        if (disp) {
+            ipx_ctx_destroy(disp);
+        }
+        for (auto ctx : workers) {
+            ipx_ctx_destroy(ctx);
+        }
+        for (auto ring : rings) {
+            ipx_ring_destroy(ring);
+        }
+        if (list) {
+            ipx_dispatcher_list_destroy(list);
+        }
+        if (shared) {
+            ipx_ctx_replicas_destroy(shared);
+        }
+        if (ring_out) {
+            // Garbage of workers passed during destruction
+            ipx_msg_t *msg;
+            while (ipx_ring_pop_batch_timed(ring_out, &msg, 1, 0) == 1) {
+                ipx_msg_destroy(msg);
+            }
+            ipx_ring_destroy(ring_out);
+        }
+        if (ring_in) {
+            ipx_ring_destroy(ring_in);
+        }
+        for (auto session : sessions) {
+            ipx_session_destroy(session);
+        }
+        if (iemgr) {
+            fds_iemgr_destroy(iemgr);
+        }
+        ipx_ring_type_set(type_old);
+    }
+
+    /** Create a new TCP Transport Session */
+    struct ipx_session *
+    session_create(uint16_t port) {
+        struct ipx_session_net net;
+        memset(&net, 0, sizeof(net));
+        net.l3_proto = AF_INET;
+        net.port_src = port;
+        net.port_dst = 4739;
+        struct ipx_session *session = ipx_session_new_tcp(&net);
+        if (session) {
+            sessions.push_back(session);
+        }
+        return session;
+    }
+
+    /**
+     * Create an IPFIX Message with one Data Record (and optionally with a Template)
+     *
+     * The Data Record consists of the ODID, a sequence number of the record in the stream and
+     * a unique identification of the message.
+     */
+    ipx_msg_t *
+    ipfix_create(const struct ipx_session *session, uint32_t odid, uint32_t seq, uint32_t id,
+        bool with_tmplt) {
+        ipfix_msg msg;
+        msg.set_odid(odid);
+        msg.set_seq(seq);
+
+        if (with_tmplt) {
+            ipfix_trec trec(TMPLT_ID);
+            trec.add_field(1, 4); // bytes
+            trec.add_field(2, 4); // packets
+            trec.add_field(3, 4); // flows
+            ipfix_set set_tmplts(2);
+            set_tmplts.add_rec(trec);
+            msg.add_set(set_tmplts);
+        }
+
+        ipfix_drec drec;
+        drec.append_uint(odid, 4);
+        drec.append_uint(seq, 4);
+        drec.append_uint(id, 4);
+        ipfix_set set_data(TMPLT_ID);
+        set_data.add_rec(drec);
+        msg.add_set(set_data);
+
+        struct ipx_msg_ctx msg_ctx = {session, odid, 0};
+        uint16_t msg_size = msg.size();
+        uint8_t *msg_data = reinterpret_cast<uint8_t *>(msg.release());
+        ipx_msg_ipfix_t *ipfix = ipx_msg_ipfix_create(disp, &msg_ctx, msg_data, msg_size);
+        if (!ipfix) {
+            free(msg_data);
+            return nullptr;
+        }
+        return ipx_msg_ipfix2base(ipfix);
+    }
+};
+
+INSTANTIATE_TEST_CASE_P(Parser, Workers, ::testing::Combine(
+    ::testing::Values(IPX_RING_MUTEX, IPX_RING_LOCKFREE), ::testing::Values(1U, 2U, 4U)));
+
+/** Get an unsigned value of a field of the first Data Record in an IPFIX Message */
+static uint64_t
+drec_uint(ipx_msg_ipfix_t *ipfix, uint16_t id)
+{
+    struct ipx_ipfix_record *rec = ipx_msg_ipfix_get_drec(ipfix, 0);
+    struct fds_drec_field field;
+    uint64_t value = UINT64_MAX;
+    if (rec != nullptr && fds_drec_find(&rec->rec, 0, id, &field) >= 0) {
+        fds_get_uint_be(field.data, field.size, &value);
+    }
+    return value;
+}
+
+// Records of each stream must be parsed and passed in order and before the end of its session
+TEST_P(Workers, streamOrder)
+{
+    const unsigned int session_cnt = 8;
+    const uint32_t odid_cnt = 4;
+    const unsigned int rounds = 500;
+
+    // Prepare all messages in advance
+    std::vector<ipx_msg_t *> input;
+    std::map<const struct ipx_session *, size_t> session_ids;
+    for (unsigned int s = 0; s < session_cnt; ++s) {
+        struct ipx_session *session = session_create(60000 + s);
+        ASSERT_NE(session, nullptr);
+        session_ids[session] = s;
+    }
+
+    // The first message of each stream also defines the template
+    std::vector<uint32_t> seq(session_cnt * odid_cnt, 0);
+    for (unsigned int r = 0; r < rounds; ++r) {
+        for (unsigned int i = 0; i < session_cnt * odid_cnt; ++i) {
+            const unsigned int s = (i + r) % session_cnt;
+            const uint32_t odid = (i / session_cnt + r) % odid_cnt;
+            const size_t stream = s * odid_cnt + odid;
+            ipx_msg_t *msg = ipfix_create(sessions[s], odid, seq[stream], input.size(),
+                seq[stream] == 0);
+            ASSERT_NE(msg, nullptr);
+            input.push_back(msg);
+            seq[stream]++;
+        }
+    }
+
+    std::vector<ipx_msg_t *> closes;
+    for (auto session : sessions) {
+        ipx_msg_session_t *msg = ipx_msg_session_create(session, IPX_MSG_SESSION_CLOSE);
+        ASSERT_NE(msg, nullptr);
+        closes.push_back(ipx_msg_session2base(msg));
+        input.push_back(closes.back());
+    }
+
+    for (auto ctx : workers) {
+        ASSERT_EQ(ipx_ctx_run(ctx), IPX_OK);
+    }
+    ASSERT_EQ(ipx_ctx_run(disp), IPX_OK);
+
+    std::thread writer([this, &input]() {
+        for (auto msg : input) {
+            ipx_ring_push(ring_in, msg);
+        }
+        ipx_msg_terminate_t *term = ipx_msg_terminate_create(IPX_MSG_TERMINATE_INSTANCE);
+        ipx_ring_push(ring_in, ipx_msg_terminate2base(term));
+    });
+
+    // Read all messages until the termination message
+    const unsigned int ipfix_total = rounds * session_cnt * odid_cnt;
+    unsigned int ipfix_cnt = 0;
+    unsigned int close_cnt = 0;
+    std::vector<bool> closed(session_cnt, false);
+    std::vector<uint32_t> next(session_cnt * odid_cnt, 0);
+    while (true) {
+        ipx_msg_t *msg = ipx_ring_pop(ring_out);
+        enum ipx_msg_type type = ipx_msg_get_type(msg);
+        if (type == IPX_MSG_TERMINATE) {
+            ipx_msg_terminate_destroy(ipx_msg_base2terminate(msg));
+            break;
+        }
+
+        if (type == IPX_MSG_GARBAGE) {
+            // Records of the closed sessions are freed after the session messages
+            EXPECT_GT(close_cnt, 0U);
+            ipx_msg_destroy(msg);
+            continue;
+        }
+
+        if (type == IPX_MSG_SESSION) {
+            ipx_msg_session_t *session_msg = ipx_msg_base2session(msg);
+            auto it = session_ids.find(ipx_msg_session_get_session(session_msg));
+            ASSERT_NE(it, session_ids.end());
+            EXPECT_FALSE(closed[it->second]);
+            closed[it->second] = true;
+            close_cnt++;
+            continue; // Destroyed at the end of the test
+        }
+
+        ASSERT_EQ(type, IPX_MSG_IPFIX);
+        ipx_msg_ipfix_t *ipfix = ipx_msg_base2ipfix(msg);
+        const struct ipx_msg_ctx *msg_ctx = ipx_msg_ipfix_get_ctx(ipfix);
+        auto it = session_ids.find(msg_ctx->session);
+        ASSERT_NE(it, session_ids.end());
+        EXPECT_FALSE(closed[it->second]) << "IPFIX Message passed after the end of its session";
+
+        // Each worker must know templates of all streams it receives
+        ASSERT_EQ(ipx_msg_ipfix_get_drec_cnt(ipfix), 1U);
+        const size_t stream = it->second * odid_cnt + msg_ctx->odid;
+        EXPECT_EQ(drec_uint(ipfix, 1), msg_ctx->odid);
+        EXPECT_EQ(drec_uint(ipfix, 2), next[stream]);
+        next[stream]++;
+        ipfix_cnt++;
+        ipx_msg_ipfix_destroy(ipfix);
+    }
+    writer.join();
+
+    EXPECT_EQ(ipfix_cnt, ipfix_total);
+    EXPECT_EQ(close_cnt, session_cnt);
+    for (size_t stream = 0; stream < next.size(); ++stream) {
+        EXPECT_EQ(next[stream], seq[stream]);
+    }
+
+    for (auto msg : closes) {
+        ipx_msg_destroy(msg);
+    }
+}
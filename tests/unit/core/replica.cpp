@@ -0,0 +1,271 @@
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+#include <map>
+#include <tuple>
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+#include <libfds.h>
+#include <ipfixcol2.h>
+
+extern "C" {
+#include <core/context.h>
+#include <core/ring.h>
+#include <core/message_base.h>
+#include <core/message_terminate.h>
+#include <core/plugin_dispatcher.h>
+}
+
+#include "tools/FakePlugin.h"
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+// Callbacks of the replica dispatcher (with and without batch processing)
+static const struct ipx_ctx_callbacks disp_cbs = {
+    nullptr, &ipx_plugin_dispatcher_info, &ipx_plugin_dispatcher_init,
+    &ipx_plugin_dispatcher_destroy, nullptr, &ipx_plugin_dispatcher_process, nullptr, nullptr,
+    nullptr
+};
+
+static const struct ipx_ctx_callbacks disp_batch_cbs = {
+    nullptr, &ipx_plugin_dispatcher_info, &ipx_plugin_dispatcher_init,
+    &ipx_plugin_dispatcher_destroy, nullptr, &ipx_plugin_dispatcher_process, nullptr,
+    &ipx_plugin_dispatcher_process_batch, nullptr
+};
+
+static void
+garbage_cb(void *data)
+{
+    (void) data;
+}
+
+/**
+ * Test fixture with a dispatcher and replicas of the fake plugin
+ *
+ * Parameters: the ring buffer implementation and batch processing of the dispatcher
+ */
+class Replica : public ::testing::TestWithParam<std::tuple<enum ipx_ring_type, bool>> {
+protected:
+    static const unsigned int REPLICAS = 4;
+
+    enum ipx_ring_type type_old;
+    fds_iemgr_t *iemgr = nullptr;
+    ipx_ring_t *ring_in = nullptr;
+    ipx_ring_t *ring_out = nullptr;
+    ipx_ctx_t *disp = nullptr;
+    ipx_dispatcher_list_t *list = nullptr;
+    ipx_ctx_replicas_t *shared = nullptr;
+    std::vector<ipx_ring_t *> rings;
+    std::vector<ipx_ctx_t *> replicas;
+    struct ipx_session *session = nullptr;
+
+    void SetUp() override {
+        type_old = ipx_ring_type_get();
+        ipx_ring_type_set(std::get<0>(GetParam()));
+        const struct ipx_ctx_callbacks *cbs = std::get<1>(GetParam()) ? &disp_batch_cbs : &disp_cbs;
+
+        iemgr = fds_iemgr_create();
+        ring_in = ipx_ring_init(64, false);
+        ring_out = ipx_ring_init(64, true);
+        disp = ipx_ctx_create("dispatcher", cbs);
+        list = ipx_dispatcher_list_create();
+        shared = ipx_ctx_replicas_create();
+        ASSERT_NE(iemgr, nullptr);
+        ASSERT_NE(ring_in, nullptr);
+        ASSERT_NE(ring_out, nullptr);
+        ASSERT_NE(disp, nullptr);
+        ASSERT_NE(list, nullptr);
+        ASSERT_NE(shared, nullptr);
+
+        for (unsigned int i = 0; i < REPLICAS; ++i) {
+            // Small ring buffers make the dispatcher wait for the replicas
+            ipx_ring_t *ring = ipx_ring_init(16, false);
+            ipx_ctx_t *ctx = ipx_ctx_create("replica", &fake_inter_cbs);
+            ASSERT_NE(ring, nullptr);
+            ASSERT_NE(ctx, nullptr);
+            rings.push_back(ring);
+            replicas.push_back(ctx);
+
+            ASSERT_EQ(ipx_dispatcher_list_add(list, ring), IPX_OK);
+            ipx_ctx_ring_src_set(ctx, ring);
+            ipx_ctx_ring_dst_set(ctx, ring_out);
+            ipx_ctx_replica_set(ctx, shared);
+            ipx_ctx_iemgr_set(ctx, iemgr);
+            ASSERT_EQ(ipx_ctx_init(ctx, nullptr), IPX_OK);
+        }
+
+        ipx_ctx_ring_src_set(disp, ring_in);
+        ipx_ctx_iemgr_set(disp, iemgr);
+        ipx_ctx_private_set(disp, list);
+        ASSERT_EQ(ipx_ctx_init(disp, nullptr), IPX_OK);
+
+        struct ipx_session_net net;
+        memset(&net, 0, sizeof(net));
+        net.l3_proto = AF_INET;
+        session = ipx_session_new_tcp(&net);
+        ASSERT_NE(session, nullptr);
+    }
+
+    void TearDown() override {
+        // Contexts first (threads are joined)
+        if (disp) {
+            ipx_ctx_destroy(disp);
+        }
+        for (auto ctx : replicas) {
+            ipx_ctx_destroy(ctx);
+        }
+        for (auto ring : rings) {
+            ipx_ring_destroy(ring);
+        }
+        if (list) {
+            ipx_dispatcher_list_destroy(list);
+        }
+        if (shared) {
+            ipx_ctx_replicas_destroy(shared);
+        }
+        if (ring_out) {
+            ipx_ring_destroy(ring_out);
+        }
+        if (ring_in) {
+            ipx_ring_destroy(ring_in);
+        }
+        if (session) {
+            ipx_session_destroy(session);
+        }
+        if (iemgr) {
+            fds_iemgr_destroy(iemgr);
+        }
+        ipx_ring_type_set(type_old);
+    }
+
+    /** Create an IPFIX Message of a stream (the stream determines the replica) */
+    ipx_msg_t *
+    ipfix_create(uint32_t odid) {
+        struct ipx_msg_ctx msg_ctx;
+        memset(&msg_ctx, 0, sizeof(msg_ctx));
+        msg_ctx.session = session;
+        msg_ctx.odid = odid;
+
+        const uint16_t size = 16;
+        uint8_t *data = static_cast<uint8_t *>(calloc(1, size));
+        if (!data) {
+            return nullptr;
+        }
+
+        ipx_msg_ipfix_t *msg = ipx_msg_ipfix_create(disp, &msg_ctx, data, size);
+        if (!msg) {
+            free(data);
+            return nullptr;
+        }
+        return ipx_msg_ipfix2base(msg);
+    }
+};
+
+INSTANTIATE_TEST_CASE_P(Types, Replica, ::testing::Combine(
+    ::testing::Values(IPX_RING_MUTEX, IPX_RING_LOCKFREE), ::testing::Bool()));
+
+// Shared messages must not be reordered with respect to IPFIX Messages of any replica
+TEST_P(Replica, sharedOrder)
+{
+    const unsigned int cnt = 20000;
+    const uint32_t streams = 16;
+
+    // Prepare all messages in advance (each pointer identifies a position in the input)
+    std::vector<ipx_msg_t *> input;
+    std::vector<bool> is_shared;
+    std::vector<uint32_t> odids;
+    std::map<ipx_msg_t *, size_t> positions;
+    for (unsigned int i = 0; i < cnt; ++i) {
+        ipx_msg_t *msg;
+        uint32_t odid = 0;
+        if (i % 50 == 25) {
+            msg = ipx_msg_garbage2base(ipx_msg_garbage_create(&input, &garbage_cb));
+        } else if (i % 50 == 49) {
+            msg = ipx_msg_session2base(ipx_msg_session_create(session, IPX_MSG_SESSION_OPEN));
+        } else {
+            odid = rand() % streams;
+            msg = ipfix_create(odid);
+        }
+        ASSERT_NE(msg, nullptr);
+        positions[msg] = input.size();
+        input.push_back(msg);
+        is_shared.push_back(ipx_msg_get_type(msg) != IPX_MSG_IPFIX);
+        odids.push_back(odid);
+    }
+
+    for (auto ctx : replicas) {
+        ASSERT_EQ(ipx_ctx_run(ctx), IPX_OK);
+    }
+    ASSERT_EQ(ipx_ctx_run(disp), IPX_OK);
+
+    std::thread writer([this, &input]() {
+        for (auto msg : input) {
+            ipx_ring_push(ring_in, msg);
+        }
+        ipx_msg_terminate_t *term = ipx_msg_terminate_create(IPX_MSG_TERMINATE_INSTANCE);
+        ipx_ring_push(ring_in, ipx_msg_terminate2base(term));
+    });
+
+    // Read all messages until the termination message
+    std::vector<size_t> output;
+    while (true) {
+        ipx_msg_t *msg = ipx_ring_pop(ring_out);
+        if (ipx_msg_get_type(msg) == IPX_MSG_TERMINATE) {
+            ipx_msg_terminate_destroy(ipx_msg_base2terminate(msg));
+            break;
+        }
+
+        auto it = positions.find(msg);
+        ASSERT_NE(it, positions.end());
+        output.push_back(it->second);
+    }
+    writer.join();
+
+    // Each message must be passed exactly once
+    ASSERT_EQ(output.size(), input.size());
+    std::vector<size_t> pos_out(input.size(), SIZE_MAX);
+    for (size_t i = 0; i < output.size(); ++i) {
+        ASSERT_EQ(pos_out[output[i]], SIZE_MAX);
+        pos_out[output[i]] = i;
+    }
+
+    // Messages of the same stream must be in the original order
+    std::vector<size_t> last(streams, SIZE_MAX);
+    for (size_t idx : output) {
+        if (is_shared[idx]) {
+            continue;
+        }
+        const uint32_t odid = odids[idx];
+        EXPECT_TRUE(last[odid] == SIZE_MAX || last[odid] < idx);
+        last[odid] = idx;
+    }
+
+    // Shared messages must follow all preceding messages and precede all following messages
+    std::vector<size_t> prefix_max(input.size());
+    std::vector<size_t> suffix_min(input.size());
+    for (size_t i = 0; i < input.size(); ++i) {
+        prefix_max[i] = (i == 0) ? pos_out[i] : std::max(prefix_max[i - 1], pos_out[i]);
+    }
+    for (size_t i = input.size(); i-- > 0;) {
+        suffix_min[i] = (i + 1 == input.size()) ? pos_out[i] : std::min(suffix_min[i + 1],
+            pos_out[i]);
+    }
+    for (size_t i = 1; i + 1 < input.size(); ++i) {
+        if (!is_shared[i]) {
+            continue;
+        }
+        EXPECT_LT(prefix_max[i - 1], pos_out[i]) << "shared message " << i << " overtook data";
+        EXPECT_GT(suffix_min[i + 1], pos_out[i]) << "data overtook shared message " << i;
+    }
+
+    for (auto msg : input) {
+        ipx_msg_destroy(msg);
+    }
+}
@@ -0,0 +1,356 @@
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+
+extern "C" {
+#include <core/ring.h>
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+/** Convert a sequence number to a fake message pointer (messages are never dereferenced) */
+static ipx_msg_t *
+num2msg(uintptr_t value)
+{
+    return reinterpret_cast<ipx_msg_t *>(value + 1);
+}
+
+/** Convert a fake message pointer back to a sequence number */
+static uintptr_t
+msg2num(ipx_msg_t *msg)
+{
+    return reinterpret_cast<uintptr_t>(msg) - 1;
+}
+
+/** Test fixture parametrized by the ring implementation */
+class Ring : public ::testing::TestWithParam<enum ipx_ring_type> {
+protected:
+    enum ipx_ring_type type_old;
+
+    void SetUp() override {
+        type_old = ipx_ring_type_get();
+        ipx_ring_type_set(GetParam());
+    }
+
+    void TearDown() override {
+        ipx_ring_type_set(type_old);
+    }
+};
+
+INSTANTIATE_TEST_CASE_P(Types, Ring, ::testing::Values(IPX_RING_MUTEX, IPX_RING_LOCKFREE));
+
+// Single thread, messages must be returned in the same order
+TEST_P(Ring, singleThread)
+{
+    const uint32_t size = 256;
+    ipx_ring_t *ring = ipx_ring_init(size, false);
+    ASSERT_NE(ring, nullptr);
+
+    uintptr_t next_write = 0;
+    uintptr_t next_read = 0;
+    for (int round = 0; round < 4; ++round) {
+        // Fill a half of the buffer and read it back
+        for (uint32_t i = 0; i < size / 2; ++i) {
+            ipx_ring_push(ring, num2msg(next_write++));
+        }
+        for (uint32_t i = 0; i < size / 2; ++i) {
+            EXPECT_EQ(msg2num(ipx_ring_pop(ring)), next_read++);
+        }
+    }
+
+    ipx_ring_destroy(ring);
+}
+
+// Single writer and single reader, the writer is faster than the reader (small buffer)
+TEST_P(Ring, singleWriter)
+{
+    const uintptr_t cnt = 1000000;
+    ipx_ring_t *ring = ipx_ring_init(128, false);
+    ASSERT_NE(ring, nullptr);
+
+    std::thread writer([ring, cnt]() {
+        for (uintptr_t i = 0; i < cnt; ++i) {
+            ipx_ring_push(ring, num2msg(i));
+        }
+    });
+
+    for (uintptr_t i = 0; i < cnt; ++i) {
+        ASSERT_EQ(msg2num(ipx_ring_pop(ring)), i);
+    }
+
+    writer.join();
+    ipx_ring_destroy(ring);
+}
+
+// Multiple writers and single reader, messages of each writer must preserve order
+TEST_P(Ring, multiWriter)
+{
+    const unsigned int writers_cnt = 4;
+    const uintptr_t cnt = 250000;
+    ipx_ring_t *ring = ipx_ring_init(128, true);
+    ASSERT_NE(ring, nullptr);
+
+    std::vector<std::thread> writers;
+    for (uintptr_t id = 0; id < writers_cnt; ++id) {
+        writers.emplace_back([ring, cnt, id]() {
+            for (uintptr_t i = 0; i < cnt; ++i) {
+                ipx_ring_push(ring, num2msg((i << 8) | id));
+            }
+        });
+    }
+
+    std::vector<uintptr_t> expected(writers_cnt, 0);
+    for (uintptr_t i = 0; i < writers_cnt * cnt; ++i) {
+        uintptr_t value = msg2num(ipx_ring_pop(ring));
+        uintptr_t id = value & 0xFF;
+        ASSERT_LT(id, writers_cnt);
+        ASSERT_EQ(value >> 8, expected[id]);
+        expected[id]++;
+    }
+
+    for (auto &writer : writers) {
+        writer.join();
+    }
+
+    ipx_ring_destroy(ring);
+}
+
+// Writer that produces messages occasionally must always wake up a sleeping reader
+TEST_P(Ring, slowWriter)
+{
+    const uintptr_t cnt = 200;
+    ipx_ring_t *ring = ipx_ring_init(128, false);
+    ASSERT_NE(ring, nullptr);
+
+    std::thread writer([ring, cnt]() {
+        for (uintptr_t i = 0; i < cnt; ++i) {
+            if (i % 10 == 0) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(2));
+            }
+            ipx_ring_push(ring, num2msg(i));
+        }
+    });
+
+    for (uintptr_t i = 0; i < cnt; ++i) {
+        ASSERT_EQ(msg2num(ipx_ring_pop(ring)), i);
+    }
+
+    writer.join();
+    ipx_ring_destroy(ring);
+}
+
+// Batch operations in a single thread, the order of messages must be preserved
+TEST_P(Ring, batchSingleThread)
+{
+    const uint32_t size = 256;
+    ipx_ring_t *ring = ipx_ring_init(size, false);
+    ASSERT_NE(ring, nullptr);
+
+    std::vector<ipx_msg_t *> msgs(size / 2);
+    uintptr_t next_write = 0;
+    uintptr_t next_read = 0;
+    for (int round = 0; round < 4; ++round) {
+        for (auto &msg : msgs) {
+            msg = num2msg(next_write++);
+        }
+        ipx_ring_push_batch(ring, msgs.data(), msgs.size());
+
+        // Read all messages using small batches
+        uint32_t remains = size / 2;
+        while (remains > 0) {
+            ipx_msg_t *batch[7];
+            uint32_t cnt = ipx_ring_pop_batch(ring, batch, 7);
+            ASSERT_GE(cnt, 1U);
+            ASSERT_LE(cnt, std::min<uint32_t>(7U, remains));
+            for (uint32_t i = 0; i < cnt; ++i) {
+                EXPECT_EQ(msg2num(batch[i]), next_read++);
+            }
+            remains -= cnt;
+        }
+    }
+
+    // Empty batch must be ignored
+    ipx_ring_push_batch(ring, msgs.data(), 0);
+    ipx_ring_destroy(ring);
+}
+
+// Multiple writers with batches larger than the ring and a single reader
+TEST_P(Ring, batchMultiWriter)
+{
+    const unsigned int writers_cnt = 4;
+    const uintptr_t cnt = 200000;
+    const uintptr_t batch_size = 200;
+    ipx_ring_t *ring = ipx_ring_init(128, true);
+    ASSERT_NE(ring, nullptr);
+
+    std::vector<std::thread> writers;
+    for (uintptr_t id = 0; id < writers_cnt; ++id) {
+        writers.emplace_back([ring, cnt, id, batch_size]() {
+            std::vector<ipx_msg_t *> batch;
+            for (uintptr_t i = 0; i < cnt; ++i) {
+                batch.push_back(num2msg((i << 8) | id));
+                if (batch.size() == batch_size) {
+                    ipx_ring_push_batch(ring, batch.data(), batch.size());
+                    batch.clear();
+                }
+            }
+            ipx_ring_push_batch(ring, batch.data(), batch.size());
+        });
+    }
+
+    std::vector<uintptr_t> expected(writers_cnt, 0);
+    uintptr_t total = 0;
+    while (total < writers_cnt * cnt) {
+        ipx_msg_t *batch[32];
+        uint32_t batch_cnt = ipx_ring_pop_batch(ring, batch, 32);
+        for (uint32_t i = 0; i < batch_cnt; ++i) {
+            uintptr_t value = msg2num(batch[i]);
+            uintptr_t id = value & 0xFF;
+            ASSERT_LT(id, writers_cnt);
+            ASSERT_EQ(value >> 8, expected[id]);
+            expected[id]++;
+        }
+        total += batch_cnt;
+    }
+
+    for (auto &writer : writers) {
+        writer.join();
+    }
+
+    ipx_ring_destroy(ring);
+}
+
+// Non-blocking push must refuse messages only if the buffer is full
+TEST_P(Ring, tryPushFull)
+{
+    const uint32_t size = 256;
+    ipx_ring_t *ring = ipx_ring_init(size, false);
+    ASSERT_NE(ring, nullptr);
+
+    // Fill the buffer
+    uintptr_t next_write = 0;
+    while (ipx_ring_try_push(ring, num2msg(next_write))) {
+        next_write++;
+        ASSERT_LE(next_write, size);
+    }
+    EXPECT_EQ(next_write, size);
+
+    // Release a half of the buffer, at least some space must be available again
+    uintptr_t next_read = 0;
+    for (uint32_t i = 0; i < size / 2; ++i) {
+        ASSERT_EQ(msg2num(ipx_ring_pop(ring)), next_read++);
+    }
+
+    uintptr_t added = 0;
+    while (ipx_ring_try_push(ring, num2msg(next_write))) {
+        next_write++;
+        added++;
+    }
+    EXPECT_GT(added, 0U);
+
+    // All accepted messages must be returned in the same order
+    while (next_read < next_write) {
+        ASSERT_EQ(msg2num(ipx_ring_pop(ring)), next_read++);
+    }
+
+    ipx_ring_destroy(ring);
+}
+
+// Multiple writers combining blocking and non-blocking push, refused messages are skipped
+TEST_P(Ring, tryPushMultiWriter)
+{
+    const unsigned int writers_cnt = 4;
+    const uintptr_t cnt = 100000;
+    ipx_ring_t *ring = ipx_ring_init(64, true);
+    ASSERT_NE(ring, nullptr);
+
+    std::vector<uintptr_t> accepted(writers_cnt, 0);
+    std::vector<std::thread> writers;
+    for (uintptr_t id = 0; id < writers_cnt; ++id) {
+        writers.emplace_back([ring, cnt, id, &accepted]() {
+            uintptr_t seq = 0;
+            for (uintptr_t i = 0; i < cnt; ++i) {
+                ipx_msg_t *msg = num2msg((seq << 8) | id);
+                if (id % 2 == 0) {
+                    ipx_ring_push(ring, msg);
+                } else if (!ipx_ring_try_push(ring, msg)) {
+                    continue; // Refused, the sequence number can be used again
+                }
+                seq++;
+            }
+            // Terminate the writer's stream
+            ipx_ring_push(ring, num2msg((UINTPTR_MAX << 8) | id));
+            accepted[id] = seq;
+        });
+    }
+
+    std::vector<uintptr_t> expected(writers_cnt, 0);
+    unsigned int finished = 0;
+    while (finished < writers_cnt) {
+        uintptr_t value = msg2num(ipx_ring_pop(ring));
+        uintptr_t id = value & 0xFF;
+        ASSERT_LT(id, writers_cnt);
+        if ((value >> 8) == (UINTPTR_MAX >> 8)) {
+            finished++;
+            continue;
+        }
+        ASSERT_EQ(value >> 8, expected[id]);
+        expected[id]++;
+    }
+
+    for (auto &writer : writers) {
+        writer.join();
+    }
+
+    for (uintptr_t id = 0; id < writers_cnt; ++id) {
+        EXPECT_EQ(expected[id], accepted[id]);
+    }
+    EXPECT_EQ(accepted[0], cnt);
+    ipx_ring_destroy(ring);
+}
+
+// Timed reading from an empty buffer must give up and must not lose later messages
+TEST_P(Ring, popTimeout)
+{
+    ipx_ring_t *ring = ipx_ring_init(64, false);
+    ASSERT_NE(ring, nullptr);
+
+    ipx_msg_t *batch[8];
+    auto begin = std::chrono::steady_clock::now();
+    EXPECT_EQ(ipx_ring_pop_batch_timed(ring, batch, 8, 20), 0U);
+    EXPECT_GE(std::chrono::steady_clock::now() - begin, std::chrono::milliseconds(20));
+
+    // A message that arrives while the reader is waiting
+    std::thread writer([ring]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        ipx_ring_push(ring, num2msg(0));
+    });
+
+    uint32_t cnt = 0;
+    while (cnt == 0) {
+        cnt = ipx_ring_pop_batch_timed(ring, batch, 8, 1000);
+    }
+    writer.join();
+    ASSERT_EQ(cnt, 1U);
+    EXPECT_EQ(msg2num(batch[0]), 0U);
+
+    // Timed and blocking reading can be combined
+    for (uintptr_t i = 1; i < 200; ++i) {
+        ipx_ring_push(ring, num2msg(i));
+        if (i % 2 == 0) {
+            ASSERT_EQ(msg2num(ipx_ring_pop(ring)), i);
+            continue;
+        }
+        ASSERT_EQ(ipx_ring_pop_batch_timed(ring, batch, 8, 0), 1U);
+        ASSERT_EQ(msg2num(batch[0]), i);
+        EXPECT_EQ(ipx_ring_pop_batch_timed(ring, batch, 8, 1), 0U);
+    }
+
+    ipx_ring_destroy(ring);
+}
@@ -0,0 +1,266 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <thread>
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <ipfixcol2.h>
+
+extern "C" {
+#include <core/context.h>
+#include <core/message_base.h>
+#include <core/plugin_output_mgr.h>
+#include <core/ring.h>
+#include <core/stats.h>
+}
+
+#include "tools/FakePlugin.h"
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+/** Convert a sequence number to a fake message pointer (messages are never dereferenced) */
+static ipx_msg_t *
+num2msg(uintptr_t value)
+{
+    return reinterpret_cast<ipx_msg_t *>(value + 1);
+}
+
+/** Test fixture with a collector of statistics and one registered instance */
+class Stats : public ::testing::Test {
+protected:
+    ipx_ring_t *ring = nullptr;
+    ipx_ctx_t *ctx = nullptr;
+    ipx_stats_t *stats = nullptr;
+
+    void SetUp() override {
+        ring = ipx_ring_init(256, false);
+        ctx = ipx_ctx_create("stats \"test\"", &fake_inter_cbs);
+        stats = ipx_stats_create();
+        ASSERT_NE(ring, nullptr);
+        ASSERT_NE(ctx, nullptr);
+        ASSERT_NE(stats, nullptr);
+        ASSERT_EQ(ipx_stats_register(stats, ctx, ring), IPX_OK);
+
+        struct ipx_stats_ctx *cnt = ipx_ctx_stats_get(ctx);
+        ipx_stats_cnt_add(&cnt->in.msgs, 5);
+        ipx_stats_cnt_add(&cnt->in.recs, 120);
+        ipx_stats_cnt_add(&cnt->out.msgs, 4);
+        ipx_stats_cnt_add(&cnt->time_ns, 1500000000ULL);
+    }
+
+    void TearDown() override {
+        if (stats) {
+            ipx_stats_destroy(stats);
+        }
+        if (ctx) {
+            ipx_ctx_destroy(ctx);
+        }
+        if (ring) {
+            ipx_ring_destroy(ring);
+        }
+    }
+
+    /** Dump statistics into a string */
+    std::string dump(enum ipx_stats_fmt fmt) {
+        char *buffer = nullptr;
+        size_t size = 0;
+        FILE *out = open_memstream(&buffer, &size);
+        EXPECT_NE(out, nullptr);
+        EXPECT_EQ(ipx_stats_dump(stats, fmt, out), IPX_OK);
+        fclose(out);
+        std::string result(buffer, size);
+        free(buffer);
+        return result;
+    }
+};
+
+// Occupancy and high-water mark of both implementations of ring buffers
+TEST(RingStats, occupancy)
+{
+    enum ipx_ring_type type_old = ipx_ring_type_get();
+    for (auto type : {IPX_RING_MUTEX, IPX_RING_LOCKFREE}) {
+        ipx_ring_type_set(type);
+        ipx_ring_t *ring = ipx_ring_init(256, false);
+        ASSERT_NE(ring, nullptr);
+
+        struct ipx_ring_stats rs;
+        ipx_ring_stats_get(ring, &rs);
+        EXPECT_EQ(rs.size, 256U);
+        EXPECT_EQ(rs.used, 0U);
+        EXPECT_EQ(rs.hwm, 0U);
+
+        for (uintptr_t i = 0; i < 256; ++i) {
+            ipx_ring_push(ring, num2msg(i));
+        }
+        ipx_ring_stats_get(ring, &rs);
+        EXPECT_EQ(rs.used, 256U);
+
+        // The reader releases slots in blocks, therefore, the occupancy is only approximate
+        for (uint32_t i = 0; i < 256; ++i) {
+            ipx_ring_pop(ring);
+        }
+        ipx_ring_stats_get(ring, &rs);
+        EXPECT_LT(rs.used, 256U);
+        EXPECT_GT(rs.hwm, 0U);
+        EXPECT_LE(rs.hwm, 256U);
+
+        ipx_ring_destroy(ring);
+    }
+    ipx_ring_type_set(type_old);
+}
+
+// Prometheus output must contain labeled counters of the instance
+TEST_F(Stats, prometheus)
+{
+    std::string out = dump(IPX_STATS_FMT_PROMETHEUS);
+    const std::string labels = "{instance=\"stats \\\"test\\\"\",plugin=\"fake-inter\"}";
+    EXPECT_NE(out.find("# TYPE ipfixcol2_messages_in_total counter\n"), std::string::npos);
+    EXPECT_NE(out.find("ipfixcol2_messages_in_total" + labels + " 5\n"), std::string::npos);
+    EXPECT_NE(out.find("ipfixcol2_records_in_total" + labels + " 120\n"), std::string::npos);
+    EXPECT_NE(out.find("ipfixcol2_messages_out_total" + labels + " 4\n"), std::string::npos);
+    EXPECT_NE(out.find("ipfixcol2_busy_seconds_total" + labels + " 1.5"), std::string::npos);
+    EXPECT_NE(out.find("ipfixcol2_ring_size" + labels + " 256\n"), std::string::npos);
+    // The instance is not a parser
+    EXPECT_EQ(out.find("ipfixcol2_parser_seq_gaps_total{"), std::string::npos);
+}
+
+// JSON output must contain one object per instance
+TEST_F(Stats, json)
+{
+    std::string out = dump(IPX_STATS_FMT_JSON);
+    EXPECT_EQ(out.find("{\"instances\":[{\"instance\":\"stats \\\"test\\\"\","
+        "\"plugin\":\"fake-inter\""), 0U);
+    EXPECT_NE(out.find("\"messages_in_total\":5,"), std::string::npos);
+    EXPECT_NE(out.find("\"ring_size\":256,"), std::string::npos);
+    EXPECT_EQ(out.substr(out.size() - 3), "]}\n");
+}
+
+// Periodically rewritten file
+TEST_F(Stats, fileEndpoint)
+{
+    char path[] = "/tmp/ipx_stats_XXXXXX";
+    int fd = mkstemp(path);
+    ASSERT_NE(fd, -1);
+    close(fd);
+    unlink(path);
+
+    ASSERT_EQ(ipx_stats_start(stats, path, IPX_STATS_FMT_JSON, 10), IPX_OK);
+    std::string content;
+    for (int i = 0; i < 200 && content.empty(); ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        std::ifstream file(path);
+        std::stringstream ss;
+        ss << file.rdbuf();
+        content = ss.str();
+    }
+
+    ipx_stats_destroy(stats);
+    stats = nullptr;
+    EXPECT_NE(content.find("\"messages_in_total\":5,"), std::string::npos);
+    unlink(path);
+}
+
+// Unix domain socket, each client receives one snapshot
+TEST_F(Stats, socketEndpoint)
+{
+    std::string path = "/tmp/ipx_stats_" + std::to_string(getpid()) + ".sock";
+    std::string endpoint = IPX_STATS_UNIX_PREFIX + path;
+    ASSERT_EQ(ipx_stats_start(stats, endpoint.c_str(), IPX_STATS_FMT_PROMETHEUS, 1000), IPX_OK);
+
+    for (int round = 0; round < 2; ++round) {
+        int sd = socket(AF_UNIX, SOCK_STREAM, 0);
+        ASSERT_NE(sd, -1);
+        struct sockaddr_un addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+        ASSERT_EQ(connect(sd, reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr)), 0);
+
+        std::string content;
+        char buffer[4096];
+        ssize_t len;
+        while ((len = read(sd, buffer, sizeof(buffer))) > 0) {
+            content.append(buffer, static_cast<size_t>(len));
+        }
+        close(sd);
+        EXPECT_NE(content.find("ipfixcol2_records_in_total{"), std::string::npos);
+    }
+
+    ipx_stats_destroy(stats);
+    stats = nullptr;
+    // The socket must be removed
+    EXPECT_NE(access(path.c_str(), F_OK), 0);
+}
+
+// Messages dropped by the output manager are exported only for output instances
+TEST_F(Stats, outputDropped)
+{
+    ipx_ring_t *out_ring = ipx_ring_init(64, false);
+    ipx_ctx_t *out_ctx = ipx_ctx_create("output", &fake_inter_cbs);
+    ipx_output_mgr_list_t *list = ipx_output_mgr_list_create();
+    ASSERT_NE(out_ring, nullptr);
+    ASSERT_NE(out_ctx, nullptr);
+    ASSERT_NE(list, nullptr);
+    ASSERT_EQ(ipx_output_mgr_list_add(list, out_ring, IPX_ODID_FILTER_NONE, nullptr,
+        IPX_OVERFLOW_DROP_NEWEST, "output"), IPX_OK);
+    ASSERT_EQ(ipx_output_mgr_list_size(list), 1U);
+    ASSERT_EQ(ipx_stats_register_output(stats, out_ctx, out_ring, list, 0), IPX_OK);
+
+    struct ipx_session_net net;
+    memset(&net, 0, sizeof(net));
+    net.l3_proto = AF_INET;
+    struct ipx_session *session = ipx_session_new_tcp(&net);
+    ASSERT_NE(session, nullptr);
+
+    // The ring buffer is full after a few messages, the rest is dropped
+    for (int i = 0; i < 256; ++i) {
+        struct ipx_msg_ctx msg_ctx;
+        memset(&msg_ctx, 0, sizeof(msg_ctx));
+        msg_ctx.session = session;
+        uint8_t *data = static_cast<uint8_t *>(calloc(1, 16));
+        ASSERT_NE(data, nullptr);
+        ipx_msg_ipfix_t *msg = ipx_msg_ipfix_create(ctx, &msg_ctx, data, 16);
+        ASSERT_NE(msg, nullptr);
+        ASSERT_EQ(ipx_plugin_output_mgr_process(ctx, list, ipx_msg_ipfix2base(msg)), IPX_OK);
+    }
+
+    uint64_t dropped_msgs, dropped_recs;
+    ASSERT_EQ(ipx_output_mgr_list_dropped(list, 0, &dropped_msgs, &dropped_recs), IPX_OK);
+    EXPECT_GT(dropped_msgs, 0U);
+
+    const std::string labels = "{instance=\"output\",plugin=\"fake-inter\"}";
+    std::string out = dump(IPX_STATS_FMT_PROMETHEUS);
+    EXPECT_NE(out.find("ipfixcol2_output_messages_dropped_total" + labels + " "
+        + std::to_string(dropped_msgs) + "\n"), std::string::npos);
+    EXPECT_NE(out.find("ipfixcol2_output_records_dropped_total" + labels + " 0\n"),
+        std::string::npos);
+    // The first instance is not an output instance
+    EXPECT_EQ(out.find("ipfixcol2_output_messages_dropped_total{instance=\"stats"),
+        std::string::npos);
+
+    out = dump(IPX_STATS_FMT_JSON);
+    EXPECT_NE(out.find("\"output_messages_dropped_total\":" + std::to_string(dropped_msgs)),
+        std::string::npos);
+
+    ipx_stats_destroy(stats);
+    stats = nullptr;
+    ipx_msg_t *msg;
+    while (ipx_ring_pop_batch_timed(out_ring, &msg, 1, 0) == 1) {
+        ipx_msg_destroy(msg);
+    }
+    ipx_output_mgr_list_destroy(list);
+    ipx_ring_destroy(out_ring);
+    ipx_ctx_destroy(out_ctx);
+    ipx_session_destroy(session);
+}
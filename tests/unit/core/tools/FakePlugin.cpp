@@ -0,0 +1,90 @@
+#include <chrono>
+#include <cstdlib>
+#include <thread>
+
+#include "FakePlugin.h"
+
+/** Private data of all instances (only a non-NULL pointer is required) */
+static int instance_data;
+
+static int
+fake_input_init(ipx_ctx_t *ctx, const char *params)
+{
+    (void) params;
+    ipx_ctx_private_set(ctx, &instance_data);
+    return IPX_OK;
+}
+
+static int
+fake_inter_init(ipx_ctx_t *ctx, const char *params)
+{
+    (void) params;
+    const ipx_msg_mask_t mask = IPX_MSG_IPFIX | IPX_MSG_SESSION;
+    if (ipx_ctx_subscribe(ctx, &mask, NULL) != IPX_OK) {
+        return IPX_ERR_DENIED;
+    }
+    ipx_ctx_private_set(ctx, &instance_data);
+    return IPX_OK;
+}
+
+static void
+fake_destroy(ipx_ctx_t *ctx, void *data)
+{
+    (void) ctx;
+    (void) data;
+}
+
+static int
+fake_input_get(ipx_ctx_t *ctx, void *data)
+{
+    (void) ctx;
+    (void) data;
+    return IPX_OK;
+}
+
+static int
+fake_inter_process(ipx_ctx_t *ctx, void *data, ipx_msg_t *msg)
+{
+    (void) data;
+    if (ipx_msg_get_type(msg) == IPX_MSG_IPFIX && rand() % 16 == 0) {
+        // Let other replicas run ahead
+        std::this_thread::sleep_for(std::chrono::microseconds(50));
+    }
+    return ipx_ctx_msg_pass(ctx, msg);
+}
+
+static const struct ipx_plugin_info fake_input_info = {
+    "fake-input", "Fake input plugin", IPX_PT_INPUT, 0, "1.0.0", "2.0.0"
+};
+
+const struct ipx_ctx_callbacks fake_input_cbs = {
+    // Static plugin, no library handles
+    nullptr,
+    &fake_input_info,
+    // Only basic functions
+    &fake_input_init,
+    &fake_destroy,
+    &fake_input_get,
+    nullptr, // No processing function
+    nullptr, // No feedback
+    nullptr, // No batch processing
+    nullptr  // No idle callback
+};
+
+static const struct ipx_plugin_info fake_inter_info = {
+    "fake-inter", "Fake intermediate plugin", IPX_PT_INTERMEDIATE, 0, "1.0.0", "2.0.0"
+};
+
+const struct ipx_ctx_callbacks fake_inter_cbs = {
+    // Static plugin, no library handles
+    nullptr,
+    &fake_inter_info,
+    // Only basic functions
+    &fake_inter_init,
+    &fake_destroy,
+    nullptr, // No getter
+    &fake_inter_process,
+    nullptr, // No feedback
+    nullptr, // No batch processing
+    nullptr  // No idle callback
+};
@@ -0,0 +1,30 @@
+/**
+ * \file tests/unit/core/tools/FakePlugin.h
+ * \brief Fake plugins for tests of plugin contexts (without any library)
+ */
+
+#ifndef IPFIXCOL_FAKEPLUGIN_H
+#define IPFIXCOL_FAKEPLUGIN_H
+
+#include <ipfixcol2.h>
+
+extern "C" {
+#include <core/context.h>
+}
+
+/**
+ * \brief Callbacks of a fake input plugin
+ *
+ * The getter doesn't produce any messages.
+ */
+extern const struct ipx_ctx_callbacks fake_input_cbs;
+
+/**
+ * \brief Callbacks of a fake intermediate plugin
+ *
+ * The plugin subscribes IPFIX and Transport Session messages and passes all of them. Processing
+ * of some IPFIX Messages is randomly delayed to let other replicas of the plugin run ahead.
+ */
+extern const struct ipx_ctx_callbacks fake_inter_cbs;
+
+#endif // IPFIXCOL_FAKEPLUGIN_H
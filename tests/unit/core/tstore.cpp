@@ -0,0 +1,186 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+extern "C" {
+#include <core/tstore.h>
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+/** Template Record with ID 256 and two fields (sourceIPv4Address, destinationIPv4Address) */
+static const uint8_t tmplt_raw[] = {
+    0x01, 0x00, 0x00, 0x02,
+    0x00, 0x08, 0x00, 0x04,
+    0x00, 0x0C, 0x00, 0x04
+};
+
+class Tstore : public ::testing::Test {
+protected:
+    std::string path;
+    struct ipx_session *session = nullptr;
+
+    void SetUp() override {
+        char name[] = "/tmp/ipx_tstore_XXXXXX";
+        int fd = mkstemp(name);
+        ASSERT_NE(fd, -1);
+        close(fd);
+        unlink(name); // The store must handle a missing file
+        path = name;
+
+        struct ipx_session_net net;
+        memset(&net, 0, sizeof(net));
+        net.l3_proto = AF_INET;
+        net.port_src = 65000;
+        net.port_dst = 4739;
+        inet_pton(AF_INET, "192.168.0.1", &net.addr_src.ipv4);
+        inet_pton(AF_INET, "127.0.0.1", &net.addr_dst.ipv4);
+        session = ipx_session_new_udp(&net, 600, 600);
+        ASSERT_NE(session, nullptr);
+    }
+
+    void TearDown() override {
+        ipx_session_destroy(session);
+        unlink(path.c_str());
+    }
+
+    /** Create a Template manager of the session with a template added at the given time */
+    fds_tmgr_t *tmgr_create(uint32_t exp_time, bool with_tmplt) {
+        fds_tmgr_t *tmgr = fds_tmgr_create(FDS_SESSION_UDP);
+        EXPECT_NE(tmgr, nullptr);
+        EXPECT_EQ(fds_tmgr_set_udp_timeouts(tmgr, 600, 600), FDS_OK);
+        EXPECT_EQ(fds_tmgr_set_time(tmgr, exp_time), FDS_OK);
+        if (with_tmplt) {
+            struct fds_template *tmplt;
+            uint16_t len = sizeof(tmplt_raw);
+            EXPECT_EQ(fds_template_parse(FDS_TYPE_TEMPLATE, tmplt_raw, &len, &tmplt), FDS_OK);
+            EXPECT_EQ(fds_tmgr_template_add(tmgr, tmplt), FDS_OK);
+        }
+        return tmgr;
+    }
+
+    /** Check whether the Template manager holds the template */
+    static bool tmplt_present(fds_tmgr_t *tmgr) {
+        const fds_tsnapshot_t *snap;
+        EXPECT_EQ(fds_tmgr_snapshot_get(tmgr, &snap), FDS_OK);
+        const struct fds_template *tmplt = fds_tsnapshot_template_get(snap, 256);
+        return tmplt != nullptr && tmplt->raw.length == sizeof(tmplt_raw)
+            && memcmp(tmplt->raw.data, tmplt_raw, sizeof(tmplt_raw)) == 0;
+    }
+};
+
+// Templates published before restart must be restored after loading of the file
+TEST_F(Tstore, saveAndLoad)
+{
+    ipx_tstore_t *store = ipx_tstore_create("test", path.c_str(), 0);
+    ASSERT_NE(store, nullptr);
+    EXPECT_EQ(ipx_tstore_load(store), IPX_ERR_NOTFOUND);
+
+    fds_tmgr_t *tmgr_old = tmgr_create(1000, true);
+    EXPECT_EQ(ipx_tstore_publish(store, session, 1, tmgr_old), IPX_OK);
+    EXPECT_EQ(ipx_tstore_save(store), IPX_OK);
+    fds_tmgr_destroy(tmgr_old);
+    ipx_tstore_destroy(store);
+
+    store = ipx_tstore_create("test", path.c_str(), 0);
+    ASSERT_NE(store, nullptr);
+    ASSERT_EQ(ipx_tstore_load(store), IPX_OK);
+
+    // Different ODID
+    unsigned int cnt;
+    fds_tmgr_t *tmgr_new = tmgr_create(1100, false);
+    EXPECT_EQ(ipx_tstore_restore(store, session, 2, tmgr_new, 1100, &cnt), IPX_ERR_NOTFOUND);
+    EXPECT_EQ(cnt, 0U);
+
+    // Still valid template
+    EXPECT_EQ(ipx_tstore_restore(store, session, 1, tmgr_new, 1100, &cnt), IPX_OK);
+    EXPECT_EQ(cnt, 1U);
+    EXPECT_TRUE(tmplt_present(tmgr_new));
+    fds_tmgr_destroy(tmgr_new);
+
+    // Expired template (lifetime is 600 seconds)
+    tmgr_new = tmgr_create(1601, false);
+    EXPECT_EQ(ipx_tstore_restore(store, session, 1, tmgr_new, 1601, &cnt), IPX_OK);
+    EXPECT_EQ(cnt, 0U);
+    fds_tmgr_destroy(tmgr_new);
+    ipx_tstore_destroy(store);
+}
+
+// Malformed files must be ignored
+TEST_F(Tstore, malformed)
+{
+    FILE *file = fopen(path.c_str(), "wb");
+    ASSERT_NE(file, nullptr);
+    const char content[] = "IPXT but definitely not a valid template store";
+    ASSERT_EQ(fwrite(content, sizeof(content), 1, file), 1U);
+    fclose(file);
+
+    ipx_tstore_t *store = ipx_tstore_create("test", path.c_str(), 0);
+    ASSERT_NE(store, nullptr);
+    EXPECT_EQ(ipx_tstore_load(store), IPX_ERR_FORMAT);
+
+    unsigned int cnt;
+    fds_tmgr_t *tmgr = tmgr_create(1000, false);
+    EXPECT_EQ(ipx_tstore_restore(store, session, 1, tmgr, 1000, &cnt), IPX_ERR_NOTFOUND);
+    fds_tmgr_destroy(tmgr);
+    ipx_tstore_destroy(store);
+}
+
+// Periodic saving must be performed at most once per interval regardless of the number of callers
+TEST_F(Tstore, savePeriodic)
+{
+    ipx_tstore_t *store = ipx_tstore_create("test", path.c_str(), 1);
+    ASSERT_NE(store, nullptr);
+
+    // Not due yet
+    EXPECT_EQ(ipx_tstore_save_periodic(store), IPX_OK);
+    EXPECT_NE(access(path.c_str(), F_OK), 0);
+
+    // Only the first caller after the interval elapsed saves the store
+    sleep(2);
+    EXPECT_EQ(ipx_tstore_save_periodic(store), IPX_OK);
+    EXPECT_EQ(access(path.c_str(), F_OK), 0);
+    unlink(path.c_str());
+    EXPECT_EQ(ipx_tstore_save_periodic(store), IPX_OK);
+    EXPECT_NE(access(path.c_str(), F_OK), 0);
+    ipx_tstore_destroy(store);
+
+    // Periodic saving is disabled
+    store = ipx_tstore_create("test", path.c_str(), 0);
+    ASSERT_NE(store, nullptr);
+    sleep(1);
+    EXPECT_EQ(ipx_tstore_save_periodic(store), IPX_OK);
+    EXPECT_NE(access(path.c_str(), F_OK), 0);
+    ipx_tstore_destroy(store);
+}
+
+// Sessions with both template lifetimes set to 0 must not be stored
+TEST_F(Tstore, lifetimeZero)
+{
+    struct ipx_session_net net = session->udp.net;
+    struct ipx_session *session_inf = ipx_session_new_udp(&net, 0, 0);
+    ASSERT_NE(session_inf, nullptr);
+
+    ipx_tstore_t *store = ipx_tstore_create("test", path.c_str(), 0);
+    ASSERT_NE(store, nullptr);
+    fds_tmgr_t *tmgr = tmgr_create(1000, true);
+    EXPECT_EQ(ipx_tstore_publish(store, session_inf, 1, tmgr), IPX_OK);
+    fds_tmgr_destroy(tmgr);
+
+    unsigned int cnt;
+    tmgr = tmgr_create(1000, false);
+    EXPECT_EQ(ipx_tstore_restore(store, session_inf, 1, tmgr, 1000, &cnt), IPX_ERR_NOTFOUND);
+    EXPECT_EQ(cnt, 0U);
+    fds_tmgr_destroy(tmgr);
+    ipx_tstore_destroy(store);
+    ipx_session_destroy(session_inf);
+}
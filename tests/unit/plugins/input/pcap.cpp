@@ -0,0 +1,118 @@
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <arpa/inet.h>
+
+#include "tools/InputInstance.h"
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+/**
+ * \brief Configuration of the plugin
+ * \param[in] path Path to the capture file
+ */
+static std::string
+params(const std::string &path)
+{
+    return "<params>"
+        "<path>" + path + "</path>"
+        "<localPort>4739</localPort>"
+        "</params>";
+}
+
+/** Expected IPFIX Message (see data/ipfix.pcap) */
+struct Expected {
+    /** Address family of the exporter */
+    uint8_t l3_proto;
+    /** Source address of the exporter */
+    const char *addr;
+    /** Source port of the exporter */
+    uint16_t port;
+    /** Observation Domain ID */
+    uint32_t odid;
+    /** Content of the message */
+    std::vector<uint8_t> data;
+};
+
+/**
+ * Content of the capture file (Ethernet, pcap with timestamps in microseconds)
+ *
+ * 1. 192.0.2.1:40000      -> 198.51.100.1:4739      IPFIX (100 B)
+ * 2. 192.0.2.2:40001      -> 198.51.100.1:4739      the first fragment of IPFIX (1200 B)
+ * 3. [2001:db8::1]:40002  -> [2001:db8::100]:4739   IPFIX (200 B)
+ * 4. 192.0.2.2            -> 198.51.100.1           the second fragment
+ * 5. 192.0.2.1:53         -> 198.51.100.1:53        DNS (must be ignored)
+ * 6. 192.0.2.2            -> 198.51.100.1           the last fragment
+ * 7. 192.0.2.1:40000      -> 198.51.100.1:4739      IPFIX (300 B)
+ * 8. [2001:db8::1]:40002  -> [2001:db8::100]:4739   IPFIX (400 B)
+ */
+static const char *PCAP_FILE = "data/ipfix.pcap";
+
+// All IPFIX Messages (including the fragmented one) must be passed with the right sessions
+TEST(PcapInput, replay)
+{
+    // The fragmented message is passed after its last fragment
+    const std::vector<Expected> expected = {
+        {AF_INET,  "192.0.2.1",   40000, 1, msg_create(100, 1, 0)},
+        {AF_INET6, "2001:db8::1", 40002, 3, msg_create(200, 3, 2)},
+        {AF_INET,  "192.0.2.2",   40001, 2, msg_create(1200, 2, 1)},
+        {AF_INET,  "192.0.2.1",   40000, 1, msg_create(300, 1, 3)},
+        {AF_INET6, "2001:db8::1", 40002, 3, msg_create(400, 3, 4)}
+    };
+
+    InputInstance instance;
+    ASSERT_EQ(instance.init(params(PCAP_FILE)), IPX_OK);
+    ASSERT_EQ(instance.run(), IPX_OK);
+    EXPECT_EQ(instance.wait_ipfix(expected.size()), expected.size());
+    ASSERT_TRUE(instance.stop());
+
+    const std::vector<const InputMsg *> received = instance.ipfix();
+    ASSERT_EQ(received.size(), expected.size());
+    for (size_t i = 0; i < expected.size(); ++i) {
+        SCOPED_TRACE("message: " + std::to_string(i));
+        const Expected &exp = expected[i];
+        EXPECT_EQ(received[i]->data, exp.data);
+        EXPECT_EQ(received[i]->odid, exp.odid);
+
+        const struct ipx_session_net &net = received[i]->net;
+        uint8_t addr[sizeof(net.addr_src)];
+        memset(addr, 0, sizeof(addr));
+        ASSERT_EQ(inet_pton(exp.l3_proto, exp.addr, addr), 1);
+        EXPECT_EQ(net.l3_proto, exp.l3_proto);
+        EXPECT_EQ(memcmp(&net.addr_src, addr, (exp.l3_proto == AF_INET) ? 4 : 16), 0);
+        EXPECT_EQ(net.port_src, exp.port);
+        EXPECT_EQ(net.port_dst, 4739);
+    }
+
+    // One Transport Session per exporter, all closed at the end of the file
+    const std::vector<InputMsg> &all = instance.msgs();
+    ASSERT_GE(all.size(), 1U);
+    EXPECT_EQ(all[0].type, IPX_MSG_SESSION);
+    EXPECT_EQ(all[0].event, IPX_MSG_SESSION_OPEN);
+    EXPECT_EQ(instance.session_cnt(IPX_MSG_SESSION_OPEN), 3U);
+    EXPECT_EQ(instance.session_cnt(IPX_MSG_SESSION_CLOSE), 3U);
+
+    // No message refers to a Transport Session after it has been closed
+    for (size_t i = 0; i < all.size(); ++i) {
+        if (all[i].type != IPX_MSG_SESSION || all[i].event != IPX_MSG_SESSION_CLOSE) {
+            continue;
+        }
+        for (size_t j = i + 1; j < all.size(); ++j) {
+            EXPECT_FALSE(all[j].type == IPX_MSG_IPFIX && all[j].session == all[i].session);
+        }
+    }
+}
+
+// A missing file must be refused by the constructor
+TEST(PcapInput, noFile)
+{
+    InputInstance instance;
+    EXPECT_NE(instance.init(params("data/missing*.pcap")), IPX_OK);
+}
@@ -0,0 +1,230 @@
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+extern "C" {
+#include <reasm.h>
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+/** Number of datagrams reassembled concurrently */
+static const unsigned int REASM_CNT = 4;
+/** Inactivity timeout */
+static const uint64_t REASM_TIMEOUT = 10;
+
+/**
+ * Test fixture that splits a UDP datagram into IPv4 or IPv6 fragments
+ *
+ * The test is executed for both IP versions (see the parameter).
+ */
+class Reasm : public ::testing::TestWithParam<int> {
+protected:
+    reasm_t *reasm;
+    /** UDP datagram (header + payload) */
+    std::vector<uint8_t> datagram;
+
+    void SetUp() override {
+        reasm = reasm_create(REASM_CNT, REASM_TIMEOUT);
+        ASSERT_NE(reasm, nullptr);
+        datagram = udp_create(4000, 0);
+    }
+
+    void TearDown() override {
+        reasm_destroy(reasm);
+    }
+
+    /**
+     * Create a UDP datagram
+     * \param[in] size Size of the payload
+     * \param[in] seed Value of the first byte of the payload
+     */
+    static std::vector<uint8_t>
+    udp_create(uint16_t size, uint8_t seed) {
+        std::vector<uint8_t> udp(8U + size);
+        const uint16_t udp_len = udp.size();
+        udp[0] = 0x12; udp[1] = 0x34; // Source port 4660
+        udp[2] = 0x11; udp[3] = 0x2B; // Destination port 4395
+        udp[4] = udp_len >> 8; udp[5] = udp_len & 0xFF;
+        for (uint16_t i = 0; i < size; ++i) {
+            udp[8U + i] = (uint8_t) (seed + i * 7);
+        }
+        return udp;
+    }
+
+    /**
+     * Create an IP packet with a fragment of a datagram
+     * \param[in] data   Datagram
+     * \param[in] offset Offset of the fragment
+     * \param[in] size   Size of the fragment
+     * \param[in] more   More fragments follow
+     * \param[in] id     Identification of the datagram
+     */
+    std::vector<uint8_t>
+    frag(const std::vector<uint8_t> &data, uint16_t offset, uint16_t size, bool more,
+        uint16_t id = 0x1234) const {
+        std::vector<uint8_t> pkt;
+        if (GetParam() == AF_INET) {
+            const uint16_t total = 20U + size;
+            const uint16_t flags = (more ? 0x2000U : 0U) | (offset / 8U);
+            pkt = {0x45, 0, (uint8_t) (total >> 8), (uint8_t) total,
+                (uint8_t) (id >> 8), (uint8_t) id, (uint8_t) (flags >> 8), (uint8_t) flags,
+                64, IPPROTO_UDP, 0, 0, 10, 0, 0, 1, 10, 0, 0, 2};
+        } else {
+            const uint16_t payload = 8U + size;
+            const uint16_t flags = offset | (more ? 0x0001U : 0U);
+            pkt.resize(48);
+            pkt[0] = 0x60;
+            pkt[4] = payload >> 8; pkt[5] = payload & 0xFF;
+            pkt[6] = IPPROTO_FRAGMENT; pkt[7] = 64;
+            pkt[8] = 0x20; pkt[9] = 0x01; pkt[23] = 1;  // 2001::1
+            pkt[24] = 0x20; pkt[25] = 0x01; pkt[39] = 2; // 2001::2
+            pkt[40] = IPPROTO_UDP;
+            pkt[42] = flags >> 8; pkt[43] = flags & 0xFF;
+            pkt[46] = id >> 8; pkt[47] = id & 0xFF;
+        }
+
+        pkt.insert(pkt.end(), data.begin() + offset, data.begin() + offset + size);
+        return pkt;
+    }
+
+    /** Add a packet to the reassembly structure */
+    enum reasm_status
+    add(const std::vector<uint8_t> &pkt, uint64_t now = 0) {
+        payload = nullptr;
+        payload_size = 0;
+        return reasm_udp(reasm, pkt.data(), pkt.size(), now, &net, &payload, &payload_size);
+    }
+
+    /** Check that the reassembled payload is the same as the payload of the datagram */
+    void
+    expect_payload(const std::vector<uint8_t> &data) {
+        ASSERT_NE(payload, nullptr);
+        ASSERT_EQ(payload_size, data.size() - 8U);
+        EXPECT_EQ(memcmp(payload, &data[8], payload_size), 0);
+        EXPECT_EQ(net.l3_proto, GetParam());
+        EXPECT_EQ(net.port_src, 4660);
+        EXPECT_EQ(net.port_dst, 4395);
+    }
+
+    struct ipx_session_net net;
+    const uint8_t *payload;
+    uint32_t payload_size;
+};
+
+INSTANTIATE_TEST_CASE_P(IPv4andIPv6, Reasm, ::testing::Values(AF_INET, AF_INET6));
+
+// Fragments received in order
+TEST_P(Reasm, inOrder)
+{
+    EXPECT_EQ(add(frag(datagram, 0, 1480, true)), REASM_MORE);
+    EXPECT_EQ(add(frag(datagram, 1480, 1480, true)), REASM_MORE);
+    EXPECT_EQ(add(frag(datagram, 2960, 1048, false)), REASM_DONE);
+    expect_payload(datagram);
+
+    // The same datagram again (e.g. the identification has wrapped around)
+    EXPECT_EQ(add(frag(datagram, 0, 2000, true)), REASM_MORE);
+    EXPECT_EQ(add(frag(datagram, 2000, 2008, false)), REASM_DONE);
+    expect_payload(datagram);
+}
+
+// Fragments received in reverse order
+TEST_P(Reasm, outOfOrder)
+{
+    EXPECT_EQ(add(frag(datagram, 2960, 1048, false)), REASM_MORE);
+    EXPECT_EQ(add(frag(datagram, 1480, 1480, true)), REASM_MORE);
+    EXPECT_EQ(add(frag(datagram, 0, 1480, true)), REASM_DONE);
+    expect_payload(datagram);
+}
+
+// Fragments that overlap each other
+TEST_P(Reasm, overlapping)
+{
+    EXPECT_EQ(add(frag(datagram, 0, 2000, true)), REASM_MORE);
+    EXPECT_EQ(add(frag(datagram, 1600, 1600, true)), REASM_MORE);
+    EXPECT_EQ(add(frag(datagram, 800, 800, true)), REASM_MORE);
+    EXPECT_EQ(add(frag(datagram, 3200, 808, false)), REASM_DONE);
+    expect_payload(datagram);
+}
+
+// The same fragments received multiple times
+TEST_P(Reasm, duplicate)
+{
+    EXPECT_EQ(add(frag(datagram, 0, 2000, true)), REASM_MORE);
+    EXPECT_EQ(add(frag(datagram, 0, 2000, true)), REASM_MORE);
+    EXPECT_EQ(add(frag(datagram, 2000, 2008, false)), REASM_DONE);
+    expect_payload(datagram);
+
+    // The completed datagram is forgotten, a late duplicate starts a new one
+    EXPECT_EQ(add(frag(datagram, 2000, 2008, false)), REASM_MORE);
+}
+
+// Incomplete datagrams must be dropped after the timeout
+TEST_P(Reasm, timeout)
+{
+    EXPECT_EQ(add(frag(datagram, 0, 2000, true), 100), REASM_MORE);
+    EXPECT_EQ(add(frag(datagram, 2000, 2008, false), 100 + REASM_TIMEOUT + 1), REASM_MORE);
+
+    // The first fragment is required again
+    EXPECT_EQ(add(frag(datagram, 0, 2000, true), 100 + REASM_TIMEOUT + 2), REASM_DONE);
+    expect_payload(datagram);
+
+    // Within the timeout
+    EXPECT_EQ(add(frag(datagram, 0, 2000, true), 200), REASM_MORE);
+    EXPECT_EQ(add(frag(datagram, 2000, 2008, false), 200 + REASM_TIMEOUT), REASM_DONE);
+    expect_payload(datagram);
+}
+
+// Fragments located beyond the end of the last fragment are rejected immediately
+TEST_P(Reasm, beyondLast)
+{
+    EXPECT_EQ(add(frag(datagram, 2000, 1000, false)), REASM_MORE);
+    EXPECT_EQ(add(frag(datagram, 2000, 2008, true)), REASM_INVALID);
+
+    // The datagram has been dropped
+    EXPECT_EQ(add(frag(datagram, 0, 2000, true)), REASM_MORE);
+    EXPECT_EQ(add(frag(datagram, 2000, 2008, false)), REASM_DONE);
+    expect_payload(datagram);
+
+    // The last fragment received after a fragment beyond its end
+    EXPECT_EQ(add(frag(datagram, 2000, 2008, true)), REASM_MORE);
+    EXPECT_EQ(add(frag(datagram, 0, 2000, false)), REASM_INVALID);
+}
+
+// Interleaved datagrams and eviction of the least recently updated one
+TEST_P(Reasm, interleaved)
+{
+    std::vector<std::vector<uint8_t>> datagrams;
+    for (unsigned int i = 0; i <= REASM_CNT; ++i) {
+        datagrams.push_back(udp_create(2000 + i * 16, i));
+    }
+
+    // The first datagram is the least recently updated one when the last one is started
+    for (unsigned int i = 0; i <= REASM_CNT; ++i) {
+        EXPECT_EQ(add(frag(datagrams[i], 0, 1000, true, i)), REASM_MORE);
+    }
+
+    for (unsigned int i = REASM_CNT; i > 0; --i) {
+        const auto &data = datagrams[i];
+        EXPECT_EQ(add(frag(data, 1000, data.size() - 1000, false, i)), REASM_DONE);
+        expect_payload(data);
+    }
+
+    const auto &data = datagrams[0];
+    EXPECT_EQ(add(frag(data, 1000, data.size() - 1000, false, 0)), REASM_MORE);
+}
+
+// Malformed fragments
+TEST_P(Reasm, malformed)
+{
+    // Unaligned size of a fragment that is not the last one
+    EXPECT_EQ(add(frag(datagram, 0, 1001, true)), REASM_INVALID);
+    // Conflicting last fragments
+    EXPECT_EQ(add(frag(datagram, 2000, 2008, false)), REASM_MORE);
+    EXPECT_EQ(add(frag(datagram, 2000, 2000, false)), REASM_INVALID);
+}
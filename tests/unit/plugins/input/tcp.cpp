@@ -0,0 +1,347 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "tools/InputInstance.h"
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+/** Size of a receive buffer of a connection (see RECV_BUFFER_SIZE in tcp.c) */
+static const uint32_t RECV_BUFFER_SIZE = 65536;
+/** Time to wait for messages that must not be passed [milliseconds] */
+static const uint32_t NOTHING_TIMEOUT = 100;
+
+/**
+ * \brief Configuration of the plugin
+ * \param[in] port Local port
+ */
+static std::string
+params(uint16_t port)
+{
+    return "<params>"
+        "<localPort>" + std::to_string(port) + "</localPort>"
+        "<localIPAddress>127.0.0.1</localIPAddress>"
+        "</params>";
+}
+
+/** Concatenate messages into a stream */
+static std::vector<uint8_t>
+stream_create(const std::vector<std::vector<uint8_t>> &msgs)
+{
+    std::vector<uint8_t> stream;
+    for (const auto &msg : msgs) {
+        stream.insert(stream.end(), msg.begin(), msg.end());
+    }
+    return stream;
+}
+
+/** Exporter, i.e. a TCP connection to the collector */
+class Exporter {
+public:
+    /**
+     * \brief Connect to the collector
+     * \param[in] dst Destination port (on 127.0.0.1)
+     */
+    explicit Exporter(uint16_t dst) {
+        sd = socket(AF_INET, SOCK_STREAM, 0);
+        if (sd == -1) {
+            throw std::runtime_error("Failed to create a socket");
+        }
+
+        // Send each part of the stream immediately
+        int on = 1;
+        setsockopt(sd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+
+        struct sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(dst);
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        socklen_t addr_len = sizeof(addr);
+        if (connect(sd, (struct sockaddr *) &addr, addr_len) == -1
+                || getsockname(sd, (struct sockaddr *) &addr, &addr_len) == -1) {
+            close(sd);
+            throw std::runtime_error("Failed to connect to the collector");
+        }
+        port = ntohs(addr.sin_port);
+    }
+
+    ~Exporter() {
+        disconnect();
+    }
+
+    /**
+     * \brief Send a part of the stream
+     * \param[in] data   Stream
+     * \param[in] offset Offset of the part
+     * \param[in] size   Size of the part (everything to the end of the stream by default)
+     */
+    void send(const std::vector<uint8_t> &data, size_t offset = 0, size_t size = SIZE_MAX) const {
+        size = std::min(size, data.size() - offset);
+        while (size > 0) {
+            ssize_t ret = ::send(sd, &data[offset], size, 0);
+            ASSERT_GT(ret, 0);
+            offset += (size_t) ret;
+            size -= (size_t) ret;
+        }
+    }
+
+    /** Close the connection */
+    void disconnect() {
+        if (sd != -1) {
+            close(sd);
+            sd = -1;
+        }
+    }
+
+    /** Socket descriptor */
+    int sd;
+    /** Source port */
+    uint16_t port;
+};
+
+/** Test fixture with one instance of the plugin */
+class TcpInput : public ::testing::Test {
+protected:
+    std::unique_ptr<InputInstance> instance;
+    uint16_t port;
+
+    void SetUp() override {
+        port = port_unused(SOCK_STREAM);
+        instance.reset(new InputInstance());
+        ASSERT_EQ(instance->init(params(port)), IPX_OK);
+        ASSERT_EQ(instance->run(), IPX_OK);
+    }
+
+    /**
+     * \brief Check that the instance passed given messages of a single connection
+     *
+     * The Transport Session must be opened before the first message and closed after the last
+     * one (the connection must be already closed).
+     * \param[in] msgs  Expected messages
+     * \param[in] src   Source port of the connection
+     */
+    void check(const std::vector<std::vector<uint8_t>> &msgs, uint16_t src) {
+        ASSERT_TRUE(instance->stop());
+        const std::vector<const InputMsg *> received = instance->ipfix();
+        ASSERT_EQ(received.size(), msgs.size());
+        for (size_t i = 0; i < msgs.size(); ++i) {
+            SCOPED_TRACE("message: " + std::to_string(i));
+            EXPECT_EQ(received[i]->data, msgs[i]);
+            EXPECT_EQ(received[i]->odid, i);
+            EXPECT_EQ(received[i]->net.port_src, src);
+        }
+
+        const std::vector<InputMsg> &all = instance->msgs();
+        ASSERT_GE(all.size(), 2U);
+        EXPECT_EQ(all.front().type, IPX_MSG_SESSION);
+        EXPECT_EQ(all.front().event, IPX_MSG_SESSION_OPEN);
+        EXPECT_EQ(instance->session_cnt(IPX_MSG_SESSION_OPEN), 1U);
+        EXPECT_EQ(instance->session_cnt(IPX_MSG_SESSION_CLOSE), 1U);
+    }
+};
+
+// A message split across multiple reads must be passed after its last part is received
+TEST_F(TcpInput, splitMessage)
+{
+    const std::vector<std::vector<uint8_t>> msgs = {msg_create(1000, 0, 0), msg_create(1500, 1, 1)};
+    const std::vector<uint8_t> stream = stream_create(msgs);
+
+    // Incomplete header of the first message
+    Exporter exporter(port);
+    exporter.send(stream, 0, 10);
+    EXPECT_EQ(instance->wait_ipfix(1, NOTHING_TIMEOUT), 0U);
+    // The rest of the header and a part of the body
+    exporter.send(stream, 10, 500);
+    EXPECT_EQ(instance->wait_ipfix(1, NOTHING_TIMEOUT), 0U);
+    // The rest of the first message and the header of the second one
+    exporter.send(stream, 510, 490 + FDS_IPFIX_MSG_HDR_LEN);
+    EXPECT_EQ(instance->wait_ipfix(1), 1U);
+    EXPECT_EQ(instance->wait_ipfix(2, NOTHING_TIMEOUT), 1U);
+    // The rest of the second message
+    exporter.send(stream, 1000 + FDS_IPFIX_MSG_HDR_LEN);
+    EXPECT_EQ(instance->wait_ipfix(2), 2U);
+
+    exporter.disconnect();
+    check(msgs, exporter.port);
+}
+
+// Multiple messages received by a single read must be passed at once
+TEST_F(TcpInput, multipleMessages)
+{
+    std::vector<std::vector<uint8_t>> msgs;
+    for (uint32_t i = 0; i < 64; ++i) {
+        msgs.push_back(msg_create(FDS_IPFIX_MSG_HDR_LEN + i * 13, i, (uint8_t) i));
+    }
+
+    Exporter exporter(port);
+    exporter.send(stream_create(msgs));
+    EXPECT_EQ(instance->wait_ipfix(msgs.size()), msgs.size());
+
+    exporter.disconnect();
+    check(msgs, exporter.port);
+}
+
+// Messages that straddle the edge of the receive buffer must be passed unchanged
+TEST_F(TcpInput, bufferEdge)
+{
+    // Sizes of messages are not aligned to the size of the buffer
+    std::vector<std::vector<uint8_t>> msgs;
+    size_t total = 0;
+    for (uint32_t i = 0; total < 4 * RECV_BUFFER_SIZE; ++i) {
+        const uint16_t size = (i % 8 == 7) ? UINT16_MAX : (uint16_t) (1000 + (i * 997) % 9000);
+        msgs.push_back(msg_create(size, i, (uint8_t) i));
+        total += size;
+    }
+
+    Exporter exporter(port);
+    exporter.send(stream_create(msgs));
+    EXPECT_EQ(instance->wait_ipfix(msgs.size()), msgs.size());
+
+    exporter.disconnect();
+    check(msgs, exporter.port);
+}
+
+// A connection with a malformed message must be closed, but previous messages must be passed
+TEST_F(TcpInput, malformed)
+{
+    const std::vector<std::vector<uint8_t>> msgs = {msg_create(100, 0, 0)};
+    std::vector<uint8_t> stream = stream_create(msgs);
+    std::vector<uint8_t> invalid = msg_create(100, 1, 1);
+    invalid[1] = 9; // NetFlow v9 is not supported over TCP
+    stream.insert(stream.end(), invalid.begin(), invalid.end());
+
+    Exporter exporter(port);
+    exporter.send(stream);
+    EXPECT_EQ(instance->wait_ipfix(1), 1U);
+
+    // The collector closes the connection
+    uint8_t byte;
+    struct timeval timeout = {2, 0};
+    setsockopt(exporter.sd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    EXPECT_EQ(recv(exporter.sd, &byte, sizeof(byte), 0), 0);
+
+    check(msgs, exporter.port);
+}
+
+// Each connection must be handled by a single worker that is also able to close it on request
+TEST(TcpWorkers, distribution)
+{
+    const unsigned int worker_cnt = 2;
+    const unsigned int conn_cnt = 16;  // Connections distributed by the kernel among workers
+    const unsigned int msg_cnt = 4;    // Messages sent over each connection
+    const uint16_t port = port_unused(SOCK_STREAM);
+
+    std::vector<std::unique_ptr<InputInstance>> workers;
+    for (unsigned int i = 0; i < worker_cnt; ++i) {
+        workers.emplace_back(new InputInstance(i, worker_cnt));
+        ASSERT_EQ(workers[i]->init(params(port)), IPX_OK);
+    }
+    for (unsigned int i = 0; i < worker_cnt; ++i) {
+        ASSERT_EQ(workers[i]->run(), IPX_OK);
+    }
+
+    // Messages of a connection are identified by ODID (i.e. index of the connection)
+    std::vector<std::unique_ptr<Exporter>> exporters;
+    std::vector<std::vector<std::vector<uint8_t>>> msgs(conn_cnt);
+    for (unsigned int c = 0; c < conn_cnt; ++c) {
+        exporters.emplace_back(new Exporter(port));
+        for (unsigned int i = 0; i < msg_cnt; ++i) {
+            msgs[c].push_back(msg_create(100 + i * 100, c, (uint8_t) (c * msg_cnt + i)));
+        }
+        exporters[c]->send(stream_create(msgs[c]));
+    }
+
+    // It is not known in advance which worker accepts the connection
+    const size_t total = conn_cnt * msg_cnt;
+    size_t received = 0;
+    for (unsigned int attempt = 0; received < total && attempt < 50; ++attempt) {
+        received = 0;
+        for (const auto &worker : workers) {
+            received += worker->wait_ipfix(total, NOTHING_TIMEOUT);
+        }
+    }
+    ASSERT_EQ(received, total);
+
+    // Find the worker and the Transport Session of each connection
+    std::map<uint16_t, unsigned int> conn_worker;
+    std::map<uint16_t, const struct ipx_session *> conn_session;
+    for (unsigned int i = 0; i < worker_cnt; ++i) {
+        for (const InputMsg *msg : workers[i]->ipfix()) {
+            const uint16_t src = msg->net.port_src;
+            ASSERT_TRUE(conn_worker.emplace(src, i).first->second == i)
+                << "Messages of a connection are passed by multiple workers";
+            conn_session[src] = msg->session;
+        }
+    }
+    ASSERT_EQ(conn_worker.size(), conn_cnt);
+
+    // Close every other connection on request of the pipeline (i.e. by the owning worker)
+    for (unsigned int c = 0; c < conn_cnt; c += 2) {
+        const uint16_t src = exporters[c]->port;
+        ASSERT_TRUE(workers[conn_worker[src]]->session_close(conn_session[src]));
+
+        uint8_t byte;
+        struct timeval timeout = {2, 0};
+        setsockopt(exporters[c]->sd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        EXPECT_EQ(recv(exporters[c]->sd, &byte, sizeof(byte), 0), 0);
+    }
+    // ... and the rest by the exporters
+    for (unsigned int c = 1; c < conn_cnt; c += 2) {
+        exporters[c]->disconnect();
+    }
+
+    for (unsigned int i = 0; i < worker_cnt; ++i) {
+        ASSERT_TRUE(workers[i]->stop());
+    }
+
+    for (unsigned int c = 0; c < conn_cnt; ++c) {
+        SCOPED_TRACE("connection: " + std::to_string(c));
+        const uint16_t src = exporters[c]->port;
+        const InputInstance &worker = *workers[conn_worker[src]];
+
+        // Messages in the original order
+        std::vector<std::vector<uint8_t>> data;
+        for (const InputMsg *msg : worker.ipfix()) {
+            if (msg->net.port_src == src) {
+                EXPECT_EQ(msg->odid, c);
+                data.push_back(msg->data);
+            }
+        }
+        EXPECT_EQ(data, msgs[c]);
+
+        // The Transport Session is opened and closed exactly once by the same worker
+        size_t open_cnt = 0;
+        size_t close_cnt = 0;
+        for (const InputMsg &msg : worker.msgs()) {
+            if (msg.type != IPX_MSG_SESSION || msg.net.port_src != src) {
+                continue;
+            }
+            (msg.event == IPX_MSG_SESSION_OPEN) ? ++open_cnt : ++close_cnt;
+        }
+        EXPECT_EQ(open_cnt, 1U);
+        EXPECT_EQ(close_cnt, 1U);
+    }
+
+    size_t open_total = 0;
+    for (const auto &worker : workers) {
+        open_total += worker->session_cnt(IPX_MSG_SESSION_OPEN);
+        EXPECT_EQ(worker->session_cnt(IPX_MSG_SESSION_OPEN),
+            worker->session_cnt(IPX_MSG_SESSION_CLOSE));
+    }
+    EXPECT_EQ(open_total, conn_cnt);
+}
@@ -0,0 +1,276 @@
+#include <cstring>
+#include <stdexcept>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+extern "C" {
+#include <core/message_terminate.h>
+}
+
+#include "InputInstance.h"
+
+/** Description of the plugin linked into the test */
+extern "C" struct ipx_plugin_info ipx_plugin_info;
+/** Optional function of the plugin linked into the test (NULL if not implemented) */
+extern "C" void
+ipx_plugin_session_close(ipx_ctx_t *ctx, void *cfg, const struct ipx_session *session)
+    __attribute__((weak));
+
+/** Callbacks of the plugin linked into the test */
+static const struct ipx_ctx_callbacks input_cbs = {
+    // Static plugin, no library handles
+    nullptr,
+    &ipx_plugin_info,
+    // Only basic functions
+    &ipx_plugin_init,
+    &ipx_plugin_destroy,
+    &ipx_plugin_get,
+    nullptr, // No processing function
+    &ipx_plugin_session_close,
+    nullptr, // No batch processing
+    nullptr  // No idle callback
+};
+
+/** Size of the output ring buffer */
+static const uint32_t RING_SIZE = 1024;
+/** Max time to wait for the termination of the instance [milliseconds] */
+static const uint32_t STOP_TIMEOUT = 10000;
+
+InputInstance::InputInstance(unsigned int worker_id, unsigned int worker_cnt)
+{
+    m_iemgr = fds_iemgr_create();
+    m_fpipe = ipx_fpipe_create();
+    m_ring = ipx_ring_init(RING_SIZE, false);
+    m_ctx = ipx_ctx_create(ipx_plugin_info.name, &input_cbs);
+    if (!m_iemgr || !m_fpipe || !m_ring || !m_ctx) {
+        throw std::runtime_error("Failed to create a context of the instance");
+    }
+
+    ipx_ctx_fpipe_set(m_ctx, m_fpipe);
+    ipx_ctx_ring_dst_set(m_ctx, m_ring);
+    ipx_ctx_iemgr_set(m_ctx, m_iemgr);
+    ipx_ctx_verb_set(m_ctx, IPX_VERB_WARNING);
+    ipx_ctx_worker_set(m_ctx, worker_id, worker_cnt);
+}
+
+InputInstance::~InputInstance()
+{
+    if (m_ctx) {
+        stop();
+        ipx_ctx_destroy(m_ctx);
+    }
+    if (m_ring) {
+        ipx_ring_destroy(m_ring);
+    }
+    if (m_fpipe) {
+        ipx_fpipe_destroy(m_fpipe);
+    }
+    if (m_iemgr) {
+        fds_iemgr_destroy(m_iemgr);
+    }
+}
+
+int
+InputInstance::init(const std::string &params)
+{
+    return ipx_ctx_init(m_ctx, params.c_str());
+}
+
+int
+InputInstance::run()
+{
+    int rc = ipx_ctx_run(m_ctx);
+    m_running = (rc == IPX_OK);
+    return rc;
+}
+
+size_t
+InputInstance::wait_ipfix(size_t cnt, uint32_t timeout)
+{
+    while (m_ipfix_cnt < cnt && !m_terminated) {
+        if (!take(timeout)) {
+            break;
+        }
+    }
+
+    return m_ipfix_cnt;
+}
+
+bool
+InputInstance::stop()
+{
+    if (!m_running) {
+        return m_terminated;
+    }
+
+    ipx_msg_terminate_t *msg = ipx_msg_terminate_create(IPX_MSG_TERMINATE_INSTANCE);
+    if (!msg) {
+        return false;
+    }
+
+    ipx_fpipe_write(m_fpipe, ipx_msg_terminate2base(msg));
+    m_running = false;
+    while (!m_terminated) {
+        if (!take(STOP_TIMEOUT)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool
+InputInstance::session_close(const struct ipx_session *session)
+{
+    ipx_msg_session_t *msg = ipx_msg_session_create(session, IPX_MSG_SESSION_CLOSE);
+    if (!msg) {
+        return false;
+    }
+
+    ipx_fpipe_write(m_fpipe, ipx_msg_session2base(msg));
+    return true;
+}
+
+std::vector<const InputMsg *>
+InputInstance::ipfix() const
+{
+    std::vector<const InputMsg *> result;
+    for (const InputMsg &msg : m_msgs) {
+        if (msg.type == IPX_MSG_IPFIX) {
+            result.push_back(&msg);
+        }
+    }
+    return result;
+}
+
+size_t
+InputInstance::session_cnt(enum ipx_msg_session_event event) const
+{
+    size_t cnt = 0;
+    for (const InputMsg &msg : m_msgs) {
+        if (msg.type == IPX_MSG_SESSION && msg.event == event) {
+            ++cnt;
+        }
+    }
+    return cnt;
+}
+
+/**
+ * \brief Get network identification of a Transport Session
+ * \param[in]  session Transport Session
+ * \param[out] net     Identification (zeroed if not available)
+ */
+static void
+session_net(const struct ipx_session *session, struct ipx_session_net *net)
+{
+    switch (session->type) {
+    case FDS_SESSION_UDP:
+        *net = session->udp.net;
+        break;
+    case FDS_SESSION_TCP:
+        *net = session->tcp.net;
+        break;
+    case FDS_SESSION_SCTP:
+        *net = session->sctp.net;
+        break;
+    default:
+        memset(net, 0, sizeof(*net));
+        break;
+    }
+}
+
+bool
+InputInstance::take(uint32_t timeout)
+{
+    ipx_msg_t *msgs[RING_SIZE];
+    uint32_t cnt = ipx_ring_pop_batch_timed(m_ring, msgs, RING_SIZE, timeout);
+    if (cnt == 0) {
+        return false;
+    }
+
+    for (uint32_t i = 0; i < cnt; ++i) {
+        ipx_msg_t *msg = msgs[i];
+        InputMsg rec;
+        memset(&rec.net, 0, sizeof(rec.net));
+        rec.type = ipx_msg_get_type(msg);
+        rec.event = IPX_MSG_SESSION_OPEN;
+        rec.session = nullptr;
+        rec.odid = 0;
+
+        switch (rec.type) {
+        case IPX_MSG_IPFIX: {
+            ipx_msg_ipfix_t *msg_ipfix = ipx_msg_base2ipfix(msg);
+            const struct ipx_msg_ctx *msg_ctx = ipx_msg_ipfix_get_ctx(msg_ipfix);
+            const uint8_t *packet = ipx_msg_ipfix_get_packet(msg_ipfix);
+            const uint16_t size = (uint16_t) ((packet[2] << 8) | packet[3]);
+            rec.session = msg_ctx->session;
+            rec.odid = msg_ctx->odid;
+            rec.data.assign(packet, packet + size);
+            session_net(rec.session, &rec.net);
+            m_ipfix_cnt++;
+            break;
+        }
+        case IPX_MSG_SESSION: {
+            const ipx_msg_session_t *msg_session = ipx_msg_base2session(msg);
+            rec.event = ipx_msg_session_get_event(msg_session);
+            rec.session = ipx_msg_session_get_session(msg_session);
+            session_net(rec.session, &rec.net);
+            break;
+        }
+        case IPX_MSG_TERMINATE:
+            m_terminated = true;
+            break;
+        default:
+            break;
+        }
+
+        m_msgs.push_back(std::move(rec));
+        ipx_msg_destroy(msg);
+    }
+
+    return true;
+}
+
+uint16_t
+port_unused(int type)
+{
+    int sd = socket(AF_INET, type, 0);
+    if (sd == -1) {
+        throw std::runtime_error("Failed to create a socket");
+    }
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0; // Any
+    socklen_t addr_len = sizeof(addr);
+    if (bind(sd, (struct sockaddr *) &addr, addr_len) == -1
+            || getsockname(sd, (struct sockaddr *) &addr, &addr_len) == -1) {
+        close(sd);
+        throw std::runtime_error("Failed to get an unused port");
+    }
+
+    close(sd);
+    return ntohs(addr.sin_port);
+}
+
+/**
+ * \brief Create an IPFIX Message (only the header is valid)
+ * \param[in] size Size of the message
+ * \param[in] odid Observation Domain ID
+ * \param[in] seed Value of the first byte after the header
+ */
+std::vector<uint8_t>
+msg_create(uint16_t size, uint32_t odid, uint8_t seed)
+{
+    std::vector<uint8_t> msg(size);
+    msg[0] = 0; msg[1] = FDS_IPFIX_VERSION;
+    msg[2] = (uint8_t) (size >> 8); msg[3] = (uint8_t) size;
+    msg[12] = (uint8_t) (odid >> 24); msg[13] = (uint8_t) (odid >> 16);
+    msg[14] = (uint8_t) (odid >> 8);  msg[15] = (uint8_t) odid;
+    for (uint32_t i = FDS_IPFIX_MSG_HDR_LEN; i < size; ++i) {
+        msg[i] = (uint8_t) (seed + i * 7);
+    }
+    return msg;
+}
@@ -0,0 +1,140 @@
+/**
+ * \file tests/unit/plugins/input/tools/InputInstance.h
+ * \brief Instance of an input plugin linked into a test (i.e. without the configurator)
+ */
+
+#ifndef IPFIXCOL_INPUTINSTANCE_H
+#define IPFIXCOL_INPUTINSTANCE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <libfds.h>
+#include <ipfixcol2.h>
+
+extern "C" {
+#include <core/context.h>
+#include <core/fpipe.h>
+#include <core/ring.h>
+}
+
+/** Copy of a message passed by the instance */
+struct InputMsg {
+    /** Type of the message */
+    enum ipx_msg_type type;
+    /** Event (Session messages only) */
+    enum ipx_msg_session_event event;
+    /** Transport Session (IPFIX and Session messages only, do NOT dereference) */
+    const struct ipx_session *session;
+    /** Network identification of the Transport Session (zeroed if not available) */
+    struct ipx_session_net net;
+    /** Observation Domain ID (IPFIX messages only) */
+    uint32_t odid;
+    /** Content of the message (IPFIX messages only) */
+    std::vector<uint8_t> data;
+};
+
+/**
+ * \brief Instance of the input plugin whose sources are linked into the test
+ *
+ * The instance runs in its own thread (the same way as in the collector) and passes messages
+ * into a ring buffer. Messages are taken from the buffer by the test, copied and immediately
+ * destroyed.
+ */
+class InputInstance {
+public:
+    /**
+     * \brief Create a context of the instance
+     * \param[in] worker_id  Identification number of the worker
+     * \param[in] worker_cnt Total number of workers
+     */
+    InputInstance(unsigned int worker_id = 0, unsigned int worker_cnt = 1);
+    /** Stop the instance (if running) and destroy the context */
+    ~InputInstance();
+
+    /**
+     * \brief Initialize the instance (i.e. call the constructor of the plugin)
+     * \param[in] params XML parameters
+     * \return #IPX_OK on success
+     */
+    int init(const std::string &params);
+    /**
+     * \brief Start the thread of the instance
+     * \return #IPX_OK on success
+     */
+    int run();
+    /**
+     * \brief Take passed messages until a given number of IPFIX messages is received
+     * \param[in] cnt     Total number of IPFIX messages to wait for
+     * \param[in] timeout Max time to wait for each message [milliseconds]
+     * \return Number of received IPFIX messages (i.e. less than \p cnt on timeout)
+     */
+    size_t wait_ipfix(size_t cnt, uint32_t timeout = 2000);
+    /**
+     * \brief Terminate the instance and take all remaining messages
+     *
+     * The instance closes all Transport Sessions in its destructor, i.e. Session messages with
+     * the close event are always the last ones.
+     * \return True if the instance has been terminated, false otherwise
+     */
+    bool stop();
+    /**
+     * \brief Send a request to close a Transport Session (i.e. the same as a parser does)
+     * \param[in] session Transport Session (must not be closed yet)
+     * \return True if the request has been sent, false otherwise
+     */
+    bool session_close(const struct ipx_session *session);
+
+    /** Messages taken so far (in the order in which they have been passed) */
+    const std::vector<InputMsg> &msgs() const { return m_msgs; }
+    /** IPFIX messages taken so far */
+    std::vector<const InputMsg *> ipfix() const;
+    /** Number of Session messages with a given event taken so far */
+    size_t session_cnt(enum ipx_msg_session_event event) const;
+
+private:
+    /** Manager of Information Elements (required by the context) */
+    fds_iemgr_t *m_iemgr = nullptr;
+    /** Feedback pipe (used to terminate the instance) */
+    ipx_fpipe_t *m_fpipe = nullptr;
+    /** Output ring buffer of the instance */
+    ipx_ring_t *m_ring = nullptr;
+    /** Context of the instance */
+    ipx_ctx_t *m_ctx = nullptr;
+    /** The thread of the instance is running */
+    bool m_running = false;
+    /** The termination message has been received */
+    bool m_terminated = false;
+
+    /** Messages taken so far */
+    std::vector<InputMsg> m_msgs;
+    /** Number of IPFIX messages taken so far */
+    size_t m_ipfix_cnt = 0;
+
+    /**
+     * \brief Take passed messages (if any)
+     * \param[in] timeout Max time to wait for a message [milliseconds]
+     * \return False on timeout, true otherwise
+     */
+    bool take(uint32_t timeout);
+};
+
+/**
+ * \brief Find an unused local port
+ * \param[in] type Socket type (SOCK_DGRAM or SOCK_STREAM)
+ * \return Port number (in host byte order)
+ */
+uint16_t
+port_unused(int type);
+
+/**
+ * \brief Create an IPFIX Message (only the header is valid)
+ * \param[in] size Size of the message
+ * \param[in] odid Observation Domain ID
+ * \param[in] seed Value of the first byte after the header
+ */
+std::vector<uint8_t>
+msg_create(uint16_t size, uint32_t odid, uint8_t seed);
+
+#endif // IPFIXCOL_INPUTINSTANCE_H
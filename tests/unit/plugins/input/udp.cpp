@@ -0,0 +1,275 @@
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "tools/InputInstance.h"
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+/** Size of the head of a receive slot (see SLOT_HEAD_SIZE in udp.c) */
+static const uint16_t SLOT_HEAD_SIZE = 2048;
+/** Max size of a UDP payload over IPv4 */
+static const uint16_t UDP_MAX = 65507;
+
+/**
+ * \brief Configuration of the plugin
+ * \param[in] port       Local port
+ * \param[in] batch_size Number of datagrams received by a single system call
+ */
+static std::string
+params(uint16_t port, unsigned int batch_size = 32)
+{
+    return "<params>"
+        "<localPort>" + std::to_string(port) + "</localPort>"
+        "<localIPAddress>127.0.0.1</localIPAddress>"
+        "<batchSize>" + std::to_string(batch_size) + "</batchSize>"
+        "</params>";
+}
+
+/** Exporter, i.e. a UDP socket bound to a local address */
+class Exporter {
+public:
+    /**
+     * \brief Create a socket
+     * \param[in] addr Source IPv4 address (any address of the loopback network)
+     */
+    explicit Exporter(const char *addr = "127.0.0.1") {
+        sd = socket(AF_INET, SOCK_DGRAM, 0);
+        if (sd == -1) {
+            throw std::runtime_error("Failed to create a socket");
+        }
+
+        struct sockaddr_in src;
+        memset(&src, 0, sizeof(src));
+        src.sin_family = AF_INET;
+        src.sin_port = 0; // Any
+        inet_pton(AF_INET, addr, &src.sin_addr);
+        socklen_t src_len = sizeof(src);
+        if (bind(sd, (struct sockaddr *) &src, src_len) == -1
+                || getsockname(sd, (struct sockaddr *) &src, &src_len) == -1) {
+            close(sd);
+            throw std::runtime_error("Failed to bind a socket");
+        }
+        port = ntohs(src.sin_port);
+    }
+
+    ~Exporter() {
+        close(sd);
+    }
+
+    /**
+     * \brief Send a datagram to the collector
+     * \param[in] data Payload
+     * \param[in] dst  Destination port (on 127.0.0.1)
+     */
+    void send(const std::vector<uint8_t> &data, uint16_t dst) const {
+        struct sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(dst);
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        ssize_t ret = sendto(sd, data.data(), data.size(), 0, (struct sockaddr *) &addr,
+            sizeof(addr));
+        ASSERT_EQ(ret, (ssize_t) data.size());
+    }
+
+    /** Socket descriptor */
+    int sd;
+    /** Source port */
+    uint16_t port;
+};
+
+/**
+ * Test fixture with one instance of the plugin
+ *
+ * The test is executed with batch processing of datagrams disabled and enabled (see the
+ * parameter, i.e. the batch size).
+ */
+class UdpInput : public ::testing::TestWithParam<unsigned int> {
+protected:
+    std::unique_ptr<InputInstance> instance;
+    uint16_t port;
+
+    void SetUp() override {
+        port = port_unused(SOCK_DGRAM);
+        instance.reset(new InputInstance());
+        ASSERT_EQ(instance->init(params(port, GetParam())), IPX_OK);
+    }
+};
+
+INSTANTIATE_TEST_CASE_P(Batch, UdpInput, ::testing::Values(1U, 32U));
+
+// Datagrams smaller, equal and larger than the head of a receive slot must be passed unchanged
+TEST_P(UdpInput, slotBoundary)
+{
+    const std::vector<uint16_t> sizes = {
+        FDS_IPFIX_MSG_HDR_LEN,
+        SLOT_HEAD_SIZE - 1, SLOT_HEAD_SIZE, SLOT_HEAD_SIZE + 1,
+        SLOT_HEAD_SIZE - 1, SLOT_HEAD_SIZE + 1, SLOT_HEAD_SIZE, // Reuse of the slots
+        2 * SLOT_HEAD_SIZE,
+        UDP_MAX
+    };
+
+    // All datagrams are waiting in the socket, i.e. they are received at once
+    Exporter exporter;
+    std::vector<std::vector<uint8_t>> msgs;
+    for (size_t i = 0; i < sizes.size(); ++i) {
+        msgs.push_back(msg_create(sizes[i], 1, (uint8_t) i));
+        exporter.send(msgs.back(), port);
+    }
+
+    ASSERT_EQ(instance->run(), IPX_OK);
+    ASSERT_EQ(instance->wait_ipfix(msgs.size()), msgs.size());
+    ASSERT_TRUE(instance->stop());
+
+    const std::vector<const InputMsg *> received = instance->ipfix();
+    ASSERT_EQ(received.size(), msgs.size());
+    for (size_t i = 0; i < msgs.size(); ++i) {
+        SCOPED_TRACE("size: " + std::to_string(sizes[i]));
+        EXPECT_EQ(received[i]->data, msgs[i]);
+        EXPECT_EQ(received[i]->odid, 1U);
+        EXPECT_EQ(received[i]->net.port_src, exporter.port);
+        EXPECT_EQ(received[i]->net.port_dst, port);
+    }
+
+    // The Transport Session is opened before the first message and closed on termination
+    const std::vector<InputMsg> &all = instance->msgs();
+    ASSERT_GE(all.size(), 1U);
+    EXPECT_EQ(all[0].type, IPX_MSG_SESSION);
+    EXPECT_EQ(all[0].event, IPX_MSG_SESSION_OPEN);
+    EXPECT_EQ(instance->session_cnt(IPX_MSG_SESSION_OPEN), 1U);
+    EXPECT_EQ(instance->session_cnt(IPX_MSG_SESSION_CLOSE), 1U);
+}
+
+// Consecutive datagrams from different sources must be assigned to the right Transport Sessions
+TEST_P(UdpInput, interleavedSources)
+{
+    const size_t msg_cnt = 24;
+    Exporter exp_a("127.0.0.1");
+    Exporter exp_b("127.0.0.2");
+    std::vector<std::vector<uint8_t>> msgs;
+    for (size_t i = 0; i < msg_cnt; ++i) {
+        // Pattern A, B, B, A, A, B, B, A, ...
+        const bool is_a = (i % 4 == 0 || i % 4 == 3);
+        const Exporter &exp = is_a ? exp_a : exp_b;
+        msgs.push_back(msg_create(100 + i * 200, is_a ? 1 : 2, (uint8_t) i));
+        exp.send(msgs.back(), port);
+    }
+
+    ASSERT_EQ(instance->run(), IPX_OK);
+    ASSERT_EQ(instance->wait_ipfix(msg_cnt), msg_cnt);
+    ASSERT_TRUE(instance->stop());
+
+    const std::vector<const InputMsg *> received = instance->ipfix();
+    ASSERT_EQ(received.size(), msg_cnt);
+    for (size_t i = 0; i < msg_cnt; ++i) {
+        EXPECT_EQ(received[i]->data, msgs[i]);
+        const uint16_t port_exp = (received[i]->odid == 1) ? exp_a.port : exp_b.port;
+        EXPECT_EQ(received[i]->net.port_src, port_exp);
+    }
+
+    EXPECT_EQ(instance->session_cnt(IPX_MSG_SESSION_OPEN), 2U);
+    EXPECT_EQ(instance->session_cnt(IPX_MSG_SESSION_CLOSE), 2U);
+}
+
+// Malformed datagrams must be dropped without affecting other datagrams of the same batch
+TEST_P(UdpInput, malformed)
+{
+    Exporter exporter;
+    const std::vector<uint8_t> valid1 = msg_create(SLOT_HEAD_SIZE, 1, 1);
+    const std::vector<uint8_t> valid2 = msg_create(SLOT_HEAD_SIZE + 1, 1, 2);
+    std::vector<uint8_t> version = msg_create(SLOT_HEAD_SIZE + 1, 1, 3);
+    version[1] = 8; // Unknown version
+
+    exporter.send({FDS_IPFIX_VERSION}, port);        // Too short
+    exporter.send(valid1, port);
+    exporter.send(version, port);
+    exporter.send({0, FDS_IPFIX_VERSION, 0}, port);  // Incomplete header
+    exporter.send(valid2, port);
+
+    ASSERT_EQ(instance->run(), IPX_OK);
+    ASSERT_EQ(instance->wait_ipfix(2), 2U);
+    ASSERT_TRUE(instance->stop());
+
+    const std::vector<const InputMsg *> received = instance->ipfix();
+    ASSERT_EQ(received.size(), 2U);
+    EXPECT_EQ(received[0]->data, valid1);
+    EXPECT_EQ(received[1]->data, valid2);
+    EXPECT_EQ(instance->session_cnt(IPX_MSG_SESSION_OPEN), 1U);
+}
+
+/**
+ * \brief Get the worker selected by the steering program (see address_steer() in udp.c)
+ * \param[in] addr    Source IPv4 address (in host byte order)
+ * \param[in] workers Number of workers
+ */
+static unsigned int
+steer(uint32_t addr, unsigned int workers)
+{
+    return ((uint32_t) (addr * 0x9E3779B1U) >> 16) % workers;
+}
+
+// All datagrams of an exporter must be received by the same worker regardless of source port
+TEST(UdpWorkers, steering)
+{
+    const unsigned int worker_cnt = 2;
+    const unsigned int addr_cnt = 8;   // Exporters 127.0.0.1 - 127.0.0.8
+    const unsigned int port_cnt = 3;   // Source ports of each exporter
+    const unsigned int msg_cnt = 4;    // Messages sent from each source port
+    const uint16_t port = port_unused(SOCK_DGRAM);
+
+    // Sockets of workers are added to the group of the port in the order of initialization
+    std::vector<std::unique_ptr<InputInstance>> workers;
+    for (unsigned int i = 0; i < worker_cnt; ++i) {
+        workers.emplace_back(new InputInstance(i, worker_cnt));
+        ASSERT_EQ(workers[i]->init(params(port)), IPX_OK);
+    }
+    for (unsigned int i = 0; i < worker_cnt; ++i) {
+        ASSERT_EQ(workers[i]->run(), IPX_OK);
+    }
+
+    std::vector<size_t> exp_msgs(worker_cnt, 0);
+    std::vector<size_t> exp_sessions(worker_cnt, 0);
+    std::vector<std::unique_ptr<Exporter>> exporters;
+    for (uint32_t addr = 1; addr <= addr_cnt; ++addr) {
+        const std::string addr_str = "127.0.0." + std::to_string(addr);
+        const unsigned int worker = steer(INADDR_LOOPBACK - 1 + addr, worker_cnt);
+        for (unsigned int i = 0; i < port_cnt; ++i) {
+            exporters.emplace_back(new Exporter(addr_str.c_str()));
+            for (unsigned int j = 0; j < msg_cnt; ++j) {
+                exporters.back()->send(msg_create(100, addr, (uint8_t) j), port);
+            }
+        }
+        exp_msgs[worker] += port_cnt * msg_cnt;
+        exp_sessions[worker] += port_cnt;
+    }
+
+    for (unsigned int i = 0; i < worker_cnt; ++i) {
+        SCOPED_TRACE("worker: " + std::to_string(i));
+        ASSERT_GT(exp_msgs[i], 0U) << "All exporters are pinned to the same worker";
+        EXPECT_EQ(workers[i]->wait_ipfix(exp_msgs[i]), exp_msgs[i]);
+        ASSERT_TRUE(workers[i]->stop());
+
+        // Each worker has its own Transport Sessions
+        const std::vector<const InputMsg *> received = workers[i]->ipfix();
+        EXPECT_EQ(received.size(), exp_msgs[i]);
+        for (const InputMsg *msg : received) {
+            const uint32_t addr = ntohl(msg->net.addr_src.ipv4.s_addr);
+            EXPECT_EQ(steer(addr, worker_cnt), i);
+            EXPECT_EQ(msg->odid, addr - (INADDR_LOOPBACK - 1));
+        }
+        EXPECT_EQ(workers[i]->session_cnt(IPX_MSG_SESSION_OPEN), exp_sessions[i]);
+        EXPECT_EQ(workers[i]->session_cnt(IPX_MSG_SESSION_CLOSE), exp_sessions[i]);
+    }
+}
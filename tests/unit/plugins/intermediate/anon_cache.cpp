@@ -0,0 +1,217 @@
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <vector>
+#include <endian.h>
+
+extern "C" {
+#include <cache.h>
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+/** Key of the anonymizer */
+static const uint8_t KEY[32] = {
+    21, 34, 23, 141, 51, 164, 207, 128, 19, 10, 91, 22, 73, 144, 125, 16,
+    216, 152, 143, 131, 121, 121, 101, 39, 98, 87, 76, 45, 42, 132, 34, 2
+};
+
+/** Test fixture with an anonymizer and a cache */
+class AnonCache : public ::testing::Test {
+protected:
+    PAnonymizer_t pan;
+    anon_cache_t *cache = nullptr;
+
+    void SetUp() override {
+        ASSERT_EQ(PAnonymizer_Init(&pan, KEY), 0);
+    }
+
+    void TearDown() override {
+        if (cache != nullptr) {
+            anon_cache_destroy(cache);
+        }
+    }
+
+    /** Create the smallest possible cache (i.e. a single set of each table) */
+    void
+    create_min() {
+        for (size_t size = 1; !cache; ++size) {
+            ASSERT_LT(size, 1024U * 1024U);
+            cache = anon_cache_create(size);
+        }
+    }
+
+    /** Anonymize an IPv4 address and compare the result with Crypto-PAn without the cache */
+    void
+    check_ipv4(uint32_t addr) {
+        EXPECT_EQ(anon_cache_ipv4(cache, &pan, addr), anonymize(&pan, addr)) << "address " << addr;
+    }
+
+    /** Anonymize an IPv6 address and compare the result with Crypto-PAn without the cache */
+    void
+    check_ipv6(const uint64_t addr[2]) {
+        uint64_t cached[2];
+        uint64_t uncached[2];
+        anon_cache_ipv6(cache, &pan, addr, cached);
+        anonymize_v6(&pan, addr, uncached);
+        EXPECT_EQ(memcmp(cached, uncached, sizeof(cached)), 0);
+    }
+
+    /** Get statistics of IPv4 or IPv6 addresses (statistics of both families are reset) */
+    struct anon_cache_stats
+    stats(bool ipv6) {
+        struct anon_cache_stats ipv4_stats;
+        struct anon_cache_stats ipv6_stats;
+        anon_cache_stats(cache, &ipv4_stats, &ipv6_stats);
+        return ipv6 ? ipv6_stats : ipv4_stats;
+    }
+};
+
+// Too small cache cannot be created
+TEST_F(AnonCache, tooSmall)
+{
+    EXPECT_EQ(anon_cache_create(0), nullptr);
+    EXPECT_EQ(anon_cache_create(1), nullptr);
+}
+
+// Hits of each prefix length and correctness of partially computed results
+TEST_F(AnonCache, prefixReuseIPv4)
+{
+    cache = anon_cache_create(1024U * 1024U);
+    ASSERT_NE(cache, nullptr);
+
+    const uint32_t addr = 0xC0A80A01;                // 192.168.10.1
+    check_ipv4(addr);                                // miss
+    check_ipv4(addr);                                // /32
+    check_ipv4(0xC0A80A02);                          // /24
+    check_ipv4(0xC0A81401);                          // /16
+    check_ipv4(0x0A000001);                          // miss
+
+    struct anon_cache_stats st = stats(false);
+    EXPECT_EQ(st.lookups, 5U);
+    EXPECT_EQ(st.bits[0], 32U);
+    EXPECT_EQ(st.bits[1], 24U);
+    EXPECT_EQ(st.bits[2], 16U);
+    EXPECT_EQ(st.hits[0], 1U);
+    EXPECT_EQ(st.hits[1], 1U);
+    EXPECT_EQ(st.hits[2], 1U);
+
+    // Statistics are reset
+    st = stats(false);
+    EXPECT_EQ(st.lookups, 0U);
+    EXPECT_EQ(st.hits[0], 0U);
+}
+
+TEST_F(AnonCache, prefixReuseIPv6)
+{
+    cache = anon_cache_create(1024U * 1024U);
+    ASSERT_NE(cache, nullptr);
+
+    uint8_t bytes[16] = {0x20, 0x01, 0x0D, 0xB8, 0x00, 0x01, 0x00, 0x02,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01};
+    uint64_t addr[2];
+    memcpy(addr, bytes, sizeof(addr));
+    check_ipv6(addr);                                // miss
+    check_ipv6(addr);                                // /128
+    bytes[15] = 0x02;
+    memcpy(addr, bytes, sizeof(addr));
+    check_ipv6(addr);                                // /64
+    bytes[6] = 0xFF;
+    memcpy(addr, bytes, sizeof(addr));
+    check_ipv6(addr);                                // /48
+    bytes[0] = 0xFE;
+    memcpy(addr, bytes, sizeof(addr));
+    check_ipv6(addr);                                // miss
+
+    struct anon_cache_stats st = stats(true);
+    EXPECT_EQ(st.lookups, 5U);
+    EXPECT_EQ(st.bits[0], 128U);
+    EXPECT_EQ(st.bits[1], 64U);
+    EXPECT_EQ(st.bits[2], 48U);
+    EXPECT_EQ(st.hits[0], 1U);
+    EXPECT_EQ(st.hits[1], 1U);
+    EXPECT_EQ(st.hits[2], 1U);
+
+    // IPv4 and IPv6 are independent
+    EXPECT_EQ(stats(false).lookups, 0U);
+}
+
+// The least recently used entries are replaced and results are still correct
+TEST_F(AnonCache, eviction)
+{
+    create_min();
+
+    // Three addresses with different /16 prefixes, but only 2 entries per table
+    const uint32_t addrs[] = {0x0A000001, 0x0B000001, 0x0C000001};
+    check_ipv4(addrs[0]);
+    check_ipv4(addrs[1]);
+    check_ipv4(addrs[0]);                            // /32, the first one is recently used
+    check_ipv4(addrs[2]);                            // replaces the second one
+    check_ipv4(addrs[0]);                            // /32
+    check_ipv4(addrs[1]);                            // /24 (the /32 hit didn't refresh it)
+    check_ipv4(addrs[0]);                            // /32
+    check_ipv4(0x0A0000FF);                          // miss (the /24 and /16 were replaced)
+
+    struct anon_cache_stats st = stats(false);
+    EXPECT_EQ(st.lookups, 8U);
+    EXPECT_EQ(st.hits[0], 3U);
+    EXPECT_EQ(st.hits[1], 1U);
+    EXPECT_EQ(st.hits[2], 0U);
+
+    uint64_t addr6[3][2] = {{1, 1}, {2, 2}, {3, 3}};
+    check_ipv6(addr6[0]);
+    check_ipv6(addr6[1]);
+    check_ipv6(addr6[2]);                            // replaces the first one
+    check_ipv6(addr6[0]);                            // miss
+    check_ipv6(addr6[0]);                            // /128
+
+    st = stats(true);
+    EXPECT_EQ(st.lookups, 5U);
+    EXPECT_EQ(st.hits[0], 1U);
+    EXPECT_EQ(st.hits[1], 0U);
+    EXPECT_EQ(st.hits[2], 0U);
+}
+
+// Random addresses with shared prefixes must give the same results as without the cache
+TEST_F(AnonCache, random)
+{
+    create_min();
+    anon_cache_t *small = cache;
+    cache = anon_cache_create(64U * 1024U);
+    ASSERT_NE(cache, nullptr);
+    anon_cache_t *big = cache;
+
+    std::mt19937_64 gen(2021);
+    std::vector<uint64_t> bases;
+    for (int i = 0; i < 16; ++i) {
+        bases.push_back(gen());
+    }
+
+    for (anon_cache_t *c : {small, big}) {
+        cache = c;
+        for (int i = 0; i < 5000; ++i) {
+            // Keep the first 16, 24, 32 or 48 bits of a base address
+            const uint64_t base = bases[gen() % bases.size()];
+            const unsigned int keep = 16 + 8 * (gen() % 4);
+            const uint64_t mask = UINT64_MAX << (64 - keep);
+            const uint64_t value = (base & mask) | (gen() & ~mask);
+
+            check_ipv4((uint32_t) (value >> 32));
+            const uint64_t addr[2] = {htobe64(value), gen() % 4};
+            check_ipv6(addr);
+        }
+
+        struct anon_cache_stats st_ipv4;
+        struct anon_cache_stats st_ipv6;
+        anon_cache_stats(cache, &st_ipv4, &st_ipv6);
+        EXPECT_EQ(st_ipv4.lookups, 5000U);
+        EXPECT_EQ(st_ipv6.lookups, 5000U);
+    }
+
+    anon_cache_destroy(small);
+}
@@ -0,0 +1,152 @@
+#include <gtest/gtest.h>
+#include <arpa/inet.h>
+#include <cstdint>
+#include <cstring>
+#include <random>
+
+extern "C" {
+#include <panonymizer.h>
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+/** Key of the sample trace distributed with the reference implementation of Crypto-PAn */
+static const uint8_t SAMPLE_KEY[32] = {
+    21, 34, 23, 141, 51, 164, 207, 128, 19, 10, 91, 22, 73, 144, 125, 16,
+    216, 152, 143, 131, 121, 121, 101, 39, 98, 87, 76, 45, 42, 132, 34, 2
+};
+
+/** Addresses of the sample trace and their anonymized versions */
+static const char *SAMPLE_IPV4[][2] = {
+    {"128.11.68.132",   "135.242.180.132"},
+    {"129.118.74.4",    "134.136.186.123"},
+    {"130.132.252.244", "133.68.164.234"},
+    {"141.223.7.43",    "141.167.8.160"},
+    {"192.102.249.13",  "252.138.62.131"},
+    {"24.0.250.221",    "100.15.198.226"},
+    {"64.34.154.117",   "0.221.154.117"},
+    {"4.3.88.225",      "124.60.155.63"},
+    {"63.14.55.111",    "95.9.215.7"},
+};
+
+/**
+ * Test fixture with the software and (if supported by the CPU) AES-NI backend
+ *
+ * The same key is used by both backends.
+ */
+class CryptoPAn : public ::testing::Test {
+protected:
+    PAnonymizer_t sw;
+    PAnonymizer_t hw;
+
+    void SetUp() override {
+        ASSERT_EQ(PAnonymizer_Init(&sw, SAMPLE_KEY), 0);
+        ASSERT_EQ(PAnonymizer_Init(&hw, SAMPLE_KEY), 0);
+        sw.aesni = 0;
+    }
+
+    /** Check if the AES-NI backend is available (otherwise, both backends are the same) */
+    bool
+    aesni() const {
+        if (!hw.aesni) {
+            std::cout << "AES-NI is not supported by the CPU, only the software backend is tested"
+                << std::endl;
+        }
+        return hw.aesni != 0;
+    }
+
+    /** Anonymize an IPv4 address in the text form */
+    static std::string
+    anon_ipv4(const PAnonymizer_t *ctx, const char *addr) {
+        struct in_addr in;
+        EXPECT_EQ(inet_pton(AF_INET, addr, &in), 1);
+        in.s_addr = htonl(anonymize(ctx, ntohl(in.s_addr)));
+
+        char buffer[INET_ADDRSTRLEN];
+        EXPECT_NE(inet_ntop(AF_INET, &in, buffer, sizeof(buffer)), nullptr);
+        return buffer;
+    }
+};
+
+// Known results of the reference implementation
+TEST_F(CryptoPAn, vectorsIPv4)
+{
+    for (const auto &sample : SAMPLE_IPV4) {
+        EXPECT_EQ(anon_ipv4(&sw, sample[0]), sample[1]) << "software, " << sample[0];
+        EXPECT_EQ(anon_ipv4(&hw, sample[0]), sample[1]) << "AES-NI, " << sample[0];
+    }
+    aesni();
+}
+
+// Both backends must produce the same one-time-pads (including partial computation)
+TEST_F(CryptoPAn, backendsIPv4)
+{
+    if (!aesni()) {
+        return;
+    }
+
+    std::mt19937 gen(12345);
+    for (int i = 0; i < 1000; ++i) {
+        const uint32_t addr = gen();
+        const uint32_t otp = anonymize_otp(&sw, addr, 0, 0);
+        ASSERT_EQ(anonymize_otp(&hw, addr, 0, 0), otp) << "address " << addr;
+
+        for (int from = 8; from < 32; from += 8) {
+            EXPECT_EQ(anonymize_otp(&sw, addr, from, otp), otp);
+            EXPECT_EQ(anonymize_otp(&hw, addr, from, otp), otp);
+        }
+    }
+}
+
+// Both backends must produce the same results for IPv6 and preserve prefixes
+TEST_F(CryptoPAn, backendsIPv6)
+{
+    std::mt19937_64 gen(54321);
+    uint64_t prev[2] = {0, 0};
+    uint64_t prev_anon[2] = {0, 0};
+
+    for (int i = 0; i < 200; ++i) {
+        uint64_t addr[2] = {gen(), gen()};
+        const int common = i % 128;
+        if (i > 0) {
+            // Share the first "common" bits with the previous address
+            uint8_t *bytes = reinterpret_cast<uint8_t *>(addr);
+            const uint8_t *prev_bytes = reinterpret_cast<const uint8_t *>(prev);
+            memcpy(bytes, prev_bytes, common / 8);
+            const uint8_t mask = 0xFF << (8 - common % 8);
+            bytes[common / 8] = (prev_bytes[common / 8] & mask) | (bytes[common / 8] & ~mask);
+        }
+
+        uint64_t anon_sw[2];
+        uint64_t anon_hw[2];
+        anonymize_v6(&sw, addr, anon_sw);
+        anonymize_v6(&hw, addr, anon_hw);
+        EXPECT_EQ(memcmp(anon_sw, anon_hw, sizeof(anon_sw)), 0) << "iteration " << i;
+
+        // Partial computation from a cached prefix
+        uint64_t otp_full[2];
+        anonymize_otp_v6(&sw, addr, 0, otp_full);
+        for (int from = 8; from < 128; from += 40) {
+            uint64_t otp_sw[2] = {otp_full[0], otp_full[1]};
+            uint64_t otp_hw[2] = {otp_full[0], otp_full[1]};
+            anonymize_otp_v6(&sw, addr, from, otp_sw);
+            anonymize_otp_v6(&hw, addr, from, otp_hw);
+            EXPECT_EQ(memcmp(otp_sw, otp_full, sizeof(otp_full)), 0);
+            EXPECT_EQ(memcmp(otp_hw, otp_full, sizeof(otp_full)), 0);
+        }
+
+        // The anonymized addresses must share the same prefix
+        // Note: Only whole bytes are compared as the implementation stores bits of the one-time-pad
+        //   in the reversed order within each byte.
+        if (i > 0) {
+            EXPECT_EQ(memcmp(anon_sw, prev_anon, common / 8), 0);
+        }
+
+        memcpy(prev, addr, sizeof(prev));
+        memcpy(prev_anon, anon_sw, sizeof(prev_anon));
+    }
+}
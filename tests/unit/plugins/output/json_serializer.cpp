@@ -0,0 +1,277 @@
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <arpa/inet.h>
+#include <libfds.h>
+
+#include "JsonSerializer.hpp"
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+/** Definition of a template field: Enterprise Number, Information Element ID and length */
+struct field_def {
+    uint32_t en;
+    uint16_t id;
+    uint16_t len;
+};
+
+/** Conversion flags of the default configuration of the JSON output */
+static const uint32_t FLAGS_FMT = FDS_CD2J_ALLOW_REALLOC | FDS_CD2J_FORMAT_TCPFLAGS
+    | FDS_CD2J_TS_FORMAT_MSEC | FDS_CD2J_FORMAT_PROTO | FDS_CD2J_NON_PRINTABLE
+    | FDS_CD2J_OCTETS_NOINT;
+/** Conversion flags with all formatting disabled and numeric identifiers of fields */
+static const uint32_t FLAGS_RAW = FDS_CD2J_ALLOW_REALLOC | FDS_CD2J_NUMERIC_ID;
+
+/** Fields of various data types (including reduced-size encoding) */
+static const std::vector<field_def> fields_types = {
+    {0, 1, 8},   // octetDeltaCount
+    {0, 2, 4},   // packetDeltaCount (reduced-size)
+    {0, 150, 4}, // flowStartSeconds
+    {0, 152, 8}, // flowStartMilliseconds
+    {0, 154, 8}, // flowStartMicroseconds
+    {0, 156, 8}, // flowStartNanoseconds
+    {0, 8, 4},   // sourceIPv4Address
+    {0, 27, 16}, // sourceIPv6Address
+    {0, 56, 6},  // sourceMacAddress
+    {0, 4, 1},   // protocolIdentifier
+    {0, 6, 2},   // tcpControlBits
+    {0, 7, 2},   // sourceTransportPort
+    {0, 82, 8},  // interfaceName (fixed-length string)
+    {0, 320, 8}, // absoluteError (float64)
+    {0, 276, 1}, // dataRecordsReliability (boolean)
+    {0, 434, 4}  // mibObjectValueInteger (signed32)
+};
+
+/** Biflow fields (forward and reverse) */
+static const std::vector<field_def> fields_biflow = {
+    {0, 8, 4}, {0, 12, 4}, {0, 7, 2}, {0, 11, 2}, {0, 4, 1},
+    {0, 1, 8}, {0, 2, 8}, {0, 152, 8}, {0, 6, 1},
+    {29305, 1, 8}, {29305, 2, 8}, {29305, 152, 8}, {29305, 6, 1}
+};
+
+/** Fixed-length octet arrays (as integers only up to 8 bytes) and MAC addresses */
+static const std::vector<field_def> fields_octets = {
+    {0, 313, 1},  // ipHeaderPacketSection
+    {0, 314, 8},  // ipPayloadPacketSection
+    {0, 315, 9},  // dataLinkFrameSection
+    {0, 210, 32}, // paddingOctets
+    {0, 56, 6},   // sourceMacAddress
+    {0, 80, 6},   // destinationMacAddress
+    {0, 1, 8}     // octetDeltaCount
+};
+
+/** Unknown fields (an unknown enterprise and an unknown IANA element) and known fields */
+static const std::vector<field_def> fields_unknown = {
+    {12345, 1000, 4}, {0, 1, 8}, {0, 32000, 2}, {12345, 1001, 3}, {0, 8, 4}
+};
+
+class Serializer : public ::testing::Test {
+protected:
+    fds_iemgr_t *iemgr = nullptr;
+    std::vector<struct fds_template *> tmplts;
+
+    void SetUp() override {
+        iemgr = fds_iemgr_create();
+        ASSERT_NE(iemgr, nullptr);
+        ASSERT_EQ(fds_iemgr_read_dir(iemgr, fds_api_cfg_dir()), FDS_OK)
+            << fds_iemgr_last_err(iemgr);
+    }
+
+    void TearDown() override {
+        for (auto tmplt : tmplts) {
+            fds_template_destroy(tmplt);
+        }
+        fds_iemgr_destroy(iemgr);
+    }
+
+    /** Create a template with definitions of Information Elements */
+    const struct fds_template *
+    tmplt_create(uint16_t id, const std::vector<field_def> &fields) {
+        std::vector<uint16_t> raw = {htons(id), htons(static_cast<uint16_t>(fields.size()))};
+        for (const auto &field : fields) {
+            raw.push_back(htons(field.id | ((field.en != 0) ? 0x8000 : 0)));
+            raw.push_back(htons(field.len));
+            if (field.en != 0) {
+                raw.push_back(htons(static_cast<uint16_t>(field.en >> 16)));
+                raw.push_back(htons(static_cast<uint16_t>(field.en & 0xFFFF)));
+            }
+        }
+
+        struct fds_template *tmplt;
+        uint16_t len = static_cast<uint16_t>(raw.size() * sizeof(uint16_t));
+        EXPECT_EQ(fds_template_parse(FDS_TYPE_TEMPLATE, raw.data(), &len, &tmplt), FDS_OK);
+        EXPECT_EQ(fds_template_ies_define(tmplt, iemgr, false), FDS_OK);
+        tmplts.push_back(tmplt);
+        return tmplt;
+    }
+
+    /** Generate pseudo-random records with realistic timestamps in milliseconds */
+    static std::vector<uint8_t>
+    records_generate(const struct fds_template *tmplt, uint32_t cnt) {
+        std::vector<uint8_t> data(size_t(tmplt->data_length) * cnt);
+        for (auto &byte : data) {
+            byte = static_cast<uint8_t>(rand());
+        }
+
+        for (uint32_t i = 0; i < cnt; ++i) {
+            uint8_t *rec = &data[size_t(tmplt->data_length) * i];
+            for (uint16_t f = 0; f < tmplt->fields_cnt_total; ++f) {
+                const struct fds_tfield *field = &tmplt->fields[f];
+                if (!field->def || field->def->data_type != FDS_ET_DATE_TIME_MILLISECONDS) {
+                    continue;
+                }
+                uint64_t ts = 1526067869006ULL + i * 7U + field->offset;
+                for (int b = 7; b >= 0; --b, ts >>= 8) {
+                    rec[field->offset + b] = static_cast<uint8_t>(ts & 0xFF);
+                }
+            }
+        }
+        return data;
+    }
+
+    /** Convert records by the serializer and fds_drec2json() and compare the results */
+    void
+    compare(JsonSerializer &serializer, const struct fds_template *tmplt, uint32_t flags,
+            bool reverse, uint32_t cnt = 100) {
+        std::vector<uint8_t> data = records_generate(tmplt, cnt);
+        const uint32_t flags_ref = flags | (reverse ? FDS_CD2J_BIFLOW_REVERSE : 0);
+        char *buffer_ref = nullptr;
+        char *buffer_new = nullptr;
+        size_t size_ref = 0;
+        size_t size_new = 0;
+
+        struct fds_drec rec;
+        rec.size = tmplt->data_length;
+        rec.tmplt = tmplt;
+        rec.snap = nullptr;
+
+        for (uint32_t i = 0; i < cnt; ++i) {
+            rec.data = &data[size_t(tmplt->data_length) * i];
+            int rc_ref = fds_drec2json(&rec, flags_ref, iemgr, &buffer_ref, &size_ref);
+            int rc_new = serializer.convert(&rec, reverse, iemgr, &buffer_new, &size_new);
+            ASSERT_GT(rc_ref, 0);
+            ASSERT_EQ(rc_new, rc_ref);
+            EXPECT_EQ(std::string(buffer_new, rc_new), std::string(buffer_ref, rc_ref))
+                << "Template " << tmplt->id << ", record " << i;
+        }
+
+        free(buffer_ref);
+        free(buffer_new);
+    }
+};
+
+// Formatted values of various data types
+TEST_F(Serializer, formatted)
+{
+    const struct fds_template *tmplt = tmplt_create(256, fields_types);
+    JsonSerializer serializer(FLAGS_FMT);
+    compare(serializer, tmplt, FLAGS_FMT, false);
+}
+
+// Numeric identifiers of fields and raw values
+TEST_F(Serializer, numericId)
+{
+    const struct fds_template *tmplt = tmplt_create(256, fields_types);
+    JsonSerializer serializer(FLAGS_RAW);
+    compare(serializer, tmplt, FLAGS_RAW, false);
+}
+
+// Biflow records from both points of view (separate plans of the same template)
+TEST_F(Serializer, biflowReverse)
+{
+    const struct fds_template *tmplt = tmplt_create(257, fields_biflow);
+    ASSERT_NE(tmplt->flags & FDS_TEMPLATE_BIFLOW, 0U);
+
+    for (uint32_t flags : {FLAGS_FMT, FLAGS_RAW}) {
+        JsonSerializer serializer(flags);
+        for (int round = 0; round < 2; ++round) {
+            compare(serializer, tmplt, flags, false);
+            compare(serializer, tmplt, flags, true);
+        }
+    }
+}
+
+// Fields without definitions of Information Elements
+TEST_F(Serializer, unknownFields)
+{
+    const struct fds_template *tmplt = tmplt_create(258, fields_unknown);
+    for (uint32_t flags : {FLAGS_FMT, FLAGS_RAW}) {
+        JsonSerializer serializer(flags);
+        compare(serializer, tmplt, flags, false);
+    }
+}
+
+// Octet arrays and MAC addresses of many records with various values
+TEST_F(Serializer, octetsMac)
+{
+    const struct fds_template *tmplt = tmplt_create(260, fields_octets);
+    for (uint32_t flags : {FLAGS_FMT, FLAGS_RAW}) {
+        JsonSerializer serializer(flags);
+        compare(serializer, tmplt, flags, false, 5000);
+    }
+}
+
+// Multiple templates converted by the same serializer (cached plans)
+TEST_F(Serializer, interleaved)
+{
+    const struct fds_template *tmplt_types = tmplt_create(256, fields_types);
+    const struct fds_template *tmplt_biflow = tmplt_create(257, fields_biflow);
+    const struct fds_template *tmplt_unknown = tmplt_create(258, fields_unknown);
+
+    JsonSerializer serializer(FLAGS_FMT);
+    for (int round = 0; round < 3; ++round) {
+        compare(serializer, tmplt_types, FLAGS_FMT, false, 10);
+        compare(serializer, tmplt_biflow, FLAGS_FMT, true, 10);
+        compare(serializer, tmplt_unknown, FLAGS_FMT, false, 10);
+        compare(serializer, tmplt_biflow, FLAGS_FMT, false, 10);
+    }
+}
+
+// Records converted one after another into the same buffer (e.g. a batch of records)
+TEST_F(Serializer, offset)
+{
+    // The second template is converted only by fds_drec2json() (multiple occurrences of an IE)
+    const std::vector<field_def> fields_multi = {{0, 1, 8}, {0, 8, 4}, {0, 1, 8}};
+    const struct fds_template *tmplt_types = tmplt_create(256, fields_types);
+    const struct fds_template *tmplt_multi = tmplt_create(259, fields_multi);
+    ASSERT_NE(tmplt_multi->flags & FDS_TEMPLATE_MULTI_IE, 0U);
+
+    JsonSerializer serializer(FLAGS_FMT);
+    for (const struct fds_template *tmplt : {tmplt_types, tmplt_multi}) {
+        const uint32_t cnt = 1000; // Requires multiple reallocations
+        std::vector<uint8_t> data = records_generate(tmplt, cnt);
+        std::string expected;
+        char *buffer_ref = nullptr;
+        char *buffer_new = nullptr;
+        size_t size_ref = 0;
+        size_t size_new = 0;
+        size_t used = 0;
+
+        struct fds_drec rec;
+        rec.size = tmplt->data_length;
+        rec.tmplt = tmplt;
+        rec.snap = nullptr;
+
+        for (uint32_t i = 0; i < cnt; ++i) {
+            rec.data = &data[size_t(tmplt->data_length) * i];
+            int rc_ref = fds_drec2json(&rec, FLAGS_FMT, iemgr, &buffer_ref, &size_ref);
+            int rc_new = serializer.convert(&rec, false, iemgr, &buffer_new, &size_new, used);
+            ASSERT_GT(rc_ref, 0);
+            ASSERT_EQ(rc_new, rc_ref);
+            expected.append(buffer_ref, size_t(rc_ref));
+            used += size_t(rc_new);
+        }
+
+        // Previously converted records must be preserved
+        EXPECT_EQ(std::string(buffer_new, used), expected) << "Template " << tmplt->id;
+        free(buffer_ref);
+        free(buffer_new);
+    }
+}
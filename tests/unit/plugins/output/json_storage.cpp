@@ -0,0 +1,420 @@
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <libfds.h>
+#include <ipfixcol2.h>
+
+extern "C" {
+#include <core/context.h>
+}
+
+#include "Storage.hpp"
+#include "Sender.hpp"
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+/** Size of a batch passed to outputs before the end of an IPFIX Message (see Storage.cpp) */
+static const size_t BATCH_SIZE = 1024 * 1024;
+/** Maximum size of a UDP datagram with multiple records (see Sender.cpp) */
+static const size_t DGRAM_SIZE = 1400;
+
+/** Output that remembers all batches passed by the storage */
+class Capture : public Output {
+public:
+    /** Content of each received batch */
+    std::vector<std::string> batches;
+    /** Records of each received batch */
+    std::vector<std::vector<std::string>> records;
+    /** Number of flush() calls */
+    unsigned int flushes = 0;
+
+    explicit Capture(ipx_ctx_t *ctx) : Output("capture", ctx) {};
+
+    int
+    process(const char *str, size_t len) override {
+        (void) str;
+        (void) len;
+        ADD_FAILURE() << "Records must be passed in batches";
+        return IPX_ERR_DENIED;
+    }
+
+    int
+    process_batch(const struct OutputBatch &batch) override {
+        batches.emplace_back(batch.data, batch.size);
+        records.emplace_back();
+
+        // All records are stored one after another in the data of the batch
+        const char *pos = batch.data;
+        for (size_t i = 0; i < batch.cnt; ++i) {
+            EXPECT_EQ(batch.recs[i].iov_base, pos);
+            records.back().emplace_back(pos, batch.recs[i].iov_len);
+            pos += batch.recs[i].iov_len;
+        }
+        EXPECT_EQ(pos, batch.data + batch.size);
+        return IPX_OK;
+    }
+
+    void
+    flush() override {
+        flushes++;
+    }
+};
+
+class JsonStorage : public ::testing::Test {
+protected:
+    fds_iemgr_t *iemgr = nullptr;
+    struct fds_template *tmplt = nullptr;
+    ipx_ctx_t *ctx = nullptr;
+    struct ipx_session *session = nullptr;
+    struct cfg_format fmt;
+
+    void SetUp() override {
+        iemgr = fds_iemgr_create();
+        ASSERT_NE(iemgr, nullptr);
+        ASSERT_EQ(fds_iemgr_read_dir(iemgr, fds_api_cfg_dir()), FDS_OK)
+            << fds_iemgr_last_err(iemgr);
+
+        // octetDeltaCount, sourceIPv4Address, sourceTransportPort, interfaceName (64 bytes)
+        std::vector<uint16_t> raw = {htons(256), htons(4), htons(1), htons(8), htons(8),
+            htons(4), htons(7), htons(2), htons(82), htons(64)};
+        uint16_t len = static_cast<uint16_t>(raw.size() * sizeof(uint16_t));
+        ASSERT_EQ(fds_template_parse(FDS_TYPE_TEMPLATE, raw.data(), &len, &tmplt), FDS_OK);
+        ASSERT_EQ(fds_template_ies_define(tmplt, iemgr, false), FDS_OK);
+
+        ctx = ipx_ctx_create("json", nullptr);
+        ASSERT_NE(ctx, nullptr);
+
+        struct ipx_session_net net;
+        memset(&net, 0, sizeof(net));
+        net.l3_proto = AF_INET;
+        session = ipx_session_new_udp(&net, 0, 0);
+        ASSERT_NE(session, nullptr);
+
+        // Default configuration of the plugin
+        memset(&fmt, 0, sizeof(fmt));
+        fmt.tcp_flags = true;
+        fmt.timestamp = true;
+        fmt.proto = true;
+    }
+
+    void TearDown() override {
+        if (session) {
+            ipx_session_destroy(session);
+        }
+        if (ctx) {
+            ipx_ctx_destroy(ctx);
+        }
+        if (tmplt) {
+            fds_template_destroy(tmplt);
+        }
+        if (iemgr) {
+            fds_iemgr_destroy(iemgr);
+        }
+    }
+
+    /**
+     * \brief Create an IPFIX Message with pseudo-random Data Records
+     * \param[in]  cnt  Number of records
+     * \param[out] data Storage of the records (must exist until the message is destroyed)
+     */
+    ipx_msg_ipfix_t *
+    msg_create(uint32_t cnt, std::vector<uint8_t> &data) {
+        data.resize(size_t(tmplt->data_length) * cnt);
+        for (auto &byte : data) {
+            byte = static_cast<uint8_t>('a' + rand() % 26);
+        }
+
+        const uint16_t size = sizeof(struct fds_ipfix_msg_hdr);
+        uint8_t *packet = static_cast<uint8_t *>(calloc(1, size));
+        if (!packet) {
+            return nullptr;
+        }
+        auto hdr = reinterpret_cast<struct fds_ipfix_msg_hdr *>(packet);
+        hdr->version = htons(FDS_IPFIX_VERSION);
+        hdr->length = htons(size);
+
+        struct ipx_msg_ctx msg_ctx;
+        memset(&msg_ctx, 0, sizeof(msg_ctx));
+        msg_ctx.session = session;
+        ipx_msg_ipfix_t *msg = ipx_msg_ipfix_create(ctx, &msg_ctx, packet, size);
+        if (!msg) {
+            free(packet);
+            return nullptr;
+        }
+
+        for (uint32_t i = 0; i < cnt; ++i) {
+            struct ipx_ipfix_record *rec = ipx_msg_ipfix_add_drec_ref(&msg);
+            EXPECT_NE(rec, nullptr);
+            rec->rec.data = &data[size_t(tmplt->data_length) * i];
+            rec->rec.size = tmplt->data_length;
+            rec->rec.tmplt = tmplt;
+            rec->rec.snap = nullptr;
+        }
+        return msg;
+    }
+
+    /** Expected JSON records of a message (converted by fds_drec2json()) */
+    std::vector<std::string>
+    expected(ipx_msg_ipfix_t *msg) {
+        const uint32_t flags = FDS_CD2J_ALLOW_REALLOC | FDS_CD2J_FORMAT_TCPFLAGS
+            | FDS_CD2J_TS_FORMAT_MSEC | FDS_CD2J_FORMAT_PROTO | FDS_CD2J_NON_PRINTABLE
+            | FDS_CD2J_OCTETS_NOINT;
+        char *buffer = nullptr;
+        size_t size = 0;
+        std::vector<std::string> result;
+
+        for (uint32_t i = 0; i < ipx_msg_ipfix_get_drec_cnt(msg); ++i) {
+            struct fds_drec *rec = &ipx_msg_ipfix_get_drec(msg, i)->rec;
+            int rc = fds_drec2json(rec, flags, iemgr, &buffer, &size);
+            EXPECT_GT(rc, 0);
+            result.emplace_back(std::string(buffer, size_t(rc)) + "\n");
+        }
+
+        free(buffer);
+        return result;
+    }
+};
+
+// All records of a message are passed to outputs at once at the end of the message
+TEST_F(JsonStorage, batchEndOfMessage)
+{
+    Storage storage(ctx, fmt);
+    Capture *capture = new Capture(ctx);
+    storage.output_add(capture);
+
+    std::vector<uint8_t> data;
+    for (uint32_t cnt : {1U, 10U, 500U}) {
+        ipx_msg_ipfix_t *msg = msg_create(cnt, data);
+        ASSERT_NE(msg, nullptr);
+        capture->batches.clear();
+        capture->records.clear();
+        capture->flushes = 0;
+
+        ASSERT_EQ(storage.records_store(msg, iemgr), IPX_OK);
+        ASSERT_EQ(capture->records.size(), 1U);
+        EXPECT_EQ(capture->records[0], expected(msg));
+        EXPECT_EQ(capture->flushes, 1U);
+        ipx_msg_ipfix_destroy(msg);
+    }
+
+    // An empty message doesn't produce any batch
+    ipx_msg_ipfix_t *msg = msg_create(0, data);
+    ASSERT_NE(msg, nullptr);
+    capture->records.clear();
+    ASSERT_EQ(storage.records_store(msg, iemgr), IPX_OK);
+    EXPECT_TRUE(capture->records.empty());
+    ipx_msg_ipfix_destroy(msg);
+}
+
+// Large messages are passed in batches of approximately 1 MiB
+TEST_F(JsonStorage, batchLimit)
+{
+    Storage storage(ctx, fmt);
+    Capture *capture = new Capture(ctx);
+    storage.output_add(capture);
+
+    std::vector<uint8_t> data;
+    ipx_msg_ipfix_t *msg = msg_create(30000, data);
+    ASSERT_NE(msg, nullptr);
+    ASSERT_EQ(storage.records_store(msg, iemgr), IPX_OK);
+    EXPECT_EQ(capture->flushes, 1U);
+
+    // The limit is exceeded by the last record of each batch (except the last one)
+    ASSERT_GT(capture->batches.size(), 1U);
+    std::vector<std::string> recs_all;
+    for (size_t i = 0; i < capture->batches.size(); ++i) {
+        const std::string &batch = capture->batches[i];
+        const std::vector<std::string> &recs = capture->records[i];
+        ASSERT_FALSE(recs.empty());
+        if (i + 1 < capture->batches.size()) {
+            EXPECT_GE(batch.size(), BATCH_SIZE);
+            EXPECT_LT(batch.size() - recs.back().size(), BATCH_SIZE);
+        } else {
+            EXPECT_LT(batch.size(), BATCH_SIZE);
+        }
+        recs_all.insert(recs_all.end(), recs.begin(), recs.end());
+    }
+    EXPECT_EQ(recs_all, expected(msg));
+    ipx_msg_ipfix_destroy(msg);
+
+    // The next message starts a new batch
+    msg = msg_create(5, data);
+    ASSERT_NE(msg, nullptr);
+    capture->records.clear();
+    ASSERT_EQ(storage.records_store(msg, iemgr), IPX_OK);
+    ASSERT_EQ(capture->records.size(), 1U);
+    EXPECT_EQ(capture->records[0], expected(msg));
+    ipx_msg_ipfix_destroy(msg);
+}
+
+/** UDP receiver on the loopback interface */
+class JsonSender : public ::testing::Test {
+protected:
+    ipx_ctx_t *ctx = nullptr;
+    int sd = -1;
+    uint16_t port = 0;
+
+    void SetUp() override {
+        ctx = ipx_ctx_create("json", nullptr);
+        ASSERT_NE(ctx, nullptr);
+
+        sd = socket(AF_INET, SOCK_DGRAM, 0);
+        ASSERT_NE(sd, -1);
+        int rcvbuf = 4 * 1024 * 1024;
+        setsockopt(sd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+
+        struct sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        ASSERT_EQ(bind(sd, reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr)), 0);
+        socklen_t addr_len = sizeof(addr);
+        ASSERT_EQ(getsockname(sd, reinterpret_cast<struct sockaddr *>(&addr), &addr_len), 0);
+        port = ntohs(addr.sin_port);
+    }
+
+    void TearDown() override {
+        if (sd != -1) {
+            close(sd);
+        }
+        if (ctx) {
+            ipx_ctx_destroy(ctx);
+        }
+    }
+
+    /** Receive all datagrams (waits only for the first one) */
+    std::vector<std::string>
+    receive() {
+        std::vector<std::string> dgrams;
+        std::vector<char> buffer(65536);
+        int timeout = 1000;
+        struct pollfd pfd = {sd, POLLIN, 0};
+        while (poll(&pfd, 1, timeout) == 1) {
+            ssize_t len = recv(sd, buffer.data(), buffer.size(), 0);
+            if (len < 0) {
+                break;
+            }
+            dgrams.emplace_back(buffer.data(), size_t(len));
+            timeout = 100;
+        }
+        return dgrams;
+    }
+};
+
+// Records are packed into datagrams up to 1400 bytes, larger records are sent alone
+TEST_F(JsonSender, udpPacking)
+{
+    struct cfg_send cfg;
+    cfg.name = "sender";
+    cfg.addr = "127.0.0.1";
+    cfg.port = port;
+    cfg.blocking = true;
+    cfg.proto = cfg_send::SEND_PROTO_UDP;
+    Sender sender(cfg, ctx);
+
+    // Records of various sizes (including a record larger than a datagram)
+    const std::vector<size_t> sizes = {100, 600, 700, 1400, 1, 1399, 2000, 300, 300, 300, 300,
+        300, 300, 50};
+    std::string data;
+    std::vector<struct iovec> recs;
+    for (size_t i = 0; i < sizes.size(); ++i) {
+        data += std::string(sizes[i] - 1, char('a' + i)) + "\n";
+    }
+    size_t offset = 0;
+    for (size_t size : sizes) {
+        struct iovec rec;
+        rec.iov_base = const_cast<char *>(data.data() + offset);
+        rec.iov_len = size;
+        recs.push_back(rec);
+        offset += size;
+    }
+
+    // Expected datagrams (consecutive records are merged greedily)
+    std::vector<std::string> dgrams_exp;
+    offset = 0;
+    for (size_t i = 0; i < sizes.size(); ) {
+        size_t len = sizes[i++];
+        while (i < sizes.size() && len + sizes[i] <= DGRAM_SIZE) {
+            len += sizes[i++];
+        }
+        dgrams_exp.push_back(data.substr(offset, len));
+        offset += len;
+    }
+
+    struct OutputBatch batch;
+    batch.data = data.data();
+    batch.size = data.size();
+    batch.recs = recs.data();
+    batch.cnt = recs.size();
+    ASSERT_EQ(sender.process_batch(batch), IPX_OK);
+
+    std::vector<std::string> dgrams = receive();
+    EXPECT_EQ(dgrams, dgrams_exp);
+    for (const std::string &dgram : dgrams) {
+        // Only a single record can exceed the limit
+        if (dgram.size() > DGRAM_SIZE) {
+            EXPECT_EQ(dgram.find('\n'), dgram.size() - 1);
+        }
+    }
+
+    // A single record is sent in its own datagram
+    ASSERT_EQ(sender.process("{}\n", 3), IPX_OK);
+    dgrams = receive();
+    ASSERT_EQ(dgrams.size(), 1U);
+    EXPECT_EQ(dgrams[0], "{}\n");
+}
+
+// Many small records are packed into full datagrams without any change
+TEST_F(JsonSender, udpManyRecords)
+{
+    struct cfg_send cfg;
+    cfg.name = "sender";
+    cfg.addr = "127.0.0.1";
+    cfg.port = port;
+    cfg.blocking = true;
+    cfg.proto = cfg_send::SEND_PROTO_UDP;
+    Sender sender(cfg, ctx);
+
+    // Records of the same size (17 bytes)
+    std::string data;
+    std::vector<struct iovec> recs;
+    for (int i = 0; i < 3000; ++i) {
+        data += "{\"rec\":" + std::to_string(1000000 + i) + "}\n";
+    }
+    const size_t rec_len = data.size() / 3000;
+    for (int i = 0; i < 3000; ++i) {
+        struct iovec rec;
+        rec.iov_base = const_cast<char *>(data.data() + i * rec_len);
+        rec.iov_len = rec_len;
+        recs.push_back(rec);
+    }
+
+    struct OutputBatch batch;
+    batch.data = data.data();
+    batch.size = data.size();
+    batch.recs = recs.data();
+    batch.cnt = recs.size();
+    ASSERT_EQ(sender.process_batch(batch), IPX_OK);
+
+    std::vector<std::string> dgrams = receive();
+    std::string received;
+    for (const std::string &dgram : dgrams) {
+        EXPECT_LE(dgram.size(), DGRAM_SIZE);
+        EXPECT_EQ(dgram.size() % rec_len, 0U);
+        received += dgram;
+    }
+    EXPECT_EQ(dgrams.size(), (3000 + DGRAM_SIZE / rec_len - 1) / (DGRAM_SIZE / rec_len));
+    EXPECT_EQ(received, data);
+}